@@ -0,0 +1,155 @@
+﻿/**
+* @file Matrix2D.h
+* @brief 2Dのアフィン変換(拡縮、回転、移動)を保存できる構造体の宣言
+*/
+#ifndef MATRIX_2D_H_
+#define MATRIX_2D_H_
+
+#include <math.h>
+#include "Vec.h"
+
+//=====================================================================//
+//! 2Dアフィン変換行列用構造体
+//! 座標は行ベクトルとして左から掛ける(D3DXの行列と同じ順番)
+//! x' = x * M11 + y * M21 + Dx
+//! y' = x * M12 + y * M22 + Dy
+//=====================================================================//
+struct Matrix2D
+{
+	/** Constructor(単位行列) */
+	Matrix2D()
+	{
+		M11 = 1.0f;
+		M12 = 0.0f;
+		M21 = 0.0f;
+		M22 = 1.0f;
+		Dx = 0.0f;
+		Dy = 0.0f;
+	}
+
+	/**
+	* @brief Constructor
+	* @param[in] m11 1行1列
+	* @param[in] m12 1行2列
+	* @param[in] m21 2行1列
+	* @param[in] m22 2行2列
+	* @param[in] dx 移動量X
+	* @param[in] dy 移動量Y
+	*/
+	Matrix2D(float m11, float m12, float m21, float m22, float dx, float dy)
+	{
+		M11 = m11;
+		M12 = m12;
+		M21 = m21;
+		M22 = m22;
+		Dx = dx;
+		Dy = dy;
+	}
+
+	/**
+	* @brief 移動行列の作成
+	* @retval Matrix2D 移動行列
+	* @param[in] x 移動量X
+	* @param[in] y 移動量Y
+	*/
+	static Matrix2D Translation(float x, float y)
+	{
+		return Matrix2D(1.0f, 0.0f, 0.0f, 1.0f, x, y);
+	}
+
+	/**
+	* @brief 回転行列の作成
+	* @retval Matrix2D 回転行列
+	* @param[in] angle 回転角度(度数法、画面上で時計回り)
+	*/
+	static Matrix2D Rotation(float angle)
+	{
+		float rad = angle * 3.14159265f / 180.0f;
+		float s = sinf(rad);
+		float c = cosf(rad);
+		return Matrix2D(c, s, -s, c, 0.0f, 0.0f);
+	}
+
+	/**
+	* @brief 拡縮行列の作成
+	* @retval Matrix2D 拡縮行列
+	* @param[in] scale_x 拡大率X
+	* @param[in] scale_y 拡大率Y
+	*/
+	static Matrix2D Scaling(float scale_x, float scale_y)
+	{
+		return Matrix2D(scale_x, 0.0f, 0.0f, scale_y, 0.0f, 0.0f);
+	}
+
+	/**
+	* @brief 行列の合成
+	* @retval Matrix2D aの変換を行った後にbの変換を行う行列
+	* @param[in] a 先に行う変換
+	* @param[in] b 後に行う変換
+	*/
+	static Matrix2D Multiply(const Matrix2D& a, const Matrix2D& b)
+	{
+		return Matrix2D(
+			a.M11 * b.M11 + a.M12 * b.M21,
+			a.M11 * b.M12 + a.M12 * b.M22,
+			a.M21 * b.M11 + a.M22 * b.M21,
+			a.M21 * b.M12 + a.M22 * b.M22,
+			a.Dx * b.M11 + a.Dy * b.M21 + b.Dx,
+			a.Dx * b.M12 + a.Dy * b.M22 + b.Dy);
+	}
+
+	/**
+	* @brief 逆行列の作成
+	* @retval Matrix2D 逆行列(逆行列がない場合は単位行列)
+	* @param[in] m 元の行列
+	*/
+	static Matrix2D Inverse(const Matrix2D& m)
+	{
+		float det = m.M11 * m.M22 - m.M12 * m.M21;
+		if (det == 0.0f)
+		{
+			return Matrix2D();
+		}
+
+		float inv_det = 1.0f / det;
+		float m11 = m.M22 * inv_det;
+		float m12 = -m.M12 * inv_det;
+		float m21 = -m.M21 * inv_det;
+		float m22 = m.M11 * inv_det;
+
+		return Matrix2D(m11, m12, m21, m22,
+			-(m.Dx * m11 + m.Dy * m21),
+			-(m.Dx * m12 + m.Dy * m22));
+	}
+
+	/**
+	* @brief 座標の変換
+	* @retval Vec2 変換後の座標
+	* @param[in] point 変換する座標
+	*/
+	Vec2 TransformPoint(const Vec2& point) const
+	{
+		return Vec2(
+			point.X * M11 + point.Y * M21 + Dx,
+			point.X * M12 + point.Y * M22 + Dy);
+	}
+
+	/**
+	* @brief 単位行列の判定
+	* @retval true 単位行列
+	* @retval false 単位行列ではない
+	*/
+	bool IsIdentity() const
+	{
+		return M11 == 1.0f && M12 == 0.0f && M21 == 0.0f && M22 == 1.0f && Dx == 0.0f && Dy == 0.0f;
+	}
+
+	float M11;	//!< 1行1列
+	float M12;	//!< 1行2列
+	float M21;	//!< 2行1列
+	float M22;	//!< 2行2列
+	float Dx;	//!< 移動量X
+	float Dy;	//!< 移動量Y
+};
+
+#endif
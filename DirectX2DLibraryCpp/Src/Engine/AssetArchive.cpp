@@ -0,0 +1,301 @@
+﻿#include <string.h>
+#include "AssetArchive.h"
+#include "FileWatcher.h"
+
+bool AssetArchive::Open(const char* file_name)
+{
+	Close();
+
+	m_FileHandle = CreateFile(
+		file_name,
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL,
+		nullptr);
+
+	if (m_FileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER file_size;
+	if (GetFileSizeEx(m_FileHandle, &file_size) == FALSE ||
+		file_size.QuadPart < (LONGLONG)sizeof(AssetArchiveHeader))
+	{
+		Close();
+		return false;
+	}
+	m_FileSize = (unsigned long long)file_size.QuadPart;
+
+	m_MappingHandle = CreateFileMapping(m_FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_MappingHandle != nullptr)
+	{
+		m_MappedData = (const char*)MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0);
+	}
+
+	if (m_MappedData == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	m_Header = (const AssetArchiveHeader*)m_MappedData;
+	if (memcmp(m_Header->Magic, AssetArchiveMagic, sizeof(AssetArchiveMagic)) != 0 ||
+		m_Header->Version != AssetArchiveVersion ||
+		ValidateDirectory() == false)
+	{
+		Close();
+		return false;
+	}
+
+	m_EntryList = (const AssetArchiveEntry*)(m_MappedData + m_Header->EntryOffset);
+	m_BucketList = (const unsigned int*)(m_MappedData + m_Header->BucketOffset);
+	m_NameList = m_MappedData + m_Header->NameOffset;
+
+	return true;
+}
+
+void AssetArchive::Close()
+{
+	if (m_MappedData != nullptr)
+	{
+		UnmapViewOfFile(m_MappedData);
+		m_MappedData = nullptr;
+	}
+
+	if (m_MappingHandle != nullptr)
+	{
+		CloseHandle(m_MappingHandle);
+		m_MappingHandle = nullptr;
+	}
+
+	if (m_FileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_FileHandle);
+		m_FileHandle = INVALID_HANDLE_VALUE;
+	}
+
+	m_FileSize = 0;
+	m_Header = nullptr;
+	m_EntryList = nullptr;
+	m_BucketList = nullptr;
+	m_NameList = nullptr;
+}
+
+bool AssetArchive::ReadFile(const char* file_name, FileData* out_data) const
+{
+	if (m_Header == nullptr)
+	{
+		return false;
+	}
+
+	const AssetArchiveEntry* entry = FindEntry(FileWatcher::NormalizePath(file_name));
+	if (entry == nullptr)
+	{
+		return false;
+	}
+
+	const char* stored_data = m_MappedData + entry->DataOffset;
+
+	if ((entry->Flags & AssetArchiveFlagLz4) == 0)
+	{
+		out_data->Buffer.clear();
+		out_data->Data = stored_data;
+		out_data->Size = entry->StoredSize;
+		return true;
+	}
+
+	out_data->Buffer.resize(entry->OriginalSize);
+	if (entry->OriginalSize > 0 &&
+		DecompressLz4(stored_data, entry->StoredSize, &out_data->Buffer[0], entry->OriginalSize) == false)
+	{
+		out_data->Buffer.clear();
+		return false;
+	}
+
+	out_data->Data = out_data->Buffer.empty() == true ? nullptr : &out_data->Buffer[0];
+	out_data->Size = entry->OriginalSize;
+
+	return true;
+}
+
+unsigned long long AssetArchive::HashName(const char* name, size_t length)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+
+	for (size_t i = 0; i < length; i++)
+	{
+		hash ^= (unsigned char)name[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+bool AssetArchive::DecompressLz4(const char* source, size_t source_size, char* destination, size_t destination_size)
+{
+	const unsigned char* ip = (const unsigned char*)source;
+	const unsigned char* ip_end = ip + source_size;
+	unsigned char* op = (unsigned char*)destination;
+	unsigned char* op_end = op + destination_size;
+
+	while (ip < ip_end)
+	{
+		// トークンの上位4ビットがリテラル長、下位4ビットが一致長(15の場合は後続のバイトを加算する)
+		unsigned int token = *ip++;
+
+		size_t literal_length = token >> 4;
+		if (literal_length == 15)
+		{
+			unsigned int value = 255;
+			while (value == 255)
+			{
+				if (ip >= ip_end)
+				{
+					return false;
+				}
+				value = *ip++;
+				literal_length += value;
+			}
+		}
+
+		if (literal_length > (size_t)(ip_end - ip) ||
+			literal_length > (size_t)(op_end - op))
+		{
+			return false;
+		}
+
+		memcpy(op, ip, literal_length);
+		ip += literal_length;
+		op += literal_length;
+
+		// 最後のシーケンスはリテラルだけ
+		if (ip == ip_end)
+		{
+			break;
+		}
+
+		if (ip_end - ip < 2)
+		{
+			return false;
+		}
+
+		size_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+
+		if (offset == 0 || offset > (size_t)(op - (unsigned char*)destination))
+		{
+			return false;
+		}
+
+		size_t match_length = token & 15;
+		if (match_length == 15)
+		{
+			unsigned int value = 255;
+			while (value == 255)
+			{
+				if (ip >= ip_end)
+				{
+					return false;
+				}
+				value = *ip++;
+				match_length += value;
+			}
+		}
+		match_length += 4;
+
+		if (match_length > (size_t)(op_end - op))
+		{
+			return false;
+		}
+
+		// 一致の範囲がコピー先と重なる場合(offset < match_length)は繰り返しになるので1バイトずつコピーする
+		const unsigned char* match = op - offset;
+		if (offset >= match_length)
+		{
+			memcpy(op, match, match_length);
+			op += match_length;
+		}
+		else
+		{
+			for (size_t i = 0; i < match_length; i++)
+			{
+				*op++ = *match++;
+			}
+		}
+	}
+
+	return op == op_end;
+}
+
+const AssetArchiveEntry* AssetArchive::FindEntry(const std::string& name) const
+{
+	unsigned long long hash = HashName(name.c_str(), name.size());
+	unsigned int mask = m_Header->BucketCount - 1;
+
+	for (unsigned int i = 0; i < m_Header->BucketCount; i++)
+	{
+		unsigned int entry_index = m_BucketList[(hash + i) & mask];
+		if (entry_index == AssetArchiveEmptyBucket)
+		{
+			return nullptr;
+		}
+
+		const AssetArchiveEntry* entry = &m_EntryList[entry_index];
+		if (entry->NameHash == hash &&
+			entry->NameLength == name.size() &&
+			memcmp(m_NameList + entry->NameOffset, name.c_str(), name.size()) == 0)
+		{
+			return entry;
+		}
+	}
+
+	return nullptr;
+}
+
+bool AssetArchive::ValidateDirectory() const
+{
+	const AssetArchiveHeader* header = m_Header;
+	unsigned long long entry_size = (unsigned long long)header->EntryCount * sizeof(AssetArchiveEntry);
+	unsigned long long bucket_size = (unsigned long long)header->BucketCount * sizeof(unsigned int);
+
+	// バケットは2のべき乗で、空きがないと検索が終わらない
+	if (header->BucketCount == 0 ||
+		(header->BucketCount & (header->BucketCount - 1)) != 0 ||
+		header->BucketCount <= header->EntryCount ||
+		header->EntryOffset % sizeof(unsigned long long) != 0 ||
+		header->BucketOffset % sizeof(unsigned int) != 0 ||
+		header->EntryOffset > m_FileSize || entry_size > m_FileSize - header->EntryOffset ||
+		header->BucketOffset > m_FileSize || bucket_size > m_FileSize - header->BucketOffset ||
+		header->NameOffset > m_FileSize || header->NameSize > m_FileSize - header->NameOffset)
+	{
+		return false;
+	}
+
+	const AssetArchiveEntry* entry_list = (const AssetArchiveEntry*)(m_MappedData + header->EntryOffset);
+	for (unsigned int i = 0; i < header->EntryCount; i++)
+	{
+		const AssetArchiveEntry& entry = entry_list[i];
+		if (entry.DataOffset > m_FileSize ||
+			entry.StoredSize > m_FileSize - entry.DataOffset ||
+			(unsigned long long)entry.NameOffset + entry.NameLength > header->NameSize ||
+			((entry.Flags & AssetArchiveFlagLz4) == 0 && entry.StoredSize != entry.OriginalSize) ||
+			((entry.Flags & AssetArchiveFlagLz4) != 0 && entry.OriginalSize > (unsigned long long)entry.StoredSize * AssetArchiveLz4MaxRatio))
+		{
+			return false;
+		}
+	}
+
+	const unsigned int* bucket_list = (const unsigned int*)(m_MappedData + header->BucketOffset);
+	for (unsigned int i = 0; i < header->BucketCount; i++)
+	{
+		if (bucket_list[i] != AssetArchiveEmptyBucket && bucket_list[i] >= header->EntryCount)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,168 @@
+﻿/**
+* @file AssetArchive.h
+* @brief <pre>
+* 複数のファイルを1つにまとめたアーカイブの形式と、アーカイブを読み込むクラスの宣言
+* アーカイブはメモリマップで開き、圧縮していないファイルはコピーせずにマップしたメモリを直接参照する
+* アーカイブはTools/AssetPackerで作成する
+* </pre>
+*/
+#ifndef ASSET_ARCHIVE_H_
+#define ASSET_ARCHIVE_H_
+
+#include <Windows.h>
+#include <string>
+#include "FileSystem.h"
+
+const char AssetArchiveMagic[4] = { 'D', 'X', 'P', 'K' };	//!< アーカイブの識別子
+const unsigned int AssetArchiveVersion = 1;				//!< アーカイブの形式のバージョン
+const size_t AssetArchiveAlignment = 16;				//!< ファイルの先頭を揃えるバイト数(SSEでそのまま読めるようにする)
+const unsigned int AssetArchiveEmptyBucket = 0xffffffff;	//!< 空のバケットを示す値
+const unsigned short AssetArchiveFlagLz4 = 0x0001;		//!< ファイルがLZ4(ブロック形式)で圧縮されているフラグ
+const unsigned int AssetArchiveLz4MaxRatio = 255;		//!< LZ4の展開後のバイト数の圧縮後に対する最大の倍率(長さの追加1バイトで最大255バイト増える)
+
+/**
+* @brief アーカイブのヘッダー
+* @details <pre>
+* アーカイブは先頭からヘッダー、ファイルの内容(AssetArchiveAlignmentバイト境界)、エントリ、バケット、ファイル名の順に並ぶ
+* バケットはファイル名のハッシュ値の下位ビットを開始位置とする線形探索のハッシュテーブルで、エントリの番号を持つ
+* </pre>
+*/
+struct AssetArchiveHeader
+{
+	char Magic[4];							//!< 識別子
+	unsigned int Version;					//!< 形式のバージョン
+	unsigned int EntryCount;				//!< エントリの数
+	unsigned int BucketCount;				//!< バケットの数(2のべき乗)
+	unsigned long long EntryOffset;			//!< エントリの位置
+	unsigned long long BucketOffset;		//!< バケットの位置
+	unsigned long long NameOffset;			//!< ファイル名の位置
+	unsigned long long NameSize;			//!< ファイル名のバイト数
+};
+
+/** @brief アーカイブのエントリ */
+struct AssetArchiveEntry
+{
+	unsigned long long NameHash;			//!< ファイル名のハッシュ値
+	unsigned long long DataOffset;			//!< 内容の位置
+	unsigned int StoredSize;				//!< アーカイブ内のバイト数
+	unsigned int OriginalSize;				//!< 展開後のバイト数
+	unsigned int NameOffset;				//!< ファイル名の位置(ファイル名の領域の先頭から)
+	unsigned short NameLength;				//!< ファイル名の文字数(終端文字を含まない)
+	unsigned short Flags;					//!< AssetArchiveFlagLz4など
+};
+
+static_assert(sizeof(AssetArchiveHeader) == 48, "AssetArchiveHeader must be 48 bytes");
+static_assert(sizeof(AssetArchiveEntry) == 32, "AssetArchiveEntry must be 32 bytes");
+
+/**
+* @brief アーカイブクラス
+* @details <pre>
+* Openでアーカイブ全体をメモリマップで開き、ヘッダーとディレクトリを検証する
+* ファイル名は大文字小文字と区切り文字を区別しない(FileWatcher::NormalizePathで正規化してから比較する)
+* 開いた後は内容を変更しないので、ReadFileは複数のスレッドから同時に実行できる
+* </pre>
+*/
+class AssetArchive : public FileSource
+{
+public:
+	/** Constructor */
+	AssetArchive() :
+		m_FileHandle(INVALID_HANDLE_VALUE),
+		m_MappingHandle(nullptr),
+		m_MappedData(nullptr),
+		m_FileSize(0),
+		m_Header(nullptr),
+		m_EntryList(nullptr),
+		m_BucketList(nullptr),
+		m_NameList(nullptr)
+	{
+	}
+
+	/** Destructor */
+	virtual ~AssetArchive()
+	{
+		Close();
+	}
+
+	/**
+	* @brief アーカイブを開く関数
+	* @retval true 成功
+	* @retval false ファイルを開けなかった、または形式が不正
+	* @param[in] file_name アーカイブのファイル名
+	*/
+	bool Open(const char* file_name);
+
+	/**
+	* @brief アーカイブを閉じる関数
+	* @details ReadFileで取得した、展開していない内容は参照できなくなる
+	*/
+	void Close();
+
+	/**
+	* @brief ファイルの読み込み関数
+	* @details 圧縮していないファイルはマップしたメモリを直接参照し、圧縮したファイルはout_data->Bufferに展開する
+	* @retval true 読み込み成功
+	* @retval false アーカイブにない、または展開失敗
+	* @param[in] file_name ファイル名(パス込み)
+	* @param[out] out_data 読み込んだ内容
+	*/
+	virtual bool ReadFile(const char* file_name, FileData* out_data) const override;
+
+	/**
+	* @brief エントリ数の取得関数
+	* @retval int アーカイブに含まれるファイルの数
+	*/
+	int GetEntryCount() const
+	{
+		return m_Header != nullptr ? (int)m_Header->EntryCount : 0;
+	}
+
+	/**
+	* @brief ファイル名のハッシュ値の計算関数
+	* @details FNV-1a(64bit)
+	* @retval unsigned long long ハッシュ値
+	* @param[in] name 正規化したファイル名
+	* @param[in] length ファイル名の文字数
+	*/
+	static unsigned long long HashName(const char* name, size_t length);
+
+	/**
+	* @brief LZ4の展開関数
+	* @details 展開後のサイズを超える書き込みや、展開済みの範囲外の参照がある不正なデータは失敗する
+	* @retval true 展開成功
+	* @retval false データが不正
+	* @param[in] source 圧縮したデータ(LZ4ブロック形式)
+	* @param[in] source_size 圧縮したデータのバイト数
+	* @param[out] destination 展開先
+	* @param[in] destination_size 展開後のバイト数
+	*/
+	static bool DecompressLz4(const char* source, size_t source_size, char* destination, size_t destination_size);
+
+private:
+	/**
+	* @brief エントリの検索関数
+	* @retval const AssetArchiveEntry* 見つかったエントリ(ない場合はnullptr)
+	* @param[in] name 正規化したファイル名
+	*/
+	const AssetArchiveEntry* FindEntry(const std::string& name) const;
+
+	/**
+	* @brief ディレクトリの検証関数
+	* @details 全ての位置とサイズがファイルの範囲内にあり、圧縮したファイルの展開後のサイズがLZ4で表せる範囲内かを確認する
+	* @retval true 正しい
+	* @retval false 不正
+	*/
+	bool ValidateDirectory() const;
+
+private:
+	HANDLE m_FileHandle;					//!< アーカイブのハンドル
+	HANDLE m_MappingHandle;					//!< ファイルマッピングのハンドル
+	const char* m_MappedData;				//!< マップしたアーカイブの先頭
+	unsigned long long m_FileSize;			//!< アーカイブのバイト数
+	const AssetArchiveHeader* m_Header;		//!< ヘッダー
+	const AssetArchiveEntry* m_EntryList;	//!< エントリ
+	const unsigned int* m_BucketList;		//!< バケット
+	const char* m_NameList;					//!< ファイル名
+};
+
+#endif
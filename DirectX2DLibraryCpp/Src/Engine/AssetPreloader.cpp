@@ -0,0 +1,354 @@
+﻿#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include "AssetPreloader.h"
+#include "Profiler.h"
+
+namespace
+{
+	/** @brief カウンタ値の差をミリ秒に変換する関数 */
+	float ConvertCounterToMilliseconds(LONGLONG count)
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		return (float)(count * 1000.0 / frequency.QuadPart);
+	}
+
+	/** @brief QueryPerformanceCounterの値の取得関数 */
+	LONGLONG GetCounter()
+	{
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter(&counter);
+		return counter.QuadPart;
+	}
+
+	/**
+	* @brief 空白文字の判定関数
+	* @retval true 空白、タブ、改行
+	* @retval false それ以外
+	* @param[in] c 文字
+	*/
+	bool IsSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	}
+
+	/**
+	* @brief 前後の空白の削除関数
+	* @retval std::string 空白を削除した文字列
+	* @param[in] begin 文字列の先頭
+	* @param[in] end 文字列の終端
+	*/
+	std::string Trim(const char* begin, const char* end)
+	{
+		while (begin < end && IsSpace(*begin) == true)
+		{
+			begin++;
+		}
+
+		while (end > begin && IsSpace(*(end - 1)) == true)
+		{
+			end--;
+		}
+
+		return std::string(begin, end);
+	}
+}
+
+bool AssetPreloader::Start(const char* manifest_file, JobSystem* job_system, Graphics* graphics, Sound* sound, PreloadProgressCallback callback, void* data)
+{
+	if (m_IsLoading == true)
+	{
+		return false;
+	}
+
+	FILE* fp = nullptr;
+	if (fopen_s(&fp, manifest_file, "rb") != 0 || fp == nullptr)
+	{
+		return false;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	if (size <= 0)
+	{
+		fclose(fp);
+		return false;
+	}
+
+	std::vector<char> manifest(size);
+	size_t read_size = fread(&manifest[0], 1, size, fp);
+	fclose(fp);
+
+	std::vector<PreloadEntry> entry_list;
+	if (read_size != (size_t)size ||
+		ParseManifest(&manifest[0], manifest.size(), &entry_list) == false)
+	{
+		return false;
+	}
+
+	m_EntryList.swap(entry_list);
+	m_JobSystem = job_system;
+	m_Graphics = graphics;
+	m_Sound = sound;
+	m_LoadedCount = 0;
+	m_Callback = callback;
+	m_CallbackData = data;
+	m_ReportedCount = -1;
+	m_IsLoading = true;
+	m_StartCounter = GetCounter();
+	m_DecodedCounter = 0;
+
+	m_Stats = PreloadStats();
+	m_Stats.TotalCount = (int)m_EntryList.size();
+	m_Stats.WorkerCount = job_system->GetWorkerCount();
+
+	// 分割をワーカーに任せて、このスレッドはすぐに戻る
+	m_JobSystem->Run(DecodeAllJob, this, &m_Counter, nullptr);
+
+	return true;
+}
+
+void AssetPreloader::Update(TextureManager* texture_manager)
+{
+	if (m_IsLoading == false)
+	{
+		return;
+	}
+
+	// ワーカースレッドがない場合はメインスレッドで待たないとデコードが進まない
+	if (m_JobSystem->GetWorkerCount() <= 1)
+	{
+		Wait(texture_manager);
+		return;
+	}
+
+	if (m_Counter.IsDone() == false)
+	{
+		ReportProgress((std::min)(m_LoadedCount.load(), (int)m_EntryList.size() - 1));
+		return;
+	}
+
+	Upload(texture_manager);
+}
+
+void AssetPreloader::Wait(TextureManager* texture_manager)
+{
+	if (m_IsLoading == false)
+	{
+		return;
+	}
+
+	m_JobSystem->Wait(&m_Counter);
+
+	Upload(texture_manager);
+}
+
+void AssetPreloader::Cancel()
+{
+	if (m_IsLoading == false)
+	{
+		return;
+	}
+
+	m_JobSystem->Wait(&m_Counter);
+
+	ClearEntries();
+	m_IsLoading = false;
+}
+
+bool AssetPreloader::ParseManifest(const char* data, size_t size, std::vector<PreloadEntry>* out_entry_list)
+{
+	const char* p = data;
+	const char* data_end = data + size;
+
+	// UTF-8のBOMは読み飛ばす
+	if (size >= 3 && memcmp(data, "\xEF\xBB\xBF", 3) == 0)
+	{
+		p += 3;
+	}
+
+	while (p < data_end)
+	{
+		const char* line = p;
+		while (p < data_end && *p != '\n')
+		{
+			p++;
+		}
+		const char* line_end = p;
+		if (p < data_end)
+		{
+			p++;
+		}
+
+		const char* comment = (const char*)memchr(line, '#', line_end - line);
+		if (comment != nullptr)
+		{
+			line_end = comment;
+		}
+
+		const char* first_comma = (const char*)memchr(line, ',', line_end - line);
+		if (first_comma == nullptr)
+		{
+			// 空行とコメントだけの行は読み飛ばす
+			if (Trim(line, line_end).empty() == true)
+			{
+				continue;
+			}
+			return false;
+		}
+
+		const char* second_comma = (const char*)memchr(first_comma + 1, ',', line_end - (first_comma + 1));
+		if (second_comma == nullptr)
+		{
+			return false;
+		}
+
+		PreloadEntry entry;
+		std::string type = Trim(line, first_comma);
+		if (type == "texture")
+		{
+			entry.Type = PreloadAssetType::Texture;
+		}
+		else if (type == "sound")
+		{
+			entry.Type = PreloadAssetType::Sound;
+		}
+		else
+		{
+			return false;
+		}
+
+		entry.Keyword = Trim(first_comma + 1, second_comma);
+		entry.FileName = Trim(second_comma + 1, line_end);
+		if (entry.Keyword.empty() == true || entry.FileName.empty() == true)
+		{
+			return false;
+		}
+
+		out_entry_list->push_back(entry);
+	}
+
+	return true;
+}
+
+void AssetPreloader::DecodeAllJob(void* data, int begin, int end)
+{
+	AssetPreloader* preloader = (AssetPreloader*)data;
+
+	// 1つのアセットのデコード時間はファイルによって大きく違うので、1つずつジョブにして空いたワーカーに盗ませる
+	preloader->m_JobSystem->ParallelFor(DecodeJob, preloader, (int)preloader->m_EntryList.size(), 1);
+
+	preloader->m_DecodedCounter = GetCounter();
+}
+
+void AssetPreloader::DecodeJob(void* data, int begin, int end)
+{
+	PROFILE_FUNCTION();
+
+	AssetPreloader* preloader = (AssetPreloader*)data;
+
+	for (int i = begin; i < end; i++)
+	{
+		PreloadEntry& entry = preloader->m_EntryList[i];
+
+		if (entry.Type == PreloadAssetType::Texture)
+		{
+			entry.IsDecoded = preloader->m_Graphics->DecodeTexture(entry.FileName.c_str(), &entry.Width, &entry.Height, &entry.Pixels, &entry.Content);
+		}
+		else
+		{
+			entry.IsDecoded = preloader->m_Sound->LoadWavFile(entry.FileName.c_str(), &entry.Wav);
+		}
+
+		preloader->m_LoadedCount++;
+	}
+}
+
+void AssetPreloader::Upload(TextureManager* texture_manager)
+{
+	PROFILE_FUNCTION();
+
+	LONGLONG upload_start = GetCounter();
+
+	for (PreloadEntry& entry : m_EntryList)
+	{
+		bool is_succeeded = false;
+
+		if (entry.Type == PreloadAssetType::Texture)
+		{
+			if (entry.IsDecoded == false)
+			{
+				// デコードに対応していない描画バックエンドでは通常の読み込みで作成する
+				is_succeeded = texture_manager->LoadTexture(entry.Keyword.c_str(), entry.FileName.c_str());
+			}
+			else
+			{
+				Texture texture = {};
+				if (m_Graphics->CreateTextureFromPixels(entry.Width, entry.Height, &entry.Pixels[0], &texture) == true)
+				{
+					is_succeeded = texture_manager->AddTexture(entry.Keyword.c_str(), entry.FileName.c_str(), texture, entry.Content);
+
+					// 登録済みのキーワードは先に読み込まれたテクスチャを使用する
+					if (is_succeeded == false)
+					{
+						texture_manager->GetLoader()->Unload(&texture);
+						is_succeeded = texture_manager->GetTexture(entry.Keyword.c_str()) != nullptr;
+					}
+				}
+			}
+
+			// 転送したテクセルはすぐに解放して、ピークのメモリを抑える
+			std::vector<DWORD>().swap(entry.Pixels);
+		}
+		else if (entry.IsDecoded == true)
+		{
+			is_succeeded = m_Sound->CreateSoundBuffer(entry.Keyword.c_str(), entry.Wav);
+
+			delete[] entry.Wav.SoundBuffer;
+			entry.Wav.SoundBuffer = nullptr;
+			entry.IsDecoded = false;
+		}
+
+		if (is_succeeded == false)
+		{
+			m_Stats.FailureCount++;
+		}
+	}
+
+	LONGLONG finish = GetCounter();
+	m_Stats.DecodeTime = ConvertCounterToMilliseconds(m_DecodedCounter.load() - m_StartCounter);
+	m_Stats.UploadTime = ConvertCounterToMilliseconds(finish - upload_start);
+	m_Stats.TotalTime = ConvertCounterToMilliseconds(finish - m_StartCounter);
+
+	ClearEntries();
+	m_IsLoading = false;
+
+	ReportProgress(m_Stats.TotalCount);
+}
+
+void AssetPreloader::ReportProgress(int loaded_count)
+{
+	if (m_Callback == nullptr || loaded_count == m_ReportedCount)
+	{
+		return;
+	}
+
+	m_ReportedCount = loaded_count;
+	m_Callback(m_CallbackData, loaded_count, m_Stats.TotalCount);
+}
+
+void AssetPreloader::ClearEntries()
+{
+	for (PreloadEntry& entry : m_EntryList)
+	{
+		if (entry.Type == PreloadAssetType::Sound && entry.IsDecoded == true)
+		{
+			delete[] entry.Wav.SoundBuffer;
+		}
+	}
+
+	std::vector<PreloadEntry>().swap(m_EntryList);
+}
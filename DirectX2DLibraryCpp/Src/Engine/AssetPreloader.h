@@ -0,0 +1,237 @@
+﻿/**
+* @file AssetPreloader.h
+* @brief <pre>
+* マニフェストに列挙したテクスチャとサウンドをまとめて読み込むクラスの宣言
+* ファイルの読み込みとデコードはジョブシステムのワーカースレッドで並列に行い、デバイスへの転送は最後にメインスレッドでまとめて行う
+* </pre>
+*/
+#ifndef ASSET_PRELOADER_H_
+#define ASSET_PRELOADER_H_
+
+#include <Windows.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include "Graphics.h"
+#include "JobSystem.h"
+#include "Sound.h"
+#include "TextureManager.h"
+
+/**
+* @brief 読み込みの進捗の通知関数
+* @details メインスレッドで呼ばれるので、ロード画面の更新などに使用できる
+* @param[in] data StartPreloadで指定したデータ
+* @param[in] loaded_count 読み込みが完了したアセットの数
+* @param[in] total_count マニフェストに列挙したアセットの数
+*/
+typedef void (*PreloadProgressCallback)(void* data, int loaded_count, int total_count);
+
+/** @brief アセットの種類 */
+enum class PreloadAssetType
+{
+	Texture,	//!< テクスチャ
+	Sound,		//!< サウンド
+};
+
+/** @brief マニフェストに列挙したアセット */
+struct PreloadEntry
+{
+	/** Constructor */
+	PreloadEntry() :
+		Type(PreloadAssetType::Texture),
+		Keyword(),
+		FileName(),
+		IsDecoded(false),
+		Width(0),
+		Height(0),
+		Pixels(),
+		Content(),
+		Wav()
+	{
+	}
+
+	PreloadAssetType Type;		//!< 種類
+	std::string Keyword;		//!< 登録用キーワード
+	std::string FileName;		//!< ファイル名
+	bool IsDecoded;				//!< デコードに成功したか
+	int Width;					//!< テクスチャの横幅
+	int Height;					//!< テクスチャの縦幅
+	std::vector<DWORD> Pixels;	//!< テクスチャのテクセル
+	FileContentHash Content;	//!< テクスチャのファイルの内容の識別情報(デコードした時に計算し、TextureManagerの共有に使用する)
+	WavData Wav;				//!< サウンドのWavデータ(SoundBufferは登録後に解放する)
+};
+
+/** @brief まとめて読み込んだ結果 */
+struct PreloadStats
+{
+	/** Constructor */
+	PreloadStats() :
+		TotalCount(0),
+		FailureCount(0),
+		WorkerCount(0),
+		DecodeTime(0.0f),
+		UploadTime(0.0f),
+		TotalTime(0.0f)
+	{
+	}
+
+	int TotalCount;		//!< マニフェストに列挙したアセットの数
+	int FailureCount;	//!< 読み込みに失敗したアセットの数
+	int WorkerCount;	//!< 読み込みに使用したワーカーの数(メインスレッドを含む)
+	float DecodeTime;	//!< 開始から全てのデコードが完了するまでの時間(ミリ秒)
+	float UploadTime;	//!< デバイスへの転送にかかった時間(ミリ秒)
+	float TotalTime;	//!< 開始から完了までの時間(ミリ秒)
+};
+
+/**
+* @brief アセットの一括読み込みクラス
+* @details <pre>
+* マニフェストは1行に「種類,キーワード,ファイル名」を記述したテキストファイル(種類はtextureかsound、#以降はコメント)
+*   texture,Enemy,Res/Enemy.png
+*   sound,Bgm,Res/Bgm.wav
+* テクスチャはGraphics::DecodeTexture、サウンドはSound::LoadWavFileでワーカースレッドでデコードする
+* 全てのデコードが完了したら、UpdateかWaitを実行したメインスレッドでテクスチャの作成とサウンドバッファの作成を行い、キーワードで登録する
+* デコードに対応していない描画バックエンドの場合、テクスチャは転送時にTextureManager::LoadTextureで読み込む
+* </pre>
+*/
+class AssetPreloader
+{
+public:
+	/** Constructor */
+	AssetPreloader() :
+		m_EntryList(),
+		m_JobSystem(nullptr),
+		m_Graphics(nullptr),
+		m_Sound(nullptr),
+		m_Counter(),
+		m_LoadedCount(0),
+		m_Callback(nullptr),
+		m_CallbackData(nullptr),
+		m_ReportedCount(-1),
+		m_IsLoading(false),
+		m_StartCounter(0),
+		m_DecodedCounter(0),
+		m_Stats()
+	{
+	}
+
+	/**
+	* @brief 開始関数
+	* @details マニフェストを読み込み、ワーカースレッドでデコードを開始する
+	* @retval true 開始成功
+	* @retval false 開始失敗(読み込み中、またはマニフェストを読み込めなかった)
+	* @param[in] manifest_file マニフェストのファイル名
+	* @param[in] job_system デコードに使用するジョブシステム
+	* @param[in] graphics テクスチャのデコードと作成に使用するクラス
+	* @param[in] sound サウンドのデコードと作成に使用するクラス
+	* @param[in] callback 進捗の通知関数(nullptrの場合は通知しない)
+	* @param[in] data 通知関数に渡すデータ
+	*/
+	bool Start(const char* manifest_file, JobSystem* job_system, Graphics* graphics, Sound* sound, PreloadProgressCallback callback, void* data);
+
+	/**
+	* @brief 読み込み中の確認関数
+	* @retval true 読み込み中
+	* @retval false 読み込んでいない、または完了した
+	*/
+	bool IsLoading() const
+	{
+		return m_IsLoading;
+	}
+
+	/**
+	* @brief 更新関数
+	* @details <pre>
+	* 進捗を通知し、全てのデコードが完了していたらテクスチャとサウンドを登録する
+	* メインスレッドで毎フレーム実行する
+	* </pre>
+	* @param[in] texture_manager テクスチャを登録するクラス
+	*/
+	void Update(TextureManager* texture_manager);
+
+	/**
+	* @brief 完了待ち関数
+	* @details 待機中はメインスレッドもデコードを行い、完了したらテクスチャとサウンドを登録する
+	* @param[in] texture_manager テクスチャを登録するクラス
+	*/
+	void Wait(TextureManager* texture_manager);
+
+	/**
+	* @brief 中止関数
+	* @details 実行中のデコードが終わるのを待ち、登録していないデータを破棄する
+	*/
+	void Cancel();
+
+	/**
+	* @brief 結果の取得関数
+	* @retval const PreloadStats& 最後に完了した読み込みの結果
+	*/
+	const PreloadStats& GetStats() const
+	{
+		return m_Stats;
+	}
+
+	/**
+	* @brief マニフェストの解析関数
+	* @retval true 解析成功
+	* @retval false 記述が不正
+	* @param[in] data マニフェストの内容
+	* @param[in] size マニフェストのバイト数
+	* @param[out] out_entry_list 列挙されたアセット
+	*/
+	static bool ParseManifest(const char* data, size_t size, std::vector<PreloadEntry>* out_entry_list);
+
+private:
+	/**
+	* @brief デコード全体のジョブ関数
+	* @details ParallelForでアセットごとのデコードを分割し、メインスレッドを止めずに待機する
+	* @param[in] data AssetPreloader
+	* @param[in] begin 未使用
+	* @param[in] end 未使用
+	*/
+	static void DecodeAllJob(void* data, int begin, int end);
+
+	/**
+	* @brief デコードのジョブ関数
+	* @param[in] data AssetPreloader
+	* @param[in] begin デコードするアセットの先頭
+	* @param[in] end デコードするアセットの終端
+	*/
+	static void DecodeJob(void* data, int begin, int end);
+
+	/**
+	* @brief 転送関数
+	* @details デコードしたテクスチャとサウンドをデバイスに送って登録し、読み込みを完了する
+	* @param[in] texture_manager テクスチャを登録するクラス
+	*/
+	void Upload(TextureManager* texture_manager);
+
+	/**
+	* @brief 進捗の通知関数
+	* @details 前回の通知から読み込み完了数が変わっている場合だけ通知する
+	* @param[in] loaded_count 読み込みが完了したアセットの数
+	*/
+	void ReportProgress(int loaded_count);
+
+	/**
+	* @brief デコード結果の破棄関数
+	*/
+	void ClearEntries();
+
+private:
+	std::vector<PreloadEntry> m_EntryList;		//!< 読み込むアセット
+	JobSystem* m_JobSystem;						//!< デコードに使用するジョブシステム
+	Graphics* m_Graphics;						//!< テクスチャのデコードと作成に使用するクラス
+	Sound* m_Sound;								//!< サウンドのデコードと作成に使用するクラス
+	JobCounter m_Counter;						//!< デコード全体のジョブのカウンター
+	std::atomic<int> m_LoadedCount;				//!< デコードが完了したアセットの数
+	PreloadProgressCallback m_Callback;			//!< 進捗の通知関数
+	void* m_CallbackData;						//!< 通知関数に渡すデータ
+	int m_ReportedCount;						//!< 最後に通知した読み込み完了数
+	bool m_IsLoading;							//!< 読み込み中フラグ
+	LONGLONG m_StartCounter;					//!< 開始時のカウンタ値
+	std::atomic<LONGLONG> m_DecodedCounter;		//!< 全てのデコードが完了した時のカウンタ値
+	PreloadStats m_Stats;						//!< 最後に完了した読み込みの結果
+};
+
+#endif
@@ -0,0 +1,573 @@
+﻿#include <algorithm>
+#include <string.h>
+#include "BitmapFont.h"
+
+namespace
+{
+	/** @brief 解析中のchar行の値 */
+	struct BitmapCharDefinition
+	{
+		unsigned int Id;
+		int X;
+		int Y;
+		int Width;
+		int Height;
+		int OffsetX;
+		int OffsetY;
+		int Advance;
+		int Page;
+	};
+
+	/**
+	* @brief 空白文字の判定関数
+	* @retval true 空白またはタブ
+	* @retval false それ以外
+	* @param[in] c 文字
+	*/
+	bool IsBlank(char c)
+	{
+		return c == ' ' || c == '\t';
+	}
+
+	/**
+	* @brief 属性の検索関数
+	* @details <pre>
+	* 1行の中から「key=value」形式の属性を探す
+	* valueがダブルクォートで囲まれている場合は囲まれた中身を返す
+	* </pre>
+	* @retval true 見つかった
+	* @retval false 見つからなかった
+	* @param[in] line 行の先頭
+	* @param[in] line_end 行の終端
+	* @param[in] key 属性名
+	* @param[out] out_value 値の先頭
+	* @param[out] out_value_end 値の終端
+	*/
+	bool FindAttribute(const char* line, const char* line_end, const char* key, const char** out_value, const char** out_value_end)
+	{
+		size_t key_length = strlen(key);
+		const char* p = line;
+
+		while (p < line_end)
+		{
+			// 属性の先頭まで進める
+			while (p < line_end && IsBlank(*p) == true)
+			{
+				p++;
+			}
+
+			const char* name = p;
+			while (p < line_end && *p != '=' && IsBlank(*p) == false)
+			{
+				p++;
+			}
+			const char* name_end = p;
+
+			if (p >= line_end || *p != '=')
+			{
+				// 値のない単語(行の種類など)は読み飛ばす
+				continue;
+			}
+			p++;
+
+			const char* value = p;
+			const char* value_end = nullptr;
+			if (p < line_end && *p == '"')
+			{
+				value = ++p;
+				while (p < line_end && *p != '"')
+				{
+					p++;
+				}
+				value_end = p;
+				if (p < line_end)
+				{
+					p++;
+				}
+			}
+			else
+			{
+				while (p < line_end && IsBlank(*p) == false)
+				{
+					p++;
+				}
+				value_end = p;
+			}
+
+			if ((size_t)(name_end - name) == key_length && strncmp(name, key, key_length) == 0)
+			{
+				*out_value = value;
+				*out_value_end = value_end;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	* @brief 整数の属性の取得関数
+	* @retval true 取得成功
+	* @retval false 属性がない、または整数ではない
+	* @param[in] line 行の先頭
+	* @param[in] line_end 行の終端
+	* @param[in] key 属性名
+	* @param[out] out_value 値
+	*/
+	bool ReadIntAttribute(const char* line, const char* line_end, const char* key, int* out_value)
+	{
+		const char* value = nullptr;
+		const char* value_end = nullptr;
+		if (FindAttribute(line, line_end, key, &value, &value_end) == false)
+		{
+			return false;
+		}
+
+		bool is_negative = false;
+		if (value < value_end && *value == '-')
+		{
+			is_negative = true;
+			value++;
+		}
+
+		if (value >= value_end || *value < '0' || *value > '9')
+		{
+			return false;
+		}
+
+		int result = 0;
+		while (value < value_end && *value >= '0' && *value <= '9')
+		{
+			result = result * 10 + (*value - '0');
+			value++;
+		}
+
+		*out_value = is_negative == true ? -result : result;
+		return true;
+	}
+
+	/**
+	* @brief 行の種類の判定関数
+	* @retval true 行の先頭の単語がtagと一致する
+	* @retval false 一致しない
+	* @param[in] line 行の先頭
+	* @param[in] line_end 行の終端
+	* @param[in] tag 行の種類
+	*/
+	bool IsLineTag(const char* line, const char* line_end, const char* tag)
+	{
+		size_t tag_length = strlen(tag);
+		if ((size_t)(line_end - line) < tag_length || strncmp(line, tag, tag_length) != 0)
+		{
+			return false;
+		}
+
+		return line + tag_length == line_end || IsBlank(line[tag_length]) == true;
+	}
+
+	/**
+	* @brief カーニングの並び替え用の比較関数
+	*/
+	bool CompareKerning(const BitmapKerning& a, const BitmapKerning& b)
+	{
+		return a.Key < b.Key;
+	}
+
+	/**
+	* @brief カーニングの重複判定用の比較関数
+	*/
+	bool IsSameKerningKey(const BitmapKerning& a, const BitmapKerning& b)
+	{
+		return a.Key == b.Key;
+	}
+
+	/**
+	* @brief カーニングのキーの作成関数
+	* @retval unsigned int キー
+	* @param[in] first 前の文字コード
+	* @param[in] second 次の文字コード
+	*/
+	unsigned int MakeKerningKey(unsigned int first, unsigned int second)
+	{
+		return (first << 16) | second;
+	}
+}
+
+bool BitmapFont::Parse(const char* data, size_t size)
+{
+	Clear();
+
+	if (data == nullptr)
+	{
+		return false;
+	}
+
+	bool has_common = false;
+	int page_count = 0;
+	std::vector<BitmapCharDefinition> char_list;
+
+	const char* p = data;
+	const char* data_end = data + size;
+
+	while (p < data_end)
+	{
+		const char* line = p;
+		while (p < data_end && *p != '\n' && *p != '\r')
+		{
+			p++;
+		}
+		const char* line_end = p;
+		while (p < data_end && (*p == '\n' || *p == '\r'))
+		{
+			p++;
+		}
+
+		while (line < line_end && IsBlank(*line) == true)
+		{
+			line++;
+		}
+
+		if (IsLineTag(line, line_end, "common") == true)
+		{
+			if (ReadIntAttribute(line, line_end, "lineHeight", &m_LineHeight) == false ||
+				ReadIntAttribute(line, line_end, "base", &m_Base) == false ||
+				ReadIntAttribute(line, line_end, "scaleW", &m_TextureWidth) == false ||
+				ReadIntAttribute(line, line_end, "scaleH", &m_TextureHeight) == false ||
+				ReadIntAttribute(line, line_end, "pages", &page_count) == false)
+			{
+				Clear();
+				return false;
+			}
+			has_common = true;
+		}
+		else if (IsLineTag(line, line_end, "page") == true)
+		{
+			int id = 0;
+			const char* file = nullptr;
+			const char* file_end = nullptr;
+			if (ReadIntAttribute(line, line_end, "id", &id) == false ||
+				id < 0 || id >= MaxBitmapFontPageCount ||
+				FindAttribute(line, line_end, "file", &file, &file_end) == false)
+			{
+				Clear();
+				return false;
+			}
+
+			if ((int)m_PageFileList.size() <= id)
+			{
+				m_PageFileList.resize(id + 1);
+			}
+			m_PageFileList[id].assign(file, file_end);
+		}
+		else if (IsLineTag(line, line_end, "char") == true)
+		{
+			int id = 0;
+			BitmapCharDefinition definition;
+			if (ReadIntAttribute(line, line_end, "id", &id) == false ||
+				ReadIntAttribute(line, line_end, "x", &definition.X) == false ||
+				ReadIntAttribute(line, line_end, "y", &definition.Y) == false ||
+				ReadIntAttribute(line, line_end, "width", &definition.Width) == false ||
+				ReadIntAttribute(line, line_end, "height", &definition.Height) == false ||
+				ReadIntAttribute(line, line_end, "xoffset", &definition.OffsetX) == false ||
+				ReadIntAttribute(line, line_end, "yoffset", &definition.OffsetY) == false ||
+				ReadIntAttribute(line, line_end, "xadvance", &definition.Advance) == false)
+			{
+				Clear();
+				return false;
+			}
+
+			// ページが1つのフォントではpageが省略されることがある
+			if (ReadIntAttribute(line, line_end, "page", &definition.Page) == false)
+			{
+				definition.Page = 0;
+			}
+
+			// テーブルに登録できない文字コードは無視する
+			if (id < 0 || (unsigned int)id > MaxBitmapFontCodepoint)
+			{
+				continue;
+			}
+			definition.Id = (unsigned int)id;
+			char_list.push_back(definition);
+		}
+		else if (IsLineTag(line, line_end, "kerning") == true)
+		{
+			int first = 0;
+			int second = 0;
+			int amount = 0;
+			if (ReadIntAttribute(line, line_end, "first", &first) == false ||
+				ReadIntAttribute(line, line_end, "second", &second) == false ||
+				ReadIntAttribute(line, line_end, "amount", &amount) == false)
+			{
+				Clear();
+				return false;
+			}
+
+			if (first < 0 || (unsigned int)first > MaxBitmapFontCodepoint ||
+				second < 0 || (unsigned int)second > MaxBitmapFontCodepoint ||
+				amount == 0)
+			{
+				continue;
+			}
+
+			BitmapKerning kerning = { MakeKerningKey(first, second), amount };
+			m_KerningList.push_back(kerning);
+		}
+	}
+
+	if (has_common == false ||
+		m_TextureWidth <= 0 || m_TextureHeight <= 0 ||
+		page_count <= 0 || page_count > MaxBitmapFontPageCount ||
+		(int)m_PageFileList.size() != page_count)
+	{
+		Clear();
+		return false;
+	}
+
+	for (const std::string& file : m_PageFileList)
+	{
+		if (file.empty() == true)
+		{
+			Clear();
+			return false;
+		}
+	}
+
+	unsigned int max_id = 0;
+	for (const BitmapCharDefinition& definition : char_list)
+	{
+		if (definition.Page < 0 || definition.Page >= page_count)
+		{
+			Clear();
+			return false;
+		}
+		max_id = (std::max)(max_id, definition.Id);
+	}
+
+	// 描画時に文字コードで直接引けるように、最大の文字コードまでのテーブルを作成する
+	BitmapGlyph empty_glyph = {};
+	m_GlyphTable.assign(char_list.empty() == true ? 0 : max_id + 1, empty_glyph);
+
+	float inv_width = 1.0f / m_TextureWidth;
+	float inv_height = 1.0f / m_TextureHeight;
+
+	for (const BitmapCharDefinition& definition : char_list)
+	{
+		BitmapGlyph& glyph = m_GlyphTable[definition.Id];
+		glyph.U0 = definition.X * inv_width;
+		glyph.V0 = definition.Y * inv_height;
+		glyph.U1 = (definition.X + definition.Width) * inv_width;
+		glyph.V1 = (definition.Y + definition.Height) * inv_height;
+		glyph.Width = (short)definition.Width;
+		glyph.Height = (short)definition.Height;
+		glyph.OffsetX = (short)definition.OffsetX;
+		glyph.OffsetY = (short)definition.OffsetY;
+		glyph.Advance = (short)definition.Advance;
+		glyph.Page = (unsigned char)definition.Page;
+		glyph.IsValid = true;
+	}
+
+	// 同じ組み合わせが複数ある場合は先に記述されたものを使用する
+	std::stable_sort(m_KerningList.begin(), m_KerningList.end(), CompareKerning);
+	auto last = std::unique(m_KerningList.begin(), m_KerningList.end(), IsSameKerningKey);
+	m_KerningList.erase(last, m_KerningList.end());
+
+	return true;
+}
+
+void BitmapFont::Clear()
+{
+	m_GlyphTable.clear();
+	m_KerningList.clear();
+	m_PageFileList.clear();
+	m_LineHeight = 0;
+	m_Base = 0;
+	m_TextureWidth = 0;
+	m_TextureHeight = 0;
+}
+
+int BitmapFont::GetKerning(unsigned int first, unsigned int second) const
+{
+	if (m_KerningList.empty() == true)
+	{
+		return 0;
+	}
+
+	BitmapKerning target = { MakeKerningKey(first, second), 0 };
+	auto itr = std::lower_bound(m_KerningList.begin(), m_KerningList.end(), target, CompareKerning);
+	if (itr == m_KerningList.end() || itr->Key != target.Key)
+	{
+		return 0;
+	}
+
+	return itr->Amount;
+}
+
+void BitmapFont::BeginLayout(const char* text, float x, float y, float scale, BitmapFontCursor* out_cursor) const
+{
+	out_cursor->Text = text;
+	out_cursor->PenX = x;
+	out_cursor->PenY = y;
+	out_cursor->LineX = x;
+	out_cursor->Scale = scale;
+	out_cursor->PrevCode = 0;
+}
+
+bool BitmapFont::NextQuad(BitmapFontCursor* cursor, BitmapGlyphQuad* out_quad) const
+{
+	while (true)
+	{
+		unsigned int code = DecodeUtf8(&cursor->Text);
+		if (code == 0)
+		{
+			return false;
+		}
+
+		if (code == '\n')
+		{
+			cursor->PenX = cursor->LineX;
+			cursor->PenY += m_LineHeight * cursor->Scale;
+			cursor->PrevCode = 0;
+			continue;
+		}
+		else if (code == '\r')
+		{
+			continue;
+		}
+
+		const BitmapGlyph* glyph = FindGlyph(code);
+		if (glyph == nullptr)
+		{
+			cursor->PrevCode = 0;
+			continue;
+		}
+
+		if (cursor->PrevCode != 0)
+		{
+			cursor->PenX += GetKerning(cursor->PrevCode, code) * cursor->Scale;
+		}
+		cursor->PrevCode = code;
+
+		float left = cursor->PenX + glyph->OffsetX * cursor->Scale;
+		float top = cursor->PenY + glyph->OffsetY * cursor->Scale;
+		cursor->PenX += glyph->Advance * cursor->Scale;
+
+		if (glyph->Width == 0 || glyph->Height == 0)
+		{
+			continue;
+		}
+
+		out_quad->Left = left;
+		out_quad->Top = top;
+		out_quad->Right = left + glyph->Width * cursor->Scale;
+		out_quad->Bottom = top + glyph->Height * cursor->Scale;
+		out_quad->Glyph = glyph;
+		return true;
+	}
+}
+
+void BitmapFont::MeasureText(const char* text, float scale, float* out_width, float* out_height) const
+{
+	float max_width = 0.0f;
+	float pen_x = 0.0f;
+	int line_count = 1;
+	unsigned int prev_code = 0;
+
+	while (true)
+	{
+		unsigned int code = DecodeUtf8(&text);
+		if (code == 0)
+		{
+			break;
+		}
+
+		if (code == '\n')
+		{
+			max_width = (std::max)(max_width, pen_x);
+			pen_x = 0.0f;
+			line_count++;
+			prev_code = 0;
+			continue;
+		}
+		else if (code == '\r')
+		{
+			continue;
+		}
+
+		const BitmapGlyph* glyph = FindGlyph(code);
+		if (glyph == nullptr)
+		{
+			prev_code = 0;
+			continue;
+		}
+
+		if (prev_code != 0)
+		{
+			pen_x += GetKerning(prev_code, code) * scale;
+		}
+		prev_code = code;
+
+		pen_x += glyph->Advance * scale;
+	}
+
+	*out_width = (std::max)(max_width, pen_x);
+	*out_height = line_count * m_LineHeight * scale;
+}
+
+unsigned int BitmapFont::DecodeUtf8(const char** text)
+{
+	const unsigned char* p = (const unsigned char*)*text;
+	if (p[0] == 0)
+	{
+		return 0;
+	}
+
+	if (p[0] < 0x80)
+	{
+		*text += 1;
+		return p[0];
+	}
+
+	int length = 0;
+	unsigned int code = 0;
+	unsigned int min_code = 0;
+	if (p[0] >= 0xC2 && p[0] <= 0xDF)
+	{
+		length = 2;
+		code = p[0] & 0x1F;
+		min_code = 0x80;
+	}
+	else if (p[0] >= 0xE0 && p[0] <= 0xEF)
+	{
+		length = 3;
+		code = p[0] & 0x0F;
+		min_code = 0x800;
+	}
+	else if (p[0] >= 0xF0 && p[0] <= 0xF4)
+	{
+		length = 4;
+		code = p[0] & 0x07;
+		min_code = 0x10000;
+	}
+
+	// 終端(0)は継続バイトの条件を満たさないので文字列の外は読まない
+	bool is_valid = length > 0;
+	for (int i = 1; i < length && is_valid == true; i++)
+	{
+		if ((p[i] & 0xC0) != 0x80)
+		{
+			is_valid = false;
+			break;
+		}
+		code = (code << 6) | (p[i] & 0x3F);
+	}
+
+	if (is_valid == false || code < min_code || code > 0x10FFFF)
+	{
+		*text += 1;
+		return 0xFFFD;
+	}
+
+	*text += length;
+	return code;
+}
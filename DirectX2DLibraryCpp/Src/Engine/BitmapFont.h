@@ -0,0 +1,213 @@
+﻿/**
+* @file BitmapFont.h
+* @brief <pre>
+* BMFont(AngelCode Bitmap Font Generator)形式のフォント定義の解析と文字配置を行うクラスの宣言
+* テクスチャを扱わないのでDirectXやWindowsに依存せず、解析と配置の処理は単体で確認できる
+* テクスチャの読み込みと描画はBitmapFontManager、Graphicsクラスで行う
+* </pre>
+*/
+#ifndef BITMAP_FONT_H_
+#define BITMAP_FONT_H_
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+const int MaxBitmapFontPageCount = 16;					//!< 1つのフォントで使用できるページ(テクスチャ)の最大数
+const unsigned int MaxBitmapFontCodepoint = 0xFFFF;		//!< グリフテーブルに登録できる最大の文字コード
+
+/** @brief ビットマップフォントのグリフ */
+struct BitmapGlyph
+{
+	float U0;				//!< テクスチャ座標(左)
+	float V0;				//!< テクスチャ座標(上)
+	float U1;				//!< テクスチャ座標(右)
+	float V1;				//!< テクスチャ座標(下)
+	short Width;			//!< グリフの横幅(ピクセル)
+	short Height;			//!< グリフの縦幅(ピクセル)
+	short OffsetX;			//!< 描画位置からグリフの左端までの距離
+	short OffsetY;			//!< 行の上端からグリフの上端までの距離
+	short Advance;			//!< 次の文字までの距離
+	unsigned char Page;		//!< グリフがあるページ番号
+	bool IsValid;			//!< フォントに含まれている文字か
+};
+
+/** @brief カーニング(文字の組み合わせごとの間隔の補正) */
+struct BitmapKerning
+{
+	unsigned int Key;		//!< 前の文字コード(上位16bit)と次の文字コード(下位16bit)
+	int Amount;				//!< 次の文字の描画位置の補正量
+};
+
+/** @brief 文字配置の途中状態 */
+struct BitmapFontCursor
+{
+	const char* Text;		//!< 次に配置する文字の位置
+	float PenX;				//!< 描画位置X
+	float PenY;				//!< 行の上端Y
+	float LineX;			//!< 行の先頭X
+	float Scale;			//!< 拡大率
+	unsigned int PrevCode;	//!< 直前に配置した文字コード(行頭の場合は0)
+};
+
+/** @brief 配置したグリフの矩形 */
+struct BitmapGlyphQuad
+{
+	float Left;				//!< 左端
+	float Top;				//!< 上端
+	float Right;			//!< 右端
+	float Bottom;			//!< 下端
+	const BitmapGlyph* Glyph;	//!< グリフ(テクスチャ座標とページ番号)
+};
+
+/**
+* @brief ビットマップフォントクラス
+* @details <pre>
+* グリフは文字コードを添字とする配列で、カーニングはキーでソートした配列で保持するので、
+* 描画時の検索でメモリ確保は行わない
+* 対応しているのはテキスト形式(.fnt)のフォント定義のみ
+* 文字列はUTF-8として扱う(ASCIIの範囲はそのまま使用できる)
+* </pre>
+*/
+class BitmapFont
+{
+public:
+	/** Constructor */
+	BitmapFont() :
+		m_GlyphTable(),
+		m_KerningList(),
+		m_PageFileList(),
+		m_LineHeight(0),
+		m_Base(0),
+		m_TextureWidth(0),
+		m_TextureHeight(0)
+	{
+	}
+
+	/**
+	* @brief フォント定義の解析関数
+	* @details テキスト形式(.fnt)のフォント定義を解析してグリフとカーニングを登録する
+	* @retval true 解析成功
+	* @retval false 解析失敗(common行がない、ページ数やグリフのページ番号が不正)
+	* @param[in] data フォント定義の内容
+	* @param[in] size dataのバイト数
+	*/
+	bool Parse(const char* data, size_t size);
+
+	/**
+	* @brief 解放関数
+	*/
+	void Clear();
+
+	/**
+	* @brief グリフの取得関数
+	* @retval const BitmapGlyph* グリフ(フォントに含まれていない場合はnullptr)
+	* @param[in] code 文字コード
+	*/
+	const BitmapGlyph* FindGlyph(unsigned int code) const
+	{
+		if (code >= m_GlyphTable.size() || m_GlyphTable[code].IsValid == false)
+		{
+			return nullptr;
+		}
+
+		return &m_GlyphTable[code];
+	}
+
+	/**
+	* @brief カーニングの取得関数
+	* @details 二分探索で検索する
+	* @retval int 次の文字の描画位置の補正量(組み合わせが登録されていない場合は0)
+	* @param[in] first 前の文字コード
+	* @param[in] second 次の文字コード
+	*/
+	int GetKerning(unsigned int first, unsigned int second) const;
+
+	/**
+	* @brief 文字配置の開始関数
+	* @param[in] text 配置する文字列(UTF-8、改行対応)
+	* @param[in] x 描画座標X
+	* @param[in] y 描画座標Y
+	* @param[in] scale 拡大率
+	* @param[out] out_cursor 配置の途中状態
+	*/
+	void BeginLayout(const char* text, float x, float y, float scale, BitmapFontCursor* out_cursor) const;
+
+	/**
+	* @brief 次の文字の配置関数
+	* @details <pre>
+	* 文字列を先頭から1文字ずつ配置し、描画するピクセルがあるグリフの矩形を返す
+	* 空白やフォントに含まれない文字は矩形を返さずに読み進める
+	* </pre>
+	* @retval true 矩形を取得した
+	* @retval false 文字列の終端に到達した
+	* @param[in,out] cursor 配置の途中状態
+	* @param[out] out_quad 配置したグリフの矩形
+	*/
+	bool NextQuad(BitmapFontCursor* cursor, BitmapGlyphQuad* out_quad) const;
+
+	/**
+	* @brief 文字列のサイズ計算関数
+	* @param[in] text 文字列(UTF-8、改行対応)
+	* @param[in] scale 拡大率
+	* @param[out] out_width 最も長い行の横幅
+	* @param[out] out_height 行数分の縦幅
+	*/
+	void MeasureText(const char* text, float scale, float* out_width, float* out_height) const;
+
+	/**
+	* @brief ページ数の取得関数
+	* @retval int ページ数
+	*/
+	int GetPageCount() const
+	{
+		return (int)m_PageFileList.size();
+	}
+
+	/**
+	* @brief ページのファイル名の取得関数
+	* @retval const char* フォント定義に記述されたファイル名(フォント定義からの相対パス)
+	* @param[in] page ページ番号
+	*/
+	const char* GetPageFileName(int page) const
+	{
+		return m_PageFileList[page].c_str();
+	}
+
+	/**
+	* @brief 行の高さの取得関数
+	* @retval int 行の高さ(ピクセル)
+	*/
+	int GetLineHeight() const
+	{
+		return m_LineHeight;
+	}
+
+	/**
+	* @brief ベースラインの取得関数
+	* @retval int 行の上端からベースラインまでの距離(ピクセル)
+	*/
+	int GetBase() const
+	{
+		return m_Base;
+	}
+
+	/**
+	* @brief UTF-8の1文字読み込み関数
+	* @details 不正なバイト列は1バイトずつ読み飛ばし、U+FFFDとして返す
+	* @retval unsigned int 文字コード(終端の場合は0)
+	* @param[in,out] text 読み込み位置(読み込んだ文字の次に進む)
+	*/
+	static unsigned int DecodeUtf8(const char** text);
+
+private:
+	std::vector<BitmapGlyph> m_GlyphTable;		//!< 文字コードを添字とするグリフ
+	std::vector<BitmapKerning> m_KerningList;	//!< Keyの昇順に並んだカーニング
+	std::vector<std::string> m_PageFileList;	//!< ページのファイル名
+	int m_LineHeight;							//!< 行の高さ
+	int m_Base;									//!< 行の上端からベースラインまでの距離
+	int m_TextureWidth;							//!< ページの横幅
+	int m_TextureHeight;						//!< ページの縦幅
+};
+
+#endif
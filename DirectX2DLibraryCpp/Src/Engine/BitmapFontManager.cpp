@@ -0,0 +1,163 @@
+﻿#include <stdio.h>
+#include <string>
+#include <vector>
+#include "BitmapFontManager.h"
+#include "Engine.h"
+
+namespace
+{
+	/**
+	* @brief ファイル読み込み関数
+	* @retval true 読み込み成功
+	* @retval false 読み込み失敗
+	* @param[in] file_name ファイル名
+	* @param[out] out_data 読み込んだ内容
+	*/
+	bool ReadFile(const char* file_name, std::vector<char>* out_data)
+	{
+		FILE* fp = nullptr;
+		if (fopen_s(&fp, file_name, "rb") != 0 || fp == nullptr)
+		{
+			return false;
+		}
+
+		fseek(fp, 0, SEEK_END);
+		long size = ftell(fp);
+		fseek(fp, 0, SEEK_SET);
+
+		if (size <= 0)
+		{
+			fclose(fp);
+			return false;
+		}
+
+		out_data->resize(size);
+		size_t read_size = fread(&(*out_data)[0], 1, size, fp);
+		fclose(fp);
+
+		return read_size == (size_t)size;
+	}
+}
+
+void BitmapFontManager::Initialize()
+{
+	m_FontList.clear();
+}
+
+void BitmapFontManager::Release()
+{
+	ReleaseAllBitmapFonts();
+}
+
+bool BitmapFontManager::LoadBitmapFont(const char* keyword, const char* file_name)
+{
+	if (file_name == nullptr ||
+		keyword == nullptr)
+	{
+		return false;
+	}
+
+	if (m_FontList.count(keyword) > 0)
+	{
+		return true;
+	}
+
+	std::vector<char> data;
+	if (ReadFile(file_name, &data) == false)
+	{
+		return false;
+	}
+
+	BitmapFontData& font_data = m_FontList[keyword];
+	font_data.PageCount = 0;
+
+	if (font_data.Font.Parse(&data[0], data.size()) == false)
+	{
+		m_FontList.erase(keyword);
+		return false;
+	}
+
+	// ページのファイル名はフォント定義からの相対パスで記述されている
+	std::string directory = file_name;
+	size_t separator = directory.find_last_of("/\\");
+	directory = separator == std::string::npos ? "" : directory.substr(0, separator + 1);
+
+	for (int i = 0; i < font_data.Font.GetPageCount(); i++)
+	{
+		std::string page_file = directory + font_data.Font.GetPageFileName(i);
+		if (Engine::CreateTexture(page_file.c_str(), &font_data.Pages[i]) == false)
+		{
+			ReleasePages(&font_data);
+			m_FontList.erase(keyword);
+			return false;
+		}
+		font_data.PageCount++;
+	}
+
+	return true;
+}
+
+void BitmapFontManager::ReleaseAllBitmapFonts()
+{
+	for (auto& font : m_FontList)
+	{
+		ReleasePages(&font.second);
+	}
+
+	m_FontList.clear();
+}
+
+void BitmapFontManager::ReleaseBitmapFont(const char* keyword)
+{
+	if (m_FontList.count(keyword) > 0)
+	{
+		ReleasePages(&m_FontList[keyword]);
+		m_FontList.erase(keyword);
+	}
+}
+
+const BitmapFontData* BitmapFontManager::GetBitmapFont(const char* keyword)
+{
+	auto itr = m_FontList.find(keyword);
+	if (itr == m_FontList.end())
+	{
+		return nullptr;
+	}
+
+	return &itr->second;
+}
+
+unsigned int BitmapFontManager::GetTextureMemorySize()
+{
+	unsigned int size = 0;
+
+	for (auto& font : m_FontList)
+	{
+		for (int i = 0; i < font.second.PageCount; i++)
+		{
+			if (font.second.Pages[i].TextureData == nullptr)
+			{
+				continue;
+			}
+
+			size += font.second.Pages[i].Width * font.second.Pages[i].Height * 4;
+		}
+	}
+
+	return size;
+}
+
+void BitmapFontManager::ReleasePages(BitmapFontData* font_data)
+{
+	// Null描画バックエンドではテクスチャデータが作成されないのでnullptrの場合がある
+	for (int i = 0; i < font_data->PageCount; i++)
+	{
+		if (font_data->Pages[i].TextureData != nullptr)
+		{
+			font_data->Pages[i].TextureData->Release();
+			font_data->Pages[i].TextureData = nullptr;
+		}
+	}
+
+	font_data->PageCount = 0;
+}
@@ -0,0 +1,92 @@
+﻿/**
+* @file BitmapFontManager.h
+* @brief <pre>
+* ビットマップフォントの読み込み、解放などの管理を行うクラスの宣言
+* Engineクラスでインスタンスを作成するので使用者が作成する必要はない
+* BitmapFontManagerクラスの関数はEngineクラス、またはEngine内で使用するため、利用者が直接使用しない
+* </pre>
+*/
+#ifndef BITMAP_FONT_MANAGER_H_
+#define BITMAP_FONT_MANAGER_H_
+
+#include <map>
+#include "BitmapFont.h"
+#include "EngineConstant.h"
+
+/** @brief 読み込んだビットマップフォント */
+struct BitmapFontData
+{
+	BitmapFont Font;							//!< フォント定義
+	Texture Pages[MaxBitmapFontPageCount];		//!< ページのテクスチャ
+	int PageCount;								//!< ページ数
+};
+
+/** @brief ビットマップフォントの管理クラス */
+class BitmapFontManager
+{
+public:
+	/**
+	* @brief 初期化関数
+	* @details ゲームで使用するフォントデータを保存出来るようにする
+	*/
+	void Initialize();
+
+	/**
+	* @brief 解放関数
+	* @details このクラスで管理しているデータを解放する
+	*/
+	void Release();
+
+	/**
+	* @brief フォント読み込み関数
+	* @details <pre>
+	* 指定されたフォント定義(.fnt)とページのテクスチャを読み込み、keywordの文字列で登録する
+	* ページのテクスチャはフォント定義と同じフォルダから読み込む
+	* </pre>
+	* @retval true 読み込み成功
+	* @retval false 読み込み失敗
+	* @param[in] keyword 登録用キーワード
+	* @param[in] file_name 読み込むフォント定義のファイル名(パス込み)
+	*/
+	bool LoadBitmapFont(const char* keyword, const char* file_name);
+
+	/**
+	* @brief フォント全解放関数
+	* @details 読み込んでいるすべてのフォントを解放する
+	*/
+	void ReleaseAllBitmapFonts();
+
+	/**
+	* @brief フォント解放関数
+	* @details 指定されたキーワードのフォントを解放する
+	* @param[in] keyword 解放するフォントのキーワード
+	*/
+	void ReleaseBitmapFont(const char* keyword);
+
+	/**
+	* @brief フォントデータの取得関数
+	* @details 指定されたキーワードのフォントデータを取得する
+	* @retval const BitmapFontData* フォントデータ(取得失敗時はnullptr)
+	* @param[in] keyword 取得したいフォントのキーワード
+	*/
+	const BitmapFontData* GetBitmapFont(const char* keyword);
+
+	/**
+	* @brief フォントのテクスチャ使用メモリの取得関数
+	* @details 読み込んでいるページのテクスチャの使用メモリを1ピクセル4バイトとして計算して返す
+	* @retval unsigned int 使用メモリ(バイト)
+	*/
+	unsigned int GetTextureMemorySize();
+
+private:
+	/**
+	* @brief ページのテクスチャ解放関数
+	* @param[in] font_data 解放するフォントデータ
+	*/
+	void ReleasePages(BitmapFontData* font_data);
+
+private:
+	std::map<const char*, BitmapFontData> m_FontList;	//!< フォントリスト
+};
+
+#endif
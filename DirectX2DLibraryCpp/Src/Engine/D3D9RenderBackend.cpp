@@ -0,0 +1,483 @@
+﻿#include <string.h>
+#include "Window.h"
+#include "D3D9RenderBackend.h"
+#include "MipmapGenerator.h"
+
+// 静的ライブラリ
+#pragma comment(lib, "d3d9.lib")
+#pragma comment(lib, "d3dx9.lib")
+
+#define VERTEX_FVF (D3DFVF_XYZRHW | D3DFVF_DIFFUSE | D3DFVF_TEX1)
+
+namespace
+{
+	/**
+	* @brief 画像のデコード関数
+	* @details file_nameがnullptrの場合はdataとsizeから、それ以外はファイルから読み込む
+	*/
+	bool DecodeImage(LPDIRECT3DDEVICE9 device, const char* file_name, const void* data, size_t size, int* out_width, int* out_height, std::vector<DWORD>* out_pixels)
+	{
+		D3DXIMAGE_INFO info;
+
+		if (device == nullptr ||
+			(file_name != nullptr && FAILED(D3DXGetImageInfoFromFile(file_name, &info))) ||
+			(file_name == nullptr && FAILED(D3DXGetImageInfoFromFileInMemory(data, (UINT)size, &info))))
+		{
+			return false;
+		}
+
+		LPDIRECT3DSURFACE9 surface = nullptr;
+
+		if (FAILED(device->CreateOffscreenPlainSurface(
+			info.Width,
+			info.Height,
+			D3DFMT_A8R8G8B8,
+			D3DPOOL_SCRATCH,
+			&surface,
+			nullptr)))
+		{
+			return false;
+		}
+
+		// CreateTextureと同じ結果になるようにカラーキーを適用し、拡大縮小はしない
+		HRESULT result = file_name != nullptr ?
+			D3DXLoadSurfaceFromFile(surface, nullptr, nullptr, file_name, nullptr, D3DX_FILTER_NONE, TextureColorKey, nullptr) :
+			D3DXLoadSurfaceFromFileInMemory(surface, nullptr, nullptr, data, (UINT)size, nullptr, D3DX_FILTER_NONE, TextureColorKey, nullptr);
+
+		D3DLOCKED_RECT locked_rect;
+
+		if (FAILED(result) ||
+			FAILED(surface->LockRect(&locked_rect, nullptr, D3DLOCK_READONLY)))
+		{
+			surface->Release();
+			return false;
+		}
+
+		out_pixels->resize((size_t)info.Width * info.Height);
+
+		for (UINT row = 0; row < info.Height; row++)
+		{
+			memcpy(
+				&(*out_pixels)[(size_t)row * info.Width],
+				(const unsigned char*)locked_rect.pBits + locked_rect.Pitch * row,
+				info.Width * sizeof(DWORD));
+		}
+
+		surface->UnlockRect();
+		surface->Release();
+
+		*out_width = (int)info.Width;
+		*out_height = (int)info.Height;
+
+		return true;
+	}
+}
+
+bool D3D9RenderBackend::Initialize(int width, int height, bool is_window_mode)
+{
+	D3DPRESENT_PARAMETERS present_param;
+	ZeroMemory(&present_param, sizeof(D3DPRESENT_PARAMETERS));
+
+	if (CreateInterface() == false)
+	{
+		return false;
+	}
+
+	if (CreateDevice(&present_param, is_window_mode) == false)
+	{
+		return false;
+	}
+
+	if (SetUpViewPort(&present_param) == false)
+	{
+		return false;
+	}
+
+	m_D3DDevice->SetRenderState(D3DRS_ALPHABLENDENABLE, true);
+	m_D3DDevice->SetRenderState(D3DRS_SRCBLEND, D3DBLEND_SRCALPHA);
+	m_D3DDevice->SetRenderState(D3DRS_DESTBLEND, D3DBLEND_INVSRCALPHA);
+
+	// テクスチャの設定
+	m_D3DDevice->SetTextureStageState(0, D3DTSS_ALPHAOP, D3DTOP_MODULATE);
+	m_D3DDevice->SetTextureStageState(0, D3DTSS_COLORARG1, D3DTA_TEXTURE);
+	m_D3DDevice->SetTextureStageState(0, D3DTSS_COLORARG2, D3DTA_DIFFUSE);
+
+	return true;
+}
+
+void D3D9RenderBackend::Release()
+{
+	if (m_D3DDevice != nullptr)
+	{
+		m_D3DDevice->Release();
+		m_D3DDevice = nullptr;
+	}
+
+	if (m_D3DInterface != nullptr)
+	{
+		m_D3DInterface->Release();
+		m_D3DInterface = nullptr;
+	}
+}
+
+bool D3D9RenderBackend::BeginFrame(DWORD color)
+{
+	if (m_D3DDevice == nullptr)
+	{
+		return false;
+	}
+
+	m_D3DDevice->Clear(0, NULL, D3DCLEAR_TARGET, color, 0.0f, 0);
+
+	if (D3D_OK == m_D3DDevice->BeginScene())
+	{
+		return true;
+	}
+
+	return false;
+}
+
+void D3D9RenderBackend::EndFrame()
+{
+	if (m_D3DDevice == nullptr)
+	{
+		return;
+	}
+
+	m_D3DDevice->EndScene();
+	m_D3DDevice->Present(nullptr, nullptr, nullptr, nullptr);
+}
+
+void D3D9RenderBackend::SetVertexFormat()
+{
+	m_D3DDevice->SetFVF(VERTEX_FVF);
+}
+
+void D3D9RenderBackend::SetTexture(const Texture* texture)
+{
+	m_D3DDevice->SetTexture(0, texture != nullptr ? texture->TextureData : nullptr);
+}
+
+void D3D9RenderBackend::SetTextureFilter(TextureFilter filter)
+{
+	D3DTEXTUREFILTERTYPE filter_type = filter == TextureFilterPoint ? D3DTEXF_POINT : D3DTEXF_LINEAR;
+
+	m_D3DDevice->SetSamplerState(0, D3DSAMP_MINFILTER, filter_type);
+	m_D3DDevice->SetSamplerState(0, D3DSAMP_MAGFILTER, filter_type);
+	m_D3DDevice->SetSamplerState(0, D3DSAMP_MIPFILTER, filter == TextureFilterTrilinear ? D3DTEXF_LINEAR : D3DTEXF_NONE);
+}
+
+void D3D9RenderBackend::DrawTriangleList(const CustomVertex* vertices, int vertex_count)
+{
+	m_D3DDevice->DrawPrimitiveUP(D3DPT_TRIANGLELIST, vertex_count / 3, vertices, sizeof(CustomVertex));
+}
+
+bool D3D9RenderBackend::CreateTexture(const char* file_name, Texture* texture_data)
+{
+	D3DXIMAGE_INFO info;
+
+	// 2の累乗じゃないケースを想定して元のサイズを取得してD3DXCreateTextureFromFileExで使う
+	D3DXGetImageInfoFromFile(file_name, &info);
+
+	if (FAILED(D3DXCreateTextureFromFileEx(
+		m_D3DDevice,
+		file_name,
+		info.Width,
+		info.Height,
+		1,
+		0,
+		D3DFMT_UNKNOWN,
+		D3DPOOL_MANAGED,
+		D3DX_DEFAULT,
+		D3DX_DEFAULT,
+		TextureColorKey,
+		nullptr,
+		nullptr,
+		&texture_data->TextureData)))
+	{
+		return false;
+	}
+	else
+	{
+		// テクスチャサイズの取得
+		D3DSURFACE_DESC desc;
+
+		if (FAILED(texture_data->TextureData->GetLevelDesc(0, &desc)))
+		{
+			texture_data->TextureData->Release();
+			return false;
+		}
+		texture_data->Width = desc.Width;
+		texture_data->Height = desc.Height;
+	}
+
+	return true;
+}
+
+bool D3D9RenderBackend::DecodeTexture(const char* file_name, int* out_width, int* out_height, std::vector<DWORD>* out_pixels)
+{
+	return DecodeImageFile(m_D3DDevice, file_name, out_width, out_height, out_pixels);
+}
+
+bool D3D9RenderBackend::CreateTextureFromMemory(const void* data, size_t size, Texture* texture_data)
+{
+	D3DXIMAGE_INFO info;
+
+	if (FAILED(D3DXGetImageInfoFromFileInMemory(data, (UINT)size, &info)) ||
+		FAILED(D3DXCreateTextureFromFileInMemoryEx(
+			m_D3DDevice,
+			data,
+			(UINT)size,
+			info.Width,
+			info.Height,
+			1,
+			0,
+			D3DFMT_UNKNOWN,
+			D3DPOOL_MANAGED,
+			D3DX_DEFAULT,
+			D3DX_DEFAULT,
+			TextureColorKey,
+			nullptr,
+			nullptr,
+			&texture_data->TextureData)))
+	{
+		return false;
+	}
+
+	D3DSURFACE_DESC desc;
+
+	if (FAILED(texture_data->TextureData->GetLevelDesc(0, &desc)))
+	{
+		texture_data->TextureData->Release();
+		texture_data->TextureData = nullptr;
+		return false;
+	}
+	texture_data->Width = desc.Width;
+	texture_data->Height = desc.Height;
+
+	return true;
+}
+
+bool D3D9RenderBackend::DecodeTextureFromMemory(const void* data, size_t size, int* out_width, int* out_height, std::vector<DWORD>* out_pixels)
+{
+	return DecodeImageFileInMemory(m_D3DDevice, data, size, out_width, out_height, out_pixels);
+}
+
+bool D3D9RenderBackend::CreateEmptyTexture(int width, int height, Texture* texture_data)
+{
+	// 頻繁に書き込まないのでDYNAMICではなくMANAGEDで作成し、デバイスロストの対応を不要にする
+	if (FAILED(m_D3DDevice->CreateTexture(
+		width,
+		height,
+		1,
+		0,
+		D3DFMT_A8R8G8B8,
+		D3DPOOL_MANAGED,
+		&texture_data->TextureData,
+		nullptr)))
+	{
+		return false;
+	}
+
+	texture_data->Width = width;
+	texture_data->Height = height;
+
+	return true;
+}
+
+bool D3D9RenderBackend::CreateMipmappedTexture(int width, int height, int level_count, const DWORD* pixels, Texture* texture_data)
+{
+	if (FAILED(m_D3DDevice->CreateTexture(
+		width,
+		height,
+		level_count,
+		0,
+		D3DFMT_A8R8G8B8,
+		D3DPOOL_MANAGED,
+		&texture_data->TextureData,
+		nullptr)))
+	{
+		return false;
+	}
+
+	if (WriteMipmapLevels(texture_data->TextureData, width, height, level_count, pixels) == false)
+	{
+		texture_data->TextureData->Release();
+		texture_data->TextureData = nullptr;
+		return false;
+	}
+
+	texture_data->Width = width;
+	texture_data->Height = height;
+
+	return true;
+}
+
+bool D3D9RenderBackend::UpdateTexture(Texture* texture_data, int x, int y, int width, int height, const DWORD* pixels, int pitch)
+{
+	return WriteTexturePixels(texture_data->TextureData, x, y, width, height, pixels, pitch);
+}
+
+void D3D9RenderBackend::GetBackBufferSize(int* out_width, int* out_height) const
+{
+	*out_width = m_BackBufferWidth;
+	*out_height = m_BackBufferHeight;
+}
+
+bool D3D9RenderBackend::CreateInterface()
+{
+	// インターフェース作成
+	m_D3DInterface = Direct3DCreate9(D3D_SDK_VERSION);
+	if (m_D3DInterface == NULL)
+	{
+		// 作成失敗
+		return false;
+	}
+
+	// 作成成功
+	return true;
+}
+
+bool D3D9RenderBackend::CreateDevice(D3DPRESENT_PARAMETERS* present_param, bool is_window_mode)
+{
+	present_param->BackBufferCount = 1;
+	present_param->BackBufferFormat = D3DFMT_X8R8G8B8;
+	present_param->SwapEffect = D3DSWAPEFFECT_DISCARD;
+
+	if (is_window_mode == true)
+	{
+		present_param->Windowed = is_window_mode;
+	}
+	else
+	{
+		HWND window_handle = FindWindow(WINDOW_CLASS_NAME, nullptr);
+
+		RECT rect;
+		GetClientRect(window_handle, &rect);
+
+		present_param->Windowed = is_window_mode;
+		present_param->BackBufferHeight = rect.bottom - rect.top;
+		present_param->BackBufferWidth = rect.right - rect.left;
+	}
+
+	// DirectDeviceの作成
+	if (FAILED(m_D3DInterface->CreateDevice(D3DADAPTER_DEFAULT,
+		D3DDEVTYPE_HAL,
+		FindWindow(WINDOW_CLASS_NAME, nullptr),
+		D3DCREATE_HARDWARE_VERTEXPROCESSING | D3DCREATE_MULTITHREADED,
+		present_param,
+		&m_D3DDevice)))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+bool D3D9RenderBackend::SetUpViewPort(D3DPRESENT_PARAMETERS* present_param)
+{
+	// ビューポートパラメータ
+	D3DVIEWPORT9 view_port;
+
+	// ビューポートの左上座標
+	view_port.X = 0;
+	view_port.Y = 0;
+	// ビューポートの幅
+	view_port.Width = present_param->BackBufferWidth;
+	// ビューポートの高さ
+	view_port.Height = present_param->BackBufferHeight;
+	// ビューポート深度設定
+	view_port.MinZ = 0.0f;
+	view_port.MaxZ = 1.0f;
+
+	// ビューポート設定
+	if (FAILED(m_D3DDevice->SetViewport(&view_port)))
+	{
+		return false;
+	}
+
+	m_BackBufferWidth = present_param->BackBufferWidth;
+	m_BackBufferHeight = present_param->BackBufferHeight;
+
+	return true;
+}
+
+bool D3D9RenderBackend::WriteTexturePixels(LPDIRECT3DTEXTURE9 texture, int x, int y, int width, int height, const DWORD* pixels, int pitch)
+{
+	if (texture == nullptr)
+	{
+		return false;
+	}
+
+	RECT rect =
+	{
+		x,
+		y,
+		x + width,
+		y + height,
+	};
+	D3DLOCKED_RECT locked_rect;
+
+	if (FAILED(texture->LockRect(0, &locked_rect, &rect, 0)))
+	{
+		return false;
+	}
+
+	for (int row = 0; row < height; row++)
+	{
+		memcpy(
+			(unsigned char*)locked_rect.pBits + locked_rect.Pitch * row,
+			&pixels[row * pitch],
+			width * sizeof(DWORD));
+	}
+
+	texture->UnlockRect(0);
+
+	return true;
+}
+
+bool D3D9RenderBackend::WriteMipmapLevels(LPDIRECT3DTEXTURE9 texture, int width, int height, int level_count, const DWORD* pixels)
+{
+	if (texture == nullptr)
+	{
+		return false;
+	}
+
+	for (int level = 0; level < level_count; level++)
+	{
+		int level_width = 0;
+		int level_height = 0;
+		MipmapGenerator::CalculateLevelSize(width, height, level, &level_width, &level_height);
+
+		D3DLOCKED_RECT locked_rect;
+
+		if (FAILED(texture->LockRect(level, &locked_rect, nullptr, 0)))
+		{
+			return false;
+		}
+
+		for (int row = 0; row < level_height; row++)
+		{
+			memcpy(
+				(unsigned char*)locked_rect.pBits + locked_rect.Pitch * row,
+				&pixels[(size_t)row * level_width],
+				level_width * sizeof(DWORD));
+		}
+
+		texture->UnlockRect(level);
+
+		pixels += (size_t)level_width * level_height;
+	}
+
+	return true;
+}
+
+bool D3D9RenderBackend::DecodeImageFile(LPDIRECT3DDEVICE9 device, const char* file_name, int* out_width, int* out_height, std::vector<DWORD>* out_pixels)
+{
+	return DecodeImage(device, file_name, nullptr, 0, out_width, out_height, out_pixels);
+}
+
+bool D3D9RenderBackend::DecodeImageFileInMemory(LPDIRECT3DDEVICE9 device, const void* data, size_t size, int* out_width, int* out_height, std::vector<DWORD>* out_pixels)
+{
+	return DecodeImage(device, nullptr, data, size, out_width, out_height, out_pixels);
+}
@@ -0,0 +1,139 @@
+﻿/**
+* @file D3D9RenderBackend.h
+* @brief <pre>
+* DirectGraphics(Direct3D9)を使用する描画バックエンドの宣言
+* Graphicsクラスでインスタンスを作成するので使用者が作成する必要はない
+* </pre>
+*/
+#ifndef D3D9_RENDER_BACKEND_H_
+#define D3D9_RENDER_BACKEND_H_
+
+#include <Windows.h>
+#include <d3d9.h>
+#include <d3dx9.h>
+#include "RenderBackend.h"
+
+/** @brief Direct3D9描画バックエンドクラス */
+class D3D9RenderBackend : public RenderBackend
+{
+public:
+	/** Constructor */
+	D3D9RenderBackend() :
+		m_D3DInterface(nullptr),
+		m_D3DDevice(nullptr),
+		m_BackBufferWidth(0),
+		m_BackBufferHeight(0)
+	{
+	}
+
+	virtual bool Initialize(int width, int height, bool is_window_mode) override;
+	virtual void Release() override;
+	virtual RenderBackendType GetType() const override
+	{
+		return RenderBackendType::RenderBackendTypeD3D9;
+	}
+	virtual bool BeginFrame(DWORD color) override;
+	virtual void EndFrame() override;
+	virtual void SetVertexFormat() override;
+	virtual void SetTexture(const Texture* texture) override;
+	virtual void SetTextureFilter(TextureFilter filter) override;
+	virtual void DrawTriangleList(const CustomVertex* vertices, int vertex_count) override;
+	virtual bool CreateTexture(const char* file_name, Texture* texture_data) override;
+	virtual bool DecodeTexture(const char* file_name, int* out_width, int* out_height, std::vector<DWORD>* out_pixels) override;
+	virtual bool CreateTextureFromMemory(const void* data, size_t size, Texture* texture_data) override;
+	virtual bool DecodeTextureFromMemory(const void* data, size_t size, int* out_width, int* out_height, std::vector<DWORD>* out_pixels) override;
+	virtual bool CreateEmptyTexture(int width, int height, Texture* texture_data) override;
+	virtual bool CreateMipmappedTexture(int width, int height, int level_count, const DWORD* pixels, Texture* texture_data) override;
+	virtual bool UpdateTexture(Texture* texture_data, int x, int y, int width, int height, const DWORD* pixels, int pitch) override;
+	virtual void GetBackBufferSize(int* out_width, int* out_height) const override;
+
+	/**
+	* @brief テクスチャのピクセル書き込み関数
+	* @details 最上位のミップレベルをロックして指定範囲にピクセルを書き込む
+	* @retval true 書き込み成功
+	* @retval false 書き込み失敗
+	* @param[in] texture 書き込むテクスチャ(A8R8G8B8)
+	* @param[in] x 書き込む範囲の左上座標X
+	* @param[in] y 書き込む範囲の左上座標Y
+	* @param[in] width 書き込む範囲の横幅
+	* @param[in] height 書き込む範囲の縦幅
+	* @param[in] pixels 書き込むピクセル
+	* @param[in] pitch pixelsの1行の要素数
+	*/
+	static bool WriteTexturePixels(LPDIRECT3DTEXTURE9 texture, int x, int y, int width, int height, const DWORD* pixels, int pitch);
+
+	/**
+	* @brief ミップマップの全レベルの書き込み関数
+	* @details 各レベルをロックしてテクセルを書き込む
+	* @retval true 書き込み成功
+	* @retval false 書き込み失敗
+	* @param[in] texture 書き込むテクスチャ(A8R8G8B8、level_count以上のレベルを持つ)
+	* @param[in] width 最上位レベルの横幅
+	* @param[in] height 最上位レベルの縦幅
+	* @param[in] level_count 書き込むレベル数
+	* @param[in] pixels MipmapGenerator::GenerateChainで作成した全レベルのテクセル
+	*/
+	static bool WriteMipmapLevels(LPDIRECT3DTEXTURE9 texture, int width, int height, int level_count, const DWORD* pixels);
+
+	/**
+	* @brief 画像ファイルのデコード関数
+	* @details SCRATCHプールのサーフェイスに読み込み、カラーキーを適用したA8R8G8B8のピクセルを取り出す
+	* @retval true デコード成功
+	* @retval false デコード失敗
+	* @param[in] device サーフェイスを作成するデバイス
+	* @param[in] file_name 読み込む画像ファイルの名前(パス込み)
+	* @param[out] out_width 横幅
+	* @param[out] out_height 縦幅
+	* @param[out] out_pixels デコードしたピクセル(1行の要素数は横幅)
+	*/
+	static bool DecodeImageFile(LPDIRECT3DDEVICE9 device, const char* file_name, int* out_width, int* out_height, std::vector<DWORD>* out_pixels);
+
+	/**
+	* @brief メモリ上の画像ファイルのデコード関数
+	* @details DecodeImageFileのメモリ版
+	* @retval true デコード成功
+	* @retval false デコード失敗
+	* @param[in] device サーフェイスを作成するデバイス
+	* @param[in] data 画像ファイルの内容
+	* @param[in] size 画像ファイルのバイト数
+	* @param[out] out_width 横幅
+	* @param[out] out_height 縦幅
+	* @param[out] out_pixels デコードしたピクセル(1行の要素数は横幅)
+	*/
+	static bool DecodeImageFileInMemory(LPDIRECT3DDEVICE9 device, const void* data, size_t size, int* out_width, int* out_height, std::vector<DWORD>* out_pixels);
+
+private:
+	/**
+	* @brief Graphicsインタフェース作成関数
+	* @details DirectGraphicsのインターフェースを作成する
+	* @retval true 作成成功
+	* @retval false 作成失敗
+	*/
+	bool CreateInterface();
+
+	/**
+	* @brief Graphicsdデバイス作成関数
+	* @details DirectGraphicsのデバイスを作成する
+	* @retval true 作成成功
+	* @retval false 作成失敗
+	* @param[in] present_param デバイス設定に使用するプレゼントパラメータ
+	* @param[in] is_window_mode ウィンドウモード
+	*/
+	bool CreateDevice(D3DPRESENT_PARAMETERS* present_param, bool is_window_mode);
+
+	/**
+	* @brief ビューポート設定関数
+	* @retval true 作成成功
+	* @retval false 作成失敗
+	* @param[in] present_param バッファサイズを保持するデータ
+	*/
+	bool SetUpViewPort(D3DPRESENT_PARAMETERS* present_param);
+
+private:
+	LPDIRECT3D9 m_D3DInterface;						//!< DirectGraphicsインターフェース
+	LPDIRECT3DDEVICE9 m_D3DDevice;					//!< DirectGraphicsデバイス
+	int m_BackBufferWidth;							//!< バックバッファの横幅
+	int m_BackBufferHeight;							//!< バックバッファの縦幅
+};
+
+#endif
@@ -0,0 +1,306 @@
+﻿#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include "DrawCommandList.h"
+#include "FrameAllocator.h"
+
+namespace
+{
+	/**
+	* @brief vectorのメモリ解放関数
+	* @details 要素を削除してから容量を0にする
+	* @param[in,out] list 解放するvector
+	*/
+	template<class T>
+	void ReleaseVector(T* list)
+	{
+		list->clear();
+		list->shrink_to_fit();
+	}
+}
+
+CustomVertex* DrawCommandList::AddCommand(const Texture* texture, int vertex_count, int layer, TextureFilter filter)
+{
+	DrawCommand command;
+	command.TextureData = texture;
+	command.Filter = filter;
+	command.FirstVertex = (int)m_VertexList.size();
+	command.VertexCount = vertex_count;
+	command.Layer = layer;
+	m_CommandList.push_back(command);
+
+	m_VertexList.resize(m_VertexList.size() + vertex_count);
+
+	return &m_VertexList[command.FirstVertex];
+}
+
+void DrawCommandList::Append(const DrawCommandList& source)
+{
+	if (source.m_CommandList.empty() == true)
+	{
+		return;
+	}
+
+	// 頂点はまとめてコピーし、命令の先頭番号だけ付け替える
+	int vertex_offset = (int)m_VertexList.size();
+	m_VertexList.insert(m_VertexList.end(), source.m_VertexList.begin(), source.m_VertexList.end());
+
+	m_CommandList.reserve(m_CommandList.size() + source.m_CommandList.size());
+	for (const DrawCommand& command : source.m_CommandList)
+	{
+		m_CommandList.push_back(command);
+		m_CommandList.back().FirstVertex += vertex_offset;
+	}
+}
+
+void DrawCommandList::Clear()
+{
+	m_CommandList.clear();
+	m_VertexList.clear();
+}
+
+void DrawCommandList::Release()
+{
+	ReleaseVector(&m_CommandList);
+	ReleaseVector(&m_VertexList);
+	ReleaseVector(&m_SortKeyList);
+	ReleaseVector(&m_OverlapGrid);
+	m_TextureIdList.clear();
+}
+
+void DrawCommandList::Sort(float viewport_width, float viewport_height, FrameAllocator* allocator)
+{
+	int count = (int)m_CommandList.size();
+	if (count == 0)
+	{
+		return;
+	}
+
+	int* depth_list = allocator->AllocateArray<int>(count);
+	CalculateDepths(depth_list, viewport_width, viewport_height, allocator);
+
+	m_TextureIdList.clear();
+	m_SortKeyList.resize(count);
+	unsigned long long* sort_temp_list = allocator->AllocateArray<unsigned long long>(count);
+
+	// 同じテクスチャとフィルタリングが続く場合は検索を省略する
+	const Texture* last_texture = nullptr;
+	TextureFilter last_filter = TextureFilterPoint;
+	int last_texture_id = -1;
+
+	for (int i = 0; i < count; i++)
+	{
+		const DrawCommand& command = m_CommandList[i];
+
+		if (last_texture_id < 0 || command.TextureData != last_texture || command.Filter != last_filter)
+		{
+			last_texture = command.TextureData;
+			last_filter = command.Filter;
+			last_texture_id = FindTextureId(last_texture, last_filter);
+		}
+
+		m_SortKeyList[i] = MakeSortKey(command.Layer, depth_list[i], last_texture_id, i);
+	}
+
+	RadixSort(&m_SortKeyList[0], sort_temp_list, count);
+}
+
+unsigned long long DrawCommandList::MakeSortKey(int layer, int depth, int texture_id, int sequence)
+{
+	return ((unsigned long long)(layer & (DrawLayerCount - 1)) << 56) |
+		((unsigned long long)((std::min)(depth, MaxDrawCommandDepth)) << 36) |
+		((unsigned long long)((std::min)(texture_id, MaxDrawCommandTextureId)) << 24) |
+		(unsigned long long)(sequence & (MaxDrawCommandCount - 1));
+}
+
+void DrawCommandList::RadixSort(unsigned long long* keys, unsigned long long* temp, int count)
+{
+	if (count <= 1)
+	{
+		return;
+	}
+
+	// 8桁分のヒストグラムを1回の走査でまとめて作成する
+	static const int DigitCount = 8;
+	int histogram[DigitCount][256];
+	memset(histogram, 0, sizeof(histogram));
+
+	for (int i = 0; i < count; i++)
+	{
+		unsigned long long key = keys[i];
+		for (int digit = 0; digit < DigitCount; digit++)
+		{
+			histogram[digit][(key >> (digit * 8)) & 0xFF]++;
+		}
+	}
+
+	unsigned long long* src = keys;
+	unsigned long long* dest = temp;
+
+	for (int digit = 0; digit < DigitCount; digit++)
+	{
+		int shift = digit * 8;
+
+		// 全てのキーで同じ値の桁は並び替えても順番が変わらないので省略する
+		if (histogram[digit][(src[0] >> shift) & 0xFF] == count)
+		{
+			continue;
+		}
+
+		int offset[256];
+		int total = 0;
+		for (int i = 0; i < 256; i++)
+		{
+			offset[i] = total;
+			total += histogram[digit][i];
+		}
+
+		for (int i = 0; i < count; i++)
+		{
+			unsigned long long key = src[i];
+			dest[offset[(key >> shift) & 0xFF]++] = key;
+		}
+
+		std::swap(src, dest);
+	}
+
+	if (src != keys)
+	{
+		memcpy(keys, src, sizeof(unsigned long long) * count);
+	}
+}
+
+void DrawCommandList::CalculateDepths(int* out_depth_list, float viewport_width, float viewport_height, FrameAllocator* allocator)
+{
+	int count = (int)m_CommandList.size();
+
+	int cell_count_x = (std::max)(1, (int)ceilf(viewport_width / DrawOrderCellSize));
+	int cell_count_y = (std::max)(1, (int)ceilf(viewport_height / DrawOrderCellSize));
+	if ((int)m_OverlapGrid.size() != cell_count_x * cell_count_y)
+	{
+		OverlapCell empty_cell = { 0, 0 };
+		m_OverlapGrid.assign(cell_count_x * cell_count_y, empty_cell);
+		m_OverlapStamp = 0;
+	}
+
+	// レイヤーごとに記録順を保ったまま命令番号を並べる
+	int layer_start[DrawLayerCount + 1] = {};
+	for (const DrawCommand& command : m_CommandList)
+	{
+		layer_start[command.Layer + 1]++;
+	}
+	for (int i = 0; i < DrawLayerCount; i++)
+	{
+		layer_start[i + 1] += layer_start[i];
+	}
+
+	int* layer_order_list = allocator->AllocateArray<int>(count);
+	int layer_position[DrawLayerCount];
+	memcpy(layer_position, layer_start, sizeof(layer_position));
+	for (int i = 0; i < count; i++)
+	{
+		layer_order_list[layer_position[m_CommandList[i].Layer]++] = i;
+	}
+
+	// 頂点データは記録順に1回だけ走査して、命令が覆うセルの範囲を求めておく
+	CellRect* cell_rect_list = allocator->AllocateArray<CellRect>(count);
+	float inv_cell_size = 1.0f / DrawOrderCellSize;
+
+	for (int index = 0; index < count; index++)
+	{
+		const DrawCommand& command = m_CommandList[index];
+
+		float min_x = FLT_MAX;
+		float min_y = FLT_MAX;
+		float max_x = -FLT_MAX;
+		float max_y = -FLT_MAX;
+		const CustomVertex* vertices = &m_VertexList[command.FirstVertex];
+		for (int i = 0; i < command.VertexCount; i++)
+		{
+			min_x = (std::min)(min_x, vertices[i].X);
+			min_y = (std::min)(min_y, vertices[i].Y);
+			max_x = (std::max)(max_x, vertices[i].X);
+			max_y = (std::max)(max_y, vertices[i].Y);
+		}
+
+		// 画面外の部分は端のセルにまとめる(重なりを見逃さない方向に丸める)
+		CellRect& rect = cell_rect_list[index];
+		rect.Left = (short)(std::min)((std::max)((int)floorf(min_x * inv_cell_size), 0), cell_count_x - 1);
+		rect.Top = (short)(std::min)((std::max)((int)floorf(min_y * inv_cell_size), 0), cell_count_y - 1);
+		rect.Right = (short)(std::min)((std::max)((int)floorf(max_x * inv_cell_size), 0), cell_count_x - 1);
+		rect.Bottom = (short)(std::min)((std::max)((int)floorf(max_y * inv_cell_size), 0), cell_count_y - 1);
+	}
+
+	for (int layer = 0; layer < DrawLayerCount; layer++)
+	{
+		if (layer_start[layer] == layer_start[layer + 1])
+		{
+			continue;
+		}
+
+		// 処理番号を変えることで前のレイヤーのセルを無効にする(セルのクリアを省略する)
+		m_OverlapStamp++;
+		if (m_OverlapStamp == 0)
+		{
+			for (OverlapCell& cell : m_OverlapGrid)
+			{
+				cell.Stamp = 0;
+			}
+			m_OverlapStamp = 1;
+		}
+
+		for (int order = layer_start[layer]; order < layer_start[layer + 1]; order++)
+		{
+			int index = layer_order_list[order];
+			int left = cell_rect_list[index].Left;
+			int top = cell_rect_list[index].Top;
+			int right = cell_rect_list[index].Right;
+			int bottom = cell_rect_list[index].Bottom;
+
+			int depth = 0;
+			for (int y = top; y <= bottom; y++)
+			{
+				const OverlapCell* row = &m_OverlapGrid[y * cell_count_x];
+				for (int x = left; x <= right; x++)
+				{
+					if (row[x].Stamp == m_OverlapStamp)
+					{
+						depth = (std::max)(depth, row[x].Depth);
+					}
+				}
+			}
+			depth = (std::min)(depth, MaxDrawCommandDepth);
+			out_depth_list[index] = depth;
+
+			for (int y = top; y <= bottom; y++)
+			{
+				OverlapCell* row = &m_OverlapGrid[y * cell_count_x];
+				for (int x = left; x <= right; x++)
+				{
+					row[x].Stamp = m_OverlapStamp;
+					row[x].Depth = depth + 1;
+				}
+			}
+		}
+	}
+}
+
+int DrawCommandList::FindTextureId(const Texture* texture, TextureFilter filter)
+{
+	int texture_index = 0;
+
+	auto itr = m_TextureIdList.find(texture);
+	if (itr != m_TextureIdList.end())
+	{
+		texture_index = itr->second;
+	}
+	else
+	{
+		texture_index = (int)m_TextureIdList.size();
+		m_TextureIdList[texture] = texture_index;
+	}
+
+	// 番号が足りない場合は最大値にまとめる(まとめた命令は記録順で描画される)
+	return (std::min)(texture_index * TextureFilterMax + filter, MaxDrawCommandTextureId);
+}
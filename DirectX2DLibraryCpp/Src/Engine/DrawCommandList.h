@@ -0,0 +1,219 @@
+﻿/**
+* @file DrawCommandList.h
+* @brief <pre>
+* 遅延描画で使用する描画命令リストクラスの宣言
+* 描画命令は頂点データごと記録し、描画時にソートキーで並び替えてから送信する
+* デバイスを使用しないので、記録と並び替えは描画バックエンドに関係なく動作する
+* </pre>
+*/
+#ifndef DRAW_COMMAND_LIST_H_
+#define DRAW_COMMAND_LIST_H_
+
+#include <unordered_map>
+#include <vector>
+#include "EngineConstant.h"
+#include "TaggedAllocator.h"
+
+class FrameAllocator;
+
+const int DrawLayerCount = 256;							//!< 描画レイヤーの数
+const int MaxDrawCommandCount = 1 << 24;				//!< 1回の並び替えで扱える描画命令の数(ソートキーの通し番号のビット数)
+const int MaxDrawCommandDepth = (1 << 20) - 1;			//!< ソートキーに格納できる重なりの深さ
+const int MaxDrawCommandTextureId = (1 << 12) - 1;		//!< ソートキーに格納できるテクスチャ番号(テクスチャとフィルタリングの組み合わせごとの番号)
+const int DrawOrderCellSize = 64;						//!< 重なり判定に使用するセルのサイズ(ピクセル)
+
+/** @brief 記録した描画命令 */
+struct DrawCommand
+{
+	const Texture* TextureData;		//!< 使用するテクスチャ(テクスチャなしの場合はnullptr)
+	TextureFilter Filter;			//!< 使用するフィルタリング
+	int FirstVertex;				//!< 頂点リスト内の先頭の頂点番号
+	int VertexCount;				//!< 頂点数(三角形リスト)
+	int Layer;						//!< 描画レイヤー
+};
+
+/**
+* @brief 描画命令リストクラス
+* @details <pre>
+* ソートキーは上位から レイヤー(8bit) 重なりの深さ(20bit) テクスチャ番号(12bit) 通し番号(24bit)
+* 重なりの深さは同じレイヤーで先に記録された命令と範囲が重なるたびに1増えるので、
+* 重なる命令同士は記録順(画家のアルゴリズム)のまま、重ならない命令はテクスチャごとにまとめられる
+* テクスチャ番号はテクスチャとフィルタリングの組み合わせに割り当てるので、同じテクスチャはフィルタリングごとにまとめられる
+* 並び替えは64bitキーのLSD基数ソートで行う
+* 並び替えの作業領域はフレームアロケーターから確保するので、命令リストごとには保持しない
+* </pre>
+*/
+class DrawCommandList
+{
+public:
+	/** Constructor */
+	DrawCommandList() :
+		m_CommandList(),
+		m_VertexList(),
+		m_SortKeyList(),
+		m_OverlapGrid(),
+		m_OverlapStamp(0),
+		m_TextureIdList()
+	{
+	}
+
+	/**
+	* @brief 描画命令の追加関数
+	* @details 追加した命令の頂点を書き込む位置を返す(次の追加までに書き込むこと)
+	* @retval CustomVertex* 頂点の書き込み位置
+	* @param[in] texture 使用するテクスチャ
+	* @param[in] vertex_count 頂点数(三角形リスト)
+	* @param[in] layer 描画レイヤー(0～DrawLayerCount-1)
+	* @param[in] filter 使用するフィルタリング
+	*/
+	CustomVertex* AddCommand(const Texture* texture, int vertex_count, int layer, TextureFilter filter);
+
+	/**
+	* @brief 命令リストの連結関数
+	* @details <pre>
+	* sourceの命令を記録順のまま末尾に追加する
+	* ワーカースレッドごとに記録したリストを決まった順番で連結することで、
+	* スレッドの終了順に関係なく同じ描画結果になる
+	* </pre>
+	* @param[in] source 追加する命令リスト
+	*/
+	void Append(const DrawCommandList& source);
+
+	/**
+	* @brief 全削除関数
+	* @details 記録した命令を全て削除する(確保したメモリは次のフレームで再利用する)
+	*/
+	void Clear();
+
+	/**
+	* @brief メモリ解放関数
+	* @details 記録した命令を全て削除し、確保したメモリも解放する(タグ付きアロケーターを解放する前に実行する)
+	*/
+	void Release();
+
+	/**
+	* @brief 並び替え関数
+	* @details 命令ごとのソートキーを作成して基数ソートを行う
+	* @param[in] viewport_width 重なり判定を行う範囲の横幅
+	* @param[in] viewport_height 重なり判定を行う範囲の縦幅
+	* @param[in] allocator 作業領域を確保するフレームアロケーター(並び替えを行うスレッドが使用しているもの)
+	*/
+	void Sort(float viewport_width, float viewport_height, FrameAllocator* allocator);
+
+	/**
+	* @brief 命令数の取得関数
+	* @retval int 命令数
+	*/
+	int GetCount() const
+	{
+		return (int)m_CommandList.size();
+	}
+
+	/**
+	* @brief 命令数の上限判定関数
+	* @retval true これ以上追加できない
+	* @retval false 追加できる
+	*/
+	bool IsFull() const
+	{
+		return (int)m_CommandList.size() >= MaxDrawCommandCount;
+	}
+
+	/**
+	* @brief 記録順の命令の取得関数
+	* @retval const DrawCommand& 命令
+	* @param[in] index 記録順の番号
+	*/
+	const DrawCommand& GetCommand(int index) const
+	{
+		return m_CommandList[index];
+	}
+
+	/**
+	* @brief 並び替え後の命令の取得関数
+	* @retval const DrawCommand& 命令
+	* @param[in] index 並び替え後の順番(Sortの実行後に使用する)
+	*/
+	const DrawCommand& GetSortedCommand(int index) const
+	{
+		return m_CommandList[(size_t)(m_SortKeyList[index] & (MaxDrawCommandCount - 1))];
+	}
+
+	/**
+	* @brief 命令の頂点データの取得関数
+	* @retval const CustomVertex* 頂点データ
+	* @param[in] command 命令
+	*/
+	const CustomVertex* GetVertices(const DrawCommand& command) const
+	{
+		return &m_VertexList[command.FirstVertex];
+	}
+
+	/**
+	* @brief ソートキーの作成関数
+	* @retval unsigned long long ソートキー
+	* @param[in] layer 描画レイヤー
+	* @param[in] depth 重なりの深さ
+	* @param[in] texture_id テクスチャ番号
+	* @param[in] sequence 通し番号
+	*/
+	static unsigned long long MakeSortKey(int layer, int depth, int texture_id, int sequence);
+
+	/**
+	* @brief 64bitキーの基数ソート関数
+	* @details <pre>
+	* 下位から8bitずつ安定ソートを行う
+	* 全てのキーで同じ値の桁は並び替えを省略する
+	* </pre>
+	* @param[in,out] keys 並び替えるキー
+	* @param[in] temp 作業領域(keysと同じ要素数)
+	* @param[in] count 要素数
+	*/
+	static void RadixSort(unsigned long long* keys, unsigned long long* temp, int count);
+
+private:
+	/** @brief 重なり判定用のセル */
+	struct OverlapCell
+	{
+		unsigned int Stamp;		//!< Depthを記録したレイヤーの処理番号
+		int Depth;				//!< セルに次に描画される命令の深さ
+	};
+
+	/** @brief 命令が覆うセルの範囲 */
+	struct CellRect
+	{
+		short Left;		//!< 左端のセル
+		short Top;		//!< 上端のセル
+		short Right;	//!< 右端のセル
+		short Bottom;	//!< 下端のセル
+	};
+
+	/**
+	* @brief 重なりの深さの計算関数
+	* @details レイヤーごとに記録順で範囲が重なるセルを調べ、命令の深さを書き込む
+	* @param[out] out_depth_list 命令ごとの重なりの深さ(命令数の要素数)
+	* @param[in] viewport_width 重なり判定を行う範囲の横幅
+	* @param[in] viewport_height 重なり判定を行う範囲の縦幅
+	* @param[in] allocator 作業領域を確保するフレームアロケーター
+	*/
+	void CalculateDepths(int* out_depth_list, float viewport_width, float viewport_height, FrameAllocator* allocator);
+
+	/**
+	* @brief テクスチャ番号の取得関数
+	* @details フレームで初めて使用されたテクスチャには新しい番号を割り当て、フィルタリングの種類ごとに連続した番号にする
+	* @retval int テクスチャ番号
+	* @param[in] texture テクスチャ
+	* @param[in] filter フィルタリング
+	*/
+	int FindTextureId(const Texture* texture, TextureFilter filter);
+
+private:
+	TaggedVector<DrawCommand, MemoryTagGraphics> m_CommandList;			//!< 記録した命令
+	TaggedVector<CustomVertex, MemoryTagGraphics> m_VertexList;			//!< 命令の頂点データ
+	TaggedVector<unsigned long long, MemoryTagGraphics> m_SortKeyList;	//!< ソートキー(並び替え後の命令の取得に使用するので保持する)
+	TaggedVector<OverlapCell, MemoryTagGraphics> m_OverlapGrid;			//!< 重なり判定用のセル
+	unsigned int m_OverlapStamp;										//!< 重なり判定の処理番号
+	std::unordered_map<const Texture*, int> m_TextureIdList;			//!< テクスチャごとの通し番号
+};
+
+#endif
@@ -0,0 +1,152 @@
+﻿#include <algorithm>
+#include <string.h>
+#include "DrawCommandRecorder.h"
+#include "Graphics.h"
+
+void DrawCommandRecorder::Clear()
+{
+	m_CommandList.Clear();
+}
+
+void DrawCommandRecorder::SetLayer(int layer)
+{
+	m_Layer = (std::min)((std::max)(layer, 0), DrawLayerCount - 1);
+}
+
+void DrawCommandRecorder::SetPivotType(PivotType pivot_type)
+{
+	m_Pivot = pivot_type;
+}
+
+void DrawCommandRecorder::SetTextureFilter(TextureFilter filter)
+{
+	m_Filter = filter;
+}
+
+void DrawCommandRecorder::RecordRect(float x, float y, float width, float height, DWORD color, UCHAR alpha, float angle, float scale_x, float scale_y)
+{
+	color += alpha << 24;
+
+	CustomVertex v[4] =
+	{
+		{ 0.0f, 0.0f, 0.0f, 1.0f, color, 0.0f, 0.0f },
+		{ width, 0.0f, 0.0f, 1.0f, color, 1.0f, 0.0f },
+		{ width, height, 0.0f, 1.0f, color, 1.0f, 1.0f },
+		{ 0.0f, height, 0.0f, 1.0f, color, 0.0f, 1.0f },
+	};
+
+	RecordQuad(nullptr, v, width, height, x, y, angle, scale_x, scale_y);
+}
+
+void DrawCommandRecorder::RecordTexture(float x, float y, const Texture* texture, UCHAR alpha, float angle, float scale_x, float scale_y)
+{
+	if (texture == nullptr)
+	{
+		return;
+	}
+
+	RecordTextureUV(x, y, texture, 0.0f, 0.0f, (float)texture->Width, (float)texture->Height, alpha, angle, scale_x, scale_y);
+}
+
+void DrawCommandRecorder::RecordTextureUV(float x, float y, const Texture* texture, float tex_x, float tex_y, float sprite_width, float sprite_height, UCHAR alpha, float angle, float scale_x, float scale_y)
+{
+	if (texture == nullptr || texture->Width == 0 || texture->Height == 0)
+	{
+		return;
+	}
+
+	// テクスチャ座標 => UV変換
+	float u_left = tex_x / texture->Width;
+	float u_right = (tex_x + sprite_width) / texture->Width;
+	float v_top = tex_y / texture->Height;
+	float v_bottom = (tex_y + sprite_height) / texture->Height;
+
+	DWORD color = D3DCOLOR_RGBA(0xff, 0xff, 0xff, alpha);
+	CustomVertex v[4] =
+	{
+		{ 0.0f, 0.0f, 0.0f, 1.0f, color, u_left, v_top },
+		{ sprite_width, 0.0f, 0.0f, 1.0f, color, u_right, v_top },
+		{ sprite_width, sprite_height, 0.0f, 1.0f, color, u_right, v_bottom },
+		{ 0.0f, sprite_height, 0.0f, 1.0f, color, u_left, v_bottom },
+	};
+
+	RecordQuad(texture, v, sprite_width, sprite_height, x, y, angle, scale_x, scale_y);
+}
+
+void DrawCommandRecorder::RecordTriangles(const Texture* texture, const CustomVertex* vertices, int vertex_count)
+{
+	if (vertex_count <= 0)
+	{
+		return;
+	}
+
+	CustomVertex* dest = m_CommandList.AddCommand(texture, vertex_count, m_Layer, m_Filter);
+	memcpy(dest, vertices, sizeof(CustomVertex) * vertex_count);
+}
+
+void DrawCommandRecorder::RecordQuad(const Texture* texture, CustomVertex* vertices, float width, float height, float x, float y, float angle, float scale_x, float scale_y)
+{
+	// Graphicsの描画と同じ頂点になるように、軸と変換はGraphicsの処理を使用する
+	Size size = Size(width, height);
+	Vec2 offset = Graphics::CalculatePivotOffset(m_Pivot, &size);
+	for (int i = 0; i < 4; i++)
+	{
+		vertices[i].X += offset.X;
+		vertices[i].Y += offset.Y;
+	}
+
+	Graphics::TransformRect(vertices, x, y, angle, scale_x, scale_y);
+
+	CustomVertex* dest = m_CommandList.AddCommand(texture, 6, m_Layer, m_Filter);
+	dest[0] = vertices[0];
+	dest[1] = vertices[1];
+	dest[2] = vertices[2];
+	dest[3] = vertices[0];
+	dest[4] = vertices[2];
+	dest[5] = vertices[3];
+}
+
+void ParallelDrawRecorder::Initialize(int recorder_count)
+{
+	Release();
+
+	for (int i = 0; i < recorder_count; i++)
+	{
+		m_RecorderList.push_back(new DrawCommandRecorder());
+	}
+}
+
+void ParallelDrawRecorder::Release()
+{
+	for (DrawCommandRecorder* recorder : m_RecorderList)
+	{
+		delete recorder;
+	}
+	m_RecorderList.clear();
+}
+
+void ParallelDrawRecorder::Clear()
+{
+	for (DrawCommandRecorder* recorder : m_RecorderList)
+	{
+		recorder->Clear();
+	}
+}
+
+DrawCommandRecorder* ParallelDrawRecorder::GetRecorder(int index)
+{
+	if (index < 0 || index >= (int)m_RecorderList.size())
+	{
+		return nullptr;
+	}
+
+	return m_RecorderList[index];
+}
+
+void ParallelDrawRecorder::Merge(DrawCommandList* out_command_list) const
+{
+	for (const DrawCommandRecorder* recorder : m_RecorderList)
+	{
+		out_command_list->Append(recorder->GetCommandList());
+	}
+}
@@ -0,0 +1,209 @@
+﻿/**
+* @file DrawCommandRecorder.h
+* @brief <pre>
+* ワーカースレッドで描画命令を記録するクラスの宣言
+* 記録は頂点の作成までを行い、デバイスは使用しないので描画バックエンドに関係なく動作する
+* 記録した命令はParallelDrawRecorder::Mergeで1つのリストにまとめ、ゲームスレッドでEngine::SubmitCommandListを実行して描画する
+* </pre>
+*/
+#ifndef DRAW_COMMAND_RECORDER_H_
+#define DRAW_COMMAND_RECORDER_H_
+
+#include <vector>
+#include "DrawCommandList.h"
+#include "EngineConstant.h"
+
+/**
+* @brief 描画命令記録クラス
+* @details <pre>
+* 1つのインスタンスは1つのスレッドからのみ使用する
+* 記録先のリストはClearしても確保したメモリを保持するので、フレームごとの記録用の領域として再利用される
+* テクスチャはEngine::GetTextureで取得したものを使用する(記録中にテクスチャの読み込み、解放を行わないこと)
+* 座標はワールド座標として記録し、カメラと座標変換はSubmitCommandListを実行した時点のものが適用される
+* </pre>
+*/
+class DrawCommandRecorder
+{
+public:
+	/** Constructor */
+	DrawCommandRecorder() :
+		m_CommandList(),
+		m_Layer(0),
+		m_Pivot(PivotType::LeftTop),
+		m_Filter(TextureFilterPoint)
+	{
+	}
+
+	/**
+	* @brief 全削除関数
+	* @details 記録した命令を全て削除する(描画レイヤー、軸、フィルタリングはそのまま)
+	*/
+	void Clear();
+
+	/**
+	* @brief 描画レイヤー設定関数
+	* @details 遅延描画で使用するレイヤーを設定する
+	* @param[in] layer 描画レイヤー(0～DrawLayerCount-1、範囲外は丸める)
+	*/
+	void SetLayer(int layer);
+
+	/**
+	* @brief 描画用矩形の軸設定関数
+	* @param[in] pivot_type 以降の矩形の記録に使用する軸
+	*/
+	void SetPivotType(PivotType pivot_type);
+
+	/**
+	* @brief テクスチャのフィルタリング設定関数
+	* @param[in] filter 以降の記録に使用するフィルタリング
+	*/
+	void SetTextureFilter(TextureFilter filter);
+
+	/**
+	* @brief 矩形記録関数
+	* @param[in] x X軸描画座標
+	* @param[in] y Y軸描画座標
+	* @param[in] width 矩形横幅
+	* @param[in] height 矩形縦幅
+	* @param[in] color 矩形の色
+	* @param[in] alpha 矩形のアルファ値
+	* @param[in] angle 回転角度(度数法)
+	* @param[in] scale_x 拡大率X
+	* @param[in] scale_y 拡大率Y
+	*/
+	void RecordRect(float x, float y, float width, float height, DWORD color, UCHAR alpha, float angle, float scale_x, float scale_y);
+
+	/**
+	* @brief テクスチャ記録関数
+	* @param[in] x X軸描画座標
+	* @param[in] y Y軸描画座標
+	* @param[in] texture 描画するテクスチャ
+	* @param[in] alpha テクスチャのアルファ値
+	* @param[in] angle 回転角度(度数法)
+	* @param[in] scale_x 拡大率X
+	* @param[in] scale_y 拡大率Y
+	*/
+	void RecordTexture(float x, float y, const Texture* texture, UCHAR alpha, float angle, float scale_x, float scale_y);
+
+	/**
+	* @brief テクスチャ記録関数(UV指定)
+	* @param[in] x X軸描画座標
+	* @param[in] y Y軸描画座標
+	* @param[in] texture 描画するテクスチャ
+	* @param[in] tex_x 描画するテクスチャの開始座標X(ピクセル)
+	* @param[in] tex_y 描画するテクスチャの開始座標Y(ピクセル)
+	* @param[in] sprite_width 描画するテクスチャの横幅(ピクセル)
+	* @param[in] sprite_height 描画するテクスチャの縦幅(ピクセル)
+	* @param[in] alpha テクスチャのアルファ値
+	* @param[in] angle 回転角度(度数法)
+	* @param[in] scale_x 拡大率X
+	* @param[in] scale_y 拡大率Y
+	*/
+	void RecordTextureUV(float x, float y, const Texture* texture, float tex_x, float tex_y, float sprite_width, float sprite_height, UCHAR alpha, float angle, float scale_x, float scale_y);
+
+	/**
+	* @brief 三角形リスト記録関数
+	* @param[in] texture 使用するテクスチャ(テクスチャなしの場合はnullptr)
+	* @param[in] vertices 頂点データ
+	* @param[in] vertex_count 頂点数(3の倍数)
+	*/
+	void RecordTriangles(const Texture* texture, const CustomVertex* vertices, int vertex_count);
+
+	/**
+	* @brief 記録した命令リストの取得関数
+	* @retval const DrawCommandList& 命令リスト
+	*/
+	const DrawCommandList& GetCommandList() const
+	{
+		return m_CommandList;
+	}
+
+private:
+	/**
+	* @brief 矩形の記録関数
+	* @details 矩形の4頂点に軸、拡縮、回転、移動を適用し、2つの三角形として記録する
+	* @param[in] texture 使用するテクスチャ
+	* @param[in] vertices 矩形の4頂点(左上から時計回り、座標は矩形の左上が原点)
+	* @param[in] width 矩形横幅
+	* @param[in] height 矩形縦幅
+	* @param[in] x X軸描画座標
+	* @param[in] y Y軸描画座標
+	* @param[in] angle 回転角度(度数法)
+	* @param[in] scale_x 拡大率X
+	* @param[in] scale_y 拡大率Y
+	*/
+	void RecordQuad(const Texture* texture, CustomVertex* vertices, float width, float height, float x, float y, float angle, float scale_x, float scale_y);
+
+private:
+	DrawCommandList m_CommandList;		//!< 記録した命令
+	int m_Layer;						//!< 描画レイヤー
+	PivotType m_Pivot;					//!< 描画用矩形の軸
+	TextureFilter m_Filter;				//!< テクスチャのフィルタリング
+};
+
+/**
+* @brief 並列描画記録クラス
+* @details <pre>
+* ワーカースレッドごとのDrawCommandRecorderを保持し、記録後に1つの命令リストにまとめる
+* 各スレッドは割り当てられた番号のレコーダーだけを使用するのでロックは行わない
+* レコーダーは個別に確保し、異なるスレッドの記録で同じキャッシュラインを更新しないようにしている
+* </pre>
+*/
+class ParallelDrawRecorder
+{
+public:
+	/** Constructor */
+	ParallelDrawRecorder() :
+		m_RecorderList()
+	{
+	}
+
+	/**
+	* @brief 初期化関数
+	* @param[in] recorder_count レコーダーの数(記録に使用するスレッドの数)
+	*/
+	void Initialize(int recorder_count);
+
+	/**
+	* @brief 解放関数
+	* @details 全てのレコーダーを解放する(使用を終えたら必ず実行する)
+	*/
+	void Release();
+
+	/**
+	* @brief 記録開始関数
+	* @details 全てのレコーダーの命令を削除する(ワーカースレッドが記録を始める前に実行する)
+	*/
+	void Clear();
+
+	/**
+	* @brief レコーダーの取得関数
+	* @retval DrawCommandRecorder* レコーダー(範囲外の場合はnullptr)
+	* @param[in] index レコーダーの番号(スレッドに割り当てた番号)
+	*/
+	DrawCommandRecorder* GetRecorder(int index);
+
+	/**
+	* @brief レコーダーの数の取得関数
+	* @retval int レコーダーの数
+	*/
+	int GetRecorderCount() const
+	{
+		return (int)m_RecorderList.size();
+	}
+
+	/**
+	* @brief 命令の統合関数
+	* @details <pre>
+	* 全てのワーカースレッドの記録が終わった後に実行する
+	* レコーダーの番号順に命令を連結するので、同じ記録内容なら毎回同じ順番になる
+	* </pre>
+	* @param[out] out_command_list 統合先の命令リスト(末尾に追加する)
+	*/
+	void Merge(DrawCommandList* out_command_list) const;
+
+private:
+	std::vector<DrawCommandRecorder*> m_RecorderList;	//!< スレッドごとのレコーダー
+};
+
+#endif
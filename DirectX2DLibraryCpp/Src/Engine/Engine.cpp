@@ -4,19 +4,25 @@
 #include "TextureManager.h"
 #include "Sound.h"
 #include "Engine.h"
+#include "Profiler.h"
 
 Engine* Engine::m_Instance = nullptr;
 
-bool Engine::Initialize(int width, int height, const char* title_str, bool is_window_mode)
+bool Engine::Initialize(int width, int height, const char* title_str, bool is_window_mode, RenderBackendType backend_type)
 {
+	PROFILE_FUNCTION();
+
 	m_Instance = new Engine();
 
+	// 各サブシステムが初期化時から使用できるように最初に初期化する
+	m_Instance->GetTaggedAllocator()->Initialize();
+
 	if (m_Instance->GetWindow()->MakeWindow(width, height, title_str) == false)
 	{
 		return false;
 	}
 
-	if (m_Instance->GetGraphics()->Initialize(is_window_mode) == false)
+	if (m_Instance->GetGraphics()->Initialize(width, height, is_window_mode, backend_type, m_Instance->GetFileSystem()) == false)
 	{
 		return false;
 	}
@@ -26,18 +32,43 @@ bool Engine::Initialize(int width, int height, const char* title_str, bool is_wi
 		return false;
 	}
 
-	if (m_Instance->GetSound()->Initialize() == false)
+	if (m_Instance->GetSound()->Initialize(m_Instance->GetFileSystem()) == false)
 	{
 		return false;
 	}
 
-	m_Instance->GetTextureManager()->Initialize();
+	m_Instance->GetTextureManager()->Initialize(nullptr, m_Instance->GetFileSystem());
+	m_Instance->GetBitmapFontManager()->Initialize();
+
+	// 論理コア数 - 1個のワーカースレッドを作成する(メインスレッドも完了待ちの間はジョブを実行する)
+	if (m_Instance->GetJobSystem()->Initialize(-1) == false)
+	{
+		return false;
+	}
+
+	if (m_Instance->GetFrameAllocator()->Initialize(DefaultFrameAllocatorSize) == false)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	m_Instance->m_PrevFrameCounter = counter.QuadPart;
 
 	return true;
 }
 
 void Engine::Release()
 {
+	PROFILE_FUNCTION();
+
+	m_Instance->GetRenderThread()->Stop();
+	m_Instance->GetAssetPreloader()->Cancel();
+	m_Instance->GetJobSystem()->Release();
+	m_Instance->GetFrameAllocator()->Release();
+
+	m_Instance->GetTextureHotReloader()->Stop();
+	m_Instance->GetBitmapFontManager()->Release();
 	m_Instance->GetTextureManager()->Release();
 	m_Instance->GetSound()->ReleaseAllSoundFiles();
 
@@ -45,56 +76,378 @@ void Engine::Release()
 	m_Instance->GetInput()->Release();
 	m_Instance->GetSound()->Release();
 
+	// 読み込み中のアセットがなくなってから閉じる
+	m_Instance->GetFileSystem()->UnmountAll();
+
+	// 解放漏れを検出できるように、全てのサブシステムを解放した後に解放する
+	m_Instance->GetTaggedAllocator()->Release();
+
 	delete m_Instance;
 }
 
 void Engine::Update()
 {
+	// 前フレームの計測結果を集計してからこのフレームの計測を始める
+	PROFILE_NEXT_FRAME();
+	PROFILE_FUNCTION();
+
+	// フレーム時間の計測
+	LARGE_INTEGER counter;
+	LARGE_INTEGER frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	float frame_time = (float)((counter.QuadPart - m_Instance->m_PrevFrameCounter) * 1000.0 / frequency.QuadPart);
+	m_Instance->m_PrevFrameCounter = counter.QuadPart;
+	m_Instance->GetPerformanceOverlay()->PushFrameTime(frame_time);
+
+	// 2フレーム前に確保した一時メモリをまとめて破棄する
+	m_Instance->GetFrameAllocator()->NextFrame();
+
 	m_Instance->GetWindow()->Update();
 	m_Instance->GetInput()->Update();
 	m_Instance->GetSound()->EraseDuplicateSound();
+
+	// 直近のフレームで使用したテクスチャは解放しないので、描画スレッドの完了を待たずに解放できる
+	m_Instance->GetTextureManager()->NextFrame();
+	m_Instance->GetTextureManager()->EvictTextures();
+
+	// デコードが完了していたらデバイスに送って登録する
+	m_Instance->GetAssetPreloader()->Update(m_Instance->GetTextureManager());
+
+	// 差し替えで古いテクスチャを解放するので、描画スレッドが使用していない時に差し替える
+	TextureHotReloader* hot_reloader = m_Instance->GetTextureHotReloader();
+	hot_reloader->RequestReloads();
+	if (hot_reloader->HasCompletedReload() == true)
+	{
+		m_Instance->GetRenderThread()->WaitIdle();
+		hot_reloader->ApplyReloads();
+	}
+
+	// デバイスが確保したバッファはアロケーターを経由しないので、サイズを集計に反映する
+	TaggedAllocator* allocator = m_Instance->GetTaggedAllocator();
+	allocator->SetExternalSize(MemoryTagTexture, (size_t)m_Instance->GetTextureManager()->GetTextureMemorySize() +
+		m_Instance->GetBitmapFontManager()->GetTextureMemorySize());
+	allocator->SetExternalSize(MemoryTagSound, m_Instance->GetSound()->GetBufferMemorySize());
 }
 
 bool Engine::StartDrawing(DWORD color)
 {
+	PROFILE_FUNCTION();
+
 	return m_Instance->GetGraphics()->StartDraw(color);
 }
 
 void Engine::FinishDrawing()
 {
+	PROFILE_FUNCTION();
+
+	PerformanceOverlay* overlay = m_Instance->GetPerformanceOverlay();
+	if (overlay->IsVisible() == true)
+	{
+		PerformanceOverlayInfo info;
+		info.Stats = m_Instance->GetGraphics()->GetFrameStats();
+		info.VoiceCount = m_Instance->GetSound()->GetPlayingVoiceCount();
+		info.TextureMemorySize = m_Instance->GetTextureManager()->GetTextureMemorySize() +
+			m_Instance->GetBitmapFontManager()->GetTextureMemorySize();
+		info.FrameMemorySize = m_Instance->GetFrameAllocator()->GetStats().UsedSize;
+
+		overlay->Draw(m_Instance->GetGraphics(), info);
+	}
+
 	m_Instance->GetGraphics()->FinishDraw();
 }
 
+bool Engine::StartRenderThread(int frame_count)
+{
+	PROFILE_FUNCTION();
+
+	return m_Instance->GetRenderThread()->Start(m_Instance->GetGraphics(), m_Instance->GetPerformanceOverlay(), frame_count);
+}
+
+void Engine::StopRenderThread()
+{
+	PROFILE_FUNCTION();
+
+	m_Instance->GetRenderThread()->Stop();
+}
+
+RenderFrame* Engine::BeginRenderFrame(DWORD color)
+{
+	PROFILE_FUNCTION();
+
+	RenderFrame* frame = m_Instance->GetRenderThread()->BeginFrame();
+	if (frame != nullptr)
+	{
+		frame->ClearColor = color;
+	}
+
+	return frame;
+}
+
+void Engine::SubmitRenderFrame()
+{
+	PROFILE_FUNCTION();
+
+	RenderThread* render_thread = m_Instance->GetRenderThread();
+	RenderFrame* frame = render_thread->BeginFrame();
+	if (frame == nullptr)
+	{
+		return;
+	}
+
+	// テクスチャの使用記録と解放済みテクスチャの読み込み直しは、TextureManagerを使用するゲームスレッドで行う
+	TouchCommandListTextures(frame->CommandList);
+
+	// サウンドとテクスチャの情報はゲームスレッドで取得してフレームに持たせる
+	frame->IsOverlayVisible = m_Instance->GetPerformanceOverlay()->IsVisible();
+	if (frame->IsOverlayVisible == true)
+	{
+		frame->OverlayInfo.VoiceCount = m_Instance->GetSound()->GetPlayingVoiceCount();
+		frame->OverlayInfo.TextureMemorySize = m_Instance->GetTextureManager()->GetTextureMemorySize() +
+			m_Instance->GetBitmapFontManager()->GetTextureMemorySize();
+		frame->OverlayInfo.FrameMemorySize = m_Instance->GetFrameAllocator()->GetStats().UsedSize;
+	}
+
+	render_thread->SubmitFrame();
+}
+
+void Engine::RunJob(JobFunction function, void* data, JobCounter* counter, JobCounter* dependency)
+{
+	m_Instance->GetJobSystem()->Run(function, data, counter, dependency);
+}
+
+void Engine::WaitJob(JobCounter* counter)
+{
+	PROFILE_FUNCTION();
+
+	m_Instance->GetJobSystem()->Wait(counter);
+}
+
+void Engine::ParallelFor(JobFunction function, void* data, int count, int grain_size)
+{
+	PROFILE_FUNCTION();
+
+	m_Instance->GetJobSystem()->ParallelFor(function, data, count, grain_size);
+}
+
+int Engine::GetJobWorkerCount()
+{
+	return m_Instance->GetJobSystem()->GetWorkerCount();
+}
+
+int Engine::GetJobWorkerIndex()
+{
+	return m_Instance->GetJobSystem()->GetCurrentWorkerIndex();
+}
+
+void* Engine::AllocateFrameMemory(size_t size, size_t alignment)
+{
+	return m_Instance->GetFrameAllocator()->Allocate(size, alignment);
+}
+
+const FrameAllocatorStats& Engine::GetFrameMemoryStats()
+{
+	return m_Instance->GetFrameAllocator()->GetStats();
+}
+
+void* Engine::AllocateMemory(MemoryTag tag, size_t size)
+{
+	return m_Instance->GetTaggedAllocator()->Allocate(tag, size);
+}
+
+void Engine::FreeMemory(void* memory)
+{
+	m_Instance->GetTaggedAllocator()->Free(memory);
+}
+
+void Engine::SetMemoryBudget(MemoryTag tag, size_t budget)
+{
+	m_Instance->GetTaggedAllocator()->SetBudget(tag, budget);
+}
+
+MemoryTagStats Engine::GetMemoryStats(MemoryTag tag)
+{
+	return m_Instance->GetTaggedAllocator()->GetTagStats(tag);
+}
+
+MemoryPoolStats Engine::GetMemoryPoolStats(int pool_index)
+{
+	return m_Instance->GetTaggedAllocator()->GetPoolStats(pool_index);
+}
+
 void Engine::DrawRect(float x, float y, float width, float height, DWORD color, UCHAR alpha, float angle, float scale_x, float scale_y)
 {
+	PROFILE_FUNCTION();
+
 	m_Instance->GetGraphics()->DrawRect(x, y, width, height, color, alpha, angle, scale_x, scale_y);
 }
 
 void Engine::DrawCircle(float x, float y, float radius, DWORD color, UCHAR alpha)
 {
+	PROFILE_FUNCTION();
+
 	m_Instance->GetGraphics()->DrawCircle(x, y, radius, color, alpha);
 }
 
 void Engine::DrawTexture(float x, float y, const char* texture_keyword, UCHAR alpha, float angle, float scale_x, float scale_y)
 {
+	PROFILE_FUNCTION();
+
 	m_Instance->GetGraphics()->DrawTexture(x, y, texture_keyword, alpha, angle, scale_x, scale_y);
 }
 
 void Engine::DrawTextureUV(float x, float y, const char* texture_keyword, float tex_x, float tex_y, float sprite_width, float sprite_height, UCHAR alpha, float angle, float scale_x, float scale_y)
 {
+	PROFILE_FUNCTION();
+
 	m_Instance->GetGraphics()->DrawTextureUV(x, y, texture_keyword, tex_x, tex_y, sprite_width, sprite_height, alpha, angle, scale_x, scale_y);
 }
 
 void Engine::DrawFont(float x, float y, const char* text, FontSize size, FontColor color)
 {
+	PROFILE_FUNCTION();
+
 	m_Instance->GetGraphics()->DrawFont(x, y, text, size, color);
 }
 
+void Engine::DrawFontEx(float x, float y, const char* text, int font_size, DWORD color, int wrap_width)
+{
+	PROFILE_FUNCTION();
+
+	m_Instance->GetGraphics()->DrawFontEx(x, y, text, font_size, color, wrap_width);
+}
+
+void Engine::DrawBitmapFont(float x, float y, const char* font_keyword, const char* text, DWORD color, float scale)
+{
+	PROFILE_FUNCTION();
+
+	m_Instance->GetGraphics()->DrawBitmapFont(x, y, m_Instance->GetBitmapFontManager()->GetBitmapFont(font_keyword), text, color, scale);
+}
+
+void Engine::SetCamera(float x, float y, float zoom, float angle)
+{
+	m_Instance->GetGraphics()->SetCamera(x, y, zoom, angle);
+}
+
+void Engine::ResetCamera()
+{
+	m_Instance->GetGraphics()->ResetCamera();
+}
+
+Camera2D Engine::GetCamera()
+{
+	return m_Instance->GetGraphics()->GetCamera();
+}
+
+bool Engine::PushTransform(float x, float y, float angle, float scale_x, float scale_y)
+{
+	Matrix2D transform = Matrix2D::Scaling(scale_x, scale_y);
+	transform = Matrix2D::Multiply(transform, Matrix2D::Rotation(angle));
+	transform = Matrix2D::Multiply(transform, Matrix2D::Translation(x, y));
+
+	return m_Instance->GetGraphics()->PushTransform(transform);
+}
+
+void Engine::PopTransform()
+{
+	m_Instance->GetGraphics()->PopTransform();
+}
+
+void Engine::SetTransformEnabled(bool is_enabled)
+{
+	m_Instance->GetGraphics()->SetTransformEnabled(is_enabled);
+}
+
+void Engine::DrawTilemap(Tilemap* tilemap)
+{
+	PROFILE_FUNCTION();
+
+	m_Instance->GetGraphics()->DrawTilemap(tilemap);
+}
+
+void Engine::DrawParticles(const ParticleEmitter* emitter)
+{
+	PROFILE_FUNCTION();
+
+	m_Instance->GetGraphics()->DrawParticles(emitter);
+}
+
+void Engine::UpdateParticles(ParticleEmitter* emitter, float delta_time)
+{
+	PROFILE_FUNCTION();
+
+	emitter->Update(delta_time, m_Instance->GetJobSystem());
+}
+
+void Engine::SetDeferredDrawing(bool is_enabled)
+{
+	m_Instance->GetGraphics()->SetDeferredDrawing(is_enabled);
+}
+
+void Engine::SetDrawLayer(int layer)
+{
+	m_Instance->GetGraphics()->SetDrawLayer(layer);
+}
+
+void Engine::SetTextureFilter(TextureFilter filter)
+{
+	m_Instance->GetGraphics()->SetTextureFilter(filter);
+}
+
+void Engine::SubmitCommandList(const DrawCommandList& command_list)
+{
+	TouchCommandListTextures(command_list);
+
+	m_Instance->GetGraphics()->SubmitCommandList(command_list);
+}
+
+void Engine::TouchCommandListTextures(const DrawCommandList& command_list)
+{
+	TextureManager* texture_manager = m_Instance->GetTextureManager();
+	const Texture* touched_texture = nullptr;
+
+	// 記録してから時間が経ったリストでもテクスチャが解放されていないように、使用を記録し直す
+	for (int i = 0; i < command_list.GetCount(); i++)
+	{
+		const DrawCommand& command = command_list.GetCommand(i);
+		if (command.TextureData != touched_texture)
+		{
+			touched_texture = command.TextureData;
+			texture_manager->TouchTexture(touched_texture);
+		}
+	}
+}
+
+Vec2 Engine::ConvertScreenToWorld(float x, float y)
+{
+	return m_Instance->GetGraphics()->ConvertScreenToWorld(Vec2(x, y));
+}
+
 void Engine::SetPivotType(PivotType pivot_type)
 {
 	m_Instance->GetGraphics()->SetPivotType(pivot_type);
 }
 
+FrameStats Engine::GetFrameStats()
+{
+	return m_Instance->GetGraphics()->GetFrameStats();
+}
+
+FrameStatsSummary Engine::GetFrameStatsSummary(FrameStatsItem item, float percentile)
+{
+	return m_Instance->GetGraphics()->GetFrameStatsHistory().GetSummary(item, percentile);
+}
+
+void Engine::SetPerformanceOverlayVisible(bool is_visible)
+{
+	m_Instance->GetPerformanceOverlay()->SetVisible(is_visible);
+}
+
+RenderBackend* Engine::GetRenderBackend()
+{
+	return m_Instance->GetGraphics()->GetBackend();
+}
+
 bool Engine::IsGamePadButtonHeld(GamePadKind button)
 {
 	GamePad* game_pad = m_Instance->GetInput()->GetGamePad();
@@ -157,57 +510,222 @@ Vec2 Engine::GetMousePos()
 
 void Engine::PlaySound(const char* keyword, bool is_loop)
 {
+	PROFILE_FUNCTION();
+
 	m_Instance->GetSound()->Play(keyword, is_loop);
 }
 
 void Engine::PlayDuplicateSound(const char* keyword)
 {
+	PROFILE_FUNCTION();
+
 	m_Instance->GetSound()->PlayDuplicate(keyword);
 }
 
 void Engine::StopSound(const char* keyword)
 {
+	PROFILE_FUNCTION();
+
 	m_Instance->GetSound()->Stop(keyword);
 }
 
 bool Engine::LoadSoundFile(const char* keyword, const char* file_name)
 {
+	PROFILE_FUNCTION();
+
 	return m_Instance->GetSound()->LoadSoundFile(keyword, file_name);
 }
 
 void Engine::ReleaseSoundFile(const char* keyword)
 {
+	PROFILE_FUNCTION();
+
 	m_Instance->GetSound()->ReleaseSoundFile(keyword);
 }
 
 void Engine::ReleaseAllSoundFiles()
 {
+	PROFILE_FUNCTION();
+
 	m_Instance->GetSound()->ReleaseAllSoundFiles();
 }
 
+SoundMemoryStats Engine::GetSoundMemoryStats()
+{
+	return m_Instance->GetSound()->GetStats();
+}
+
 bool Engine::LoadTexture(const char* keyword, const char* file_name)
 {
+	PROFILE_FUNCTION();
+
 	return m_Instance->GetTextureManager()->LoadTexture(keyword, file_name);
 }
 
 void Engine::ReleaseAllTextures()
 {
+	PROFILE_FUNCTION();
+
+	// 描画スレッドが使用中のテクスチャを解放しないように描画の完了を待つ
+	m_Instance->GetRenderThread()->WaitIdle();
+
 	m_Instance->GetTextureManager()->ReleaseAllTextures();
 }
 
 void Engine::ReleaseTexture(const char* keyword)
 {
+	PROFILE_FUNCTION();
+
+	m_Instance->GetRenderThread()->WaitIdle();
+
 	m_Instance->GetTextureManager()->ReleaseTexture(keyword);
 }
 
 Texture* Engine::GetTexture(const char* keyword)
 {
+	// Graphicsを単体で使用している場合(ヘッドレスのベンチマークなど)はテクスチャを登録できない
+	if (m_Instance == nullptr)
+	{
+		return nullptr;
+	}
+
 	return m_Instance->GetTextureManager()->GetTexture(keyword);
 }
 
-bool Engine::CreateTexture(const char* file_name, Texture* texture_data)
+void Engine::TouchTexture(const Texture* texture)
+{
+	if (m_Instance == nullptr)
+	{
+		return;
+	}
+
+	m_Instance->GetTextureManager()->TouchTexture(texture);
+}
+
+void Engine::SetTextureBudget(size_t budget)
+{
+	m_Instance->GetTextureManager()->SetBudget(budget);
+}
+
+TextureMemoryStats Engine::GetTextureMemoryStats()
 {
-	return m_Instance->GetGraphics()->CreateTexture(file_name, texture_data);
+	return m_Instance->GetTextureManager()->GetStats();
+}
+
+bool Engine::StartTextureHotReload(const char* directory)
+{
+	PROFILE_FUNCTION();
+
+	return m_Instance->GetTextureHotReloader()->Start(directory, m_Instance->GetTextureManager());
+}
+
+void Engine::StopTextureHotReload()
+{
+	PROFILE_FUNCTION();
+
+	m_Instance->GetTextureHotReloader()->Stop();
+}
+
+const TextureHotReloadStats& Engine::GetTextureHotReloadStats()
+{
+	return m_Instance->GetTextureHotReloader()->GetStats();
+}
+
+bool Engine::EnableTextureCache(const char* directory)
+{
+	PROFILE_FUNCTION();
+
+	return m_Instance->GetGraphics()->EnableTextureCache(directory);
+}
+
+TextureCacheStats Engine::GetTextureCacheStats()
+{
+	return m_Instance->GetGraphics()->GetTextureCacheStats();
+}
+
+void Engine::SetTextureMipmapGeneration(bool is_enabled)
+{
+	m_Instance->GetGraphics()->SetMipmapGeneration(is_enabled);
+}
+
+bool Engine::StartPreload(const char* manifest_file, PreloadProgressCallback callback, void* data)
+{
+	PROFILE_FUNCTION();
+
+	return m_Instance->GetAssetPreloader()->Start(
+		manifest_file,
+		m_Instance->GetJobSystem(),
+		m_Instance->GetGraphics(),
+		m_Instance->GetSound(),
+		callback,
+		data);
+}
+
+bool Engine::IsPreloading()
+{
+	return m_Instance->GetAssetPreloader()->IsLoading();
+}
+
+void Engine::WaitPreload()
+{
+	PROFILE_FUNCTION();
+
+	m_Instance->GetAssetPreloader()->Wait(m_Instance->GetTextureManager());
+}
+
+const PreloadStats& Engine::GetPreloadStats()
+{
+	return m_Instance->GetAssetPreloader()->GetStats();
+}
+
+bool Engine::MountArchive(const char* file_name)
+{
+	PROFILE_FUNCTION();
+
+	// ワーカースレッドが検索している間は読み込み元を変更できない
+	m_Instance->GetAssetPreloader()->Wait(m_Instance->GetTextureManager());
+
+	return m_Instance->GetFileSystem()->MountArchive(file_name);
+}
+
+void Engine::UnmountAllArchives()
+{
+	PROFILE_FUNCTION();
+
+	m_Instance->GetAssetPreloader()->Wait(m_Instance->GetTextureManager());
+	m_Instance->GetFileSystem()->UnmountAll();
+}
+
+bool Engine::LoadBitmapFont(const char* keyword, const char* file_name)
+{
+	PROFILE_FUNCTION();
+
+	return m_Instance->GetBitmapFontManager()->LoadBitmapFont(keyword, file_name);
+}
+
+void Engine::ReleaseAllBitmapFonts()
+{
+	PROFILE_FUNCTION();
+
+	m_Instance->GetRenderThread()->WaitIdle();
+
+	m_Instance->GetBitmapFontManager()->ReleaseAllBitmapFonts();
+}
+
+void Engine::ReleaseBitmapFont(const char* keyword)
+{
+	PROFILE_FUNCTION();
+
+	m_Instance->GetRenderThread()->WaitIdle();
+
+	m_Instance->GetBitmapFontManager()->ReleaseBitmapFont(keyword);
+}
+
+bool Engine::CreateTexture(const char* file_name, Texture* texture_data, FileContentHash* out_hash)
+{
+	PROFILE_FUNCTION();
+
+	return m_Instance->GetGraphics()->CreateTexture(file_name, texture_data, out_hash);
 }
 
 bool Engine::IsClosedWindow()
@@ -219,3 +737,25 @@ bool Engine::IsRecievedWindowMessage()
 {
 	return m_Instance->GetWindow()->IsRecievedMessage();
 }
+
+const ProfileZoneStat* Engine::GetProfileZoneStats(int* out_count)
+{
+#ifdef ENABLE_PROFILER
+	return Profiler::GetFrameZoneStats(out_count);
+#else
+	if (out_count != nullptr)
+	{
+		*out_count = 0;
+	}
+	return nullptr;
+#endif
+}
+
+bool Engine::WriteProfileTrace(const char* file_name)
+{
+#ifdef ENABLE_PROFILER
+	return Profiler::WriteChromeTrace(file_name);
+#else
+	return false;
+#endif
+}
@@ -5,12 +5,23 @@
 #ifndef ENGINE_H_
 #define ENGINE_H_
 
+#include "AssetPreloader.h"
 #include "Graphics.h"
 #include "TextureManager.h"
+#include "TextureHotReloader.h"
+#include "BitmapFontManager.h"
+#include "DrawCommandRecorder.h"
+#include "FileSystem.h"
+#include "FrameAllocator.h"
 #include "Input.h"
+#include "JobSystem.h"
 #include "Sound.h"
+#include "TaggedAllocator.h"
 #include "EngineConstant.h"
 #include "Window.h"
+#include "Profiler.h"
+#include "PerformanceOverlay.h"
+#include "RenderThread.h"
 
 /** @brief エンジンクラス */
 class Engine
@@ -29,8 +40,9 @@ public:
 	* @param[in] height ウィンドウの縦幅
 	* @param[in] title_str タイトルバーに表示する文字列
 	* @param[in] is_window_mode ウィンドウ or Fullスクリーン設定フラグ(オプション)
+	* @param[in] backend_type 描画バックエンドの種類(オプション)
 	*/
-	static bool Initialize(int width, int height, const char* title_str, bool is_window_mode = true);
+	static bool Initialize(int width, int height, const char* title_str, bool is_window_mode = true, RenderBackendType backend_type = RenderBackendType::RenderBackendTypeD3D9);
 
 	/**
 	* @brief 解放関数
@@ -72,6 +84,192 @@ public:
 	*/
 	static void FinishDrawing();
 
+	/**
+	* @brief 描画スレッドの開始関数
+	* @details <pre>
+	* 描画とPresentを専用のスレッドで行うモードを開始する
+	* 開始後はStartDrawing、FinishDrawing、Draw系の関数は使用せず、
+	* BeginRenderFrameで取得したフレームに命令を記録してSubmitRenderFrameで描画スレッドに渡す
+	* </pre>
+	* @retval true 開始成功
+	* @retval false 開始失敗
+	* @param[in] frame_count 処理中にできるフレーム数(2の場合、フレームNの描画中にフレームN+1を処理できる)(オプション)
+	*/
+	static bool StartRenderThread(int frame_count = 2);
+
+	/**
+	* @brief 描画スレッドの停止関数
+	* @details 渡したフレームを全て描画してから描画スレッドを終了し、通常の描画に戻す
+	*/
+	static void StopRenderThread();
+
+	/**
+	* @brief 描画スレッドに渡すフレームの取得関数
+	* @details <pre>
+	* 命令リストが空のフレームを返す(カメラは前のフレームの設定を引き継ぐ)
+	* 処理中のフレームがframe_count個ある場合は、描画スレッドが描画を終えるまで待機する
+	* </pre>
+	* @retval RenderFrame* 記録するフレーム(描画スレッドを開始していない場合はnullptr)
+	* @param[in] color クリアカラー
+	*/
+	static RenderFrame* BeginRenderFrame(DWORD color);
+
+	/**
+	* @brief フレームの送信関数
+	* @details BeginRenderFrameで取得したフレームを描画スレッドに渡し、描画の完了を待たずに戻る
+	*/
+	static void SubmitRenderFrame();
+
+	/**
+	* @brief ジョブの追加関数
+	* @details <pre>
+	* エンジンのワーカースレッドでジョブを実行する
+	* ジョブの追加と完了待ちはメインスレッドか、ジョブの処理関数の中で行う
+	* </pre>
+	* @param[in] function 処理関数(begin = 0、end = 1で呼ばれる)
+	* @param[in] data 処理関数に渡すデータ
+	* @param[in] counter 完了を待つためのカウンター(nullptrの場合は使用しない)
+	* @param[in] dependency 先に完了している必要があるジョブのカウンター(オプション)
+	*/
+	static void RunJob(JobFunction function, void* data, JobCounter* counter, JobCounter* dependency = nullptr);
+
+	/**
+	* @brief ジョブの完了待ち関数
+	* @details 待機中はメインスレッドもジョブを実行する
+	* @param[in] counter 待機するカウンター
+	*/
+	static void WaitJob(JobCounter* counter);
+
+	/**
+	* @brief 並列ループ関数
+	* @details 0～countの範囲をgrain_sizeごとに分割してワーカースレッドで実行し、全て完了するまで待機する
+	* @param[in] function 処理関数(分割した範囲で呼ばれる)
+	* @param[in] data 処理関数に渡すデータ
+	* @param[in] count 範囲の要素数
+	* @param[in] grain_size 1つのジョブで処理する要素数
+	*/
+	static void ParallelFor(JobFunction function, void* data, int count, int grain_size);
+
+	/**
+	* @brief ジョブのワーカー数の取得関数
+	* @retval int メインスレッドを含めたワーカーの数(ParallelDrawRecorderのレコーダー数などに使用する)
+	*/
+	static int GetJobWorkerCount();
+
+	/**
+	* @brief 現在のワーカー番号の取得関数
+	* @retval int ワーカー番号(0はメインスレッド、ワーカースレッドではない場合は-1)
+	*/
+	static int GetJobWorkerIndex();
+
+	/**
+	* @brief フレームメモリの確保関数
+	* @details <pre>
+	* 次の次のUpdateまで有効な一時メモリを確保する(解放は不要)
+	* 頂点配列などのフレーム内だけで使用する作業領域に使用する
+	* メインスレッドからのみ使用できる
+	* </pre>
+	* @retval void* 確保したメモリ
+	* @param[in] size 確保するバイト数
+	* @param[in] alignment アライメント(2のべき乗)(オプション)
+	*/
+	static void* AllocateFrameMemory(size_t size, size_t alignment = DefaultFrameAlignment);
+
+	/**
+	* @brief フレームメモリの配列確保関数
+	* @details 要素のコンストラクタは実行されないので、初期化してから使用する
+	* @retval T* 確保した配列
+	* @param[in] count 要素数
+	*/
+	template<class T>
+	static T* AllocateFrameArray(int count)
+	{
+		return m_Instance->GetFrameAllocator()->AllocateArray<T>(count);
+	}
+
+	/**
+	* @brief フレームメモリの使用状況の取得関数
+	* @retval const FrameAllocatorStats& 前のフレームの使用量と最大使用量
+	*/
+	static const FrameAllocatorStats& GetFrameMemoryStats();
+
+	/**
+	* @brief タグ付きメモリの確保関数
+	* @details <pre>
+	* 確保したサイズをタグごとに集計する(GetMemoryStatsで取得できる)
+	* 小さい確保は固定長プールから行うので、小さいオブジェクトを頻繁に確保する場合に使用する
+	* 複数のスレッドから使用できる
+	* </pre>
+	* @retval void* 確保したメモリ(16バイト境界)
+	* @param[in] tag タグ
+	* @param[in] size 確保するバイト数
+	*/
+	static void* AllocateMemory(MemoryTag tag, size_t size);
+
+	/**
+	* @brief タグ付きメモリの解放関数
+	* @param[in] memory AllocateMemoryで確保したメモリ
+	*/
+	static void FreeMemory(void* memory);
+
+	/**
+	* @brief タグ付きオブジェクトの生成関数
+	* @details 初期化前はタグを集計せずにヒープから確保するので、Graphicsなどをエンジンの外で単体で使用できる
+	* @retval T* 生成したオブジェクト(DeleteObjectで破棄する)
+	* @param[in] tag タグ
+	* @param[in] args コンストラクタの引数
+	*/
+	template<class T, class... Args>
+	static T* NewObject(MemoryTag tag, Args&&... args)
+	{
+		void* memory = TaggedAllocator::AllocateGlobal(tag, sizeof(T));
+		if (memory == nullptr)
+		{
+			return nullptr;
+		}
+
+		return new(memory) T(std::forward<Args>(args)...);
+	}
+
+	/**
+	* @brief タグ付きオブジェクトの破棄関数
+	* @param[in] object NewObjectで生成したオブジェクト(nullptrの場合は何もしない)
+	*/
+	template<class T>
+	static void DeleteObject(T* object)
+	{
+		if (object == nullptr)
+		{
+			return;
+		}
+
+		object->~T();
+		TaggedAllocator::FreeGlobal(object);
+	}
+
+	/**
+	* @brief メモリ予算の設定関数
+	* @details 合計サイズが予算を超えた時にデバッグ出力に警告を出力する
+	* @param[in] tag タグ
+	* @param[in] budget 予算(バイト、0の場合は予算なし)
+	*/
+	static void SetMemoryBudget(MemoryTag tag, size_t budget);
+
+	/**
+	* @brief タグごとのメモリ使用状況の取得関数
+	* @details テクスチャとサウンドのタグには、デバイスが確保したバッファのサイズがUpdateごとに反映される
+	* @retval MemoryTagStats 使用状況
+	* @param[in] tag タグ
+	*/
+	static MemoryTagStats GetMemoryStats(MemoryTag tag);
+
+	/**
+	* @brief 固定長プールの使用状況の取得関数
+	* @retval MemoryPoolStats 使用状況
+	* @param[in] pool_index プールの番号(0～MemoryPoolCount - 1)
+	*/
+	static MemoryPoolStats GetMemoryPoolStats(int pool_index);
+
 	/**
 	* @brief 矩形描画関数
 	* @details 指定された位置に矩形を描画する
@@ -139,6 +337,167 @@ public:
 	*/
 	static 	void DrawFont(float x, float y, const char* text, FontSize size, FontColor color);
 
+	/**
+	* @brief フォント描画関数 サイズ、色指定バージョン
+	* @details <pre>
+	* 指定された位置に任意のサイズ、色でフォントを描画する
+	* 続けて描画した文字列は1回の描画命令にまとめられる
+	* 同じ文字列、サイズ、折り返し幅の2回目以降の描画はキャッシュしたレイアウトを使用する
+	* </pre>
+	* @param[in] x X軸描画座標
+	* @param[in] y Y軸描画座標
+	* @param[in] text 描画するテキスト(改行対応)
+	* @param[in] font_size フォントサイズ(ピクセル)
+	* @param[in] color フォントの色(ARGB形式)
+	* @param[in] wrap_width 折り返す横幅(ピクセル、0の場合は折り返さない)
+	*/
+	static void DrawFontEx(float x, float y, const char* text, int font_size, DWORD color, int wrap_width = 0);
+
+	/**
+	* @brief ビットマップフォント描画関数
+	* @details <pre>
+	* LoadBitmapFontで読み込んだフォントで文字列を描画する
+	* GDIを使用せず、描画中にメモリ確保も行わないので、スコアなど毎フレーム更新する文字列に向いている
+	* </pre>
+	* @param[in] x X軸描画座標
+	* @param[in] y Y軸描画座標
+	* @param[in] font_keyword 描画に使用するフォントのキーワード
+	* @param[in] text 描画するテキスト(UTF-8、改行対応)
+	* @param[in] color フォントの色(ARGB形式)
+	* @param[in] scale 拡大率
+	*/
+	static void DrawBitmapFont(float x, float y, const char* font_keyword, const char* text, DWORD color = D3DCOLOR_ARGB(255, 255, 255, 255), float scale = 1.0f);
+
+	/**
+	* @brief カメラ設定関数
+	* @details <pre>
+	* 以降の描画の座標をワールド座標として扱い、カメラから見た位置に描画する
+	* スクロールする場合はオブジェクトの座標をずらさずにカメラの位置を変更する
+	* </pre>
+	* @param[in] x 画面の中心に表示するワールド座標X
+	* @param[in] y 画面の中心に表示するワールド座標Y
+	* @param[in] zoom 拡大率
+	* @param[in] angle 回転角度(度数法)
+	*/
+	static void SetCamera(float x, float y, float zoom = 1.0f, float angle = 0.0f);
+
+	/**
+	* @brief カメラ初期化関数
+	* @details ワールド座標と画面座標が一致する状態(初期状態)に戻す
+	*/
+	static void ResetCamera();
+
+	/**
+	* @brief カメラ取得関数
+	* @retval Camera2D 現在のカメラ
+	*/
+	static Camera2D GetCamera();
+
+	/**
+	* @brief 座標変換の追加関数
+	* @details <pre>
+	* 拡縮、回転、移動の順に行う変換をスタックに積む
+	* 以降の描画の座標は追加した変換のローカル座標として扱われ、PopTransformで元に戻る
+	* 親子関係のあるオブジェクトの描画に使用する
+	* </pre>
+	* @retval true 追加成功
+	* @retval false スタックの上限を超えた
+	* @param[in] x 移動量X
+	* @param[in] y 移動量Y
+	* @param[in] angle 回転角度(度数法)
+	* @param[in] scale_x 拡大率X
+	* @param[in] scale_y 拡大率Y
+	*/
+	static bool PushTransform(float x, float y, float angle = 0.0f, float scale_x = 1.0f, float scale_y = 1.0f);
+
+	/**
+	* @brief 座標変換の削除関数
+	* @details 最後にPushTransformで追加した変換を取り除く
+	*/
+	static void PopTransform();
+
+	/**
+	* @brief 座標変換の有効設定関数
+	* @details falseの場合はカメラと座標変換を無視して画面座標で描画する(UIの描画などに使用する)
+	* @param[in] is_enabled 有効にする場合はtrue
+	*/
+	static void SetTransformEnabled(bool is_enabled);
+
+	/**
+	* @brief タイルマップ描画関数
+	* @details <pre>
+	* タイルを変更したチャンクだけ頂点を作り直し、画面に表示される範囲のチャンクを描画する
+	* タイルマップはTilemap::Initializeで作成したものを使用する
+	* </pre>
+	* @param[in] tilemap 描画するタイルマップ
+	*/
+	static void DrawTilemap(Tilemap* tilemap);
+
+	/**
+	* @brief パーティクル描画関数
+	* @details <pre>
+	* エミッターのパーティクルを描画する
+	* エミッターの更新(ParticleEmitter::Update)は描画の前に行っておく
+	* </pre>
+	* @param[in] emitter 描画するエミッター
+	*/
+	static void DrawParticles(const ParticleEmitter* emitter);
+
+	/**
+	* @brief パーティクル更新関数
+	* @details パーティクルの移動をワーカースレッドに分割して行う
+	* @param[in] emitter 更新するエミッター
+	* @param[in] delta_time 経過時間(秒)
+	*/
+	static void UpdateParticles(ParticleEmitter* emitter, float delta_time);
+
+	/**
+	* @brief 遅延描画の有効設定関数
+	* @details <pre>
+	* trueの場合は描画を記録し、FinishDrawingでレイヤー、重なり、テクスチャの順に並び替えてから描画する
+	* 重ならない描画は同じテクスチャごとにまとめられるので、描画命令の数を減らせる
+	* </pre>
+	* @param[in] is_enabled 有効にする場合はtrue
+	*/
+	static void SetDeferredDrawing(bool is_enabled);
+
+	/**
+	* @brief 描画レイヤー設定関数
+	* @details 遅延描画で以降の描画に使用するレイヤーを設定する(番号が大きいほど手前に描画される)
+	* @param[in] layer 描画レイヤー(0～255)
+	*/
+	static void SetDrawLayer(int layer);
+
+	/**
+	* @brief テクスチャのフィルタリング設定関数
+	* @details <pre>
+	* 以降の描画で使用するフィルタリングを設定する(初期値はTextureFilterPoint)
+	* 縮小して描画するテクスチャはミップマップを作成し、TextureFilterTrilinearで描画するとちらつきが減る
+	* </pre>
+	* @param[in] filter フィルタリング
+	*/
+	static void SetTextureFilter(TextureFilter filter);
+
+	/**
+	* @brief 記録済み命令リストの描画関数
+	* @details <pre>
+	* ワーカースレッドでDrawCommandRecorderに記録し、ParallelDrawRecorder::Mergeでまとめた命令を描画する
+	* StartDrawingとFinishDrawingの間に、ゲームスレッドで実行する
+	* 描画スレッドの使用中はBeginRenderFrameで取得したフレームの命令リストに追加する
+	* </pre>
+	* @param[in] command_list 命令リスト
+	*/
+	static void SubmitCommandList(const DrawCommandList& command_list);
+
+	/**
+	* @brief 画面座標からワールド座標への変換関数
+	* @details マウス座標からワールド上の位置を求める場合などに使用する
+	* @retval Vec2 ワールド座標
+	* @param[in] x 画面座標X
+	* @param[in] y 画面座標Y
+	*/
+	static Vec2 ConvertScreenToWorld(float x, float y);
+
 	/**
 	* @brief 描画用矩形の軸設定関数
 	* @details 指定された軸の値をm_CurrentPivotに設定する
@@ -146,6 +505,49 @@ public:
 	*/
 	static void SetPivotType(PivotType pivot_type);
 
+	/**
+	* @brief 描画統計の取得関数
+	* @details <pre>
+	* 直前に描画が終了したフレームの描画統計(描画命令数、頂点数など)を取得する
+	* 統計はFinishDrawingの実行時に更新される
+	* </pre>
+	* @retval FrameStats 描画統計
+	*/
+	static FrameStats GetFrameStats();
+
+	/**
+	* @brief 描画統計履歴の集計関数
+	* @details <pre>
+	* 直近FrameStatsHistorySizeフレーム分の描画統計から
+	* 指定された項目の最小、最大、平均、パーセンタイル値を求める
+	* パフォーマンス予算の確認に使用する
+	* </pre>
+	* @retval FrameStatsSummary 集計結果
+	* @param[in] item 集計する項目
+	* @param[in] percentile 求めるパーセンタイル(0.0～100.0)(オプション)
+	*/
+	static FrameStatsSummary GetFrameStatsSummary(FrameStatsItem item, float percentile = 95.0f);
+
+	/**
+	* @brief パフォーマンスオーバーレイの表示設定関数
+	* @details <pre>
+	* フレーム時間のグラフ、FPS、描画命令数、再生中のサウンド数、テクスチャの使用メモリを画面左上に表示する
+	* オーバーレイはFinishDrawingの実行時に描画され、描画統計には含まれない
+	* </pre>
+	* @param[in] is_visible 表示する場合はtrue
+	*/
+	static void SetPerformanceOverlayVisible(bool is_visible);
+
+	/**
+	* @brief 描画バックエンドの取得関数
+	* @details <pre>
+	* Initializeで指定した描画バックエンドを取得する
+	* RenderBackendTypeRecordingの場合はRecordingRenderBackendにキャストして記録内容を確認できる
+	* </pre>
+	* @retval RenderBackend* 描画バックエンド
+	*/
+	static RenderBackend* GetRenderBackend();
+
 	// 入力関連
 	/**
 	* @brief ゲームパッドボタンの押下状態判定関数
@@ -277,6 +679,13 @@ public:
 	*/
 	static void ReleaseAllSoundFiles();
 
+	/**
+	* @brief サウンド使用メモリの状況の取得関数
+	* @details 同じ内容のサウンドを複数のキーワードで読み込んだ場合は波形データを共有し、共有で節約したバイト数を返す
+	* @retval SoundMemoryStats 使用メモリの状況
+	*/
+	static SoundMemoryStats GetSoundMemoryStats();
+
 	// テクスチャ関連
 	/**
 	* @brief テクスチャ読み込み関数
@@ -303,12 +712,184 @@ public:
 
 	/**
 	* @brief テクスチャデータの取得関数
-	* @details 指定されたキーワードのテクスチャデータを取得する
+	* @details <pre>
+	* 指定されたキーワードのテクスチャデータを取得する
+	* 予算を超えて解放されていたテクスチャは読み込み直してから返す
+	* 初期化前はnullptrを返す(Graphicsを単体で使用する場合はキーワードのテクスチャを描画しない)
+	* </pre>
 	* @retval Texture* テクスチャデータ(取得失敗時はnullptr)
 	* @param[in] keyword 取得したいテクスチャのキーワード
 	*/
 	static Texture* GetTexture(const char* keyword);
 
+	/**
+	* @brief テクスチャの使用記録関数
+	* @details <pre>
+	* GetTextureで取得したテクスチャを保持して描画する場合に、使用中として記録して予算超過時の解放の対象から外す
+	* DrawTilemap、SubmitCommandList、SubmitRenderFrameは内部で実行するので、使用者が実行する必要はない
+	* TextureManagerはゲームスレッドだけが使用するので、ゲームスレッドで実行する
+	* 初期化前は何もしない
+	* </pre>
+	* @param[in] texture GetTextureで取得したテクスチャ
+	*/
+	static void TouchTexture(const Texture* texture);
+
+	/**
+	* @brief テクスチャ予算の設定関数
+	* @details <pre>
+	* 読み込まれているテクスチャの合計が予算を超えた場合、Updateで最後に使用したフレームが古い順に解放する
+	* 解放したテクスチャは次に描画した時に読み込み直す
+	* </pre>
+	* @param[in] budget 予算(バイト、0の場合は予算なし)
+	*/
+	static void SetTextureBudget(size_t budget);
+
+	/**
+	* @brief テクスチャ使用メモリの状況の取得関数
+	* @details 同じ内容のテクスチャを複数のキーワードで読み込んだ場合は共有し、共有で節約したバイト数を返す
+	* @retval TextureMemoryStats 使用メモリの状況
+	*/
+	static TextureMemoryStats GetTextureMemoryStats();
+
+	/**
+	* @brief テクスチャのホットリロードの開始関数
+	* @details <pre>
+	* 指定したフォルダ(サブフォルダを含む)の画像ファイルの変更を監視し、変更されたファイルを読み込んでいるテクスチャを読み込み直す
+	* 読み込みは別のスレッドで行い、Updateで差し替えるので、キーワードとGetTextureで取得したポインタはそのまま使用できる
+	* 差し替えにかかった時間はデバッグ出力とGetTextureHotReloadStatsで確認できる
+	* 開発中に使用する機能なので、製品版では開始しない
+	* </pre>
+	* @retval true 開始成功
+	* @retval false 開始失敗(フォルダを開けなかった)
+	* @param[in] directory 監視するフォルダ(LoadTextureで指定したファイル名と同じ基準のパス)
+	*/
+	static bool StartTextureHotReload(const char* directory);
+
+	/**
+	* @brief テクスチャのホットリロードの停止関数
+	*/
+	static void StopTextureHotReload();
+
+	/**
+	* @brief テクスチャのホットリロードの状況の取得関数
+	* @retval const TextureHotReloadStats& 読み込み直した数と差し替えにかかった時間
+	*/
+	static const TextureHotReloadStats& GetTextureHotReloadStats();
+
+	/**
+	* @brief テクスチャキャッシュの有効化関数
+	* @details <pre>
+	* 画像ファイルをデコードしたテクセルを指定したフォルダに保存し、次回の起動からはメモリマップで読み込んでデコードを省略する
+	* 元の画像ファイルのサイズか更新日時が変わった場合はデコードし直して保存し直す
+	* テクスチャを読み込む前に実行する
+	* </pre>
+	* @retval true 有効化成功
+	* @retval false 有効化失敗(フォルダを作成できなかった)
+	* @param[in] directory キャッシュファイルを保存するフォルダ
+	*/
+	static bool EnableTextureCache(const char* directory);
+
+	/**
+	* @brief テクスチャキャッシュの使用状況の取得関数
+	* @retval TextureCacheStats キャッシュから読み込んだ数とデコードした数
+	*/
+	static TextureCacheStats GetTextureCacheStats();
+
+	/**
+	* @brief ミップマップ作成の有効設定関数
+	* @details <pre>
+	* trueの場合は以降に読み込むテクスチャに1x1までのミップマップを作成する(使用メモリは約4/3倍になる)
+	* ミップマップはSetTextureFilterでTextureFilterTrilinearを設定した描画で使用される
+	* テクスチャを読み込む前に実行する
+	* </pre>
+	* @param[in] is_enabled 有効にする場合はtrue
+	*/
+	static void SetTextureMipmapGeneration(bool is_enabled);
+
+	// 一括読み込み関連
+	/**
+	* @brief 一括読み込みの開始関数
+	* @details <pre>
+	* マニフェストに列挙したテクスチャとサウンドの読み込みを開始し、すぐに戻る
+	* ファイルの読み込みとデコードはワーカースレッドで並列に行い、全て完了したUpdateでまとめてデバイスに送って登録する
+	* 読み込み中もゲームループを回せるので、callbackで通知される進捗でロード画面を描画できる
+	* マニフェストは1行に「種類(textureかsound),キーワード,ファイル名」を記述する
+	* </pre>
+	* @retval true 開始成功
+	* @retval false 開始失敗(読み込み中、またはマニフェストを読み込めなかった)
+	* @param[in] manifest_file マニフェストのファイル名
+	* @param[in] callback 進捗の通知関数(Updateで呼ばれる、nullptrの場合は通知しない)(オプション)
+	* @param[in] data 通知関数に渡すデータ(オプション)
+	*/
+	static bool StartPreload(const char* manifest_file, PreloadProgressCallback callback = nullptr, void* data = nullptr);
+
+	/**
+	* @brief 一括読み込み中の確認関数
+	* @retval true 読み込み中
+	* @retval false 読み込んでいない、または完了した
+	*/
+	static bool IsPreloading();
+
+	/**
+	* @brief 一括読み込みの完了待ち関数
+	* @details ロード画面を表示しない場合に使用する(待機中はメインスレッドもデコードを行う)
+	*/
+	static void WaitPreload();
+
+	/**
+	* @brief 一括読み込みの結果の取得関数
+	* @retval const PreloadStats& 最後に完了した一括読み込みの失敗数と時間
+	*/
+	static const PreloadStats& GetPreloadStats();
+
+	// アーカイブ関連
+	/**
+	* @brief アーカイブのマウント関数
+	* @details <pre>
+	* Tools/AssetPackerで作成したアーカイブをメモリマップで開き、以降のテクスチャとサウンドの読み込みでアーカイブを先に検索する
+	* ファイル名はアーカイブ作成時に指定したフォルダからのパス(例：Res/Enemy.png)で、大文字小文字と区切り文字は区別しない
+	* アーカイブにないファイルは通常のファイルから読み込む
+	* 複数マウントした場合は先にマウントしたアーカイブを優先する
+	* </pre>
+	* @retval true マウント成功
+	* @retval false マウント失敗(ファイルがない、または形式が不正)
+	* @param[in] file_name アーカイブのファイル名
+	*/
+	static bool MountArchive(const char* file_name);
+
+	/**
+	* @brief 全てのアーカイブのアンマウント関数
+	* @details 一括読み込み中の場合は完了を待ってからアンマウントする
+	*/
+	static void UnmountAllArchives();
+
+	// ビットマップフォント関連
+	/**
+	* @brief ビットマップフォント読み込み関数
+	* @details <pre>
+	* BMFont形式(テキスト)のフォント定義(.fnt)とページのテクスチャ(.png)を読み込み、keywordの文字列で登録する
+	* ページのテクスチャはフォント定義と同じフォルダに置く
+	* </pre>
+	* @retval true 読み込み成功
+	* @retval false 読み込み失敗
+	* @param[in] keyword 登録用キーワード
+	* @param[in] file_name 読み込むフォント定義のファイル名
+	*/
+	static bool LoadBitmapFont(const char* keyword, const char* file_name);
+
+	/**
+	* @brief ビットマップフォント全解放関数
+	* @details 読み込んでいるすべてのビットマップフォントを解放する
+	*/
+	static void ReleaseAllBitmapFonts();
+
+	/**
+	* @brief ビットマップフォント解放関数
+	* @details 指定されたキーワードのビットマップフォントを解放する
+	* @param[in] keyword 解放するフォントのキーワード
+	*/
+	static void ReleaseBitmapFont(const char* keyword);
+
 	/**
 	* @brief テクスチャ作成関数
 	* @details <pre>
@@ -319,8 +900,9 @@ public:
 	* @retval false 作成失敗
 	* @param[in] file_name 読み込むテクスチャの名前(パス込み)
 	* @param[out] texture_data 読み込まれたテクスチャを反映するデータ
+	* @param[out] out_hash ファイルの内容の識別情報(不要な場合はnullptr)(オプション)
 	*/
-	static bool CreateTexture(const char* file_name, Texture* texture_data);
+	static bool CreateTexture(const char* file_name, Texture* texture_data, FileContentHash* out_hash = nullptr);
 
 	/**
 	* @brief ウィンドウ閉鎖チェック関数
@@ -338,7 +920,41 @@ public:
 	*/
 	static bool IsRecievedWindowMessage();
 
+	// プロファイラ関連
+	/**
+	* @brief プロファイル集計結果の取得関数
+	* @details <pre>
+	* 直前のフレームで計測された区間毎の処理時間を取得する
+	* ENABLE_PROFILERが定義されていない場合は常にnullptrを返す
+	* </pre>
+	* @retval const ProfileZoneStat* 集計結果の配列
+	* @param[out] out_count 集計結果の数
+	*/
+	static const ProfileZoneStat* GetProfileZoneStats(int* out_count);
+
+	/**
+	* @brief プロファイルトレース出力関数
+	* @details <pre>
+	* 計測結果をChromeのトレースイベント形式(JSON)でファイルに出力する
+	* ENABLE_PROFILERが定義されていない場合は何も出力しない
+	* </pre>
+	* @retval true 出力成功
+	* @retval false 出力失敗
+	* @param[in] file_name 出力ファイル名
+	*/
+	static bool WriteProfileTrace(const char* file_name);
+
 private:
+	/**
+	* @brief 命令リストのテクスチャの使用記録関数
+	* @details <pre>
+	* 命令リストが参照するテクスチャを使用中として記録し、予算超過で解放されていた場合は読み込み直す
+	* TextureManagerはゲームスレッドだけが使用するので、描画スレッドに渡す前にゲームスレッドで実行する
+	* </pre>
+	* @param[in] command_list 命令リスト
+	*/
+	static void TouchCommandListTextures(const DrawCommandList& command_list);
+
 	/**
 	* @brief Graphicsインスタンスのゲッター
 	* @retval Graphics* Graphicsインスタンス
@@ -375,6 +991,87 @@ private:
 		return &m_TextureManager;
 	}
 
+	/**
+	* @brief TextureHotReloaderインスタンスのゲッター
+	* @retval TextureHotReloader* TextureHotReloaderインスタンス
+	*/
+	TextureHotReloader* GetTextureHotReloader()
+	{
+		return &m_TextureHotReloader;
+	}
+
+	/**
+	* @brief AssetPreloaderインスタンスのゲッター
+	* @retval AssetPreloader* AssetPreloaderインスタンス
+	*/
+	AssetPreloader* GetAssetPreloader()
+	{
+		return &m_AssetPreloader;
+	}
+
+	/**
+	* @brief FileSystemインスタンスのゲッター
+	* @retval FileSystem* FileSystemインスタンス
+	*/
+	FileSystem* GetFileSystem()
+	{
+		return &m_FileSystem;
+	}
+
+	/**
+	* @brief BitmapFontManagerインスタンスのゲッター
+	* @retval BitmapFontManager* BitmapFontManagerインスタンス
+	*/
+	BitmapFontManager* GetBitmapFontManager()
+	{
+		return &m_BitmapFontManager;
+	}
+
+	/**
+	* @brief PerformanceOverlayインスタンスのゲッター
+	* @retval PerformanceOverlay* PerformanceOverlayインスタンス
+	*/
+	PerformanceOverlay* GetPerformanceOverlay()
+	{
+		return &m_PerformanceOverlay;
+	}
+
+	/**
+	* @brief RenderThreadインスタンスのゲッター
+	* @retval RenderThread* RenderThreadインスタンス
+	*/
+	RenderThread* GetRenderThread()
+	{
+		return &m_RenderThread;
+	}
+
+	/**
+	* @brief JobSystemインスタンスのゲッター
+	* @retval JobSystem* JobSystemインスタンス
+	*/
+	JobSystem* GetJobSystem()
+	{
+		return &m_JobSystem;
+	}
+
+	/**
+	* @brief FrameAllocatorインスタンスのゲッター
+	* @retval FrameAllocator* FrameAllocatorインスタンス
+	*/
+	FrameAllocator* GetFrameAllocator()
+	{
+		return &m_FrameAllocator;
+	}
+
+	/**
+	* @brief TaggedAllocatorインスタンスのゲッター
+	* @retval TaggedAllocator* TaggedAllocatorインスタンス
+	*/
+	TaggedAllocator* GetTaggedAllocator()
+	{
+		return &m_TaggedAllocator;
+	}
+
 	/**
 	* @brief Windowインスタンスのゲッター
 	* @retval Window* Windowインスタンス
@@ -392,7 +1089,17 @@ private:
 	Input m_Input;						//!< 入力クラス
 	Sound m_Sound;						//!< サウンドクラス
 	TextureManager m_TextureManager;	//!< テクスチャ管理クラス
+	TextureHotReloader m_TextureHotReloader;	//!< テクスチャのホットリロード
+	AssetPreloader m_AssetPreloader;	//!< アセットの一括読み込み
+	FileSystem m_FileSystem;			//!< 仮想ファイルシステム
+	BitmapFontManager m_BitmapFontManager;	//!< ビットマップフォント管理クラス
 	Window m_Window;					//!< ウィンドウクラス
+	PerformanceOverlay m_PerformanceOverlay;	//!< パフォーマンスオーバーレイ
+	RenderThread m_RenderThread;		//!< 描画スレッド
+	JobSystem m_JobSystem;				//!< ジョブシステム
+	FrameAllocator m_FrameAllocator;	//!< フレームアロケーター
+	TaggedAllocator m_TaggedAllocator;	//!< タグ付きアロケーター
+	LONGLONG m_PrevFrameCounter;		//!< 前フレームのUpdate実行時のカウンタ値
 };
 
 #endif
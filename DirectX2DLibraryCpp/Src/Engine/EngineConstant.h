@@ -5,12 +5,15 @@
 #ifndef ENGINE_CONSTANT_H_
 #define ENGINE_CONSTANT_H_
 
-#include <d3dx9.h>
+#include <Windows.h>
+#include "RenderTypes.h"
 
 const int SmallFontSize = 16;	//!< フォントサイズ(小)
 const int RegularFontSize = 24;	//!< フォントサイズ(中)
 const int LargeFontSize = 32;	//!< フォントサイズ(大)
 const int MaxKeyNum = 256;		//!< キー最大数
+const int CacheLineSize = 64;	//!< 別スレッドが更新する変数を分けるためのキャッシュラインのサイズ
+const DWORD TextureColorKey = 0x0000ff00;	//!< テクスチャの読み込み時に透明にする色
 
 /** @brief 描画用矩形の軸の種類 */
 enum PivotType
@@ -44,6 +47,15 @@ enum FontSize
 	FontSizeMax,	//!< サイズ最大数
 };
 
+/** @brief テクスチャのフィルタリングの種類 */
+enum TextureFilter
+{
+	TextureFilterPoint,		//!< 最も近いテクセルを使用する(拡大してもぼやけない)
+	TextureFilterLinear,	//!< 周囲の4テクセルを補間する
+	TextureFilterTrilinear,	//!< 周囲の4テクセルを補間し、縮小率に合う2つのミップマップレベルも補間する(ミップマップがない場合はLinearと同じ)
+	TextureFilterMax,		//!< 種類の最大数
+};
+
 /** @brief キーボタンの種類 */
 enum ButtonKind
 {
@@ -98,24 +110,4 @@ enum MouseButton
 	Center,		//!< 真ん中
 };
 
-/** @brief 頂点データ */
-struct CustomVertex
-{
-	float X;			//!< X座標
-	float Y;			//!< Y座標
-	float Z;			//!< Z座標	
-	float Rhw;			//!< 除算数
-	DWORD Color;		//!< 頂点カラー
-	float TextureX;		//!< テクスチャ座標X
-	float TexrureY;		//!< テクスチャ座標Y
-};
-
-/** @brief テクスチャデータやサイズを保持する構造体 */
-struct Texture
-{
-	LPDIRECT3DTEXTURE9 TextureData;	//!< テクスチャデータ
-	int Width;						//!< 横幅
-	int Height;						//!< 縦幅
-};
-
 #endif
@@ -0,0 +1,136 @@
+﻿#include <stdio.h>
+#include <string.h>
+#include "AssetArchive.h"
+#include "FileSystem.h"
+
+namespace
+{
+	const unsigned long long HashPrime1 = 0x9E3779B185EBCA87ULL;	//!< ハッシュ値の計算に使用する素数
+	const unsigned long long HashPrime2 = 0xC2B2AE3D27D4EB4FULL;	//!< ハッシュ値の計算に使用する素数
+
+	/** @brief 左回転関数 */
+	unsigned long long RotateLeft(unsigned long long value, int bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+}
+
+bool FileSystem::MountArchive(const char* file_name)
+{
+	AssetArchive* archive = new AssetArchive();
+
+	if (archive->Open(file_name) == false)
+	{
+		delete archive;
+		return false;
+	}
+
+	m_SourceList.push_back(archive);
+
+	return true;
+}
+
+void FileSystem::UnmountAll()
+{
+	for (FileSource* source : m_SourceList)
+	{
+		delete source;
+	}
+
+	m_SourceList.clear();
+}
+
+bool FileSystem::ReadFile(const char* file_name, FileData* out_data) const
+{
+	for (const FileSource* source : m_SourceList)
+	{
+		if (source->ReadFile(file_name, out_data) == true)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool FileSystem::LoadFile(const char* file_name, FileData* out_data) const
+{
+	if (ReadFile(file_name, out_data) == true)
+	{
+		return true;
+	}
+
+	return ReadLooseFile(file_name, out_data);
+}
+
+bool FileSystem::ReadLooseFile(const char* file_name, FileData* out_data)
+{
+	FILE* fp = nullptr;
+	if (fopen_s(&fp, file_name, "rb") != 0 || fp == nullptr)
+	{
+		return false;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	if (size < 0)
+	{
+		fclose(fp);
+		return false;
+	}
+
+	out_data->Buffer.resize(size);
+	size_t read_size = size > 0 ? fread(&out_data->Buffer[0], 1, size, fp) : 0;
+	fclose(fp);
+
+	if (read_size != (size_t)size)
+	{
+		out_data->Buffer.clear();
+		return false;
+	}
+
+	out_data->Data = out_data->Buffer.empty() == true ? nullptr : &out_data->Buffer[0];
+	out_data->Size = out_data->Buffer.size();
+
+	return true;
+}
+
+unsigned long long FileSystem::HashContent(const void* data, size_t size)
+{
+	const unsigned char* p = (const unsigned char*)data;
+	unsigned long long hash = HashPrime2 ^ (size * HashPrime1);
+
+	size_t i = 0;
+	for (; i + sizeof(unsigned long long) <= size; i += sizeof(unsigned long long))
+	{
+		unsigned long long value;
+		memcpy(&value, p + i, sizeof(value));
+		hash = RotateLeft(hash + value * HashPrime2, 31) * HashPrime1;
+	}
+
+	for (; i < size; i++)
+	{
+		hash = RotateLeft(hash ^ (p[i] * HashPrime1), 11) * HashPrime2;
+	}
+
+	// 下位ビットでも偏らないように全てのビットを混ぜる
+	hash ^= hash >> 33;
+	hash *= HashPrime2;
+	hash ^= hash >> 29;
+	hash *= HashPrime1;
+	hash ^= hash >> 32;
+
+	return hash;
+}
+
+FileContentHash FileSystem::MakeContentHash(const void* data, size_t size)
+{
+	FileContentHash content_hash;
+	content_hash.Value = HashContent(data, size);
+	content_hash.Size = size;
+	content_hash.IsValid = true;
+
+	return content_hash;
+}
@@ -0,0 +1,165 @@
+﻿/**
+* @file FileSystem.h
+* @brief マウントしたアーカイブからファイルを読み込む仮想ファイルシステムクラスの宣言
+*/
+#ifndef FILE_SYSTEM_H_
+#define FILE_SYSTEM_H_
+
+#include <vector>
+
+/** @brief 読み込んだファイルの内容 */
+struct FileData
+{
+	/** Constructor */
+	FileData() :
+		Data(nullptr),
+		Size(0),
+		Buffer()
+	{
+	}
+
+	const char* Data;			//!< 内容(圧縮していない場合はアーカイブのマップしたメモリを直接指す)
+	size_t Size;				//!< バイト数
+	std::vector<char> Buffer;	//!< 展開した内容を置く領域(展開した場合はDataはこの領域を指す)
+};
+
+/**
+* @brief ファイルの内容の識別情報
+* @details 内容をメモリに読み込んだ時に計算しておき、同じ内容のテクスチャを探す時にファイルを読み直さずに使用する
+*/
+struct FileContentHash
+{
+	/** Constructor */
+	FileContentHash() :
+		Value(0),
+		Size(0),
+		IsValid(false)
+	{
+	}
+
+	unsigned long long Value;	//!< 内容のハッシュ値(FileSystem::HashContentで計算したもの)
+	unsigned long long Size;	//!< 内容のバイト数(ハッシュ値が衝突した場合に備えて比較する)
+	bool IsValid;				//!< 計算済みか
+};
+
+/**
+* @brief ファイルの読み込み元のインターフェース
+* @details FileSystemにマウントし、パスを指定してファイルの内容を取得する
+*/
+class FileSource
+{
+public:
+	/** Destructor */
+	virtual ~FileSource() {}
+
+	/**
+	* @brief ファイルの読み込み関数
+	* @details 複数のスレッドから同時に実行できるように実装する
+	* @retval true 読み込み成功
+	* @retval false ファイルがない、または読み込み失敗
+	* @param[in] file_name ファイル名(パス込み)
+	* @param[out] out_data 読み込んだ内容
+	*/
+	virtual bool ReadFile(const char* file_name, FileData* out_data) const = 0;
+};
+
+/**
+* @brief 仮想ファイルシステムクラス
+* @details <pre>
+* マウントした順に読み込み元を検索し、最初に見つかったファイルの内容を返す
+* どの読み込み元にもないファイルはReadFileが失敗するので、呼び出し側で通常のファイルとして読み込む
+* ReadFileは複数のスレッドから同時に実行できるが、マウントとアンマウントは読み込み中に行わないこと
+* </pre>
+*/
+class FileSystem
+{
+public:
+	/** Constructor */
+	FileSystem() :
+		m_SourceList()
+	{
+	}
+
+	/** Destructor */
+	~FileSystem()
+	{
+		UnmountAll();
+	}
+
+	/**
+	* @brief アーカイブのマウント関数
+	* @retval true マウント成功
+	* @retval false アーカイブを開けなかった
+	* @param[in] file_name アーカイブのファイル名
+	*/
+	bool MountArchive(const char* file_name);
+
+	/**
+	* @brief 全ての読み込み元のアンマウント関数
+	* @details 読み込み元が参照しているメモリは解放されるので、読み込んだ内容は使用できなくなる
+	*/
+	void UnmountAll();
+
+	/**
+	* @brief ファイルの読み込み関数
+	* @retval true 読み込み成功
+	* @retval false マウントした読み込み元にない、または読み込み失敗
+	* @param[in] file_name ファイル名(パス込み)
+	* @param[out] out_data 読み込んだ内容
+	*/
+	bool ReadFile(const char* file_name, FileData* out_data) const;
+
+	/**
+	* @brief ファイルの読み込み関数
+	* @details マウントした読み込み元にない場合は通常のファイルから読み込む
+	* @retval true 読み込み成功
+	* @retval false どこにもない、または読み込み失敗
+	* @param[in] file_name ファイル名(パス込み)
+	* @param[out] out_data 読み込んだ内容
+	*/
+	bool LoadFile(const char* file_name, FileData* out_data) const;
+
+	/**
+	* @brief 通常のファイルの読み込み関数
+	* @retval true 読み込み成功
+	* @retval false ファイルがない、または読み込み失敗
+	* @param[in] file_name ファイル名(パス込み)
+	* @param[out] out_data 読み込んだ内容(out_data->Bufferに読み込む)
+	*/
+	static bool ReadLooseFile(const char* file_name, FileData* out_data);
+
+	/**
+	* @brief 内容のハッシュ値の計算関数
+	* @details <pre>
+	* 同じ内容のテクスチャやサウンドを見つけるために使用する(64bit、8バイト単位で処理する)
+	* バイト数もハッシュ値に含める
+	* </pre>
+	* @retval unsigned long long ハッシュ値
+	* @param[in] data 内容
+	* @param[in] size バイト数
+	*/
+	static unsigned long long HashContent(const void* data, size_t size);
+
+	/**
+	* @brief 内容の識別情報の作成関数
+	* @retval FileContentHash 内容のハッシュ値とバイト数
+	* @param[in] data 内容
+	* @param[in] size バイト数
+	*/
+	static FileContentHash MakeContentHash(const void* data, size_t size);
+
+	/**
+	* @brief マウントしているかの確認関数
+	* @retval true 1つ以上マウントしている
+	* @retval false マウントしていない
+	*/
+	bool IsMounted() const
+	{
+		return m_SourceList.empty() == false;
+	}
+
+private:
+	std::vector<FileSource*> m_SourceList;	//!< マウントした読み込み元
+};
+
+#endif
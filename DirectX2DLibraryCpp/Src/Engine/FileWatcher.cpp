@@ -0,0 +1,421 @@
+﻿#include <ctype.h>
+#ifndef _WIN32
+#include <dirent.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "FileWatcher.h"
+
+namespace
+{
+	/** @brief QueryPerformanceCounterの値の取得関数 */
+	LONGLONG GetCounter()
+	{
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter(&counter);
+		return counter.QuadPart;
+	}
+}
+
+bool FileWatcher::Start(const char* directory)
+{
+	Stop();
+
+#ifdef _WIN32
+	m_DirectoryHandle = CreateFile(
+		directory,
+		FILE_LIST_DIRECTORY,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+		nullptr);
+
+	if (m_DirectoryHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	m_StopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+	if (m_StopEvent == nullptr)
+	{
+		Stop();
+		return false;
+	}
+#else
+	m_NotifyDescriptor = inotify_init1(IN_CLOEXEC);
+	if (m_NotifyDescriptor < 0)
+	{
+		return false;
+	}
+
+	m_StopDescriptor = eventfd(0, EFD_CLOEXEC);
+	if (m_StopDescriptor < 0)
+	{
+		Stop();
+		return false;
+	}
+
+	m_SourceDirectory = directory;
+	while (m_SourceDirectory.size() > 1 && (m_SourceDirectory.back() == '/' || m_SourceDirectory.back() == '\\'))
+	{
+		m_SourceDirectory.pop_back();
+	}
+
+	// 監視するフォルダがない場合はWindowsと同じく失敗する
+	AddWatch("", false);
+	if (m_WatchList.empty() == true)
+	{
+		Stop();
+		return false;
+	}
+#endif
+
+	m_Directory = NormalizePath(directory);
+	if (m_Directory.empty() == false && m_Directory.back() != '/')
+	{
+		m_Directory += '/';
+	}
+
+	m_Thread = std::thread(&FileWatcher::Run, this);
+
+	return true;
+}
+
+void FileWatcher::Stop()
+{
+	if (m_Thread.joinable() == true)
+	{
+#ifdef _WIN32
+		SetEvent(m_StopEvent);
+#else
+		uint64_t value = 1;
+		ssize_t written = write(m_StopDescriptor, &value, sizeof(value));
+		(void)written;
+#endif
+		m_Thread.join();
+	}
+
+#ifdef _WIN32
+	if (m_StopEvent != nullptr)
+	{
+		CloseHandle(m_StopEvent);
+		m_StopEvent = nullptr;
+	}
+
+	if (m_DirectoryHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_DirectoryHandle);
+		m_DirectoryHandle = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (m_StopDescriptor >= 0)
+	{
+		close(m_StopDescriptor);
+		m_StopDescriptor = -1;
+	}
+
+	// inotifyのディスクリプタを閉じると全ての監視が解除される
+	if (m_NotifyDescriptor >= 0)
+	{
+		close(m_NotifyDescriptor);
+		m_NotifyDescriptor = -1;
+	}
+	m_WatchList.clear();
+#endif
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_PendingList.clear();
+}
+
+void FileWatcher::PollChanges(std::vector<FileChange>* out_change_list)
+{
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	LONGLONG settle_count = (LONGLONG)(frequency.QuadPart * FileWatchSettleTime / 1000.0f);
+	LONGLONG now = GetCounter();
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	for (auto itr = m_PendingList.begin(); itr != m_PendingList.end();)
+	{
+		if (now - itr->second.LastCounter < settle_count)
+		{
+			itr++;
+			continue;
+		}
+
+		FileChange change;
+		change.FileName = itr->first;
+		change.DetectedCounter = itr->second.FirstCounter;
+		out_change_list->push_back(change);
+
+		itr = m_PendingList.erase(itr);
+	}
+}
+
+std::string FileWatcher::NormalizePath(const char* path)
+{
+	std::string normalized = path;
+
+	for (char& c : normalized)
+	{
+		if (c == '\\')
+		{
+			c = '/';
+		}
+		else if ((unsigned char)c < 0x80)
+		{
+			c = (char)tolower((unsigned char)c);
+		}
+	}
+
+	// "./Res/a.png"と"Res/a.png"を同じファイルとして扱う
+	while (normalized.compare(0, 2, "./") == 0)
+	{
+		normalized.erase(0, 2);
+	}
+
+	return normalized;
+}
+
+#ifdef _WIN32
+void FileWatcher::Run()
+{
+	// FILE_NOTIFY_INFORMATIONはDWORD境界に置く必要がある
+	std::vector<DWORD> buffer(FileWatchBufferSize / sizeof(DWORD));
+
+	OVERLAPPED overlapped = {};
+	overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+	if (overlapped.hEvent == nullptr)
+	{
+		return;
+	}
+
+	while (true)
+	{
+		ResetEvent(overlapped.hEvent);
+
+		if (ReadDirectoryChangesW(
+			m_DirectoryHandle,
+			&buffer[0],
+			FileWatchBufferSize,
+			TRUE,
+			FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME,
+			nullptr,
+			&overlapped,
+			nullptr) == FALSE)
+		{
+			break;
+		}
+
+		HANDLE handles[2] = { m_StopEvent, overlapped.hEvent };
+		DWORD result = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+
+		DWORD size = 0;
+		if (result != WAIT_OBJECT_0 + 1)
+		{
+			// 発行中の読み込みを取り消し、完了を待ってからバッファを破棄する
+			CancelIoEx(m_DirectoryHandle, &overlapped);
+			GetOverlappedResult(m_DirectoryHandle, &overlapped, &size, TRUE);
+			break;
+		}
+
+		if (GetOverlappedResult(m_DirectoryHandle, &overlapped, &size, FALSE) == FALSE)
+		{
+			break;
+		}
+
+		// バッファが溢れた場合は0になり、その間の変更は取得できない
+		if (size == 0)
+		{
+			continue;
+		}
+
+		const char* data = (const char*)&buffer[0];
+		while (true)
+		{
+			const FILE_NOTIFY_INFORMATION* notify_info = (const FILE_NOTIFY_INFORMATION*)data;
+			AddNotification(notify_info);
+
+			if (notify_info->NextEntryOffset == 0)
+			{
+				break;
+			}
+			data += notify_info->NextEntryOffset;
+		}
+	}
+
+	CloseHandle(overlapped.hEvent);
+}
+
+void FileWatcher::AddNotification(const FILE_NOTIFY_INFORMATION* notify_info)
+{
+	// 削除と名前変更前の通知は読み込み直せないので無視する
+	if (notify_info->Action != FILE_ACTION_MODIFIED &&
+		notify_info->Action != FILE_ACTION_ADDED &&
+		notify_info->Action != FILE_ACTION_RENAMED_NEW_NAME)
+	{
+		return;
+	}
+
+	int wide_length = (int)(notify_info->FileNameLength / sizeof(WCHAR));
+	int length = WideCharToMultiByte(CP_ACP, 0, notify_info->FileName, wide_length, nullptr, 0, nullptr, nullptr);
+	if (length <= 0)
+	{
+		return;
+	}
+
+	std::string file_name(length, '\0');
+	WideCharToMultiByte(CP_ACP, 0, notify_info->FileName, wide_length, &file_name[0], length, nullptr, nullptr);
+
+	AddChange(file_name.c_str());
+}
+#else
+void FileWatcher::Run()
+{
+	// inotify_eventはint境界に置く必要がある
+	std::vector<DWORD> buffer(FileWatchBufferSize / sizeof(DWORD));
+
+	pollfd poll_list[2] =
+	{
+		{ m_StopDescriptor, POLLIN, 0 },
+		{ m_NotifyDescriptor, POLLIN, 0 },
+	};
+
+	while (true)
+	{
+		if (poll(poll_list, 2, -1) < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			break;
+		}
+
+		if (poll_list[0].revents != 0 || (poll_list[1].revents & POLLIN) == 0)
+		{
+			break;
+		}
+
+		ssize_t size = read(m_NotifyDescriptor, &buffer[0], FileWatchBufferSize);
+		if (size <= 0)
+		{
+			if (size < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			break;
+		}
+
+		const char* data = (const char*)&buffer[0];
+		for (ssize_t offset = 0; offset < size;)
+		{
+			const inotify_event* event = (const inotify_event*)(data + offset);
+			offset += sizeof(inotify_event) + event->len;
+
+			// 監視を解除したフォルダ(削除されたフォルダ)
+			if ((event->mask & IN_IGNORED) != 0)
+			{
+				m_WatchList.erase(event->wd);
+				continue;
+			}
+
+			// キューが溢れた場合(IN_Q_OVERFLOW)はwdが-1になり、その間の変更は取得できない
+			auto watch = m_WatchList.find(event->wd);
+			if (watch == m_WatchList.end() || event->len == 0)
+			{
+				continue;
+			}
+
+			std::string name = watch->second + event->name;
+			if ((event->mask & IN_ISDIR) != 0)
+			{
+				if ((event->mask & (IN_CREATE | IN_MOVED_TO)) != 0)
+				{
+					AddWatch(name + "/", true);
+				}
+				continue;
+			}
+
+			AddChange(name.c_str());
+		}
+	}
+}
+
+void FileWatcher::AddWatch(const std::string& relative_directory, bool is_created)
+{
+	std::string path = m_SourceDirectory + "/" + relative_directory;
+
+	// 削除と名前変更前の通知は読み込み直せないので監視しない
+	int watch = inotify_add_watch(
+		m_NotifyDescriptor,
+		path.c_str(),
+		IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_MOVED_TO | IN_ONLYDIR);
+	if (watch < 0)
+	{
+		return;
+	}
+	m_WatchList[watch] = relative_directory;
+
+	DIR* directory = opendir(path.c_str());
+	if (directory == nullptr)
+	{
+		return;
+	}
+
+	while (dirent* entry = readdir(directory))
+	{
+		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+		{
+			continue;
+		}
+
+		std::string name = relative_directory + entry->d_name;
+		bool is_directory = entry->d_type == DT_DIR;
+		if (entry->d_type == DT_UNKNOWN)
+		{
+			struct stat status;
+			std::string entry_path = path + entry->d_name;
+			is_directory = stat(entry_path.c_str(), &status) == 0 && S_ISDIR(status.st_mode);
+		}
+
+		if (is_directory == true)
+		{
+			AddWatch(name + "/", is_created);
+		}
+		else if (is_created == true)
+		{
+			// 監視を追加する前にフォルダ内に作成されたファイルは通知されない
+			AddChange(name.c_str());
+		}
+	}
+
+	closedir(directory);
+}
+#endif
+
+void FileWatcher::AddChange(const char* file_name)
+{
+	std::string path = m_Directory + NormalizePath(file_name);
+	LONGLONG now = GetCounter();
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	auto itr = m_PendingList.find(path);
+	if (itr == m_PendingList.end())
+	{
+		PendingChange change = { now, now };
+		m_PendingList[path] = change;
+	}
+	else
+	{
+		itr->second.LastCounter = now;
+	}
+}
@@ -0,0 +1,157 @@
+﻿/**
+* @file FileWatcher.h
+* @brief <pre>
+* フォルダ内のファイルの変更を監視するクラスの宣言
+* ReadDirectoryChangesW(Windows以外ではinotify)で変更の通知を受け取り、書き込みが落ち着いたファイルを取得できるようにする
+* </pre>
+*/
+#ifndef FILE_WATCHER_H_
+#define FILE_WATCHER_H_
+
+#include <Windows.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+const int FileWatchBufferSize = 16 * 1024;	//!< 変更の通知を受け取るバッファのバイト数
+const float FileWatchSettleTime = 100.0f;	//!< 最後の通知から変更を確定するまでの時間(ミリ秒)(保存中の書き込みを何度も通知しないようにする)
+
+/** @brief 変更されたファイル */
+struct FileChange
+{
+	/** Constructor */
+	FileChange() :
+		FileName(),
+		DetectedCounter(0)
+	{
+	}
+
+	std::string FileName;		//!< ファイル名(監視しているフォルダを含む、NormalizePathで正規化したもの)
+	LONGLONG DetectedCounter;	//!< 最初に変更を通知された時のQueryPerformanceCounterの値
+};
+
+/**
+* @brief ファイル監視クラス
+* @details <pre>
+* 監視用のスレッドでフォルダ(サブフォルダを含む)の変更を受け取り、ファイルごとにまとめる
+* PollChangesで最後の通知からFileWatchSettleTime経過したファイルを取得する
+* </pre>
+*/
+class FileWatcher
+{
+public:
+	/** Constructor */
+	FileWatcher() :
+		m_Directory(),
+#ifdef _WIN32
+		m_DirectoryHandle(INVALID_HANDLE_VALUE),
+		m_StopEvent(nullptr),
+#else
+		m_SourceDirectory(),
+		m_NotifyDescriptor(-1),
+		m_StopDescriptor(-1),
+		m_WatchList(),
+#endif
+		m_Thread(),
+		m_Mutex(),
+		m_PendingList()
+	{
+	}
+
+	/**
+	* @brief 開始関数
+	* @retval true 開始成功
+	* @retval false 開始失敗(フォルダを開けなかった)
+	* @param[in] directory 監視するフォルダ
+	*/
+	bool Start(const char* directory);
+
+	/**
+	* @brief 停止関数
+	* @details 監視用のスレッドを終了し、確定していない変更を破棄する
+	*/
+	void Stop();
+
+	/**
+	* @brief 監視中の確認関数
+	* @retval true 監視中
+	* @retval false 停止中
+	*/
+	bool IsRunning() const
+	{
+#ifdef _WIN32
+		return m_DirectoryHandle != INVALID_HANDLE_VALUE;
+#else
+		return m_NotifyDescriptor >= 0;
+#endif
+	}
+
+	/**
+	* @brief 変更の取得関数
+	* @details 最後の通知からFileWatchSettleTime経過したファイルを追加し、監視中のリストから取り除く
+	* @param[out] out_change_list 変更されたファイルを追加するリスト
+	*/
+	void PollChanges(std::vector<FileChange>* out_change_list);
+
+	/**
+	* @brief パスの正規化関数
+	* @details 区切り文字を'/'に揃え、英字を小文字にする(Windowsのファイル名は大文字小文字を区別しないため)
+	* @retval std::string 正規化したパス
+	* @param[in] path パス
+	*/
+	static std::string NormalizePath(const char* path);
+
+private:
+	/** @brief 確定していない変更 */
+	struct PendingChange
+	{
+		LONGLONG FirstCounter;	//!< 最初に通知された時のカウンタ値
+		LONGLONG LastCounter;	//!< 最後に通知された時のカウンタ値
+	};
+
+	/**
+	* @brief 監視用スレッドの処理関数
+	*/
+	void Run();
+
+#ifdef _WIN32
+	/**
+	* @brief 通知の追加関数
+	* @param[in] notify_info 受け取った通知
+	*/
+	void AddNotification(const FILE_NOTIFY_INFORMATION* notify_info);
+#else
+	/**
+	* @brief フォルダの監視の追加関数
+	* @details inotifyはサブフォルダを監視しないので、サブフォルダにも再帰的に監視を追加する
+	* @param[in] relative_directory 監視しているフォルダからの相対パス('/'で終わる、ルートは空文字列)
+	* @param[in] is_created 監視の開始後に作成されたフォルダ(監視を追加する前に作成されたファイルを変更として追加する)
+	*/
+	void AddWatch(const std::string& relative_directory, bool is_created);
+#endif
+
+	/**
+	* @brief 変更の追加関数
+	* @param[in] file_name 監視しているフォルダからの相対パス
+	*/
+	void AddChange(const char* file_name);
+
+private:
+	std::string m_Directory;			//!< 監視しているフォルダ(正規化したもの)
+#ifdef _WIN32
+	HANDLE m_DirectoryHandle;			//!< 監視しているフォルダのハンドル
+	HANDLE m_StopEvent;					//!< 停止の要求
+#else
+	std::string m_SourceDirectory;		//!< 監視しているフォルダ(Startに渡されたもの、inotifyに追加する時に使用する)
+	int m_NotifyDescriptor;				//!< inotifyのファイルディスクリプタ
+	int m_StopDescriptor;				//!< 停止の要求(eventfd)
+	std::map<int, std::string> m_WatchList;	//!< 監視ディスクリプタごとのフォルダ(監視しているフォルダからの相対パス)
+#endif
+	std::thread m_Thread;				//!< 監視用スレッド
+	std::mutex m_Mutex;					//!< 確定していない変更の排他制御
+	std::map<std::string, PendingChange> m_PendingList;	//!< 確定していない変更
+};
+
+#endif
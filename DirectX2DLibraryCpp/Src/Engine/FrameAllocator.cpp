@@ -0,0 +1,122 @@
+﻿#include <algorithm>
+#include <stdint.h>
+#include <stdlib.h>
+#include "FrameAllocator.h"
+
+bool FrameAllocator::Initialize(size_t capacity)
+{
+	Release();
+
+	for (Buffer& buffer : m_Buffers)
+	{
+		buffer.Memory = (char*)malloc(capacity);
+		if (buffer.Memory == nullptr)
+		{
+			Release();
+			return false;
+		}
+		buffer.Capacity = capacity;
+	}
+
+	m_Stats.Capacity = capacity;
+
+	return true;
+}
+
+void FrameAllocator::Release()
+{
+	for (Buffer& buffer : m_Buffers)
+	{
+		for (void* block : buffer.OverflowBlockList)
+		{
+			free(block);
+		}
+
+		free(buffer.Memory);
+		buffer = Buffer();
+	}
+
+	m_CurrentBuffer = 0;
+	m_Stats = FrameAllocatorStats();
+}
+
+void* FrameAllocator::Allocate(size_t size, size_t alignment)
+{
+	// 2のべき乗以外では切り上げのマスクが正しく作れない
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+	{
+		return nullptr;
+	}
+
+	Buffer& buffer = m_Buffers[m_CurrentBuffer];
+
+	if (buffer.Memory != nullptr)
+	{
+		uintptr_t base = (uintptr_t)buffer.Memory;
+		uintptr_t aligned = (base + buffer.Offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+		size_t end = (size_t)(aligned - base) + size;
+
+		if (end <= buffer.Capacity)
+		{
+			buffer.Offset = end;
+			return (void*)aligned;
+		}
+	}
+
+	// 容量を超えた分はヒープから確保し、次にこのバッファを空にする時に解放する
+	char* block = (char*)malloc(size + alignment);
+	if (block == nullptr)
+	{
+		return nullptr;
+	}
+
+	buffer.OverflowBlockList.push_back(block);
+	buffer.OverflowSize += size + alignment;
+
+	return (void*)(((uintptr_t)block + alignment - 1) & ~(uintptr_t)(alignment - 1));
+}
+
+void FrameAllocator::NextFrame()
+{
+	const Buffer& current = m_Buffers[m_CurrentBuffer];
+	m_Stats.UsedSize = current.Offset + current.OverflowSize;
+	m_Stats.HighWaterMark = (std::max)(m_Stats.HighWaterMark, m_Stats.UsedSize);
+	m_Stats.OverflowCount = (int)current.OverflowBlockList.size();
+
+	m_CurrentBuffer = (m_CurrentBuffer + 1) % FrameAllocatorBufferCount;
+
+	Buffer* next = &m_Buffers[m_CurrentBuffer];
+	ResetBuffer(next);
+	m_Stats.Capacity = next->Capacity;
+}
+
+bool FrameAllocator::ResetBuffer(Buffer* buffer)
+{
+	for (void* block : buffer->OverflowBlockList)
+	{
+		free(block);
+	}
+	buffer->OverflowBlockList.clear();
+
+	size_t required_size = buffer->Offset + buffer->OverflowSize;
+	buffer->Offset = 0;
+	buffer->OverflowSize = 0;
+
+	if (required_size <= buffer->Capacity)
+	{
+		return true;
+	}
+
+	// 容量を超えたフレームの使用量まで広げ、以降の同じ規模のフレームはヒープを使用しないようにする
+	char* memory = (char*)malloc(required_size);
+	if (memory == nullptr)
+	{
+		return false;
+	}
+
+	free(buffer->Memory);
+	buffer->Memory = memory;
+	buffer->Capacity = required_size;
+
+	return true;
+}
@@ -0,0 +1,145 @@
+﻿/**
+* @file FrameAllocator.h
+* @brief <pre>
+* 1フレームの間だけ使用する一時メモリを確保するフレームアロケーターの宣言
+* 確保は先頭から順に切り出すだけで、個別の解放は行わずにフレームの切り替え時にまとめて破棄する
+* </pre>
+*/
+#ifndef FRAME_ALLOCATOR_H_
+#define FRAME_ALLOCATOR_H_
+
+#include <stddef.h>
+#include <vector>
+
+const size_t DefaultFrameAllocatorSize = 1024 * 1024;	//!< 1つのバッファの既定の容量(バイト)
+const size_t DefaultFrameAlignment = 16;				//!< 確保するメモリの既定のアライメント(SSEの型に合わせる)
+const int FrameAllocatorBufferCount = 2;				//!< バッファの数
+
+/** @brief フレームアロケーターの使用状況 */
+struct FrameAllocatorStats
+{
+	/** Constructor */
+	FrameAllocatorStats() :
+		UsedSize(0),
+		HighWaterMark(0),
+		Capacity(0),
+		OverflowCount(0)
+	{
+	}
+
+	size_t UsedSize;			//!< 前のフレームで確保したバイト数(容量を超えた分を含む)
+	size_t HighWaterMark;		//!< 1フレームで確保したバイト数の最大値
+	size_t Capacity;			//!< 1つのバッファの容量
+	int OverflowCount;			//!< 前のフレームで容量を超えてヒープから確保した回数
+};
+
+/**
+* @brief フレームアロケータークラス
+* @details <pre>
+* 2つのバッファを交互に使用するので、確保したメモリは次のNextFrameの後のフレームまで有効
+* (フレームNで確保したメモリはフレームN+1でも参照できる)
+* 容量を超えた確保はヒープから行い、そのバッファを次に再利用する時に解放する
+* 確保はスレッドセーフではないので、メインスレッドからのみ使用する
+* コンストラクタとデストラクタは実行されないので、確保した領域は初期化してから使用する
+* </pre>
+*/
+class FrameAllocator
+{
+public:
+	/** Constructor */
+	FrameAllocator() :
+		m_Buffers(),
+		m_CurrentBuffer(0),
+		m_Stats()
+	{
+	}
+
+	/**
+	* @brief 初期化関数
+	* @details 2つのバッファをそれぞれcapacityバイトで確保する
+	* @retval true 初期化成功
+	* @retval false 初期化失敗(メモリの確保に失敗)
+	* @param[in] capacity 1つのバッファの容量(バイト)
+	*/
+	bool Initialize(size_t capacity);
+
+	/**
+	* @brief 解放関数
+	*/
+	void Release();
+
+	/**
+	* @brief 確保関数
+	* @retval void* 確保したメモリ(sizeが0の場合もnullptrにはならない)
+	* @retval nullptr alignmentが0または2のべき乗ではない、またはヒープからの確保に失敗
+	* @param[in] size 確保するバイト数
+	* @param[in] alignment アライメント(2のべき乗)
+	*/
+	void* Allocate(size_t size, size_t alignment);
+
+	/**
+	* @brief 配列の確保関数
+	* @retval T* 確保した配列(要素は初期化されない)
+	* @param[in] count 要素数
+	*/
+	template<class T>
+	T* AllocateArray(int count)
+	{
+		return (T*)Allocate(sizeof(T) * count, alignof(T) > DefaultFrameAlignment ? alignof(T) : DefaultFrameAlignment);
+	}
+
+	/**
+	* @brief フレームの切り替え関数
+	* @details <pre>
+	* 使用状況を集計してから、2フレーム前に使用したバッファを空にして確保先にする
+	* 容量を超えた確保があった場合は、次に空にするときに容量を超えた分だけバッファを広げる
+	* </pre>
+	*/
+	void NextFrame();
+
+	/**
+	* @brief 使用状況の取得関数
+	* @retval const FrameAllocatorStats& 使用状況
+	*/
+	const FrameAllocatorStats& GetStats() const
+	{
+		return m_Stats;
+	}
+
+private:
+	/** @brief バッファ */
+	struct Buffer
+	{
+		/** Constructor */
+		Buffer() :
+			Memory(nullptr),
+			Capacity(0),
+			Offset(0),
+			OverflowSize(0),
+			OverflowBlockList()
+		{
+		}
+
+		char* Memory;							//!< 確保済みの領域
+		size_t Capacity;						//!< 領域のバイト数
+		size_t Offset;							//!< 次に切り出す位置
+		size_t OverflowSize;					//!< 容量を超えてヒープから確保したバイト数
+		std::vector<void*> OverflowBlockList;	//!< 容量を超えてヒープから確保した領域
+	};
+
+	/**
+	* @brief バッファを空にする関数
+	* @details 容量を超えた確保があった場合は領域を作り直して広げる
+	* @retval true 成功
+	* @retval false 領域の再確保に失敗
+	* @param[in] buffer 空にするバッファ
+	*/
+	bool ResetBuffer(Buffer* buffer);
+
+private:
+	Buffer m_Buffers[FrameAllocatorBufferCount];	//!< バッファ
+	int m_CurrentBuffer;							//!< 確保先のバッファの番号
+	FrameAllocatorStats m_Stats;					//!< 使用状況
+};
+
+#endif
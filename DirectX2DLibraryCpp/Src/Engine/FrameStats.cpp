@@ -0,0 +1,72 @@
+﻿#include <algorithm>
+#include "FrameStats.h"
+
+int FrameStats::GetValue(FrameStatsItem item) const
+{
+	switch (item)
+	{
+	case FrameStatsItem::FrameStatsItemDrawCall:
+		return DrawCallCount;
+	case FrameStatsItem::FrameStatsItemPrimitive:
+		return PrimitiveCount;
+	case FrameStatsItem::FrameStatsItemStateChange:
+		return StateChangeCount;
+	case FrameStatsItem::FrameStatsItemTextureBind:
+		return TextureBindCount;
+	case FrameStatsItem::FrameStatsItemVertex:
+		return VertexCount;
+	case FrameStatsItem::FrameStatsItemFontDraw:
+		return FontDrawCount;
+	case FrameStatsItem::FrameStatsItemTextLayoutHit:
+		return TextLayoutHitCount;
+	case FrameStatsItem::FrameStatsItemTextLayoutMiss:
+		return TextLayoutMissCount;
+	case FrameStatsItem::FrameStatsItemCulled:
+		return CulledCount;
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+void FrameStatsHistory::Push(const FrameStats& stats)
+{
+	m_History[m_WriteIndex] = stats;
+	m_WriteIndex = (m_WriteIndex + 1) % FrameStatsHistorySize;
+
+	if (m_Count < FrameStatsHistorySize)
+	{
+		m_Count++;
+	}
+}
+
+FrameStatsSummary FrameStatsHistory::GetSummary(FrameStatsItem item, float percentile) const
+{
+	FrameStatsSummary summary = { 0, 0, 0.0f, 0 };
+	if (m_Count == 0)
+	{
+		return summary;
+	}
+
+	int values[FrameStatsHistorySize];
+	long long total = 0;
+
+	for (int i = 0; i < m_Count; i++)
+	{
+		values[i] = m_History[i].GetValue(item);
+		total += values[i];
+	}
+
+	summary.Min = *std::min_element(values, values + m_Count);
+	summary.Max = *std::max_element(values, values + m_Count);
+	summary.Average = (float)total / m_Count;
+
+	// 最近傍順位法でパーセンタイル値を求める
+	percentile = std::max(0.0f, std::min(100.0f, percentile));
+	int rank = (int)(percentile / 100.0f * (m_Count - 1) + 0.5f);
+	std::nth_element(values, values + rank, values + m_Count);
+	summary.Percentile = values[rank];
+
+	return summary;
+}
@@ -0,0 +1,133 @@
+﻿/**
+* @file FrameStats.h
+* @brief <pre>
+* 1フレーム分の描画統計と、その履歴を保持するクラスの宣言
+* カウンタは整数の加算のみで更新するのでRelease構成でも有効のままにしている
+* </pre>
+*/
+#ifndef FRAME_STATS_H_
+#define FRAME_STATS_H_
+
+const int FrameStatsHistorySize = 120;	//!< 統計履歴として保持するフレーム数
+
+/** @brief 描画統計の項目 */
+enum FrameStatsItem
+{
+	FrameStatsItemDrawCall,		//!< 描画命令の発行回数
+	FrameStatsItemPrimitive,	//!< 描画したプリミティブ数
+	FrameStatsItemStateChange,	//!< ステート変更回数
+	FrameStatsItemTextureBind,	//!< テクスチャの設定回数
+	FrameStatsItemVertex,		//!< 送信した頂点数
+	FrameStatsItemFontDraw,		//!< フォント描画回数
+	FrameStatsItemTextLayoutHit,	//!< 文字列レイアウトのキャッシュヒット数
+	FrameStatsItemTextLayoutMiss,	//!< 文字列レイアウトのキャッシュミス数
+	FrameStatsItemCulled,		//!< 画面外のため描画しなかった回数
+	FrameStatsItemMax,			//!< 項目の最大数
+};
+
+/** @brief 1フレーム分の描画統計 */
+struct FrameStats
+{
+	/** Constructor */
+	FrameStats()
+	{
+		Reset();
+	}
+
+	/**
+	* @brief リセット関数
+	* @details 全てのカウンタを0にする
+	*/
+	void Reset()
+	{
+		DrawCallCount = 0;
+		PrimitiveCount = 0;
+		StateChangeCount = 0;
+		TextureBindCount = 0;
+		VertexCount = 0;
+		FontDrawCount = 0;
+		TextLayoutHitCount = 0;
+		TextLayoutMissCount = 0;
+		CulledCount = 0;
+	}
+
+	/**
+	* @brief 項目値の取得関数
+	* @retval int 指定された項目の値
+	* @param[in] item 取得する項目
+	*/
+	int GetValue(FrameStatsItem item) const;
+
+	/**
+	* @brief 文字列レイアウトのキャッシュヒット率の取得関数
+	* @retval float ヒット率(0～1、フォント描画がない場合は0)
+	*/
+	float GetTextLayoutHitRate() const
+	{
+		int total = TextLayoutHitCount + TextLayoutMissCount;
+		return total > 0 ? (float)TextLayoutHitCount / total : 0.0f;
+	}
+
+	int DrawCallCount;		//!< 描画命令の発行回数
+	int PrimitiveCount;		//!< 描画したプリミティブ数
+	int StateChangeCount;	//!< ステート変更回数
+	int TextureBindCount;	//!< テクスチャの設定回数
+	int VertexCount;		//!< 送信した頂点数
+	int FontDrawCount;		//!< フォント描画回数
+	int TextLayoutHitCount;		//!< 文字列レイアウトのキャッシュヒット数
+	int TextLayoutMissCount;	//!< 文字列レイアウトのキャッシュミス数
+	int CulledCount;		//!< 画面外のため描画しなかった回数
+};
+
+/** @brief 統計履歴の集計結果 */
+struct FrameStatsSummary
+{
+	int Min;			//!< 最小値
+	int Max;			//!< 最大値
+	float Average;		//!< 平均値
+	int Percentile;		//!< 指定パーセンタイル値
+};
+
+/** @brief 直近FrameStatsHistorySizeフレーム分の統計履歴クラス */
+class FrameStatsHistory
+{
+public:
+	/** Constructor */
+	FrameStatsHistory() :
+		m_WriteIndex(0),
+		m_Count(0)
+	{
+	}
+
+	/**
+	* @brief 履歴追加関数
+	* @details 1フレーム分の統計を追加する、保持数を超えた場合は一番古い履歴を上書きする
+	* @param[in] stats 追加する統計
+	*/
+	void Push(const FrameStats& stats);
+
+	/**
+	* @brief 履歴の集計関数
+	* @details 保持している履歴から指定された項目の最小、最大、平均、パーセンタイル値を求める
+	* @retval FrameStatsSummary 集計結果(履歴がない場合は全て0)
+	* @param[in] item 集計する項目
+	* @param[in] percentile 求めるパーセンタイル(0.0～100.0)
+	*/
+	FrameStatsSummary GetSummary(FrameStatsItem item, float percentile) const;
+
+	/**
+	* @brief 履歴数の取得関数
+	* @retval int 保持している履歴の数
+	*/
+	int GetCount() const
+	{
+		return m_Count;
+	}
+
+private:
+	FrameStats m_History[FrameStatsHistorySize];	//!< 統計履歴
+	int m_WriteIndex;								//!< 次に書き込む位置
+	int m_Count;									//!< 保持している履歴の数
+};
+
+#endif
@@ -0,0 +1,436 @@
+﻿#include <d3d9.h>
+#include <algorithm>
+#include "RenderBackend.h"
+#include "GlyphAtlas.h"
+
+namespace
+{
+	const int GrayLevelCount = 64;						// GGO_GRAY8_BITMAPの階調数(0～64)
+	const int MaxGlyphCellSize = GlyphAtlasSize / 2;	// セルの最大サイズ
+
+	/**
+	* @brief グリフのキー作成関数
+	* @details フォントサイズと文字コードを1つの値にまとめる
+	*/
+	unsigned long long MakeGlyphKey(unsigned int code, int font_size)
+	{
+		return ((unsigned long long)font_size << 32) | code;
+	}
+}
+
+GlyphAtlas::GlyphAtlas() :
+	m_Backend(nullptr),
+	m_Texture(),
+	m_DeviceContext(nullptr),
+	m_FontList(),
+	m_ShelfList(),
+	m_NextShelfTop(0),
+	m_GlyphList(),
+	m_EmptyGlyphList(),
+	m_OutlineBuffer(),
+	m_CellBuffer(),
+	m_CurrentFrame(0),
+	m_Generation(0)
+{
+}
+
+bool GlyphAtlas::Initialize(RenderBackend* backend)
+{
+	m_Backend = backend;
+
+	if (m_Backend->CreateEmptyTexture(GlyphAtlasSize, GlyphAtlasSize, &m_Texture) == false)
+	{
+		return false;
+	}
+
+	m_DeviceContext = CreateCompatibleDC(nullptr);
+	if (m_DeviceContext == nullptr)
+	{
+		return false;
+	}
+
+	// セルのポインタを保持するので、段のリストが再確保されないように最大数を確保しておく
+	m_ShelfList.reserve(GlyphAtlasSize / GlyphCellStep);
+
+	return true;
+}
+
+void GlyphAtlas::Release()
+{
+	m_GlyphList.clear();
+	m_EmptyGlyphList.clear();
+	m_ShelfList.clear();
+	m_NextShelfTop = 0;
+
+	m_OutlineBuffer.clear();
+	m_OutlineBuffer.shrink_to_fit();
+	m_CellBuffer.clear();
+	m_CellBuffer.shrink_to_fit();
+
+	for (auto& font : m_FontList)
+	{
+		DeleteObject(font.second.Font);
+	}
+	m_FontList.clear();
+
+	if (m_DeviceContext != nullptr)
+	{
+		DeleteDC(m_DeviceContext);
+		m_DeviceContext = nullptr;
+	}
+
+	if (m_Texture.TextureData != nullptr)
+	{
+		m_Texture.TextureData->Release();
+		m_Texture.TextureData = nullptr;
+	}
+}
+
+const GlyphInfo* GlyphAtlas::FindGlyph(unsigned int code, int font_size)
+{
+	font_size = ClampFontSize(font_size);
+	unsigned long long key = MakeGlyphKey(code, font_size);
+
+	auto empty_glyph = m_EmptyGlyphList.find(key);
+	if (empty_glyph != m_EmptyGlyphList.end())
+	{
+		return &empty_glyph->second;
+	}
+
+	auto glyph = m_GlyphList.find(key);
+	if (glyph != m_GlyphList.end())
+	{
+		glyph->second->Info.LastUsedFrame = m_CurrentFrame;
+		return &glyph->second->Info;
+	}
+
+	return CreateGlyph(key, code, font_size);
+}
+
+int GlyphAtlas::GetLineHeight(int font_size)
+{
+	font_size = ClampFontSize(font_size);
+
+	const GlyphFont* font = FindFont(font_size);
+	if (font == nullptr)
+	{
+		return font_size;
+	}
+
+	return font->LineHeight;
+}
+
+int GlyphAtlas::ClampFontSize(int font_size)
+{
+	if (font_size < MinGlyphFontSize)
+	{
+		return MinGlyphFontSize;
+	}
+	else if (font_size > MaxGlyphFontSize)
+	{
+		return MaxGlyphFontSize;
+	}
+
+	return font_size;
+}
+
+const GlyphAtlas::GlyphFont* GlyphAtlas::FindFont(int font_size)
+{
+	auto font = m_FontList.find(font_size);
+	if (font != m_FontList.end())
+	{
+		return &font->second;
+	}
+
+	if (m_DeviceContext == nullptr)
+	{
+		return nullptr;
+	}
+
+	// ID3DXFontで使用していたフォントと同じ設定で作成する
+	HFONT font_handle = CreateFont(
+		font_size,
+		font_size / 2,
+		0,
+		0,
+		FW_REGULAR,
+		FALSE,
+		FALSE,
+		FALSE,
+		DEFAULT_CHARSET,
+		OUT_TT_ONLY_PRECIS,
+		CLIP_DEFAULT_PRECIS,
+		ANTIALIASED_QUALITY,
+		FIXED_PITCH | FF_SCRIPT,
+		TEXT("ＭＳ　Ｐゴシック"));
+
+	if (font_handle == nullptr)
+	{
+		return nullptr;
+	}
+
+	SelectObject(m_DeviceContext, font_handle);
+
+	TEXTMETRIC metric;
+	if (GetTextMetrics(m_DeviceContext, &metric) == FALSE)
+	{
+		DeleteObject(font_handle);
+		return nullptr;
+	}
+
+	GlyphFont& entry = m_FontList[font_size];
+	entry.Font = font_handle;
+	entry.Ascent = metric.tmAscent;
+	entry.LineHeight = metric.tmHeight;
+
+	return &entry;
+}
+
+const GlyphInfo* GlyphAtlas::CreateGlyph(unsigned long long key, unsigned int code, int font_size)
+{
+	const GlyphFont* font = FindFont(font_size);
+	if (font == nullptr)
+	{
+		return nullptr;
+	}
+
+	SelectObject(m_DeviceContext, font->Font);
+
+	const MAT2 matrix = { { 0, 1 }, { 0, 0 }, { 0, 0 }, { 0, 1 } };
+	GLYPHMETRICS metrics;
+
+	DWORD buffer_size = GetGlyphOutlineW(m_DeviceContext, code, GGO_GRAY8_BITMAP, &metrics, 0, nullptr, &matrix);
+	if (buffer_size == GDI_ERROR)
+	{
+		return nullptr;
+	}
+
+	GlyphInfo info = {};
+	info.OffsetX = metrics.gmptGlyphOrigin.x;
+	info.OffsetY = font->Ascent - metrics.gmptGlyphOrigin.y;
+	info.Advance = metrics.gmCellIncX;
+
+	// 空白文字はピクセルがないのでアトラスに配置しない
+	if (buffer_size == 0)
+	{
+		GlyphInfo& empty_glyph = m_EmptyGlyphList[key];
+		empty_glyph = info;
+		return &empty_glyph;
+	}
+
+	m_OutlineBuffer.resize(buffer_size);
+	if (GetGlyphOutlineW(m_DeviceContext, code, GGO_GRAY8_BITMAP, &metrics, buffer_size, &m_OutlineBuffer[0], &matrix) == GDI_ERROR)
+	{
+		return nullptr;
+	}
+
+	int width = metrics.gmBlackBoxX;
+	int height = metrics.gmBlackBoxY;
+	int pitch = (width + 3) & ~3;
+
+	// 隣のセルのグリフがにじまないように1ピクセル以上の余白を含める
+	int cell_size = ((std::max)(width, height) + 1 + GlyphCellStep - 1) / GlyphCellStep * GlyphCellStep;
+	if (cell_size > MaxGlyphCellSize)
+	{
+		return nullptr;
+	}
+
+	int x = 0;
+	int y = 0;
+	GlyphShelf::Slot* slot = AllocateSlot(cell_size, &x, &y);
+	if (slot == nullptr)
+	{
+		return nullptr;
+	}
+
+	// 頂点カラーを乗算するためRGBは白、濃淡をアルファに書き込む
+	m_CellBuffer.assign(cell_size * cell_size, 0x00ffffff);
+	for (int row = 0; row < height; row++)
+	{
+		for (int column = 0; column < width; column++)
+		{
+			int level = m_OutlineBuffer[row * pitch + column];
+			DWORD alpha = (level * 255 + GrayLevelCount / 2) / GrayLevelCount;
+			m_CellBuffer[row * cell_size + column] = (alpha << 24) | 0x00ffffff;
+		}
+	}
+
+	if (m_Backend->UpdateTexture(&m_Texture, x, y, cell_size, cell_size, &m_CellBuffer[0], cell_size) == false)
+	{
+		return nullptr;
+	}
+
+	info.U0 = (float)x / GlyphAtlasSize;
+	info.V0 = (float)y / GlyphAtlasSize;
+	info.U1 = (float)(x + width) / GlyphAtlasSize;
+	info.V1 = (float)(y + height) / GlyphAtlasSize;
+	info.Width = width;
+	info.Height = height;
+	info.LastUsedFrame = m_CurrentFrame;
+
+	slot->Key = key;
+	slot->IsUsed = true;
+	slot->Info = info;
+	m_GlyphList[key] = slot;
+
+	return &slot->Info;
+}
+
+GlyphShelf::Slot* GlyphAtlas::AllocateSlot(int cell_size, int* out_x, int* out_y)
+{
+	const GlyphShelf::Slot empty_slot = { 0, false, {} };
+
+	// 同じサイズの段の空いているセル
+	for (auto& shelf : m_ShelfList)
+	{
+		if (shelf.CellSize != cell_size)
+		{
+			continue;
+		}
+
+		for (int i = 0; i < (int)shelf.Slots.size(); i++)
+		{
+			if (shelf.Slots[i].IsUsed == false)
+			{
+				*out_x = i * cell_size;
+				*out_y = shelf.Top;
+				return &shelf.Slots[i];
+			}
+		}
+	}
+
+	// 新しい段
+	if (m_NextShelfTop + cell_size <= GlyphAtlasSize)
+	{
+		GlyphShelf shelf;
+		shelf.Top = m_NextShelfTop;
+		shelf.Height = cell_size;
+		shelf.CellSize = cell_size;
+		shelf.Slots.assign(GlyphAtlasSize / cell_size, empty_slot);
+		m_ShelfList.push_back(shelf);
+
+		m_NextShelfTop += cell_size;
+
+		*out_x = 0;
+		*out_y = shelf.Top;
+		return &m_ShelfList.back().Slots[0];
+	}
+
+	// 同じサイズの段で最も使われていないセル
+	GlyphShelf::Slot* oldest_slot = nullptr;
+	for (auto& shelf : m_ShelfList)
+	{
+		if (shelf.CellSize != cell_size)
+		{
+			continue;
+		}
+
+		for (int i = 0; i < (int)shelf.Slots.size(); i++)
+		{
+			GlyphShelf::Slot& slot = shelf.Slots[i];
+			if (slot.Info.LastUsedFrame == m_CurrentFrame)
+			{
+				continue;
+			}
+
+			if (oldest_slot == nullptr ||
+				slot.Info.LastUsedFrame < oldest_slot->Info.LastUsedFrame)
+			{
+				oldest_slot = &slot;
+				*out_x = i * cell_size;
+				*out_y = shelf.Top;
+			}
+		}
+	}
+
+	if (oldest_slot != nullptr)
+	{
+		FreeSlot(oldest_slot);
+		return oldest_slot;
+	}
+
+	// 現在のフレームで使用していない最も古い段(高さが足りない場合は連続する段)をこのサイズで作り直す
+	int oldest_begin = -1;
+	int oldest_end = -1;
+	unsigned int oldest_frame = 0;
+	for (int begin = 0; begin < (int)m_ShelfList.size(); begin++)
+	{
+		int height = 0;
+		unsigned int last_used_frame = 0;
+		bool is_in_use = false;
+		int end = begin;
+
+		for (; end < (int)m_ShelfList.size() && height < cell_size; end++)
+		{
+			for (auto& slot : m_ShelfList[end].Slots)
+			{
+				if (slot.IsUsed == false)
+				{
+					continue;
+				}
+
+				last_used_frame = (std::max)(last_used_frame, slot.Info.LastUsedFrame);
+				if (slot.Info.LastUsedFrame == m_CurrentFrame)
+				{
+					is_in_use = true;
+				}
+			}
+			height += m_ShelfList[end].Height;
+		}
+
+		if (height < cell_size ||
+			is_in_use == true)
+		{
+			continue;
+		}
+
+		if (oldest_begin < 0 ||
+			last_used_frame < oldest_frame)
+		{
+			oldest_begin = begin;
+			oldest_end = end;
+			oldest_frame = last_used_frame;
+		}
+	}
+
+	if (oldest_begin < 0)
+	{
+		return nullptr;
+	}
+
+	for (int i = oldest_begin; i < oldest_end; i++)
+	{
+		for (auto& slot : m_ShelfList[i].Slots)
+		{
+			if (slot.IsUsed == true)
+			{
+				FreeSlot(&slot);
+			}
+		}
+	}
+
+	// 連続する段を1つにまとめる
+	// 後ろの段はムーブされるだけでセルの配列は再確保されないので、保持しているセルのポインタは有効なまま
+	GlyphShelf& shelf = m_ShelfList[oldest_begin];
+	for (int i = oldest_begin + 1; i < oldest_end; i++)
+	{
+		shelf.Height += m_ShelfList[i].Height;
+	}
+	m_ShelfList.erase(m_ShelfList.begin() + oldest_begin + 1, m_ShelfList.begin() + oldest_end);
+
+	shelf.CellSize = cell_size;
+	shelf.Slots.assign(GlyphAtlasSize / cell_size, empty_slot);
+
+	*out_x = 0;
+	*out_y = shelf.Top;
+	return &shelf.Slots[0];
+}
+
+void GlyphAtlas::FreeSlot(GlyphShelf::Slot* slot)
+{
+	m_GlyphList.erase(slot->Key);
+	slot->IsUsed = false;
+
+	// 取得済みのグリフを使用している側(文字列のレイアウトなど)に作り直しを促す
+	m_Generation++;
+}
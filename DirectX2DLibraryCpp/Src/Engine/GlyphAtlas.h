@@ -0,0 +1,213 @@
+﻿/**
+* @file GlyphAtlas.h
+* @brief <pre>
+* 文字(グリフ)を1枚のテクスチャにまとめて管理するクラスの宣言
+* グリフは使用時にGDIで作成してテクスチャに書き込み、空きがない場合は最も使われていないものと入れ替える
+* Graphicsクラスでインスタンスを作成するので使用者が作成する必要はない
+* </pre>
+*/
+#ifndef GLYPH_ATLAS_H_
+#define GLYPH_ATLAS_H_
+
+#include <Windows.h>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include "EngineConstant.h"
+#include "TaggedAllocator.h"
+
+class RenderBackend;
+
+const int GlyphAtlasSize = 1024;		//!< アトラステクスチャの縦横のサイズ
+const int GlyphCellStep = 8;			//!< グリフを配置するセルのサイズの単位
+const int MinGlyphFontSize = 4;			//!< 指定できる最小のフォントサイズ
+const int MaxGlyphFontSize = 256;		//!< 指定できる最大のフォントサイズ
+
+/** @brief アトラスに配置されたグリフの情報 */
+struct GlyphInfo
+{
+	float U0;			//!< テクスチャ座標(左)
+	float V0;			//!< テクスチャ座標(上)
+	float U1;			//!< テクスチャ座標(右)
+	float V1;			//!< テクスチャ座標(下)
+	int Width;			//!< グリフの横幅(ピクセル、空白文字は0)
+	int Height;			//!< グリフの縦幅(ピクセル、空白文字は0)
+	int OffsetX;		//!< 描画位置からグリフの左端までの距離
+	int OffsetY;		//!< 行の上端からグリフの上端までの距離
+	int Advance;		//!< 次の文字までの距離
+	unsigned int LastUsedFrame;	//!< 最後に使用したフレーム(GlyphAtlasが更新する)
+};
+
+/**
+* @brief アトラスの1段(同じサイズのセルが横に並ぶ領域)
+* @details セルのサイズ(フォントサイズの区分)ごとに段を分けることで、入れ替え時に隙間ができないようにする
+*/
+struct GlyphShelf
+{
+	/** @brief 段のセル */
+	struct Slot
+	{
+		unsigned long long Key;		//!< 配置されているグリフのキー
+		bool IsUsed;				//!< グリフが配置されているか
+		GlyphInfo Info;				//!< グリフの情報
+	};
+
+	int Top;					//!< 段の上端(ピクセル)
+	int Height;					//!< 段の高さ(ピクセル)
+	int CellSize;				//!< セルの縦横のサイズ(Height以下)
+	std::vector<Slot> Slots;	//!< セル
+};
+
+/** @brief グリフアトラスクラス */
+class GlyphAtlas
+{
+public:
+	/** Constructor */
+	GlyphAtlas();
+
+	/**
+	* @brief 初期化関数
+	* @details アトラステクスチャとグリフ作成用のデバイスコンテキストを作成する
+	* @retval true 初期化成功
+	* @retval false 初期化失敗
+	* @param[in] backend テクスチャの作成、更新に使用する描画バックエンド
+	*/
+	bool Initialize(RenderBackend* backend);
+
+	/**
+	* @brief 解放関数
+	*/
+	void Release();
+
+	/**
+	* @brief フレーム更新関数
+	* @details 描画開始時に実行し、現在のフレームで使用したグリフを入れ替え対象から外す
+	*/
+	void NextFrame()
+	{
+		m_CurrentFrame++;
+	}
+
+	/**
+	* @brief グリフの取得関数
+	* @details <pre>
+	* アトラスにない場合はグリフを作成してテクスチャに書き込む
+	* 現在のフレームで使用したグリフは入れ替えないので、
+	* 同じフレームで使用するグリフが多すぎて入りきらない場合はnullptrを返す
+	* </pre>
+	* @retval const GlyphInfo* グリフの情報(作成できなかった場合はnullptr)
+	* @param[in] code 文字コード(UTF-16)
+	* @param[in] font_size フォントサイズ(ピクセル)
+	*/
+	const GlyphInfo* FindGlyph(unsigned int code, int font_size);
+
+	/**
+	* @brief グリフの使用済み設定関数
+	* @details <pre>
+	* FindGlyphで取得済みのグリフを現在のフレームで使用したことにして、入れ替え対象から外す
+	* 取得時の世代(GetGeneration)から変わっていないグリフにのみ使用できる
+	* </pre>
+	* @param[in] glyph FindGlyphで取得したグリフ
+	*/
+	void MarkGlyphUsed(const GlyphInfo* glyph)
+	{
+		const_cast<GlyphInfo*>(glyph)->LastUsedFrame = m_CurrentFrame;
+	}
+
+	/**
+	* @brief 世代の取得関数
+	* @details グリフが入れ替えられるたびに増えるので、取得済みのグリフが有効かどうかの判定に使用する
+	* @retval unsigned int 世代
+	*/
+	unsigned int GetGeneration() const
+	{
+		return m_Generation;
+	}
+
+	/**
+	* @brief 行の高さの取得関数
+	* @retval int 行の高さ(ピクセル)
+	* @param[in] font_size フォントサイズ(ピクセル)
+	*/
+	int GetLineHeight(int font_size);
+
+	/**
+	* @brief アトラステクスチャの取得関数
+	* @retval const Texture* アトラステクスチャ
+	*/
+	const Texture* GetTexture() const
+	{
+		return &m_Texture;
+	}
+
+	/**
+	* @brief フォントサイズの補正関数
+	* @retval int MinGlyphFontSize～MaxGlyphFontSizeに丸めたサイズ
+	* @param[in] font_size フォントサイズ
+	*/
+	static int ClampFontSize(int font_size);
+
+private:
+	/** @brief サイズごとのフォント */
+	struct GlyphFont
+	{
+		HFONT Font;			//!< GDIフォント
+		int Ascent;			//!< ベースラインから上端までの高さ
+		int LineHeight;		//!< 行の高さ
+	};
+
+	/**
+	* @brief フォントの取得関数
+	* @details 指定されたサイズのフォントがない場合は作成する
+	* @retval const GlyphFont* フォント(作成できなかった場合はnullptr)
+	* @param[in] font_size フォントサイズ
+	*/
+	const GlyphFont* FindFont(int font_size);
+
+	/**
+	* @brief グリフ作成関数
+	* @details GDIでグリフを作成し、アトラスに配置する
+	* @retval const GlyphInfo* グリフの情報(作成できなかった場合はnullptr)
+	* @param[in] key グリフのキー
+	* @param[in] code 文字コード
+	* @param[in] font_size フォントサイズ
+	*/
+	const GlyphInfo* CreateGlyph(unsigned long long key, unsigned int code, int font_size);
+
+	/**
+	* @brief セルの確保関数
+	* @details <pre>
+	* 空いているセル、新しい段、最も使われていないセルの順に探す
+	* 同じサイズの段で見つからない場合は、現在のフレームで使用していない最も古い段を作り直す
+	* 段の高さが足りない場合は連続する段をまとめて1つの段にする
+	* </pre>
+	* @retval GlyphShelf::Slot* 確保したセル(確保できなかった場合はnullptr)
+	* @param[in] cell_size セルのサイズ
+	* @param[out] out_x セルの左上座標X
+	* @param[out] out_y セルの左上座標Y
+	*/
+	GlyphShelf::Slot* AllocateSlot(int cell_size, int* out_x, int* out_y);
+
+	/**
+	* @brief セルの解放関数
+	* @details 配置されていたグリフを検索用のリストから削除する
+	* @param[in] slot 解放するセル
+	*/
+	void FreeSlot(GlyphShelf::Slot* slot);
+
+private:
+	RenderBackend* m_Backend;												//!< 描画バックエンド
+	Texture m_Texture;														//!< アトラステクスチャ
+	HDC m_DeviceContext;													//!< グリフ作成用のデバイスコンテキスト
+	std::map<int, GlyphFont> m_FontList;									//!< サイズごとのフォント
+	std::vector<GlyphShelf> m_ShelfList;									//!< アトラスの段
+	int m_NextShelfTop;														//!< 次に作成する段の上端
+	std::unordered_map<unsigned long long, GlyphShelf::Slot*> m_GlyphList;	//!< 配置されているグリフ
+	std::unordered_map<unsigned long long, GlyphInfo> m_EmptyGlyphList;		//!< 空白文字(アトラスに配置しないグリフ)
+	TaggedVector<unsigned char, MemoryTagGraphics> m_OutlineBuffer;			//!< GDIから受け取るグリフの作業領域
+	TaggedVector<DWORD, MemoryTagGraphics> m_CellBuffer;					//!< テクスチャに書き込むセルの作業領域
+	unsigned int m_CurrentFrame;											//!< 現在のフレーム
+	unsigned int m_Generation;												//!< グリフの入れ替え回数
+};
+
+#endif
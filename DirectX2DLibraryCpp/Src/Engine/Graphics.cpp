@@ -1,114 +1,184 @@
-﻿#include "Graphics.h"
+﻿#include <algorithm>
+#include <float.h>
+#include <xmmintrin.h>
+#include "Graphics.h"
 #include "Engine.h"
+#include "MipmapGenerator.h"
+#include "Profiler.h"
+#include "D3D9RenderBackend.h"
+#include "NullRenderBackend.h"
+#include "RecordingRenderBackend.h"
+#include "SoftwareRenderBackend.h"
+
+namespace
+{
+	/**
+	* @brief 範囲と画面の重なり判定関数
+	* @details 4つの辺の比較を1回のSSE比較で行う
+	* @retval true 重なる
+	* @retval false 完全に画面外
+	* @param[in] min_x 範囲の左端
+	* @param[in] min_y 範囲の上端
+	* @param[in] max_x 範囲の右端
+	* @param[in] max_y 範囲の下端
+	* @param[in] width 画面の横幅
+	* @param[in] height 画面の縦幅
+	*/
+	inline bool IsBoundsVisible(float min_x, float min_y, float max_x, float max_y, float width, float height)
+	{
+		// (max_x, max_y, width, height) >= (0, 0, min_x, min_y) が全て成り立てば重なる
+		__m128 a = _mm_set_ps(height, width, max_y, max_x);
+		__m128 b = _mm_set_ps(min_y, min_x, 0.0f, 0.0f);
+		return _mm_movemask_ps(_mm_cmpge_ps(a, b)) == 0xF;
+	}
+
+	/**
+	* @brief 4要素の最小値の取得関数
+	* @retval float 最小値
+	* @param[in] v 4要素
+	*/
+	inline float HorizontalMin(__m128 v)
+	{
+		v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+		v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_cvtss_f32(v);
+	}
 
-// 静的ライブラリ
-#pragma comment(lib, "d3d9.lib")
-#pragma comment(lib, "d3dx9.lib")
+	/**
+	* @brief 4要素の最大値の取得関数
+	* @retval float 最大値
+	* @param[in] v 4要素
+	*/
+	inline float HorizontalMax(__m128 v)
+	{
+		v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+		v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_cvtss_f32(v);
+	}
 
-#define VERTEX_FVF (D3DFVF_XYZRHW | D3DFVF_DIFFUSE | D3DFVF_TEX1)
+	const int CircleVertexCount = 182;	//!< 円の頂点数(中心 + 2度ごとの外周)
+}
 
-bool Graphics::Initialize(bool is_window_mode)
+bool Graphics::Initialize(int width, int height, bool is_window_mode, RenderBackendType backend_type, const FileSystem* file_system)
 {
-	D3DPRESENT_PARAMETERS present_param;
-	ZeroMemory(&present_param, sizeof(D3DPRESENT_PARAMETERS));
+	m_FileSystem = file_system;
 
-	if (CreateInterface() == false)
+	m_Backend = CreateBackend(backend_type);
+	if (m_Backend == nullptr)
 	{
 		return false;
 	}
 
-	if (CreateDevice(&present_param, is_window_mode) == false)
+	if (m_Backend->Initialize(width, height, is_window_mode) == false)
 	{
 		return false;
 	}
 
-	if (SetUpViewPort(&present_param) == false)
+	if (m_GlyphAtlas.Initialize(m_Backend) == false)
 	{
 		return false;
 	}
 
-	if (CreateFontDevice() == false)
+	if (m_FrameAllocator.Initialize(DefaultFrameAllocatorSize) == false)
 	{
 		return false;
 	}
 
-	SetPivotType(PivotType::LeftTop);
-
-	m_D3DDevice->SetRenderState(D3DRS_ALPHABLENDENABLE, true);
-	m_D3DDevice->SetRenderState(D3DRS_SRCBLEND, D3DBLEND_SRCALPHA);
-	m_D3DDevice->SetRenderState(D3DRS_DESTBLEND, D3DBLEND_INVSRCALPHA);
+	int back_buffer_width = 0;
+	int back_buffer_height = 0;
+	m_Backend->GetBackBufferSize(&back_buffer_width, &back_buffer_height);
+	m_ViewportWidth = (float)back_buffer_width;
+	m_ViewportHeight = (float)back_buffer_height;
 
-	// テクスチャの設定
-	m_D3DDevice->SetTextureStageState(0, D3DTSS_ALPHAOP, D3DTOP_MODULATE);
-	m_D3DDevice->SetTextureStageState(0, D3DTSS_COLORARG1, D3DTA_TEXTURE);
-	m_D3DDevice->SetTextureStageState(0, D3DTSS_COLORARG2, D3DTA_DIFFUSE);
+	SetPivotType(PivotType::LeftTop);
+	ResetCamera();
 
 	return true;
 }
 
 void Graphics::Release()
 {
-	for (auto& device : m_FontList)
-	{
-		if (device == nullptr)
-		{
-			continue;
-		}
-		device->Release();
-		device = nullptr;
-	}
-
-	if (m_D3DDevice != nullptr)
+	// レイアウトはアトラスのグリフを参照しているので先に破棄する
+	m_TextLayoutCache.Clear();
+	m_GlyphAtlas.Release();
+	m_TextureCache.Release();
+	m_DeferredCommandList.Release();
+	m_FrameAllocator.Release();
+
+	if (m_Backend != nullptr)
 	{
-		m_D3DDevice->Release();
-		m_D3DDevice = nullptr;
-	}
-
-	if (m_D3DInterface != nullptr)
-	{
-		m_D3DInterface->Release();
-		m_D3DInterface = nullptr;
+		m_Backend->Release();
+		Engine::DeleteObject(m_Backend);
+		m_Backend = nullptr;
 	}
 }
 
 bool Graphics::StartDraw(DWORD color)
 {
-	if (m_D3DDevice == nullptr)
+	if (m_Backend == nullptr)
 	{
 		return false;
 	}
 
-	m_D3DDevice->Clear(0, NULL, D3DCLEAR_TARGET, color, 0.0f, 0);
+	m_FrameStats.Reset();
+	m_IsFrameStatsSuspended = false;
+	m_BatchVertexCount = 0;
+	m_DeferredCommandList.Clear();
+	InvalidateStateCache();
 
-	if (D3D_OK == m_D3DDevice->BeginScene())
+	// 前のフレームでPopされなかった変換は破棄する
+	if (m_TransformStackDepth != 0)
 	{
-		return true;
+		m_TransformStackDepth = 0;
+		UpdateViewTransform();
 	}
 
-	return false;
+	// 2フレーム前の作業領域をまとめて破棄する
+	m_FrameAllocator.NextFrame();
+	m_GlyphAtlas.NextFrame();
+	m_TextLayoutCache.NextFrame();
+
+	return m_Backend->BeginFrame(color);
 }
 
 void Graphics::FinishDraw()
 {
-	if (m_D3DDevice == nullptr)
+	PROFILE_FUNCTION();
+
+	if (m_Backend == nullptr)
 	{
 		return;
 	}
 
-	m_D3DDevice->EndScene();
-	m_D3DDevice->Present(nullptr, nullptr, nullptr, nullptr);
+	SubmitDeferredCommands();
+	FlushBatch();
+
+	m_Backend->EndFrame();
+
+	m_LastFrameStats = m_FrameStats;
+	m_FrameStatsHistory.Push(m_FrameStats);
 }
 
 void Graphics::DrawCircle(float x, float y, float radius, DWORD color, UCHAR alpha)
 {
+	// 三角関数で頂点を作成する前に画面外の円を除外する
+	if (CullBoundingCircle(x, y, radius) == true)
+	{
+		return;
+	}
+
 	color += alpha << 24;
 
-	CustomVertex v[182] =
-	{
-		x, y, 0.0f, 1.0f, color, 0.0f, 0.0f
-	};
+	CustomVertex* v = m_FrameAllocator.AllocateArray<CustomVertex>(CircleVertexCount);
+	v[0].X = x;
+	v[0].Y = y;
+	v[0].Z = 0.0f;
+	v[0].Rhw = 1.0f;
+	v[0].Color = color;
+	v[0].TextureX = 0.0f;
+	v[0].TexrureY = 0.0f;
 
-	for (int i = 1; i < 182; i++)
+	for (int i = 1; i < CircleVertexCount; i++)
 	{
 		float rad = D3DXToRadian((i - 1) * 2.0f);
 		float vec_x = cosf(rad) * radius;
@@ -123,18 +193,20 @@ void Graphics::DrawCircle(float x, float y, float radius, DWORD color, UCHAR alp
 		v[i].TexrureY = 0.0f;
 	}
 
-	// 頂点構造の指定
-	m_D3DDevice->SetFVF(VERTEX_FVF);
-
-	m_D3DDevice->SetTexture(0, nullptr);
-
-	m_D3DDevice->DrawPrimitiveUP(D3DPT_TRIANGLEFAN, 182 - 2, v, sizeof(CustomVertex));
+	AddTriangleFan(nullptr, v, CircleVertexCount);
 }
 
 void Graphics::DrawRect(float x, float y, float width, float height, DWORD color, UCHAR alpha, float angle, float scale_x, float scale_y)
 {
 	Size size = Size(width, height);
 
+	// 頂点を作成する前に画面外の矩形を除外する
+	Vec2 offset = CalculatePivotOffset(m_CurrentPivot, &size);
+	if (CullRect(x, y, size, offset, scale_x, scale_y) == true)
+	{
+		return;
+	}
+
 	color += alpha << 24;
 
 	CustomVertex v[4] =
@@ -145,8 +217,6 @@ void Graphics::DrawRect(float x, float y, float width, float height, DWORD color
 		{ 0.0f, size.Height, 0.0f, 1.0f, color, 0.0f, 1.0f },
 	};
 
-	Vec2 offset = CalculatePivotOffset(&size);
-
 	for (int i = 0; i < 4; i++)
 	{
 		v[i].X += offset.X;
@@ -155,12 +225,7 @@ void Graphics::DrawRect(float x, float y, float width, float height, DWORD color
 
 	TransformRect(v, x, y, angle, scale_x, scale_y);
 
-	// 頂点構造の指定
-	m_D3DDevice->SetFVF(VERTEX_FVF);
-
-	m_D3DDevice->SetTexture(0, nullptr);
-
-	m_D3DDevice->DrawPrimitiveUP(D3DPT_TRIANGLEFAN, 2, v, sizeof(CustomVertex));
+	AddQuad(nullptr, v);
 }
 
 void Graphics::DrawTextureUV(float x, float y, const char* texture_keyword, float tex_x, float tex_y, float sprite_width, float sprite_height, UCHAR alpha, float angle, float scale_x, float scale_y)
@@ -187,6 +252,13 @@ void Graphics::DrawTextureUV(float x, float y, const char* texture_keyword, floa
 
 	Size size = Size(sprite_width, sprite_height);
 
+	// 頂点を作成する前に画面外の矩形を除外する
+	Vec2 offset = CalculatePivotOffset(m_CurrentPivot, &size);
+	if (CullRect(x, y, size, offset, scale_x, scale_y) == true)
+	{
+		return;
+	}
+
 	DWORD color = D3DCOLOR_RGBA(0xff, 0xff, 0xff, alpha);
 	CustomVertex v[4] =
 	{
@@ -196,8 +268,6 @@ void Graphics::DrawTextureUV(float x, float y, const char* texture_keyword, floa
 		{ 0.0f, size.Height, 0.0f, 1.0f, color, u_left, v_bottom },
 	};
 
-	Vec2 offset = CalculatePivotOffset(&size);
-
 	for (int i = 0; i < 4; i++)
 	{
 		v[i].X += offset.X;
@@ -206,12 +276,7 @@ void Graphics::DrawTextureUV(float x, float y, const char* texture_keyword, floa
 
 	TransformRect(v, x, y, angle, scale_x, scale_y);
 
-	// 頂点構造の指定
-	m_D3DDevice->SetFVF(VERTEX_FVF);
-
-	m_D3DDevice->SetTexture(0, texture_data->TextureData);
-
-	m_D3DDevice->DrawPrimitiveUP(D3DPT_TRIANGLEFAN, 2, v, sizeof(CustomVertex));
+	AddQuad(texture_data, v);
 }
 
 void Graphics::DrawTexture(float x, float y, const char* texture_keyword, UCHAR alpha, float angle, float scale_x, float scale_y)
@@ -224,6 +289,13 @@ void Graphics::DrawTexture(float x, float y, const char* texture_keyword, UCHAR
 
 	Size size = Size((float)texture_data->Width, (float)texture_data->Height);
 
+	// 頂点を作成する前に画面外の矩形を除外する
+	Vec2 offset = CalculatePivotOffset(m_CurrentPivot, &size);
+	if (CullRect(x, y, size, offset, scale_x, scale_y) == true)
+	{
+		return;
+	}
+
 	DWORD color = D3DCOLOR_RGBA(0xff, 0xff, 0xff, alpha);
 	CustomVertex v[4] =
 	{
@@ -233,8 +305,6 @@ void Graphics::DrawTexture(float x, float y, const char* texture_keyword, UCHAR
 		{ 0.0f, size.Height, 0.0f, 1.0f, color, 0.0f, 1.0f },
 	};
 
-	Vec2 offset = CalculatePivotOffset(&size);
-
 	for (int i = 0; i < 4; i++)
 	{
 		v[i].X += offset.X;
@@ -243,27 +313,16 @@ void Graphics::DrawTexture(float x, float y, const char* texture_keyword, UCHAR
 
 	TransformRect(v, x, y, angle, scale_x, scale_y);
 
-	// 頂点構造の指定
-	m_D3DDevice->SetFVF(VERTEX_FVF);
-
-	m_D3DDevice->SetTexture(0, texture_data->TextureData);
-
-	m_D3DDevice->DrawPrimitiveUP(D3DPT_TRIANGLEFAN, 2, v, sizeof(CustomVertex));
+	AddQuad(texture_data, v);
 }
 
 void Graphics::DrawFont(float x, float y, const char* text, FontSize font_type, FontColor color)
 {
-	if (m_FontList[font_type] == nullptr)
-	{
-		return;
-	}
-
-	RECT rect =
+	int size_list[] =
 	{
-		(long)x,
-		(long)y,
-		(long)x + 800,
-		(long)y + 300,
+		SmallFontSize,
+		RegularFontSize,
+		LargeFontSize
 	};
 
 	int r, g, b;
@@ -279,164 +338,521 @@ void Graphics::DrawFont(float x, float y, const char* text, FontSize font_type,
 		g = b = 0;
 	}
 
-	m_FontList[font_type]->DrawText(
-		nullptr,
-		text,
-		-1,
-		&rect,
-		DT_LEFT,
-		D3DCOLOR_XRGB(r, g, b)
-	);
+	DrawFontEx(x, y, text, size_list[font_type], D3DCOLOR_XRGB(r, g, b));
 }
 
-void Graphics::SetPivotType(PivotType pivot_type)
+void Graphics::DrawFontEx(float x, float y, const char* text, int font_size, DWORD color, int wrap_width)
 {
-	m_CurrentPivot = pivot_type;
+	if (text == nullptr || text[0] == '\0')
+	{
+		return;
+	}
+
+	bool is_hit = false;
+	const TextLayout* layout = m_TextLayoutCache.FindLayout(text, font_size, wrap_width, &m_GlyphAtlas, &m_FrameAllocator, &is_hit);
+
+	if (is_hit == true)
+	{
+		m_FrameStats.TextLayoutHitCount++;
+	}
+	else
+	{
+		m_FrameStats.TextLayoutMissCount++;
+	}
+
+	// グリフのピクセルが画面のピクセルと一致するように整数座標から描画する
+	float origin_x = floorf(x);
+	float origin_y = floorf(y);
+
+	// 文字列全体の範囲が画面外の場合は頂点をコピーしない
+	float half_width = (layout->MaxX - layout->MinX) / 2.0f;
+	float half_height = (layout->MaxY - layout->MinY) / 2.0f;
+	if (CullBoundingCircle(origin_x + layout->MinX + half_width, origin_y + layout->MinY + half_height, sqrtf(half_width * half_width + half_height * half_height)) == true)
+	{
+		return;
+	}
+
+	const Texture* atlas_texture = m_GlyphAtlas.GetTexture();
+	const CustomVertex* src = layout->Vertices.empty() == true ? nullptr : &layout->Vertices[0];
+	int vertex_count = (int)layout->Vertices.size();
+
+	while (vertex_count > 0)
+	{
+		// 矩形の途中で分割しないように6の倍数で区切る
+		int count = vertex_count;
+		if (count > MaxBatchVertexCount)
+		{
+			count = MaxBatchVertexCount - MaxBatchVertexCount % 6;
+		}
+
+		CustomVertex* dest = ReserveBatch(atlas_texture, count);
+		for (int i = 0; i < count; i++)
+		{
+			dest[i] = src[i];
+			dest[i].X += origin_x;
+			dest[i].Y += origin_y;
+			dest[i].Color = color;
+		}
+
+		if (m_IsViewTransformIdentity == false)
+		{
+			TransformVertices(dest, dest, count);
+		}
+
+		src += count;
+		vertex_count -= count;
+	}
+
+	m_FrameStats.FontDrawCount++;
 }
 
-bool Graphics::CreateTexture(const char* file_name, Texture* texture_data)
+void Graphics::DrawBitmapFont(float x, float y, const BitmapFontData* font_data, const char* text, DWORD color, float scale)
 {
-	D3DXIMAGE_INFO info;
+	if (font_data == nullptr || text == nullptr)
+	{
+		return;
+	}
 
-	// 2の累乗じゃないケースを想定して元のサイズを取得してD3DXCreateTextureFromFileExで使う
-	D3DXGetImageInfoFromFile(file_name, &info);
+	// 等倍の場合はグリフのピクセルが画面のピクセルと一致するように整数座標から描画する
+	BitmapFontCursor cursor;
+	font_data->Font.BeginLayout(text, floorf(x), floorf(y), scale, &cursor);
 
-	if (FAILED(D3DXCreateTextureFromFileEx(
-		m_D3DDevice,
-		file_name,
-		info.Width,
-		info.Height,
-		1,
-		0,
-		D3DFMT_UNKNOWN,
-		D3DPOOL_MANAGED,
-		D3DX_DEFAULT,
-		D3DX_DEFAULT,
-		0x0000ff00,
-		nullptr,
-		nullptr,
-		&texture_data->TextureData)))
+	BitmapGlyphQuad quad;
+	while (font_data->Font.NextQuad(&cursor, &quad) == true)
 	{
-		return false;
+		const BitmapGlyph* glyph = quad.Glyph;
+		if (glyph->Page >= font_data->PageCount)
+		{
+			continue;
+		}
+
+		// ピクセルとテクセルの中心を合わせるために0.5ずらす
+		float left = quad.Left - 0.5f;
+		float top = quad.Top - 0.5f;
+		float right = quad.Right - 0.5f;
+		float bottom = quad.Bottom - 0.5f;
+
+		CustomVertex v[4] =
+		{
+			{ left, top, 0.0f, 1.0f, color, glyph->U0, glyph->V0 },
+			{ right, top, 0.0f, 1.0f, color, glyph->U1, glyph->V0 },
+			{ right, bottom, 0.0f, 1.0f, color, glyph->U1, glyph->V1 },
+			{ left, bottom, 0.0f, 1.0f, color, glyph->U0, glyph->V1 },
+		};
+
+		AddQuad(&font_data->Pages[glyph->Page], v);
 	}
-	else
+
+	m_FrameStats.FontDrawCount++;
+}
+
+void Graphics::DrawTilemap(Tilemap* tilemap)
+{
+	PROFILE_FUNCTION();
+
+	tilemap->RebuildDirtyChunks();
+
+	float left = 0.0f;
+	float top = 0.0f;
+	float right = 0.0f;
+	float bottom = 0.0f;
+	CalculateVisibleWorldRect(&left, &top, &right, &bottom);
+
+	int first_column = 0;
+	int first_row = 0;
+	int last_column = 0;
+	int last_row = 0;
+	if (tilemap->FindChunkRange(left, top, right, bottom, &first_column, &first_row, &last_column, &last_row) == false)
 	{
-		// テクスチャサイズの取得
-		D3DSURFACE_DESC desc;
+		return;
+	}
+
+	const Texture* tileset = tilemap->GetTileset();
+	Engine::TouchTexture(tileset);
 
-		if (FAILED(texture_data->TextureData->GetLevelDesc(0, &desc)))
+	for (int row = first_row; row <= last_row; row++)
+	{
+		for (int column = first_column; column <= last_column; column++)
 		{
-			texture_data->TextureData->Release();
-			return false;
+			const TilemapChunk& chunk = tilemap->GetChunk(column, row);
+			if (chunk.Vertices.empty() == true)
+			{
+				continue;
+			}
+
+			DrawTriangles(tileset, &chunk.Vertices[0], (int)chunk.Vertices.size());
 		}
-		texture_data->Width = desc.Width;
-		texture_data->Height = desc.Height;
 	}
+}
 
-	return true;
+void Graphics::DrawParticles(const ParticleEmitter* emitter)
+{
+	PROFILE_FUNCTION();
+
+	const std::string& texture_keyword = emitter->GetDesc().TextureKeyword;
+	const Texture* texture = texture_keyword.empty() == true ? nullptr : Engine::GetTexture(texture_keyword.c_str());
+
+	int particle_count = emitter->GetCount();
+	int first = 0;
+
+	while (first < particle_count)
+	{
+		// 1個6頂点なのでバッチに収まる個数ずつ区切る
+		int count = (std::min)(particle_count - first, MaxBatchVertexCount / 6);
+
+		CustomVertex* dest = ReserveBatch(texture, count * 6);
+		emitter->WriteVertices(first, count, dest);
+
+		if (m_IsViewTransformIdentity == false)
+		{
+			TransformVertices(dest, dest, count * 6);
+		}
+
+		first += count;
+	}
 }
 
-bool Graphics::CreateInterface()
+void Graphics::DrawTriangles(const Texture* texture, const CustomVertex* vertices, int vertex_count)
 {
-	// インターフェース作成
-	m_D3DInterface = Direct3DCreate9(D3D_SDK_VERSION);
-	if (m_D3DInterface == NULL)
+	while (vertex_count > 0)
 	{
-		// 作成失敗
-		return false;
+		// 三角形の途中で分割しないように3の倍数で区切る
+		int count = vertex_count;
+		if (count > MaxBatchVertexCount)
+		{
+			count = MaxBatchVertexCount - MaxBatchVertexCount % 3;
+		}
+
+		CustomVertex* dest = ReserveBatch(texture, count);
+		if (m_IsViewTransformIdentity == true)
+		{
+			memcpy(dest, vertices, sizeof(CustomVertex) * count);
+		}
+		else
+		{
+			TransformVertices(vertices, dest, count);
+		}
+
+		vertices += count;
+		vertex_count -= count;
 	}
+}
 
-	// 作成成功
-	return true;
+void Graphics::SubmitCommandList(const DrawCommandList& command_list)
+{
+	PROFILE_FUNCTION();
+
+	// テクスチャの使用記録は描画スレッドから行えないので、ゲームスレッドでEngineが済ませている
+	int layer = m_DrawLayer;
+	TextureFilter filter = m_TextureFilter;
+
+	for (int i = 0; i < command_list.GetCount(); i++)
+	{
+		const DrawCommand& command = command_list.GetCommand(i);
+
+		m_DrawLayer = command.Layer;
+		m_TextureFilter = command.Filter;
+		DrawTriangles(command.TextureData, command_list.GetVertices(command), command.VertexCount);
+	}
+
+	m_DrawLayer = layer;
+	m_TextureFilter = filter;
 }
 
-bool Graphics::CreateDevice(D3DPRESENT_PARAMETERS* present_param, bool is_window_mode)
+void Graphics::FlushBatch()
 {
-	present_param->BackBufferCount = 1;
-	present_param->BackBufferFormat = D3DFMT_X8R8G8B8;
-	present_param->SwapEffect = D3DSWAPEFFECT_DISCARD;
+	if (m_BatchVertexCount == 0)
+	{
+		return;
+	}
+
+	// 頂点構造の指定
+	BindVertexFormat();
+
+	BindTexture(m_BatchTexture);
+	BindTextureFilter(m_BatchFilter);
+
+	DrawPrimitive(m_BatchVertices, m_BatchVertexCount);
 
-	if (is_window_mode == true)
+	m_BatchVertexCount = 0;
+}
+
+void Graphics::SuspendFrameStats()
+{
+	if (m_IsFrameStatsSuspended == true)
 	{
-		present_param->Windowed = is_window_mode;
+		return;
 	}
-	else
+
+	// 停止前の描画を確定させてから統計を退避する
+	SubmitDeferredCommands();
+	FlushBatch();
+
+	m_SuspendedFrameStats = m_FrameStats;
+	m_IsFrameStatsSuspended = true;
+}
+
+void Graphics::ResumeFrameStats()
+{
+	if (m_IsFrameStatsSuspended == false)
 	{
-		HWND window_handle = FindWindow(WINDOW_CLASS_NAME, nullptr);
+		return;
+	}
+
+	SubmitDeferredCommands();
+	FlushBatch();
 
-		RECT rect;
-		GetClientRect(window_handle, &rect);
+	m_FrameStats = m_SuspendedFrameStats;
+	m_IsFrameStatsSuspended = false;
+}
 
-		present_param->Windowed = is_window_mode;
-		present_param->BackBufferHeight = rect.bottom - rect.top;
-		present_param->BackBufferWidth = rect.right - rect.left;
+void Graphics::SetDeferredDrawing(bool is_enabled)
+{
+	if (is_enabled == false)
+	{
+		SubmitDeferredCommands();
 	}
 
-	// DirectDeviceの作成
-	if (FAILED(m_D3DInterface->CreateDevice(D3DADAPTER_DEFAULT,
-		D3DDEVTYPE_HAL,
-		FindWindow(WINDOW_CLASS_NAME, nullptr),
-		D3DCREATE_HARDWARE_VERTEXPROCESSING | D3DCREATE_MULTITHREADED,
-		present_param,
-		&m_D3DDevice)))
+	m_IsDeferredDrawing = is_enabled;
+}
+
+void Graphics::SetDrawLayer(int layer)
+{
+	m_DrawLayer = (std::min)((std::max)(layer, 0), DrawLayerCount - 1);
+}
+
+void Graphics::SetTextureFilter(TextureFilter filter)
+{
+	if (filter < 0 || filter >= TextureFilterMax)
+	{
+		return;
+	}
+
+	m_TextureFilter = filter;
+}
+
+void Graphics::SetPivotType(PivotType pivot_type)
+{
+	m_CurrentPivot = pivot_type;
+}
+
+void Graphics::SetCamera(float x, float y, float zoom, float angle)
+{
+	m_Camera.Position = Vec2(x, y);
+	m_Camera.Zoom = zoom;
+	m_Camera.Angle = angle;
+
+	UpdateViewTransform();
+}
+
+void Graphics::ResetCamera()
+{
+	SetCamera(m_ViewportWidth / 2.0f, m_ViewportHeight / 2.0f, 1.0f, 0.0f);
+}
+
+bool Graphics::PushTransform(const Matrix2D& transform)
+{
+	if (m_TransformStackDepth >= MaxTransformStackDepth)
 	{
 		return false;
 	}
 
+	// 追加した変換を先に行い、その後に親の変換を行う
+	m_TransformStack[m_TransformStackDepth + 1] = Matrix2D::Multiply(transform, m_TransformStack[m_TransformStackDepth]);
+	m_TransformStackDepth++;
+
+	UpdateViewTransform();
+
 	return true;
 }
 
-bool Graphics::SetUpViewPort(D3DPRESENT_PARAMETERS* present_param)
+void Graphics::PopTransform()
+{
+	if (m_TransformStackDepth == 0)
+	{
+		return;
+	}
+
+	m_TransformStackDepth--;
+
+	UpdateViewTransform();
+}
+
+void Graphics::SetTransformEnabled(bool is_enabled)
+{
+	m_IsTransformEnabled = is_enabled;
+
+	UpdateViewTransform();
+}
+
+Vec2 Graphics::ConvertScreenToWorld(const Vec2& screen_pos) const
+{
+	return Matrix2D::Inverse(CreateCameraMatrix()).TransformPoint(screen_pos);
+}
+
+bool Graphics::CreateTexture(const char* file_name, Texture* texture_data, FileContentHash* out_hash)
 {
-	// ビューポートパラメータ
-	D3DVIEWPORT9 view_port;
+	// ミップマップはデコードしたテクセルから作成する(デコードできない場合はミップマップなしで作成する)
+	if (m_IsMipmapGeneration == true)
+	{
+		int width = 0;
+		int height = 0;
+		std::vector<DWORD> pixels;
+		if (DecodeTexture(file_name, &width, &height, &pixels, out_hash) == true)
+		{
+			return CreateTextureFromPixels(width, height, &pixels[0], texture_data);
+		}
+	}
+
+	// アーカイブのファイルはデコード済みのテクセルを保存するよりも、そのまま読み込む方が速い
+	FileData file_data;
+	if (m_FileSystem != nullptr &&
+		m_FileSystem->ReadFile(file_name, &file_data) == true)
+	{
+		if (out_hash != nullptr)
+		{
+			*out_hash = FileSystem::MakeContentHash(file_data.Data, file_data.Size);
+		}
+		return m_Backend->CreateTextureFromMemory(file_data.Data, file_data.Size, texture_data);
+	}
+
+	if (m_TextureCache.IsEnabled() == false)
+	{
+		// 内容のハッシュ値を計算できるように、ファイルは1度だけ読み込んでメモリから作成する
+		if (FileSystem::ReadLooseFile(file_name, &file_data) == true)
+		{
+			if (out_hash != nullptr)
+			{
+				*out_hash = FileSystem::MakeContentHash(file_data.Data, file_data.Size);
+			}
+			return m_Backend->CreateTextureFromMemory(file_data.Data, file_data.Size, texture_data);
+		}
+
+		return m_Backend->CreateTexture(file_name, texture_data);
+	}
+
+	TextureCacheView view;
+	if (m_TextureCache.Open(file_name, &view) == true)
+	{
+		bool is_succeeded = CreateTextureFromPixels(view.Width, view.Height, view.Pixels, texture_data);
+		if (is_succeeded == true && out_hash != nullptr)
+		{
+			out_hash->Value = view.SourceHash;
+			out_hash->Size = view.SourceSize;
+			out_hash->IsValid = true;
+		}
+		m_TextureCache.Close(&view);
+
+		if (is_succeeded == true)
+		{
+			return true;
+		}
+	}
+
+	int width = 0;
+	int height = 0;
+	std::vector<DWORD> pixels;
+	if (DecodeAndCacheTexture(file_name, &width, &height, &pixels, out_hash) == false)
+	{
+		// デコードに対応していない描画バックエンドはキャッシュを使用しない
+		return m_Backend->CreateTexture(file_name, texture_data);
+	}
+
+	return CreateTextureFromPixels(width, height, &pixels[0], texture_data);
+}
+
+bool Graphics::DecodeTexture(const char* file_name, int* out_width, int* out_height, std::vector<DWORD>* out_pixels, FileContentHash* out_hash)
+{
+	FileData file_data;
+	if (m_FileSystem != nullptr &&
+		m_FileSystem->ReadFile(file_name, &file_data) == true)
+	{
+		if (out_hash != nullptr)
+		{
+			*out_hash = FileSystem::MakeContentHash(file_data.Data, file_data.Size);
+		}
+		return m_Backend->DecodeTextureFromMemory(file_data.Data, file_data.Size, out_width, out_height, out_pixels);
+	}
+
+	TextureCacheView view;
+	if (m_TextureCache.IsEnabled() == true &&
+		m_TextureCache.Open(file_name, &view) == true)
+	{
+		*out_width = view.Width;
+		*out_height = view.Height;
+		out_pixels->assign(view.Pixels, view.Pixels + (size_t)view.Width * view.Height);
+		if (out_hash != nullptr)
+		{
+			out_hash->Value = view.SourceHash;
+			out_hash->Size = view.SourceSize;
+			out_hash->IsValid = true;
+		}
+		m_TextureCache.Close(&view);
+
+		return true;
+	}
+
+	return DecodeAndCacheTexture(file_name, out_width, out_height, out_pixels, out_hash);
+}
+
+bool Graphics::EnableTextureCache(const char* directory)
+{
+	return m_TextureCache.Initialize(directory);
+}
+
+bool Graphics::DecodeAndCacheTexture(const char* file_name, int* out_width, int* out_height, std::vector<DWORD>* out_pixels, FileContentHash* out_hash)
+{
+	FileData file_data;
+	if (FileSystem::ReadLooseFile(file_name, &file_data) == false)
+	{
+		return false;
+	}
 
-	// ビューポートの左上座標
-	view_port.X = 0;
-	view_port.Y = 0;
-	// ビューポートの幅
-	view_port.Width = present_param->BackBufferWidth;
-	// ビューポートの高さ
-	view_port.Height = present_param->BackBufferHeight;
-	// ビューポート深度設定
-	view_port.MinZ = 0.0f;
-	view_port.MaxZ = 1.0f;
+	FileContentHash content_hash = FileSystem::MakeContentHash(file_data.Data, file_data.Size);
 
-	// ビューポート設定
-	if (FAILED(m_D3DDevice->SetViewport(&view_port)))
+	if (m_Backend->DecodeTextureFromMemory(file_data.Data, file_data.Size, out_width, out_height, out_pixels) == false)
 	{
 		return false;
 	}
 
+	// 保存に失敗しても次回デコードし直すだけなので、失敗は無視する
+	if (m_TextureCache.IsEnabled() == true)
+	{
+		m_TextureCache.Write(file_name, *out_width, *out_height, &(*out_pixels)[0], content_hash.Value);
+	}
+
+	if (out_hash != nullptr)
+	{
+		*out_hash = content_hash;
+	}
+
 	return true;
 }
 
-bool Graphics::CreateFontDevice()
+bool Graphics::CreateTextureFromPixels(int width, int height, const DWORD* pixels, Texture* texture_data)
 {
-	int size_list[] =
+	int level_count = MipmapGenerator::CalculateLevelCount(width, height);
+	if (m_IsMipmapGeneration == true && level_count > 1)
 	{
-		SmallFontSize,
-		RegularFontSize,
-		LargeFontSize
-	};
+		std::vector<DWORD> chain;
+		MipmapGenerator::GenerateChain(width, height, pixels, level_count, &chain);
 
-	for (int i = 0; i < FontSize::FontSizeMax; i++)
-	{
-		if (FAILED(D3DXCreateFont(m_D3DDevice,
-			size_list[i],
-			size_list[i] / 2,
-			FW_REGULAR,
-			0,
-			FALSE,
-			DEFAULT_CHARSET,
-			OUT_DEFAULT_PRECIS,
-			PROOF_QUALITY,
-			FIXED_PITCH | FF_SCRIPT,
-			TEXT("ＭＳ　Ｐゴシック"),
-			&m_FontList[i])))
+		return m_Backend->CreateMipmappedTexture(width, height, level_count, &chain[0], texture_data);
+	}
+
+	if (m_Backend->CreateEmptyTexture(width, height, texture_data) == false)
+	{
+		return false;
+	}
+
+	if (m_Backend->UpdateTexture(texture_data, 0, 0, width, height, pixels, width) == false)
+	{
+		if (texture_data->TextureData != nullptr)
 		{
-			return false;
+			texture_data->TextureData->Release();
+			texture_data->TextureData = nullptr;
 		}
+		return false;
 	}
 
 	return true;
@@ -465,7 +881,7 @@ void Graphics::TransformRect(CustomVertex* vertices, float pos_x, float pos_y, f
 	}
 }
 
-Vec2 Graphics::CalculatePivotOffset(Size* size)
+Vec2 Graphics::CalculatePivotOffset(PivotType pivot_type, const Size* size)
 {
 	Vec2 offset[] =
 	{
@@ -482,5 +898,340 @@ Vec2 Graphics::CalculatePivotOffset(Size* size)
 		{ Vec2(-size->Width, -size->Height) },
 	};
 
-	return offset[m_CurrentPivot];
+	return offset[pivot_type];
+}
+
+Matrix2D Graphics::CreateCameraMatrix() const
+{
+	// カメラの位置を原点に移動し、回転、拡大してから画面の中心に移動する
+	Matrix2D matrix = Matrix2D::Translation(-m_Camera.Position.X, -m_Camera.Position.Y);
+	matrix = Matrix2D::Multiply(matrix, Matrix2D::Rotation(-m_Camera.Angle));
+	matrix = Matrix2D::Multiply(matrix, Matrix2D::Scaling(m_Camera.Zoom, m_Camera.Zoom));
+	matrix = Matrix2D::Multiply(matrix, Matrix2D::Translation(m_ViewportWidth / 2.0f, m_ViewportHeight / 2.0f));
+
+	return matrix;
+}
+
+void Graphics::UpdateViewTransform()
+{
+	if (m_IsTransformEnabled == false)
+	{
+		m_ViewTransform = Matrix2D();
+	}
+	else
+	{
+		m_ViewTransform = Matrix2D::Multiply(m_TransformStack[m_TransformStackDepth], CreateCameraMatrix());
+	}
+
+	// 既定のカメラで変換がない場合は頂点の変換を省略する
+	m_IsViewTransformIdentity = m_ViewTransform.IsIdentity();
+}
+
+bool Graphics::TransformVertices(const CustomVertex* src, CustomVertex* dest, int vertex_count)
+{
+	const Matrix2D& m = m_ViewTransform;
+
+	__m128 m11 = _mm_set1_ps(m.M11);
+	__m128 m12 = _mm_set1_ps(m.M12);
+	__m128 m21 = _mm_set1_ps(m.M21);
+	__m128 m22 = _mm_set1_ps(m.M22);
+	__m128 dx = _mm_set1_ps(m.Dx);
+	__m128 dy = _mm_set1_ps(m.Dy);
+
+	__m128 min_x = _mm_set1_ps(FLT_MAX);
+	__m128 min_y = _mm_set1_ps(FLT_MAX);
+	__m128 max_x = _mm_set1_ps(-FLT_MAX);
+	__m128 max_y = _mm_set1_ps(-FLT_MAX);
+
+	// 4頂点ずつX、Yをまとめて変換し、同じループで範囲を求める
+	int i = 0;
+	for (; i + 4 <= vertex_count; i += 4)
+	{
+		__m128 x = _mm_set_ps(src[i + 3].X, src[i + 2].X, src[i + 1].X, src[i].X);
+		__m128 y = _mm_set_ps(src[i + 3].Y, src[i + 2].Y, src[i + 1].Y, src[i].Y);
+
+		if (m_IsViewTransformIdentity == false)
+		{
+			__m128 transformed_x = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m11), _mm_mul_ps(y, m21)), dx);
+			__m128 transformed_y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m12), _mm_mul_ps(y, m22)), dy);
+			x = transformed_x;
+			y = transformed_y;
+		}
+
+		float xs[4];
+		float ys[4];
+		_mm_storeu_ps(xs, x);
+		_mm_storeu_ps(ys, y);
+
+		for (int j = 0; j < 4; j++)
+		{
+			dest[i + j] = src[i + j];
+			dest[i + j].X = xs[j];
+			dest[i + j].Y = ys[j];
+		}
+
+		min_x = _mm_min_ps(min_x, x);
+		min_y = _mm_min_ps(min_y, y);
+		max_x = _mm_max_ps(max_x, x);
+		max_y = _mm_max_ps(max_y, y);
+	}
+
+	for (; i < vertex_count; i++)
+	{
+		float x = src[i].X;
+		float y = src[i].Y;
+
+		if (m_IsViewTransformIdentity == false)
+		{
+			float transformed_x = x * m.M11 + y * m.M21 + m.Dx;
+			float transformed_y = x * m.M12 + y * m.M22 + m.Dy;
+			x = transformed_x;
+			y = transformed_y;
+		}
+
+		dest[i] = src[i];
+		dest[i].X = x;
+		dest[i].Y = y;
+
+		min_x = _mm_min_ps(min_x, _mm_set1_ps(x));
+		min_y = _mm_min_ps(min_y, _mm_set1_ps(y));
+		max_x = _mm_max_ps(max_x, _mm_set1_ps(x));
+		max_y = _mm_max_ps(max_y, _mm_set1_ps(y));
+	}
+
+	return IsBoundsVisible(HorizontalMin(min_x), HorizontalMin(min_y), HorizontalMax(max_x), HorizontalMax(max_y), m_ViewportWidth, m_ViewportHeight);
+}
+
+void Graphics::CalculateVisibleWorldRect(float* out_left, float* out_top, float* out_right, float* out_bottom) const
+{
+	Matrix2D inverse = Matrix2D::Inverse(m_ViewTransform);
+
+	Vec2 corners[4] =
+	{
+		inverse.TransformPoint(Vec2(0.0f, 0.0f)),
+		inverse.TransformPoint(Vec2(m_ViewportWidth, 0.0f)),
+		inverse.TransformPoint(Vec2(m_ViewportWidth, m_ViewportHeight)),
+		inverse.TransformPoint(Vec2(0.0f, m_ViewportHeight)),
+	};
+
+	*out_left = corners[0].X;
+	*out_top = corners[0].Y;
+	*out_right = corners[0].X;
+	*out_bottom = corners[0].Y;
+	for (int i = 1; i < 4; i++)
+	{
+		*out_left = (std::min)(*out_left, corners[i].X);
+		*out_top = (std::min)(*out_top, corners[i].Y);
+		*out_right = (std::max)(*out_right, corners[i].X);
+		*out_bottom = (std::max)(*out_bottom, corners[i].Y);
+	}
+}
+
+bool Graphics::CullBoundingCircle(float x, float y, float radius)
+{
+	const Matrix2D& m = m_ViewTransform;
+
+	// 円を変換した楕円の外接矩形で判定する(拡縮、回転されていても画面内の円を除外しない)
+	float center_x = x * m.M11 + y * m.M21 + m.Dx;
+	float center_y = x * m.M12 + y * m.M22 + m.Dy;
+	float extent_x = radius * sqrtf(m.M11 * m.M11 + m.M21 * m.M21);
+	float extent_y = radius * sqrtf(m.M12 * m.M12 + m.M22 * m.M22);
+
+	if (IsBoundsVisible(center_x - extent_x, center_y - extent_y, center_x + extent_x, center_y + extent_y, m_ViewportWidth, m_ViewportHeight) == true)
+	{
+		return false;
+	}
+
+	m_FrameStats.CulledCount++;
+	return true;
+}
+
+bool Graphics::CullRect(float x, float y, const Size& size, const Vec2& offset, float scale_x, float scale_y)
+{
+	// 回転の中心(軸)から最も遠い頂点までの距離を半径とする円は回転に関係なく矩形を含む
+	float far_x = (std::max)(fabsf(offset.X), fabsf(offset.X + size.Width)) * fabsf(scale_x);
+	float far_y = (std::max)(fabsf(offset.Y), fabsf(offset.Y + size.Height)) * fabsf(scale_y);
+
+	return CullBoundingCircle(x, y, sqrtf(far_x * far_x + far_y * far_y));
+}
+
+void Graphics::BindVertexFormat()
+{
+	if (m_IsVertexFormatBound == true)
+	{
+		return;
+	}
+
+	m_Backend->SetVertexFormat();
+	m_IsVertexFormatBound = true;
+	m_FrameStats.StateChangeCount++;
+}
+
+void Graphics::BindTexture(const Texture* texture)
+{
+	if (m_IsTextureBound == true &&
+		m_CurrentTexture == texture)
+	{
+		return;
+	}
+
+	m_Backend->SetTexture(texture);
+	m_CurrentTexture = texture;
+	m_IsTextureBound = true;
+	m_FrameStats.StateChangeCount++;
+	m_FrameStats.TextureBindCount++;
+}
+
+void Graphics::BindTextureFilter(TextureFilter filter)
+{
+	if (m_IsFilterBound == true &&
+		m_CurrentFilter == filter)
+	{
+		return;
+	}
+
+	m_Backend->SetTextureFilter(filter);
+	m_CurrentFilter = filter;
+	m_IsFilterBound = true;
+	m_FrameStats.StateChangeCount++;
+}
+
+void Graphics::DrawPrimitive(const CustomVertex* vertices, int vertex_count)
+{
+	m_Backend->DrawTriangleList(vertices, vertex_count);
+
+	m_FrameStats.DrawCallCount++;
+	m_FrameStats.PrimitiveCount += vertex_count / 3;
+	m_FrameStats.VertexCount += vertex_count;
+}
+
+void Graphics::InvalidateStateCache()
+{
+	m_CurrentTexture = nullptr;
+	m_IsVertexFormatBound = false;
+	m_IsTextureBound = false;
+	m_IsFilterBound = false;
+}
+
+void Graphics::AddQuad(const Texture* texture, const CustomVertex* vertices)
+{
+	CustomVertex transformed[4];
+	if (TransformVertices(vertices, transformed, 4) == false)
+	{
+		m_FrameStats.CulledCount++;
+		return;
+	}
+
+	CustomVertex* dest = ReserveBatch(texture, 6);
+
+	dest[0] = transformed[0];
+	dest[1] = transformed[1];
+	dest[2] = transformed[2];
+	dest[3] = transformed[0];
+	dest[4] = transformed[2];
+	dest[5] = transformed[3];
+}
+
+void Graphics::AddTriangleFan(const Texture* texture, const CustomVertex* vertices, int vertex_count)
+{
+	if (vertex_count > MaxTriangleFanVertexCount)
+	{
+		vertex_count = MaxTriangleFanVertexCount;
+	}
+
+	CustomVertex* transformed = m_FrameAllocator.AllocateArray<CustomVertex>(vertex_count);
+	if (TransformVertices(vertices, transformed, vertex_count) == false)
+	{
+		m_FrameStats.CulledCount++;
+		return;
+	}
+
+	int triangle_count = vertex_count - 2;
+	CustomVertex* dest = ReserveBatch(texture, triangle_count * 3);
+
+	for (int i = 0; i < triangle_count; i++)
+	{
+		dest[i * 3 + 0] = transformed[0];
+		dest[i * 3 + 1] = transformed[i + 1];
+		dest[i * 3 + 2] = transformed[i + 2];
+	}
+}
+
+CustomVertex* Graphics::ReserveBatch(const Texture* texture, int vertex_count)
+{
+	if (m_IsDeferredDrawing == true && m_IsSubmittingDeferred == false)
+	{
+		if (m_DeferredCommandList.IsFull() == true)
+		{
+			SubmitDeferredCommands();
+		}
+
+		return m_DeferredCommandList.AddCommand(texture, vertex_count, m_DrawLayer, m_TextureFilter);
+	}
+
+	if (m_BatchVertexCount > 0 &&
+		(m_BatchTexture != texture || m_BatchFilter != m_TextureFilter || m_BatchVertexCount + vertex_count > MaxBatchVertexCount))
+	{
+		FlushBatch();
+	}
+
+	m_BatchTexture = texture;
+	m_BatchFilter = m_TextureFilter;
+
+	CustomVertex* dest = &m_BatchVertices[m_BatchVertexCount];
+	m_BatchVertexCount += vertex_count;
+
+	return dest;
+}
+
+void Graphics::SubmitDeferredCommands()
+{
+	PROFILE_FUNCTION();
+
+	int count = m_DeferredCommandList.GetCount();
+	if (count == 0)
+	{
+		return;
+	}
+
+	{
+		PROFILE_SCOPE("DrawCommandList::Sort");
+		m_DeferredCommandList.Sort(m_ViewportWidth, m_ViewportHeight, &m_FrameAllocator);
+	}
+
+	// 送信中はReserveBatchが通常のバッチに書き込むようにする
+	m_IsSubmittingDeferred = true;
+	TextureFilter filter = m_TextureFilter;
+
+	for (int i = 0; i < count; i++)
+	{
+		const DrawCommand& command = m_DeferredCommandList.GetSortedCommand(i);
+		m_TextureFilter = command.Filter;
+		CustomVertex* dest = ReserveBatch(command.TextureData, command.VertexCount);
+		memcpy(dest, m_DeferredCommandList.GetVertices(command), sizeof(CustomVertex) * command.VertexCount);
+	}
+
+	m_TextureFilter = filter;
+	m_IsSubmittingDeferred = false;
+
+	m_DeferredCommandList.Clear();
+}
+
+RenderBackend* Graphics::CreateBackend(RenderBackendType backend_type)
+{
+	switch (backend_type)
+	{
+	case RenderBackendType::RenderBackendTypeD3D9:
+		return Engine::NewObject<D3D9RenderBackend>(MemoryTagGraphics);
+	case RenderBackendType::RenderBackendTypeNull:
+		return Engine::NewObject<NullRenderBackend>(MemoryTagGraphics);
+	case RenderBackendType::RenderBackendTypeRecording:
+		return Engine::NewObject<RecordingRenderBackend>(MemoryTagGraphics);
+	case RenderBackendType::RenderBackendTypeSoftware:
+		return Engine::NewObject<SoftwareRenderBackend>(MemoryTagGraphics);
+	default:
+		break;
+	}
+
+	return nullptr;
 }
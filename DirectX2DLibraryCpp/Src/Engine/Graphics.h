@@ -13,21 +13,85 @@
 #include <d3d9.h>
 #include <d3dx9.h>
 #include "EngineConstant.h"
+#include <vector>
+#include "BitmapFontManager.h"
+#include "DrawCommandList.h"
+#include "FileSystem.h"
+#include "FrameAllocator.h"
+#include "FrameStats.h"
+#include "GlyphAtlas.h"
+#include "ParticleEmitter.h"
+#include "RenderBackend.h"
+#include "TextLayoutCache.h"
+#include "TextureCache.h"
+#include "Tilemap.h"
+#include "../Common/Matrix2D.h"
 #include "../Common/Vec.h"
 #include "../Common/Size.h"
 
+const int MaxBatchVertexCount = 6 * 2048;	//!< 1回の描画命令でまとめて描画できる頂点数
+const int MaxTransformStackDepth = 32;		//!< 座標変換スタックに積める変換の数
+const int MaxTriangleFanVertexCount = 256;	//!< 1回で追加できるトライアングルファンの頂点数
+
+/** @brief 2Dカメラ */
+struct Camera2D
+{
+	Vec2 Position;		//!< 画面の中心に表示するワールド座標
+	float Zoom;			//!< 拡大率
+	float Angle;		//!< 回転角度(度数法)
+};
+
 /** @brief 描画クラス */
 class Graphics
 {
 public:
+	/** Constructor */
+	Graphics() :
+		m_Backend(nullptr),
+		m_CurrentPivot(PivotType::LeftTop),
+		m_CurrentTexture(nullptr),
+		m_CurrentFilter(TextureFilterPoint),
+		m_IsVertexFormatBound(false),
+		m_IsTextureBound(false),
+		m_IsFilterBound(false),
+		m_IsFrameStatsSuspended(false),
+		m_BatchVertexCount(0),
+		m_BatchTexture(nullptr),
+		m_BatchFilter(TextureFilterPoint),
+		m_TextureFilter(TextureFilterPoint),
+		m_IsMipmapGeneration(false),
+		m_Camera(),
+		m_TransformStack(),
+		m_TransformStackDepth(0),
+		m_ViewTransform(),
+		m_IsViewTransformIdentity(true),
+		m_IsTransformEnabled(true),
+		m_ViewportWidth(0.0f),
+		m_ViewportHeight(0.0f),
+		m_GlyphAtlas(),
+		m_TextLayoutCache(),
+		m_TextureCache(),
+		m_FileSystem(nullptr),
+		m_DeferredCommandList(),
+		m_FrameAllocator(),
+		m_IsDeferredDrawing(false),
+		m_IsSubmittingDeferred(false),
+		m_DrawLayer(0)
+	{
+	}
+
 	/**
 	* @brief Graphics機能初期化関数
 	* @details 描画を使用するための初期化を行う
 	* @retval true 初期化成功
 	* @retval false 初期化失敗
+	* @param[in] width バックバッファの横幅
+	* @param[in] height バックバッファの縦幅
 	* @param[in] is_window_mode ウィンドウ or Fullスクリーン設定フラグ
+	* @param[in] backend_type 使用する描画バックエンドの種類
+	* @param[in] file_system テクスチャの読み込み元の仮想ファイルシステム(nullptrの場合はファイルから直接読み込む)(オプション)
 	*/
-	bool Initialize(bool is_window_mode);
+	bool Initialize(int width, int height, bool is_window_mode, RenderBackendType backend_type, const FileSystem* file_system = nullptr);
 
 	/**
 	* @brief Graphics機能終了関数
@@ -123,6 +187,185 @@ public:
 	*/
 	void DrawFont(float x, float y, const char* text, FontSize size, FontColor color);
 
+	/**
+	* @brief フォント描画関数 サイズ、色指定バージョン
+	* @details <pre>
+	* 指定された位置に任意のサイズ、色でフォントを描画する
+	* 文字はグリフアトラスの矩形としてバッチに追加されるので、
+	* 続けて描画した文字列は1回の描画命令にまとめられる
+	* 文字列のレイアウトはキャッシュされ、同じ文字列の2回目以降の描画は頂点のコピーだけで行われる
+	* </pre>
+	* @param[in] x X軸描画座標
+	* @param[in] y Y軸描画座標
+	* @param[in] text 描画するテキスト(改行対応)
+	* @param[in] font_size フォントサイズ(ピクセル)
+	* @param[in] color フォントの色(ARGB形式)
+	* @param[in] wrap_width 折り返す横幅(ピクセル、0の場合は折り返さない)
+	*/
+	void DrawFontEx(float x, float y, const char* text, int font_size, DWORD color, int wrap_width = 0);
+
+	/**
+	* @brief ビットマップフォント描画関数
+	* @details <pre>
+	* 読み込み済みのビットマップフォントで文字列を描画する
+	* 文字はページのテクスチャの矩形としてバッチに追加され、描画中にメモリ確保は行わない
+	* </pre>
+	* @param[in] x X軸描画座標
+	* @param[in] y Y軸描画座標
+	* @param[in] font_data 描画に使用するフォント
+	* @param[in] text 描画するテキスト(UTF-8、改行対応)
+	* @param[in] color フォントの色(ARGB形式)
+	* @param[in] scale 拡大率
+	*/
+	void DrawBitmapFont(float x, float y, const BitmapFontData* font_data, const char* text, DWORD color, float scale);
+
+	/**
+	* @brief タイルマップ描画関数
+	* @details <pre>
+	* 作り直しが必要なチャンクの頂点を作成してから、画面に表示される範囲のチャンクだけを描画する
+	* 表示範囲はカメラと座標変換の逆変換で求めるので、画面外のチャンクは頂点の変換も行わない
+	* </pre>
+	* @param[in] tilemap 描画するタイルマップ
+	*/
+	void DrawTilemap(Tilemap* tilemap);
+
+	/**
+	* @brief パーティクル描画関数
+	* @details <pre>
+	* パーティクルの頂点を一時バッファを経由せずにバッチの領域へ直接書き込む
+	* テクスチャはエミッターの設定のキーワードで取得する
+	* </pre>
+	* @param[in] emitter 描画するエミッター
+	*/
+	void DrawParticles(const ParticleEmitter* emitter);
+
+	/**
+	* @brief 三角形リスト描画関数
+	* @details <pre>
+	* 変換済みの頂点データ(三角形リスト)をバッチに追加する
+	* 同じテクスチャを使用する描画はFlushBatchが実行されるまで1回の描画命令にまとめられる
+	* </pre>
+	* @param[in] texture 使用するテクスチャ(テクスチャなしの場合はnullptr)
+	* @param[in] vertices 頂点データ
+	* @param[in] vertex_count 頂点数(3の倍数)
+	*/
+	void DrawTriangles(const Texture* texture, const CustomVertex* vertices, int vertex_count);
+
+	/**
+	* @brief 記録済み命令リストの描画関数
+	* @details <pre>
+	* ワーカースレッドで記録した命令を記録順にバッチに追加する
+	* 遅延描画が有効な場合は命令ごとのレイヤーで記録され、FinishDrawで並び替えられる
+	* カメラと座標変換はこの関数を実行した時点のものが適用される
+	* </pre>
+	* @param[in] command_list 命令リスト
+	*/
+	void SubmitCommandList(const DrawCommandList& command_list);
+
+	/**
+	* @brief バッチ描画関数
+	* @details バッチに溜まっている頂点データをデバイスに送信して描画する
+	*/
+	void FlushBatch();
+
+	/**
+	* @brief 描画統計の一時停止関数
+	* @details <pre>
+	* ResumeFrameStatsを実行するまでの描画を描画統計に含めないようにする
+	* デバッグ表示など計測対象外の描画に使用する
+	* </pre>
+	*/
+	void SuspendFrameStats();
+
+	/**
+	* @brief 描画統計の再開関数
+	* @details SuspendFrameStatsで一時停止した描画統計を再開する
+	*/
+	void ResumeFrameStats();
+
+	/**
+	* @brief 遅延描画の有効設定関数
+	* @details <pre>
+	* trueの場合は描画を命令として記録し、FinishDrawでレイヤー、重なり、テクスチャの順に並び替えてから描画する
+	* 同じレイヤーで重なる描画は呼び出し順のまま、重ならない描画はテクスチャごとにまとめられる
+	* falseにした場合は記録済みの命令をその時点で描画する
+	* </pre>
+	* @param[in] is_enabled 有効にする場合はtrue
+	*/
+	void SetDeferredDrawing(bool is_enabled);
+
+	/**
+	* @brief 遅延描画の有効判定関数
+	* @retval true 有効
+	* @retval false 無効
+	*/
+	bool IsDeferredDrawing() const
+	{
+		return m_IsDeferredDrawing;
+	}
+
+	/**
+	* @brief 描画レイヤー設定関数
+	* @details <pre>
+	* 遅延描画で以降の描画に使用するレイヤーを設定する
+	* 番号が大きいレイヤーほど手前に描画される
+	* </pre>
+	* @param[in] layer 描画レイヤー(0～DrawLayerCount-1、範囲外は丸める)
+	*/
+	void SetDrawLayer(int layer);
+
+	/**
+	* @brief 描画レイヤーの取得関数
+	* @retval int 描画レイヤー
+	*/
+	int GetDrawLayer() const
+	{
+		return m_DrawLayer;
+	}
+
+	/**
+	* @brief テクスチャのフィルタリング設定関数
+	* @details <pre>
+	* 以降の描画で使用するフィルタリングを設定する
+	* フィルタリングが異なる描画は同じテクスチャでもバッチが分かれる
+	* 遅延描画では命令ごとに記録され、並び替え後も記録した時のフィルタリングで描画される
+	* </pre>
+	* @param[in] filter フィルタリング
+	*/
+	void SetTextureFilter(TextureFilter filter);
+
+	/**
+	* @brief テクスチャのフィルタリングの取得関数
+	* @retval TextureFilter フィルタリング
+	*/
+	TextureFilter GetTextureFilter() const
+	{
+		return m_TextureFilter;
+	}
+
+	/**
+	* @brief ミップマップ作成の有効設定関数
+	* @details <pre>
+	* trueの場合は以降に作成するテクスチャにMipmapGeneratorで縮小したミップマップを作成する
+	* 画像はデコードしたテクセルから作成するので、デコードに対応していない描画バックエンドではミップマップを作成しない
+	* </pre>
+	* @param[in] is_enabled 有効にする場合はtrue
+	*/
+	void SetMipmapGeneration(bool is_enabled)
+	{
+		m_IsMipmapGeneration = is_enabled;
+	}
+
+	/**
+	* @brief ミップマップ作成の有効判定関数
+	* @retval true 有効
+	* @retval false 無効
+	*/
+	bool IsMipmapGeneration() const
+	{
+		return m_IsMipmapGeneration;
+	}
+
 	/**
 	* @brief 描画用矩形の軸設定関数
 	* @details 指定された軸の値をm_CurrentPivotに設定する
@@ -130,6 +373,80 @@ public:
 	*/
 	void SetPivotType(PivotType pivot_type);
 
+	/**
+	* @brief カメラ設定関数
+	* @details <pre>
+	* 以降の描画はワールド座標として扱われ、カメラの変換を行ってから画面に描画される
+	* 変換は頂点の作成時にまとめて行うので、描画する側で座標をずらす必要はない
+	* </pre>
+	* @param[in] x 画面の中心に表示するワールド座標X
+	* @param[in] y 画面の中心に表示するワールド座標Y
+	* @param[in] zoom 拡大率
+	* @param[in] angle 回転角度(度数法)
+	*/
+	void SetCamera(float x, float y, float zoom, float angle);
+
+	/**
+	* @brief カメラ初期化関数
+	* @details ワールド座標と画面座標が一致する状態に戻す
+	*/
+	void ResetCamera();
+
+	/**
+	* @brief カメラの取得関数
+	* @retval const Camera2D& カメラ
+	*/
+	const Camera2D& GetCamera() const
+	{
+		return m_Camera;
+	}
+
+	/**
+	* @brief 座標変換の追加関数
+	* @details <pre>
+	* 現在の変換に拡縮、回転、移動を追加してスタックに積む
+	* 以降の描画の座標は追加した変換のローカル座標として扱われる
+	* </pre>
+	* @retval true 追加成功
+	* @retval false スタックがMaxTransformStackDepthを超えた
+	* @param[in] transform 追加する変換
+	*/
+	bool PushTransform(const Matrix2D& transform);
+
+	/**
+	* @brief 座標変換の削除関数
+	* @details 最後にPushTransformで追加した変換を取り除く
+	*/
+	void PopTransform();
+
+	/**
+	* @brief 座標変換の有効設定関数
+	* @details <pre>
+	* falseの場合はカメラと変換スタックを無視して画面座標で描画する
+	* UIやデバッグ表示の描画に使用する
+	* </pre>
+	* @param[in] is_enabled 有効にする場合はtrue
+	*/
+	void SetTransformEnabled(bool is_enabled);
+
+	/**
+	* @brief 座標変換の有効判定関数
+	* @retval true 有効
+	* @retval false 無効
+	*/
+	bool IsTransformEnabled() const
+	{
+		return m_IsTransformEnabled;
+	}
+
+	/**
+	* @brief 画面座標からワールド座標への変換関数
+	* @details カメラの逆変換を行う(変換スタックは含まない)
+	* @retval Vec2 ワールド座標
+	* @param[in] screen_pos 画面座標
+	*/
+	Vec2 ConvertScreenToWorld(const Vec2& screen_pos) const;
+
 	/**
 	* @brief テクスチャ作成関数
 	* @details 指定された情報から読み込み、テクスチャを作成する
@@ -137,47 +454,92 @@ public:
 	* @retval false 作成失敗
 	* @param[in] file_name 読み込むテクスチャの名前(パス込み)
 	* @param[out] texture_data 読み込まれたテクスチャを反映するデータ
+	* @param[out] out_hash ファイルの内容の識別情報(ファイルの内容を読み込まなかった場合はIsValidがfalse、不要な場合はnullptr)(オプション)
 	*/
-	bool CreateTexture(const char* file_name, Texture* texture_data);
+	bool CreateTexture(const char* file_name, Texture* texture_data, FileContentHash* out_hash = nullptr);
 
-private:
 	/**
-	* @brief Graphicsインタフェース作成関数
-	* @details DirectGraphicsのインターフェースを作成する
-	* @retval true 作成成功
-	* @retval false 作成失敗
+	* @brief 画像ファイルのデコード関数
+	* @details <pre>
+	* 画像ファイルをCreateTextureと同じカラーキーを適用したテクセルにデコードする
+	* テクスチャキャッシュが有効な場合はキャッシュから読み込み、ない場合はデコードして保存する
+	* マウントしたアーカイブにあるファイルはアーカイブから読み込み、テクスチャキャッシュは使用しない
+	* デバイスに送らないので、ワーカースレッドから実行できる
+	* </pre>
+	* @retval true デコード成功
+	* @retval false デコード失敗(デコードに対応していない描画バックエンドを含む)
+	* @param[in] file_name 画像ファイル名(パス込み)
+	* @param[out] out_width 横幅
+	* @param[out] out_height 縦幅
+	* @param[out] out_pixels テクセル(A8R8G8B8、1行の要素数はout_width)
+	* @param[out] out_hash ファイルの内容の識別情報(キャッシュから読み込んだ場合はキャッシュに保存した値、不要な場合はnullptr)(オプション)
 	*/
-	bool CreateInterface();
+	bool DecodeTexture(const char* file_name, int* out_width, int* out_height, std::vector<DWORD>* out_pixels, FileContentHash* out_hash = nullptr);
 
 	/**
-	* @brief Graphicsdデバイス作成関数
-	* @details DirectGraphicsのデバイスを作成する
+	* @brief テクセルからのテクスチャ作成関数
+	* @details ミップマップ作成が有効な場合はミップマップも作成する
 	* @retval true 作成成功
 	* @retval false 作成失敗
-	* @param[in] present_param デバイス設定に使用するプレゼントパラメータ
-	* @param[in] is_window_mode ウィンドウモード
+	* @param[in] width 横幅
+	* @param[in] height 縦幅
+	* @param[in] pixels テクセル(A8R8G8B8、1行の要素数はwidth)
+	* @param[out] texture_data 作成したテクスチャを反映するデータ
 	*/
-	bool CreateDevice(D3DPRESENT_PARAMETERS* present_param, bool is_window_mode);
+	bool CreateTextureFromPixels(int width, int height, const DWORD* pixels, Texture* texture_data);
 
 	/**
-	* @brief ビューポート設定関数
-	* @retval true 作成成功
-	* @retval false 作成失敗
-	* @param[in] present_param バッファサイズを保持するデータ
+	* @brief テクスチャキャッシュの有効化関数
+	* @details <pre>
+	* 以降のCreateTextureでデコードしたテクセルを指定したフォルダに保存し、次回からは保存したテクセルを読み込む
+	* 画像のデコードができない描画バックエンドではキャッシュを使用しない
+	* </pre>
+	* @retval true 有効化成功
+	* @retval false 有効化失敗(フォルダを作成できなかった)
+	* @param[in] directory キャッシュファイルを保存するフォルダ
 	*/
-	bool SetUpViewPort(D3DPRESENT_PARAMETERS* present_param);
+	bool EnableTextureCache(const char* directory);
 
 	/**
-	* @brief フォントデバイス作成関数
-	* @details DirectFontのデバイスを作成する
-	* @retval true 作成成功
-	* @retval false 作成失敗
+	* @brief テクスチャキャッシュの使用状況の取得関数
+	* @retval TextureCacheStats 使用状況
+	*/
+	TextureCacheStats GetTextureCacheStats() const
+	{
+		return m_TextureCache.GetStats();
+	}
+
+	/**
+	* @brief 描画統計の取得関数
+	* @details 直前に描画が終了したフレームの描画統計を返す
+	* @retval const FrameStats& 描画統計
 	*/
-	bool CreateFontDevice();
+	const FrameStats& GetFrameStats() const
+	{
+		return m_LastFrameStats;
+	}
+
+	/**
+	* @brief 描画統計履歴の取得関数
+	* @retval const FrameStatsHistory& 直近のフレームの描画統計履歴
+	*/
+	const FrameStatsHistory& GetFrameStatsHistory() const
+	{
+		return m_FrameStatsHistory;
+	}
+
+	/**
+	* @brief 描画バックエンドの取得関数
+	* @retval RenderBackend* 使用中の描画バックエンド
+	*/
+	RenderBackend* GetBackend()
+	{
+		return m_Backend;
+	}
 
 	/**
 	* @brief 矩形変換関数
-	* @details 引数の矩形に対し、移動、回転、拡大を行う
+	* @details 引数の矩形に対し、移動、回転、拡大を行う(DrawCommandRecorderでも使用する)
 	* @param[out] vertices 変換対象の矩形
 	* @param[in] pos_x 移動座標(X軸)
 	* @param[in] pos_y 移動座標(Y軸)
@@ -185,20 +547,216 @@ private:
 	* @param[in] scale_x 拡縮率(X軸)
 	* @param[in] scale_y 拡縮率(Y軸)
 	*/
-	void TransformRect(CustomVertex* vertices, float pos_x, float pos_y, float angle, float scale_x, float scale_y);
+	static void TransformRect(CustomVertex* vertices, float pos_x, float pos_y, float angle, float scale_x, float scale_y);
 
 	/**
 	* @brief オフセット値計算関数
-	* @details m_CurrentPivotに設定されている値を参考にして軸のオフセット値を計算して返す
+	* @details 軸の値を参考にして軸のオフセット値を計算して返す(DrawCommandRecorderでも使用する)
 	* @retval オフセット値
+	* @param[in] pivot_type 軸
 	* @param[in] rect_size オフセット値の参考に使う矩形のサイズ
 	*/
-	Vec2 CalculatePivotOffset(Size* rect_size);
+	static Vec2 CalculatePivotOffset(PivotType pivot_type, const Size* rect_size);
+
+private:
+	/**
+	* @brief 描画バックエンド作成関数
+	* @retval RenderBackend* 作成したバックエンド(不明な種類の場合はnullptr)
+	* @param[in] backend_type 作成するバックエンドの種類
+	*/
+	RenderBackend* CreateBackend(RenderBackendType backend_type);
+
+	/**
+	* @brief 画像ファイルのデコードと保存関数
+	* @details <pre>
+	* ファイルを1度だけ読み込み、内容のハッシュ値を計算してから描画バックエンドでデコードする
+	* テクスチャキャッシュが有効な場合はハッシュ値と共に保存する
+	* </pre>
+	* @retval true デコード成功
+	* @retval false デコード失敗(デコードに対応していない描画バックエンドを含む)
+	* @param[in] file_name 画像ファイル名(パス込み)
+	* @param[out] out_width 横幅
+	* @param[out] out_height 縦幅
+	* @param[out] out_pixels テクセル(A8R8G8B8、カラーキー適用済み)
+	* @param[out] out_hash ファイルの内容の識別情報(不要な場合はnullptr)
+	*/
+	bool DecodeAndCacheTexture(const char* file_name, int* out_width, int* out_height, std::vector<DWORD>* out_pixels, FileContentHash* out_hash);
+
+	/**
+	* @brief カメラの変換行列の作成関数
+	* @retval Matrix2D ワールド座標から画面座標への変換行列
+	*/
+	Matrix2D CreateCameraMatrix() const;
+
+	/**
+	* @brief 描画用の変換行列の更新関数
+	* @details カメラ、変換スタック、有効設定が変更された時に実行する
+	*/
+	void UpdateViewTransform();
+
+	/**
+	* @brief 頂点変換関数
+	* @details <pre>
+	* 頂点に描画用の変換を行い、変換後の範囲が画面に重なるかを判定する
+	* 4頂点ずつSSEで変換する
+	* srcとdestは同じ配列でも良い
+	* </pre>
+	* @retval true 画面に重なる
+	* @retval false 完全に画面外
+	* @param[in] src 変換前の頂点データ
+	* @param[out] dest 変換後の頂点データ
+	* @param[in] vertex_count 頂点数
+	*/
+	bool TransformVertices(const CustomVertex* src, CustomVertex* dest, int vertex_count);
+
+	/**
+	* @brief 画面に表示されるワールド座標の範囲の計算関数
+	* @details 画面の4隅に描画用の変換の逆変換を行い、それを囲む矩形を求める
+	* @param[out] out_left 左端
+	* @param[out] out_top 上端
+	* @param[out] out_right 右端
+	* @param[out] out_bottom 下端
+	*/
+	void CalculateVisibleWorldRect(float* out_left, float* out_top, float* out_right, float* out_bottom) const;
+
+	/**
+	* @brief 円の画面外判定関数
+	* @details <pre>
+	* 描画用の変換を行った円が完全に画面外かを判定する
+	* 頂点を作成する前に実行し、画面外の場合は描画統計の除外数を増やす
+	* </pre>
+	* @retval true 画面外(描画しない)
+	* @retval false 画面に重なる可能性がある
+	* @param[in] x 中心座標X
+	* @param[in] y 中心座標Y
+	* @param[in] radius 半径
+	*/
+	bool CullBoundingCircle(float x, float y, float radius);
+
+	/**
+	* @brief 矩形の画面外判定関数
+	* @details 回転を含めた矩形を囲む円でCullBoundingCircleを実行する
+	* @retval true 画面外(描画しない)
+	* @retval false 画面に重なる可能性がある
+	* @param[in] x 描画座標X(回転、拡縮の中心)
+	* @param[in] y 描画座標Y(回転、拡縮の中心)
+	* @param[in] size 矩形のサイズ
+	* @param[in] offset 軸のオフセット値
+	* @param[in] scale_x 拡縮率(X軸)
+	* @param[in] scale_y 拡縮率(Y軸)
+	*/
+	bool CullRect(float x, float y, const Size& size, const Vec2& offset, float scale_x, float scale_y);
+
+	/**
+	* @brief 頂点構造設定関数
+	* @details 頂点構造が設定済みでない場合のみデバイスに設定する
+	*/
+	void BindVertexFormat();
+
+	/**
+	* @brief テクスチャ設定関数
+	* @details 設定済みのテクスチャと異なる場合のみデバイスに設定する
+	* @param[in] texture 設定するテクスチャ(テクスチャなしの場合はnullptr)
+	*/
+	void BindTexture(const Texture* texture);
+
+	/**
+	* @brief テクスチャのフィルタリング設定関数
+	* @details 設定済みのフィルタリングと異なる場合のみデバイスに設定する
+	* @param[in] filter 設定するフィルタリング
+	*/
+	void BindTextureFilter(TextureFilter filter);
+
+	/**
+	* @brief プリミティブ描画関数
+	* @details 三角形リストの頂点データを描画し、描画統計を更新する
+	* @param[in] vertices 頂点データ
+	* @param[in] vertex_count 頂点数
+	*/
+	void DrawPrimitive(const CustomVertex* vertices, int vertex_count);
+
+	/**
+	* @brief デバイスステートのキャッシュ破棄関数
+	* @details <pre>
+	* 設定済みとして記録しているステートを破棄し、次回の設定を必ずデバイスに反映させる
+	* フォント描画などGraphics以外がデバイスのステートを変更した後に実行する
+	* </pre>
+	*/
+	void InvalidateStateCache();
+
+	/**
+	* @brief 矩形追加関数
+	* @details トライアングルファン形式の矩形を三角形リストに変換してバッチに追加する
+	* @param[in] texture 使用するテクスチャ
+	* @param[in] vertices 矩形の頂点データ(4頂点)
+	*/
+	void AddQuad(const Texture* texture, const CustomVertex* vertices);
+
+	/**
+	* @brief トライアングルファン追加関数
+	* @details <pre>
+	* トライアングルファンを三角形リストに変換してバッチに追加する
+	* 頂点数はMaxTriangleFanVertexCount以下にする
+	* </pre>
+	* @param[in] texture 使用するテクスチャ
+	* @param[in] vertices ファンの頂点データ
+	* @param[in] vertex_count 頂点数
+	*/
+	void AddTriangleFan(const Texture* texture, const CustomVertex* vertices, int vertex_count);
+
+	/**
+	* @brief バッチ準備関数
+	* @details <pre>
+	* テクスチャやフィルタリングが異なる場合や容量が足りない場合はバッチを描画し、
+	* 指定された頂点数を書き込める位置を返す
+	* </pre>
+	* @retval CustomVertex* 頂点の書き込み先
+	* @param[in] texture 使用するテクスチャ
+	* @param[in] vertex_count 書き込む頂点数(MaxBatchVertexCount以下)
+	*/
+	CustomVertex* ReserveBatch(const Texture* texture, int vertex_count);
+
+	/**
+	* @brief 遅延描画命令の送信関数
+	* @details 記録した命令を並び替えてバッチに追加し、リストを空にする
+	*/
+	void SubmitDeferredCommands();
 private:
-	LPDIRECT3D9 m_D3DInterface;						//!< DirectGraphicsインターフェース
-	LPDIRECT3DDEVICE9 m_D3DDevice;					//!< DirectGraphicsデバイス
-	LPD3DXFONT m_FontList[FontSize::FontSizeMax];	//!< フォントデバイスリスト
+	RenderBackend* m_Backend;						//!< 描画バックエンド
 	PivotType m_CurrentPivot;						//!< 描画用矩形の軸
+	const Texture* m_CurrentTexture;				//!< デバイスに設定済みのテクスチャ
+	TextureFilter m_CurrentFilter;					//!< デバイスに設定済みのフィルタリング
+	bool m_IsVertexFormatBound;						//!< 頂点構造の設定済みフラグ
+	bool m_IsTextureBound;							//!< テクスチャの設定済みフラグ
+	bool m_IsFilterBound;							//!< フィルタリングの設定済みフラグ
+	FrameStats m_FrameStats;						//!< 描画中フレームの描画統計
+	FrameStats m_LastFrameStats;					//!< 直前のフレームの描画統計
+	FrameStatsHistory m_FrameStatsHistory;			//!< 描画統計の履歴
+	FrameStats m_SuspendedFrameStats;				//!< 一時停止時点の描画統計
+	bool m_IsFrameStatsSuspended;					//!< 描画統計の一時停止フラグ
+	CustomVertex m_BatchVertices[MaxBatchVertexCount];	//!< バッチの頂点データ
+	int m_BatchVertexCount;							//!< バッチの頂点数
+	const Texture* m_BatchTexture;					//!< バッチで使用するテクスチャ
+	TextureFilter m_BatchFilter;					//!< バッチで使用するフィルタリング
+	TextureFilter m_TextureFilter;					//!< 以降の描画で使用するフィルタリング
+	bool m_IsMipmapGeneration;						//!< ミップマップ作成の有効フラグ
+	Camera2D m_Camera;								//!< カメラ
+	Matrix2D m_TransformStack[MaxTransformStackDepth + 1];	//!< 座標変換スタック(0番目は単位行列)
+	int m_TransformStackDepth;						//!< 座標変換スタックに積まれている変換の数
+	Matrix2D m_ViewTransform;						//!< 描画時に頂点に行う変換(変換スタックとカメラを合成したもの)
+	bool m_IsViewTransformIdentity;					//!< m_ViewTransformが単位行列か
+	bool m_IsTransformEnabled;						//!< 座標変換の有効フラグ
+	float m_ViewportWidth;							//!< ビューポートの横幅
+	float m_ViewportHeight;							//!< ビューポートの縦幅
+	GlyphAtlas m_GlyphAtlas;						//!< フォント描画用のグリフアトラス
+	TextLayoutCache m_TextLayoutCache;				//!< フォント描画用の文字列レイアウトキャッシュ
+	TextureCache m_TextureCache;					//!< デコード済みのテクセルのキャッシュ
+	const FileSystem* m_FileSystem;					//!< テクスチャの読み込み元の仮想ファイルシステム
+	DrawCommandList m_DeferredCommandList;			//!< 遅延描画の命令リスト
+	FrameAllocator m_FrameAllocator;				//!< 描画中の作業領域(描画スレッドでも使用するので、Engineのものとは別に持つ)
+	bool m_IsDeferredDrawing;						//!< 遅延描画の有効フラグ
+	bool m_IsSubmittingDeferred;					//!< 遅延描画の命令を送信中か
+	int m_DrawLayer;								//!< 遅延描画で使用する描画レイヤー
 };
 
 #endif
@@ -4,6 +4,7 @@
 #include <D3dx9math.h>
 #include "Window.h"
 #include "Input.h"
+#include "Profiler.h"
 
 #pragma comment(lib, "dinput8.lib")
 #pragma comment(lib, "dxguid.lib")
@@ -53,6 +54,8 @@ void Input::Release()
 
 void Input::Update()
 {
+	PROFILE_FUNCTION();
+
 	m_Keyboard.Update();
 	m_Mouse.Update();
 	m_GamePad.Update();
@@ -0,0 +1,427 @@
+﻿#include <algorithm>
+#include "JobSystem.h"
+
+namespace
+{
+	const int JobSpinCount = 64;	//!< 待機する前にジョブを探し直す回数
+
+	thread_local const JobSystem* t_JobSystem = nullptr;	//!< このスレッドが登録されているジョブシステム
+	thread_local int t_WorkerIndex = -1;					//!< このスレッドのワーカー番号
+}
+
+void JobCounter::Add(int count)
+{
+	m_Count.fetch_add(count, std::memory_order_acq_rel);
+}
+
+void JobCounter::Decrement(std::vector<Job*>* out_job_list)
+{
+	// 0にした後も依存ジョブのリストを操作するので、操作が終わるまでIsDoneがtrueにならないようにする
+	// (待機していたスレッドが戻った直後にカウンターを破棄しても安全になる)
+	m_DecrementingCount.fetch_add(1, std::memory_order_acq_rel);
+
+	if (m_Count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		out_job_list->insert(out_job_list->end(), m_WaitingJobList.begin(), m_WaitingJobList.end());
+		m_WaitingJobList.clear();
+	}
+
+	m_DecrementingCount.fetch_sub(1, std::memory_order_release);
+}
+
+bool JobCounter::AddWaitingJob(Job* job)
+{
+	// 0になったスレッドがリストを取り出す前後のどちらでも取りこぼさないように、判定と追加をロック内で行う
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_Count.load(std::memory_order_acquire) == 0)
+	{
+		return false;
+	}
+
+	m_WaitingJobList.push_back(job);
+
+	return true;
+}
+
+bool JobQueue::Push(Job* job)
+{
+	long long bottom = m_Bottom.load(std::memory_order_relaxed);
+	long long top = m_Top.load(std::memory_order_acquire);
+	if (bottom - top >= JobQueueCapacity)
+	{
+		return false;
+	}
+
+	m_Slots[bottom & (JobQueueCapacity - 1)].store(job, std::memory_order_relaxed);
+
+	// ジョブの書き込みが完了してから位置を公開する
+	m_Bottom.store(bottom + 1, std::memory_order_release);
+
+	return true;
+}
+
+bool JobQueue::Pop(Job** out_job)
+{
+	// 先に末尾を縮めてから先頭を読み、Stealと同じジョブを取り合っていないかを確認する
+	long long bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+	m_Bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long long top = m_Top.load(std::memory_order_relaxed);
+
+	if (top > bottom)
+	{
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		return false;
+	}
+
+	Job* job = m_Slots[bottom & (JobQueueCapacity - 1)].load(std::memory_order_relaxed);
+
+	if (top == bottom)
+	{
+		// 最後の1つはStealと同じ方法で先頭を進めて取り合う
+		bool is_taken = m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		if (is_taken == false)
+		{
+			return false;
+		}
+	}
+
+	*out_job = job;
+
+	return true;
+}
+
+bool JobQueue::Steal(Job** out_job)
+{
+	long long top = m_Top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long long bottom = m_Bottom.load(std::memory_order_acquire);
+
+	if (top >= bottom)
+	{
+		return false;
+	}
+
+	Job* job = m_Slots[top & (JobQueueCapacity - 1)].load(std::memory_order_relaxed);
+	if (m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed) == false)
+	{
+		return false;
+	}
+
+	*out_job = job;
+
+	return true;
+}
+
+bool JobSystem::Initialize(int thread_count)
+{
+	Release();
+
+	if (thread_count < 0)
+	{
+		thread_count = (int)std::thread::hardware_concurrency() - 1;
+	}
+	thread_count = (std::min)((std::max)(thread_count, 0), MaxJobWorkers);
+
+	m_WakeSemaphore = CreateSemaphore(nullptr, 0, MaxJobWorkers, nullptr);
+	if (m_WakeSemaphore == nullptr)
+	{
+		return false;
+	}
+
+	m_IsStopRequested = false;
+	m_SleepingCount = 0;
+	m_IsPoolFullReported = false;
+
+	for (int i = 0; i <= thread_count; i++)
+	{
+		JobWorker* worker = new JobWorker();
+		worker->RandomState = 0x9E3779B9u * (i + 1);
+		m_WorkerList.push_back(worker);
+	}
+
+	t_JobSystem = this;
+	t_WorkerIndex = 0;
+
+	// ワーカーのリストが揃ってからスレッドを開始する(盗む相手としてリスト全体を参照するため)
+	for (int i = 1; i <= thread_count; i++)
+	{
+		m_WorkerList[i]->Thread = std::thread(&JobSystem::WorkerMain, this, i);
+	}
+
+	return true;
+}
+
+void JobSystem::Release()
+{
+	m_IsStopRequested = true;
+
+	if (m_WakeSemaphore != nullptr && m_WorkerList.size() > 1)
+	{
+		ReleaseSemaphore(m_WakeSemaphore, (LONG)m_WorkerList.size() - 1, nullptr);
+	}
+
+	// 他のワーカーが盗みに来る可能性があるので、全てのスレッドが終了してから破棄する
+	for (JobWorker* worker : m_WorkerList)
+	{
+		if (worker->Thread.joinable() == true)
+		{
+			worker->Thread.join();
+		}
+	}
+
+	for (JobWorker* worker : m_WorkerList)
+	{
+		delete worker;
+	}
+	m_WorkerList.clear();
+
+	if (m_WakeSemaphore != nullptr)
+	{
+		CloseHandle(m_WakeSemaphore);
+		m_WakeSemaphore = nullptr;
+	}
+
+	if (t_JobSystem == this)
+	{
+		t_JobSystem = nullptr;
+		t_WorkerIndex = -1;
+	}
+}
+
+void JobSystem::Run(JobFunction function, void* data, JobCounter* counter, JobCounter* dependency)
+{
+	Submit(function, data, 0, 1, counter, dependency);
+}
+
+void JobSystem::ParallelFor(JobFunction function, void* data, int count, int grain_size)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	grain_size = (std::max)(grain_size, 1);
+
+	// 分割しても並列に実行できない場合はジョブを作らずにそのまま実行する
+	if (m_WorkerList.size() <= 1 || count <= grain_size || GetCurrentWorkerIndex() < 0)
+	{
+		function(data, 0, count);
+		return;
+	}
+
+	JobCounter counter;
+	for (int begin = 0; begin < count; begin += grain_size)
+	{
+		Submit(function, data, begin, (std::min)(begin + grain_size, count), &counter, nullptr);
+	}
+
+	Wait(&counter);
+}
+
+void JobSystem::Wait(JobCounter* counter)
+{
+	int worker_index = GetCurrentWorkerIndex();
+
+	while (counter->IsDone() == false)
+	{
+		if (worker_index >= 0 && ExecuteNext(worker_index) == true)
+		{
+			continue;
+		}
+
+		std::this_thread::yield();
+	}
+}
+
+int JobSystem::GetCurrentWorkerIndex() const
+{
+	return t_JobSystem == this ? t_WorkerIndex : -1;
+}
+
+void JobSystem::Submit(JobFunction function, void* data, int begin, int end, JobCounter* counter, JobCounter* dependency)
+{
+	if (counter != nullptr)
+	{
+		counter->Add(1);
+	}
+
+	int worker_index = GetCurrentWorkerIndex();
+	if (worker_index < 0)
+	{
+		// ジョブシステムのスレッドではない場合はキューを使用できないので、依存の完了を待ってその場で実行する
+		Job job = { function, data, begin, end, counter, nullptr };
+		while (dependency != nullptr && dependency->IsDone() == false)
+		{
+			std::this_thread::yield();
+		}
+		Execute(worker_index, &job);
+		return;
+	}
+
+	Job* job = AllocateJob(m_WorkerList[worker_index]);
+	if (job == nullptr)
+	{
+		if (m_IsPoolFullReported.exchange(true) == false)
+		{
+			OutputDebugString("JobSystem: job pool is full, running jobs inline\n");
+		}
+
+		// 記録領域を上書きしないように、依存の完了を待ってその場で実行する(待機中は他のジョブを実行して記録領域を空ける)
+		Job inline_job = { function, data, begin, end, counter, nullptr };
+		if (dependency != nullptr)
+		{
+			Wait(dependency);
+		}
+		Execute(worker_index, &inline_job);
+		return;
+	}
+
+	job->Function = function;
+	job->Data = data;
+	job->Begin = begin;
+	job->End = end;
+	job->Counter = counter;
+
+	if (dependency != nullptr && dependency->AddWaitingJob(job) == true)
+	{
+		return;
+	}
+
+	Enqueue(worker_index, job);
+}
+
+Job* JobSystem::AllocateJob(JobWorker* worker)
+{
+	// 使用中フラグを立てるのは持ち主だけなので、空きを見つけたらそのまま使用できる
+	for (int i = 0; i < JobPoolSize; i++)
+	{
+		unsigned int index = worker->NextJob++ & (JobPoolSize - 1);
+		if (worker->JobInUseList[index].load(std::memory_order_acquire) == false)
+		{
+			worker->JobInUseList[index].store(true, std::memory_order_relaxed);
+			Job* job = &worker->JobPool[index];
+			job->InUse = &worker->JobInUseList[index];
+			return job;
+		}
+	}
+
+	return nullptr;
+}
+
+void JobSystem::Enqueue(int worker_index, Job* job)
+{
+	if (worker_index < 0 || m_WorkerList[worker_index]->Queue.Push(job) == false)
+	{
+		Execute(worker_index, job);
+		return;
+	}
+
+	// 待機しようとしているワーカーがキューの確認を終えていても、セマフォで必ず起こせるように順序を保証する
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_SleepingCount.load(std::memory_order_relaxed) > 0)
+	{
+		ReleaseSemaphore(m_WakeSemaphore, 1, nullptr);
+	}
+}
+
+void JobSystem::Execute(int worker_index, Job* job)
+{
+	// 処理関数の中で追加したジョブが同じ記録領域を使用できるように、複製してから記録領域を空ける
+	Job executing_job = *job;
+	if (job->InUse != nullptr)
+	{
+		job->InUse->store(false, std::memory_order_release);
+	}
+
+	executing_job.Function(executing_job.Data, executing_job.Begin, executing_job.End);
+
+	if (executing_job.Counter == nullptr)
+	{
+		return;
+	}
+
+	std::vector<Job*> ready_job_list;
+	executing_job.Counter->Decrement(&ready_job_list);
+
+	for (Job* ready_job : ready_job_list)
+	{
+		Enqueue(worker_index, ready_job);
+	}
+}
+
+bool JobSystem::ExecuteNext(int worker_index)
+{
+	JobWorker* worker = m_WorkerList[worker_index];
+	Job* job = nullptr;
+
+	if (worker->Queue.Pop(&job) == true)
+	{
+		Execute(worker_index, job);
+		return true;
+	}
+
+	// 同じワーカーに盗みが集中しないように、探し始める相手を乱数で決める
+	unsigned int x = worker->RandomState;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	worker->RandomState = x;
+
+	int worker_count = (int)m_WorkerList.size();
+	int start = (int)(x % (unsigned int)worker_count);
+
+	for (int i = 0; i < worker_count; i++)
+	{
+		int victim = (start + i) % worker_count;
+		if (victim == worker_index)
+		{
+			continue;
+		}
+
+		if (m_WorkerList[victim]->Queue.Steal(&job) == true)
+		{
+			Execute(worker_index, job);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::WorkerMain(int worker_index)
+{
+	t_JobSystem = this;
+	t_WorkerIndex = worker_index;
+
+	int idle_count = 0;
+
+	while (m_IsStopRequested.load(std::memory_order_acquire) == false)
+	{
+		if (ExecuteNext(worker_index) == true)
+		{
+			idle_count = 0;
+			continue;
+		}
+
+		// すぐに次のジョブが追加されることが多いので、しばらくはスレッドを譲りながら探し直す
+		if (++idle_count < JobSpinCount)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		// 待機数を増やしてから探し直し、Enqueueとの間でジョブを取りこぼさないようにする
+		m_SleepingCount.fetch_add(1, std::memory_order_seq_cst);
+
+		if (ExecuteNext(worker_index) == false && m_IsStopRequested.load(std::memory_order_acquire) == false)
+		{
+			WaitForSingleObject(m_WakeSemaphore, INFINITE);
+		}
+
+		m_SleepingCount.fetch_sub(1, std::memory_order_seq_cst);
+		idle_count = 0;
+	}
+}
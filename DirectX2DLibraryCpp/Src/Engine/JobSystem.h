@@ -0,0 +1,327 @@
+﻿/**
+* @file JobSystem.h
+* @brief <pre>
+* 固定数のワーカースレッドでジョブを並列に実行するジョブシステムの宣言
+* ワーカーごとに両端キューを持ち、自分のキューが空になったワーカーは他のワーカーのキューからジョブを盗んで実行する
+* ジョブの追加と完了待ちはメインスレッド(Initializeを実行したスレッド)とワーカースレッドから行う
+* </pre>
+*/
+#ifndef JOB_SYSTEM_H_
+#define JOB_SYSTEM_H_
+
+#include <Windows.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "EngineConstant.h"
+
+const int MaxJobWorkers = 15;				//!< ワーカースレッドの最大数(メインスレッドを含まない)
+const int JobQueueCapacity = 4096;			//!< 1つのワーカーのキューに積めるジョブの最大数(2のべき乗)
+const int JobPoolSize = JobQueueCapacity * 2;	//!< 1つのワーカーが同時に使用できるジョブの最大数(キューに積んだジョブと依存待ちのジョブの合計)
+
+class JobCounter;
+
+/**
+* @brief ジョブの処理関数
+* @param[in] data ジョブに渡すデータ
+* @param[in] begin 処理する範囲の先頭
+* @param[in] end 処理する範囲の終端
+*/
+typedef void (*JobFunction)(void* data, int begin, int end);
+
+/** @brief ジョブ */
+struct Job
+{
+	JobFunction Function;		//!< 処理関数
+	void* Data;					//!< 処理関数に渡すデータ
+	int Begin;					//!< 処理する範囲の先頭
+	int End;					//!< 処理する範囲の終端
+	JobCounter* Counter;		//!< 完了時に減らすカウンター(nullptrの場合は使用しない)
+	std::atomic<bool>* InUse;	//!< 記録領域の使用中フラグ(記録領域を使用しない場合はnullptr)
+};
+
+/**
+* @brief ジョブカウンター
+* @details <pre>
+* 追加したジョブの数を数え、ジョブが完了するたびに1減らす
+* 0になったカウンターに依存しているジョブは、0にしたスレッドが実行待ちのキューに追加する
+* 使用中のカウンターは全てのジョブが完了するまで破棄しない
+* </pre>
+*/
+class JobCounter
+{
+public:
+	/** Constructor */
+	JobCounter() :
+		m_Count(0),
+		m_DecrementingCount(0),
+		m_Mutex(),
+		m_WaitingJobList()
+	{
+	}
+
+	/**
+	* @brief 完了判定関数
+	* @retval true 全てのジョブが完了している
+	* @retval false 実行中または実行待ちのジョブがある
+	*/
+	bool IsDone() const
+	{
+		return m_Count.load(std::memory_order_acquire) == 0 && m_DecrementingCount.load(std::memory_order_acquire) == 0;
+	}
+
+	/**
+	* @brief 加算関数
+	* @param[in] count 追加するジョブの数
+	*/
+	void Add(int count);
+
+	/**
+	* @brief 減算関数
+	* @details 0になった場合は依存していたジョブをout_job_listに移す
+	* @param[out] out_job_list 実行可能になったジョブ
+	*/
+	void Decrement(std::vector<Job*>* out_job_list);
+
+	/**
+	* @brief 依存ジョブの追加関数
+	* @retval true 追加成功(カウンターが0になった時に実行可能になる)
+	* @retval false 既に0になっている(すぐに実行できる)
+	* @param[in] job 依存しているジョブ
+	*/
+	bool AddWaitingJob(Job* job);
+
+private:
+	std::atomic<int> m_Count;				//!< 完了していないジョブの数
+	std::atomic<int> m_DecrementingCount;	//!< Decrementを実行中のスレッドの数
+	std::mutex m_Mutex;						//!< 依存ジョブのリストの排他制御
+	std::vector<Job*> m_WaitingJobList;		//!< 0になるのを待っているジョブ
+};
+
+/**
+* @brief ワーカーのジョブキュー
+* @details <pre>
+* 持ち主のワーカーだけが末尾でPushとPopを行い、他のワーカーは先頭からStealで取り出す固定長の両端キュー
+* 持ち主は後から積んだジョブを先に実行し(キャッシュに残っているデータを使う)、
+* 盗む側は古いジョブ(ParallelForの分割では大きな範囲の残り)を持っていく
+* </pre>
+*/
+class JobQueue
+{
+public:
+	/** Constructor */
+	JobQueue() :
+		m_Top(0),
+		m_TopPadding(),
+		m_Bottom(0),
+		m_BottomPadding(),
+		m_Slots()
+	{
+	}
+
+	/**
+	* @brief 追加関数(持ち主のワーカーのみ)
+	* @retval true 追加成功
+	* @retval false キューが一杯
+	* @param[in] job 追加するジョブ
+	*/
+	bool Push(Job* job);
+
+	/**
+	* @brief 末尾からの取り出し関数(持ち主のワーカーのみ)
+	* @retval true 取り出し成功
+	* @retval false キューが空
+	* @param[out] out_job 取り出したジョブ
+	*/
+	bool Pop(Job** out_job);
+
+	/**
+	* @brief 先頭からの取り出し関数(他のワーカー用)
+	* @retval true 取り出し成功
+	* @retval false キューが空、または他のスレッドと取り合って失敗した
+	* @param[out] out_job 取り出したジョブ
+	*/
+	bool Steal(Job** out_job);
+
+private:
+	std::atomic<long long> m_Top;						//!< 次に盗まれる位置
+	char m_TopPadding[CacheLineSize];				//!< m_Topとm_Bottomを別のキャッシュラインに置くための領域
+	std::atomic<long long> m_Bottom;					//!< 次に追加する位置(持ち主だけが更新する)
+	char m_BottomPadding[CacheLineSize];				//!< m_Bottomとジョブを別のキャッシュラインに置くための領域
+	std::atomic<Job*> m_Slots[JobQueueCapacity];		//!< ジョブのリングバッファ
+};
+
+/** @brief ワーカーの情報 */
+struct JobWorker
+{
+	/** Constructor */
+	JobWorker() :
+		Queue(),
+		JobPool(JobPoolSize),
+		JobInUseList(JobPoolSize),
+		NextJob(0),
+		RandomState(0),
+		Thread()
+	{
+	}
+
+	JobQueue Queue;					//!< ジョブキュー
+	std::vector<Job> JobPool;		//!< ジョブの記録領域
+	std::vector<std::atomic<bool>> JobInUseList;	//!< 記録領域ごとの使用中フラグ(持ち主が立て、実行を始めたワーカーが下ろす)
+	unsigned int NextJob;			//!< 次に空きを探し始める記録領域の位置
+	unsigned int RandomState;		//!< 盗む相手を選ぶための乱数の状態
+	std::thread Thread;				//!< スレッド(メインスレッドの場合は使用しない)
+};
+
+/**
+* @brief ジョブシステムクラス
+* @details <pre>
+* 番号0のワーカーはメインスレッドで、完了待ちの間だけジョブを実行する
+* 番号1以降のワーカーは専用のスレッドで、実行するジョブがない間はセマフォで待機する
+* ジョブの処理関数は他のジョブの追加と完了待ちを行ってもよい
+* </pre>
+*/
+class JobSystem
+{
+public:
+	/** Constructor */
+	JobSystem() :
+		m_WorkerList(),
+		m_WakeSemaphore(nullptr),
+		m_SleepingCount(0),
+		m_IsStopRequested(false),
+		m_IsPoolFullReported(false)
+	{
+	}
+
+	/**
+	* @brief 初期化関数
+	* @details 実行したスレッドをメインスレッドとして登録し、ワーカースレッドを作成する
+	* @retval true 初期化成功
+	* @retval false 初期化失敗(セマフォの作成に失敗)
+	* @param[in] thread_count ワーカースレッドの数(負の場合は論理コア数 - 1、0の場合はメインスレッドだけで実行する)
+	*/
+	bool Initialize(int thread_count);
+
+	/**
+	* @brief 解放関数
+	* @details 実行中のジョブが終わるのを待ってからワーカースレッドを終了する(キューに残っているジョブは実行しない)
+	*/
+	void Release();
+
+	/**
+	* @brief ジョブの追加関数
+	* @details <pre>
+	* 処理関数はbegin = 0、end = 1で呼ばれる
+	* dependencyを指定した場合は、dependencyのジョブが全て完了してから実行される
+	* </pre>
+	* @param[in] function 処理関数
+	* @param[in] data 処理関数に渡すデータ
+	* @param[in] counter 完了を待つためのカウンター(nullptrの場合は使用しない)
+	* @param[in] dependency 先に完了している必要があるジョブのカウンター(nullptrの場合は依存しない)
+	*/
+	void Run(JobFunction function, void* data, JobCounter* counter, JobCounter* dependency);
+
+	/**
+	* @brief 並列ループ関数
+	* @details <pre>
+	* 0～countの範囲をgrain_sizeごとに分割して並列に実行し、全ての範囲が完了するまで待機する
+	* 待機中はこの関数を実行したスレッドもジョブを実行する
+	* </pre>
+	* @param[in] function 処理関数(分割した範囲で呼ばれる)
+	* @param[in] data 処理関数に渡すデータ
+	* @param[in] count 範囲の要素数
+	* @param[in] grain_size 1つのジョブで処理する要素数
+	*/
+	void ParallelFor(JobFunction function, void* data, int count, int grain_size);
+
+	/**
+	* @brief 完了待ち関数
+	* @details 待機中はこの関数を実行したスレッドもジョブを実行する
+	* @param[in] counter 待機するカウンター
+	*/
+	void Wait(JobCounter* counter);
+
+	/**
+	* @brief ワーカー数の取得関数
+	* @retval int メインスレッドを含めたワーカーの数
+	*/
+	int GetWorkerCount() const
+	{
+		return (int)m_WorkerList.size();
+	}
+
+	/**
+	* @brief 現在のワーカー番号の取得関数
+	* @details ジョブの中でスレッドごとのデータ(ParallelDrawRecorderのレコーダーなど)を選ぶために使用する
+	* @retval int ワーカー番号(0はメインスレッド、ジョブシステムのスレッドではない場合は-1)
+	*/
+	int GetCurrentWorkerIndex() const;
+
+private:
+	/**
+	* @brief ジョブの追加関数
+	* @param[in] function 処理関数
+	* @param[in] data 処理関数に渡すデータ
+	* @param[in] begin 処理する範囲の先頭
+	* @param[in] end 処理する範囲の終端
+	* @param[in] counter 完了を待つためのカウンター
+	* @param[in] dependency 先に完了している必要があるジョブのカウンター
+	*/
+	void Submit(JobFunction function, void* data, int begin, int end, JobCounter* counter, JobCounter* dependency);
+
+	/**
+	* @brief ジョブの記録領域の確保関数
+	* @details <pre>
+	* 前回確保した位置から空いている記録領域を探し、使用中にして返す
+	* キューに積んだジョブや依存待ちのジョブが全ての記録領域を使用している場合はnullptrを返す
+	* </pre>
+	* @retval Job* 確保した記録領域(空きがない場合はnullptr)
+	* @param[in] worker 確保するワーカー(現在のスレッドのワーカーのみ)
+	*/
+	Job* AllocateJob(JobWorker* worker);
+
+	/**
+	* @brief 実行可能なジョブのキューへの追加関数
+	* @details キューが一杯の場合はその場で実行する
+	* @param[in] worker_index 追加するワーカーの番号
+	* @param[in] job 追加するジョブ
+	*/
+	void Enqueue(int worker_index, Job* job);
+
+	/**
+	* @brief ジョブの実行関数
+	* @details <pre>
+	* ジョブを複製して記録領域を空けてから実行する
+	* 実行後にカウンターを減らし、実行可能になったジョブをキューに追加する
+	* </pre>
+	* @param[in] worker_index 実行するワーカーの番号
+	* @param[in] job 実行するジョブ
+	*/
+	void Execute(int worker_index, Job* job);
+
+	/**
+	* @brief 次のジョブの実行関数
+	* @details 自分のキューから取り出し、空の場合は他のワーカーから盗んで実行する
+	* @retval true ジョブを実行した
+	* @retval false 実行できるジョブがなかった
+	* @param[in] worker_index 実行するワーカーの番号
+	*/
+	bool ExecuteNext(int worker_index);
+
+	/**
+	* @brief ワーカースレッドの処理関数
+	* @param[in] worker_index ワーカーの番号
+	*/
+	void WorkerMain(int worker_index);
+
+private:
+	std::vector<JobWorker*> m_WorkerList;		//!< ワーカー(個別に確保し、別のワーカーのキューと同じキャッシュラインに置かない)
+	HANDLE m_WakeSemaphore;						//!< 待機中のワーカーを起こすセマフォ
+	std::atomic<int> m_SleepingCount;			//!< 待機中のワーカーの数
+	std::atomic<bool> m_IsStopRequested;		//!< 停止要求フラグ
+	std::atomic<bool> m_IsPoolFullReported;		//!< 記録領域の不足を出力済みか
+};
+
+#endif
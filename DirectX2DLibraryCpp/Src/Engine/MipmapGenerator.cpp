@@ -0,0 +1,176 @@
+﻿#include <algorithm>
+#include <emmintrin.h>
+#include <string.h>
+#include "MipmapGenerator.h"
+
+namespace
+{
+	/**
+	* @brief 4テクセルの平均の計算関数(SSE2)
+	* @details <pre>
+	* 色はアルファで重み付けした合計をアルファの合計で割り、アルファは単純な平均にする
+	* 除算は(B, G, R, A)を(アルファの合計 x3, 4)で割る1回のSSE除算で行う
+	* </pre>
+	* @retval DWORD 平均のテクセル
+	* @param[in] top 上の行の2テクセル(16bitに広げたもの)
+	* @param[in] bottom 下の行の2テクセル(16bitに広げたもの)
+	*/
+	inline DWORD AverageTexelPairs(__m128i top, __m128i bottom)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128 rgb_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+
+		// 各テクセルのアルファを4チャンネルに複製して掛ける(最大255x255なので16bitに収まる)
+		__m128i top_alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(top, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		__m128i bottom_alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(bottom, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		__m128i top_weighted = _mm_mullo_epi16(top, top_alpha);
+		__m128i bottom_weighted = _mm_mullo_epi16(bottom, bottom_alpha);
+
+		// 32bitに広げて4テクセル分を合計する
+		__m128i weighted_sum = _mm_add_epi32(
+			_mm_add_epi32(_mm_unpacklo_epi16(top_weighted, zero), _mm_unpackhi_epi16(top_weighted, zero)),
+			_mm_add_epi32(_mm_unpacklo_epi16(bottom_weighted, zero), _mm_unpackhi_epi16(bottom_weighted, zero)));
+		__m128i pair_sum = _mm_add_epi16(top, bottom);
+		__m128i sum = _mm_add_epi32(_mm_unpacklo_epi16(pair_sum, zero), _mm_unpackhi_epi16(pair_sum, zero));
+		__m128 alpha_sum = _mm_cvtepi32_ps(_mm_shuffle_epi32(sum, _MM_SHUFFLE(3, 3, 3, 3)));
+
+		// 全て透明の場合は色の合計も0なので、1で割って0にする
+		__m128 numerator = _mm_or_ps(
+			_mm_and_ps(_mm_cvtepi32_ps(weighted_sum), rgb_mask),
+			_mm_andnot_ps(rgb_mask, alpha_sum));
+		__m128 divisor = _mm_or_ps(
+			_mm_and_ps(_mm_max_ps(alpha_sum, _mm_set1_ps(1.0f)), rgb_mask),
+			_mm_andnot_ps(rgb_mask, _mm_set1_ps(4.0f)));
+
+		__m128i result = _mm_cvttps_epi32(_mm_add_ps(_mm_div_ps(numerator, divisor), _mm_set1_ps(0.5f)));
+		result = _mm_packs_epi32(result, result);
+		result = _mm_packus_epi16(result, result);
+
+		return (DWORD)_mm_cvtsi128_si32(result);
+	}
+}
+
+int MipmapGenerator::CalculateLevelCount(int width, int height)
+{
+	int level_count = 1;
+
+	while ((width > 1 || height > 1) && level_count < MaxMipmapLevelCount)
+	{
+		width = (std::max)(width / 2, 1);
+		height = (std::max)(height / 2, 1);
+		level_count++;
+	}
+
+	return level_count;
+}
+
+void MipmapGenerator::CalculateLevelSize(int width, int height, int level, int* out_width, int* out_height)
+{
+	*out_width = (std::max)(width >> level, 1);
+	*out_height = (std::max)(height >> level, 1);
+}
+
+size_t MipmapGenerator::CalculateChainTexelCount(int width, int height, int level_count)
+{
+	size_t texel_count = 0;
+
+	for (int level = 0; level < level_count; level++)
+	{
+		int level_width = 0;
+		int level_height = 0;
+		CalculateLevelSize(width, height, level, &level_width, &level_height);
+		texel_count += (size_t)level_width * level_height;
+	}
+
+	return texel_count;
+}
+
+void MipmapGenerator::GenerateChain(int width, int height, const DWORD* pixels, int level_count, std::vector<DWORD>* out_chain)
+{
+	out_chain->resize(CalculateChainTexelCount(width, height, level_count));
+	memcpy(&(*out_chain)[0], pixels, (size_t)width * height * sizeof(DWORD));
+
+	// 各レベルは直前のレベルから作成する
+	DWORD* src = &(*out_chain)[0];
+	int src_width = width;
+	int src_height = height;
+
+	for (int level = 1; level < level_count; level++)
+	{
+		DWORD* dest = src + (size_t)src_width * src_height;
+		Downsample(src, src_width, src_height, dest);
+
+		src = dest;
+		CalculateLevelSize(width, height, level, &src_width, &src_height);
+	}
+}
+
+void MipmapGenerator::Downsample(const DWORD* src, int src_width, int src_height, DWORD* dest)
+{
+	int dest_width = (std::max)(src_width / 2, 1);
+	int dest_height = (std::max)(src_height / 2, 1);
+
+	// 1ピクセルしかない方向は同じ行、列を2回使用する
+	int next_column = src_width > 1 ? 1 : 0;
+	size_t next_row = src_height > 1 ? (size_t)src_width : 0;
+
+	const __m128i zero = _mm_setzero_si128();
+
+	for (int y = 0; y < dest_height; y++)
+	{
+		const DWORD* top = &src[(size_t)y * 2 * src_width];
+		const DWORD* bottom = top + next_row;
+		DWORD* dest_row = &dest[(size_t)y * dest_width];
+		int x = 0;
+
+		if (next_column == 1)
+		{
+			// 1行から4テクセルずつ読み込み、縮小後の2テクセルを作成する
+			for (; x + 2 <= dest_width; x += 2)
+			{
+				__m128i top_texels = _mm_loadu_si128((const __m128i*)&top[x * 2]);
+				__m128i bottom_texels = _mm_loadu_si128((const __m128i*)&bottom[x * 2]);
+
+				dest_row[x] = AverageTexelPairs(_mm_unpacklo_epi8(top_texels, zero), _mm_unpacklo_epi8(bottom_texels, zero));
+				dest_row[x + 1] = AverageTexelPairs(_mm_unpackhi_epi8(top_texels, zero), _mm_unpackhi_epi8(bottom_texels, zero));
+			}
+		}
+
+		for (; x < dest_width; x++)
+		{
+			dest_row[x] = AverageTexels(
+				top[x * 2],
+				top[x * 2 + next_column],
+				bottom[x * 2],
+				bottom[x * 2 + next_column]);
+		}
+	}
+}
+
+DWORD MipmapGenerator::AverageTexels(DWORD texel0, DWORD texel1, DWORD texel2, DWORD texel3)
+{
+	const DWORD texels[4] = { texel0, texel1, texel2, texel3 };
+	int weighted_sum[3] = { 0, 0, 0 };
+	int alpha_sum = 0;
+
+	for (int i = 0; i < 4; i++)
+	{
+		int alpha = (int)(texels[i] >> 24);
+		for (int channel = 0; channel < 3; channel++)
+		{
+			weighted_sum[channel] += (int)((texels[i] >> (channel * 8)) & 0xFF) * alpha;
+		}
+		alpha_sum += alpha;
+	}
+
+	// AverageTexelPairsと同じ順番でfloatの計算を行い、同じ結果にする
+	float divisor = (float)(std::max)(alpha_sum, 1);
+	DWORD result = (DWORD)(int)((float)alpha_sum / 4.0f + 0.5f) << 24;
+
+	for (int channel = 0; channel < 3; channel++)
+	{
+		result |= (DWORD)(int)((float)weighted_sum[channel] / divisor + 0.5f) << (channel * 8);
+	}
+
+	return result;
+}
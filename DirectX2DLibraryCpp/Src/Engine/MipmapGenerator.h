@@ -0,0 +1,88 @@
+﻿/**
+* @file MipmapGenerator.h
+* @brief <pre>
+* テクセルからミップマップを作成するクラスの宣言
+* デバイスを使用しないので、描画バックエンドに関係なく動作する
+* </pre>
+*/
+#ifndef MIPMAP_GENERATOR_H_
+#define MIPMAP_GENERATOR_H_
+
+#include <Windows.h>
+#include <vector>
+
+const int MaxMipmapLevelCount = 16;		//!< ミップマップのレベル数の上限(32768ピクセルまで1x1に縮小できる)
+
+/**
+* @brief ミップマップ作成クラス
+* @details <pre>
+* 1つ上のレベルの2x2テクセルの平均で次のレベルを作成する(ボックスフィルタ)
+* 色はアルファで重み付けした平均にするので、カラーキーで透明にしたテクセルの色が混ざって縁が暗くならない
+* 縮小後のサイズは元のサイズの半分(切り捨て、最小1)で、奇数の場合は最後の行、列を使用しない
+* 縮小はSSE2で1回に2テクセルずつ行う
+* </pre>
+*/
+class MipmapGenerator
+{
+public:
+	/**
+	* @brief レベル数の計算関数
+	* @details 1x1になるまでのレベル数を返す(MaxMipmapLevelCountまで)
+	* @retval int レベル数(最上位レベルを含む)
+	* @param[in] width 最上位レベルの横幅
+	* @param[in] height 最上位レベルの縦幅
+	*/
+	static int CalculateLevelCount(int width, int height);
+
+	/**
+	* @brief レベルのサイズの計算関数
+	* @param[in] width 最上位レベルの横幅
+	* @param[in] height 最上位レベルの縦幅
+	* @param[in] level レベル
+	* @param[out] out_width レベルの横幅
+	* @param[out] out_height レベルの縦幅
+	*/
+	static void CalculateLevelSize(int width, int height, int level, int* out_width, int* out_height);
+
+	/**
+	* @brief 全レベルのテクセル数の計算関数
+	* @retval size_t テクセル数
+	* @param[in] width 最上位レベルの横幅
+	* @param[in] height 最上位レベルの縦幅
+	* @param[in] level_count レベル数
+	*/
+	static size_t CalculateChainTexelCount(int width, int height, int level_count);
+
+	/**
+	* @brief ミップマップの作成関数
+	* @details 最上位レベルから順に全てのレベルのテクセルを詰めて並べる
+	* @param[in] width 最上位レベルの横幅
+	* @param[in] height 最上位レベルの縦幅
+	* @param[in] pixels 最上位レベルのテクセル(A8R8G8B8、1行の要素数はwidth)
+	* @param[in] level_count 作成するレベル数(最上位レベルを含む、CalculateLevelCount以下)
+	* @param[out] out_chain 全レベルのテクセル(各レベルの1行の要素数はそのレベルの横幅)
+	*/
+	static void GenerateChain(int width, int height, const DWORD* pixels, int level_count, std::vector<DWORD>* out_chain);
+
+	/**
+	* @brief 1レベルの縮小関数
+	* @param[in] src 縮小元のテクセル(A8R8G8B8、1行の要素数はsrc_width)
+	* @param[in] src_width 縮小元の横幅
+	* @param[in] src_height 縮小元の縦幅
+	* @param[out] dest 縮小したテクセル(1行の要素数は縮小後の横幅)
+	*/
+	static void Downsample(const DWORD* src, int src_width, int src_height, DWORD* dest);
+
+	/**
+	* @brief 4テクセルの平均の計算関数
+	* @details Downsampleと同じ計算をSSEを使用せずに行う(端の処理と結果の確認に使用する)
+	* @retval DWORD 平均のテクセル
+	* @param[in] texel0 テクセル
+	* @param[in] texel1 テクセル
+	* @param[in] texel2 テクセル
+	* @param[in] texel3 テクセル
+	*/
+	static DWORD AverageTexels(DWORD texel0, DWORD texel1, DWORD texel2, DWORD texel3);
+};
+
+#endif
@@ -0,0 +1,104 @@
+﻿#include <stdio.h>
+#include <string.h>
+#include "NullRenderBackend.h"
+
+bool NullRenderBackend::Initialize(int width, int height, bool is_window_mode)
+{
+	m_BackBufferWidth = width;
+	m_BackBufferHeight = height;
+
+	return true;
+}
+
+bool NullRenderBackend::CreateTexture(const char* file_name, Texture* texture_data)
+{
+	int width = 0;
+	int height = 0;
+
+	if (ReadImageSize(file_name, &width, &height) == false)
+	{
+		return false;
+	}
+
+	texture_data->TextureData = nullptr;
+	texture_data->Width = width;
+	texture_data->Height = height;
+
+	return true;
+}
+
+bool NullRenderBackend::CreateTextureFromMemory(const void* data, size_t size, Texture* texture_data)
+{
+	int width = 0;
+	int height = 0;
+
+	if (ParseImageSize((const unsigned char*)data, size, &width, &height) == false)
+	{
+		return false;
+	}
+
+	texture_data->TextureData = nullptr;
+	texture_data->Width = width;
+	texture_data->Height = height;
+
+	return true;
+}
+
+bool NullRenderBackend::CreateEmptyTexture(int width, int height, Texture* texture_data)
+{
+	texture_data->TextureData = nullptr;
+	texture_data->Width = width;
+	texture_data->Height = height;
+
+	return true;
+}
+
+void NullRenderBackend::GetBackBufferSize(int* out_width, int* out_height) const
+{
+	*out_width = m_BackBufferWidth;
+	*out_height = m_BackBufferHeight;
+}
+
+bool NullRenderBackend::ReadImageSize(const char* file_name, int* out_width, int* out_height)
+{
+	FILE* fp = nullptr;
+	if (fopen_s(&fp, file_name, "rb") != 0 || fp == nullptr)
+	{
+		return false;
+	}
+
+	unsigned char header[26];
+	size_t read_size = fread(header, 1, sizeof(header), fp);
+	fclose(fp);
+
+	return ParseImageSize(header, read_size, out_width, out_height);
+}
+
+bool NullRenderBackend::ParseImageSize(const unsigned char* header, size_t size, int* out_width, int* out_height)
+{
+	const unsigned char png_signature[] = { 0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a };
+
+	// png：シグネチャの直後のIHDRチャンクに幅と高さ(ビッグエンディアン)がある
+	if (size >= 24 &&
+		memcmp(header, png_signature, sizeof(png_signature)) == 0 &&
+		memcmp(&header[12], "IHDR", 4) == 0)
+	{
+		*out_width = (header[16] << 24) | (header[17] << 16) | (header[18] << 8) | header[19];
+		*out_height = (header[20] << 24) | (header[21] << 16) | (header[22] << 8) | header[23];
+		return true;
+	}
+
+	// bmp：情報ヘッダに幅と高さ(リトルエンディアン、高さは負の場合あり)がある
+	if (size >= 26 &&
+		header[0] == 'B' &&
+		header[1] == 'M')
+	{
+		int width = header[18] | (header[19] << 8) | (header[20] << 16) | (header[21] << 24);
+		int height = header[22] | (header[23] << 8) | (header[24] << 16) | (header[25] << 24);
+		*out_width = width;
+		*out_height = height < 0 ? -height : height;
+		return true;
+	}
+
+	return false;
+}
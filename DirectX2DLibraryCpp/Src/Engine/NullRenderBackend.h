@@ -0,0 +1,144 @@
+﻿/**
+* @file NullRenderBackend.h
+* @brief <pre>
+* 何も描画しない描画バックエンドの宣言
+* GPUがない環境でもGraphicsの頂点作成やバッチ処理をそのまま実行できる
+* Graphicsクラスでインスタンスを作成するので使用者が作成する必要はない
+* </pre>
+*/
+#ifndef NULL_RENDER_BACKEND_H_
+#define NULL_RENDER_BACKEND_H_
+
+#include "RenderBackend.h"
+
+/** @brief Null描画バックエンドクラス */
+class NullRenderBackend : public RenderBackend
+{
+public:
+	/** Constructor */
+	NullRenderBackend() :
+		m_BackBufferWidth(0),
+		m_BackBufferHeight(0)
+	{
+	}
+
+	virtual bool Initialize(int width, int height, bool is_window_mode) override;
+	virtual void Release() override {}
+	virtual RenderBackendType GetType() const override
+	{
+		return RenderBackendType::RenderBackendTypeNull;
+	}
+	virtual bool BeginFrame(DWORD color) override
+	{
+		return true;
+	}
+	virtual void EndFrame() override {}
+	virtual void SetVertexFormat() override {}
+	virtual void SetTexture(const Texture* texture) override {}
+	virtual void SetTextureFilter(TextureFilter filter) override {}
+	virtual void DrawTriangleList(const CustomVertex* vertices, int vertex_count) override {}
+
+	/**
+	* @brief テクスチャ作成関数
+	* @details <pre>
+	* 画像ファイルのヘッダからサイズのみを読み込み、テクスチャデータは作成しない
+	* 対応フォーマットはpngとbmp
+	* </pre>
+	* @retval true 作成成功
+	* @retval false 作成失敗
+	* @param[in] file_name 読み込むテクスチャの名前(パス込み)
+	* @param[out] texture_data サイズを反映するデータ(TextureDataはnullptr)
+	*/
+	virtual bool CreateTexture(const char* file_name, Texture* texture_data) override;
+
+	/**
+	* @brief テクスチャのデコード関数
+	* @details デコーダーを持たないので常に失敗する(テクスチャキャッシュを使用せずにCreateTextureで作成される)
+	* @retval false デコード失敗
+	*/
+	virtual bool DecodeTexture(const char* file_name, int* out_width, int* out_height, std::vector<DWORD>* out_pixels) override
+	{
+		return false;
+	}
+
+	/**
+	* @brief メモリ上の画像ファイルからのテクスチャ作成関数
+	* @details CreateTextureと同様にヘッダからサイズのみを読み込む
+	* @retval true 作成成功
+	* @retval false 作成失敗
+	* @param[in] data 画像ファイルの内容
+	* @param[in] size 画像ファイルのバイト数
+	* @param[out] texture_data サイズを反映するデータ(TextureDataはnullptr)
+	*/
+	virtual bool CreateTextureFromMemory(const void* data, size_t size, Texture* texture_data) override;
+
+	/**
+	* @brief メモリ上の画像ファイルのデコード関数
+	* @details デコーダーを持たないので常に失敗する
+	* @retval false デコード失敗
+	*/
+	virtual bool DecodeTextureFromMemory(const void* data, size_t size, int* out_width, int* out_height, std::vector<DWORD>* out_pixels) override
+	{
+		return false;
+	}
+
+
+	/**
+	* @brief 空のテクスチャ作成関数
+	* @details サイズのみを設定し、テクスチャデータは作成しない
+	* @retval true 作成成功
+	* @param[in] width 横幅
+	* @param[in] height 縦幅
+	* @param[out] texture_data サイズを反映するデータ(TextureDataはnullptr)
+	*/
+	virtual bool CreateEmptyTexture(int width, int height, Texture* texture_data) override;
+
+	/**
+	* @brief ミップマップ付きテクスチャの作成関数
+	* @details CreateEmptyTextureと同じく最上位レベルのサイズのみを設定する
+	* @retval true 作成成功
+	* @param[in] width 最上位レベルの横幅
+	* @param[in] height 最上位レベルの縦幅
+	* @param[in] level_count レベル数
+	* @param[in] pixels 全レベルのテクセル
+	* @param[out] texture_data サイズを反映するデータ(TextureDataはnullptr)
+	*/
+	virtual bool CreateMipmappedTexture(int width, int height, int level_count, const DWORD* pixels, Texture* texture_data) override
+	{
+		return CreateEmptyTexture(width, height, texture_data);
+	}
+	virtual bool UpdateTexture(Texture* texture_data, int x, int y, int width, int height, const DWORD* pixels, int pitch) override
+	{
+		return true;
+	}
+	virtual void GetBackBufferSize(int* out_width, int* out_height) const override;
+
+	/**
+	* @brief 画像サイズの読み込み関数
+	* @details pngかbmpのヘッダから画像サイズを読み込む
+	* @retval true 読み込み成功
+	* @retval false 読み込み失敗
+	* @param[in] file_name 画像ファイル名
+	* @param[out] out_width 横幅
+	* @param[out] out_height 縦幅
+	*/
+	static bool ReadImageSize(const char* file_name, int* out_width, int* out_height);
+
+	/**
+	* @brief 画像サイズの解析関数
+	* @details pngかbmpのヘッダから画像サイズを読み取る
+	* @retval true 解析成功
+	* @retval false 対応していない形式、またはヘッダが不足している
+	* @param[in] header 画像ファイルの先頭
+	* @param[in] size headerのバイト数
+	* @param[out] out_width 横幅
+	* @param[out] out_height 縦幅
+	*/
+	static bool ParseImageSize(const unsigned char* header, size_t size, int* out_width, int* out_height);
+
+private:
+	int m_BackBufferWidth;	//!< バックバッファの横幅
+	int m_BackBufferHeight;	//!< バックバッファの縦幅
+};
+
+#endif
@@ -0,0 +1,556 @@
+﻿#include <algorithm>
+#include <emmintrin.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ParticleEmitter.h"
+
+namespace
+{
+	const float DegreeToRadian = 3.14159265f / 180.0f;	//!< 角度をラジアンに変換する係数(D3DXToRadianと同じ値)
+
+	/**
+	* @brief 空白文字の判定関数
+	* @retval true 空白、タブ、改行
+	* @retval false それ以外
+	* @param[in] c 文字
+	*/
+	bool IsSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	}
+
+	/**
+	* @brief 数値の読み込み関数
+	* @details 「最小,最大」形式の数値を読み込む(1つだけの場合は最小と最大に同じ値を設定する)
+	* @retval true 読み込み成功
+	* @retval false 数値ではない
+	* @param[in] value 値の文字列
+	* @param[out] out_min 最小値
+	* @param[out] out_max 最大値
+	*/
+	bool ReadFloatRange(const char* value, float* out_min, float* out_max)
+	{
+		char* end = nullptr;
+		float min = strtof(value, &end);
+		if (end == value)
+		{
+			return false;
+		}
+
+		float max = min;
+		while (IsSpace(*end) == true)
+		{
+			end++;
+		}
+
+		if (*end == ',')
+		{
+			const char* second = end + 1;
+			max = strtof(second, &end);
+			if (end == second)
+			{
+				return false;
+			}
+		}
+
+		*out_min = min;
+		*out_max = max;
+
+		return true;
+	}
+
+	/**
+	* @brief 1行の解析関数
+	* @retval true 解析成功(知らないキーは無視する)
+	* @retval false 値が不正
+	* @param[in] key キー
+	* @param[in] value 値
+	* @param[out] out_desc 解析結果
+	*/
+	bool ParseLine(const std::string& key, const std::string& value, ParticleEmitterDesc* out_desc)
+	{
+		float min = 0.0f;
+		float max = 0.0f;
+
+		if (key == "texture")
+		{
+			out_desc->TextureKeyword = value;
+			return true;
+		}
+		else if (key == "start_color" || key == "end_color")
+		{
+			char* end = nullptr;
+			DWORD color = (DWORD)strtoul(value.c_str(), &end, 16);
+			if (end == value.c_str())
+			{
+				return false;
+			}
+
+			(key == "start_color" ? out_desc->StartColor : out_desc->EndColor) = color;
+			return true;
+		}
+
+		if (ReadFloatRange(value.c_str(), &min, &max) == false)
+		{
+			return false;
+		}
+
+		if (key == "max_particles")
+		{
+			out_desc->MaxParticles = (int)min;
+		}
+		else if (key == "emit_rate")
+		{
+			out_desc->EmitRate = min;
+		}
+		else if (key == "life")
+		{
+			out_desc->LifeMin = min;
+			out_desc->LifeMax = max;
+		}
+		else if (key == "speed")
+		{
+			out_desc->SpeedMin = min;
+			out_desc->SpeedMax = max;
+		}
+		else if (key == "angle")
+		{
+			out_desc->AngleMin = min;
+			out_desc->AngleMax = max;
+		}
+		else if (key == "start_size")
+		{
+			out_desc->StartSizeMin = min;
+			out_desc->StartSizeMax = max;
+		}
+		else if (key == "end_size")
+		{
+			out_desc->EndSize = min;
+		}
+		else if (key == "gravity")
+		{
+			out_desc->GravityX = min;
+			out_desc->GravityY = max;
+		}
+		else if (key == "spawn_radius")
+		{
+			out_desc->SpawnRadius = min;
+		}
+
+		return true;
+	}
+
+	/** @brief 並列更新のジョブに渡すデータ */
+	struct ParticleIntegrateJobData
+	{
+		ParticleEmitter* Emitter;	//!< 更新するエミッター
+		float DeltaTime;			//!< 経過時間(秒)
+	};
+
+	/**
+	* @brief 並列更新のジョブの処理関数
+	* @param[in] data ParticleIntegrateJobData
+	* @param[in] begin 先頭のパーティクル
+	* @param[in] end 終端のパーティクル
+	*/
+	void IntegrateParticlesJob(void* data, int begin, int end)
+	{
+		ParticleIntegrateJobData* job_data = (ParticleIntegrateJobData*)data;
+		job_data->Emitter->IntegrateRange(begin, end, job_data->DeltaTime);
+	}
+
+	/**
+	* @brief 前後の空白の削除関数
+	* @retval std::string 空白を削除した文字列
+	* @param[in] begin 文字列の先頭
+	* @param[in] end 文字列の終端
+	*/
+	std::string Trim(const char* begin, const char* end)
+	{
+		while (begin < end && IsSpace(*begin) == true)
+		{
+			begin++;
+		}
+
+		while (end > begin && IsSpace(*(end - 1)) == true)
+		{
+			end--;
+		}
+
+		return std::string(begin, end);
+	}
+}
+
+void ParticleEmitter::Initialize(const ParticleEmitterDesc& desc)
+{
+	Release();
+
+	m_Desc = desc;
+	m_Desc.MaxParticles = (std::min)((std::max)(desc.MaxParticles, 0), MaxParticleCount);
+
+	for (std::vector<float>& stream : m_Streams)
+	{
+		stream.resize(m_Desc.MaxParticles);
+	}
+}
+
+void ParticleEmitter::Release()
+{
+	for (std::vector<float>& stream : m_Streams)
+	{
+		stream.clear();
+	}
+
+	m_Count = 0;
+	m_EmitAccumulator = 0.0f;
+}
+
+void ParticleEmitter::Update(float delta_time, JobSystem* job_system)
+{
+	if (job_system != nullptr)
+	{
+		ParticleIntegrateJobData job_data = { this, delta_time };
+		job_system->ParallelFor(IntegrateParticlesJob, &job_data, m_Count, ParticleJobGrainSize);
+	}
+	else
+	{
+		IntegrateRange(0, m_Count, delta_time);
+	}
+	RemoveDeadParticles();
+
+	if (m_IsEmitting == true)
+	{
+		m_EmitAccumulator += m_Desc.EmitRate * delta_time;
+
+		int count = (int)m_EmitAccumulator;
+		m_EmitAccumulator -= (float)count;
+		Emit(count);
+	}
+}
+
+void ParticleEmitter::Emit(int count)
+{
+	count = (std::min)(count, m_Desc.MaxParticles - m_Count);
+
+	float start_color[4] =
+	{
+		(float)((m_Desc.StartColor >> 16) & 0xff),
+		(float)((m_Desc.StartColor >> 8) & 0xff),
+		(float)(m_Desc.StartColor & 0xff),
+		(float)((m_Desc.StartColor >> 24) & 0xff),
+	};
+
+	float end_color[4] =
+	{
+		(float)((m_Desc.EndColor >> 16) & 0xff),
+		(float)((m_Desc.EndColor >> 8) & 0xff),
+		(float)(m_Desc.EndColor & 0xff),
+		(float)((m_Desc.EndColor >> 24) & 0xff),
+	};
+
+	for (int n = 0; n < count; n++)
+	{
+		int i = m_Count++;
+
+		float life = (std::max)(RandomRange(m_Desc.LifeMin, m_Desc.LifeMax), 0.001f);
+		float speed = RandomRange(m_Desc.SpeedMin, m_Desc.SpeedMax);
+		float angle = RandomRange(m_Desc.AngleMin, m_Desc.AngleMax) * DegreeToRadian;
+		float size = RandomRange(m_Desc.StartSizeMin, m_Desc.StartSizeMax);
+
+		float offset_x = 0.0f;
+		float offset_y = 0.0f;
+		if (m_Desc.SpawnRadius > 0.0f)
+		{
+			float offset_angle = RandomRange(0.0f, 360.0f) * DegreeToRadian;
+			float offset_length = m_Desc.SpawnRadius * sqrtf(NextRandom());
+			offset_x = cosf(offset_angle) * offset_length;
+			offset_y = sinf(offset_angle) * offset_length;
+		}
+
+		// 寿命が尽きた時に終了時の値になるように、1秒あたりの変化量を発生時に求めておく
+		float inverse_life = 1.0f / life;
+
+		m_Streams[ParticleStreamPositionX][i] = m_PositionX + offset_x;
+		m_Streams[ParticleStreamPositionY][i] = m_PositionY + offset_y;
+		m_Streams[ParticleStreamVelocityX][i] = cosf(angle) * speed;
+		m_Streams[ParticleStreamVelocityY][i] = sinf(angle) * speed;
+		for (int c = 0; c < 4; c++)
+		{
+			m_Streams[ParticleStreamColorR + c][i] = start_color[c];
+			m_Streams[ParticleStreamColorDeltaR + c][i] = (end_color[c] - start_color[c]) * inverse_life;
+		}
+		m_Streams[ParticleStreamSize][i] = size;
+		m_Streams[ParticleStreamSizeDelta][i] = (m_Desc.EndSize - size) * inverse_life;
+		m_Streams[ParticleStreamLife][i] = life;
+	}
+}
+
+void ParticleEmitter::IntegrateRange(int begin, int end, float delta_time)
+{
+	end = (std::min)(end, m_Count);
+	if (begin >= end)
+	{
+		return;
+	}
+
+	float* position_x = &m_Streams[ParticleStreamPositionX][0];
+	float* position_y = &m_Streams[ParticleStreamPositionY][0];
+	float* velocity_x = &m_Streams[ParticleStreamVelocityX][0];
+	float* velocity_y = &m_Streams[ParticleStreamVelocityY][0];
+	float* size = &m_Streams[ParticleStreamSize][0];
+	const float* size_delta = &m_Streams[ParticleStreamSizeDelta][0];
+	float* life = &m_Streams[ParticleStreamLife][0];
+
+	float gravity_x = m_Desc.GravityX * delta_time;
+	float gravity_y = m_Desc.GravityY * delta_time;
+
+	const __m128 dt = _mm_set1_ps(delta_time);
+	const __m128 gx = _mm_set1_ps(gravity_x);
+	const __m128 gy = _mm_set1_ps(gravity_y);
+
+	int i = begin;
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 vx = _mm_add_ps(_mm_loadu_ps(&velocity_x[i]), gx);
+		__m128 vy = _mm_add_ps(_mm_loadu_ps(&velocity_y[i]), gy);
+		_mm_storeu_ps(&velocity_x[i], vx);
+		_mm_storeu_ps(&velocity_y[i], vy);
+		_mm_storeu_ps(&position_x[i], _mm_add_ps(_mm_loadu_ps(&position_x[i]), _mm_mul_ps(vx, dt)));
+		_mm_storeu_ps(&position_y[i], _mm_add_ps(_mm_loadu_ps(&position_y[i]), _mm_mul_ps(vy, dt)));
+		_mm_storeu_ps(&size[i], _mm_add_ps(_mm_loadu_ps(&size[i]), _mm_mul_ps(_mm_loadu_ps(&size_delta[i]), dt)));
+		_mm_storeu_ps(&life[i], _mm_sub_ps(_mm_loadu_ps(&life[i]), dt));
+	}
+
+	for (; i < end; i++)
+	{
+		velocity_x[i] += gravity_x;
+		velocity_y[i] += gravity_y;
+		position_x[i] += velocity_x[i] * delta_time;
+		position_y[i] += velocity_y[i] * delta_time;
+		size[i] += size_delta[i] * delta_time;
+		life[i] -= delta_time;
+	}
+
+	for (int c = 0; c < 4; c++)
+	{
+		float* color = &m_Streams[ParticleStreamColorR + c][0];
+		const float* color_delta = &m_Streams[ParticleStreamColorDeltaR + c][0];
+
+		i = begin;
+		for (; i + 4 <= end; i += 4)
+		{
+			_mm_storeu_ps(&color[i], _mm_add_ps(_mm_loadu_ps(&color[i]), _mm_mul_ps(_mm_loadu_ps(&color_delta[i]), dt)));
+		}
+
+		for (; i < end; i++)
+		{
+			color[i] += color_delta[i] * delta_time;
+		}
+	}
+}
+
+void ParticleEmitter::RemoveDeadParticles()
+{
+	const float* life = m_Count == 0 ? nullptr : &m_Streams[ParticleStreamLife][0];
+
+	int i = 0;
+	while (i < m_Count)
+	{
+		if (life[i] > 0.0f)
+		{
+			i++;
+			continue;
+		}
+
+		// 最後のパーティクルを移動してきたので、同じ番号をもう一度判定する
+		int last = --m_Count;
+		for (std::vector<float>& stream : m_Streams)
+		{
+			stream[i] = stream[last];
+		}
+	}
+}
+
+void ParticleEmitter::WriteVertices(int first, int count, CustomVertex* dest) const
+{
+	const float* position_x = &m_Streams[ParticleStreamPositionX][first];
+	const float* position_y = &m_Streams[ParticleStreamPositionY][first];
+	const float* size = &m_Streams[ParticleStreamSize][first];
+	const float* color_r = &m_Streams[ParticleStreamColorR][first];
+	const float* color_g = &m_Streams[ParticleStreamColorG][first];
+	const float* color_b = &m_Streams[ParticleStreamColorB][first];
+	const float* color_a = &m_Streams[ParticleStreamColorA][first];
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 max_value = _mm_set1_ps(255.0f);
+
+	for (int i = 0; i < count; i += 4)
+	{
+		int lane_count = (std::min)(count - i, 4);
+
+		// 端数は残りの要素を0で埋めてから変換する
+		float channels[4][4] = {};
+		for (int lane = 0; lane < lane_count; lane++)
+		{
+			channels[0][lane] = color_a[i + lane];
+			channels[1][lane] = color_r[i + lane];
+			channels[2][lane] = color_g[i + lane];
+			channels[3][lane] = color_b[i + lane];
+		}
+
+		__m128i packed = _mm_setzero_si128();
+		for (int c = 0; c < 4; c++)
+		{
+			__m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(channels[c]), zero), max_value);
+			packed = _mm_or_si128(_mm_slli_epi32(packed, 8), _mm_cvttps_epi32(value));
+		}
+
+		DWORD colors[4];
+		_mm_storeu_si128((__m128i*)colors, packed);
+
+		for (int lane = 0; lane < lane_count; lane++)
+		{
+			int index = i + lane;
+			float half_size = (std::max)(size[index], 0.0f) * 0.5f;
+			float left = position_x[index] - half_size;
+			float top = position_y[index] - half_size;
+			float right = position_x[index] + half_size;
+			float bottom = position_y[index] + half_size;
+			DWORD color = colors[lane];
+
+			CustomVertex v[4] =
+			{
+				{ left, top, 0.0f, 1.0f, color, 0.0f, 0.0f },
+				{ right, top, 0.0f, 1.0f, color, 1.0f, 0.0f },
+				{ right, bottom, 0.0f, 1.0f, color, 1.0f, 1.0f },
+				{ left, bottom, 0.0f, 1.0f, color, 0.0f, 1.0f },
+			};
+
+			dest[0] = v[0];
+			dest[1] = v[1];
+			dest[2] = v[2];
+			dest[3] = v[0];
+			dest[4] = v[2];
+			dest[5] = v[3];
+			dest += 6;
+		}
+	}
+}
+
+void ParticleEmitter::SetPosition(float x, float y)
+{
+	m_PositionX = x;
+	m_PositionY = y;
+}
+
+void ParticleEmitter::SetEmitting(bool is_emitting)
+{
+	m_IsEmitting = is_emitting;
+}
+
+bool ParticleEmitter::ParseDesc(const char* data, size_t size, ParticleEmitterDesc* out_desc)
+{
+	const char* p = data;
+	const char* data_end = data + size;
+
+	// UTF-8のBOMは読み飛ばす
+	if (size >= 3 && memcmp(data, "\xEF\xBB\xBF", 3) == 0)
+	{
+		p += 3;
+	}
+
+	while (p < data_end)
+	{
+		const char* line = p;
+		while (p < data_end && *p != '\n')
+		{
+			p++;
+		}
+		const char* line_end = p;
+		if (p < data_end)
+		{
+			p++;
+		}
+
+		const char* comment = (const char*)memchr(line, '#', line_end - line);
+		if (comment != nullptr)
+		{
+			line_end = comment;
+		}
+
+		const char* equal = (const char*)memchr(line, '=', line_end - line);
+		if (equal == nullptr)
+		{
+			// 空行とコメントだけの行は読み飛ばす
+			if (Trim(line, line_end).empty() == true)
+			{
+				continue;
+			}
+			return false;
+		}
+
+		if (ParseLine(Trim(line, equal), Trim(equal + 1, line_end), out_desc) == false)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool ParticleEmitter::LoadDesc(const char* file_name, ParticleEmitterDesc* out_desc)
+{
+	FILE* fp = nullptr;
+	if (fopen_s(&fp, file_name, "rb") != 0 || fp == nullptr)
+	{
+		return false;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	if (size <= 0)
+	{
+		fclose(fp);
+		return false;
+	}
+
+	std::vector<char> data(size);
+	size_t read_size = fread(&data[0], 1, size, fp);
+	fclose(fp);
+
+	if (read_size != (size_t)size)
+	{
+		return false;
+	}
+
+	ParticleEmitterDesc desc;
+	if (ParseDesc(&data[0], data.size(), &desc) == false)
+	{
+		return false;
+	}
+
+	*out_desc = desc;
+
+	return true;
+}
+
+float ParticleEmitter::NextRandom()
+{
+	// xorshift32(スレッドごとにエミッターを分ければロックなしで使用できる)
+	unsigned int x = m_RandomState;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	m_RandomState = x;
+
+	return (x >> 8) * (1.0f / 16777216.0f);
+}
+
+float ParticleEmitter::RandomRange(float min, float max)
+{
+	return min + (max - min) * NextRandom();
+}
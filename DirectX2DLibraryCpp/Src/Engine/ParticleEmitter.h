@@ -0,0 +1,280 @@
+﻿/**
+* @file ParticleEmitter.h
+* @brief <pre>
+* パーティクルの発生、更新を行うエミッタークラスの宣言
+* パーティクルは項目ごとの配列(SoA)で保持し、4個ずつSSEでまとめて更新する
+* デバイスを使用しないので、発生と更新は描画バックエンドに関係なく動作する
+* 描画はGraphics::DrawParticlesでスプライトバッチに直接頂点を書き込んで行う
+* </pre>
+*/
+#ifndef PARTICLE_EMITTER_H_
+#define PARTICLE_EMITTER_H_
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "EngineConstant.h"
+#include "JobSystem.h"
+
+const int MaxParticleCount = 1 << 20;	//!< 1つのエミッターで扱えるパーティクルの最大数
+const int ParticleJobGrainSize = 8192;	//!< 並列更新で1つのジョブが更新するパーティクル数
+
+/** @brief パーティクルの項目 */
+enum ParticleStream
+{
+	ParticleStreamPositionX,		//!< 座標X
+	ParticleStreamPositionY,		//!< 座標Y
+	ParticleStreamVelocityX,		//!< 速度X(1秒あたり)
+	ParticleStreamVelocityY,		//!< 速度Y(1秒あたり)
+	ParticleStreamColorR,			//!< 色R(0～255)
+	ParticleStreamColorG,			//!< 色G(0～255)
+	ParticleStreamColorB,			//!< 色B(0～255)
+	ParticleStreamColorA,			//!< 色A(0～255)
+	ParticleStreamColorDeltaR,		//!< 色Rの変化量(1秒あたり)
+	ParticleStreamColorDeltaG,		//!< 色Gの変化量(1秒あたり)
+	ParticleStreamColorDeltaB,		//!< 色Bの変化量(1秒あたり)
+	ParticleStreamColorDeltaA,		//!< 色Aの変化量(1秒あたり)
+	ParticleStreamSize,				//!< サイズ(ピクセル)
+	ParticleStreamSizeDelta,		//!< サイズの変化量(1秒あたり)
+	ParticleStreamLife,				//!< 残り寿命(秒)
+	ParticleStreamMax,				//!< 項目の最大数
+};
+
+/**
+* @brief エミッターの設定
+* @details <pre>
+* データファイル(1行に「キー=値」、範囲は「最小,最大」、#から行末はコメント)から読み込める
+* texture=Spark
+* max_particles=2000
+* emit_rate=500
+* life=0.5,1.5
+* speed=50,200
+* angle=0,360
+* start_size=8,16
+* end_size=0
+* start_color=FFFFFFFF
+* end_color=00FF4000
+* gravity=0,98
+* spawn_radius=4
+* </pre>
+*/
+struct ParticleEmitterDesc
+{
+	/** Constructor */
+	ParticleEmitterDesc() :
+		TextureKeyword(),
+		MaxParticles(1000),
+		EmitRate(100.0f),
+		LifeMin(1.0f),
+		LifeMax(1.0f),
+		SpeedMin(50.0f),
+		SpeedMax(100.0f),
+		AngleMin(0.0f),
+		AngleMax(360.0f),
+		StartSizeMin(8.0f),
+		StartSizeMax(8.0f),
+		EndSize(8.0f),
+		StartColor(D3DCOLOR_ARGB(255, 255, 255, 255)),
+		EndColor(D3DCOLOR_ARGB(0, 255, 255, 255)),
+		GravityX(0.0f),
+		GravityY(0.0f),
+		SpawnRadius(0.0f)
+	{
+	}
+
+	std::string TextureKeyword;		//!< 使用するテクスチャのキーワード(空の場合はテクスチャなし)
+	int MaxParticles;				//!< 同時に存在できるパーティクル数
+	float EmitRate;					//!< 1秒あたりの発生数
+	float LifeMin;					//!< 寿命の最小値(秒)
+	float LifeMax;					//!< 寿命の最大値(秒)
+	float SpeedMin;					//!< 初速の最小値(1秒あたりのピクセル)
+	float SpeedMax;					//!< 初速の最大値(1秒あたりのピクセル)
+	float AngleMin;					//!< 発射角度の最小値(度数法)
+	float AngleMax;					//!< 発射角度の最大値(度数法)
+	float StartSizeMin;				//!< 発生時のサイズの最小値
+	float StartSizeMax;				//!< 発生時のサイズの最大値
+	float EndSize;					//!< 寿命が尽きる時のサイズ
+	DWORD StartColor;				//!< 発生時の色(ARGB形式)
+	DWORD EndColor;					//!< 寿命が尽きる時の色(ARGB形式)
+	float GravityX;					//!< 加速度X(1秒あたり)
+	float GravityY;					//!< 加速度Y(1秒あたり)
+	float SpawnRadius;				//!< 発生位置のばらつきの半径
+};
+
+/**
+* @brief パーティクルエミッタークラス
+* @details <pre>
+* 寿命が尽きたパーティクルは最後のパーティクルと入れ替えて削除するので、配列の詰め直しは行わない
+* そのため描画順は発生順にならない(加算合成などの順序に依存しない表現に向いている)
+* </pre>
+*/
+class ParticleEmitter
+{
+public:
+	/** Constructor */
+	ParticleEmitter() :
+		m_Desc(),
+		m_Streams(),
+		m_Count(0),
+		m_PositionX(0.0f),
+		m_PositionY(0.0f),
+		m_EmitAccumulator(0.0f),
+		m_IsEmitting(true),
+		m_RandomState(0x12345678)
+	{
+	}
+
+	/**
+	* @brief 初期化関数
+	* @details 設定に従ってパーティクルの配列を確保する
+	* @param[in] desc エミッターの設定
+	*/
+	void Initialize(const ParticleEmitterDesc& desc);
+
+	/**
+	* @brief 解放関数
+	*/
+	void Release();
+
+	/**
+	* @brief 更新関数
+	* @details <pre>
+	* 発生、移動、寿命が尽きたパーティクルの削除をまとめて行う
+	* job_systemを指定した場合は、移動をParticleJobGrainSize個ずつに分割して並列に行う
+	* </pre>
+	* @param[in] delta_time 経過時間(秒)
+	* @param[in] job_system 移動に使用するジョブシステム(nullptrの場合は実行したスレッドだけで行う)
+	*/
+	void Update(float delta_time, JobSystem* job_system);
+
+	/**
+	* @brief 発生関数
+	* @details <pre>
+	* 指定された数のパーティクルを発生させる(爆発などの一度に発生させる演出に使用する)
+	* 同時に存在できる数を超える分は発生させない
+	* </pre>
+	* @param[in] count 発生させる数
+	*/
+	void Emit(int count);
+
+	/**
+	* @brief 範囲指定の移動関数
+	* @details <pre>
+	* 座標、速度、色、サイズ、寿命を4個ずつSSEで更新する(4個に満たない端数は1個ずつ更新する)
+	* 範囲が重ならなければ複数のスレッドから同時に実行できる
+	* 寿命が尽きたパーティクルは削除しないので、全ての範囲の更新後にRemoveDeadParticlesを実行する
+	* </pre>
+	* @param[in] begin 先頭の番号
+	* @param[in] end 終端の番号
+	* @param[in] delta_time 経過時間(秒)
+	*/
+	void IntegrateRange(int begin, int end, float delta_time);
+
+	/**
+	* @brief 寿命が尽きたパーティクルの削除関数
+	* @details 最後のパーティクルと入れ替えて削除する
+	*/
+	void RemoveDeadParticles();
+
+	/**
+	* @brief 頂点データの作成関数
+	* @details <pre>
+	* パーティクルを中心からサイズ分の正方形として、1個につき6頂点(三角形リスト)を書き込む
+	* 色は4個ずつSSEで0～255に丸めてARGB形式に変換する
+	* Graphics::DrawParticlesがバッチの領域に直接書き込むために使用する
+	* </pre>
+	* @param[in] first 先頭の番号
+	* @param[in] count 書き込むパーティクル数
+	* @param[out] dest 書き込み先(count * 6頂点分)
+	*/
+	void WriteVertices(int first, int count, CustomVertex* dest) const;
+
+	/**
+	* @brief 発生位置の設定関数
+	* @param[in] x 発生位置X
+	* @param[in] y 発生位置Y
+	*/
+	void SetPosition(float x, float y);
+
+	/**
+	* @brief 連続発生の有効設定関数
+	* @details falseの場合はEmitRateによる発生を止める(発生済みのパーティクルは寿命まで残る)
+	* @param[in] is_emitting 発生させる場合はtrue
+	*/
+	void SetEmitting(bool is_emitting);
+
+	/**
+	* @brief パーティクル数の取得関数
+	* @retval int 存在しているパーティクル数
+	*/
+	int GetCount() const
+	{
+		return m_Count;
+	}
+
+	/**
+	* @brief 項目の配列の取得関数
+	* @retval const float* 項目の配列(GetCount個の要素が有効)
+	* @param[in] stream 項目
+	*/
+	const float* GetStream(ParticleStream stream) const
+	{
+		return m_Streams[stream].empty() == true ? nullptr : &m_Streams[stream][0];
+	}
+
+	/**
+	* @brief 設定の取得関数
+	* @retval const ParticleEmitterDesc& エミッターの設定
+	*/
+	const ParticleEmitterDesc& GetDesc() const
+	{
+		return m_Desc;
+	}
+
+	/**
+	* @brief 設定の解析関数
+	* @details 「キー=値」形式のデータを解析する(記述されていない項目はout_descの値のまま)
+	* @retval true 解析成功
+	* @retval false 解析失敗(値が数値ではない行がある)
+	* @param[in] data データの内容
+	* @param[in] size dataのバイト数
+	* @param[in,out] out_desc 解析結果
+	*/
+	static bool ParseDesc(const char* data, size_t size, ParticleEmitterDesc* out_desc);
+
+	/**
+	* @brief 設定ファイルの読み込み関数
+	* @retval true 読み込み成功
+	* @retval false 読み込み失敗
+	* @param[in] file_name ファイル名(パス込み)
+	* @param[out] out_desc 読み込んだ設定
+	*/
+	static bool LoadDesc(const char* file_name, ParticleEmitterDesc* out_desc);
+
+private:
+	/**
+	* @brief 0.0～1.0の乱数の取得関数
+	* @retval float 乱数
+	*/
+	float NextRandom();
+
+	/**
+	* @brief 範囲内の乱数の取得関数
+	* @retval float 乱数
+	* @param[in] min 最小値
+	* @param[in] max 最大値
+	*/
+	float RandomRange(float min, float max);
+
+private:
+	ParticleEmitterDesc m_Desc;								//!< エミッターの設定
+	std::vector<float> m_Streams[ParticleStreamMax];		//!< 項目ごとの配列
+	int m_Count;											//!< 存在しているパーティクル数
+	float m_PositionX;										//!< 発生位置X
+	float m_PositionY;										//!< 発生位置Y
+	float m_EmitAccumulator;								//!< 連続発生の端数
+	bool m_IsEmitting;										//!< 連続発生の有効フラグ
+	unsigned int m_RandomState;								//!< 乱数の状態
+};
+
+#endif
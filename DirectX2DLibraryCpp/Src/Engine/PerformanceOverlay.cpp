@@ -0,0 +1,184 @@
+﻿#include <stdio.h>
+#include "Graphics.h"
+#include "PerformanceOverlay.h"
+
+namespace
+{
+	const float OverlayX = 8.0f;				// オーバーレイの表示座標X
+	const float OverlayY = 8.0f;				// オーバーレイの表示座標Y
+	const float GraphWidth = 256.0f;			// グラフの横幅
+	const float GraphHeight = 64.0f;			// グラフの縦幅
+	const float GraphMaxTime = 50.0f;			// グラフの上端に対応するフレーム時間(ミリ秒)
+	const float TargetFrameTime = 1000.0f / 60.0f;	// 目安のフレーム時間(ミリ秒)
+	const float TextLineHeight = 16.0f;			// 文字列の行間
+
+	/**
+	* @brief 矩形の書き込み関数
+	* @details 指定された範囲の矩形を三角形リスト(6頂点)として書き込む
+	*/
+	void WriteRect(CustomVertex* out_vertices, float left, float top, float right, float bottom, DWORD color)
+	{
+		CustomVertex v[4] =
+		{
+			{ left, top, 0.0f, 1.0f, color, 0.0f, 0.0f },
+			{ right, top, 0.0f, 1.0f, color, 1.0f, 0.0f },
+			{ right, bottom, 0.0f, 1.0f, color, 1.0f, 1.0f },
+			{ left, bottom, 0.0f, 1.0f, color, 0.0f, 1.0f },
+		};
+
+		out_vertices[0] = v[0];
+		out_vertices[1] = v[1];
+		out_vertices[2] = v[2];
+		out_vertices[3] = v[0];
+		out_vertices[4] = v[2];
+		out_vertices[5] = v[3];
+	}
+}
+
+void FrameTimeHistory::Push(float frame_time)
+{
+	unsigned int count = m_WriteCount.load(std::memory_order_relaxed);
+	m_Values[count % FrameTimeHistorySize].store(frame_time, std::memory_order_relaxed);
+
+	// 値の書き込み後に総数を更新して読み込み側に公開する
+	m_WriteCount.store(count + 1, std::memory_order_release);
+}
+
+int FrameTimeHistory::Copy(float* out_values, int max_count) const
+{
+	unsigned int write_count = m_WriteCount.load(std::memory_order_acquire);
+
+	unsigned int count = write_count;
+	if (count > FrameTimeHistorySize)
+	{
+		count = FrameTimeHistorySize;
+	}
+	if (count > (unsigned int)max_count)
+	{
+		count = max_count;
+	}
+
+	unsigned int start = write_count - count;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		out_values[i] = m_Values[(start + i) % FrameTimeHistorySize].load(std::memory_order_relaxed);
+	}
+
+	return (int)count;
+}
+
+float FrameTimeHistory::GetLatest() const
+{
+	unsigned int write_count = m_WriteCount.load(std::memory_order_acquire);
+	if (write_count == 0)
+	{
+		return 0.0f;
+	}
+
+	return m_Values[(write_count - 1) % FrameTimeHistorySize].load(std::memory_order_relaxed);
+}
+
+void PerformanceOverlay::Draw(Graphics* graphics, const PerformanceOverlayInfo& info)
+{
+	if (m_IsVisible == false)
+	{
+		return;
+	}
+
+	// オーバーレイ自身の描画は統計に含めない
+	graphics->SuspendFrameStats();
+
+	// オーバーレイはカメラに関係なく画面座標で描画する
+	bool is_transform_enabled = graphics->IsTransformEnabled();
+	graphics->SetTransformEnabled(false);
+
+	float frame_times[FrameTimeHistorySize];
+	int count = m_FrameTimeHistory.Copy(frame_times, FrameTimeHistorySize);
+
+	float average_time = 0.0f;
+	for (int i = 0; i < count; i++)
+	{
+		average_time += frame_times[i];
+	}
+	if (count > 0)
+	{
+		average_time /= count;
+	}
+
+	float graph_y = OverlayY + TextLineHeight * 4.0f;
+
+	// グラフと文字列はテクスチャが異なるので、それぞれ1回のバッチで描画される
+	CustomVertex vertices[MaxOverlayVertexCount];
+	int vertex_count = BuildGraphVertices(frame_times, count, OverlayX, graph_y, GraphWidth, GraphHeight, GraphMaxTime, vertices);
+	graphics->DrawTriangles(nullptr, vertices, vertex_count);
+
+	char text[128];
+
+	sprintf_s(text, sizeof(text), "FPS:%.1f Frame:%.2fms", average_time > 0.0f ? 1000.0f / average_time : 0.0f, m_FrameTimeHistory.GetLatest());
+	graphics->DrawFont(OverlayX, OverlayY, text, FontSize::Small, FontColor::White);
+
+	sprintf_s(text, sizeof(text), "DrawCall:%d Vertex:%d Culled:%d", info.Stats.DrawCallCount, info.Stats.VertexCount, info.Stats.CulledCount);
+	graphics->DrawFont(OverlayX, OverlayY + TextLineHeight, text, FontSize::Small, FontColor::White);
+
+	sprintf_s(text, sizeof(text), "Voice:%d TextCache:%.0f%%", info.VoiceCount, info.Stats.GetTextLayoutHitRate() * 100.0f);
+	graphics->DrawFont(OverlayX, OverlayY + TextLineHeight * 2.0f, text, FontSize::Small, FontColor::White);
+
+	sprintf_s(text, sizeof(text), "Texture:%.2fMB FrameMem:%.0fKB", info.TextureMemorySize / (1024.0f * 1024.0f), info.FrameMemorySize / 1024.0f);
+	graphics->DrawFont(OverlayX, OverlayY + TextLineHeight * 3.0f, text, FontSize::Small, FontColor::White);
+
+	graphics->SetTransformEnabled(is_transform_enabled);
+	graphics->ResumeFrameStats();
+}
+
+int PerformanceOverlay::BuildGraphVertices(const float* frame_times, int count, float x, float y, float width, float height, float max_time, CustomVertex* out_vertices)
+{
+	if (count > FrameTimeHistorySize)
+	{
+		count = FrameTimeHistorySize;
+	}
+
+	int vertex_count = 0;
+	float bottom = y + height;
+
+	// 背景
+	WriteRect(&out_vertices[vertex_count], x, y, x + width, bottom, D3DCOLOR_ARGB(160, 0, 0, 0));
+	vertex_count += 6;
+
+	// フレーム時間の棒グラフ(右端が最新)
+	float bar_width = width / FrameTimeHistorySize;
+	float left = x + width - bar_width * count;
+
+	for (int i = 0; i < count; i++)
+	{
+		float time = frame_times[i];
+		if (time > max_time)
+		{
+			time = max_time;
+		}
+		if (time < 0.0f)
+		{
+			time = 0.0f;
+		}
+
+		DWORD color = D3DCOLOR_ARGB(255, 0, 255, 0);
+		if (frame_times[i] > TargetFrameTime * 2.0f)
+		{
+			color = D3DCOLOR_ARGB(255, 255, 0, 0);
+		}
+		else if (frame_times[i] > TargetFrameTime)
+		{
+			color = D3DCOLOR_ARGB(255, 255, 255, 0);
+		}
+
+		float bar_left = left + bar_width * i;
+		WriteRect(&out_vertices[vertex_count], bar_left, bottom - height * (time / max_time), bar_left + bar_width, bottom, color);
+		vertex_count += 6;
+	}
+
+	// 目安線(60FPS)
+	float target_y = bottom - height * (TargetFrameTime / max_time);
+	WriteRect(&out_vertices[vertex_count], x, target_y, x + width, target_y + 1.0f, D3DCOLOR_ARGB(200, 255, 255, 255));
+	vertex_count += 6;
+
+	return vertex_count;
+}
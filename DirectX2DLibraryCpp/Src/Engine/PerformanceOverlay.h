@@ -0,0 +1,146 @@
+﻿/**
+* @file PerformanceOverlay.h
+* @brief <pre>
+* パフォーマンス情報(フレーム時間のグラフ、FPS、描画命令数など)を画面に表示するクラスの宣言
+* Engineクラスでインスタンスを作成するので使用者が作成する必要はない
+* </pre>
+*/
+#ifndef PERFORMANCE_OVERLAY_H_
+#define PERFORMANCE_OVERLAY_H_
+
+#include <atomic>
+#include "EngineConstant.h"
+#include "FrameStats.h"
+
+class Graphics;
+
+const int FrameTimeHistorySize = 128;								//!< グラフに表示するフレーム数
+const int MaxOverlayVertexCount = (FrameTimeHistorySize + 2) * 6;	//!< グラフの最大頂点数
+
+/**
+* @brief フレーム時間の履歴クラス
+* @details <pre>
+* 固定長のリングバッファで、書き込みは1スレッド、読み込みは任意のスレッドからロックなしで行える
+* </pre>
+*/
+class FrameTimeHistory
+{
+public:
+	/** Constructor */
+	FrameTimeHistory() :
+		m_WriteCount(0)
+	{
+		for (auto& value : m_Values)
+		{
+			value.store(0.0f, std::memory_order_relaxed);
+		}
+	}
+
+	/**
+	* @brief 履歴追加関数
+	* @param[in] frame_time フレーム時間(ミリ秒)
+	*/
+	void Push(float frame_time);
+
+	/**
+	* @brief 履歴のコピー関数
+	* @details 古い順に最大max_count個の履歴をコピーする
+	* @retval int コピーした数
+	* @param[out] out_values コピー先
+	* @param[in] max_count コピー先の要素数
+	*/
+	int Copy(float* out_values, int max_count) const;
+
+	/**
+	* @brief 最新値の取得関数
+	* @retval float 最後に追加されたフレーム時間(履歴がない場合は0)
+	*/
+	float GetLatest() const;
+
+private:
+	std::atomic<float> m_Values[FrameTimeHistorySize];	//!< フレーム時間
+	std::atomic<unsigned int> m_WriteCount;				//!< 書き込み済みの総数
+};
+
+/** @brief オーバーレイに表示する情報 */
+struct PerformanceOverlayInfo
+{
+	FrameStats Stats;					//!< 描画統計
+	int VoiceCount;						//!< 再生中のサウンド数
+	unsigned int TextureMemorySize;		//!< テクスチャの使用メモリ(バイト)
+	size_t FrameMemorySize;				//!< 前のフレームで確保したフレームメモリ(バイト)
+};
+
+/** @brief パフォーマンスオーバーレイクラス */
+class PerformanceOverlay
+{
+public:
+	/** Constructor */
+	PerformanceOverlay() :
+		m_IsVisible(false)
+	{
+	}
+
+	/**
+	* @brief フレーム時間の追加関数
+	* @param[in] frame_time フレーム時間(ミリ秒)
+	*/
+	void PushFrameTime(float frame_time)
+	{
+		m_FrameTimeHistory.Push(frame_time);
+	}
+
+	/**
+	* @brief 表示設定関数
+	* @param[in] is_visible 表示する場合はtrue
+	*/
+	void SetVisible(bool is_visible)
+	{
+		m_IsVisible = is_visible;
+	}
+
+	/**
+	* @brief 表示状態の取得関数
+	* @retval true 表示する
+	* @retval false 表示しない
+	*/
+	bool IsVisible() const
+	{
+		return m_IsVisible;
+	}
+
+	/**
+	* @brief 描画関数
+	* @details <pre>
+	* グラフと文字列をそれぞれ1回のバッチで描画する
+	* 描画は描画統計に含めないので、表示している数値には影響しない
+	* </pre>
+	* @param[in] graphics 描画に使用するGraphics
+	* @param[in] info 表示する情報
+	*/
+	void Draw(Graphics* graphics, const PerformanceOverlayInfo& info);
+
+	/**
+	* @brief グラフの頂点作成関数
+	* @details <pre>
+	* 背景、目安線(60FPS)、フレーム時間の棒グラフを三角形リストとして作成する
+	* デバイスを使用しないので描画環境がなくても実行できる
+	* </pre>
+	* @retval int 作成した頂点数
+	* @param[in] frame_times フレーム時間(古い順)
+	* @param[in] count フレーム時間の数(FrameTimeHistorySize以下)
+	* @param[in] x グラフの左上座標X
+	* @param[in] y グラフの左上座標Y
+	* @param[in] width グラフの横幅
+	* @param[in] height グラフの縦幅
+	* @param[in] max_time グラフの上端に対応するフレーム時間(ミリ秒)
+	* @param[out] out_vertices 頂点の書き込み先(MaxOverlayVertexCount以上の要素数が必要)
+	*/
+	static int BuildGraphVertices(const float* frame_times, int count, float x, float y, float width, float height, float max_time, CustomVertex* out_vertices);
+
+private:
+	FrameTimeHistory m_FrameTimeHistory;	//!< フレーム時間の履歴
+	bool m_IsVisible;						//!< 表示フラグ
+};
+
+#endif
@@ -0,0 +1,339 @@
+﻿#include <stdio.h>
+#include "Profiler.h"
+
+#ifdef ENABLE_PROFILER
+
+namespace
+{
+	// スレッド毎のリングバッファ(ヒープを使わないよう静的に確保する)
+	ProfileThreadBuffer g_ThreadBufferList[MaxProfileThreads];
+	std::atomic<LONG> g_ThreadBufferCount(0);				// 1度でも割り当てたバッファの数(集計側が走査する範囲)
+	std::atomic<bool> g_IsThreadOverflowReported(false);
+	thread_local ProfileThreadBuffer* g_CurrentThreadBuffer = nullptr;
+	thread_local bool g_IsRegisteredThread = false;
+
+	// 直前のフレームの集計結果
+	ProfileZoneStat g_FrameZoneStats[MaxProfileZoneStats];
+	int g_FrameZoneStatCount = 0;
+
+	/** @brief スレッドの終了時にリングバッファを返却するクラス */
+	class ProfileThreadRegistration
+	{
+	public:
+		/** Constructor */
+		ProfileThreadRegistration() :
+			Buffer(nullptr)
+		{
+		}
+
+		/** Destructor */
+		~ProfileThreadRegistration()
+		{
+			if (Buffer == nullptr)
+			{
+				return;
+			}
+
+			// 終了処理中の区間で登録し直さないように、登録済みのまま計測だけを止める
+			g_CurrentThreadBuffer = nullptr;
+			Buffer->IsUsed.store(false, std::memory_order_release);
+		}
+
+		ProfileThreadBuffer* Buffer;	//!< 返却するリングバッファ
+	};
+
+	/**
+	* @brief カウンタ値の取得関数
+	* @retval LONGLONG 現在のカウンタ値
+	*/
+	LONGLONG GetCounter()
+	{
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter(&counter);
+		return counter.QuadPart;
+	}
+
+	/**
+	* @brief 計測結果の読み込み関数
+	* @details <pre>
+	* 持ち主のスレッドが書き込み中のリングバッファから計測結果を複製する
+	* 複製した後にWriteCountを読み直し、持ち主が同じ位置を書き換え始めていた場合は失敗にする
+	* (EndZoneは書き込み前にreleaseフェンスを置くので、書き換え中の値を読んだ場合はindex + リングバッファサイズ以上の総数が見える)
+	* </pre>
+	* @retval true 読み込み成功
+	* @retval false 読み込み中に上書きされた
+	* @param[in] buffer リングバッファ
+	* @param[in] index 読み込む計測結果の番号(書き込み済みの総数未満)
+	* @param[out] out_sample 計測結果
+	*/
+	bool ReadSample(const ProfileThreadBuffer* buffer, LONG index, ProfileSample* out_sample)
+	{
+		*out_sample = buffer->Samples[index % ProfileRingBufferSize];
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		return buffer->WriteCount.load(std::memory_order_relaxed) - index < ProfileRingBufferSize;
+	}
+
+	/**
+	* @brief JSON文字列の出力関数
+	* @details 区間名に含まれる「"」「\」と制御文字をエスケープして、前後の「"」と共に出力する
+	* @param[in] fp 出力先
+	* @param[in] text 出力する文字列
+	*/
+	void WriteJsonString(FILE* fp, const char* text)
+	{
+		fputc('"', fp);
+
+		for (const unsigned char* c = (const unsigned char*)text; *c != '\0'; c++)
+		{
+			if (*c == '"' || *c == '\\')
+			{
+				fputc('\\', fp);
+				fputc(*c, fp);
+			}
+			else if (*c < 0x20)
+			{
+				fprintf(fp, "\\u%04x", *c);
+			}
+			else
+			{
+				fputc(*c, fp);
+			}
+		}
+
+		fputc('"', fp);
+	}
+
+	/**
+	* @brief カウンタ周波数の取得関数
+	* @retval double 1秒あたりのカウント数
+	*/
+	double GetFrequency()
+	{
+		static double frequency = 0.0;
+		if (frequency == 0.0)
+		{
+			LARGE_INTEGER value;
+			QueryPerformanceFrequency(&value);
+			frequency = (double)value.QuadPart;
+		}
+		return frequency;
+	}
+}
+
+LONGLONG Profiler::BeginZone()
+{
+	ProfileThreadBuffer* buffer = GetThreadBuffer();
+	if (buffer != nullptr)
+	{
+		buffer->CurrentDepth++;
+	}
+
+	return GetCounter();
+}
+
+void Profiler::EndZone(const char* name, LONGLONG start)
+{
+	LONGLONG end = GetCounter();
+
+	ProfileThreadBuffer* buffer = GetThreadBuffer();
+	if (buffer == nullptr)
+	{
+		return;
+	}
+
+	buffer->CurrentDepth--;
+
+	LONG count = buffer->WriteCount.load(std::memory_order_relaxed);
+
+	// 上書きする位置を読み込んでいるスレッドが、読み込み後にcount以上の総数を必ず見るようにする
+	std::atomic_thread_fence(std::memory_order_release);
+
+	ProfileSample& sample = buffer->Samples[count % ProfileRingBufferSize];
+	sample.Name = name;
+	sample.Start = start;
+	sample.End = end;
+	sample.Depth = buffer->CurrentDepth;
+
+	// 書き込み完了後に総数を更新して集計側に公開する
+	buffer->WriteCount.store(count + 1, std::memory_order_release);
+}
+
+void Profiler::NextFrame()
+{
+	double to_milliseconds = 1000.0 / GetFrequency();
+
+	g_FrameZoneStatCount = 0;
+
+	LONG thread_count = g_ThreadBufferCount.load(std::memory_order_acquire);
+
+	for (int i = 0; i < thread_count; i++)
+	{
+		ProfileThreadBuffer* buffer = &g_ThreadBufferList[i];
+		if (buffer->ThreadId.load(std::memory_order_acquire) == 0)
+		{
+			continue;
+		}
+
+		LONG write_count = buffer->WriteCount.load(std::memory_order_acquire);
+
+		// 上書きされた計測結果は集計しない
+		LONG read_count = buffer->ReadCount;
+		if (write_count - read_count > ProfileRingBufferSize)
+		{
+			read_count = write_count - ProfileRingBufferSize;
+		}
+
+		for (LONG j = read_count; j < write_count; j++)
+		{
+			ProfileSample sample;
+			if (ReadSample(buffer, j, &sample) == false)
+			{
+				continue;
+			}
+
+			ProfileZoneStat* stat = nullptr;
+			for (int k = 0; k < g_FrameZoneStatCount; k++)
+			{
+				if (g_FrameZoneStats[k].Name == sample.Name &&
+					g_FrameZoneStats[k].Depth == sample.Depth)
+				{
+					stat = &g_FrameZoneStats[k];
+					break;
+				}
+			}
+
+			if (stat == nullptr)
+			{
+				if (g_FrameZoneStatCount >= MaxProfileZoneStats)
+				{
+					continue;
+				}
+
+				stat = &g_FrameZoneStats[g_FrameZoneStatCount++];
+				stat->Name = sample.Name;
+				stat->Depth = sample.Depth;
+				stat->CallCount = 0;
+				stat->TotalTime = 0.0;
+			}
+
+			stat->CallCount++;
+			stat->TotalTime += (sample.End - sample.Start) * to_milliseconds;
+		}
+
+		buffer->ReadCount = write_count;
+	}
+}
+
+const ProfileZoneStat* Profiler::GetFrameZoneStats(int* out_count)
+{
+	if (out_count != nullptr)
+	{
+		*out_count = g_FrameZoneStatCount;
+	}
+
+	return g_FrameZoneStats;
+}
+
+bool Profiler::WriteChromeTrace(const char* file_name)
+{
+	FILE* fp = nullptr;
+	if (fopen_s(&fp, file_name, "w") != 0 || fp == nullptr)
+	{
+		return false;
+	}
+
+	double to_microseconds = 1000000.0 / GetFrequency();
+	bool is_first = true;
+
+	fprintf(fp, "{\"traceEvents\":[\n");
+
+	LONG thread_count = g_ThreadBufferCount.load(std::memory_order_acquire);
+
+	for (int i = 0; i < thread_count; i++)
+	{
+		ProfileThreadBuffer* buffer = &g_ThreadBufferList[i];
+		DWORD thread_id = buffer->ThreadId.load(std::memory_order_acquire);
+		if (thread_id == 0)
+		{
+			continue;
+		}
+
+		LONG write_count = buffer->WriteCount.load(std::memory_order_acquire);
+		LONG start_count = write_count > ProfileRingBufferSize ? write_count - ProfileRingBufferSize : 0;
+
+		for (LONG j = start_count; j < write_count; j++)
+		{
+			ProfileSample sample;
+			if (ReadSample(buffer, j, &sample) == false)
+			{
+				continue;
+			}
+
+			fprintf(fp, "%s{\"name\":", is_first ? "" : ",\n");
+			WriteJsonString(fp, sample.Name);
+			fprintf(fp,
+				",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%lu}",
+				sample.Start * to_microseconds,
+				(sample.End - sample.Start) * to_microseconds,
+				(unsigned long)thread_id);
+
+			is_first = false;
+		}
+	}
+
+	fprintf(fp, "\n]}\n");
+	fclose(fp);
+
+	return true;
+}
+
+ProfileThreadBuffer* Profiler::GetThreadBuffer()
+{
+	if (g_IsRegisteredThread == true)
+	{
+		return g_CurrentThreadBuffer;
+	}
+	g_IsRegisteredThread = true;
+
+	// 終了したスレッドが返却したバッファを含めて、空いている最初のバッファを使用する
+	int id = 0;
+	for (; id < MaxProfileThreads; id++)
+	{
+		bool is_used = false;
+		if (g_ThreadBufferList[id].IsUsed.compare_exchange_strong(is_used, true, std::memory_order_acquire) == true)
+		{
+			break;
+		}
+	}
+
+	if (id >= MaxProfileThreads)
+	{
+		// 空きがないスレッドの区間は記録されないので、計測結果が欠けていることが分かるようにする
+		if (g_IsThreadOverflowReported.exchange(true) == false)
+		{
+			OutputDebugString("Profiler: too many threads, zones on additional threads are not recorded\n");
+		}
+		return nullptr;
+	}
+
+	// 返却されたバッファのWriteCountは続きから使用するので、集計側は前のスレッドの残りも読み込める
+	// スレッドIDは集計側が登録済みかを判定するので、走査範囲を広げる前に公開する
+	ProfileThreadBuffer* buffer = &g_ThreadBufferList[id];
+	buffer->CurrentDepth = 0;
+	buffer->ThreadId.store(GetCurrentThreadId(), std::memory_order_release);
+
+	LONG thread_count = g_ThreadBufferCount.load(std::memory_order_relaxed);
+	while (thread_count <= id && g_ThreadBufferCount.compare_exchange_weak(thread_count, id + 1, std::memory_order_release) == false)
+	{
+	}
+
+	g_CurrentThreadBuffer = buffer;
+
+	thread_local ProfileThreadRegistration registration;
+	registration.Buffer = buffer;
+
+	return buffer;
+}
+
+#endif
@@ -0,0 +1,158 @@
+﻿/**
+* @file Profiler.h
+* @brief <pre>
+* フレームプロファイラの宣言
+* PROFILE_SCOPE、PROFILE_FUNCTIONで囲んだ区間の処理時間をスレッド毎のリングバッファに記録する
+* ENABLE_PROFILERが定義されていない場合、計測マクロは空になり何もコンパイルされない
+* </pre>
+*/
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <Windows.h>
+#include <atomic>
+
+const int ProfileRingBufferSize = 4096;	//!< スレッド毎に保持できる計測結果の最大数
+const int MaxProfileThreads = 48;		//!< 同時に計測できるスレッドの最大数(終了したスレッドの分は再利用する)
+const int MaxProfileZoneStats = 64;		//!< 1フレームで集計できる区間の最大数
+
+/** @brief 1区間分の計測結果 */
+struct ProfileSample
+{
+	const char* Name;	//!< 区間名
+	LONGLONG Start;		//!< 開始時間(カウンタ値)
+	LONGLONG End;		//!< 終了時間(カウンタ値)
+	int Depth;			//!< 区間の階層
+};
+
+/** @brief 1フレーム分の区間毎の集計結果 */
+struct ProfileZoneStat
+{
+	const char* Name;	//!< 区間名
+	int Depth;			//!< 区間の階層
+	int CallCount;		//!< 呼び出し回数
+	double TotalTime;	//!< 合計時間(ミリ秒)
+};
+
+#ifdef ENABLE_PROFILER
+
+/**
+* @brief スレッド毎の計測結果保存用リングバッファ
+* @details <pre>
+* 書き込みは持ち主のスレッドだけが行い、集計とトレース出力は別のスレッドから読み込む
+* 読み込み中に持ち主が1周して同じ位置を書き換えることがあるので、
+* 読み込んだ後にWriteCountを確認し、書き換えられた可能性がある計測結果は破棄する
+* スレッドの終了時に返却し、次に登録したスレッドが続きから書き込む(WriteCountは戻さない)
+* </pre>
+*/
+struct ProfileThreadBuffer
+{
+	ProfileSample Samples[ProfileRingBufferSize];	//!< 計測結果
+	std::atomic<LONG> WriteCount;					//!< 書き込み済みの総数(計測結果を書き込んだ後に更新して公開する)
+	LONG ReadCount;									//!< 集計済みの総数(NextFrameを実行するスレッドだけが使用する)
+	int CurrentDepth;								//!< 現在の区間の階層(持ち主のスレッドだけが使用する)
+	std::atomic<DWORD> ThreadId;					//!< 最後に割り当てたスレッドのID(1度も割り当てていない場合は0)
+	std::atomic<bool> IsUsed;						//!< スレッドに割り当て中か
+};
+
+/** @brief フレームプロファイラクラス */
+class Profiler
+{
+public:
+	/**
+	* @brief 区間開始関数
+	* @details 実行スレッドの階層を1段深くし、開始時間を返す
+	* @retval LONGLONG 開始時間(カウンタ値)
+	*/
+	static LONGLONG BeginZone();
+
+	/**
+	* @brief 区間終了関数
+	* @details 実行スレッドのリングバッファに計測結果を書き込む
+	* @param[in] name 区間名(文字列リテラルを指定すること)
+	* @param[in] start BeginZoneで取得した開始時間
+	*/
+	static void EndZone(const char* name, LONGLONG start);
+
+	/**
+	* @brief フレーム更新関数
+	* @details <pre>
+	* 前回の呼び出しから記録された計測結果を区間毎に集計する
+	* 毎フレーム1度だけ実行する
+	* </pre>
+	*/
+	static void NextFrame();
+
+	/**
+	* @brief 集計結果の取得関数
+	* @details 直前のフレームの区間毎の集計結果を返す
+	* @retval const ProfileZoneStat* 集計結果の配列
+	* @param[out] out_count 集計結果の数
+	*/
+	static const ProfileZoneStat* GetFrameZoneStats(int* out_count);
+
+	/**
+	* @brief トレース出力関数
+	* @details <pre>
+	* リングバッファに残っている計測結果をChromeのトレースイベント形式(JSON)で出力する
+	* 出力したファイルはchrome://tracingで確認できる
+	* </pre>
+	* @retval true 出力成功
+	* @retval false 出力失敗
+	* @param[in] file_name 出力ファイル名
+	*/
+	static bool WriteChromeTrace(const char* file_name);
+
+private:
+	/**
+	* @brief リングバッファの取得関数
+	* @details <pre>
+	* 実行スレッドのリングバッファを返す、初回実行時に空いているバッファを登録する
+	* 登録したバッファはスレッドの終了時に返却する
+	* 空いているバッファがないスレッドは計測しない(最初の1回だけデバッグ出力に警告を出力する)
+	* </pre>
+	* @retval ProfileThreadBuffer* リングバッファ(登録数超過時はnullptr)
+	*/
+	static ProfileThreadBuffer* GetThreadBuffer();
+};
+
+/** @brief スコープを抜けるまでの時間を計測するクラス */
+class ScopedProfileZone
+{
+public:
+	/**
+	* @brief Constructor
+	* @param[in] name 区間名(文字列リテラルを指定すること)
+	*/
+	explicit ScopedProfileZone(const char* name) :
+		m_Name(name),
+		m_Start(Profiler::BeginZone())
+	{
+	}
+
+	/** Destructor */
+	~ScopedProfileZone()
+	{
+		Profiler::EndZone(m_Name, m_Start);
+	}
+
+private:
+	const char* m_Name;	//!< 区間名
+	LONGLONG m_Start;	//!< 開始時間
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ScopedProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)	//!< スコープ計測マクロ
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)											//!< 関数計測マクロ
+#define PROFILE_NEXT_FRAME() Profiler::NextFrame()												//!< フレーム更新マクロ
+
+#else
+
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_NEXT_FRAME()
+
+#endif
+
+#endif
@@ -0,0 +1,39 @@
+﻿#include "RecordingRenderBackend.h"
+
+bool RecordingRenderBackend::BeginFrame(DWORD color)
+{
+	// 容量は残したまま前フレームの記録を破棄する
+	m_CommandList.clear();
+	m_VertexList.clear();
+	m_CurrentTexture = nullptr;
+	m_CurrentFilter = TextureFilterPoint;
+
+	return true;
+}
+
+void RecordingRenderBackend::EndFrame()
+{
+	m_FrameCount++;
+}
+
+void RecordingRenderBackend::SetTexture(const Texture* texture)
+{
+	m_CurrentTexture = texture;
+}
+
+void RecordingRenderBackend::SetTextureFilter(TextureFilter filter)
+{
+	m_CurrentFilter = filter;
+}
+
+void RecordingRenderBackend::DrawTriangleList(const CustomVertex* vertices, int vertex_count)
+{
+	RecordedCommand command;
+	command.TextureData = m_CurrentTexture;
+	command.Filter = m_CurrentFilter;
+	command.FirstVertex = (int)m_VertexList.size();
+	command.VertexCount = vertex_count;
+
+	m_VertexList.insert(m_VertexList.end(), vertices, vertices + vertex_count);
+	m_CommandList.push_back(command);
+}
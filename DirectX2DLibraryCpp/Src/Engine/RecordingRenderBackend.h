@@ -0,0 +1,86 @@
+﻿/**
+* @file RecordingRenderBackend.h
+* @brief <pre>
+* 描画命令と頂点データを記録する描画バックエンドの宣言
+* GPUなしで描画結果(頂点の座標、UV、カラー)を確認、比較するために使用する
+* Graphicsクラスでインスタンスを作成するので使用者が作成する必要はない
+* </pre>
+*/
+#ifndef RECORDING_RENDER_BACKEND_H_
+#define RECORDING_RENDER_BACKEND_H_
+
+#include <vector>
+#include "NullRenderBackend.h"
+
+/** @brief 記録された描画命令(三角形リストの描画) */
+struct RecordedCommand
+{
+	const Texture* TextureData;		//!< 使用したテクスチャ
+	TextureFilter Filter;			//!< 使用したフィルタリング
+	int FirstVertex;				//!< 頂点データの開始位置
+	int VertexCount;				//!< 頂点数
+};
+
+/** @brief 記録描画バックエンドクラス */
+class RecordingRenderBackend : public NullRenderBackend
+{
+public:
+	/** Constructor */
+	RecordingRenderBackend() :
+		m_CurrentTexture(nullptr),
+		m_CurrentFilter(TextureFilterPoint),
+		m_FrameCount(0)
+	{
+	}
+
+	virtual RenderBackendType GetType() const override
+	{
+		return RenderBackendType::RenderBackendTypeRecording;
+	}
+
+	/**
+	* @brief フレーム開始関数
+	* @details 前のフレームで記録した内容を破棄する
+	*/
+	virtual bool BeginFrame(DWORD color) override;
+	virtual void EndFrame() override;
+	virtual void SetTexture(const Texture* texture) override;
+	virtual void SetTextureFilter(TextureFilter filter) override;
+	virtual void DrawTriangleList(const CustomVertex* vertices, int vertex_count) override;
+
+	/**
+	* @brief 記録された命令の取得関数
+	* @retval const std::vector<RecordedCommand>& 現在のフレームで記録された命令
+	*/
+	const std::vector<RecordedCommand>& GetCommands() const
+	{
+		return m_CommandList;
+	}
+
+	/**
+	* @brief 記録された頂点データの取得関数
+	* @retval const std::vector<CustomVertex>& 現在のフレームで記録された頂点データ
+	*/
+	const std::vector<CustomVertex>& GetVertices() const
+	{
+		return m_VertexList;
+	}
+
+	/**
+	* @brief 終了したフレーム数の取得関数
+	* @retval int EndFrameが実行された回数
+	*/
+	int GetFrameCount() const
+	{
+		return m_FrameCount;
+	}
+
+private:
+	std::vector<RecordedCommand> m_CommandList;	//!< 記録された命令
+	std::vector<CustomVertex> m_VertexList;		//!< 記録された頂点データ
+	const Texture* m_CurrentTexture;			//!< 設定中のテクスチャ
+	TextureFilter m_CurrentFilter;				//!< 設定中のフィルタリング
+	int m_FrameCount;							//!< 終了したフレーム数
+};
+
+#endif
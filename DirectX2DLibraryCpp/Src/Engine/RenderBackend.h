@@ -0,0 +1,188 @@
+﻿/**
+* @file RenderBackend.h
+* @brief <pre>
+* 描画バックエンドのインターフェースの宣言
+* Graphicsクラスは頂点の作成やバッチ処理を行い、デバイスへの送信はバックエンドに任せる
+* Graphicsクラスでインスタンスを作成するので使用者が作成する必要はない
+* </pre>
+*/
+#ifndef RENDER_BACKEND_H_
+#define RENDER_BACKEND_H_
+
+#include <vector>
+#include "EngineConstant.h"
+
+/** @brief 描画バックエンドの種類 */
+enum RenderBackendType
+{
+	RenderBackendTypeD3D9,		//!< DirectGraphics(Direct3D9)で描画する
+	RenderBackendTypeNull,		//!< 何も描画しない(GPUなしで描画処理を実行する)
+	RenderBackendTypeRecording,	//!< 描画命令と頂点データを記録する
+	RenderBackendTypeSoftware,	//!< CPUでラスタライズする(描画結果を画像で保存、比較できる)
+	RenderBackendTypeMax,		//!< 種類の最大数
+};
+
+/** @brief 描画バックエンドのインターフェース */
+class RenderBackend
+{
+public:
+	/** Destructor */
+	virtual ~RenderBackend() {}
+
+	/**
+	* @brief 初期化関数
+	* @retval true 初期化成功
+	* @retval false 初期化失敗
+	* @param[in] width バックバッファの横幅
+	* @param[in] height バックバッファの縦幅
+	* @param[in] is_window_mode ウィンドウ or Fullスクリーン設定フラグ
+	*/
+	virtual bool Initialize(int width, int height, bool is_window_mode) = 0;
+
+	/**
+	* @brief 解放関数
+	*/
+	virtual void Release() = 0;
+
+	/**
+	* @brief 種類の取得関数
+	* @retval RenderBackendType バックエンドの種類
+	*/
+	virtual RenderBackendType GetType() const = 0;
+
+	/**
+	* @brief フレーム開始関数
+	* @details バックバッファのクリアと描画開始を行う
+	* @retval true 開始成功
+	* @retval false 開始失敗
+	* @param[in] color クリアカラー
+	*/
+	virtual bool BeginFrame(DWORD color) = 0;
+
+	/**
+	* @brief フレーム終了関数
+	* @details 描画を終了し、バックバッファを表示する
+	*/
+	virtual void EndFrame() = 0;
+
+	/**
+	* @brief 頂点構造設定関数
+	* @details CustomVertexの頂点構造を設定する
+	*/
+	virtual void SetVertexFormat() = 0;
+
+	/**
+	* @brief テクスチャ設定関数
+	* @param[in] texture 設定するテクスチャ(テクスチャなしの場合はnullptr)
+	*/
+	virtual void SetTexture(const Texture* texture) = 0;
+
+	/**
+	* @brief テクスチャのフィルタリング設定関数
+	* @param[in] filter 以降の描画で使用するフィルタリング
+	*/
+	virtual void SetTextureFilter(TextureFilter filter) = 0;
+
+	/**
+	* @brief 三角形リスト描画関数
+	* @param[in] vertices 頂点データ
+	* @param[in] vertex_count 頂点数(3の倍数)
+	*/
+	virtual void DrawTriangleList(const CustomVertex* vertices, int vertex_count) = 0;
+
+	/**
+	* @brief テクスチャ作成関数
+	* @retval true 作成成功
+	* @retval false 作成失敗
+	* @param[in] file_name 読み込むテクスチャの名前(パス込み)
+	* @param[out] texture_data 読み込まれたテクスチャを反映するデータ
+	*/
+	virtual bool CreateTexture(const char* file_name, Texture* texture_data) = 0;
+
+	/**
+	* @brief テクスチャのデコード関数
+	* @details <pre>
+	* 画像ファイルをCreateTextureと同じカラーキーを適用したA8R8G8B8のピクセルにデコードする
+	* テクスチャキャッシュに保存するピクセルの作成に使用する
+	* </pre>
+	* @retval true デコード成功
+	* @retval false デコード失敗(デコードできないバックエンドの場合も含む)
+	* @param[in] file_name 読み込む画像ファイルの名前(パス込み)
+	* @param[out] out_width 横幅
+	* @param[out] out_height 縦幅
+	* @param[out] out_pixels デコードしたピクセル(1行の要素数は横幅)
+	*/
+	virtual bool DecodeTexture(const char* file_name, int* out_width, int* out_height, std::vector<DWORD>* out_pixels) = 0;
+
+	/**
+	* @brief メモリ上の画像ファイルからのテクスチャ作成関数
+	* @details アーカイブから読み込んだ画像ファイルの内容からCreateTextureと同じテクスチャを作成する
+	* @retval true 作成成功
+	* @retval false 作成失敗
+	* @param[in] data 画像ファイルの内容
+	* @param[in] size 画像ファイルのバイト数
+	* @param[out] texture_data 読み込まれたテクスチャを反映するデータ
+	*/
+	virtual bool CreateTextureFromMemory(const void* data, size_t size, Texture* texture_data) = 0;
+
+	/**
+	* @brief メモリ上の画像ファイルのデコード関数
+	* @details DecodeTextureのメモリ版
+	* @retval true デコード成功
+	* @retval false デコード失敗(デコードできないバックエンドの場合も含む)
+	* @param[in] data 画像ファイルの内容
+	* @param[in] size 画像ファイルのバイト数
+	* @param[out] out_width 横幅
+	* @param[out] out_height 縦幅
+	* @param[out] out_pixels デコードしたピクセル(1行の要素数は横幅)
+	*/
+	virtual bool DecodeTextureFromMemory(const void* data, size_t size, int* out_width, int* out_height, std::vector<DWORD>* out_pixels) = 0;
+
+	/**
+	* @brief 空のテクスチャ作成関数
+	* @details UpdateTextureで内容を書き込むためのテクスチャ(A8R8G8B8)を作成する
+	* @retval true 作成成功
+	* @retval false 作成失敗
+	* @param[in] width 横幅
+	* @param[in] height 縦幅
+	* @param[out] texture_data 作成したテクスチャを反映するデータ
+	*/
+	virtual bool CreateEmptyTexture(int width, int height, Texture* texture_data) = 0;
+
+	/**
+	* @brief ミップマップ付きテクスチャの作成関数
+	* @details 全てのレベルのテクセルを書き込んだテクスチャ(A8R8G8B8)を作成する
+	* @retval true 作成成功
+	* @retval false 作成失敗
+	* @param[in] width 最上位レベルの横幅
+	* @param[in] height 最上位レベルの縦幅
+	* @param[in] level_count レベル数
+	* @param[in] pixels MipmapGenerator::GenerateChainで作成した全レベルのテクセル
+	* @param[out] texture_data 作成したテクスチャを反映するデータ
+	*/
+	virtual bool CreateMipmappedTexture(int width, int height, int level_count, const DWORD* pixels, Texture* texture_data) = 0;
+
+	/**
+	* @brief テクスチャ更新関数
+	* @details CreateEmptyTextureで作成したテクスチャの指定範囲にピクセルを書き込む
+	* @retval true 更新成功
+	* @retval false 更新失敗
+	* @param[in] texture_data 更新するテクスチャ
+	* @param[in] x 書き込む範囲の左上座標X
+	* @param[in] y 書き込む範囲の左上座標Y
+	* @param[in] width 書き込む範囲の横幅
+	* @param[in] height 書き込む範囲の縦幅
+	* @param[in] pixels 書き込むピクセル(A8R8G8B8)
+	* @param[in] pitch pixelsの1行の要素数
+	*/
+	virtual bool UpdateTexture(Texture* texture_data, int x, int y, int width, int height, const DWORD* pixels, int pitch) = 0;
+
+	/**
+	* @brief バックバッファサイズの取得関数
+	* @param[out] out_width 横幅
+	* @param[out] out_height 縦幅
+	*/
+	virtual void GetBackBufferSize(int* out_width, int* out_height) const = 0;
+};
+
+#endif
@@ -0,0 +1,219 @@
+﻿#include <algorithm>
+#include "RenderThread.h"
+#include "Profiler.h"
+
+bool RenderFrameQueue::Push(RenderFrame* frame)
+{
+	unsigned int tail = m_Tail.load(std::memory_order_relaxed);
+	if (tail - m_Head.load(std::memory_order_acquire) >= (unsigned int)MaxRenderFramesInFlight)
+	{
+		return false;
+	}
+
+	m_Slots[tail & (MaxRenderFramesInFlight - 1)] = frame;
+
+	// フレームの書き込みが完了してから位置を公開する
+	m_Tail.store(tail + 1, std::memory_order_release);
+
+	return true;
+}
+
+bool RenderFrameQueue::Pop(RenderFrame** out_frame)
+{
+	unsigned int head = m_Head.load(std::memory_order_relaxed);
+	if (head == m_Tail.load(std::memory_order_acquire))
+	{
+		return false;
+	}
+
+	*out_frame = m_Slots[head & (MaxRenderFramesInFlight - 1)];
+
+	// 読み込みが完了してから位置を進める(進めた後はPush側が上書きできる)
+	m_Head.store(head + 1, std::memory_order_release);
+
+	return true;
+}
+
+bool RenderThread::Start(Graphics* graphics, PerformanceOverlay* overlay, int frame_count)
+{
+	if (m_IsRunning == true || graphics == nullptr)
+	{
+		return false;
+	}
+
+	// キューの待機はイベントで行う(受け渡し自体はキューで行い、イベントは眠っているスレッドを起こすだけに使う)
+	m_FrameSubmittedEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	m_FrameReleasedEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	if (m_FrameSubmittedEvent == nullptr || m_FrameReleasedEvent == nullptr)
+	{
+		Stop();
+		return false;
+	}
+
+	m_Graphics = graphics;
+	m_Overlay = overlay;
+	m_FrameCount = (std::min)((std::max)(frame_count, 1), MaxRenderFramesInFlight);
+	m_LastCamera = graphics->GetCamera();
+	m_CurrentFrame = nullptr;
+
+	for (int i = 0; i < m_FrameCount; i++)
+	{
+		m_FreeQueue.Push(&m_Frames[i]);
+	}
+
+	m_IsStopRequested = false;
+	m_Thread = std::thread(&RenderThread::Run, this);
+	m_IsRunning = true;
+
+	return true;
+}
+
+void RenderThread::Stop()
+{
+	if (m_IsRunning == true)
+	{
+		m_IsStopRequested = true;
+		SetEvent(m_FrameSubmittedEvent);
+
+		m_Thread.join();
+		m_IsRunning = false;
+	}
+
+	// 記録中のフレームは描画せずに破棄する
+	RenderFrame* frame = nullptr;
+	while (m_FreeQueue.Pop(&frame) == true)
+	{
+		frame->CommandList.Clear();
+	}
+	m_CurrentFrame = nullptr;
+
+	// 命令リストはタグ付きアロケーターで確保しているので、アロケーターの解放前に解放する
+	for (RenderFrame& render_frame : m_Frames)
+	{
+		render_frame.CommandList.Release();
+	}
+
+	if (m_FrameSubmittedEvent != nullptr)
+	{
+		CloseHandle(m_FrameSubmittedEvent);
+		m_FrameSubmittedEvent = nullptr;
+	}
+
+	if (m_FrameReleasedEvent != nullptr)
+	{
+		CloseHandle(m_FrameReleasedEvent);
+		m_FrameReleasedEvent = nullptr;
+	}
+}
+
+RenderFrame* RenderThread::BeginFrame()
+{
+	PROFILE_FUNCTION();
+
+	if (m_IsRunning == false)
+	{
+		return nullptr;
+	}
+
+	if (m_CurrentFrame != nullptr)
+	{
+		return m_CurrentFrame;
+	}
+
+	// 空きフレームがない場合は先行しすぎているので、描画スレッドがフレームを返すまで待つ
+	RenderFrame* frame = nullptr;
+	while (m_FreeQueue.Pop(&frame) == false)
+	{
+		WaitForSingleObject(m_FrameReleasedEvent, INFINITE);
+	}
+
+	frame->CommandList.Clear();
+	frame->Camera = m_LastCamera;
+	frame->IsOverlayVisible = false;
+	m_CurrentFrame = frame;
+
+	return frame;
+}
+
+void RenderThread::SubmitFrame()
+{
+	PROFILE_FUNCTION();
+
+	if (m_CurrentFrame == nullptr)
+	{
+		return;
+	}
+
+	m_LastCamera = m_CurrentFrame->Camera;
+
+	// フレーム数はキューの容量以下なので追加は必ず成功する
+	m_SubmitQueue.Push(m_CurrentFrame);
+	m_CurrentFrame = nullptr;
+
+	SetEvent(m_FrameSubmittedEvent);
+}
+
+void RenderThread::WaitIdle()
+{
+	PROFILE_FUNCTION();
+
+	if (m_IsRunning == false)
+	{
+		return;
+	}
+
+	// 記録中のフレーム以外が全て空きキューに戻るまで待つ
+	int expected_count = m_FrameCount - (m_CurrentFrame != nullptr ? 1 : 0);
+	while (m_FreeQueue.GetCount() < expected_count)
+	{
+		WaitForSingleObject(m_FrameReleasedEvent, INFINITE);
+	}
+}
+
+void RenderThread::Run()
+{
+	while (true)
+	{
+		RenderFrame* frame = nullptr;
+		if (m_SubmitQueue.Pop(&frame) == false)
+		{
+			// 停止要求があっても、追加済みのフレームを描画し終えるまでは終了しない
+			if (m_IsStopRequested == true)
+			{
+				break;
+			}
+
+			WaitForSingleObject(m_FrameSubmittedEvent, INFINITE);
+			continue;
+		}
+
+		DrawFrame(frame);
+
+		m_FreeQueue.Push(frame);
+		SetEvent(m_FrameReleasedEvent);
+	}
+}
+
+void RenderThread::DrawFrame(RenderFrame* frame)
+{
+	PROFILE_FUNCTION();
+
+	if (m_Graphics->StartDraw(frame->ClearColor) == false)
+	{
+		return;
+	}
+
+	const Camera2D& camera = frame->Camera;
+	m_Graphics->SetCamera(camera.Position.X, camera.Position.Y, camera.Zoom, camera.Angle);
+
+	m_Graphics->SubmitCommandList(frame->CommandList);
+
+	if (frame->IsOverlayVisible == true && m_Overlay != nullptr)
+	{
+		PerformanceOverlayInfo info = frame->OverlayInfo;
+		info.Stats = m_Graphics->GetFrameStats();
+		m_Overlay->Draw(m_Graphics, info);
+	}
+
+	m_Graphics->FinishDraw();
+}
@@ -0,0 +1,214 @@
+﻿/**
+* @file RenderThread.h
+* @brief <pre>
+* 描画専用スレッドと、ゲームスレッドから描画スレッドへフレームを受け渡すキューの宣言
+* ゲームスレッドはフレームNの命令リストを渡した直後にフレームN+1の処理を開始できる
+* 描画スレッドの使用中はGraphicsを描画スレッドだけが使用するので、ゲームスレッドはEngine::StartDrawingなどの描画関数を使用しない
+* </pre>
+*/
+#ifndef RENDER_THREAD_H_
+#define RENDER_THREAD_H_
+
+#include <Windows.h>
+#include <atomic>
+#include <thread>
+#include "DrawCommandList.h"
+#include "Graphics.h"
+#include "PerformanceOverlay.h"
+
+const int MaxRenderFramesInFlight = 4;		//!< 同時に処理中にできるフレームの最大数(2のべき乗)
+
+/** @brief 描画スレッドに渡す1フレーム分のデータ */
+struct RenderFrame
+{
+	/** Constructor */
+	RenderFrame() :
+		CommandList(),
+		ClearColor(0),
+		Camera(),
+		IsOverlayVisible(false),
+		OverlayInfo()
+	{
+	}
+
+	DrawCommandList CommandList;			//!< 描画命令
+	DWORD ClearColor;						//!< クリアカラー
+	Camera2D Camera;						//!< カメラ(前のフレームで設定した値が引き継がれる)
+	bool IsOverlayVisible;					//!< パフォーマンスオーバーレイを描画するか
+	PerformanceOverlayInfo OverlayInfo;		//!< オーバーレイの情報(描画統計は描画スレッドで設定する)
+};
+
+/**
+* @brief フレームの受け渡しキュー
+* @details <pre>
+* 1つのスレッドがPush、もう1つのスレッドがPopを行う固定長のリングバッファ
+* 読み書き位置はそれぞれ片方のスレッドしか更新しないので、ロックを使用せずにatomic変数だけで受け渡しを行う
+* </pre>
+*/
+class RenderFrameQueue
+{
+public:
+	/** Constructor */
+	RenderFrameQueue() :
+		m_Slots(),
+		m_Head(0),
+		m_HeadPadding(),
+		m_Tail(0)
+	{
+	}
+
+	/**
+	* @brief 追加関数
+	* @retval true 追加成功
+	* @retval false キューが一杯
+	* @param[in] frame 追加するフレーム
+	*/
+	bool Push(RenderFrame* frame);
+
+	/**
+	* @brief 取り出し関数
+	* @retval true 取り出し成功
+	* @retval false キューが空
+	* @param[out] out_frame 取り出したフレーム
+	*/
+	bool Pop(RenderFrame** out_frame);
+
+	/**
+	* @brief 要素数の取得関数
+	* @details 別スレッドが更新中の場合は取得した直後に変わっている可能性がある
+	* @retval int 要素数
+	*/
+	int GetCount() const
+	{
+		return (int)(m_Tail.load(std::memory_order_acquire) - m_Head.load(std::memory_order_acquire));
+	}
+
+private:
+	RenderFrame* m_Slots[MaxRenderFramesInFlight];		//!< フレームのリングバッファ
+	std::atomic<unsigned int> m_Head;					//!< 次に取り出す位置(Popを行うスレッドだけが更新する)
+	char m_HeadPadding[CacheLineSize];					//!< m_Headとm_Tailを別のキャッシュラインに置くための領域
+	std::atomic<unsigned int> m_Tail;					//!< 次に追加する位置(Pushを行うスレッドだけが更新する)
+};
+
+/**
+* @brief 描画スレッドクラス
+* @details <pre>
+* フレームは空きキューと描画待ちキューの間を循環する
+* ゲームスレッドは空きキューからフレームを取り出して命令を記録し、描画待ちキューに追加する
+* 描画スレッドは描画待ちキューから取り出して描画し(Presentを含む)、空きキューに戻す
+* 空きフレームがない場合はBeginFrameが待機するので、ゲームスレッドが先行できるのは最大でフレーム数-1フレームになる
+* </pre>
+*/
+class RenderThread
+{
+public:
+	/** Constructor */
+	RenderThread() :
+		m_Graphics(nullptr),
+		m_Overlay(nullptr),
+		m_Frames(),
+		m_FrameCount(0),
+		m_FreeQueue(),
+		m_SubmitQueue(),
+		m_Thread(),
+		m_FrameSubmittedEvent(nullptr),
+		m_FrameReleasedEvent(nullptr),
+		m_IsStopRequested(false),
+		m_IsRunning(false),
+		m_CurrentFrame(nullptr),
+		m_LastCamera()
+	{
+	}
+
+	/**
+	* @brief 開始関数
+	* @details <pre>
+	* 描画スレッドを作成する
+	* 以降、graphicsは描画スレッドだけが使用する
+	* </pre>
+	* @retval true 開始成功
+	* @retval false 開始失敗(既に開始している、またはイベントの作成に失敗)
+	* @param[in] graphics 描画に使用するGraphics
+	* @param[in] overlay 描画に使用するパフォーマンスオーバーレイ
+	* @param[in] frame_count 処理中にできるフレーム数(2でフレームNの描画中にN+1を記録できる、1～MaxRenderFramesInFlight)
+	*/
+	bool Start(Graphics* graphics, PerformanceOverlay* overlay, int frame_count);
+
+	/**
+	* @brief 停止関数
+	* @details 追加済みのフレームを全て描画してから描画スレッドを終了する
+	*/
+	void Stop();
+
+	/**
+	* @brief 実行中判定関数
+	* @retval true 描画スレッドが実行中
+	* @retval false 停止している
+	*/
+	bool IsRunning() const
+	{
+		return m_IsRunning;
+	}
+
+	/**
+	* @brief フレームの記録開始関数
+	* @details <pre>
+	* 空きフレームを取り出し、命令リストを空にして返す
+	* 空きフレームがない場合は描画スレッドがフレームを描画し終えるまで待機する
+	* SubmitFrameを実行する前に再度実行した場合は同じフレームを返す
+	* </pre>
+	* @retval RenderFrame* 記録するフレーム
+	*/
+	RenderFrame* BeginFrame();
+
+	/**
+	* @brief フレームの追加関数
+	* @details BeginFrameで取得したフレームを描画待ちキューに追加し、待機せずに戻る
+	*/
+	void SubmitFrame();
+
+	/**
+	* @brief 描画完了待ち関数
+	* @details 追加済みのフレームが全て描画されるまで待機する(テクスチャの解放前などに使用する)
+	*/
+	void WaitIdle();
+
+	/**
+	* @brief 描画待ちのフレーム数の取得関数
+	* @retval int 描画待ちのフレーム数
+	*/
+	int GetPendingFrameCount() const
+	{
+		return m_SubmitQueue.GetCount();
+	}
+
+private:
+	/**
+	* @brief 描画スレッドの処理関数
+	* @details 描画待ちキューからフレームを取り出して描画し、空きキューに戻す
+	*/
+	void Run();
+
+	/**
+	* @brief 1フレームの描画関数
+	* @param[in] frame 描画するフレーム
+	*/
+	void DrawFrame(RenderFrame* frame);
+
+private:
+	Graphics* m_Graphics;									//!< 描画に使用するGraphics
+	PerformanceOverlay* m_Overlay;							//!< 描画に使用するパフォーマンスオーバーレイ
+	RenderFrame m_Frames[MaxRenderFramesInFlight];			//!< フレーム
+	int m_FrameCount;										//!< 使用するフレーム数
+	RenderFrameQueue m_FreeQueue;							//!< 空きフレーム(描画スレッド => ゲームスレッド)
+	RenderFrameQueue m_SubmitQueue;							//!< 描画待ちフレーム(ゲームスレッド => 描画スレッド)
+	std::thread m_Thread;									//!< 描画スレッド
+	HANDLE m_FrameSubmittedEvent;							//!< 描画待ちキューへの追加を通知するイベント
+	HANDLE m_FrameReleasedEvent;							//!< 空きキューへの追加を通知するイベント
+	std::atomic<bool> m_IsStopRequested;					//!< 停止要求フラグ
+	bool m_IsRunning;										//!< 実行中フラグ(ゲームスレッドだけが使用する)
+	RenderFrame* m_CurrentFrame;							//!< 記録中のフレーム(ゲームスレッドだけが使用する)
+	Camera2D m_LastCamera;									//!< 最後に追加したフレームのカメラ(ゲームスレッドだけが使用する)
+};
+
+#endif
@@ -0,0 +1,50 @@
+﻿/**
+* @file RenderTypes.h
+* @brief <pre>
+* 描画バックエンドに共通の型とカラーのマクロの宣言
+* Direct3D9のヘッダーをインクルードしないので、Null、Recording描画バックエンドや
+* 頂点を作成するだけの処理(パーティクル、タイルマップ、描画命令リスト)はDirectX SDKなしでビルドできる
+* </pre>
+*/
+#ifndef RENDER_TYPES_H_
+#define RENDER_TYPES_H_
+
+#include <Windows.h>
+
+// テクスチャデータはD3D9描画バックエンドとソフトウェア描画バックエンドだけが中身を使用する
+struct IDirect3DTexture9;
+
+#ifndef D3DCOLOR_DEFINED
+typedef DWORD D3DCOLOR;
+#define D3DCOLOR_DEFINED
+#endif
+
+// Direct3D9のヘッダーと同じ定義なので、どちらを先にインクルードしても再定義の警告にならない
+#ifndef D3DCOLOR_ARGB
+#define D3DCOLOR_ARGB(a,r,g,b) \
+	((D3DCOLOR)((((a)&0xff)<<24)|(((r)&0xff)<<16)|(((g)&0xff)<<8)|((b)&0xff)))
+#define D3DCOLOR_RGBA(r,g,b,a) D3DCOLOR_ARGB(a,r,g,b)
+#define D3DCOLOR_XRGB(r,g,b)   D3DCOLOR_ARGB(0xff,r,g,b)
+#endif
+
+/** @brief 頂点データ */
+struct CustomVertex
+{
+	float X;			//!< X座標
+	float Y;			//!< Y座標
+	float Z;			//!< Z座標
+	float Rhw;			//!< 除算数
+	DWORD Color;		//!< 頂点カラー
+	float TextureX;		//!< テクスチャ座標X
+	float TexrureY;		//!< テクスチャ座標Y
+};
+
+/** @brief テクスチャデータやサイズを保持する構造体 */
+struct Texture
+{
+	IDirect3DTexture9* TextureData;	//!< テクスチャデータ(Null描画バックエンドではnullptr)
+	int Width;						//!< 横幅
+	int Height;						//!< 縦幅
+};
+
+#endif
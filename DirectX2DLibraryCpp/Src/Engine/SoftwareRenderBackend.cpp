@@ -0,0 +1,985 @@
+﻿#include <emmintrin.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "Window.h"
+#include "D3D9RenderBackend.h"
+#include "SoftwareRenderBackend.h"
+
+namespace
+{
+	/**
+	* @brief 0～255の値同士の乗算関数
+	* @details a * b / 255を四捨五入する
+	*/
+	inline int MulColor(int a, int b)
+	{
+		int t = a * b + 128;
+		return (t + (t >> 8)) >> 8;
+	}
+
+	/**
+	* @brief 1ピクセルのブレンド関数
+	* @details dest = source * source_alpha + dest * (1 - source_alpha)
+	*/
+	inline DWORD BlendPixel(DWORD dest, DWORD source)
+	{
+		int alpha = source >> 24;
+		DWORD result = 0xff000000;
+
+		for (int shift = 0; shift < 24; shift += 8)
+		{
+			int t = ((source >> shift) & 0xff) * alpha + ((dest >> shift) & 0xff) * (255 - alpha) + 128;
+			result |= (DWORD)((t + (t >> 8)) >> 8) << shift;
+		}
+
+		return result;
+	}
+
+	/**
+	* @brief ブレンドのチャンネル計算関数
+	* @details 16bitに展開した2ピクセル分のチャンネルをBlendPixelと同じ式でブレンドする
+	*/
+	inline __m128i BlendChannels(__m128i source, __m128i dest)
+	{
+		const __m128i max_value = _mm_set1_epi16(255);
+		const __m128i round = _mm_set1_epi16(128);
+
+		// BGRAのAを各チャンネルに複製する
+		__m128i alpha = _mm_shufflelo_epi16(source, _MM_SHUFFLE(3, 3, 3, 3));
+		alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+
+		// 最大で255 * 255 + 128なので符号なし16bitに収まる
+		__m128i t = _mm_add_epi16(
+			_mm_add_epi16(_mm_mullo_epi16(source, alpha), _mm_mullo_epi16(dest, _mm_sub_epi16(max_value, alpha))),
+			round);
+
+		return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+	}
+
+	/**
+	* @brief 1行分のブレンド関数
+	* @details 4ピクセルずつSSE2でブレンドし、端数はBlendPixelで処理する
+	*/
+	void BlendSpan(DWORD* dest, const DWORD* source, int count)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i alpha_mask = _mm_set1_epi32((int)0xff000000);
+
+		int i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128i src = _mm_loadu_si128((const __m128i*)&source[i]);
+			__m128i dst = _mm_loadu_si128((const __m128i*)&dest[i]);
+
+			__m128i low = BlendChannels(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero));
+			__m128i high = BlendChannels(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero));
+
+			_mm_storeu_si128((__m128i*)&dest[i], _mm_or_si128(_mm_packus_epi16(low, high), alpha_mask));
+		}
+
+		for (; i < count; i++)
+		{
+			dest[i] = BlendPixel(dest[i], source[i]);
+		}
+	}
+
+	/**
+	* @brief 1行分の塗りつぶし関数
+	* @details 不透明な単色の場合はブレンドせずに書き込む
+	*/
+	void FillSpan(DWORD* dest, DWORD color, int count, DWORD* span_buffer)
+	{
+		if ((color >> 24) == 0xff)
+		{
+			__m128i value = _mm_set1_epi32((int)color);
+
+			int i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				_mm_storeu_si128((__m128i*)&dest[i], value);
+			}
+			for (; i < count; i++)
+			{
+				dest[i] = color;
+			}
+			return;
+		}
+
+		for (int i = 0; i < count; i++)
+		{
+			span_buffer[i] = color;
+		}
+		BlendSpan(dest, span_buffer, count);
+	}
+
+	/**
+	* @brief エッジの内外判定関数
+	* @details 辺上のピクセルは左上ルールで内側に含めるかを決める
+	*/
+	inline bool IsInsideEdge(float value, bool is_top_left)
+	{
+		return value > 0.0f || (value == 0.0f && is_top_left == true);
+	}
+
+	/**
+	* @brief 描画範囲の計算関数
+	* @details ピクセル中心(整数座標)がmin_value～max_valueに含まれる範囲を0～limitに丸めて返す
+	*/
+	void CalculatePixelRange(float min_value, float max_value, int limit, int* out_begin, int* out_end)
+	{
+		// 画面外の大きな値をintに変換しないように丸める
+		min_value = (std::max)((std::min)(min_value, (float)limit), -1.0f);
+		max_value = (std::max)((std::min)(max_value, (float)limit), -1.0f);
+
+		int begin = (int)ceilf(min_value);
+		int end = (int)floorf(max_value) + 1;
+
+		*out_begin = begin < 0 ? 0 : begin;
+		*out_end = end > limit ? limit : end;
+	}
+}
+
+SoftwareRenderBackend::SoftwareRenderBackend() :
+	m_D3DInterface(nullptr),
+	m_D3DDevice(nullptr),
+	m_BackBufferWidth(0),
+	m_BackBufferHeight(0),
+	m_TileCountX(0),
+	m_TileCountY(0),
+	m_WorkerCount(1),
+	m_CurrentTextureIndex(-1),
+	m_FrameBuffer(),
+	m_TriangleList(),
+	m_TextureList(),
+	m_TileTriangleList(),
+	m_WorkerThreadList(),
+	m_StartSemaphore(nullptr),
+	m_FinishedEvent(nullptr),
+	m_NextTile(0),
+	m_FrameTileCount(0),
+	m_PendingWorkerCount(0),
+	m_IsStopRequested(false)
+{
+	SetWorkerCount((int)std::thread::hardware_concurrency());
+}
+
+SoftwareRenderBackend::~SoftwareRenderBackend()
+{
+	// 実行中のスレッドを残したまま破棄しない
+	StopWorkers();
+}
+
+bool SoftwareRenderBackend::Initialize(int width, int height, bool is_window_mode)
+{
+	if (width <= 0 ||
+		height <= 0)
+	{
+		return false;
+	}
+
+	if (CreateDevice() == false)
+	{
+		return false;
+	}
+
+	m_BackBufferWidth = width;
+	m_BackBufferHeight = height;
+	m_FrameBuffer.assign(width * height, 0xff000000);
+
+	m_TileCountX = (width + SoftwareTileSize - 1) / SoftwareTileSize;
+	m_TileCountY = (height + SoftwareTileSize - 1) / SoftwareTileSize;
+	m_TileTriangleList.resize(m_TileCountX * m_TileCountY);
+
+	// フレームごとにスレッドを作成すると作成と終了待ちのコストが毎フレームかかるので、ここで作成して使い回す
+	StopWorkers();
+	if (StartWorkers() == false)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void SoftwareRenderBackend::Release()
+{
+	StopWorkers();
+
+	m_TriangleList.clear();
+	m_TextureList.clear();
+	m_TileTriangleList.clear();
+	m_FrameBuffer.clear();
+
+	if (m_D3DDevice != nullptr)
+	{
+		m_D3DDevice->Release();
+		m_D3DDevice = nullptr;
+	}
+
+	if (m_D3DInterface != nullptr)
+	{
+		m_D3DInterface->Release();
+		m_D3DInterface = nullptr;
+	}
+}
+
+bool SoftwareRenderBackend::BeginFrame(DWORD color)
+{
+	if (m_FrameBuffer.empty() == true)
+	{
+		return false;
+	}
+
+	// バックバッファ(X8R8G8B8)と同じくアルファは使用しない
+	std::fill(m_FrameBuffer.begin(), m_FrameBuffer.end(), color | 0xff000000);
+
+	m_TriangleList.clear();
+	m_TextureList.clear();
+	m_CurrentTextureIndex = -1;
+
+	return true;
+}
+
+void SoftwareRenderBackend::EndFrame()
+{
+	if (m_TriangleList.empty() == true)
+	{
+		return;
+	}
+
+	// ロックできなかったテクスチャは頂点カラーのみで描画する
+	LockFrameTextures();
+
+	// 三角形をタイルに振り分ける(タイル内では描画命令の順番を保つ)
+	for (auto& triangle_list : m_TileTriangleList)
+	{
+		triangle_list.clear();
+	}
+
+	for (int i = 0; i < (int)m_TriangleList.size(); i++)
+	{
+		const SoftwareTriangle& triangle = m_TriangleList[i];
+
+		int tile_left = triangle.MinX / SoftwareTileSize;
+		int tile_top = triangle.MinY / SoftwareTileSize;
+		int tile_right = (triangle.MaxX - 1) / SoftwareTileSize;
+		int tile_bottom = (triangle.MaxY - 1) / SoftwareTileSize;
+
+		for (int tile_y = tile_top; tile_y <= tile_bottom; tile_y++)
+		{
+			for (int tile_x = tile_left; tile_x <= tile_right; tile_x++)
+			{
+				m_TileTriangleList[tile_y * m_TileCountX + tile_x].push_back(i);
+			}
+		}
+	}
+
+	// タイル単位で各スレッドに割り当てる
+	// 1つのタイルは1つのスレッドだけが書き込むので結果はスレッド数に依存しない
+	m_FrameTileCount = m_TileCountX * m_TileCountY;
+	m_NextTile.store(0, std::memory_order_relaxed);
+
+	int helper_count = (std::min)((int)m_WorkerThreadList.size(), m_FrameTileCount - 1);
+	if (helper_count > 0)
+	{
+		m_PendingWorkerCount.store(helper_count, std::memory_order_release);
+		ReleaseSemaphore(m_StartSemaphore, helper_count, nullptr);
+	}
+
+	RasterizeTiles();
+
+	// テクスチャのアンロックと三角形の破棄を行うので、全てのスレッドが作業を終えるまで待つ
+	while (m_PendingWorkerCount.load(std::memory_order_acquire) > 0)
+	{
+		WaitForSingleObject(m_FinishedEvent, INFINITE);
+	}
+
+	UnlockFrameTextures();
+
+	m_TriangleList.clear();
+	m_TextureList.clear();
+	m_CurrentTextureIndex = -1;
+}
+
+void SoftwareRenderBackend::SetTexture(const Texture* texture)
+{
+	if (texture == nullptr)
+	{
+		m_CurrentTextureIndex = -1;
+		return;
+	}
+
+	for (int i = 0; i < (int)m_TextureList.size(); i++)
+	{
+		if (m_TextureList[i].Source == texture)
+		{
+			m_CurrentTextureIndex = i;
+			return;
+		}
+	}
+
+	SoftwareTextureView view = { texture, nullptr, 0, texture->Width, texture->Height };
+	m_TextureList.push_back(view);
+	m_CurrentTextureIndex = (int)m_TextureList.size() - 1;
+}
+
+void SoftwareRenderBackend::DrawTriangleList(const CustomVertex* vertices, int vertex_count)
+{
+	for (int i = 0; i + 3 <= vertex_count; i += 3)
+	{
+		SetUpTriangle(&vertices[i]);
+	}
+}
+
+bool SoftwareRenderBackend::CreateTexture(const char* file_name, Texture* texture_data)
+{
+	if (m_D3DDevice == nullptr)
+	{
+		return false;
+	}
+
+	D3DXIMAGE_INFO info;
+
+	if (FAILED(D3DXGetImageInfoFromFile(file_name, &info)))
+	{
+		return false;
+	}
+
+	// ラスタライズ時にCPUで読み込むのでフォーマットを固定してSCRATCHプールに作成する
+	if (FAILED(D3DXCreateTextureFromFileEx(
+		m_D3DDevice,
+		file_name,
+		info.Width,
+		info.Height,
+		1,
+		0,
+		D3DFMT_A8R8G8B8,
+		D3DPOOL_SCRATCH,
+		D3DX_DEFAULT,
+		D3DX_DEFAULT,
+		TextureColorKey,
+		nullptr,
+		nullptr,
+		&texture_data->TextureData)))
+	{
+		return false;
+	}
+
+	D3DSURFACE_DESC desc;
+
+	if (FAILED(texture_data->TextureData->GetLevelDesc(0, &desc)))
+	{
+		texture_data->TextureData->Release();
+		texture_data->TextureData = nullptr;
+		return false;
+	}
+	texture_data->Width = desc.Width;
+	texture_data->Height = desc.Height;
+
+	return true;
+}
+
+bool SoftwareRenderBackend::DecodeTexture(const char* file_name, int* out_width, int* out_height, std::vector<DWORD>* out_pixels)
+{
+	return D3D9RenderBackend::DecodeImageFile(m_D3DDevice, file_name, out_width, out_height, out_pixels);
+}
+
+bool SoftwareRenderBackend::CreateTextureFromMemory(const void* data, size_t size, Texture* texture_data)
+{
+	if (m_D3DDevice == nullptr)
+	{
+		return false;
+	}
+
+	D3DXIMAGE_INFO info;
+
+	if (FAILED(D3DXGetImageInfoFromFileInMemory(data, (UINT)size, &info)))
+	{
+		return false;
+	}
+
+	if (FAILED(D3DXCreateTextureFromFileInMemoryEx(
+		m_D3DDevice,
+		data,
+		(UINT)size,
+		info.Width,
+		info.Height,
+		1,
+		0,
+		D3DFMT_A8R8G8B8,
+		D3DPOOL_SCRATCH,
+		D3DX_DEFAULT,
+		D3DX_DEFAULT,
+		TextureColorKey,
+		nullptr,
+		nullptr,
+		&texture_data->TextureData)))
+	{
+		return false;
+	}
+
+	D3DSURFACE_DESC desc;
+
+	if (FAILED(texture_data->TextureData->GetLevelDesc(0, &desc)))
+	{
+		texture_data->TextureData->Release();
+		texture_data->TextureData = nullptr;
+		return false;
+	}
+	texture_data->Width = desc.Width;
+	texture_data->Height = desc.Height;
+
+	return true;
+}
+
+bool SoftwareRenderBackend::DecodeTextureFromMemory(const void* data, size_t size, int* out_width, int* out_height, std::vector<DWORD>* out_pixels)
+{
+	return D3D9RenderBackend::DecodeImageFileInMemory(m_D3DDevice, data, size, out_width, out_height, out_pixels);
+}
+
+bool SoftwareRenderBackend::CreateEmptyTexture(int width, int height, Texture* texture_data)
+{
+	if (m_D3DDevice == nullptr)
+	{
+		return false;
+	}
+
+	if (FAILED(m_D3DDevice->CreateTexture(
+		width,
+		height,
+		1,
+		0,
+		D3DFMT_A8R8G8B8,
+		D3DPOOL_SCRATCH,
+		&texture_data->TextureData,
+		nullptr)))
+	{
+		return false;
+	}
+
+	texture_data->Width = width;
+	texture_data->Height = height;
+
+	return true;
+}
+
+bool SoftwareRenderBackend::CreateMipmappedTexture(int width, int height, int level_count, const DWORD* pixels, Texture* texture_data)
+{
+	if (m_D3DDevice == nullptr)
+	{
+		return false;
+	}
+
+	if (FAILED(m_D3DDevice->CreateTexture(
+		width,
+		height,
+		level_count,
+		0,
+		D3DFMT_A8R8G8B8,
+		D3DPOOL_SCRATCH,
+		&texture_data->TextureData,
+		nullptr)))
+	{
+		return false;
+	}
+
+	if (D3D9RenderBackend::WriteMipmapLevels(texture_data->TextureData, width, height, level_count, pixels) == false)
+	{
+		texture_data->TextureData->Release();
+		texture_data->TextureData = nullptr;
+		return false;
+	}
+
+	texture_data->Width = width;
+	texture_data->Height = height;
+
+	return true;
+}
+
+bool SoftwareRenderBackend::UpdateTexture(Texture* texture_data, int x, int y, int width, int height, const DWORD* pixels, int pitch)
+{
+	// ラスタライズはEndFrameで行うので、フレーム中に書き換えた範囲はそれ以前の描画にも反映される
+	// (GlyphAtlasは現在のフレームで使用したセルを書き換えない)
+	return D3D9RenderBackend::WriteTexturePixels(texture_data->TextureData, x, y, width, height, pixels, pitch);
+}
+
+void SoftwareRenderBackend::GetBackBufferSize(int* out_width, int* out_height) const
+{
+	*out_width = m_BackBufferWidth;
+	*out_height = m_BackBufferHeight;
+}
+
+void SoftwareRenderBackend::SetWorkerCount(int worker_count)
+{
+	if (worker_count < 1)
+	{
+		worker_count = 1;
+	}
+	else if (worker_count > MaxSoftwareWorkerCount)
+	{
+		worker_count = MaxSoftwareWorkerCount;
+	}
+
+	if (worker_count == m_WorkerCount)
+	{
+		return;
+	}
+
+	m_WorkerCount = worker_count;
+
+	// 初期化済みの場合はスレッド数を合わせて作り直す
+	if (m_StartSemaphore != nullptr)
+	{
+		StopWorkers();
+		StartWorkers();
+	}
+}
+
+bool SoftwareRenderBackend::StartWorkers()
+{
+	m_StartSemaphore = CreateSemaphore(nullptr, 0, MaxSoftwareWorkerCount, nullptr);
+	m_FinishedEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	if (m_StartSemaphore == nullptr ||
+		m_FinishedEvent == nullptr)
+	{
+		StopWorkers();
+		return false;
+	}
+
+	m_IsStopRequested = false;
+	m_PendingWorkerCount = 0;
+
+	for (int i = 1; i < m_WorkerCount; i++)
+	{
+		m_WorkerThreadList.push_back(std::thread(&SoftwareRenderBackend::WorkerMain, this));
+	}
+
+	return true;
+}
+
+void SoftwareRenderBackend::StopWorkers()
+{
+	m_IsStopRequested = true;
+
+	if (m_StartSemaphore != nullptr && m_WorkerThreadList.empty() == false)
+	{
+		ReleaseSemaphore(m_StartSemaphore, (LONG)m_WorkerThreadList.size(), nullptr);
+	}
+
+	for (std::thread& thread : m_WorkerThreadList)
+	{
+		thread.join();
+	}
+	m_WorkerThreadList.clear();
+
+	if (m_StartSemaphore != nullptr)
+	{
+		CloseHandle(m_StartSemaphore);
+		m_StartSemaphore = nullptr;
+	}
+
+	if (m_FinishedEvent != nullptr)
+	{
+		CloseHandle(m_FinishedEvent);
+		m_FinishedEvent = nullptr;
+	}
+}
+
+void SoftwareRenderBackend::WorkerMain()
+{
+	while (true)
+	{
+		WaitForSingleObject(m_StartSemaphore, INFINITE);
+		if (m_IsStopRequested.load(std::memory_order_acquire) == true)
+		{
+			break;
+		}
+
+		RasterizeTiles();
+
+		// 最後に作業を終えたスレッドがEndFrameの待機を解除する
+		if (m_PendingWorkerCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			SetEvent(m_FinishedEvent);
+		}
+	}
+}
+
+void SoftwareRenderBackend::RasterizeTiles()
+{
+	DWORD span_buffer[SoftwareTileSize];
+
+	for (int tile = m_NextTile.fetch_add(1); tile < m_FrameTileCount; tile = m_NextTile.fetch_add(1))
+	{
+		RasterizeTile(tile, span_buffer);
+	}
+}
+
+bool SoftwareRenderBackend::SaveFrameBuffer(const char* file_name)
+{
+	if (m_D3DDevice == nullptr ||
+		m_FrameBuffer.empty() == true)
+	{
+		return false;
+	}
+
+	LPDIRECT3DSURFACE9 surface = nullptr;
+
+	if (FAILED(m_D3DDevice->CreateOffscreenPlainSurface(
+		m_BackBufferWidth,
+		m_BackBufferHeight,
+		D3DFMT_X8R8G8B8,
+		D3DPOOL_SCRATCH,
+		&surface,
+		nullptr)))
+	{
+		return false;
+	}
+
+	D3DLOCKED_RECT locked_rect;
+
+	if (FAILED(surface->LockRect(&locked_rect, nullptr, 0)))
+	{
+		surface->Release();
+		return false;
+	}
+
+	for (int y = 0; y < m_BackBufferHeight; y++)
+	{
+		memcpy(
+			(unsigned char*)locked_rect.pBits + locked_rect.Pitch * y,
+			&m_FrameBuffer[y * m_BackBufferWidth],
+			m_BackBufferWidth * sizeof(DWORD));
+	}
+
+	surface->UnlockRect();
+
+	HRESULT result = D3DXSaveSurfaceToFile(file_name, D3DXIFF_PNG, surface, nullptr, nullptr);
+	surface->Release();
+
+	return SUCCEEDED(result);
+}
+
+bool SoftwareRenderBackend::CompareFrameBuffer(const char* reference_file, int tolerance, int* out_diff_count)
+{
+	if (out_diff_count != nullptr)
+	{
+		*out_diff_count = 0;
+	}
+
+	if (m_D3DDevice == nullptr ||
+		m_FrameBuffer.empty() == true)
+	{
+		return false;
+	}
+
+	D3DXIMAGE_INFO info;
+
+	if (FAILED(D3DXGetImageInfoFromFile(reference_file, &info)) ||
+		(int)info.Width != m_BackBufferWidth ||
+		(int)info.Height != m_BackBufferHeight)
+	{
+		return false;
+	}
+
+	LPDIRECT3DSURFACE9 surface = nullptr;
+
+	if (FAILED(m_D3DDevice->CreateOffscreenPlainSurface(
+		m_BackBufferWidth,
+		m_BackBufferHeight,
+		D3DFMT_A8R8G8B8,
+		D3DPOOL_SCRATCH,
+		&surface,
+		nullptr)))
+	{
+		return false;
+	}
+
+	D3DLOCKED_RECT locked_rect;
+
+	if (FAILED(D3DXLoadSurfaceFromFile(surface, nullptr, nullptr, reference_file, nullptr, D3DX_FILTER_NONE, 0, nullptr)) ||
+		FAILED(surface->LockRect(&locked_rect, nullptr, D3DLOCK_READONLY)))
+	{
+		surface->Release();
+		return false;
+	}
+
+	int diff_count = 0;
+
+	for (int y = 0; y < m_BackBufferHeight; y++)
+	{
+		const DWORD* reference = (const DWORD*)((const unsigned char*)locked_rect.pBits + locked_rect.Pitch * y);
+		const DWORD* pixels = &m_FrameBuffer[y * m_BackBufferWidth];
+
+		for (int x = 0; x < m_BackBufferWidth; x++)
+		{
+			for (int shift = 0; shift < 24; shift += 8)
+			{
+				int diff = (int)((pixels[x] >> shift) & 0xff) - (int)((reference[x] >> shift) & 0xff);
+				if (diff > tolerance || -diff > tolerance)
+				{
+					diff_count++;
+					break;
+				}
+			}
+		}
+	}
+
+	surface->UnlockRect();
+	surface->Release();
+
+	if (out_diff_count != nullptr)
+	{
+		*out_diff_count = diff_count;
+	}
+
+	return diff_count == 0;
+}
+
+bool SoftwareRenderBackend::CreateDevice()
+{
+	m_D3DInterface = Direct3DCreate9(D3D_SDK_VERSION);
+	if (m_D3DInterface == NULL)
+	{
+		return false;
+	}
+
+	D3DPRESENT_PARAMETERS present_param;
+	ZeroMemory(&present_param, sizeof(D3DPRESENT_PARAMETERS));
+
+	present_param.BackBufferWidth = 1;
+	present_param.BackBufferHeight = 1;
+	present_param.BackBufferFormat = D3DFMT_UNKNOWN;
+	present_param.BackBufferCount = 1;
+	present_param.SwapEffect = D3DSWAPEFFECT_DISCARD;
+	present_param.Windowed = TRUE;
+
+	HWND window_handle = FindWindow(WINDOW_CLASS_NAME, nullptr);
+	if (window_handle == nullptr)
+	{
+		window_handle = GetDesktopWindow();
+	}
+
+	// NULLREFデバイスは描画できないが、SCRATCHプールのリソース作成とD3DXの画像読み書きには使用できる
+	if (FAILED(m_D3DInterface->CreateDevice(D3DADAPTER_DEFAULT,
+		D3DDEVTYPE_NULLREF,
+		window_handle,
+		D3DCREATE_SOFTWARE_VERTEXPROCESSING | D3DCREATE_MULTITHREADED,
+		&present_param,
+		&m_D3DDevice)))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void SoftwareRenderBackend::SetUpTriangle(const CustomVertex* vertices)
+{
+	SoftwareTriangle triangle;
+
+	for (int i = 0; i < 3; i++)
+	{
+		triangle.Vertices[i] = vertices[i];
+	}
+
+	const CustomVertex& v0 = vertices[0];
+	const CustomVertex& v1 = vertices[1];
+	const CustomVertex& v2 = vertices[2];
+
+	// D3D9の初期設定(D3DCULL_CCW)と同じく反時計回りの三角形は描画しない
+	float area = (v1.X - v0.X) * (v2.Y - v0.Y) - (v1.Y - v0.Y) * (v2.X - v0.X);
+	if (area <= 0.0f)
+	{
+		return;
+	}
+
+	float min_x = (std::min)((std::min)(v0.X, v1.X), v2.X);
+	float max_x = (std::max)((std::max)(v0.X, v1.X), v2.X);
+	float min_y = (std::min)((std::min)(v0.Y, v1.Y), v2.Y);
+	float max_y = (std::max)((std::max)(v0.Y, v1.Y), v2.Y);
+
+	CalculatePixelRange(min_x, max_x, m_BackBufferWidth, &triangle.MinX, &triangle.MaxX);
+	CalculatePixelRange(min_y, max_y, m_BackBufferHeight, &triangle.MinY, &triangle.MaxY);
+
+	if (triangle.MinX >= triangle.MaxX ||
+		triangle.MinY >= triangle.MaxY)
+	{
+		return;
+	}
+
+	// エッジ関数 E(x, y) = A * x + B * y + C (頂点iの対辺、内側で正)
+	for (int i = 0; i < 3; i++)
+	{
+		const CustomVertex& a = vertices[(i + 1) % 3];
+		const CustomVertex& b = vertices[(i + 2) % 3];
+		float dx = b.X - a.X;
+		float dy = b.Y - a.Y;
+
+		triangle.EdgeA[i] = -dy;
+		triangle.EdgeB[i] = dx;
+		triangle.EdgeC[i] = dy * a.X - dx * a.Y;
+		triangle.IsTopLeft[i] = (dy == 0.0f && dx > 0.0f) || dy < 0.0f;
+	}
+
+	triangle.InvArea = 1.0f / area;
+	triangle.TextureIndex = m_CurrentTextureIndex;
+	triangle.IsSolidColor =
+		m_CurrentTextureIndex < 0 &&
+		v0.Color == v1.Color &&
+		v0.Color == v2.Color;
+
+	m_TriangleList.push_back(triangle);
+}
+
+void SoftwareRenderBackend::LockFrameTextures()
+{
+	for (auto& view : m_TextureList)
+	{
+		view.Texels = nullptr;
+
+		D3DLOCKED_RECT locked_rect;
+
+		if (view.Source->TextureData == nullptr ||
+			FAILED(view.Source->TextureData->LockRect(0, &locked_rect, nullptr, D3DLOCK_READONLY)))
+		{
+			continue;
+		}
+
+		view.Texels = (const DWORD*)locked_rect.pBits;
+		view.Pitch = locked_rect.Pitch / sizeof(DWORD);
+	}
+}
+
+void SoftwareRenderBackend::UnlockFrameTextures()
+{
+	for (auto& view : m_TextureList)
+	{
+		if (view.Texels == nullptr)
+		{
+			continue;
+		}
+
+		view.Source->TextureData->UnlockRect(0);
+		view.Texels = nullptr;
+	}
+}
+
+void SoftwareRenderBackend::RasterizeTile(int tile_index, DWORD* span_buffer)
+{
+	int left = (tile_index % m_TileCountX) * SoftwareTileSize;
+	int top = (tile_index / m_TileCountX) * SoftwareTileSize;
+	int right = (std::min)(left + SoftwareTileSize, m_BackBufferWidth);
+	int bottom = (std::min)(top + SoftwareTileSize, m_BackBufferHeight);
+
+	for (int index : m_TileTriangleList[tile_index])
+	{
+		RasterizeTriangle(m_TriangleList[index], left, top, right, bottom, span_buffer);
+	}
+}
+
+void SoftwareRenderBackend::RasterizeTriangle(const SoftwareTriangle& triangle, int left, int top, int right, int bottom, DWORD* span_buffer)
+{
+	int begin_x = (std::max)(triangle.MinX, left);
+	int end_x = (std::min)(triangle.MaxX, right);
+	int begin_y = (std::max)(triangle.MinY, top);
+	int end_y = (std::min)(triangle.MaxY, bottom);
+
+	const SoftwareTextureView* texture = triangle.TextureIndex >= 0 ? &m_TextureList[triangle.TextureIndex] : nullptr;
+	const CustomVertex* v = triangle.Vertices;
+
+	for (int y = begin_y; y < end_y; y++)
+	{
+		float py = (float)y;
+		float row[3];
+		for (int i = 0; i < 3; i++)
+		{
+			row[i] = triangle.EdgeB[i] * py + triangle.EdgeC[i];
+		}
+
+		// 凸形状なので1行の内側のピクセルは連続している
+		int span_begin = end_x;
+		int span_end = begin_x;
+		for (int x = begin_x; x < end_x; x++)
+		{
+			float px = (float)x;
+			if (IsInsideEdge(triangle.EdgeA[0] * px + row[0], triangle.IsTopLeft[0]) == true &&
+				IsInsideEdge(triangle.EdgeA[1] * px + row[1], triangle.IsTopLeft[1]) == true &&
+				IsInsideEdge(triangle.EdgeA[2] * px + row[2], triangle.IsTopLeft[2]) == true)
+			{
+				if (span_begin == end_x)
+				{
+					span_begin = x;
+				}
+				span_end = x + 1;
+			}
+			else if (span_begin != end_x)
+			{
+				break;
+			}
+		}
+
+		if (span_begin >= span_end)
+		{
+			continue;
+		}
+
+		DWORD* dest = &m_FrameBuffer[y * m_BackBufferWidth + span_begin];
+		int count = span_end - span_begin;
+
+		if (triangle.IsSolidColor == true)
+		{
+			FillSpan(dest, v[0].Color, count, span_buffer);
+			continue;
+		}
+
+		// 頂点カラーとUVを重心座標で補間する
+		for (int x = span_begin; x < span_end; x++)
+		{
+			float px = (float)x;
+			float weight0 = (triangle.EdgeA[0] * px + row[0]) * triangle.InvArea;
+			float weight1 = (triangle.EdgeA[1] * px + row[1]) * triangle.InvArea;
+			float weight2 = 1.0f - weight0 - weight1;
+
+			DWORD color = 0;
+			for (int shift = 0; shift < 32; shift += 8)
+			{
+				float value =
+					((v[0].Color >> shift) & 0xff) * weight0 +
+					((v[1].Color >> shift) & 0xff) * weight1 +
+					((v[2].Color >> shift) & 0xff) * weight2;
+				int channel = (int)(value + 0.5f);
+				channel = channel < 0 ? 0 : (channel > 255 ? 255 : channel);
+				color |= (DWORD)channel << shift;
+			}
+
+			if (texture != nullptr &&
+				texture->Texels != nullptr)
+			{
+				float u = v[0].TextureX * weight0 + v[1].TextureX * weight1 + v[2].TextureX * weight2;
+				float t = v[0].TexrureY * weight0 + v[1].TexrureY * weight1 + v[2].TexrureY * weight2;
+
+				// ポイントサンプリング、アドレスモードはWRAP(D3D9の初期設定)
+				int texel_x = (int)floorf(u * texture->Width) % texture->Width;
+				int texel_y = (int)floorf(t * texture->Height) % texture->Height;
+				texel_x += texel_x < 0 ? texture->Width : 0;
+				texel_y += texel_y < 0 ? texture->Height : 0;
+
+				DWORD texel = texture->Texels[texel_y * texture->Pitch + texel_x];
+
+				DWORD modulated = 0;
+				for (int shift = 0; shift < 32; shift += 8)
+				{
+					modulated |= (DWORD)MulColor((texel >> shift) & 0xff, (color >> shift) & 0xff) << shift;
+				}
+				color = modulated;
+			}
+
+			span_buffer[x - span_begin] = color;
+		}
+
+		BlendSpan(dest, span_buffer, count);
+	}
+}
@@ -0,0 +1,250 @@
+﻿/**
+* @file SoftwareRenderBackend.h
+* @brief <pre>
+* CPUで三角形をラスタライズする描画バックエンドの宣言
+* GPUがない環境で描画結果を画像として保存、比較するために使用する
+* Graphicsクラスでインスタンスを作成するので使用者が作成する必要はない
+* </pre>
+*/
+#ifndef SOFTWARE_RENDER_BACKEND_H_
+#define SOFTWARE_RENDER_BACKEND_H_
+
+#include <Windows.h>
+#include <d3d9.h>
+#include <d3dx9.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "RenderBackend.h"
+
+const int SoftwareTileSize = 64;			//!< フレームバッファを分割するタイルのサイズ(ピクセル)
+const int MaxSoftwareWorkerCount = 16;		//!< ラスタライズを行うスレッドの最大数
+
+/** @brief ラスタライズ用に前処理した三角形 */
+struct SoftwareTriangle
+{
+	CustomVertex Vertices[3];	//!< 頂点
+	float EdgeA[3];				//!< エッジ関数のX係数(添字の頂点の対辺)
+	float EdgeB[3];				//!< エッジ関数のY係数
+	float EdgeC[3];				//!< エッジ関数の定数項
+	bool IsTopLeft[3];			//!< エッジが左上ルールで内側に含まれるか
+	float InvArea;				//!< 面積(エッジ関数の値)の逆数
+	int TextureIndex;			//!< フレーム内のテクスチャ番号(テクスチャなしの場合は-1)
+	bool IsSolidColor;			//!< テクスチャなしで全頂点が同じ色か
+	int MinX;					//!< 描画範囲の左端(ピクセル)
+	int MinY;					//!< 描画範囲の上端(ピクセル)
+	int MaxX;					//!< 描画範囲の右端(ピクセル、範囲に含まない)
+	int MaxY;					//!< 描画範囲の下端(ピクセル、範囲に含まない)
+};
+
+/** @brief ラスタライズ中に参照するテクスチャのピクセルデータ */
+struct SoftwareTextureView
+{
+	const Texture* Source;		//!< 参照元のテクスチャ
+	const DWORD* Texels;		//!< ピクセルデータ(A8R8G8B8)
+	int Pitch;					//!< 1行の要素数
+	int Width;					//!< 横幅
+	int Height;					//!< 縦幅
+};
+
+/**
+* @brief ソフトウェア描画バックエンドクラス
+* @details <pre>
+* 描画命令はフレーム中に蓄積し、EndFrameでタイルごとに複数スレッドでラスタライズする
+* ラスタライズを行うスレッドはInitializeで作成し、EndFrameのたびにセマフォで起こして使い回す
+* ブレンドはD3D9描画バックエンドと同じSRCALPHA/INVSRCALPHA、テクスチャは頂点カラーと乗算する
+* テクスチャの読み込みと画像の保存にはNULLREFデバイスとD3DXを使用するのでGPUは不要
+* </pre>
+*/
+class SoftwareRenderBackend : public RenderBackend
+{
+public:
+	/** Constructor */
+	SoftwareRenderBackend();
+
+	/** Destructor */
+	virtual ~SoftwareRenderBackend();
+
+	virtual bool Initialize(int width, int height, bool is_window_mode) override;
+	virtual void Release() override;
+	virtual RenderBackendType GetType() const override
+	{
+		return RenderBackendType::RenderBackendTypeSoftware;
+	}
+
+	/**
+	* @brief フレーム開始関数
+	* @details フレームバッファをクリアし、前のフレームの描画命令を破棄する
+	*/
+	virtual bool BeginFrame(DWORD color) override;
+
+	/**
+	* @brief フレーム終了関数
+	* @details 蓄積した三角形をタイルごとに並列でラスタライズする
+	*/
+	virtual void EndFrame() override;
+	virtual void SetVertexFormat() override {}
+	virtual void SetTexture(const Texture* texture) override;
+
+	/**
+	* @brief テクスチャのフィルタリング設定関数
+	* @details ラスタライズは常に最上位レベルのポイントサンプリングで行うので、設定は無視する
+	* @param[in] filter フィルタリング
+	*/
+	virtual void SetTextureFilter(TextureFilter filter) override {}
+	virtual void DrawTriangleList(const CustomVertex* vertices, int vertex_count) override;
+	virtual bool CreateTexture(const char* file_name, Texture* texture_data) override;
+	virtual bool DecodeTexture(const char* file_name, int* out_width, int* out_height, std::vector<DWORD>* out_pixels) override;
+	virtual bool CreateTextureFromMemory(const void* data, size_t size, Texture* texture_data) override;
+	virtual bool DecodeTextureFromMemory(const void* data, size_t size, int* out_width, int* out_height, std::vector<DWORD>* out_pixels) override;
+	virtual bool CreateEmptyTexture(int width, int height, Texture* texture_data) override;
+	virtual bool CreateMipmappedTexture(int width, int height, int level_count, const DWORD* pixels, Texture* texture_data) override;
+	virtual bool UpdateTexture(Texture* texture_data, int x, int y, int width, int height, const DWORD* pixels, int pitch) override;
+	virtual void GetBackBufferSize(int* out_width, int* out_height) const override;
+
+	/**
+	* @brief ラスタライズスレッド数の設定関数
+	* @details <pre>
+	* 1からMaxSoftwareWorkerCountの範囲に丸められる
+	* 初期化後に変更した場合はスレッドを作り直すので、BeginFrameとEndFrameの間では実行しない
+	* </pre>
+	* @param[in] worker_count スレッド数(呼び出し元のスレッドを含む)
+	*/
+	void SetWorkerCount(int worker_count);
+
+	/**
+	* @brief ラスタライズスレッド数の取得関数
+	* @retval int スレッド数
+	*/
+	int GetWorkerCount() const
+	{
+		return m_WorkerCount;
+	}
+
+	/**
+	* @brief フレームバッファの取得関数
+	* @details EndFrame後は最後に終了したフレームの描画結果を保持している
+	* @retval const DWORD* ピクセルデータ(X8R8G8B8、横幅×縦幅)
+	*/
+	const DWORD* GetFrameBuffer() const
+	{
+		return m_FrameBuffer.empty() == true ? nullptr : &m_FrameBuffer[0];
+	}
+
+	/**
+	* @brief フレームバッファの保存関数
+	* @retval true 保存成功
+	* @retval false 保存失敗
+	* @param[in] file_name 保存するpngファイル名(パス込み)
+	*/
+	bool SaveFrameBuffer(const char* file_name);
+
+	/**
+	* @brief フレームバッファの比較関数
+	* @details <pre>
+	* 参照画像とRGBを1ピクセルずつ比較する
+	* GPUで描画した画像と比較する場合はtoleranceで丸め誤差を許容する
+	* </pre>
+	* @retval true 全てのピクセルの差がtolerance以下
+	* @retval false 差がtoleranceを超えるピクセルがある、または参照画像の読み込み失敗
+	* @param[in] reference_file 参照画像のファイル名(パス込み、サイズはバックバッファと同じ)
+	* @param[in] tolerance 許容する各チャンネルの差
+	* @param[out] out_diff_count 差がtoleranceを超えたピクセル数(不要な場合はnullptr)
+	*/
+	bool CompareFrameBuffer(const char* reference_file, int tolerance, int* out_diff_count);
+
+private:
+	/**
+	* @brief デバイス作成関数
+	* @details テクスチャの読み込みと画像の保存に使用するNULLREFデバイスを作成する
+	* @retval true 作成成功
+	* @retval false 作成失敗
+	*/
+	bool CreateDevice();
+
+	/**
+	* @brief ラスタライズスレッドの開始関数
+	* @details 呼び出し元のスレッドもラスタライズするので、スレッド数 - 1のスレッドを作成する
+	* @retval true 開始成功
+	* @retval false 開始失敗(セマフォ、イベントの作成に失敗)
+	*/
+	bool StartWorkers();
+
+	/**
+	* @brief ラスタライズスレッドの停止関数
+	* @details 全てのスレッドを終了させ、セマフォとイベントを解放する
+	*/
+	void StopWorkers();
+
+	/**
+	* @brief ラスタライズスレッドの処理関数
+	* @details EndFrameで起こされるたびにタイルを取り出してラスタライズする
+	*/
+	void WorkerMain();
+
+	/**
+	* @brief フレームのタイルのラスタライズ関数
+	* @details 未処理のタイルがなくなるまで取り出してラスタライズする(EndFrameの呼び出し元とラスタライズスレッドが並行して実行する)
+	*/
+	void RasterizeTiles();
+
+	/**
+	* @brief 三角形の前処理関数
+	* @details エッジ関数と描画範囲を計算し、フレームの三角形リストに追加する
+	* @param[in] vertices 三角形の頂点(3つ)
+	*/
+	void SetUpTriangle(const CustomVertex* vertices);
+
+	/**
+	* @brief フレームで使用するテクスチャのロック関数
+	* @details ロックできなかったテクスチャはTexelsがnullptrになる
+	*/
+	void LockFrameTextures();
+
+	/**
+	* @brief フレームで使用するテクスチャのアンロック関数
+	*/
+	void UnlockFrameTextures();
+
+	/**
+	* @brief タイルのラスタライズ関数
+	* @details タイルに重なる三角形を描画命令の順にラスタライズする
+	* @param[in] tile_index タイル番号
+	* @param[in] span_buffer 1行分のピクセルの作業領域(SoftwareTileSize以上の要素数が必要)
+	*/
+	void RasterizeTile(int tile_index, DWORD* span_buffer);
+
+	/**
+	* @brief 三角形のラスタライズ関数
+	* @param[in] triangle 三角形
+	* @param[in] left 描画範囲の左端
+	* @param[in] top 描画範囲の上端
+	* @param[in] right 描画範囲の右端(範囲に含まない)
+	* @param[in] bottom 描画範囲の下端(範囲に含まない)
+	* @param[in] span_buffer 1行分のピクセルの作業領域
+	*/
+	void RasterizeTriangle(const SoftwareTriangle& triangle, int left, int top, int right, int bottom, DWORD* span_buffer);
+
+private:
+	LPDIRECT3D9 m_D3DInterface;								//!< DirectGraphicsインターフェース
+	LPDIRECT3DDEVICE9 m_D3DDevice;							//!< テクスチャ読み込み用のNULLREFデバイス
+	int m_BackBufferWidth;									//!< バックバッファの横幅
+	int m_BackBufferHeight;									//!< バックバッファの縦幅
+	int m_TileCountX;										//!< 横方向のタイル数
+	int m_TileCountY;										//!< 縦方向のタイル数
+	int m_WorkerCount;										//!< ラスタライズを行うスレッド数
+	int m_CurrentTextureIndex;								//!< 設定中のテクスチャ番号
+	std::vector<DWORD> m_FrameBuffer;						//!< フレームバッファ
+	std::vector<SoftwareTriangle> m_TriangleList;			//!< フレーム中に蓄積した三角形
+	std::vector<SoftwareTextureView> m_TextureList;			//!< フレーム中に使用したテクスチャ
+	std::vector<std::vector<int>> m_TileTriangleList;		//!< タイルごとの三角形番号
+	std::vector<std::thread> m_WorkerThreadList;			//!< ラスタライズスレッド(呼び出し元のスレッドを含まない)
+	HANDLE m_StartSemaphore;								//!< ラスタライズスレッドを起こすセマフォ
+	HANDLE m_FinishedEvent;									//!< 全てのラスタライズスレッドが作業を終えたことを通知するイベント
+	std::atomic<int> m_NextTile;							//!< 次にラスタライズするタイル番号
+	int m_FrameTileCount;									//!< ラスタライズするタイル数
+	std::atomic<int> m_PendingWorkerCount;					//!< 作業を終えていないラスタライズスレッドの数
+	std::atomic<bool> m_IsStopRequested;					//!< ラスタライズスレッドの停止要求フラグ
+};
+
+#endif
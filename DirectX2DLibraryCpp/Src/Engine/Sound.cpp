@@ -1,16 +1,21 @@
 ﻿#include <stdio.h>
+#include <string.h>
 #include <map>
 #include <vector>
 #include "Window.h"
 #include "Sound.h"
+#include "Engine.h"
+#include "Profiler.h"
 
 #pragma comment(lib, "dsound.lib")
 #pragma comment(lib, "dxguid.lib")
 // mmioで必要
 #pragma comment(lib, "winmm.lib")
 
-bool Sound::Initialize()
+bool Sound::Initialize(const FileSystem* file_system)
 {
+	m_FileSystem = file_system;
+
 	// DirectSoundの生成
 	if (FAILED(DirectSoundCreate8(
 			nullptr,			// GUID
@@ -66,30 +71,63 @@ bool Sound::LoadSoundFile(const char* keyword, const char* file_name)
 		return false;
 	}
 
+	bool is_succeeded = CreateSoundBuffer(keyword, wav_data);
+
+	// コピーが終わったのでサウンドデータを解放
+	delete[] wav_data.SoundBuffer;
+
+	return is_succeeded;
+}
+
+bool Sound::CreateSoundBuffer(const char* keyword, const WavData& wav_data)
+{
+	unsigned long long hash = FileSystem::HashContent(wav_data.SoundBuffer, wav_data.Size);
+
+	// 同じ波形データが登録済みの場合は複製してデータを共有する(ハッシュ値が衝突した場合に備えて形式とサイズも比較する)
+	auto shared = m_SharedBufferList.find(hash);
+	bool is_same_content = shared != m_SharedBufferList.end() &&
+		shared->second.Size == wav_data.Size &&
+		memcmp(&shared->second.WavFormat, &wav_data.WavFormat, sizeof(WAVEFORMATEX)) == 0;
+
+	// 複製に失敗した場合(ハードウェアバッファなど)は共有せずに通常の作成を行う
+	LPDIRECTSOUNDBUFFER duplicate_buffer = nullptr;
+	if (is_same_content == true &&
+		SUCCEEDED(m_Interface->DuplicateSoundBuffer(shared->second.Source, &duplicate_buffer)))
+	{
+		// 同じキーワードで読み込み直した場合は古いバッファを解放する(複製したバッファが参照しているので共有データは残る)
+		shared->second.ReferenceCount++;
+		ReleaseSoundFile(keyword);
+		m_BufferList[keyword] = duplicate_buffer;
+		m_BufferHashList[keyword] = hash;
+
+		return true;
+	}
+
 	// バッファ情報の設定
+	WAVEFORMATEX wav_format = wav_data.WavFormat;
 	DSBUFFERDESC dsbd;
 	ZeroMemory(&dsbd, sizeof(DSBUFFERDESC));
 	dsbd.dwSize = sizeof(DSBUFFERDESC);
 	dsbd.dwFlags = DSBCAPS_CTRLPAN | DSBCAPS_CTRLVOLUME;
 	dsbd.dwBufferBytes = wav_data.Size;
 	dsbd.guid3DAlgorithm = DS3DALG_DEFAULT;
-	dsbd.lpwfxFormat = &wav_data.WavFormat;
+	dsbd.lpwfxFormat = &wav_format;
 
 	// セカンダリバッファ作成
+	LPDIRECTSOUNDBUFFER sound_buffer = nullptr;
 	if (FAILED(m_Interface->CreateSoundBuffer(
 			&dsbd,							// バッファ情報
-			&m_BufferList[keyword],	// 作成されたバッファの保存先
+			&sound_buffer,					// 作成されたバッファの保存先
 			nullptr)))
 	{
 		// 作成失敗
-		delete[] wav_data.SoundBuffer;
 		return false;
 	}
 
 	// 波形データを書き込むためにセカンダリバッファをロックする
 	void* buffer;
 	DWORD buffer_size;
-	if (FAILED(m_BufferList[keyword]->Lock(
+	if (FAILED(sound_buffer->Lock(
 		0,				// オフセット
 		wav_data.Size,	// ロックするバッファサイズ
 		&buffer,		// ロックされたバッファパート１の保存先
@@ -99,33 +137,54 @@ bool Sound::LoadSoundFile(const char* keyword, const char* file_name)
 		0)))			// ロックオプション
 	{
 		// ロック失敗
-		delete[] wav_data.SoundBuffer;
+		sound_buffer->Release();
 		return false;
 	}
 
 	memcpy(buffer, wav_data.SoundBuffer, buffer_size);
 
-	m_BufferList[keyword]->Unlock(
+	sound_buffer->Unlock(
 		&buffer,		// アンロックするバッファパート１
 		buffer_size,	// パート１のバッファサイズ
 		nullptr,		// アンロックするバッファパート２
 		0);				// パート２のバッファサイズ
 
-	// コピーが終わったのでサウンドデータを解放
-	delete[] wav_data.SoundBuffer;
+	// 同じキーワードで読み込み直した場合は古いバッファを解放する
+	ReleaseSoundFile(keyword);
+	m_BufferList[keyword] = sound_buffer;
+
+	// ハッシュ値が衝突した場合と複製に失敗した場合は共有しない
+	if (m_SharedBufferList.count(hash) == 0)
+	{
+		SharedSoundBuffer& new_shared = m_SharedBufferList[hash];
+		new_shared.Source = sound_buffer;
+		new_shared.Source->AddRef();
+		new_shared.WavFormat = wav_data.WavFormat;
+		new_shared.Size = wav_data.Size;
+		new_shared.ReferenceCount = 1;
+		m_BufferHashList[keyword] = hash;
+	}
 
 	return true;
 }
 
 void Sound::ReleaseSoundFile(const char* keyword)
 {
-	if (m_BufferList.count(keyword) > 0)
+	auto itr = m_BufferList.find(keyword);
+	if (itr == m_BufferList.end())
+	{
+		return;
+	}
+
+	// Stopで未登録のキーワードを指定した場合はnullptrが登録されている
+	if (itr->second != nullptr)
 	{
-		m_BufferList[keyword]->Stop();
-		m_BufferList[keyword]->Release();
-		m_BufferList[keyword] = nullptr;
-		m_BufferList.erase(keyword);
+		itr->second->Stop();
+		itr->second->Release();
 	}
+	m_BufferList.erase(itr);
+
+	ReleaseSharedReference(keyword);
 }
 
 void Sound::ReleaseAllSoundFiles()
@@ -142,6 +201,13 @@ void Sound::ReleaseAllSoundFiles()
 	}
 
 	m_BufferList.clear();
+
+	for (auto& shared : m_SharedBufferList)
+	{
+		shared.second.Source->Release();
+	}
+	m_SharedBufferList.clear();
+	m_BufferHashList.clear();
 }
 
 void Sound::Play(const char* keyword, bool is_loop)
@@ -193,39 +259,117 @@ void Sound::Stop(const char* keyword)
 
 void Sound::EraseDuplicateSound()
 {
-	for (auto itr = m_DuplicateList.begin(); itr != m_DuplicateList.end(); )
+	PROFILE_FUNCTION();
+
+	if (m_DuplicateList.empty() == true)
 	{
-		bool is_erase = false;
+		return;
+	}
+
+	// 再生中のバッファをフレームメモリに詰めてから戻し、途中の要素を削除するたびに後ろを詰め直さないようにする
+	int count = (int)m_DuplicateList.size();
+	LPDIRECTSOUNDBUFFER* playing_list = Engine::AllocateFrameArray<LPDIRECTSOUNDBUFFER>(count);
+	int playing_count = 0;
 
-		if (*itr == nullptr)
+	for (LPDIRECTSOUNDBUFFER buffer : m_DuplicateList)
+	{
+		if (buffer == nullptr)
 		{
-			is_erase = true;
+			continue;
 		}
-		else
+
+		DWORD status;
+
+		// 状態取得
+		buffer->GetStatus(&status);
+
+		if (!(status & DSBSTATUS_PLAYING))
 		{
-			DWORD status;
+			buffer->Release();
+			continue;
+		}
+
+		playing_list[playing_count] = buffer;
+		playing_count++;
+	}
 
-			// 状態取得
-			(*itr)->GetStatus(&status);
+	// 容量は変わらないので、複製再生が続いても再確保は起きない
+	m_DuplicateList.assign(playing_list, playing_list + playing_count);
+}
 
-			if (!(status & DSBSTATUS_PLAYING))
-			{
-				(*itr)->Release();
-				(*itr) = nullptr;
+int Sound::GetPlayingVoiceCount()
+{
+	int count = 0;
 
-				is_erase = true;
-			}
+	for (auto& buffer : m_BufferList)
+	{
+		if (buffer.second == nullptr)
+		{
+			continue;
 		}
 
-		if (is_erase == true)
+		DWORD status;
+		buffer.second->GetStatus(&status);
+		if (status & DSBSTATUS_PLAYING)
 		{
-			itr = m_DuplicateList.erase(itr);
+			count++;
 		}
-		else
+	}
+
+	// 複製再生は終了したものが毎フレーム削除されるので残っている数を再生中とみなす
+	count += (int)m_DuplicateList.size();
+
+	return count;
+}
+
+size_t Sound::GetBufferMemorySize()
+{
+	size_t size = 0;
+
+	// 共有している波形データは1つ分だけ数える
+	for (auto& shared : m_SharedBufferList)
+	{
+		size += shared.second.Size;
+	}
+
+	for (auto& buffer : m_BufferList)
+	{
+		if (buffer.second == nullptr || m_BufferHashList.count(buffer.first) > 0)
+		{
+			continue;
+		}
+
+		DSBCAPS caps;
+		caps.dwSize = sizeof(DSBCAPS);
+		if (SUCCEEDED(buffer.second->GetCaps(&caps)))
 		{
-			itr++;
+			size += caps.dwBufferBytes;
 		}
 	}
+
+	return size;
+}
+
+SoundMemoryStats Sound::GetStats()
+{
+	SoundMemoryStats stats;
+	stats.BufferSize = GetBufferMemorySize();
+
+	for (auto& buffer : m_BufferList)
+	{
+		if (buffer.second != nullptr)
+		{
+			stats.SoundCount++;
+		}
+	}
+
+	for (auto& shared : m_SharedBufferList)
+	{
+		stats.SharedCount += shared.second.ReferenceCount - 1;
+		stats.SharedSize += (size_t)shared.second.Size * (shared.second.ReferenceCount - 1);
+	}
+
+	return stats;
 }
 
 bool Sound::LoadWavFile(const char* file_name, WavData* out_wave_data)
@@ -241,10 +385,22 @@ bool Sound::LoadWavFile(const char* file_name, WavData* out_wave_data)
 	// WAVファイル内音サンプルのサイズ
 	DWORD dwWavSize = 0;
 
+	// アーカイブにある場合はメモリをファイルとして開く(読み込みのみなので書き換えられない)
+	FileData file_data;
+	MMIOINFO mmio_info;
+	ZeroMemory(&mmio_info, sizeof(MMIOINFO));
+	if (m_FileSystem != nullptr &&
+		m_FileSystem->ReadFile(file_name, &file_data) == true)
+	{
+		mmio_info.fccIOProc = FOURCC_MEM;
+		mmio_info.pchBuffer = (HPSTR)file_data.Data;
+		mmio_info.cchBuffer = (LONG)file_data.Size;
+	}
+
 	// WAVファイルを開く
 	mmio_handle = mmioOpen(
-		(char*)file_name,	// ファイル名
-		nullptr,			// MMIO情報
+		mmio_info.pchBuffer != nullptr ? nullptr : (char*)file_name,	// ファイル名
+		mmio_info.pchBuffer != nullptr ? &mmio_info : nullptr,			// MMIO情報
 		MMIO_READ);			// オープンモード
 
 	if (mmio_handle == nullptr)
@@ -332,3 +488,29 @@ bool Sound::LoadWavFile(const char* file_name, WavData* out_wave_data)
 
 	return true;
 }
+
+void Sound::ReleaseSharedReference(const std::string& keyword)
+{
+	auto hash = m_BufferHashList.find(keyword);
+	if (hash == m_BufferHashList.end())
+	{
+		return;
+	}
+
+	auto shared = m_SharedBufferList.find(hash->second);
+	m_BufferHashList.erase(hash);
+
+	if (shared == m_SharedBufferList.end())
+	{
+		return;
+	}
+
+	shared->second.ReferenceCount--;
+	if (shared->second.ReferenceCount > 0)
+	{
+		return;
+	}
+
+	shared->second.Source->Release();
+	m_SharedBufferList.erase(shared);
+}
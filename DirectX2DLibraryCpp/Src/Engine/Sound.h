@@ -11,7 +11,10 @@
 
 #include <dsound.h>
 #include <map>
+#include <string>
+#include <unordered_map>
 #include <vector>
+#include "FileSystem.h"
 
 /** @brief Wavデータ格納用 */
 struct WavData
@@ -21,7 +24,32 @@ struct WavData
 	DWORD Size;				//!< サイズ
 };
 
-/** @brief サウンドクラス */
+/** @brief サウンドバッファの使用メモリの状況 */
+struct SoundMemoryStats
+{
+	/** Constructor */
+	SoundMemoryStats() :
+		BufferSize(0),
+		SoundCount(0),
+		SharedCount(0),
+		SharedSize(0)
+	{
+	}
+
+	size_t BufferSize;	//!< サウンドバッファのバイト数(共有しているデータは1つ分)
+	int SoundCount;		//!< 登録されているサウンドの数
+	int SharedCount;	//!< 同じ内容の読み込み済みサウンドとデータを共有しているキーワードの数
+	size_t SharedSize;	//!< 共有によって確保せずに済んだバイト数
+};
+
+/**
+* @brief サウンドクラス
+* @details <pre>
+* サウンドバッファの作成時に波形データのハッシュ値を計算し、同じ内容のサウンドが登録されていればDuplicateSoundBufferで複製する
+* 複製したバッファは波形データを共有し、再生位置や音量はキーワードごとに持つ
+* 波形データは最後のキーワードを解放した時に解放される
+* </pre>
+*/
 class Sound
 {
 public:
@@ -30,8 +58,9 @@ public:
 	* @details サウンドを使用するための初期化を行う
 	* @retval true 初期化成功
 	* @retval false 初期化失敗
+	* @param[in] file_system Wavファイルの読み込み元の仮想ファイルシステム(nullptrの場合はファイルから直接読み込む)(オプション)
 	*/
-	bool Initialize();
+	bool Initialize(const FileSystem* file_system = nullptr);
 
 	/**
 	* @brief サウンド機能終了関数
@@ -77,6 +106,21 @@ public:
 	*/
 	bool LoadSoundFile(const char* keyword, const char* file_name);
 
+	/**
+	* @brief サウンドバッファの作成関数
+	* @details <pre>
+	* 読み込み済みのWavデータからセカンダリバッファを作成し、keywordの文字列で登録する
+	* 同じ内容のサウンドが登録されている場合は、そのバッファを複製して波形データを共有する
+	* 登録済みのキーワードの場合は古いバッファを解放して置き換える
+	* ※wav_data.SoundBufferは解放しない
+	* </pre>
+	* @retval true 作成成功
+	* @retval false 作成失敗
+	* @param[in] keyword 登録用キーワード
+	* @param[in] wav_data LoadWavFileで読み込んだWavデータ
+	*/
+	bool CreateSoundBuffer(const char* keyword, const WavData& wav_data);
+
 	/**
 	* @brief サウンドファイル解放関数
 	* @details 指定されたキーワードのサウンドファイルを解放する
@@ -99,11 +143,33 @@ public:
 	*/
 	void EraseDuplicateSound();
 
+	/**
+	* @brief 再生中サウンド数の取得関数
+	* @details 通常再生と複製再生を合わせた再生中のサウンド数を返す
+	* @retval int 再生中のサウンド数
+	*/
+	int GetPlayingVoiceCount();
+
+	/**
+	* @brief サウンドバッファのメモリ使用量の取得関数
+	* @details 読み込んだサウンドのバッファサイズの合計を返す(複製バッファは元のバッファとデータを共有するので含めない)
+	* @retval size_t バッファサイズの合計(バイト)
+	*/
+	size_t GetBufferMemorySize();
+
+	/**
+	* @brief 使用メモリの状況の取得関数
+	* @retval SoundMemoryStats 使用メモリの状況
+	*/
+	SoundMemoryStats GetStats();
+
 	/**
 	* @brief Wavファイルの読み込み関数
 	* @details <pre>
 	* 引数で指定したWavファイルを読み込む
 	* ※LoadSoundFileで実行する関数なので使用者は実行する必要がない
+	* マウントしたアーカイブにあるファイルはアーカイブのメモリから読み込む
+	* メンバを変更しないので、別のスレッドから実行できる
 	* </pre>
 	* @retval true 読み込み成功
 	* @retval false 読み込み失敗
@@ -112,10 +178,30 @@ public:
 	*/
 	bool LoadWavFile(const char* file_name, WavData* out_wave_data);
 
+private:
+	/** @brief 複数のキーワードで共有している波形データ */
+	struct SharedSoundBuffer
+	{
+		LPDIRECTSOUNDBUFFER Source;	//!< 複製元のバッファ(参照を1つ保持する)
+		WAVEFORMATEX WavFormat;		//!< Wavフォーマットデータ
+		DWORD Size;					//!< 波形データのバイト数
+		int ReferenceCount;			//!< 使用しているキーワードの数
+	};
+
+	/**
+	* @brief 共有の参照の解除関数
+	* @details 最後の参照だった場合は複製元のバッファを解放する
+	* @param[in] keyword 解除するサウンドのキーワード
+	*/
+	void ReleaseSharedReference(const std::string& keyword);
+
 private:
 	LPDIRECTSOUND8 m_Interface = nullptr;						//!< サウンドデバイス
-	std::map<const char*, LPDIRECTSOUNDBUFFER> m_BufferList;	//!< サウンドデータ保存用
+	std::map<std::string, LPDIRECTSOUNDBUFFER> m_BufferList;	//!< サウンドデータ保存用
 	std::vector<LPDIRECTSOUNDBUFFER> m_DuplicateList;			//!< 複製バッファ保存用
+	const FileSystem* m_FileSystem = nullptr;					//!< Wavファイルの読み込み元の仮想ファイルシステム
+	std::unordered_map<unsigned long long, SharedSoundBuffer> m_SharedBufferList;	//!< 波形データのハッシュ値ごとの共有バッファ
+	std::map<std::string, unsigned long long> m_BufferHashList;	//!< キーワードごとの波形データのハッシュ値(共有していないバッファは含まない)
 };
 
 #endif
@@ -0,0 +1,341 @@
+﻿#include <malloc.h>
+#include <stdio.h>
+#include "TaggedAllocator.h"
+
+namespace
+{
+	/** @brief 確保したメモリの前に置くヘッダー */
+	struct MemoryHeader
+	{
+		size_t Size;		//!< 確保したバイト数
+		int Tag;			//!< タグ
+		int PoolIndex;		//!< 確保したプールの番号(ヒープから確保した場合は-1、集計せずに確保した場合はUntrackedPoolIndex)
+	};
+
+	static_assert(sizeof(MemoryHeader) <= MemoryHeaderSize, "MemoryHeader must fit in MemoryHeaderSize");
+
+	const int UntrackedPoolIndex = -2;	//!< アロケーターの初期化前に集計せずにヒープから確保したメモリのプール番号
+}
+
+std::atomic<TaggedAllocator*> TaggedAllocator::m_GlobalInstance(nullptr);
+
+void FixedSizePool::Initialize(size_t block_size)
+{
+	Release();
+
+	m_BlockSize = block_size;
+}
+
+void FixedSizePool::Release()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	for (char* page : m_PageList)
+	{
+		_aligned_free(page);
+	}
+	m_PageList.clear();
+
+	m_FreeList = nullptr;
+	m_UsedCount = 0;
+	m_Capacity = 0;
+}
+
+void* FixedSizePool::Allocate()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	if (m_FreeList == nullptr)
+	{
+		char* page = (char*)_aligned_malloc(MemoryPoolPageSize, MemoryHeaderSize);
+		if (page == nullptr)
+		{
+			return nullptr;
+		}
+		m_PageList.push_back(page);
+
+		// 新しい領域をブロックに分けて空きリストに繋ぐ
+		int block_count = (int)(MemoryPoolPageSize / m_BlockSize);
+		for (int i = block_count - 1; i >= 0; i--)
+		{
+			FreeBlock* block = (FreeBlock*)(page + m_BlockSize * i);
+			block->Next = m_FreeList;
+			m_FreeList = block;
+		}
+		m_Capacity += block_count;
+	}
+
+	FreeBlock* block = m_FreeList;
+	m_FreeList = block->Next;
+	m_UsedCount++;
+
+	return block;
+}
+
+void FixedSizePool::Free(void* block)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	FreeBlock* free_block = (FreeBlock*)block;
+	free_block->Next = m_FreeList;
+	m_FreeList = free_block;
+	m_UsedCount--;
+}
+
+MemoryPoolStats FixedSizePool::GetStats()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	MemoryPoolStats stats;
+	stats.BlockSize = m_BlockSize;
+	stats.UsedCount = m_UsedCount;
+	stats.Capacity = m_Capacity;
+
+	return stats;
+}
+
+void TaggedAllocator::Initialize()
+{
+	for (int i = 0; i < MemoryPoolCount; i++)
+	{
+		m_PoolList[i].Initialize(MemoryPoolBlockSizeList[i]);
+	}
+
+	m_GlobalInstance.store(this);
+}
+
+void TaggedAllocator::Release()
+{
+	// 解放後にAllocateGlobalで確保したメモリは集計せずにヒープから確保する
+	TaggedAllocator* global_instance = this;
+	m_GlobalInstance.compare_exchange_strong(global_instance, nullptr);
+
+	// 解放漏れはタグごとにまとめて出力する(プールを解放した後は参照できなくなる)
+	for (int i = 0; i < MemoryTagMax; i++)
+	{
+		int count = m_TagList[i].AllocationCount.load();
+		if (count == 0)
+		{
+			continue;
+		}
+
+		char text[128];
+		sprintf_s(text, sizeof(text), "[Memory] %s: %d allocations (%u bytes) were not freed\n",
+			GetTagName((MemoryTag)i), count, (unsigned int)m_TagList[i].AllocatedSize.load());
+		OutputDebugString(text);
+	}
+
+	// 解放漏れのブロックが後からFreeGlobalで解放されてもヘッダーを読めるように、使用中のブロックがあるプールは残す
+	for (FixedSizePool& pool : m_PoolList)
+	{
+		if (pool.GetStats().UsedCount == 0)
+		{
+			pool.Release();
+		}
+	}
+}
+
+void* TaggedAllocator::Allocate(MemoryTag tag, size_t size)
+{
+	size_t block_size = size + MemoryHeaderSize;
+
+	int pool_index = -1;
+	for (int i = 0; i < MemoryPoolCount; i++)
+	{
+		if (block_size <= MemoryPoolBlockSizeList[i])
+		{
+			pool_index = i;
+			break;
+		}
+	}
+
+	char* block = nullptr;
+	if (pool_index >= 0)
+	{
+		block = (char*)m_PoolList[pool_index].Allocate();
+	}
+	else
+	{
+		block = (char*)_aligned_malloc(block_size, MemoryHeaderSize);
+	}
+
+	if (block == nullptr)
+	{
+		return nullptr;
+	}
+
+	MemoryHeader* header = (MemoryHeader*)block;
+	header->Size = size;
+	header->Tag = tag;
+	header->PoolIndex = pool_index;
+
+	TagCounter& counter = m_TagList[tag];
+	counter.AllocatedSize.fetch_add(size, std::memory_order_relaxed);
+	counter.AllocationCount.fetch_add(1, std::memory_order_relaxed);
+	CheckTotalSize(tag);
+
+	return block + MemoryHeaderSize;
+}
+
+void TaggedAllocator::Free(void* memory)
+{
+	if (memory == nullptr)
+	{
+		return;
+	}
+
+	char* block = (char*)memory - MemoryHeaderSize;
+	MemoryHeader* header = (MemoryHeader*)block;
+	if (header->PoolIndex == UntrackedPoolIndex)
+	{
+		_aligned_free(block);
+		return;
+	}
+
+	MemoryTag tag = (MemoryTag)header->Tag;
+
+	TagCounter& counter = m_TagList[tag];
+	counter.AllocatedSize.fetch_sub(header->Size, std::memory_order_relaxed);
+	counter.AllocationCount.fetch_sub(1, std::memory_order_relaxed);
+
+	if (header->PoolIndex >= 0)
+	{
+		m_PoolList[header->PoolIndex].Free(block);
+	}
+	else
+	{
+		_aligned_free(block);
+	}
+
+	CheckTotalSize(tag);
+}
+
+void TaggedAllocator::SetExternalSize(MemoryTag tag, size_t size)
+{
+	m_TagList[tag].ExternalSize.store(size, std::memory_order_relaxed);
+	CheckTotalSize(tag);
+}
+
+void TaggedAllocator::SetBudget(MemoryTag tag, size_t budget)
+{
+	m_TagList[tag].Budget.store(budget, std::memory_order_relaxed);
+	CheckTotalSize(tag);
+}
+
+MemoryTagStats TaggedAllocator::GetTagStats(MemoryTag tag) const
+{
+	const TagCounter& counter = m_TagList[tag];
+
+	MemoryTagStats stats;
+	stats.AllocatedSize = counter.AllocatedSize.load(std::memory_order_relaxed);
+	stats.ExternalSize = counter.ExternalSize.load(std::memory_order_relaxed);
+	stats.PeakSize = counter.PeakSize.load(std::memory_order_relaxed);
+	stats.Budget = counter.Budget.load(std::memory_order_relaxed);
+	stats.AllocationCount = counter.AllocationCount.load(std::memory_order_relaxed);
+	stats.OverBudgetCount = counter.OverBudgetCount.load(std::memory_order_relaxed);
+
+	return stats;
+}
+
+MemoryPoolStats TaggedAllocator::GetPoolStats(int pool_index)
+{
+	if (pool_index < 0 || pool_index >= MemoryPoolCount)
+	{
+		return MemoryPoolStats();
+	}
+
+	return m_PoolList[pool_index].GetStats();
+}
+
+void* TaggedAllocator::AllocateGlobal(MemoryTag tag, size_t size)
+{
+	TaggedAllocator* allocator = m_GlobalInstance.load();
+	if (allocator != nullptr)
+	{
+		return allocator->Allocate(tag, size);
+	}
+
+	char* block = (char*)_aligned_malloc(size + MemoryHeaderSize, MemoryHeaderSize);
+	if (block == nullptr)
+	{
+		return nullptr;
+	}
+
+	MemoryHeader* header = (MemoryHeader*)block;
+	header->Size = size;
+	header->Tag = tag;
+	header->PoolIndex = UntrackedPoolIndex;
+
+	return block + MemoryHeaderSize;
+}
+
+void TaggedAllocator::FreeGlobal(void* memory)
+{
+	if (memory == nullptr)
+	{
+		return;
+	}
+
+	TaggedAllocator* allocator = m_GlobalInstance.load();
+	if (allocator != nullptr)
+	{
+		allocator->Free(memory);
+		return;
+	}
+
+	// 解放後はプールの領域も解放済みなので、ヒープから確保したものだけを解放する
+	char* block = (char*)memory - MemoryHeaderSize;
+	MemoryHeader* header = (MemoryHeader*)block;
+	if (header->PoolIndex < 0)
+	{
+		_aligned_free(block);
+	}
+}
+
+const char* TaggedAllocator::GetTagName(MemoryTag tag)
+{
+	static const char* tag_names[MemoryTagMax] =
+	{
+		"Graphics",
+		"Sound",
+		"Texture",
+		"Game",
+	};
+
+	return tag >= 0 && tag < MemoryTagMax ? tag_names[tag] : "Unknown";
+}
+
+void TaggedAllocator::CheckTotalSize(MemoryTag tag)
+{
+	TagCounter& counter = m_TagList[tag];
+	size_t total = counter.AllocatedSize.load(std::memory_order_relaxed) + counter.ExternalSize.load(std::memory_order_relaxed);
+
+	size_t peak = counter.PeakSize.load(std::memory_order_relaxed);
+	while (total > peak && counter.PeakSize.compare_exchange_weak(peak, total, std::memory_order_relaxed) == false)
+	{
+	}
+
+	size_t budget = counter.Budget.load(std::memory_order_relaxed);
+	if (budget == 0 || total <= budget)
+	{
+		// 確保のたびに書き込むとスレッド間でキャッシュラインを奪い合うので、変わる時だけ書き込む
+		if (counter.IsOverBudget.load(std::memory_order_relaxed) == true)
+		{
+			counter.IsOverBudget.store(false, std::memory_order_relaxed);
+		}
+		return;
+	}
+
+	// 超えている間は毎回出力せず、超えた時に1回だけ出力する
+	if (counter.IsOverBudget.exchange(true, std::memory_order_relaxed) == true)
+	{
+		return;
+	}
+
+	counter.OverBudgetCount.fetch_add(1, std::memory_order_relaxed);
+
+	char text[128];
+	sprintf_s(text, sizeof(text), "[Memory] %s: budget exceeded (%u KB / %u KB)\n",
+		GetTagName(tag), (unsigned int)(total / 1024), (unsigned int)(budget / 1024));
+	OutputDebugString(text);
+}
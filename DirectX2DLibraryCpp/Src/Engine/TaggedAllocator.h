@@ -0,0 +1,363 @@
+﻿/**
+* @file TaggedAllocator.h
+* @brief <pre>
+* 確保したメモリをサブシステムごとのタグで集計するアロケーターの宣言
+* 小さい確保はサイズごとの固定長プールから行い、ヒープの断片化と確保のコストを抑える
+* タグごとに予算を設定でき、予算を超えた時に警告を出力する
+* サブシステムが持つSTLコンテナはTaggedStlAllocatorでタグを付けて確保する
+* </pre>
+*/
+#ifndef TAGGED_ALLOCATOR_H_
+#define TAGGED_ALLOCATOR_H_
+
+#include <Windows.h>
+#include <stddef.h>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+const int MemoryPoolCount = 5;													//!< 固定長プールの数
+const size_t MemoryPoolBlockSizeList[MemoryPoolCount] = { 32, 64, 128, 256, 512 };	//!< 固定長プールのブロックサイズ(ヘッダーを含む)
+const size_t MemoryPoolPageSize = 64 * 1024;									//!< 固定長プールが一度に確保する領域のサイズ
+const size_t MemoryHeaderSize = 16;												//!< 確保したメモリの前に置くヘッダーのサイズ(アライメントを16に保つ)
+
+/** @brief メモリのタグ */
+enum MemoryTag
+{
+	MemoryTagGraphics,		//!< 描画
+	MemoryTagSound,			//!< サウンド
+	MemoryTagTexture,		//!< テクスチャ(ビットマップフォントのページを含む)
+	MemoryTagGame,			//!< ゲーム
+	MemoryTagMax,			//!< タグの最大数
+};
+
+/** @brief タグごとの使用状況 */
+struct MemoryTagStats
+{
+	/** Constructor */
+	MemoryTagStats() :
+		AllocatedSize(0),
+		ExternalSize(0),
+		PeakSize(0),
+		Budget(0),
+		AllocationCount(0),
+		OverBudgetCount(0)
+	{
+	}
+
+	/**
+	* @brief 合計サイズの取得関数
+	* @retval size_t アロケーターで確保したサイズと外部で確保したサイズの合計
+	*/
+	size_t GetTotalSize() const
+	{
+		return AllocatedSize + ExternalSize;
+	}
+
+	size_t AllocatedSize;		//!< アロケーターで確保中のバイト数(ヘッダーを除く)
+	size_t ExternalSize;		//!< デバイスなどの外部で確保されたバイト数(テクスチャ、サウンドバッファ)
+	size_t PeakSize;			//!< 合計サイズの最大値
+	size_t Budget;				//!< 予算(0の場合は予算なし)
+	int AllocationCount;		//!< 確保中の数
+	int OverBudgetCount;		//!< 予算を超えた回数
+};
+
+/** @brief 固定長プールの使用状況 */
+struct MemoryPoolStats
+{
+	/** Constructor */
+	MemoryPoolStats() :
+		BlockSize(0),
+		UsedCount(0),
+		Capacity(0)
+	{
+	}
+
+	size_t BlockSize;		//!< ブロックサイズ
+	int UsedCount;			//!< 使用中のブロック数
+	int Capacity;			//!< 確保済みのブロック数(使用中の割合が低いほど空きが多い)
+};
+
+/**
+* @brief 固定長プールクラス
+* @details <pre>
+* 同じサイズのブロックを空きリストで管理し、確保と解放を定数時間で行う
+* 領域はMemoryPoolPageSizeごとに確保し、Releaseまで解放しない
+* 複数のスレッドから使用できる
+* </pre>
+*/
+class FixedSizePool
+{
+public:
+	/** Constructor */
+	FixedSizePool() :
+		m_BlockSize(0),
+		m_PageList(),
+		m_FreeList(nullptr),
+		m_UsedCount(0),
+		m_Capacity(0),
+		m_Mutex()
+	{
+	}
+
+	/**
+	* @brief 初期化関数
+	* @param[in] block_size ブロックサイズ(16の倍数)
+	*/
+	void Initialize(size_t block_size);
+
+	/**
+	* @brief 解放関数
+	* @details 確保した全ての領域を解放する
+	*/
+	void Release();
+
+	/**
+	* @brief 確保関数
+	* @retval void* 確保したブロック(領域の確保に失敗した場合はnullptr)
+	*/
+	void* Allocate();
+
+	/**
+	* @brief 解放関数
+	* @param[in] block Allocateで確保したブロック
+	*/
+	void Free(void* block);
+
+	/**
+	* @brief 使用状況の取得関数
+	* @retval MemoryPoolStats 使用状況
+	*/
+	MemoryPoolStats GetStats();
+
+private:
+	/** @brief 空きブロック */
+	struct FreeBlock
+	{
+		FreeBlock* Next;		//!< 次の空きブロック
+	};
+
+private:
+	size_t m_BlockSize;				//!< ブロックサイズ
+	std::vector<char*> m_PageList;	//!< 確保した領域
+	FreeBlock* m_FreeList;			//!< 空きブロックのリスト
+	int m_UsedCount;				//!< 使用中のブロック数
+	int m_Capacity;					//!< 確保済みのブロック数
+	std::mutex m_Mutex;				//!< 排他制御
+};
+
+/**
+* @brief タグ付きアロケータークラス
+* @details <pre>
+* 確保したメモリの前にタグとサイズを記録したヘッダーを置き、解放時にタグの集計から差し引く
+* ヘッダーを含めてプールのブロックに収まる確保はプールから、それ以外はヒープから行う
+* 集計はatomic変数で行うので、複数のスレッドから使用できる
+* </pre>
+*/
+class TaggedAllocator
+{
+public:
+	/** Constructor */
+	TaggedAllocator() :
+		m_TagList(),
+		m_PoolList()
+	{
+	}
+
+	/**
+	* @brief 初期化関数
+	*/
+	void Initialize();
+
+	/**
+	* @brief 解放関数
+	* @details 解放されていないメモリがあるタグを警告として出力してから、プールを解放する(使用中のブロックがあるプールは残す)
+	*/
+	void Release();
+
+	/**
+	* @brief 確保関数
+	* @retval void* 確保したメモリ(16バイト境界、確保に失敗した場合はnullptr)
+	* @param[in] tag タグ
+	* @param[in] size 確保するバイト数
+	*/
+	void* Allocate(MemoryTag tag, size_t size);
+
+	/**
+	* @brief 解放関数
+	* @param[in] memory Allocateで確保したメモリ(nullptrの場合は何もしない)
+	*/
+	void Free(void* memory);
+
+	/**
+	* @brief 外部で確保されたサイズの設定関数
+	* @details テクスチャやサウンドバッファなどのアロケーターを経由しないメモリをタグに加える
+	* @param[in] tag タグ
+	* @param[in] size 外部で確保されたバイト数
+	*/
+	void SetExternalSize(MemoryTag tag, size_t size);
+
+	/**
+	* @brief 予算の設定関数
+	* @details 合計サイズが予算を超えた時に警告を出力する(予算内に戻った後に再度超えた場合も出力する)
+	* @param[in] tag タグ
+	* @param[in] budget 予算(バイト、0の場合は予算なし)
+	*/
+	void SetBudget(MemoryTag tag, size_t budget);
+
+	/**
+	* @brief タグの使用状況の取得関数
+	* @retval MemoryTagStats 使用状況
+	* @param[in] tag タグ
+	*/
+	MemoryTagStats GetTagStats(MemoryTag tag) const;
+
+	/**
+	* @brief 固定長プールの使用状況の取得関数
+	* @retval MemoryPoolStats 使用状況
+	* @param[in] pool_index プールの番号(0～MemoryPoolCount - 1)
+	*/
+	MemoryPoolStats GetPoolStats(int pool_index);
+
+	/**
+	* @brief タグ名の取得関数
+	* @retval const char* タグ名
+	* @param[in] tag タグ
+	*/
+	static const char* GetTagName(MemoryTag tag);
+
+	/**
+	* @brief 共通のアロケーターからの確保関数
+	* @details <pre>
+	* 最後にInitializeしたアロケーターから確保する(TaggedStlAllocatorで使用する)
+	* 初期化前や解放後はタグを集計せずにヒープから確保するので、エンジンの外で作成したコンテナもそのまま使用できる
+	* </pre>
+	* @retval void* 確保したメモリ(16バイト境界、確保に失敗した場合はnullptr)
+	* @param[in] tag タグ
+	* @param[in] size 確保するバイト数
+	*/
+	static void* AllocateGlobal(MemoryTag tag, size_t size);
+
+	/**
+	* @brief 共通のアロケーターへの解放関数
+	* @param[in] memory AllocateGlobalで確保したメモリ(nullptrの場合は何もしない)
+	*/
+	static void FreeGlobal(void* memory);
+
+private:
+	/** @brief タグごとの集計 */
+	struct TagCounter
+	{
+		/** Constructor */
+		TagCounter() :
+			AllocatedSize(0),
+			ExternalSize(0),
+			PeakSize(0),
+			Budget(0),
+			AllocationCount(0),
+			OverBudgetCount(0),
+			IsOverBudget(false)
+		{
+		}
+
+		std::atomic<size_t> AllocatedSize;		//!< アロケーターで確保中のバイト数
+		std::atomic<size_t> ExternalSize;		//!< 外部で確保されたバイト数
+		std::atomic<size_t> PeakSize;			//!< 合計サイズの最大値
+		std::atomic<size_t> Budget;				//!< 予算
+		std::atomic<int> AllocationCount;		//!< 確保中の数
+		std::atomic<int> OverBudgetCount;		//!< 予算を超えた回数
+		std::atomic<bool> IsOverBudget;			//!< 予算を超えている状態か
+	};
+
+	/**
+	* @brief 合計サイズの変更後の確認関数
+	* @details 最大値を更新し、予算を超えた時に警告を出力する
+	* @param[in] tag タグ
+	*/
+	void CheckTotalSize(MemoryTag tag);
+
+private:
+	TagCounter m_TagList[MemoryTagMax];				//!< タグごとの集計
+	FixedSizePool m_PoolList[MemoryPoolCount];		//!< 固定長プール
+
+	static std::atomic<TaggedAllocator*> m_GlobalInstance;	//!< AllocateGlobalで使用するアロケーター
+};
+
+/**
+* @brief タグ付きアロケーターを使用するSTLコンテナ用アロケーター
+* @details <pre>
+* TaggedAllocator::AllocateGlobalで確保し、確保したサイズをTagに集計する
+* タグ付きアロケーターを解放する前に、コンテナのメモリを解放しておく必要がある(解放しない場合は解放漏れとして出力される)
+* </pre>
+*/
+template<class T, MemoryTag Tag>
+class TaggedStlAllocator
+{
+public:
+	typedef T value_type;
+
+	/** @brief 別の型の要素を確保するアロケーター */
+	template<class U>
+	struct rebind
+	{
+		typedef TaggedStlAllocator<U, Tag> other;
+	};
+
+	/** Constructor */
+	TaggedStlAllocator()
+	{
+	}
+
+	/** Copy Constructor */
+	template<class U>
+	TaggedStlAllocator(const TaggedStlAllocator<U, Tag>&)
+	{
+	}
+
+	/**
+	* @brief 確保関数
+	* @retval T* 確保したメモリ(確保に失敗した場合はstd::bad_allocを送出する)
+	* @param[in] count 要素数
+	*/
+	T* allocate(size_t count)
+	{
+		void* memory = TaggedAllocator::AllocateGlobal(Tag, count * sizeof(T));
+		if (memory == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+
+		return (T*)memory;
+	}
+
+	/**
+	* @brief 解放関数
+	* @param[in] memory allocateで確保したメモリ
+	*/
+	void deallocate(T* memory, size_t)
+	{
+		TaggedAllocator::FreeGlobal(memory);
+	}
+};
+
+/** @brief 同じタグのアロケーターは互いに解放できる */
+template<class T, class U, MemoryTag Tag>
+bool operator==(const TaggedStlAllocator<T, Tag>&, const TaggedStlAllocator<U, Tag>&)
+{
+	return true;
+}
+
+/** @brief 同じタグのアロケーターは互いに解放できる */
+template<class T, class U, MemoryTag Tag>
+bool operator!=(const TaggedStlAllocator<T, Tag>&, const TaggedStlAllocator<U, Tag>&)
+{
+	return false;
+}
+
+/** @brief タグを付けて確保するvector */
+template<class T, MemoryTag Tag>
+using TaggedVector = std::vector<T, TaggedStlAllocator<T, Tag>>;
+
+#endif
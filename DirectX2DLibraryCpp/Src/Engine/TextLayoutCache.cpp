@@ -0,0 +1,295 @@
+﻿#include <Windows.h>
+#include <string.h>
+#include <algorithm>
+#include "TextLayoutCache.h"
+#include "FrameAllocator.h"
+#include "GlyphAtlas.h"
+
+namespace
+{
+	const unsigned long long FnvOffsetBasis = 14695981039346656037ULL;
+	const unsigned long long FnvPrime = 1099511628211ULL;
+
+	/**
+	* @brief FNV-1aハッシュの更新関数
+	* @retval unsigned long long 更新後のハッシュ値
+	* @param[in] hash 更新前のハッシュ値
+	* @param[in] data データ
+	* @param[in] size データのバイト数
+	*/
+	unsigned long long HashBytes(unsigned long long hash, const void* data, size_t size)
+	{
+		const unsigned char* bytes = (const unsigned char*)data;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= FnvPrime;
+		}
+		return hash;
+	}
+
+	/**
+	* @brief 折り返し位置にできる文字かの判定関数
+	* @retval true 空白文字
+	* @retval false それ以外
+	* @param[in] code 文字コード(UTF-16)
+	*/
+	bool IsBreakableSpace(wchar_t code)
+	{
+		return code == L' ' || code == 0x3000;
+	}
+}
+
+void TextLayoutCache::NextFrame()
+{
+	m_CurrentFrame++;
+
+	// 使用順リストの末尾から一定フレーム使用されていないものを破棄する
+	while (m_LruList.empty() == false)
+	{
+		TextLayout& oldest = m_LayoutList[m_LruList.back()];
+		if (m_CurrentFrame - oldest.LastUsedFrame <= (unsigned int)MaxTextLayoutAge)
+		{
+			break;
+		}
+		Erase(m_LruList.back());
+	}
+}
+
+void TextLayoutCache::Clear()
+{
+	m_LayoutList.clear();
+	m_LruList.clear();
+}
+
+const TextLayout* TextLayoutCache::FindLayout(const char* text, int font_size, int wrap_width, GlyphAtlas* atlas, FrameAllocator* allocator, bool* out_is_hit)
+{
+	font_size = GlyphAtlas::ClampFontSize(font_size);
+	if (wrap_width < 0)
+	{
+		wrap_width = 0;
+	}
+
+	unsigned long long key = CalculateHash(text, font_size, wrap_width);
+
+	auto itr = m_LayoutList.find(key);
+	if (itr != m_LayoutList.end())
+	{
+		TextLayout& layout = itr->second;
+
+		// ハッシュが衝突していないか文字列で確認する
+		if (layout.FontSize == font_size &&
+			layout.WrapWidth == wrap_width &&
+			layout.Text == text)
+		{
+			// グリフが入れ替えられていなければ保持している頂点をそのまま使用できる
+			if (layout.IsComplete == true &&
+				layout.AtlasGeneration == atlas->GetGeneration())
+			{
+				for (const GlyphInfo* glyph : layout.Glyphs)
+				{
+					atlas->MarkGlyphUsed(glyph);
+				}
+
+				Touch(&layout);
+				*out_is_hit = true;
+				return &layout;
+			}
+		}
+		else
+		{
+			layout.Text = text;
+			layout.FontSize = font_size;
+			layout.WrapWidth = wrap_width;
+		}
+
+		BuildLayout(&layout, atlas, allocator);
+		Touch(&layout);
+		*out_is_hit = false;
+		return &layout;
+	}
+
+	// 最大数に達している場合は最も使われていないものを破棄する
+	if ((int)m_LayoutList.size() >= MaxTextLayoutCount)
+	{
+		Erase(m_LruList.back());
+	}
+
+	m_LruList.push_front(key);
+
+	TextLayout& layout = m_LayoutList[key];
+	layout.Text = text;
+	layout.FontSize = font_size;
+	layout.WrapWidth = wrap_width;
+	layout.LruPosition = m_LruList.begin();
+
+	BuildLayout(&layout, atlas, allocator);
+	layout.LastUsedFrame = m_CurrentFrame;
+	*out_is_hit = false;
+	return &layout;
+}
+
+unsigned long long TextLayoutCache::CalculateHash(const char* text, int font_size, int wrap_width)
+{
+	unsigned long long hash = HashBytes(FnvOffsetBasis, text, strlen(text));
+	hash = HashBytes(hash, &font_size, sizeof(font_size));
+	hash = HashBytes(hash, &wrap_width, sizeof(wrap_width));
+
+	return hash;
+}
+
+void TextLayoutCache::BuildLayout(TextLayout* layout, GlyphAtlas* atlas, FrameAllocator* allocator)
+{
+	layout->Vertices.clear();
+	layout->Glyphs.clear();
+	layout->IsComplete = true;
+	layout->MinX = 0.0f;
+	layout->MinY = 0.0f;
+	layout->MaxX = 0.0f;
+	layout->MaxY = 0.0f;
+
+	// 文字列(Shift-JIS)をグリフの検索に使用するUTF-16に変換する
+	int length = MultiByteToWideChar(CP_ACP, 0, layout->Text.c_str(), -1, nullptr, 0);
+	if (length <= 1)
+	{
+		layout->AtlasGeneration = atlas->GetGeneration();
+		return;
+	}
+	wchar_t* wide_text = allocator->AllocateArray<wchar_t>(length);
+	MultiByteToWideChar(CP_ACP, 0, layout->Text.c_str(), -1, wide_text, length);
+
+	int font_size = layout->FontSize;
+	int wrap_width = layout->WrapWidth;
+	float line_height = (float)atlas->GetLineHeight(font_size);
+
+	float pen_x = 0.0f;
+	float pen_y = 0.0f;
+
+	// 現在の行で最後に見つかった空白の直後の位置(単語単位の折り返しに使用する)
+	bool has_break = false;
+	size_t break_vertex = 0;
+	float break_pen_x = 0.0f;
+
+	for (int i = 0; i < length - 1; i++)
+	{
+		wchar_t code = wide_text[i];
+
+		if (code == L'\n')
+		{
+			pen_x = 0.0f;
+			pen_y += line_height;
+			has_break = false;
+			continue;
+		}
+		else if (code == L'\r')
+		{
+			continue;
+		}
+
+		const GlyphInfo* glyph = atlas->FindGlyph(code, font_size);
+		if (glyph == nullptr)
+		{
+			layout->IsComplete = false;
+			continue;
+		}
+		layout->Glyphs.push_back(glyph);
+
+		if (wrap_width > 0 && pen_x > 0.0f && pen_x + glyph->Advance > wrap_width)
+		{
+			if (IsBreakableSpace(code) == true)
+			{
+				// はみ出す空白は次の行の先頭に置かずに改行だけ行う
+				pen_x = 0.0f;
+				pen_y += line_height;
+				has_break = false;
+				continue;
+			}
+
+			if (has_break == true)
+			{
+				// 最後の空白より後ろの単語を次の行に送る
+				for (size_t j = break_vertex; j < layout->Vertices.size(); j++)
+				{
+					layout->Vertices[j].X -= break_pen_x;
+					layout->Vertices[j].Y += line_height;
+				}
+				pen_x -= break_pen_x;
+			}
+			else
+			{
+				// 空白がない場合(日本語や長い単語)は文字単位で折り返す
+				pen_x = 0.0f;
+			}
+			pen_y += line_height;
+			has_break = false;
+		}
+
+		if (glyph->Width > 0)
+		{
+			AddGlyphQuad(layout, glyph, pen_x, pen_y);
+		}
+
+		pen_x += glyph->Advance;
+
+		if (IsBreakableSpace(code) == true)
+		{
+			has_break = true;
+			break_vertex = layout->Vertices.size();
+			break_pen_x = pen_x;
+		}
+	}
+
+	// 描画時の画面外判定に使用する範囲を求める(折り返しで移動した後の位置で計算する)
+	for (const CustomVertex& vertex : layout->Vertices)
+	{
+		layout->MinX = (std::min)(layout->MinX, vertex.X);
+		layout->MinY = (std::min)(layout->MinY, vertex.Y);
+		layout->MaxX = (std::max)(layout->MaxX, vertex.X);
+		layout->MaxY = (std::max)(layout->MaxY, vertex.Y);
+	}
+
+	// グリフの作成中に他のグリフが入れ替えられることがあるので作成後の世代を記録する
+	layout->AtlasGeneration = atlas->GetGeneration();
+}
+
+void TextLayoutCache::AddGlyphQuad(TextLayout* layout, const GlyphInfo* glyph, float pen_x, float pen_y)
+{
+	// ピクセルとテクセルの中心を合わせるために0.5ずらす
+	float left = pen_x + glyph->OffsetX - 0.5f;
+	float top = pen_y + glyph->OffsetY - 0.5f;
+	float right = left + glyph->Width;
+	float bottom = top + glyph->Height;
+
+	CustomVertex v[4] =
+	{
+		{ left, top, 0.0f, 1.0f, 0, glyph->U0, glyph->V0 },
+		{ right, top, 0.0f, 1.0f, 0, glyph->U1, glyph->V0 },
+		{ right, bottom, 0.0f, 1.0f, 0, glyph->U1, glyph->V1 },
+		{ left, bottom, 0.0f, 1.0f, 0, glyph->U0, glyph->V1 },
+	};
+
+	layout->Vertices.push_back(v[0]);
+	layout->Vertices.push_back(v[1]);
+	layout->Vertices.push_back(v[2]);
+	layout->Vertices.push_back(v[0]);
+	layout->Vertices.push_back(v[2]);
+	layout->Vertices.push_back(v[3]);
+}
+
+void TextLayoutCache::Touch(TextLayout* layout)
+{
+	layout->LastUsedFrame = m_CurrentFrame;
+	m_LruList.splice(m_LruList.begin(), m_LruList, layout->LruPosition);
+}
+
+void TextLayoutCache::Erase(unsigned long long key)
+{
+	auto itr = m_LayoutList.find(key);
+	if (itr == m_LayoutList.end())
+	{
+		return;
+	}
+
+	m_LruList.erase(itr->second.LruPosition);
+	m_LayoutList.erase(itr);
+}
@@ -0,0 +1,148 @@
+﻿/**
+* @file TextLayoutCache.h
+* @brief <pre>
+* 文字列のレイアウト(グリフの検索、改行、折り返し)の結果を保持するキャッシュクラスの宣言
+* 毎フレーム同じ文字列を描画する場合は頂点のコピーだけで描画できる
+* Graphicsクラスでインスタンスを作成するので使用者が作成する必要はない
+* </pre>
+*/
+#ifndef TEXT_LAYOUT_CACHE_H_
+#define TEXT_LAYOUT_CACHE_H_
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "EngineConstant.h"
+#include "TaggedAllocator.h"
+
+class FrameAllocator;
+class GlyphAtlas;
+struct GlyphInfo;
+
+const int MaxTextLayoutCount = 1024;	//!< キャッシュできるレイアウトの最大数
+const int MaxTextLayoutAge = 300;		//!< 使用されないレイアウトを破棄するまでのフレーム数
+
+/** @brief 文字列のレイアウト */
+struct TextLayout
+{
+	std::string Text;											//!< 文字列
+	int FontSize;												//!< フォントサイズ
+	int WrapWidth;												//!< 折り返す横幅(0の場合は折り返さない)
+	TaggedVector<CustomVertex, MemoryTagGraphics> Vertices;		//!< 描画位置を原点としたグリフの矩形(三角形リスト、カラーは未設定)
+	TaggedVector<const GlyphInfo*, MemoryTagGraphics> Glyphs;	//!< 矩形に使用したグリフ
+	float MinX;													//!< 矩形全体の範囲(左端)
+	float MinY;													//!< 矩形全体の範囲(上端)
+	float MaxX;													//!< 矩形全体の範囲(右端)
+	float MaxY;													//!< 矩形全体の範囲(下端)
+	unsigned int AtlasGeneration;								//!< 作成時のグリフアトラスの世代
+	bool IsComplete;											//!< 全てのグリフを配置できたか
+	unsigned int LastUsedFrame;									//!< 最後に使用したフレーム
+	std::list<unsigned long long>::iterator LruPosition;		//!< 使用順リスト内の位置
+};
+
+/**
+* @brief 文字列レイアウトキャッシュクラス
+* @details <pre>
+* 文字列のハッシュ、フォントサイズ、折り返す横幅をキーにしてレイアウトを保持する
+* 最大数を超えた場合は最も使われていないものを、MaxTextLayoutAgeフレーム使用されていないものは毎フレーム破棄する
+* グリフアトラスのグリフが入れ替えられた場合はUVが変わっている可能性があるので作り直す
+* </pre>
+*/
+class TextLayoutCache
+{
+public:
+	/** Constructor */
+	TextLayoutCache() :
+		m_LayoutList(),
+		m_LruList(),
+		m_CurrentFrame(0)
+	{
+	}
+
+	/**
+	* @brief フレーム更新関数
+	* @details 描画開始時に実行し、一定フレーム使用されていないレイアウトを破棄する
+	*/
+	void NextFrame();
+
+	/**
+	* @brief 解放関数
+	* @details 全てのレイアウトを破棄する
+	*/
+	void Clear();
+
+	/**
+	* @brief レイアウトの取得関数
+	* @details <pre>
+	* キャッシュにない場合、またはグリフアトラスの世代が変わっている場合はレイアウトを作成する
+	* 取得したレイアウトのグリフは現在のフレームで使用したことになる
+	* </pre>
+	* @retval const TextLayout* レイアウト
+	* @param[in] text 文字列
+	* @param[in] font_size フォントサイズ(ピクセル)
+	* @param[in] wrap_width 折り返す横幅(0の場合は折り返さない)
+	* @param[in] atlas グリフの取得に使用するグリフアトラス
+	* @param[in] allocator レイアウトの作成時に作業領域を確保するフレームアロケーター
+	* @param[out] out_is_hit キャッシュにあった場合はtrue
+	*/
+	const TextLayout* FindLayout(const char* text, int font_size, int wrap_width, GlyphAtlas* atlas, FrameAllocator* allocator, bool* out_is_hit);
+
+	/**
+	* @brief 保持しているレイアウト数の取得関数
+	* @retval int レイアウト数
+	*/
+	int GetCount() const
+	{
+		return (int)m_LayoutList.size();
+	}
+
+	/**
+	* @brief 文字列のハッシュ計算関数
+	* @details FNV-1a(64bit)でハッシュを計算し、フォントサイズと折り返す横幅を混ぜる
+	* @retval unsigned long long ハッシュ値
+	* @param[in] text 文字列
+	* @param[in] font_size フォントサイズ
+	* @param[in] wrap_width 折り返す横幅
+	*/
+	static unsigned long long CalculateHash(const char* text, int font_size, int wrap_width);
+
+private:
+	/**
+	* @brief レイアウトの作成関数
+	* @details グリフを検索して改行、折り返しを行い、矩形の頂点を作成する
+	* @param[out] layout 作成結果を書き込むレイアウト(Text、FontSize、WrapWidthは設定済み)
+	* @param[in] atlas グリフの取得に使用するグリフアトラス
+	* @param[in] allocator 文字コード変換の作業領域を確保するフレームアロケーター
+	*/
+	void BuildLayout(TextLayout* layout, GlyphAtlas* atlas, FrameAllocator* allocator);
+
+	/**
+	* @brief 矩形の追加関数
+	* @param[out] layout 追加先のレイアウト
+	* @param[in] glyph グリフ
+	* @param[in] pen_x 描画位置X
+	* @param[in] pen_y 行の上端Y
+	*/
+	static void AddGlyphQuad(TextLayout* layout, const GlyphInfo* glyph, float pen_x, float pen_y);
+
+	/**
+	* @brief 使用順リストの更新関数
+	* @details レイアウトを最後に使用したものとして先頭に移動する
+	* @param[in] layout 使用したレイアウト
+	*/
+	void Touch(TextLayout* layout);
+
+	/**
+	* @brief レイアウトの破棄関数
+	* @param[in] key 破棄するレイアウトのキー
+	*/
+	void Erase(unsigned long long key);
+
+private:
+	std::unordered_map<unsigned long long, TextLayout> m_LayoutList;	//!< レイアウト
+	std::list<unsigned long long> m_LruList;							//!< 使用順のキー(先頭が最新)
+	unsigned int m_CurrentFrame;										//!< 現在のフレーム
+};
+
+#endif
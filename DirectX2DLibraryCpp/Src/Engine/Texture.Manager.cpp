@@ -1,11 +1,67 @@
 ﻿#include <d3dx9.h>
 #include <stdlib.h>
+#include <algorithm>
+#include <vector>
 #include "Engine.h"
+#include "FileWatcher.h"
 #include "Graphics.h"
+#include "MipmapGenerator.h"
 
-void TextureManager::Initialize()
+static_assert(TextureEvictionGuardFrames > MaxRenderFramesInFlight, "TextureEvictionGuardFrames must cover frames in flight");
+
+namespace
+{
+	/** @brief 描画デバイスでテクスチャを作成する既定のローダー */
+	class DeviceTextureLoader : public TextureLoader
+	{
+	public:
+		bool Load(const char* file_name, Texture* out_texture, FileContentHash* out_hash) override
+		{
+			return Engine::CreateTexture(file_name, out_texture, out_hash);
+		}
+
+		void Unload(Texture* texture) override
+		{
+			// Null描画バックエンドではテクスチャデータが作成されないのでnullptrの場合がある
+			if (texture->TextureData != nullptr)
+			{
+				texture->TextureData->Release();
+				texture->TextureData = nullptr;
+			}
+		}
+	};
+
+	DeviceTextureLoader g_DeviceTextureLoader;
+
+	/**
+	* @brief テクスチャのバイト数の計算関数
+	* @details ミップマップがある場合は全てのレベルを含める
+	*/
+	size_t CalculateTextureByteSize(const Texture& texture)
+	{
+		int level_count = texture.TextureData != nullptr ? (int)texture.TextureData->GetLevelCount() : 1;
+		return MipmapGenerator::CalculateChainTexelCount(texture.Width, texture.Height, level_count) * 4;
+	}
+
+	/** @brief 最後に使用したフレームが古い順に並べる比較関数 */
+	template<typename T>
+	bool IsUsedEarlier(const std::pair<unsigned int, T*>& a, const std::pair<unsigned int, T*>& b)
+	{
+		return a.first < b.first;
+	}
+}
+
+void TextureManager::Initialize(TextureLoader* loader, const FileSystem* file_system)
 {
 	m_TextureList.clear();
+	m_EntryList.clear();
+	m_SharedList.clear();
+	m_Loader = loader != nullptr ? loader : &g_DeviceTextureLoader;
+	m_FileSystem = file_system;
+	m_ResidentSize = 0;
+	m_CurrentFrame = 0;
+	m_EvictionCount = 0;
+	m_ReloadCount = 0;
 }
 
 void TextureManager::Release()
@@ -15,11 +71,11 @@ void TextureManager::Release()
 
 void TextureManager::ReleaseTexture(const char* keyword)
 {
-	if (m_TextureList.count(keyword) > 0 &&
-		m_TextureList[keyword].TextureData != nullptr)
+	if (m_TextureList.count(keyword) > 0)
 	{
-		m_TextureList[keyword].TextureData->Release();
-		m_TextureList[keyword].TextureData = nullptr;
+		TextureEntry* entry = &m_TextureList[keyword];
+		UnloadEntry(entry);
+		m_EntryList.erase(&entry->Data);
 		m_TextureList.erase(keyword);
 	}
 }
@@ -28,16 +84,12 @@ void TextureManager::ReleaseAllTextures()
 {
 	for (auto& texture : m_TextureList)
 	{
-		if (texture.second.TextureData == nullptr)
-		{
-			continue;
-		}
-
-		texture.second.TextureData->Release();
-		texture.second.TextureData = nullptr;
+		UnloadEntry(&texture.second);
 	}
 
 	m_TextureList.clear();
+	m_EntryList.clear();
+	m_SharedList.clear();
 }
 
 bool TextureManager::LoadTexture(const char* keyword, const char* file_name)
@@ -53,15 +105,361 @@ bool TextureManager::LoadTexture(const char* keyword, const char* file_name)
 		return true;
 	}
 
-	return Engine::CreateTexture(file_name, &m_TextureList[keyword]);
+	TextureEntry* entry = &m_TextureList[keyword];
+	entry->FileName = file_name;
+	entry->LastUsedFrame = m_CurrentFrame;
+
+	if (LoadEntry(entry) == false)
+	{
+		m_TextureList.erase(keyword);
+		return false;
+	}
+
+	m_EntryList[&entry->Data] = entry;
+
+	return true;
+}
+
+bool TextureManager::AddTexture(const char* keyword, const char* file_name, const Texture& texture, const FileContentHash& content_hash)
+{
+	if (file_name == nullptr ||
+		keyword == nullptr ||
+		m_TextureList.count(keyword) > 0)
+	{
+		return false;
+	}
+
+	TextureEntry* entry = &m_TextureList[keyword];
+	entry->Data = texture;
+	entry->FileName = file_name;
+	entry->ByteSize = CalculateTextureByteSize(texture);
+	entry->LastUsedFrame = m_CurrentFrame;
+	entry->IsResident = true;
+	m_EntryList[&entry->Data] = entry;
+
+	entry->Content = content_hash;
+	if (entry->Content.IsValid == false)
+	{
+		HashFile(entry->FileName, &entry->Content);
+	}
+
+	// 作成済みでも、同じ内容のテクスチャがあればそちらを使用してメモリを節約する
+	Texture created_texture = texture;
+	if (ShareTexture(entry) == true)
+	{
+		m_Loader->Unload(&created_texture);
+		return true;
+	}
+
+	RegisterSharedTexture(entry);
+	m_ResidentSize += entry->ByteSize;
+
+	return true;
 }
 
 Texture* TextureManager::GetTexture(const char* keyword)
 {
-	if (m_TextureList.count(keyword) == 0)
+	auto itr = m_TextureList.find(keyword);
+	if (itr == m_TextureList.end())
 	{
 		return nullptr;
 	}
 
-	return &m_TextureList[keyword];
+	if (Touch(&itr->second) == false)
+	{
+		return nullptr;
+	}
+
+	return &itr->second.Data;
+}
+
+void TextureManager::TouchTexture(const Texture* texture)
+{
+	auto itr = m_EntryList.find(texture);
+	if (itr == m_EntryList.end())
+	{
+		return;
+	}
+
+	Touch(itr->second);
+}
+
+void TextureManager::NextFrame()
+{
+	m_CurrentFrame++;
+}
+
+bool TextureManager::IsOverBudget() const
+{
+	return m_Budget > 0 && m_ResidentSize > m_Budget;
+}
+
+int TextureManager::EvictTextures()
+{
+	if (IsOverBudget() == false)
+	{
+		return 0;
+	}
+
+	// 描画スレッドや記録済みの描画コマンドが参照している可能性がある直近のテクスチャは対象外にする
+	std::vector<std::pair<unsigned int, TextureEntry*>> candidate_list;
+	for (auto& texture : m_TextureList)
+	{
+		TextureEntry* entry = &texture.second;
+		if (entry->IsResident == true && m_CurrentFrame - entry->LastUsedFrame >= TextureEvictionGuardFrames)
+		{
+			candidate_list.push_back(std::make_pair(entry->LastUsedFrame, entry));
+		}
+	}
+
+	std::sort(candidate_list.begin(), candidate_list.end(), IsUsedEarlier<TextureEntry>);
+
+	int eviction_count = 0;
+	for (auto& candidate : candidate_list)
+	{
+		if (m_ResidentSize <= m_Budget)
+		{
+			break;
+		}
+
+		UnloadEntry(candidate.second);
+		eviction_count++;
+	}
+
+	m_EvictionCount += eviction_count;
+
+	return eviction_count;
+}
+
+void TextureManager::FindTexturesByFile(const std::string& file_name, std::vector<std::string>* out_keyword_list)
+{
+	for (auto& texture : m_TextureList)
+	{
+		if (FileWatcher::NormalizePath(texture.second.FileName.c_str()) == file_name)
+		{
+			out_keyword_list->push_back(texture.first);
+		}
+	}
+}
+
+bool TextureManager::ReplaceTexture(const char* keyword, const Texture& texture, const FileContentHash& content_hash)
+{
+	auto itr = m_TextureList.find(keyword);
+	if (itr == m_TextureList.end() || itr->second.IsResident == false)
+	{
+		return false;
+	}
+
+	TextureEntry* entry = &itr->second;
+	if (ReleaseSharedReference(entry) == true)
+	{
+		m_Loader->Unload(&entry->Data);
+		m_ResidentSize -= entry->ByteSize;
+	}
+
+	entry->Data.TextureData = texture.TextureData;
+	entry->Data.Width = texture.Width;
+	entry->Data.Height = texture.Height;
+	entry->ByteSize = CalculateTextureByteSize(texture);
+	entry->Content = content_hash;
+	m_ResidentSize += entry->ByteSize;
+
+	return true;
+}
+
+unsigned int TextureManager::GetTextureMemorySize()
+{
+	return (unsigned int)m_ResidentSize;
+}
+
+TextureMemoryStats TextureManager::GetStats() const
+{
+	TextureMemoryStats stats;
+	stats.ResidentSize = m_ResidentSize;
+	stats.Budget = m_Budget;
+	stats.TextureCount = (int)m_TextureList.size();
+	stats.EvictionCount = m_EvictionCount;
+	stats.ReloadCount = m_ReloadCount;
+
+	for (auto& shared : m_SharedList)
+	{
+		stats.SharedCount += shared.second.ReferenceCount - 1;
+		stats.SharedSize += shared.second.ByteSize * (shared.second.ReferenceCount - 1);
+	}
+
+	for (auto& texture : m_TextureList)
+	{
+		stats.TotalSize += texture.second.ByteSize;
+		if (texture.second.IsResident == true)
+		{
+			stats.ResidentCount++;
+		}
+	}
+
+	return stats;
+}
+
+bool TextureManager::Touch(TextureEntry* entry)
+{
+	entry->LastUsedFrame = m_CurrentFrame;
+
+	if (entry->IsResident == true)
+	{
+		return true;
+	}
+
+	if (LoadEntry(entry) == false)
+	{
+		return false;
+	}
+
+	m_ReloadCount++;
+
+	return true;
+}
+
+bool TextureManager::LoadEntry(TextureEntry* entry)
+{
+	// 解放後の読み込み直しは前回のハッシュ値で探し、共有できればファイルを読まない
+	if (ShareTexture(entry) == true)
+	{
+		return true;
+	}
+
+	FileContentHash content_hash;
+	if (m_Loader->Load(entry->FileName.c_str(), &entry->Data, &content_hash) == false)
+	{
+		entry->Data.TextureData = nullptr;
+		return false;
+	}
+
+	// ローダーが内容を読み込まなかった場合だけファイルを読み直す(計算できない場合は共有しない)
+	if (content_hash.IsValid == false)
+	{
+		HashFile(entry->FileName, &content_hash);
+	}
+
+	// 前回から内容が変わっている場合があるので、新しい内容で同じテクスチャを探し直す
+	entry->Content = content_hash;
+
+	Texture created_texture = entry->Data;
+	if (ShareTexture(entry) == true)
+	{
+		m_Loader->Unload(&created_texture);
+		return true;
+	}
+
+	entry->ByteSize = CalculateTextureByteSize(entry->Data);
+	entry->IsResident = true;
+	m_ResidentSize += entry->ByteSize;
+
+	RegisterSharedTexture(entry);
+
+	return true;
+}
+
+void TextureManager::UnloadEntry(TextureEntry* entry)
+{
+	if (entry->IsResident == false)
+	{
+		return;
+	}
+
+	entry->IsResident = false;
+
+	// 他のキーワードが使用している場合は参照を外すだけにする
+	if (ReleaseSharedReference(entry) == false)
+	{
+		entry->Data.TextureData = nullptr;
+		return;
+	}
+
+	m_Loader->Unload(&entry->Data);
+	m_ResidentSize -= entry->ByteSize;
+}
+
+bool TextureManager::HashFile(const std::string& file_name, FileContentHash* out_hash) const
+{
+	FileData file_data;
+	bool is_loaded = m_FileSystem != nullptr ?
+		m_FileSystem->LoadFile(file_name.c_str(), &file_data) :
+		FileSystem::ReadLooseFile(file_name.c_str(), &file_data);
+
+	if (is_loaded == false)
+	{
+		return false;
+	}
+
+	*out_hash = FileSystem::MakeContentHash(file_data.Data, file_data.Size);
+
+	return true;
+}
+
+bool TextureManager::ShareTexture(TextureEntry* entry)
+{
+	if (entry->Content.IsValid == false)
+	{
+		return false;
+	}
+
+	auto itr = m_SharedList.find(entry->Content.Value);
+	if (itr == m_SharedList.end() ||
+		itr->second.ContentSize != entry->Content.Size)
+	{
+		return false;
+	}
+
+	SharedTexture& shared = itr->second;
+	shared.ReferenceCount++;
+
+	entry->Data.TextureData = shared.Data.TextureData;
+	entry->Data.Width = shared.Data.Width;
+	entry->Data.Height = shared.Data.Height;
+	entry->ByteSize = shared.ByteSize;
+	entry->IsResident = true;
+	entry->IsShareable = true;
+
+	return true;
+}
+
+void TextureManager::RegisterSharedTexture(TextureEntry* entry)
+{
+	if (entry->Content.IsValid == false ||
+		m_SharedList.count(entry->Content.Value) > 0)
+	{
+		return;
+	}
+
+	SharedTexture& shared = m_SharedList[entry->Content.Value];
+	shared.Data = entry->Data;
+	shared.ByteSize = entry->ByteSize;
+	shared.ContentSize = entry->Content.Size;
+	shared.ReferenceCount = 1;
+	entry->IsShareable = true;
+}
+
+bool TextureManager::ReleaseSharedReference(TextureEntry* entry)
+{
+	if (entry->IsShareable == false)
+	{
+		return true;
+	}
+
+	entry->IsShareable = false;
+
+	auto itr = m_SharedList.find(entry->Content.Value);
+	if (itr == m_SharedList.end())
+	{
+		return true;
+	}
+
+	itr->second.ReferenceCount--;
+	if (itr->second.ReferenceCount > 0)
+	{
+		return false;
+	}
+
+	m_SharedList.erase(itr);
+
+	return true;
 }
@@ -0,0 +1,236 @@
+﻿#include <stdio.h>
+#include <string.h>
+#include "EngineConstant.h"
+#include "TextureCache.h"
+
+namespace
+{
+	const char TextureCacheMagic[4] = { 'T', 'X', 'C', 'H' };	//!< キャッシュファイルの識別子
+
+	/** @brief キャッシュファイルのヘッダー */
+	struct TextureCacheHeader
+	{
+		char Magic[4];						//!< 識別子
+		unsigned int Version;				//!< 形式のバージョン
+		unsigned int Width;					//!< 横幅
+		unsigned int Height;				//!< 縦幅
+		unsigned long long SourceSize;		//!< 元のファイルのサイズ
+		unsigned long long SourceWriteTime;	//!< 元のファイルの更新日時
+		unsigned long long SourceHash;		//!< 元のファイルの内容のハッシュ値
+		DWORD ColorKey;						//!< 適用したカラーキー
+		unsigned int Reserved[5];			//!< 予約(0)
+	};
+
+	static_assert(sizeof(TextureCacheHeader) == TextureCacheHeaderSize, "TextureCacheHeader must be TextureCacheHeaderSize bytes");
+}
+
+bool TextureCache::Initialize(const char* directory)
+{
+	Release();
+
+	if (CreateDirectory(directory, nullptr) == FALSE && GetLastError() != ERROR_ALREADY_EXISTS)
+	{
+		return false;
+	}
+
+	m_Directory = directory;
+	if (m_Directory.empty() == false && m_Directory.back() != '/' && m_Directory.back() != '\\')
+	{
+		m_Directory += '/';
+	}
+
+	return true;
+}
+
+void TextureCache::Release()
+{
+	m_Directory.clear();
+}
+
+bool TextureCache::Open(const char* file_name, TextureCacheView* out_view)
+{
+	unsigned long long source_size = 0;
+	unsigned long long source_write_time = 0;
+	if (ReadSourceInfo(file_name, &source_size, &source_write_time) == false)
+	{
+		m_MissCount++;
+		return false;
+	}
+
+	TextureCacheView view;
+	view.FileHandle = CreateFile(
+		MakeCacheFileName(file_name).c_str(),
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL,
+		nullptr);
+
+	if (view.FileHandle == INVALID_HANDLE_VALUE)
+	{
+		m_MissCount++;
+		return false;
+	}
+
+	LARGE_INTEGER file_size;
+	if (GetFileSizeEx(view.FileHandle, &file_size) == FALSE ||
+		file_size.QuadPart < (LONGLONG)TextureCacheHeaderSize)
+	{
+		Close(&view);
+		m_MissCount++;
+		return false;
+	}
+
+	view.MappingHandle = CreateFileMapping(view.FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (view.MappingHandle != nullptr)
+	{
+		view.MappedData = MapViewOfFile(view.MappingHandle, FILE_MAP_READ, 0, 0, 0);
+	}
+
+	if (view.MappedData == nullptr)
+	{
+		Close(&view);
+		m_MissCount++;
+		return false;
+	}
+
+	// 元のファイルが更新されている場合や、書き込みが中断されたファイルは使用しない
+	const TextureCacheHeader* header = (const TextureCacheHeader*)view.MappedData;
+	if (memcmp(header->Magic, TextureCacheMagic, sizeof(TextureCacheMagic)) != 0 ||
+		header->Version != TextureCacheVersion ||
+		header->ColorKey != TextureColorKey ||
+		header->SourceSize != source_size ||
+		header->SourceWriteTime != source_write_time ||
+		(unsigned long long)file_size.QuadPart != TextureCacheHeaderSize + (unsigned long long)header->Width * header->Height * sizeof(DWORD))
+	{
+		Close(&view);
+		m_MissCount++;
+		return false;
+	}
+
+	view.Width = (int)header->Width;
+	view.Height = (int)header->Height;
+	view.SourceHash = header->SourceHash;
+	view.SourceSize = header->SourceSize;
+	view.Pixels = (const DWORD*)((const char*)view.MappedData + TextureCacheHeaderSize);
+
+	*out_view = view;
+	m_HitCount++;
+
+	return true;
+}
+
+void TextureCache::Close(TextureCacheView* view) const
+{
+	if (view->MappedData != nullptr)
+	{
+		UnmapViewOfFile(view->MappedData);
+	}
+
+	if (view->MappingHandle != nullptr)
+	{
+		CloseHandle(view->MappingHandle);
+	}
+
+	if (view->FileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(view->FileHandle);
+	}
+
+	*view = TextureCacheView();
+}
+
+bool TextureCache::Write(const char* file_name, int width, int height, const DWORD* pixels, unsigned long long source_hash) const
+{
+	TextureCacheHeader header = {};
+	if (ReadSourceInfo(file_name, &header.SourceSize, &header.SourceWriteTime) == false)
+	{
+		return false;
+	}
+	header.SourceHash = source_hash;
+
+	FILE* fp = nullptr;
+	if (fopen_s(&fp, MakeCacheFileName(file_name).c_str(), "wb") != 0)
+	{
+		return false;
+	}
+
+	// 識別子が空のヘッダーを先に書き込み、テクセルを書き終えてから正しいヘッダーで上書きする
+	bool is_succeeded = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+		fwrite(pixels, sizeof(DWORD), (size_t)width * height, fp) == (size_t)width * height;
+
+	if (is_succeeded == true)
+	{
+		memcpy(header.Magic, TextureCacheMagic, sizeof(TextureCacheMagic));
+		header.Version = TextureCacheVersion;
+		header.Width = (unsigned int)width;
+		header.Height = (unsigned int)height;
+		header.ColorKey = TextureColorKey;
+
+		is_succeeded = fseek(fp, 0, SEEK_SET) == 0 &&
+			fwrite(&header, sizeof(header), 1, fp) == 1;
+	}
+
+	fclose(fp);
+
+	return is_succeeded;
+}
+
+TextureCacheStats TextureCache::GetStats() const
+{
+	TextureCacheStats stats;
+	stats.HitCount = m_HitCount.load();
+	stats.MissCount = m_MissCount.load();
+
+	return stats;
+}
+
+std::string TextureCache::MakeCacheFileName(const char* file_name) const
+{
+	std::string cache_file_name = file_name;
+
+	for (char& c : cache_file_name)
+	{
+		if (c == '/' || c == '\\' || c == ':')
+		{
+			c = '_';
+		}
+	}
+
+	return m_Directory + cache_file_name + TextureCacheExtension;
+}
+
+bool TextureCache::ReadSourceInfo(const char* file_name, unsigned long long* out_size, unsigned long long* out_write_time)
+{
+	HANDLE file = CreateFile(
+		file_name,
+		GENERIC_READ,
+		FILE_SHARE_READ | FILE_SHARE_WRITE,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL,
+		nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	FILETIME write_time;
+	bool is_succeeded = GetFileSizeEx(file, &size) != FALSE &&
+		GetFileTime(file, nullptr, nullptr, &write_time) != FALSE;
+
+	CloseHandle(file);
+
+	if (is_succeeded == false)
+	{
+		return false;
+	}
+
+	*out_size = (unsigned long long)size.QuadPart;
+	*out_write_time = ((unsigned long long)write_time.dwHighDateTime << 32) | write_time.dwLowDateTime;
+
+	return true;
+}
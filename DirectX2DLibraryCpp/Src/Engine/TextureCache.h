@@ -0,0 +1,165 @@
+﻿/**
+* @file TextureCache.h
+* @brief <pre>
+* 画像ファイルをデコードしたテクセルを保存するテクスチャキャッシュの宣言
+* 2回目以降の起動では保存したテクセルをメモリマップで読み込み、画像のデコードを省略する
+* </pre>
+*/
+#ifndef TEXTURE_CACHE_H_
+#define TEXTURE_CACHE_H_
+
+#include <Windows.h>
+#include <atomic>
+#include <string>
+
+const unsigned int TextureCacheVersion = 2;			//!< キャッシュファイルの形式のバージョン(形式を変えたら増やして古いキャッシュを無効にする)
+const size_t TextureCacheHeaderSize = 64;			//!< キャッシュファイルのヘッダーのバイト数(テクセルの先頭を揃える)
+const char TextureCacheExtension[] = ".texcache";	//!< キャッシュファイルの拡張子
+
+/** @brief メモリマップで開いたキャッシュ */
+struct TextureCacheView
+{
+	/** Constructor */
+	TextureCacheView() :
+		Pixels(nullptr),
+		Width(0),
+		Height(0),
+		SourceHash(0),
+		SourceSize(0),
+		FileHandle(INVALID_HANDLE_VALUE),
+		MappingHandle(nullptr),
+		MappedData(nullptr)
+	{
+	}
+
+	const DWORD* Pixels;		//!< テクセル(A8R8G8B8、カラーキー適用済み、1行の要素数はWidth)
+	int Width;					//!< 横幅
+	int Height;					//!< 縦幅
+	unsigned long long SourceHash;	//!< 元のファイルの内容のハッシュ値(FileSystem::HashContent)
+	unsigned long long SourceSize;	//!< 元のファイルのバイト数
+	HANDLE FileHandle;			//!< キャッシュファイルのハンドル
+	HANDLE MappingHandle;		//!< ファイルマッピングのハンドル
+	const void* MappedData;		//!< マップしたファイルの先頭
+};
+
+/** @brief キャッシュの使用状況 */
+struct TextureCacheStats
+{
+	/** Constructor */
+	TextureCacheStats() :
+		HitCount(0),
+		MissCount(0)
+	{
+	}
+
+	int HitCount;		//!< キャッシュから読み込んだ数
+	int MissCount;		//!< キャッシュがない、または元のファイルが更新されていてデコードした数
+};
+
+/**
+* @brief テクスチャキャッシュクラス
+* @details <pre>
+* 画像ファイルごとに、ヘッダー(バージョン、サイズ、元のファイルのサイズと更新日時と内容のハッシュ値、カラーキー)とテクセルを1つのファイルに保存する
+* 元のファイルのサイズか更新日時が変わった場合は無効とし、デコードし直して上書きする
+* 複数のスレッドから使用できる(ホットリロードの読み込み用スレッドから使用するため)
+* </pre>
+*/
+class TextureCache
+{
+public:
+	/** Constructor */
+	TextureCache() :
+		m_Directory(),
+		m_HitCount(0),
+		m_MissCount(0)
+	{
+	}
+
+	/**
+	* @brief 初期化関数
+	* @details キャッシュファイルを保存するフォルダを設定し、存在しない場合は作成する
+	* @retval true 初期化成功
+	* @retval false 初期化失敗(フォルダを作成できなかった)
+	* @param[in] directory キャッシュファイルを保存するフォルダ
+	*/
+	bool Initialize(const char* directory);
+
+	/**
+	* @brief 解放関数
+	* @details キャッシュを無効にする(保存したファイルは削除しない)
+	*/
+	void Release();
+
+	/**
+	* @brief 有効の確認関数
+	* @retval true 有効
+	* @retval false 無効(Initializeを実行していない)
+	*/
+	bool IsEnabled() const
+	{
+		return m_Directory.empty() == false;
+	}
+
+	/**
+	* @brief キャッシュを開く関数
+	* @details 有効なキャッシュファイルがある場合はメモリマップで開き、テクセルを参照できるようにする
+	* @retval true 有効なキャッシュがあった(使用後はCloseを実行する)
+	* @retval false キャッシュがない、または無効
+	* @param[in] file_name 元の画像ファイル名
+	* @param[out] out_view 開いたキャッシュ
+	*/
+	bool Open(const char* file_name, TextureCacheView* out_view);
+
+	/**
+	* @brief キャッシュを閉じる関数
+	* @param[in,out] view Openで開いたキャッシュ
+	*/
+	void Close(TextureCacheView* view) const;
+
+	/**
+	* @brief キャッシュの保存関数
+	* @details <pre>
+	* デコードしたテクセルを保存する
+	* ヘッダーは最後に書き込むので、途中で中断したファイルは無効として扱われる
+	* </pre>
+	* @retval true 保存成功
+	* @retval false 保存失敗
+	* @param[in] file_name 元の画像ファイル名
+	* @param[in] width 横幅
+	* @param[in] height 縦幅
+	* @param[in] pixels テクセル(A8R8G8B8、カラーキー適用済み、1行の要素数はwidth)
+	* @param[in] source_hash 元のファイルの内容のハッシュ値(キャッシュから読み込んだ時に同じ内容のテクスチャを探すために使用する)
+	*/
+	bool Write(const char* file_name, int width, int height, const DWORD* pixels, unsigned long long source_hash) const;
+
+	/**
+	* @brief 使用状況の取得関数
+	* @retval TextureCacheStats 使用状況
+	*/
+	TextureCacheStats GetStats() const;
+
+private:
+	/**
+	* @brief キャッシュファイル名の作成関数
+	* @retval std::string キャッシュファイル名(区切り文字を'_'に置き換えた元のファイル名に拡張子を付けたもの)
+	* @param[in] file_name 元の画像ファイル名
+	*/
+	std::string MakeCacheFileName(const char* file_name) const;
+
+	/**
+	* @brief 元のファイルの情報の取得関数
+	* @retval true 取得成功
+	* @retval false 取得失敗(ファイルがない)
+	* @param[in] file_name 元の画像ファイル名
+	* @param[out] out_size ファイルサイズ
+	* @param[out] out_write_time 更新日時
+	*/
+	static bool ReadSourceInfo(const char* file_name, unsigned long long* out_size, unsigned long long* out_write_time);
+
+private:
+	std::string m_Directory;			//!< キャッシュファイルを保存するフォルダ('/'で終わる)
+	std::atomic<int> m_HitCount;		//!< キャッシュから読み込んだ数
+	std::atomic<int> m_MissCount;		//!< デコードした数
+};
+
+#endif
@@ -0,0 +1,189 @@
+﻿#include <stdio.h>
+#include <algorithm>
+#include "TextureHotReloader.h"
+
+namespace
+{
+	/** @brief カウンタ値の差をミリ秒に変換する関数 */
+	float ConvertCounterToMilliseconds(LONGLONG count)
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		return (float)(count * 1000.0 / frequency.QuadPart);
+	}
+
+	/** @brief QueryPerformanceCounterの値の取得関数 */
+	LONGLONG GetCounter()
+	{
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter(&counter);
+		return counter.QuadPart;
+	}
+}
+
+bool TextureHotReloader::Start(const char* directory, TextureManager* texture_manager)
+{
+	Stop();
+
+	if (m_FileWatcher.Start(directory) == false)
+	{
+		return false;
+	}
+
+	m_RequestEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	if (m_RequestEvent == nullptr)
+	{
+		m_FileWatcher.Stop();
+		return false;
+	}
+
+	m_TextureManager = texture_manager;
+	m_IsStopRequested = false;
+	m_Thread = std::thread(&TextureHotReloader::Run, this);
+
+	return true;
+}
+
+void TextureHotReloader::Stop()
+{
+	m_FileWatcher.Stop();
+
+	if (m_Thread.joinable() == true)
+	{
+		m_IsStopRequested = true;
+		SetEvent(m_RequestEvent);
+		m_Thread.join();
+	}
+
+	if (m_RequestEvent != nullptr)
+	{
+		CloseHandle(m_RequestEvent);
+		m_RequestEvent = nullptr;
+	}
+
+	// 差し替えていないテクスチャはどこからも参照されていないので解放する
+	for (ReloadRequest& request : m_CompletedList)
+	{
+		if (request.IsSucceeded == true)
+		{
+			m_TextureManager->GetLoader()->Unload(&request.Result);
+		}
+	}
+
+	m_RequestList.clear();
+	m_CompletedList.clear();
+}
+
+bool TextureHotReloader::HasCompletedReload()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_CompletedList.empty() == false;
+}
+
+void TextureHotReloader::RequestReloads()
+{
+	if (IsRunning() == false)
+	{
+		return;
+	}
+
+	std::vector<FileChange> change_list;
+	m_FileWatcher.PollChanges(&change_list);
+
+	std::vector<ReloadRequest> request_list;
+	for (const FileChange& change : change_list)
+	{
+		std::vector<std::string> keyword_list;
+		m_TextureManager->FindTexturesByFile(change.FileName, &keyword_list);
+
+		for (const std::string& keyword : keyword_list)
+		{
+			ReloadRequest request = {};
+			request.Keyword = keyword;
+			request.FileName = change.FileName;
+			request.DetectedCounter = change.DetectedCounter;
+			request_list.push_back(request);
+		}
+	}
+
+	if (request_list.empty() == true)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_RequestList.insert(m_RequestList.end(), request_list.begin(), request_list.end());
+	}
+
+	SetEvent(m_RequestEvent);
+}
+
+void TextureHotReloader::ApplyReloads()
+{
+	std::vector<ReloadRequest> completed_list;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		completed_list.swap(m_CompletedList);
+	}
+
+	for (ReloadRequest& request : completed_list)
+	{
+		if (request.IsSucceeded == false)
+		{
+			m_Stats.FailureCount++;
+			continue;
+		}
+
+		// キーワードが解放された場合などは差し替え先がないので、読み込んだテクスチャを解放する
+		if (m_TextureManager->ReplaceTexture(request.Keyword.c_str(), request.Result, request.ResultHash) == false)
+		{
+			m_TextureManager->GetLoader()->Unload(&request.Result);
+			continue;
+		}
+
+		float latency = ConvertCounterToMilliseconds(GetCounter() - request.DetectedCounter);
+
+		m_Stats.ReloadCount++;
+		m_Stats.LastDecodeTime = request.DecodeTime;
+		m_Stats.LastLatency = latency;
+		m_Stats.MaxLatency = (std::max)(m_Stats.MaxLatency, latency);
+
+		char text[MAX_PATH + 128];
+		sprintf_s(text, sizeof(text), "[HotReload] %s (%s): decode %.1f ms, latency %.1f ms\n",
+			request.Keyword.c_str(), request.FileName.c_str(), request.DecodeTime, latency);
+		OutputDebugString(text);
+	}
+}
+
+void TextureHotReloader::Run()
+{
+	std::vector<ReloadRequest> request_list;
+
+	while (m_IsStopRequested.load() == false)
+	{
+		WaitForSingleObject(m_RequestEvent, INFINITE);
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			request_list.swap(m_RequestList);
+		}
+
+		for (ReloadRequest& request : request_list)
+		{
+			if (m_IsStopRequested.load() == true)
+			{
+				break;
+			}
+
+			LONGLONG start = GetCounter();
+			request.IsSucceeded = m_TextureManager->GetLoader()->Load(request.FileName.c_str(), &request.Result, &request.ResultHash);
+			request.DecodeTime = ConvertCounterToMilliseconds(GetCounter() - start);
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_CompletedList.push_back(request);
+		}
+
+		request_list.clear();
+	}
+}
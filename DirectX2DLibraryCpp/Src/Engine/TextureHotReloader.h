@@ -0,0 +1,149 @@
+﻿/**
+* @file TextureHotReloader.h
+* @brief <pre>
+* 変更された画像ファイルのテクスチャを読み込み直すクラスの宣言
+* ゲームを再起動せずに、保存した画像を確認できるようにする開発用の機能
+* </pre>
+*/
+#ifndef TEXTURE_HOT_RELOADER_H_
+#define TEXTURE_HOT_RELOADER_H_
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FileWatcher.h"
+#include "TextureManager.h"
+
+/** @brief 読み込み直しの状況 */
+struct TextureHotReloadStats
+{
+	/** Constructor */
+	TextureHotReloadStats() :
+		ReloadCount(0),
+		FailureCount(0),
+		LastDecodeTime(0.0f),
+		LastLatency(0.0f),
+		MaxLatency(0.0f)
+	{
+	}
+
+	int ReloadCount;		//!< 差し替えたテクスチャの数
+	int FailureCount;		//!< 読み込みに失敗した数(保存途中のファイルなど)
+	float LastDecodeTime;	//!< 最後に差し替えたテクスチャの読み込み時間(ミリ秒)
+	float LastLatency;		//!< 最後に差し替えたテクスチャの変更の通知から差し替えまでの時間(ミリ秒)
+	float MaxLatency;		//!< 変更の通知から差し替えまでの時間の最大値(ミリ秒)
+};
+
+/**
+* @brief テクスチャのホットリロードクラス
+* @details <pre>
+* FileWatcherで変更が確定したファイルを読み込んでいるテクスチャを探し、読み込み用のスレッドで読み込む
+* 読み込みが完了したテクスチャはApplyReloadsでTextureManager::ReplaceTextureで差し替えるので、キーワードとポインタは変わらない
+* </pre>
+*/
+class TextureHotReloader
+{
+public:
+	/** Constructor */
+	TextureHotReloader() :
+		m_FileWatcher(),
+		m_TextureManager(nullptr),
+		m_Thread(),
+		m_RequestEvent(nullptr),
+		m_IsStopRequested(false),
+		m_Mutex(),
+		m_RequestList(),
+		m_CompletedList(),
+		m_Stats()
+	{
+	}
+
+	/**
+	* @brief 開始関数
+	* @retval true 開始成功
+	* @retval false 開始失敗(フォルダを開けなかった)
+	* @param[in] directory 監視するフォルダ(サブフォルダを含む)
+	* @param[in] texture_manager 差し替えるテクスチャを管理しているクラス
+	*/
+	bool Start(const char* directory, TextureManager* texture_manager);
+
+	/**
+	* @brief 停止関数
+	* @details 読み込み用のスレッドを終了し、差し替えていないテクスチャを解放する
+	*/
+	void Stop();
+
+	/**
+	* @brief 実行中の確認関数
+	* @retval true 実行中
+	* @retval false 停止中
+	*/
+	bool IsRunning() const
+	{
+		return m_FileWatcher.IsRunning();
+	}
+
+	/**
+	* @brief 読み込みの依頼関数
+	* @details 変更が確定したファイルを読み込んでいるテクスチャを探し、読み込み用のスレッドに読み込みを依頼する
+	*/
+	void RequestReloads();
+
+	/**
+	* @brief 差し替え待ちの確認関数
+	* @retval true 読み込みが完了して差し替えを待っているテクスチャがある
+	* @retval false 差し替えを待っているテクスチャがない
+	*/
+	bool HasCompletedReload();
+
+	/**
+	* @brief 差し替え関数
+	* @details <pre>
+	* 読み込みが完了したテクスチャを差し替える
+	* 古いテクスチャを解放するので、描画スレッドの完了を待ってから実行する
+	* </pre>
+	*/
+	void ApplyReloads();
+
+	/**
+	* @brief 読み込み直しの状況の取得関数
+	* @retval const TextureHotReloadStats& 読み込み直しの状況
+	*/
+	const TextureHotReloadStats& GetStats() const
+	{
+		return m_Stats;
+	}
+
+private:
+	/** @brief 読み込みの依頼 */
+	struct ReloadRequest
+	{
+		std::string Keyword;		//!< 差し替えるテクスチャのキーワード
+		std::string FileName;		//!< 読み込むファイル名
+		LONGLONG DetectedCounter;	//!< 変更を通知された時のカウンタ値
+		Texture Result;				//!< 読み込んだテクスチャ
+		FileContentHash ResultHash;	//!< 読み込んだファイルの内容の識別情報
+		bool IsSucceeded;			//!< 読み込みに成功したか
+		float DecodeTime;			//!< 読み込み時間(ミリ秒)
+	};
+
+	/**
+	* @brief 読み込み用スレッドの処理関数
+	*/
+	void Run();
+
+private:
+	FileWatcher m_FileWatcher;					//!< ファイル監視
+	TextureManager* m_TextureManager;			//!< 差し替えるテクスチャを管理しているクラス
+	std::thread m_Thread;						//!< 読み込み用スレッド
+	HANDLE m_RequestEvent;						//!< 依頼の追加の通知
+	std::atomic<bool> m_IsStopRequested;		//!< 停止の要求
+	std::mutex m_Mutex;							//!< 依頼のリストの排他制御
+	std::vector<ReloadRequest> m_RequestList;	//!< 読み込み待ちの依頼
+	std::vector<ReloadRequest> m_CompletedList;	//!< 読み込みが完了した依頼
+	TextureHotReloadStats m_Stats;				//!< 読み込み直しの状況
+};
+
+#endif
@@ -10,17 +10,107 @@
 #define TEXTURE_H_
 
 #include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "EngineConstant.h"
+#include "FileSystem.h"
 
-/** @brief テクスチャファイルの管理クラス */
+const unsigned int TextureEvictionGuardFrames = 8;	//!< 最後に使用してから解放の対象にするまでのフレーム数(描画スレッドで処理中のフレームより大きくする)
+
+/**
+* @brief テクスチャの作成と解放を行うインターフェース
+* @details <pre>
+* TextureManagerはこのインターフェースを通してテクスチャを作成、解放する
+* 既定ではEngine::CreateTextureで作成するが、テストではデバイスを使用しない実装に差し替えられる
+* </pre>
+*/
+class TextureLoader
+{
+public:
+	/** Destructor */
+	virtual ~TextureLoader() {}
+
+	/**
+	* @brief 読み込み関数
+	* @retval true 読み込み成功
+	* @retval false 読み込み失敗
+	* @param[in] file_name 読み込むテクスチャ名(パス込み)
+	* @param[out] out_texture 作成したテクスチャ
+	* @param[out] out_hash 読み込んだファイルの内容の識別情報(計算しない場合はIsValidをfalseのままにする、TextureManagerがファイルを読み直して計算する)
+	*/
+	virtual bool Load(const char* file_name, Texture* out_texture, FileContentHash* out_hash) = 0;
+
+	/**
+	* @brief 解放関数
+	* @param[in,out] texture 解放するテクスチャ(TextureDataはnullptrにする)
+	*/
+	virtual void Unload(Texture* texture) = 0;
+};
+
+/** @brief テクスチャの使用メモリの状況 */
+struct TextureMemoryStats
+{
+	/** Constructor */
+	TextureMemoryStats() :
+		ResidentSize(0),
+		TotalSize(0),
+		Budget(0),
+		TextureCount(0),
+		ResidentCount(0),
+		EvictionCount(0),
+		ReloadCount(0),
+		SharedCount(0),
+		SharedSize(0)
+	{
+	}
+
+	size_t ResidentSize;	//!< 読み込まれているテクスチャのバイト数(共有しているテクスチャは1つ分)
+	size_t TotalSize;		//!< 解放したテクスチャを含めた全てのテクスチャのバイト数
+	size_t Budget;			//!< 予算(0の場合は予算なし)
+	int TextureCount;		//!< 登録されているテクスチャの数
+	int ResidentCount;		//!< 読み込まれているテクスチャの数
+	int EvictionCount;		//!< 予算を超えて解放した回数の合計
+	int ReloadCount;		//!< 解放したテクスチャを読み込み直した回数の合計
+	int SharedCount;		//!< 同じ内容の読み込み済みテクスチャを共有しているキーワードの数
+	size_t SharedSize;		//!< 共有によって作成せずに済んだテクスチャのバイト数
+};
+
+/**
+* @brief テクスチャファイルの管理クラス
+* @details <pre>
+* テクスチャごとにバイト数と最後に使用したフレームを記録する
+* 予算を設定すると、読み込まれているテクスチャの合計が予算を超えた時に、最後に使用したフレームが古い順に解放する
+* 解放したテクスチャはキーワードの登録を残しておき、次にGetTextureで取得した時に読み込み直す
+* 読み込み時にファイルの内容のハッシュ値を計算し、同じ内容のテクスチャが読み込まれていれば作成せずに共有する
+* 共有しているテクスチャは参照数を数え、最後のキーワードが解放した時に解放する
+* </pre>
+*/
 class TextureManager
 {
 public:
+	/** Constructor */
+	TextureManager() :
+		m_TextureList(),
+		m_EntryList(),
+		m_SharedList(),
+		m_Loader(nullptr),
+		m_FileSystem(nullptr),
+		m_Budget(0),
+		m_ResidentSize(0),
+		m_CurrentFrame(0),
+		m_EvictionCount(0),
+		m_ReloadCount(0)
+	{
+	}
+
 	/**
 	* @brief 初期化関数
 	* @details ゲームで使用するテクスチャデータを保存出来るようにする
+	* @param[in] loader テクスチャの作成と解放を行うクラス(nullptrの場合はEngine::CreateTextureで作成する)(オプション)
+	* @param[in] file_system 内容のハッシュ値を計算するためにファイルを読み込む仮想ファイルシステム(nullptrの場合は通常のファイルから読み込む)(オプション)
 	*/
-	void Initialize();
+	void Initialize(TextureLoader* loader = nullptr, const FileSystem* file_system = nullptr);
 
 	/**
 	* @brief 解放関数
@@ -38,6 +128,22 @@ public:
 	*/
 	bool LoadTexture(const char* keyword, const char* file_name);
 
+	/**
+	* @brief 作成済みテクスチャの登録関数
+	* @details <pre>
+	* 別の場所で作成したテクスチャをkeywordの文字列で登録する(AssetPreloaderでまとめて読み込んだテクスチャなど)
+	* 同じ内容のテクスチャが読み込まれている場合は、textureを解放して読み込まれているテクスチャを共有する
+	* 予算を超えて解放した後はfile_nameから読み込み直す
+	* </pre>
+	* @retval true 登録成功(textureはこのクラスで解放する)
+	* @retval false キーワードが登録済み(textureは解放されない)
+	* @param[in] keyword 登録用キーワード
+	* @param[in] file_name テクスチャを作成したファイル名(パス込み)
+	* @param[in] texture 作成済みのテクスチャ
+	* @param[in] content_hash 作成した時に計算したファイルの内容の識別情報(IsValidがfalseの場合はファイルを読み込んで計算する)
+	*/
+	bool AddTexture(const char* keyword, const char* file_name, const Texture& texture, const FileContentHash& content_hash);
+
 	/**
 	* @brief テクスチャ全解放関数
 	* @details 読み込んでいるすべてのテクスチャを解放する
@@ -53,14 +159,216 @@ public:
 
 	/**
 	* @brief テクスチャデータの取得関数
-	* @details 指定されたキーワードのテクスチャデータを取得する
+	* @details <pre>
+	* 指定されたキーワードのテクスチャデータを取得する
+	* 使用したフレームを記録し、予算を超えて解放されていた場合は読み込み直す
+	* </pre>
 	* @retval Texture* テクスチャデータ(取得失敗時はnullptr)
 	* @param[in] keyword 取得したいテクスチャのキーワード
 	*/
 	Texture* GetTexture(const char* keyword);
 
+	/**
+	* @brief テクスチャの使用記録関数
+	* @details <pre>
+	* GetTextureで取得したテクスチャを保持して使用する場合(タイルマップなど)に、使用したフレームを記録する
+	* 解放されていた場合は読み込み直す
+	* このクラスで管理していないテクスチャの場合は何もしない
+	* </pre>
+	* @param[in] texture GetTextureで取得したテクスチャ
+	*/
+	void TouchTexture(const Texture* texture);
+
+	/**
+	* @brief フレームの切り替え関数
+	* @details 使用したフレームの記録に使用するフレーム番号を進める
+	*/
+	void NextFrame();
+
+	/**
+	* @brief 予算超過の確認関数
+	* @retval true 読み込まれているテクスチャの合計が予算を超えている
+	* @retval false 予算内、または予算なし
+	*/
+	bool IsOverBudget() const;
+
+	/**
+	* @brief 予算超過時の解放関数
+	* @details <pre>
+	* 予算内に収まるまで、最後に使用したフレームが古い順にテクスチャを解放する
+	* 直近TextureEvictionGuardFramesフレームで使用したテクスチャは解放しないので、予算を超えたままになる場合がある
+	* </pre>
+	* @retval int 解放したテクスチャの数
+	*/
+	int EvictTextures();
+
+	/**
+	* @brief 予算の設定関数
+	* @param[in] budget 読み込んでおくテクスチャの合計バイト数(0の場合は予算なし)
+	*/
+	void SetBudget(size_t budget)
+	{
+		m_Budget = budget;
+	}
+
+	/**
+	* @brief ファイル名からのテクスチャの検索関数
+	* @details 同じファイルを複数のキーワードで読み込んでいる場合は全てのキーワードを追加する
+	* @param[in] file_name ファイル名(FileWatcher::NormalizePathで正規化したもの)
+	* @param[out] out_keyword_list 見つかったテクスチャのキーワードを追加するリスト
+	*/
+	void FindTexturesByFile(const std::string& file_name, std::vector<std::string>* out_keyword_list);
+
+	/**
+	* @brief テクスチャの差し替え関数
+	* @details <pre>
+	* 登録済みのテクスチャのデータを解放し、作成済みのデータに差し替える
+	* GetTextureで取得したポインタは変わらないので、保持しているテクスチャもそのまま使用できる
+	* 他のキーワードと共有していた場合は共有をやめ、他のキーワードは元のテクスチャを使用し続ける
+	* </pre>
+	* @retval true 差し替え成功
+	* @retval false キーワードが登録されていない、または予算を超えて解放中(textureは解放されない)
+	* @param[in] keyword 差し替えるテクスチャのキーワード
+	* @param[in] texture 差し替えるデータ(成功した場合はこのクラスで解放する)
+	* @param[in] content_hash 差し替えるデータを作成したファイルの内容の識別情報(解放後に読み込み直す時の共有に使用する)
+	*/
+	bool ReplaceTexture(const char* keyword, const Texture& texture, const FileContentHash& content_hash);
+
+	/**
+	* @brief テクスチャの作成と解放を行うクラスの取得関数
+	* @retval TextureLoader* テクスチャの作成と解放を行うクラス
+	*/
+	TextureLoader* GetLoader() const
+	{
+		return m_Loader;
+	}
+
+	/**
+	* @brief テクスチャ使用メモリの取得関数
+	* @details 読み込んでいるテクスチャの使用メモリを1ピクセル4バイトとして計算して返す(共有しているテクスチャは1つ分)
+	* @retval unsigned int 使用メモリ(バイト)
+	*/
+	unsigned int GetTextureMemorySize();
+
+	/**
+	* @brief 使用メモリの状況の取得関数
+	* @retval TextureMemoryStats 使用メモリの状況
+	*/
+	TextureMemoryStats GetStats() const;
+
+private:
+	/** @brief 登録されているテクスチャ */
+	struct TextureEntry
+	{
+		/** Constructor */
+		TextureEntry() :
+			Data(),
+			FileName(),
+			ByteSize(0),
+			LastUsedFrame(0),
+			IsResident(false),
+			Content(),
+			IsShareable(false)
+		{
+		}
+
+		Texture Data;					//!< テクスチャデータ(解放中はTextureDataがnullptr)
+		std::string FileName;			//!< 読み込み直す時のファイル名
+		size_t ByteSize;				//!< テクスチャのバイト数(ミップマップを含む)
+		unsigned int LastUsedFrame;		//!< 最後に使用したフレーム
+		bool IsResident;				//!< 読み込まれているか
+		FileContentHash Content;		//!< 読み込んだファイルの内容の識別情報(読み込み直す時はこの値で共有を探す)
+		bool IsShareable;				//!< m_SharedListに登録して参照数を数えているか
+	};
+
+	/** @brief 複数のキーワードで共有しているテクスチャ */
+	struct SharedTexture
+	{
+		/** Constructor */
+		SharedTexture() :
+			Data(),
+			ByteSize(0),
+			ContentSize(0),
+			ReferenceCount(0)
+		{
+		}
+
+		Texture Data;					//!< テクスチャデータ
+		size_t ByteSize;				//!< テクスチャのバイト数
+		unsigned long long ContentSize;	//!< 作成したファイルのバイト数
+		int ReferenceCount;		//!< 読み込まれているキーワードの数
+	};
+
+	/**
+	* @brief テクスチャの使用記録関数
+	* @details 使用したフレームを記録し、解放されていた場合は読み込み直す
+	* @retval true 読み込まれている
+	* @retval false 読み込み直しに失敗
+	* @param[in,out] entry 使用するテクスチャ
+	*/
+	bool Touch(TextureEntry* entry);
+
+	/**
+	* @brief 読み込み関数
+	* @details 前回読み込んだ時の内容の識別情報がある場合は、ファイルを読まずに同じ内容のテクスチャを探す
+	* @retval true 読み込み成功
+	* @retval false 読み込み失敗
+	* @param[in,out] entry 読み込むテクスチャ
+	*/
+	bool LoadEntry(TextureEntry* entry);
+
+	/**
+	* @brief 解放関数
+	* @details キーワードの登録は残したままテクスチャだけを解放する
+	* @param[in,out] entry 解放するテクスチャ
+	*/
+	void UnloadEntry(TextureEntry* entry);
+
+	/**
+	* @brief ファイルの内容のハッシュ値の計算関数
+	* @details ローダーや呼び出し元が識別情報を渡さなかった場合だけ使用する
+	* @retval true 計算成功
+	* @retval false ファイルを読み込めなかった
+	* @param[in] file_name ファイル名(パス込み)
+	* @param[out] out_hash 内容の識別情報
+	*/
+	bool HashFile(const std::string& file_name, FileContentHash* out_hash) const;
+
+	/**
+	* @brief 読み込み済みテクスチャの共有関数
+	* @details ファイルの内容のハッシュ値とバイト数が同じテクスチャが読み込まれている場合、参照数を増やしてentryに設定する
+	* @retval true 共有した
+	* @retval false 同じ内容のテクスチャが読み込まれていない
+	* @param[in,out] entry 読み込むテクスチャ(Contentを計算済みのもの)
+	*/
+	bool ShareTexture(TextureEntry* entry);
+
+	/**
+	* @brief 共有するテクスチャの登録関数
+	* @details 同じハッシュ値で内容が異なる(バイト数が違う)テクスチャが登録済みの場合は登録しない
+	* @param[in,out] entry 読み込んだテクスチャ(Contentを計算済みのもの)
+	*/
+	void RegisterSharedTexture(TextureEntry* entry);
+
+	/**
+	* @brief 共有の参照の解除関数
+	* @retval true 最後の参照だった、または共有していない(テクスチャを解放する)
+	* @retval false 他のキーワードが使用している(テクスチャは解放しない)
+	* @param[in,out] entry 解除するテクスチャ
+	*/
+	bool ReleaseSharedReference(TextureEntry* entry);
+
 private:
-	std::map<const char*, Texture> m_TextureList; //!< テクスチャリスト
+	std::map<std::string, TextureEntry> m_TextureList;				//!< テクスチャリスト
+	std::unordered_map<const Texture*, TextureEntry*> m_EntryList;	//!< テクスチャデータから登録を探すためのリスト
+	std::unordered_map<unsigned long long, SharedTexture> m_SharedList;	//!< ファイルの内容のハッシュ値ごとの読み込み済みテクスチャ
+	TextureLoader* m_Loader;		//!< テクスチャの作成と解放を行うクラス
+	const FileSystem* m_FileSystem;	//!< ファイルを読み込む仮想ファイルシステム
+	size_t m_Budget;				//!< 予算
+	size_t m_ResidentSize;			//!< 読み込まれているテクスチャのバイト数
+	unsigned int m_CurrentFrame;	//!< 現在のフレーム番号
+	int m_EvictionCount;			//!< 予算を超えて解放した回数の合計
+	int m_ReloadCount;				//!< 読み込み直した回数の合計
 };
 
 #endif
@@ -0,0 +1,226 @@
+﻿#include <algorithm>
+#include <math.h>
+#include "Tilemap.h"
+
+bool Tilemap::Initialize(const Texture* tileset, int tile_width, int tile_height, int columns, int rows)
+{
+	Release();
+
+	if (tileset == nullptr || tile_width <= 0 || tile_height <= 0 || columns <= 0 || rows <= 0)
+	{
+		return false;
+	}
+
+	m_TilesetColumns = tileset->Width / tile_width;
+	int tileset_rows = tileset->Height / tile_height;
+	if (m_TilesetColumns == 0 || tileset_rows == 0)
+	{
+		return false;
+	}
+
+	m_Tileset = tileset;
+	m_TileWidth = tile_width;
+	m_TileHeight = tile_height;
+	m_TilesetTileCount = m_TilesetColumns * tileset_rows;
+	m_Columns = columns;
+	m_Rows = rows;
+	m_ChunkColumns = (columns + TilemapChunkSize - 1) / TilemapChunkSize;
+	m_ChunkRows = (rows + TilemapChunkSize - 1) / TilemapChunkSize;
+
+	m_TileList.assign(columns * rows, EmptyTile);
+	m_ChunkList.resize(m_ChunkColumns * m_ChunkRows);
+	for (TilemapChunk& chunk : m_ChunkList)
+	{
+		chunk.IsDirty = false;
+	}
+
+	return true;
+}
+
+void Tilemap::Release()
+{
+	m_Tileset = nullptr;
+	m_Columns = 0;
+	m_Rows = 0;
+	m_ChunkColumns = 0;
+	m_ChunkRows = 0;
+	m_TileList.clear();
+	m_ChunkList.clear();
+	m_DirtyChunkList.clear();
+}
+
+void Tilemap::SetTile(int column, int row, int tile_index)
+{
+	if (column < 0 || column >= m_Columns || row < 0 || row >= m_Rows)
+	{
+		return;
+	}
+
+	int& tile = m_TileList[row * m_Columns + column];
+	if (tile == tile_index)
+	{
+		return;
+	}
+
+	tile = tile_index;
+	MarkChunkDirty((row / TilemapChunkSize) * m_ChunkColumns + column / TilemapChunkSize);
+}
+
+void Tilemap::SetTiles(const int* tiles)
+{
+	if (m_TileList.empty() == true)
+	{
+		return;
+	}
+
+	m_TileList.assign(tiles, tiles + m_Columns * m_Rows);
+	MarkAllChunksDirty();
+}
+
+int Tilemap::GetTile(int column, int row) const
+{
+	if (column < 0 || column >= m_Columns || row < 0 || row >= m_Rows)
+	{
+		return EmptyTile;
+	}
+
+	return m_TileList[row * m_Columns + column];
+}
+
+void Tilemap::SetPosition(float x, float y)
+{
+	if (m_PositionX == x && m_PositionY == y)
+	{
+		return;
+	}
+
+	m_PositionX = x;
+	m_PositionY = y;
+	MarkAllChunksDirty();
+}
+
+void Tilemap::SetColor(DWORD color)
+{
+	if (m_Color == color)
+	{
+		return;
+	}
+
+	m_Color = color;
+	MarkAllChunksDirty();
+}
+
+int Tilemap::RebuildDirtyChunks()
+{
+	int count = (int)m_DirtyChunkList.size();
+
+	for (int chunk_index : m_DirtyChunkList)
+	{
+		BuildChunk(chunk_index);
+	}
+	m_DirtyChunkList.clear();
+
+	return count;
+}
+
+bool Tilemap::FindChunkRange(float left, float top, float right, float bottom, int* out_first_column, int* out_first_row, int* out_last_column, int* out_last_row) const
+{
+	if (m_ChunkList.empty() == true)
+	{
+		return false;
+	}
+
+	float chunk_width = (float)(m_TileWidth * TilemapChunkSize);
+	float chunk_height = (float)(m_TileHeight * TilemapChunkSize);
+
+	int first_column = (int)floorf((left - m_PositionX) / chunk_width);
+	int first_row = (int)floorf((top - m_PositionY) / chunk_height);
+	int last_column = (int)floorf((right - m_PositionX) / chunk_width);
+	int last_row = (int)floorf((bottom - m_PositionY) / chunk_height);
+
+	if (last_column < 0 || last_row < 0 || first_column >= m_ChunkColumns || first_row >= m_ChunkRows)
+	{
+		return false;
+	}
+
+	*out_first_column = (std::max)(first_column, 0);
+	*out_first_row = (std::max)(first_row, 0);
+	*out_last_column = (std::min)(last_column, m_ChunkColumns - 1);
+	*out_last_row = (std::min)(last_row, m_ChunkRows - 1);
+
+	return true;
+}
+
+void Tilemap::MarkChunkDirty(int chunk_index)
+{
+	TilemapChunk& chunk = m_ChunkList[chunk_index];
+	if (chunk.IsDirty == true)
+	{
+		return;
+	}
+
+	chunk.IsDirty = true;
+	m_DirtyChunkList.push_back(chunk_index);
+}
+
+void Tilemap::MarkAllChunksDirty()
+{
+	for (int i = 0; i < (int)m_ChunkList.size(); i++)
+	{
+		MarkChunkDirty(i);
+	}
+}
+
+void Tilemap::BuildChunk(int chunk_index)
+{
+	TilemapChunk& chunk = m_ChunkList[chunk_index];
+	chunk.IsDirty = false;
+	chunk.Vertices.clear();
+
+	int first_column = (chunk_index % m_ChunkColumns) * TilemapChunkSize;
+	int first_row = (chunk_index / m_ChunkColumns) * TilemapChunkSize;
+	int last_column = (std::min)(first_column + TilemapChunkSize, m_Columns);
+	int last_row = (std::min)(first_row + TilemapChunkSize, m_Rows);
+
+	// UVの割り算はタイルごとではなく1タイル分の幅を1回だけ求めておく
+	float tile_u = (float)m_TileWidth / m_Tileset->Width;
+	float tile_v = (float)m_TileHeight / m_Tileset->Height;
+
+	for (int row = first_row; row < last_row; row++)
+	{
+		const int* tiles = &m_TileList[row * m_Columns];
+		float top = m_PositionY + (float)(row * m_TileHeight);
+		float bottom = top + (float)m_TileHeight;
+
+		for (int column = first_column; column < last_column; column++)
+		{
+			int tile_index = tiles[column];
+			if (tile_index < 0 || tile_index >= m_TilesetTileCount)
+			{
+				continue;
+			}
+
+			float left = m_PositionX + (float)(column * m_TileWidth);
+			float right = left + (float)m_TileWidth;
+			float u_left = (tile_index % m_TilesetColumns) * tile_u;
+			float v_top = (tile_index / m_TilesetColumns) * tile_v;
+			float u_right = u_left + tile_u;
+			float v_bottom = v_top + tile_v;
+
+			CustomVertex v[4] =
+			{
+				{ left, top, 0.0f, 1.0f, m_Color, u_left, v_top },
+				{ right, top, 0.0f, 1.0f, m_Color, u_right, v_top },
+				{ right, bottom, 0.0f, 1.0f, m_Color, u_right, v_bottom },
+				{ left, bottom, 0.0f, 1.0f, m_Color, u_left, v_bottom },
+			};
+
+			chunk.Vertices.push_back(v[0]);
+			chunk.Vertices.push_back(v[1]);
+			chunk.Vertices.push_back(v[2]);
+			chunk.Vertices.push_back(v[0]);
+			chunk.Vertices.push_back(v[2]);
+			chunk.Vertices.push_back(v[3]);
+		}
+	}
+}
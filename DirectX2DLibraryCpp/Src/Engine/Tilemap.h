@@ -0,0 +1,207 @@
+﻿/**
+* @file Tilemap.h
+* @brief <pre>
+* タイルセットのテクスチャとタイル番号の配列から描画するタイルマップクラスの宣言
+* 頂点データは一定サイズのチャンクごとに作成して保持し、タイルを変更したチャンクだけを作り直す
+* デバイスを使用しないので、頂点の作成と表示範囲の計算は描画バックエンドに関係なく動作する
+* 描画はGraphics::DrawTilemapで行う
+* </pre>
+*/
+#ifndef TILEMAP_H_
+#define TILEMAP_H_
+
+#include <vector>
+#include "EngineConstant.h"
+
+const int TilemapChunkSize = 16;	//!< チャンクの一辺のタイル数(1チャンクの頂点数がバッチに収まるサイズ)
+const int EmptyTile = -1;			//!< 何も描画しないタイル番号
+
+/** @brief タイルマップのチャンク */
+struct TilemapChunk
+{
+	std::vector<CustomVertex> Vertices;		//!< チャンク内のタイルの頂点データ(三角形リスト、ワールド座標)
+	bool IsDirty;							//!< 頂点データの作り直しが必要か
+};
+
+/**
+* @brief タイルマップクラス
+* @details <pre>
+* タイル番号はタイルセットの左上から右方向に0,1,2...と数える
+* タイルの変更時は所属するチャンクに印を付けるだけで、頂点の作成は描画前にまとめて行う
+* </pre>
+*/
+class Tilemap
+{
+public:
+	/** Constructor */
+	Tilemap() :
+		m_Tileset(nullptr),
+		m_TileWidth(0),
+		m_TileHeight(0),
+		m_TilesetColumns(0),
+		m_TilesetTileCount(0),
+		m_Columns(0),
+		m_Rows(0),
+		m_ChunkColumns(0),
+		m_ChunkRows(0),
+		m_PositionX(0.0f),
+		m_PositionY(0.0f),
+		m_Color(D3DCOLOR_ARGB(255, 255, 255, 255)),
+		m_TileList(),
+		m_ChunkList(),
+		m_DirtyChunkList()
+	{
+	}
+
+	/**
+	* @brief 初期化関数
+	* @details 全てのタイルをEmptyTileにしてチャンクを作成する
+	* @retval true 初期化成功
+	* @retval false 初期化失敗(タイルセットがない、サイズが不正)
+	* @param[in] tileset タイルセットのテクスチャ(Engine::GetTextureで取得したもの)
+	* @param[in] tile_width タイルの横幅(ピクセル)
+	* @param[in] tile_height タイルの縦幅(ピクセル)
+	* @param[in] columns マップの横のタイル数
+	* @param[in] rows マップの縦のタイル数
+	*/
+	bool Initialize(const Texture* tileset, int tile_width, int tile_height, int columns, int rows);
+
+	/**
+	* @brief 解放関数
+	*/
+	void Release();
+
+	/**
+	* @brief タイル設定関数
+	* @param[in] column 列
+	* @param[in] row 行
+	* @param[in] tile_index タイル番号(EmptyTileの場合は描画しない)
+	*/
+	void SetTile(int column, int row, int tile_index);
+
+	/**
+	* @brief タイル一括設定関数
+	* @param[in] tiles タイル番号の配列(行ごとに左から並べたもの、列数×行数の要素数)
+	*/
+	void SetTiles(const int* tiles);
+
+	/**
+	* @brief タイル取得関数
+	* @retval int タイル番号(範囲外の場合はEmptyTile)
+	* @param[in] column 列
+	* @param[in] row 行
+	*/
+	int GetTile(int column, int row) const;
+
+	/**
+	* @brief 描画位置の設定関数
+	* @details 位置を変更すると全てのチャンクを作り直す
+	* @param[in] x マップの左上のワールド座標X
+	* @param[in] y マップの左上のワールド座標Y
+	*/
+	void SetPosition(float x, float y);
+
+	/**
+	* @brief 頂点カラーの設定関数
+	* @details 色を変更すると全てのチャンクを作り直す
+	* @param[in] color 頂点カラー(ARGB形式)
+	*/
+	void SetColor(DWORD color);
+
+	/**
+	* @brief チャンクの再作成関数
+	* @details 印が付いたチャンクの頂点データを作り直す
+	* @retval int 作り直したチャンクの数
+	*/
+	int RebuildDirtyChunks();
+
+	/**
+	* @brief 範囲に重なるチャンクの取得関数
+	* @retval true 重なるチャンクがある
+	* @retval false 重なるチャンクがない
+	* @param[in] left 範囲の左端(ワールド座標)
+	* @param[in] top 範囲の上端(ワールド座標)
+	* @param[in] right 範囲の右端(ワールド座標)
+	* @param[in] bottom 範囲の下端(ワールド座標)
+	* @param[out] out_first_column 重なる最初のチャンクの列
+	* @param[out] out_first_row 重なる最初のチャンクの行
+	* @param[out] out_last_column 重なる最後のチャンクの列
+	* @param[out] out_last_row 重なる最後のチャンクの行
+	*/
+	bool FindChunkRange(float left, float top, float right, float bottom, int* out_first_column, int* out_first_row, int* out_last_column, int* out_last_row) const;
+
+	/**
+	* @brief チャンクの取得関数
+	* @retval const TilemapChunk& チャンク
+	* @param[in] chunk_column チャンクの列
+	* @param[in] chunk_row チャンクの行
+	*/
+	const TilemapChunk& GetChunk(int chunk_column, int chunk_row) const
+	{
+		return m_ChunkList[chunk_row * m_ChunkColumns + chunk_column];
+	}
+
+	/**
+	* @brief タイルセットの取得関数
+	* @retval const Texture* タイルセットのテクスチャ
+	*/
+	const Texture* GetTileset() const
+	{
+		return m_Tileset;
+	}
+
+	/**
+	* @brief 横のチャンク数の取得関数
+	* @retval int 横のチャンク数
+	*/
+	int GetChunkColumns() const
+	{
+		return m_ChunkColumns;
+	}
+
+	/**
+	* @brief 縦のチャンク数の取得関数
+	* @retval int 縦のチャンク数
+	*/
+	int GetChunkRows() const
+	{
+		return m_ChunkRows;
+	}
+
+private:
+	/**
+	* @brief チャンクに印を付ける関数
+	* @param[in] chunk_index チャンクの番号
+	*/
+	void MarkChunkDirty(int chunk_index);
+
+	/**
+	* @brief 全チャンクに印を付ける関数
+	*/
+	void MarkAllChunksDirty();
+
+	/**
+	* @brief チャンクの頂点作成関数
+	* @param[in] chunk_index チャンクの番号
+	*/
+	void BuildChunk(int chunk_index);
+
+private:
+	const Texture* m_Tileset;					//!< タイルセットのテクスチャ
+	int m_TileWidth;							//!< タイルの横幅
+	int m_TileHeight;							//!< タイルの縦幅
+	int m_TilesetColumns;						//!< タイルセットの横のタイル数
+	int m_TilesetTileCount;						//!< タイルセットのタイル数
+	int m_Columns;								//!< マップの横のタイル数
+	int m_Rows;									//!< マップの縦のタイル数
+	int m_ChunkColumns;							//!< 横のチャンク数
+	int m_ChunkRows;							//!< 縦のチャンク数
+	float m_PositionX;							//!< マップの左上のワールド座標X
+	float m_PositionY;							//!< マップの左上のワールド座標Y
+	DWORD m_Color;								//!< 頂点カラー
+	std::vector<int> m_TileList;				//!< タイル番号
+	std::vector<TilemapChunk> m_ChunkList;		//!< チャンク
+	std::vector<int> m_DirtyChunkList;			//!< 作り直しが必要なチャンクの番号
+};
+
+#endif
@@ -1,4 +1,5 @@
 ﻿#include "Window.h"
+#include "Profiler.h"
 
 LRESULT CALLBACK Window::WindowProc(HWND window_handle, UINT message_id, WPARAM wparam, LPARAM lparam)
 {
@@ -84,6 +85,8 @@ bool Window::MakeWindow(int width, int height, const char* title)
 
 void Window::Update()
 {
+	PROFILE_FUNCTION();
+
 	bool message_ret = false;
 	MSG msg;
 
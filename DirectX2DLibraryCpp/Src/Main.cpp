@@ -31,18 +31,17 @@ int WINAPI WinMain(
 		return 0;
 	}
 
-	// テクスチャ読み込み
-	// 第一引数の文字列で読み込んだテクスチャを登録する
-	// 描画や取得は登録した文字列で指定する
-	Engine::LoadTexture("Enemy", "Res/Enemy.png");
-	Engine::LoadTexture("Bomb", "Res/bomb_move.png");
+	// 縮小して描画するテクスチャのちらつきを減らすためにミップマップを作成する
+	Engine::SetTextureMipmapGeneration(true);
 
-	
-	// サウンド読み込み
-	// 第一引数の文字列で読み込んだサウンドを登録する
+	// テクスチャとサウンドの一括読み込み
+	// マニフェストに列挙したファイルをワーカースレッドで並列に読み込み、キーワードで登録する
 	// 描画や取得は登録した文字列で指定する
-	Engine::LoadSoundFile("Bgm", "Res/Bgm.wav");
-	Engine::LoadSoundFile("Se", "Res/Se.wav");
+	// 1つずつ読み込む場合はEngine::LoadTexture、Engine::LoadSoundFileを使用する
+	if (Engine::StartPreload("Res/Preload.txt") == true)
+	{
+		Engine::WaitPreload();
+	}
 
 	// サウンド再生
 	// 指定されたキーワードのサウンドファイルを再生する
@@ -118,6 +117,14 @@ void GameProcessing()
 		}
 	}
 
+	// パフォーマンスオーバーレイの表示切り替え
+	static bool is_overlay_visible = false;
+	if (Engine::IsKeyboardKeyPushed(DIK_F1) == true)
+	{
+		is_overlay_visible = !is_overlay_visible;
+		Engine::SetPerformanceOverlayVisible(is_overlay_visible);
+	}
+
 	// 
 	if (Engine::IsKeyboardKeyReleased(DIK_A))
 	{
@@ -153,8 +160,11 @@ void DrawProcessing()
 	Engine::SetPivotType(PivotType::LeftTop);
 	Engine::DrawTexture(300, 200, "Enemy", 128, 0.0f, 1.0f, 1.0f);
 
+	// 拡縮するテクスチャはミップマップを補間して描画する
 	Engine::SetPivotType((PivotType)g_PivotType);
+	Engine::SetTextureFilter(TextureFilter::TextureFilterTrilinear);
 	Engine::DrawTextureUV(300, 200, "Enemy", 0.0f, 0.0f, 64.0f, 64.0f, 128, 0.0f, g_Scale.X, g_Scale.Y);
+	Engine::SetTextureFilter(TextureFilter::TextureFilterPoint);
 
 	// フォント描画
 	Engine::DrawFont(0.0f, 5.0f, "FontSize:Small", FontSize::Small, FontColor::White);
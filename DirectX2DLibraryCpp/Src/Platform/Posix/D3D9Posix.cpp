@@ -0,0 +1,450 @@
+﻿#include <d3dx9.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#ifdef POSIX_USE_LIBPNG
+#include <png.h>
+#endif
+
+namespace
+{
+	/** @brief 参照カウントを持つインターフェースの共通の実装 */
+	template<typename Interface>
+	class PosixUnknown : public Interface
+	{
+	public:
+		ULONG AddRef() override
+		{
+			return ++m_ReferenceCount;
+		}
+
+		ULONG Release() override
+		{
+			ULONG count = --m_ReferenceCount;
+			if (count == 0)
+			{
+				delete this;
+			}
+			return count;
+		}
+
+	private:
+		std::atomic<ULONG> m_ReferenceCount{ 1 };
+	};
+
+	/** @brief システムメモリのピクセル(A8R8G8B8とX8R8G8B8だけに対応する) */
+	struct PosixImage
+	{
+		UINT Width = 0;
+		UINT Height = 0;
+		std::vector<DWORD> Pixels;
+
+		void Resize(UINT width, UINT height)
+		{
+			Width = width;
+			Height = height;
+			Pixels.assign((size_t)width * height, 0);
+		}
+
+		HRESULT Lock(D3DLOCKED_RECT* out_locked_rect, const RECT* rect)
+		{
+			if (out_locked_rect == nullptr)
+			{
+				return D3DERR_INVALIDCALL;
+			}
+
+			size_t offset = 0;
+			if (rect != nullptr)
+			{
+				if (rect->left < 0 || rect->top < 0 || rect->right > (LONG)Width || rect->bottom > (LONG)Height ||
+					rect->left >= rect->right || rect->top >= rect->bottom)
+				{
+					return D3DERR_INVALIDCALL;
+				}
+				offset = (size_t)rect->top * Width + rect->left;
+			}
+
+			out_locked_rect->pBits = Pixels.data() + offset;
+			out_locked_rect->Pitch = (INT)(Width * sizeof(DWORD));
+			return D3D_OK;
+		}
+
+		void GetDesc(D3DFORMAT format, D3DPOOL pool, D3DSURFACE_DESC* out_desc) const
+		{
+			out_desc->Format = format;
+			out_desc->Pool = pool;
+			out_desc->Width = Width;
+			out_desc->Height = Height;
+		}
+	};
+
+	/** @brief サーフェス */
+	class PosixSurface : public PosixUnknown<IDirect3DSurface9>
+	{
+	public:
+		PosixSurface(UINT width, UINT height, D3DFORMAT format, D3DPOOL pool) :
+			m_Format(format),
+			m_Pool(pool)
+		{
+			m_Image.Resize(width, height);
+		}
+
+		HRESULT GetDesc(D3DSURFACE_DESC* out_desc) override
+		{
+			m_Image.GetDesc(m_Format, m_Pool, out_desc);
+			return D3D_OK;
+		}
+
+		HRESULT LockRect(D3DLOCKED_RECT* out_locked_rect, const RECT* rect, DWORD flags) override
+		{
+			return m_Image.Lock(out_locked_rect, rect);
+		}
+
+		HRESULT UnlockRect() override
+		{
+			return D3D_OK;
+		}
+
+		PosixImage* GetImage()
+		{
+			return &m_Image;
+		}
+
+	private:
+		PosixImage m_Image;
+		D3DFORMAT m_Format;
+		D3DPOOL m_Pool;
+	};
+
+	/** @brief ミップマップのレベルを持つテクスチャ */
+	class PosixTexture : public PosixUnknown<IDirect3DTexture9>
+	{
+	public:
+		PosixTexture(UINT width, UINT height, UINT levels, D3DFORMAT format, D3DPOOL pool) :
+			m_Format(format),
+			m_Pool(pool)
+		{
+			// レベル数が0の場合は1x1までの全てのレベルを作成する
+			for (UINT level = 0; levels == 0 || level < levels; level++)
+			{
+				m_LevelList.emplace_back();
+				m_LevelList.back().Resize(width, height);
+				if (width == 1 && height == 1)
+				{
+					break;
+				}
+				width = (std::max)(width / 2, 1u);
+				height = (std::max)(height / 2, 1u);
+			}
+		}
+
+		DWORD GetLevelCount() override
+		{
+			return (DWORD)m_LevelList.size();
+		}
+
+		HRESULT GetLevelDesc(UINT level, D3DSURFACE_DESC* out_desc) override
+		{
+			if (level >= m_LevelList.size() || out_desc == nullptr)
+			{
+				return D3DERR_INVALIDCALL;
+			}
+			m_LevelList[level].GetDesc(m_Format, m_Pool, out_desc);
+			return D3D_OK;
+		}
+
+		HRESULT LockRect(UINT level, D3DLOCKED_RECT* out_locked_rect, const RECT* rect, DWORD flags) override
+		{
+			if (level >= m_LevelList.size())
+			{
+				return D3DERR_INVALIDCALL;
+			}
+			return m_LevelList[level].Lock(out_locked_rect, rect);
+		}
+
+		HRESULT UnlockRect(UINT level) override
+		{
+			return level < m_LevelList.size() ? D3D_OK : D3DERR_INVALIDCALL;
+		}
+
+		PosixImage* GetImage(UINT level)
+		{
+			return &m_LevelList[level];
+		}
+
+	private:
+		std::vector<PosixImage> m_LevelList;
+		D3DFORMAT m_Format;
+		D3DPOOL m_Pool;
+	};
+
+	/** @brief NULLREFデバイス(リソースの作成だけを行い、描画命令は何もしない) */
+	class PosixDevice : public PosixUnknown<IDirect3DDevice9>
+	{
+	public:
+		HRESULT CreateTexture(UINT width, UINT height, UINT levels, DWORD usage, D3DFORMAT format, D3DPOOL pool, IDirect3DTexture9** out_texture, HANDLE* shared_handle) override
+		{
+			if (out_texture == nullptr || width == 0 || height == 0)
+			{
+				return D3DERR_INVALIDCALL;
+			}
+			*out_texture = new PosixTexture(width, height, levels, format, pool);
+			return D3D_OK;
+		}
+
+		HRESULT CreateOffscreenPlainSurface(UINT width, UINT height, D3DFORMAT format, D3DPOOL pool, IDirect3DSurface9** out_surface, HANDLE* shared_handle) override
+		{
+			if (out_surface == nullptr || width == 0 || height == 0)
+			{
+				return D3DERR_INVALIDCALL;
+			}
+			*out_surface = new PosixSurface(width, height, format, pool);
+			return D3D_OK;
+		}
+
+		HRESULT SetViewport(const D3DVIEWPORT9* view_port) override { return D3D_OK; }
+		HRESULT SetRenderState(D3DRENDERSTATETYPE state, DWORD value) override { return D3D_OK; }
+		HRESULT SetTextureStageState(DWORD stage, D3DTEXTURESTAGESTATETYPE type, DWORD value) override { return D3D_OK; }
+		HRESULT SetSamplerState(DWORD sampler, D3DSAMPLERSTATETYPE type, DWORD value) override { return D3D_OK; }
+		HRESULT SetTexture(DWORD stage, IDirect3DBaseTexture9* texture) override { return D3D_OK; }
+		HRESULT SetFVF(DWORD fvf) override { return D3D_OK; }
+		HRESULT Clear(DWORD count, const void* rects, DWORD flags, D3DCOLOR color, float z, DWORD stencil) override { return D3D_OK; }
+		HRESULT BeginScene() override { return D3D_OK; }
+		HRESULT EndScene() override { return D3D_OK; }
+		HRESULT Present(const RECT* source_rect, const RECT* dest_rect, HWND dest_window, const void* dirty_region) override { return D3D_OK; }
+		HRESULT DrawPrimitiveUP(D3DPRIMITIVETYPE type, UINT primitive_count, const void* vertices, UINT stride) override { return D3D_OK; }
+	};
+
+	/** @brief Direct3D9のインターフェース */
+	class PosixDirect3D : public PosixUnknown<IDirect3D9>
+	{
+	public:
+		HRESULT CreateDevice(UINT adapter, D3DDEVTYPE device_type, HWND focus_window, DWORD behavior_flags, D3DPRESENT_PARAMETERS* present_param, IDirect3DDevice9** out_device) override
+		{
+			// ハードウェアのデバイスはないので、NULLREFデバイスだけを作成できる
+			if (device_type != D3DDEVTYPE_NULLREF || out_device == nullptr)
+			{
+				return D3DERR_NOTAVAILABLE;
+			}
+			*out_device = new PosixDevice();
+			return D3D_OK;
+		}
+	};
+
+	bool ReadWholeFile(const char* file_name, std::vector<unsigned char>* out_data)
+	{
+		FILE* fp = nullptr;
+		if (file_name == nullptr || fopen_s(&fp, file_name, "rb") != 0 || fp == nullptr)
+		{
+			return false;
+		}
+
+		fseek(fp, 0, SEEK_END);
+		long size = ftell(fp);
+		fseek(fp, 0, SEEK_SET);
+
+		bool is_succeeded = size >= 0;
+		if (is_succeeded == true)
+		{
+			out_data->resize((size_t)size);
+			is_succeeded = size == 0 || fread(out_data->data(), 1, (size_t)size, fp) == (size_t)size;
+		}
+		fclose(fp);
+
+		return is_succeeded;
+	}
+
+	// PNGをA8R8G8B8でデコードする(out_imageがnullptrの場合はサイズだけを取得する)
+	HRESULT DecodePng(const void* data, UINT size, D3DCOLOR color_key, D3DXIMAGE_INFO* out_info, PosixImage* out_image)
+	{
+#ifdef POSIX_USE_LIBPNG
+		if (data == nullptr || size == 0)
+		{
+			return D3DXERR_INVALIDDATA;
+		}
+
+		png_image image;
+		memset(&image, 0, sizeof(image));
+		image.version = PNG_IMAGE_VERSION;
+		if (png_image_begin_read_from_memory(&image, data, size) == 0)
+		{
+			return D3DXERR_INVALIDDATA;
+		}
+
+		if (out_info != nullptr)
+		{
+			out_info->Width = image.width;
+			out_info->Height = image.height;
+			out_info->Depth = 1;
+			out_info->MipLevels = 1;
+			out_info->Format = D3DFMT_A8R8G8B8;
+			out_info->ImageFileFormat = D3DXIFF_PNG;
+		}
+
+		if (out_image == nullptr)
+		{
+			png_image_free(&image);
+			return D3D_OK;
+		}
+
+		// リトルエンディアンのBGRAはD3DFMT_A8R8G8B8と同じ並び
+		image.format = PNG_FORMAT_BGRA;
+		out_image->Resize(image.width, image.height);
+		if (png_image_finish_read(&image, nullptr, out_image->Pixels.data(), 0, nullptr) == 0)
+		{
+			return D3DXERR_INVALIDDATA;
+		}
+
+		// D3DXと同じく、カラーキーと一致するピクセルは透明な黒にする
+		if (color_key != 0)
+		{
+			for (DWORD& pixel : out_image->Pixels)
+			{
+				if (pixel == color_key)
+				{
+					pixel = 0;
+				}
+			}
+		}
+		return D3D_OK;
+#else
+		return D3DERR_NOTAVAILABLE;
+#endif
+	}
+
+	HRESULT CreateTextureFromImage(LPDIRECT3DDEVICE9 device, const void* data, UINT size, D3DPOOL pool, D3DCOLOR color_key, D3DXIMAGE_INFO* out_info, LPDIRECT3DTEXTURE9* out_texture)
+	{
+		if (device == nullptr || out_texture == nullptr)
+		{
+			return D3DERR_INVALIDCALL;
+		}
+
+		PosixImage image;
+		HRESULT result = DecodePng(data, size, color_key, out_info, &image);
+		if (FAILED(result))
+		{
+			return result;
+		}
+
+		PosixTexture* texture = new PosixTexture(image.Width, image.Height, 1, D3DFMT_A8R8G8B8, pool);
+		texture->GetImage(0)->Pixels.swap(image.Pixels);
+		*out_texture = texture;
+		return D3D_OK;
+	}
+
+	HRESULT LoadSurfaceFromImage(LPDIRECT3DSURFACE9 dest_surface, const void* data, UINT size, D3DCOLOR color_key, D3DXIMAGE_INFO* out_info)
+	{
+		PosixSurface* surface = dynamic_cast<PosixSurface*>(dest_surface);
+		if (surface == nullptr)
+		{
+			return D3DERR_INVALIDCALL;
+		}
+
+		PosixImage image;
+		HRESULT result = DecodePng(data, size, color_key, out_info, &image);
+		if (FAILED(result))
+		{
+			return result;
+		}
+
+		// 拡大縮小には対応しないので、サーフェスと同じサイズの画像だけを読み込める
+		PosixImage* dest_image = surface->GetImage();
+		if (image.Width != dest_image->Width || image.Height != dest_image->Height)
+		{
+			return D3DERR_INVALIDCALL;
+		}
+		dest_image->Pixels.swap(image.Pixels);
+		return D3D_OK;
+	}
+}
+
+IDirect3D9* Direct3DCreate9(UINT sdk_version)
+{
+	return new PosixDirect3D();
+}
+
+HRESULT D3DXGetImageInfoFromFile(LPCSTR src_file, D3DXIMAGE_INFO* out_src_info)
+{
+	std::vector<unsigned char> data;
+	if (ReadWholeFile(src_file, &data) == false)
+	{
+		return D3DERR_INVALIDCALL;
+	}
+	return DecodePng(data.data(), (UINT)data.size(), 0, out_src_info, nullptr);
+}
+
+HRESULT D3DXGetImageInfoFromFileInMemory(const void* src_data, UINT src_data_size, D3DXIMAGE_INFO* out_src_info)
+{
+	return DecodePng(src_data, src_data_size, 0, out_src_info, nullptr);
+}
+
+HRESULT D3DXCreateTextureFromFileEx(LPDIRECT3DDEVICE9 device, LPCSTR src_file, UINT width, UINT height, UINT mip_levels, DWORD usage, D3DFORMAT format, D3DPOOL pool, DWORD filter, DWORD mip_filter, D3DCOLOR color_key, D3DXIMAGE_INFO* out_src_info, PALETTEENTRY* out_palette, LPDIRECT3DTEXTURE9* out_texture)
+{
+	std::vector<unsigned char> data;
+	if (ReadWholeFile(src_file, &data) == false)
+	{
+		return D3DERR_INVALIDCALL;
+	}
+	return CreateTextureFromImage(device, data.data(), (UINT)data.size(), pool, color_key, out_src_info, out_texture);
+}
+
+HRESULT D3DXCreateTextureFromFileInMemoryEx(LPDIRECT3DDEVICE9 device, const void* src_data, UINT src_data_size, UINT width, UINT height, UINT mip_levels, DWORD usage, D3DFORMAT format, D3DPOOL pool, DWORD filter, DWORD mip_filter, D3DCOLOR color_key, D3DXIMAGE_INFO* out_src_info, PALETTEENTRY* out_palette, LPDIRECT3DTEXTURE9* out_texture)
+{
+	return CreateTextureFromImage(device, src_data, src_data_size, pool, color_key, out_src_info, out_texture);
+}
+
+HRESULT D3DXLoadSurfaceFromFile(LPDIRECT3DSURFACE9 dest_surface, const PALETTEENTRY* dest_palette, const RECT* dest_rect, LPCSTR src_file, const RECT* src_rect, DWORD filter, D3DCOLOR color_key, D3DXIMAGE_INFO* out_src_info)
+{
+	std::vector<unsigned char> data;
+	if (ReadWholeFile(src_file, &data) == false)
+	{
+		return D3DERR_INVALIDCALL;
+	}
+	return LoadSurfaceFromImage(dest_surface, data.data(), (UINT)data.size(), color_key, out_src_info);
+}
+
+HRESULT D3DXLoadSurfaceFromFileInMemory(LPDIRECT3DSURFACE9 dest_surface, const PALETTEENTRY* dest_palette, const RECT* dest_rect, const void* src_data, UINT src_data_size, const RECT* src_rect, DWORD filter, D3DCOLOR color_key, D3DXIMAGE_INFO* out_src_info)
+{
+	return LoadSurfaceFromImage(dest_surface, src_data, src_data_size, color_key, out_src_info);
+}
+
+HRESULT D3DXSaveSurfaceToFile(LPCSTR dest_file, D3DXIMAGE_FILEFORMAT dest_format, LPDIRECT3DSURFACE9 src_surface, const PALETTEENTRY* src_palette, const RECT* src_rect)
+{
+#ifdef POSIX_USE_LIBPNG
+	PosixSurface* surface = dynamic_cast<PosixSurface*>(src_surface);
+	if (surface == nullptr || dest_format != D3DXIFF_PNG || src_rect != nullptr)
+	{
+		return D3DERR_INVALIDCALL;
+	}
+
+	D3DSURFACE_DESC desc;
+	surface->GetDesc(&desc);
+
+	// X8R8G8B8はアルファを持たないので不透明として保存する
+	const PosixImage* image = surface->GetImage();
+	std::vector<DWORD> pixels = image->Pixels;
+	if (desc.Format == D3DFMT_X8R8G8B8)
+	{
+		for (DWORD& pixel : pixels)
+		{
+			pixel |= 0xff000000;
+		}
+	}
+
+	png_image png;
+	memset(&png, 0, sizeof(png));
+	png.version = PNG_IMAGE_VERSION;
+	png.width = image->Width;
+	png.height = image->Height;
+	png.format = PNG_FORMAT_BGRA;
+	if (png_image_write_to_file(&png, dest_file, 0, pixels.data(), 0, nullptr) == 0)
+	{
+		return D3DERR_INVALIDCALL;
+	}
+	return D3D_OK;
+#else
+	return D3DERR_NOTAVAILABLE;
+#endif
+}
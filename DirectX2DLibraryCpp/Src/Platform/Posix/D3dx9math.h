@@ -0,0 +1,12 @@
+﻿/**
+* @file D3dx9math.h
+* @brief Windows以外でビルドするためのD3DXの数学関数の代替の宣言
+*/
+#ifndef POSIX_D3DX9MATH_H_
+#define POSIX_D3DX9MATH_H_
+
+#define D3DX_PI ((float)3.141592654f)
+#define D3DXToRadian(degree) ((degree) * (D3DX_PI / 180.0f))
+#define D3DXToDegree(radian) ((radian) * (180.0f / D3DX_PI))
+
+#endif
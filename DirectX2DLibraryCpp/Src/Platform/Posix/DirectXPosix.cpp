@@ -0,0 +1,30 @@
+﻿#include <dinput.h>
+#include <dsound.h>
+
+// 入力デバイスとサウンドデバイスは使用できないので、識別子は値を区別するためだけに定義する
+const GUID IID_IDirectInput8 = { 0xbf798030, 0x483a, 0x4da2, { 0xaa, 0x99, 0x5d, 0x64, 0xed, 0x36, 0x97, 0x00 } };
+const GUID GUID_SysKeyboard = { 0x6f1d2b61, 0xd5a0, 0x11cf, { 0xbf, 0xc7, 0x44, 0x45, 0x53, 0x54, 0x00, 0x00 } };
+const GUID GUID_SysMouse = { 0x6f1d2b60, 0xd5a0, 0x11cf, { 0xbf, 0xc7, 0x44, 0x45, 0x53, 0x54, 0x00, 0x00 } };
+const GUID DS3DALG_DEFAULT = {};
+
+const DIDATAFORMAT c_dfDIKeyboard = { sizeof(DIDATAFORMAT), 0, 0, 256, 0, nullptr };
+const DIDATAFORMAT c_dfDIMouse = { sizeof(DIDATAFORMAT), 0, 0, sizeof(DIMOUSESTATE), 0, nullptr };
+const DIDATAFORMAT c_dfDIJoystick = { sizeof(DIDATAFORMAT), 0, 0, sizeof(DIJOYSTATE), 0, nullptr };
+
+HRESULT DirectInput8Create(HINSTANCE instance, DWORD version, REFIID riid, LPVOID* out_interface, void* outer)
+{
+	if (out_interface != nullptr)
+	{
+		*out_interface = nullptr;
+	}
+	return E_NOTIMPL;
+}
+
+HRESULT DirectSoundCreate8(const GUID* device, LPDIRECTSOUND8* out_interface, void* outer)
+{
+	if (out_interface != nullptr)
+	{
+		*out_interface = nullptr;
+	}
+	return E_NOTIMPL;
+}
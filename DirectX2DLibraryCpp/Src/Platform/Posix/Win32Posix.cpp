@@ -0,0 +1,929 @@
+﻿#include <Windows.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace
+{
+	const ULONGLONG FileTimeUnixEpoch = 116444736000000000ULL;	// 1601年1月1日から1970年1月1日までの100ナノ秒数
+	const ULONGLONG FileTimeTicksPerSecond = 10000000ULL;		// 1秒あたりのFILETIMEの単位数
+	const LONG GdiGlyphMargin = 1;								// 箱型のグリフの上下左右の余白
+
+	thread_local DWORD g_LastError = 0;
+
+	/** @brief CloseHandleで解放するハンドルの基底 */
+	struct PosixHandle
+	{
+		virtual ~PosixHandle() {}
+	};
+
+	/** @brief ファイルとディレクトリのハンドル */
+	struct PosixFileHandle : public PosixHandle
+	{
+		int Descriptor = -1;
+
+		~PosixFileHandle() override
+		{
+			if (Descriptor >= 0)
+			{
+				close(Descriptor);
+			}
+		}
+	};
+
+	/** @brief ファイルマッピングのハンドル(サイズだけを保持し、マップ時にファイルを使用する) */
+	struct PosixMappingHandle : public PosixHandle
+	{
+		int Descriptor = -1;
+		size_t Size = 0;
+
+		~PosixMappingHandle() override
+		{
+			if (Descriptor >= 0)
+			{
+				close(Descriptor);
+			}
+		}
+	};
+
+	/** @brief イベントとセマフォのハンドル */
+	struct PosixSyncHandle : public PosixHandle
+	{
+		std::mutex Mutex;
+		std::condition_variable Condition;
+		LONG Count = 0;
+		LONG MaxCount = 1;
+		bool IsManualReset = false;
+
+		// ロックした状態で呼び出す
+		bool TryAcquire()
+		{
+			if (Count <= 0)
+			{
+				return false;
+			}
+			if (IsManualReset == false)
+			{
+				Count--;
+			}
+			return true;
+		}
+	};
+
+	/** @brief FindFirstFileのハンドル */
+	struct PosixFindHandle : public PosixHandle
+	{
+		DIR* Directory = nullptr;
+		std::string Path;
+
+		~PosixFindHandle() override
+		{
+			if (Directory != nullptr)
+			{
+				closedir(Directory);
+			}
+		}
+	};
+
+	/** @brief GDIのフォント(高さだけを保持する) */
+	struct PosixFont
+	{
+		int Height;
+		int Width;
+	};
+
+	/** @brief GDIのデバイスコンテキスト */
+	struct PosixDeviceContext
+	{
+		PosixFont* Font = nullptr;
+	};
+
+	std::mutex g_ViewMutex;
+	std::unordered_map<const void*, size_t> g_ViewSizeList;
+
+	DWORD ConvertErrno(int error_number)
+	{
+		switch (error_number)
+		{
+		case ENOENT:
+		case ENOTDIR:
+			return ERROR_FILE_NOT_FOUND;
+		case EACCES:
+		case EPERM:
+			return ERROR_ACCESS_DENIED;
+		case EEXIST:
+			return ERROR_ALREADY_EXISTS;
+		default:
+			return ERROR_INVALID_PARAMETER;
+		}
+	}
+
+	void ConvertTimespec(const timespec& time, FILETIME* out_file_time)
+	{
+		ULONGLONG ticks = (ULONGLONG)time.tv_sec * FileTimeTicksPerSecond + time.tv_nsec / 100 + FileTimeUnixEpoch;
+		out_file_time->dwLowDateTime = (DWORD)ticks;
+		out_file_time->dwHighDateTime = (DWORD)(ticks >> 32);
+	}
+
+	timespec ConvertFileTime(const FILETIME* file_time)
+	{
+		timespec time;
+		if (file_time == nullptr)
+		{
+			time.tv_sec = 0;
+			time.tv_nsec = UTIME_OMIT;
+			return time;
+		}
+
+		ULONGLONG ticks = ((ULONGLONG)file_time->dwHighDateTime << 32) | file_time->dwLowDateTime;
+		ticks = ticks > FileTimeUnixEpoch ? ticks - FileTimeUnixEpoch : 0;
+		time.tv_sec = (time_t)(ticks / FileTimeTicksPerSecond);
+		time.tv_nsec = (long)(ticks % FileTimeTicksPerSecond) * 100;
+		return time;
+	}
+
+	int GetDescriptor(HANDLE file)
+	{
+		PosixFileHandle* handle = dynamic_cast<PosixFileHandle*>((PosixHandle*)file);
+		return handle != nullptr ? handle->Descriptor : -1;
+	}
+
+	PosixSyncHandle* GetSyncHandle(HANDLE handle)
+	{
+		if (handle == nullptr || handle == INVALID_HANDLE_VALUE)
+		{
+			return nullptr;
+		}
+		return dynamic_cast<PosixSyncHandle*>((PosixHandle*)handle);
+	}
+
+	bool ReadNextEntry(PosixFindHandle* find_handle, WIN32_FIND_DATA* out_find_data)
+	{
+		dirent* entry = readdir(find_handle->Directory);
+		if (entry == nullptr)
+		{
+			return false;
+		}
+
+		ZeroMemory(out_find_data, sizeof(WIN32_FIND_DATA));
+		snprintf(out_find_data->cFileName, sizeof(out_find_data->cFileName), "%s", entry->d_name);
+
+		struct stat status;
+		std::string path = find_handle->Path + "/" + entry->d_name;
+		if (stat(path.c_str(), &status) == 0 && S_ISDIR(status.st_mode))
+		{
+			out_find_data->dwFileAttributes = FILE_ATTRIBUTE_DIRECTORY;
+		}
+		else
+		{
+			out_find_data->dwFileAttributes = FILE_ATTRIBUTE_NORMAL;
+		}
+		return true;
+	}
+
+	// UTF-8の1文字をデコードし、読み込んだバイト数を返す(不正なバイトは1バイトとして'?'にする)
+	int DecodeUtf8(const unsigned char* text, int length, unsigned int* out_code)
+	{
+		unsigned char lead = text[0];
+		int size = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xe ? 3 : (lead >> 3) == 0x1e ? 4 : 0;
+		if (size == 0 || size > length)
+		{
+			*out_code = '?';
+			return 1;
+		}
+
+		unsigned int code = size == 1 ? lead : lead & (0xff >> (size + 1));
+		for (int i = 1; i < size; i++)
+		{
+			if ((text[i] & 0xc0) != 0x80)
+			{
+				*out_code = '?';
+				return 1;
+			}
+			code = (code << 6) | (text[i] & 0x3f);
+		}
+
+		*out_code = code;
+		return size;
+	}
+
+	int EncodeUtf8(unsigned int code, char* out_text)
+	{
+		if (code < 0x80)
+		{
+			out_text[0] = (char)code;
+			return 1;
+		}
+		if (code < 0x800)
+		{
+			out_text[0] = (char)(0xc0 | (code >> 6));
+			out_text[1] = (char)(0x80 | (code & 0x3f));
+			return 2;
+		}
+		if (code < 0x10000)
+		{
+			out_text[0] = (char)(0xe0 | (code >> 12));
+			out_text[1] = (char)(0x80 | ((code >> 6) & 0x3f));
+			out_text[2] = (char)(0x80 | (code & 0x3f));
+			return 3;
+		}
+		out_text[0] = (char)(0xf0 | (code >> 18));
+		out_text[1] = (char)(0x80 | ((code >> 12) & 0x3f));
+		out_text[2] = (char)(0x80 | ((code >> 6) & 0x3f));
+		out_text[3] = (char)(0x80 | (code & 0x3f));
+		return 4;
+	}
+}
+
+DWORD GetLastError()
+{
+	return g_LastError;
+}
+
+void SetLastError(DWORD error_code)
+{
+	g_LastError = error_code;
+}
+
+BOOL QueryPerformanceCounter(LARGE_INTEGER* counter)
+{
+	timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	counter->QuadPart = (LONGLONG)time.tv_sec * 1000000000LL + time.tv_nsec;
+	return TRUE;
+}
+
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency)
+{
+	frequency->QuadPart = 1000000000LL;
+	return TRUE;
+}
+
+DWORD GetCurrentThreadId()
+{
+	// スレッドごとに一度だけ番号を割り当てる(0は使用しない)
+	static std::atomic<DWORD> next_thread_id(1);
+	thread_local DWORD thread_id = next_thread_id.fetch_add(1);
+	return thread_id;
+}
+
+void Sleep(DWORD milliseconds)
+{
+	if (milliseconds == 0)
+	{
+		std::this_thread::yield();
+		return;
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+void OutputDebugString(LPCSTR text)
+{
+	fputs(text, stderr);
+}
+
+HANDLE CreateFile(LPCSTR file_name, DWORD desired_access, DWORD share_mode, void* security_attributes, DWORD creation_disposition, DWORD flags_and_attributes, HANDLE template_file)
+{
+	int flags = O_CLOEXEC;
+	if ((desired_access & GENERIC_WRITE) != 0)
+	{
+		flags |= (desired_access & GENERIC_READ) != 0 ? O_RDWR : O_WRONLY;
+	}
+	else
+	{
+		flags |= O_RDONLY;
+	}
+
+	switch (creation_disposition)
+	{
+	case CREATE_NEW:
+		flags |= O_CREAT | O_EXCL;
+		break;
+	case CREATE_ALWAYS:
+		flags |= O_CREAT | O_TRUNC;
+		break;
+	case OPEN_ALWAYS:
+		flags |= O_CREAT;
+		break;
+	default:
+		break;
+	}
+
+	int descriptor = open(file_name, flags, 0644);
+	if (descriptor < 0)
+	{
+		SetLastError(ConvertErrno(errno));
+		return INVALID_HANDLE_VALUE;
+	}
+
+	// ディレクトリはFILE_FLAG_BACKUP_SEMANTICSを指定した場合だけ開ける
+	struct stat status;
+	if (fstat(descriptor, &status) == 0 && S_ISDIR(status.st_mode) && (flags_and_attributes & FILE_FLAG_BACKUP_SEMANTICS) == 0)
+	{
+		close(descriptor);
+		SetLastError(ERROR_ACCESS_DENIED);
+		return INVALID_HANDLE_VALUE;
+	}
+
+	PosixFileHandle* handle = new PosixFileHandle();
+	handle->Descriptor = descriptor;
+	return handle;
+}
+
+BOOL CloseHandle(HANDLE handle)
+{
+	if (handle == nullptr || handle == INVALID_HANDLE_VALUE)
+	{
+		SetLastError(ERROR_INVALID_HANDLE);
+		return FALSE;
+	}
+
+	delete (PosixHandle*)handle;
+	return TRUE;
+}
+
+BOOL GetFileSizeEx(HANDLE file, LARGE_INTEGER* out_size)
+{
+	struct stat status;
+	if (fstat(GetDescriptor(file), &status) != 0)
+	{
+		SetLastError(ERROR_INVALID_HANDLE);
+		return FALSE;
+	}
+
+	out_size->QuadPart = status.st_size;
+	return TRUE;
+}
+
+BOOL GetFileTime(HANDLE file, FILETIME* out_creation_time, FILETIME* out_last_access_time, FILETIME* out_last_write_time)
+{
+	struct stat status;
+	if (fstat(GetDescriptor(file), &status) != 0)
+	{
+		SetLastError(ERROR_INVALID_HANDLE);
+		return FALSE;
+	}
+
+	// POSIXには作成日時がないので、状態の変更日時を代わりに使用する
+	if (out_creation_time != nullptr)
+	{
+		ConvertTimespec(status.st_ctim, out_creation_time);
+	}
+	if (out_last_access_time != nullptr)
+	{
+		ConvertTimespec(status.st_atim, out_last_access_time);
+	}
+	if (out_last_write_time != nullptr)
+	{
+		ConvertTimespec(status.st_mtim, out_last_write_time);
+	}
+	return TRUE;
+}
+
+BOOL SetFileTime(HANDLE file, const FILETIME* creation_time, const FILETIME* last_access_time, const FILETIME* last_write_time)
+{
+	timespec times[2] = { ConvertFileTime(last_access_time), ConvertFileTime(last_write_time) };
+	if (futimens(GetDescriptor(file), times) != 0)
+	{
+		SetLastError(ConvertErrno(errno));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+BOOL CreateDirectory(LPCSTR path_name, void* security_attributes)
+{
+	if (mkdir(path_name, 0755) != 0)
+	{
+		SetLastError(ConvertErrno(errno));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+BOOL DeleteFile(LPCSTR file_name)
+{
+	if (unlink(file_name) != 0)
+	{
+		SetLastError(ConvertErrno(errno));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+HANDLE FindFirstFile(LPCSTR file_name, WIN32_FIND_DATA* out_find_data)
+{
+	// "ディレクトリ/*"の形式だけに対応する
+	std::string path = file_name;
+	if (path.size() >= 2 && (path.compare(path.size() - 2, 2, "/*") == 0 || path.compare(path.size() - 2, 2, "\\*") == 0))
+	{
+		path.resize(path.size() - 2);
+	}
+	else
+	{
+		SetLastError(ERROR_NOT_SUPPORTED);
+		return INVALID_HANDLE_VALUE;
+	}
+
+	DIR* directory = opendir(path.c_str());
+	if (directory == nullptr)
+	{
+		SetLastError(ConvertErrno(errno));
+		return INVALID_HANDLE_VALUE;
+	}
+
+	PosixFindHandle* handle = new PosixFindHandle();
+	handle->Directory = directory;
+	handle->Path = path;
+	if (ReadNextEntry(handle, out_find_data) == false)
+	{
+		delete handle;
+		SetLastError(ERROR_FILE_NOT_FOUND);
+		return INVALID_HANDLE_VALUE;
+	}
+	return handle;
+}
+
+BOOL FindNextFile(HANDLE find_file, WIN32_FIND_DATA* out_find_data)
+{
+	PosixFindHandle* handle = dynamic_cast<PosixFindHandle*>((PosixHandle*)find_file);
+	if (handle == nullptr || ReadNextEntry(handle, out_find_data) == false)
+	{
+		SetLastError(ERROR_FILE_NOT_FOUND);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+BOOL FindClose(HANDLE find_file)
+{
+	return CloseHandle(find_file);
+}
+
+HANDLE CreateFileMapping(HANDLE file, void* security_attributes, DWORD protect, DWORD maximum_size_high, DWORD maximum_size_low, LPCSTR name)
+{
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(file, &size) == FALSE)
+	{
+		return nullptr;
+	}
+
+	// Windowsと同じく、空のファイルはマッピングできない
+	if (size.QuadPart == 0)
+	{
+		SetLastError(ERROR_FILE_INVALID);
+		return nullptr;
+	}
+
+	PosixMappingHandle* handle = new PosixMappingHandle();
+	handle->Descriptor = dup(GetDescriptor(file));
+	handle->Size = (size_t)size.QuadPart;
+	return handle;
+}
+
+LPVOID MapViewOfFile(HANDLE file_mapping, DWORD desired_access, DWORD offset_high, DWORD offset_low, SIZE_T size)
+{
+	PosixMappingHandle* handle = dynamic_cast<PosixMappingHandle*>((PosixHandle*)file_mapping);
+	if (handle == nullptr)
+	{
+		SetLastError(ERROR_INVALID_HANDLE);
+		return nullptr;
+	}
+
+	off_t offset = (off_t)(((ULONGLONG)offset_high << 32) | offset_low);
+	size_t map_size = size != 0 ? size : handle->Size - (size_t)offset;
+	void* view = mmap(nullptr, map_size, PROT_READ, MAP_SHARED, handle->Descriptor, offset);
+	if (view == MAP_FAILED)
+	{
+		SetLastError(ConvertErrno(errno));
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> lock(g_ViewMutex);
+	g_ViewSizeList[view] = map_size;
+	return view;
+}
+
+BOOL UnmapViewOfFile(const void* base_address)
+{
+	size_t size = 0;
+	{
+		std::lock_guard<std::mutex> lock(g_ViewMutex);
+		auto view = g_ViewSizeList.find(base_address);
+		if (view == g_ViewSizeList.end())
+		{
+			SetLastError(ERROR_INVALID_PARAMETER);
+			return FALSE;
+		}
+		size = view->second;
+		g_ViewSizeList.erase(view);
+	}
+
+	munmap((void*)base_address, size);
+	return TRUE;
+}
+
+HANDLE CreateEvent(void* security_attributes, BOOL is_manual_reset, BOOL is_initial_state, LPCSTR name)
+{
+	PosixSyncHandle* handle = new PosixSyncHandle();
+	handle->Count = is_initial_state != FALSE ? 1 : 0;
+	handle->MaxCount = 1;
+	handle->IsManualReset = is_manual_reset != FALSE;
+	return handle;
+}
+
+BOOL SetEvent(HANDLE event)
+{
+	PosixSyncHandle* handle = GetSyncHandle(event);
+	if (handle == nullptr)
+	{
+		SetLastError(ERROR_INVALID_HANDLE);
+		return FALSE;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(handle->Mutex);
+		handle->Count = 1;
+	}
+	handle->Condition.notify_all();
+	return TRUE;
+}
+
+BOOL ResetEvent(HANDLE event)
+{
+	PosixSyncHandle* handle = GetSyncHandle(event);
+	if (handle == nullptr)
+	{
+		SetLastError(ERROR_INVALID_HANDLE);
+		return FALSE;
+	}
+
+	std::lock_guard<std::mutex> lock(handle->Mutex);
+	handle->Count = 0;
+	return TRUE;
+}
+
+HANDLE CreateSemaphore(void* security_attributes, LONG initial_count, LONG maximum_count, LPCSTR name)
+{
+	if (maximum_count <= 0 || initial_count < 0 || initial_count > maximum_count)
+	{
+		SetLastError(ERROR_INVALID_PARAMETER);
+		return nullptr;
+	}
+
+	PosixSyncHandle* handle = new PosixSyncHandle();
+	handle->Count = initial_count;
+	handle->MaxCount = maximum_count;
+	return handle;
+}
+
+BOOL ReleaseSemaphore(HANDLE semaphore, LONG release_count, LONG* out_previous_count)
+{
+	PosixSyncHandle* handle = GetSyncHandle(semaphore);
+	if (handle == nullptr || release_count <= 0)
+	{
+		SetLastError(ERROR_INVALID_PARAMETER);
+		return FALSE;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(handle->Mutex);
+		if (handle->Count + release_count > handle->MaxCount)
+		{
+			SetLastError(ERROR_INVALID_PARAMETER);
+			return FALSE;
+		}
+		if (out_previous_count != nullptr)
+		{
+			*out_previous_count = handle->Count;
+		}
+		handle->Count += release_count;
+	}
+	handle->Condition.notify_all();
+	return TRUE;
+}
+
+DWORD WaitForSingleObject(HANDLE handle, DWORD milliseconds)
+{
+	PosixSyncHandle* sync_handle = GetSyncHandle(handle);
+	if (sync_handle == nullptr)
+	{
+		SetLastError(ERROR_INVALID_HANDLE);
+		return WAIT_FAILED;
+	}
+
+	std::unique_lock<std::mutex> lock(sync_handle->Mutex);
+	auto is_signaled = [sync_handle]() { return sync_handle->Count > 0; };
+	if (milliseconds == INFINITE)
+	{
+		sync_handle->Condition.wait(lock, is_signaled);
+	}
+	else if (sync_handle->Condition.wait_for(lock, std::chrono::milliseconds(milliseconds), is_signaled) == false)
+	{
+		return WAIT_TIMEOUT;
+	}
+
+	sync_handle->TryAcquire();
+	return WAIT_OBJECT_0;
+}
+
+int MultiByteToWideChar(UINT code_page, DWORD flags, LPCSTR multi_byte_str, int multi_byte_length, WCHAR* out_wide_str, int wide_length)
+{
+	const unsigned char* text = (const unsigned char*)multi_byte_str;
+	int length = multi_byte_length >= 0 ? multi_byte_length : (int)strlen(multi_byte_str) + 1;
+
+	// Windowsと同じく、出力先のサイズが0の場合は必要な文字数だけを返す
+	int count = 0;
+	for (int i = 0; i < length;)
+	{
+		unsigned int code = 0;
+		i += DecodeUtf8(text + i, length - i, &code);
+		if (wide_length > 0)
+		{
+			if (count >= wide_length)
+			{
+				SetLastError(ERROR_INVALID_PARAMETER);
+				return 0;
+			}
+			out_wide_str[count] = (WCHAR)code;
+		}
+		count++;
+	}
+	return count;
+}
+
+int WideCharToMultiByte(UINT code_page, DWORD flags, const WCHAR* wide_str, int wide_length, LPSTR out_multi_byte_str, int multi_byte_length, LPCSTR default_char, BOOL* out_is_used_default_char)
+{
+	int length = wide_length >= 0 ? wide_length : (int)wcslen(wide_str) + 1;
+
+	int count = 0;
+	for (int i = 0; i < length; i++)
+	{
+		char encoded[4];
+		int size = EncodeUtf8((unsigned int)wide_str[i], encoded);
+		if (multi_byte_length > 0)
+		{
+			if (count + size > multi_byte_length)
+			{
+				SetLastError(ERROR_INVALID_PARAMETER);
+				return 0;
+			}
+			memcpy(out_multi_byte_str + count, encoded, size);
+		}
+		count += size;
+	}
+
+	if (out_is_used_default_char != nullptr)
+	{
+		*out_is_used_default_char = FALSE;
+	}
+	return count;
+}
+
+HMODULE GetModuleHandle(LPCSTR module_name)
+{
+	return nullptr;
+}
+
+HICON LoadIcon(HINSTANCE instance, LPCSTR icon_name)
+{
+	return nullptr;
+}
+
+HCURSOR LoadCursor(HINSTANCE instance, LPCSTR cursor_name)
+{
+	return nullptr;
+}
+
+ATOM RegisterClassEx(const WNDCLASSEX* window_class)
+{
+	SetLastError(ERROR_NOT_SUPPORTED);
+	return 0;
+}
+
+HWND CreateWindow(LPCSTR class_name, LPCSTR window_name, DWORD style, int x, int y, int width, int height, HWND parent, HMENU menu, HINSTANCE instance, LPVOID param)
+{
+	SetLastError(ERROR_NOT_SUPPORTED);
+	return nullptr;
+}
+
+HWND FindWindow(LPCSTR class_name, LPCSTR window_name)
+{
+	return nullptr;
+}
+
+HWND GetDesktopWindow()
+{
+	// ウィンドウを必要としないNULLREFデバイスの作成に渡すだけなので、ダミーの値を返す
+	static int desktop_window = 0;
+	return &desktop_window;
+}
+
+BOOL GetWindowRect(HWND window, RECT* out_rect)
+{
+	ZeroMemory(out_rect, sizeof(RECT));
+	return FALSE;
+}
+
+BOOL GetClientRect(HWND window, RECT* out_rect)
+{
+	ZeroMemory(out_rect, sizeof(RECT));
+	return FALSE;
+}
+
+BOOL SetWindowPos(HWND window, HWND insert_after, int x, int y, int width, int height, UINT flags)
+{
+	return FALSE;
+}
+
+BOOL ShowWindow(HWND window, int command)
+{
+	return FALSE;
+}
+
+BOOL UpdateWindow(HWND window)
+{
+	return FALSE;
+}
+
+BOOL PeekMessage(MSG* out_message, HWND window, UINT filter_min, UINT filter_max, UINT remove_message)
+{
+	return FALSE;
+}
+
+BOOL TranslateMessage(const MSG* message)
+{
+	return FALSE;
+}
+
+LRESULT DispatchMessage(const MSG* message)
+{
+	return 0;
+}
+
+void PostQuitMessage(int exit_code)
+{
+}
+
+BOOL PostMessage(HWND window, UINT message, WPARAM wparam, LPARAM lparam)
+{
+	return FALSE;
+}
+
+LRESULT DefWindowProc(HWND window, UINT message, WPARAM wparam, LPARAM lparam)
+{
+	return 0;
+}
+
+BOOL GetCursorPos(POINT* out_point)
+{
+	out_point->x = 0;
+	out_point->y = 0;
+	return FALSE;
+}
+
+BOOL ScreenToClient(HWND window, POINT* point)
+{
+	return FALSE;
+}
+
+HDC CreateCompatibleDC(HDC device_context)
+{
+	return new PosixDeviceContext();
+}
+
+BOOL DeleteDC(HDC device_context)
+{
+	delete (PosixDeviceContext*)device_context;
+	return TRUE;
+}
+
+HFONT CreateFont(int height, int width, int escapement, int orientation, int weight, DWORD is_italic, DWORD is_underline, DWORD is_strike_out, DWORD char_set, DWORD out_precision, DWORD clip_precision, DWORD quality, DWORD pitch_and_family, LPCSTR face_name)
+{
+	PosixFont* font = new PosixFont();
+	font->Height = (std::max)(height < 0 ? -height : height, GdiGlyphMargin * 2 + 1);
+	font->Width = width > 0 ? width : font->Height / 2;
+	return font;
+}
+
+HGDIOBJ SelectObject(HDC device_context, HGDIOBJ object)
+{
+	PosixDeviceContext* context = (PosixDeviceContext*)device_context;
+	PosixFont* previous_font = context->Font;
+	context->Font = (PosixFont*)object;
+	return previous_font;
+}
+
+BOOL DeleteObject(HGDIOBJ object)
+{
+	delete (PosixFont*)object;
+	return TRUE;
+}
+
+BOOL GetTextMetrics(HDC device_context, TEXTMETRIC* out_metric)
+{
+	PosixDeviceContext* context = (PosixDeviceContext*)device_context;
+	if (context == nullptr || context->Font == nullptr)
+	{
+		return FALSE;
+	}
+
+	ZeroMemory(out_metric, sizeof(TEXTMETRIC));
+	out_metric->tmHeight = context->Font->Height;
+	out_metric->tmAscent = context->Font->Height * 4 / 5;
+	out_metric->tmDescent = out_metric->tmHeight - out_metric->tmAscent;
+	out_metric->tmAveCharWidth = context->Font->Width;
+	out_metric->tmMaxCharWidth = context->Font->Width * 2;
+	return TRUE;
+}
+
+DWORD GetGlyphOutlineW(HDC device_context, UINT code, UINT format, GLYPHMETRICS* out_metrics, DWORD buffer_size, LPVOID out_buffer, const MAT2* matrix)
+{
+	PosixDeviceContext* context = (PosixDeviceContext*)device_context;
+	if (context == nullptr || context->Font == nullptr || format != GGO_GRAY8_BITMAP)
+	{
+		return GDI_ERROR;
+	}
+
+	// 全角の文字は半角の2倍の幅にする
+	const PosixFont* font = context->Font;
+	LONG advance = code < 0x80 ? font->Width : font->Width * 2;
+	LONG ascent = font->Height * 4 / 5;
+
+	ZeroMemory(out_metrics, sizeof(GLYPHMETRICS));
+	out_metrics->gmCellIncX = (short)advance;
+
+	// 空白文字はGDIと同じくピクセルを持たない
+	if (code == ' ' || code == 0x3000)
+	{
+		out_metrics->gmBlackBoxX = 1;
+		out_metrics->gmBlackBoxY = 1;
+		return 0;
+	}
+
+	// 文字の形の代わりに、余白を除いたセル全体を塗りつぶした箱を返す
+	UINT width = (UINT)(std::max)(advance - GdiGlyphMargin * 2, 1);
+	UINT height = (UINT)(std::max)(ascent - GdiGlyphMargin, 1);
+	UINT pitch = (width + 3) & ~3;
+	DWORD required_size = pitch * height;
+
+	out_metrics->gmBlackBoxX = width;
+	out_metrics->gmBlackBoxY = height;
+	out_metrics->gmptGlyphOrigin.x = GdiGlyphMargin;
+	out_metrics->gmptGlyphOrigin.y = ascent;
+
+	if (buffer_size == 0 || out_buffer == nullptr)
+	{
+		return required_size;
+	}
+	if (buffer_size < required_size)
+	{
+		return GDI_ERROR;
+	}
+
+	// GGO_GRAY8_BITMAPの階調は0～64
+	BYTE* pixels = (BYTE*)out_buffer;
+	ZeroMemory(pixels, required_size);
+	for (UINT y = 0; y < height; y++)
+	{
+		memset(pixels + y * pitch, 64, width);
+	}
+	return required_size;
+}
+
+HMMIO mmioOpen(LPSTR file_name, MMIOINFO* mmio_info, DWORD open_flags)
+{
+	return nullptr;
+}
+
+UINT mmioClose(HMMIO mmio, UINT flags)
+{
+	return MMSYSERR_NOERROR;
+}
+
+UINT mmioDescend(HMMIO mmio, MMCKINFO* chunk_info, const MMCKINFO* parent_chunk_info, UINT flags)
+{
+	return 1;
+}
+
+UINT mmioAscend(HMMIO mmio, MMCKINFO* chunk_info, UINT flags)
+{
+	return 1;
+}
+
+LONG mmioRead(HMMIO mmio, HPSTR buffer, LONG size)
+{
+	return -1;
+}
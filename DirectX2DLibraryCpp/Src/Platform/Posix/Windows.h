@@ -0,0 +1,424 @@
+﻿/**
+* @file Windows.h
+* @brief <pre>
+* Windows以外でエンジンとツールをビルドするためのWin32 APIの代替の宣言
+* エンジンが使用している型、定数、関数だけを宣言し、Win32Posix.cppでPOSIXの機能を使用して実装する
+* ファイル、ファイルマッピング、イベントとセマフォ、時間計測、文字コード変換は同じ動作をする
+* ウィンドウの作成は常に失敗するので、Engine::Initializeは使用できない(Graphicsを単体で初期化して使用する)
+* GDIはフォントの高さから箱型のグリフを作成するだけなので、文字の形は描画されない
+* </pre>
+*/
+#ifndef POSIX_WINDOWS_H_
+#define POSIX_WINDOWS_H_
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 基本の型(WindowsのLONGとDWORDは32ビットなので、longではなくintを使用する)
+typedef int BOOL;
+typedef unsigned char BYTE;
+typedef unsigned char UCHAR;
+typedef unsigned short WORD;
+typedef unsigned int DWORD;
+typedef int INT;
+typedef unsigned int UINT;
+typedef int LONG;
+typedef unsigned int ULONG;
+typedef long long LONGLONG;
+typedef unsigned long long ULONGLONG;
+typedef size_t SIZE_T;
+typedef int HRESULT;
+typedef char CHAR;
+typedef wchar_t WCHAR;
+typedef char* LPSTR;
+typedef const char* LPCSTR;
+typedef char* HPSTR;
+typedef void* LPVOID;
+typedef uintptr_t WPARAM;
+typedef intptr_t LPARAM;
+typedef intptr_t LRESULT;
+typedef unsigned short ATOM;
+
+typedef void* HANDLE;
+typedef void* HWND;
+typedef void* HINSTANCE;
+typedef void* HMODULE;
+typedef void* HICON;
+typedef void* HCURSOR;
+typedef void* HBRUSH;
+typedef void* HMENU;
+typedef void* HDC;
+typedef void* HFONT;
+typedef void* HGDIOBJ;
+
+#define TRUE 1
+#define FALSE 0
+#define CALLBACK
+#define WINAPI
+#define TEXT(text) text
+#define MAX_PATH 260
+#define INFINITE 0xffffffff
+#define INVALID_HANDLE_VALUE ((HANDLE)(intptr_t)-1)
+#define ZeroMemory(destination, length) memset((destination), 0, (length))
+
+#define S_OK ((HRESULT)0)
+#define E_FAIL ((HRESULT)0x80004005)
+#define E_NOTIMPL ((HRESULT)0x80004001)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+
+#define ERROR_FILE_NOT_FOUND 2
+#define ERROR_ACCESS_DENIED 5
+#define ERROR_INVALID_HANDLE 6
+#define ERROR_NOT_SUPPORTED 50
+#define ERROR_FILE_EXISTS 80
+#define ERROR_INVALID_PARAMETER 87
+#define ERROR_ALREADY_EXISTS 183
+#define ERROR_FILE_INVALID 1006
+
+/** @brief 64ビット整数 */
+typedef union _LARGE_INTEGER
+{
+	struct
+	{
+		DWORD LowPart;
+		LONG HighPart;
+	};
+	LONGLONG QuadPart;
+} LARGE_INTEGER;
+
+/** @brief 1601年1月1日からの100ナノ秒単位の時刻 */
+typedef struct _FILETIME
+{
+	DWORD dwLowDateTime;
+	DWORD dwHighDateTime;
+} FILETIME;
+
+/** @brief 矩形 */
+typedef struct tagRECT
+{
+	LONG left;
+	LONG top;
+	LONG right;
+	LONG bottom;
+} RECT;
+
+/** @brief 座標 */
+typedef struct tagPOINT
+{
+	LONG x;
+	LONG y;
+} POINT;
+
+/** @brief COMのインターフェースの識別子 */
+typedef struct _GUID
+{
+	DWORD Data1;
+	WORD Data2;
+	WORD Data3;
+	BYTE Data4[8];
+} GUID;
+typedef const GUID& REFGUID;
+typedef const GUID& REFIID;
+
+/** @brief COMの参照カウントのインターフェース */
+struct IUnknown
+{
+	virtual ULONG AddRef() = 0;
+	virtual ULONG Release() = 0;
+
+protected:
+	virtual ~IUnknown() {}
+};
+
+// エラー
+DWORD GetLastError();
+void SetLastError(DWORD error_code);
+
+// 時間計測とスレッド
+BOOL QueryPerformanceCounter(LARGE_INTEGER* counter);
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency);
+DWORD GetCurrentThreadId();
+void Sleep(DWORD milliseconds);
+void OutputDebugString(LPCSTR text);
+
+// ファイル
+#define GENERIC_READ 0x80000000
+#define GENERIC_WRITE 0x40000000
+#define FILE_WRITE_ATTRIBUTES 0x0100
+#define FILE_SHARE_READ 0x00000001
+#define FILE_SHARE_WRITE 0x00000002
+#define FILE_SHARE_DELETE 0x00000004
+#define CREATE_NEW 1
+#define CREATE_ALWAYS 2
+#define OPEN_EXISTING 3
+#define OPEN_ALWAYS 4
+#define FILE_ATTRIBUTE_DIRECTORY 0x00000010
+#define FILE_ATTRIBUTE_NORMAL 0x00000080
+#define FILE_FLAG_BACKUP_SEMANTICS 0x02000000
+
+HANDLE CreateFile(LPCSTR file_name, DWORD desired_access, DWORD share_mode, void* security_attributes, DWORD creation_disposition, DWORD flags_and_attributes, HANDLE template_file);
+BOOL CloseHandle(HANDLE handle);
+BOOL GetFileSizeEx(HANDLE file, LARGE_INTEGER* out_size);
+BOOL GetFileTime(HANDLE file, FILETIME* out_creation_time, FILETIME* out_last_access_time, FILETIME* out_last_write_time);
+BOOL SetFileTime(HANDLE file, const FILETIME* creation_time, const FILETIME* last_access_time, const FILETIME* last_write_time);
+BOOL CreateDirectory(LPCSTR path_name, void* security_attributes);
+BOOL DeleteFile(LPCSTR file_name);
+
+/** @brief FindFirstFileで取得するファイルの情報 */
+typedef struct _WIN32_FIND_DATA
+{
+	DWORD dwFileAttributes;
+	CHAR cFileName[MAX_PATH];
+} WIN32_FIND_DATA;
+
+HANDLE FindFirstFile(LPCSTR file_name, WIN32_FIND_DATA* out_find_data);
+BOOL FindNextFile(HANDLE find_file, WIN32_FIND_DATA* out_find_data);
+BOOL FindClose(HANDLE find_file);
+
+// ファイルマッピング
+#define PAGE_READONLY 0x02
+#define FILE_MAP_READ 0x0004
+
+HANDLE CreateFileMapping(HANDLE file, void* security_attributes, DWORD protect, DWORD maximum_size_high, DWORD maximum_size_low, LPCSTR name);
+LPVOID MapViewOfFile(HANDLE file_mapping, DWORD desired_access, DWORD offset_high, DWORD offset_low, SIZE_T size);
+BOOL UnmapViewOfFile(const void* base_address);
+
+// 同期オブジェクト
+#define WAIT_OBJECT_0 0x00000000
+#define WAIT_TIMEOUT 0x00000102
+#define WAIT_FAILED 0xffffffff
+
+HANDLE CreateEvent(void* security_attributes, BOOL is_manual_reset, BOOL is_initial_state, LPCSTR name);
+BOOL SetEvent(HANDLE event);
+BOOL ResetEvent(HANDLE event);
+HANDLE CreateSemaphore(void* security_attributes, LONG initial_count, LONG maximum_count, LPCSTR name);
+BOOL ReleaseSemaphore(HANDLE semaphore, LONG release_count, LONG* out_previous_count);
+DWORD WaitForSingleObject(HANDLE handle, DWORD milliseconds);
+
+// 文字コード変換(CP_ACPはUTF-8として扱う)
+#define CP_ACP 0
+#define CP_UTF8 65001
+
+int MultiByteToWideChar(UINT code_page, DWORD flags, LPCSTR multi_byte_str, int multi_byte_length, WCHAR* out_wide_str, int wide_length);
+int WideCharToMultiByte(UINT code_page, DWORD flags, const WCHAR* wide_str, int wide_length, LPSTR out_multi_byte_str, int multi_byte_length, LPCSTR default_char, BOOL* out_is_used_default_char);
+
+// ウィンドウ(作成は常に失敗する)
+#define CS_VREDRAW 0x0001
+#define CS_HREDRAW 0x0002
+#define WS_OVERLAPPEDWINDOW 0x00cf0000
+#define WS_THICKFRAME 0x00040000
+#define WS_VISIBLE 0x10000000
+#define CW_USEDEFAULT ((int)0x80000000)
+#define SW_SHOW 5
+#define SWP_NOMOVE 0x0002
+#define PM_REMOVE 0x0001
+#define WM_CLOSE 0x0010
+#define WM_QUIT 0x0012
+#define WM_KEYDOWN 0x0100
+#define VK_ESCAPE 0x1b
+#define IDI_APPLICATION ((LPCSTR)32512)
+#define IDC_ARROW ((LPCSTR)32512)
+
+typedef LRESULT (CALLBACK* WNDPROC)(HWND, UINT, WPARAM, LPARAM);
+
+/** @brief ウィンドウクラスの情報 */
+typedef struct tagWNDCLASSEX
+{
+	UINT cbSize;
+	UINT style;
+	WNDPROC lpfnWndProc;
+	int cbClsExtra;
+	int cbWndExtra;
+	HINSTANCE hInstance;
+	HICON hIcon;
+	HCURSOR hCursor;
+	HBRUSH hbrBackground;
+	LPCSTR lpszMenuName;
+	LPCSTR lpszClassName;
+	HICON hIconSm;
+} WNDCLASSEX;
+
+/** @brief ウィンドウメッセージ */
+typedef struct tagMSG
+{
+	HWND hwnd;
+	UINT message;
+	WPARAM wParam;
+	LPARAM lParam;
+	DWORD time;
+	POINT pt;
+} MSG;
+
+HMODULE GetModuleHandle(LPCSTR module_name);
+HICON LoadIcon(HINSTANCE instance, LPCSTR icon_name);
+HCURSOR LoadCursor(HINSTANCE instance, LPCSTR cursor_name);
+ATOM RegisterClassEx(const WNDCLASSEX* window_class);
+HWND CreateWindow(LPCSTR class_name, LPCSTR window_name, DWORD style, int x, int y, int width, int height, HWND parent, HMENU menu, HINSTANCE instance, LPVOID param);
+HWND FindWindow(LPCSTR class_name, LPCSTR window_name);
+#define FindWindowA FindWindow
+HWND GetDesktopWindow();
+BOOL GetWindowRect(HWND window, RECT* out_rect);
+BOOL GetClientRect(HWND window, RECT* out_rect);
+BOOL SetWindowPos(HWND window, HWND insert_after, int x, int y, int width, int height, UINT flags);
+BOOL ShowWindow(HWND window, int command);
+BOOL UpdateWindow(HWND window);
+BOOL PeekMessage(MSG* out_message, HWND window, UINT filter_min, UINT filter_max, UINT remove_message);
+BOOL TranslateMessage(const MSG* message);
+LRESULT DispatchMessage(const MSG* message);
+void PostQuitMessage(int exit_code);
+BOOL PostMessage(HWND window, UINT message, WPARAM wparam, LPARAM lparam);
+LRESULT DefWindowProc(HWND window, UINT message, WPARAM wparam, LPARAM lparam);
+BOOL GetCursorPos(POINT* out_point);
+BOOL ScreenToClient(HWND window, POINT* point);
+
+// GDI(フォントの高さから箱型のグリフを作成する)
+#define FW_REGULAR 400
+#define DEFAULT_CHARSET 1
+#define OUT_TT_ONLY_PRECIS 7
+#define CLIP_DEFAULT_PRECIS 0
+#define ANTIALIASED_QUALITY 4
+#define FIXED_PITCH 1
+#define FF_SCRIPT 0x40
+#define GGO_GRAY8_BITMAP 6
+#define GDI_ERROR 0xffffffff
+
+/** @brief フォントの寸法 */
+typedef struct tagTEXTMETRIC
+{
+	LONG tmHeight;
+	LONG tmAscent;
+	LONG tmDescent;
+	LONG tmInternalLeading;
+	LONG tmExternalLeading;
+	LONG tmAveCharWidth;
+	LONG tmMaxCharWidth;
+} TEXTMETRIC;
+
+/** @brief グリフの寸法 */
+typedef struct _GLYPHMETRICS
+{
+	UINT gmBlackBoxX;
+	UINT gmBlackBoxY;
+	POINT gmptGlyphOrigin;
+	short gmCellIncX;
+	short gmCellIncY;
+} GLYPHMETRICS;
+
+/** @brief 固定小数点数 */
+typedef struct _FIXED
+{
+	WORD fract;
+	short value;
+} FIXED;
+
+/** @brief グリフの変換行列 */
+typedef struct _MAT2
+{
+	FIXED eM11;
+	FIXED eM12;
+	FIXED eM21;
+	FIXED eM22;
+} MAT2;
+
+HDC CreateCompatibleDC(HDC device_context);
+BOOL DeleteDC(HDC device_context);
+HFONT CreateFont(int height, int width, int escapement, int orientation, int weight, DWORD is_italic, DWORD is_underline, DWORD is_strike_out, DWORD char_set, DWORD out_precision, DWORD clip_precision, DWORD quality, DWORD pitch_and_family, LPCSTR face_name);
+HGDIOBJ SelectObject(HDC device_context, HGDIOBJ object);
+BOOL DeleteObject(HGDIOBJ object);
+BOOL GetTextMetrics(HDC device_context, TEXTMETRIC* out_metric);
+DWORD GetGlyphOutlineW(HDC device_context, UINT code, UINT format, GLYPHMETRICS* out_metrics, DWORD buffer_size, LPVOID out_buffer, const MAT2* matrix);
+
+// マルチメディアAPI(Wavファイルの読み込みはdsound.hと同じく常に失敗する)
+typedef void* HMMIO;
+typedef DWORD FOURCC;
+
+/** @brief RIFFチャンクの情報 */
+typedef struct _MMCKINFO
+{
+	FOURCC ckid;
+	DWORD cksize;
+	FOURCC fccType;
+	DWORD dwDataOffset;
+	DWORD dwFlags;
+} MMCKINFO;
+
+/** @brief mmioOpenの情報 */
+typedef struct _MMIOINFO
+{
+	DWORD dwFlags;
+	FOURCC fccIOProc;
+	void* pIOProc;
+	UINT wErrorRet;
+	void* htask;
+	LONG cchBuffer;
+	HPSTR pchBuffer;
+	HPSTR pchNext;
+	HPSTR pchEndRead;
+	HPSTR pchEndWrite;
+	LONG lBufOffset;
+	LONG lDiskOffset;
+	DWORD adwInfo[3];
+	DWORD dwReserved1;
+	DWORD dwReserved2;
+	HMMIO hmmio;
+} MMIOINFO;
+
+#define mmioFOURCC(ch0, ch1, ch2, ch3) \
+	((DWORD)(BYTE)(ch0) | ((DWORD)(BYTE)(ch1) << 8) | ((DWORD)(BYTE)(ch2) << 16) | ((DWORD)(BYTE)(ch3) << 24))
+#define FOURCC_MEM mmioFOURCC('M', 'E', 'M', ' ')
+#define MMSYSERR_NOERROR 0
+#define MMIO_READ 0x00000000
+#define MMIO_FHOPEN 0x0010
+#define MMIO_FINDCHUNK 0x0010
+#define MMIO_FINDRIFF 0x0020
+
+HMMIO mmioOpen(LPSTR file_name, MMIOINFO* mmio_info, DWORD open_flags);
+UINT mmioClose(HMMIO mmio, UINT flags);
+UINT mmioDescend(HMMIO mmio, MMCKINFO* chunk_info, const MMCKINFO* parent_chunk_info, UINT flags);
+UINT mmioAscend(HMMIO mmio, MMCKINFO* chunk_info, UINT flags);
+LONG mmioRead(HMMIO mmio, HPSTR buffer, LONG size);
+
+// Visual C++のランタイムの関数
+#define _countof(array) (sizeof(array) / sizeof((array)[0]))
+
+/** @brief fopenの代替 */
+inline int fopen_s(FILE** out_file, const char* file_name, const char* mode)
+{
+	*out_file = fopen(file_name, mode);
+	return *out_file != nullptr ? 0 : 1;
+}
+
+/** @brief snprintfの代替(Visual C++と同じく、収まらない場合は-1を返す) */
+inline int sprintf_s(char* buffer, size_t buffer_size, const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	int length = vsnprintf(buffer, buffer_size, format, args);
+	va_end(args);
+
+	return length >= 0 && (size_t)length < buffer_size ? length : -1;
+}
+
+/** @brief アライメントを指定した確保関数 */
+inline void* _aligned_malloc(size_t size, size_t alignment)
+{
+	void* memory = nullptr;
+	if (posix_memalign(&memory, alignment < sizeof(void*) ? sizeof(void*) : alignment, size) != 0)
+	{
+		return nullptr;
+	}
+	return memory;
+}
+
+/** @brief _aligned_mallocで確保したメモリの解放関数 */
+inline void _aligned_free(void* memory)
+{
+	free(memory);
+}
+
+#endif
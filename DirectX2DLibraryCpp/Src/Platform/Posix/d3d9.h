@@ -0,0 +1,214 @@
+﻿/**
+* @file d3d9.h
+* @brief <pre>
+* Windows以外でビルドするためのDirect3D9の代替の宣言
+* エンジンが使用しているインターフェースと定数だけを宣言し、D3D9Posix.cppで実装する
+* 作成できるデバイスはNULLREFデバイスだけで、テクスチャとサーフェスはシステムメモリに確保する
+* 描画命令は何もしないので、描画結果はSoftware描画バックエンドで確認する
+* </pre>
+*/
+#ifndef POSIX_D3D9_H_
+#define POSIX_D3D9_H_
+
+#include <Windows.h>
+
+#ifndef D3DCOLOR_DEFINED
+typedef DWORD D3DCOLOR;
+#define D3DCOLOR_DEFINED
+#endif
+
+// DirectX SDKのd3d9types.hと同じ定義(RenderTypes.hと同じ字句なので再定義の警告にならない)
+#define D3DCOLOR_ARGB(a,r,g,b) \
+	((D3DCOLOR)((((a)&0xff)<<24)|(((r)&0xff)<<16)|(((g)&0xff)<<8)|((b)&0xff)))
+#define D3DCOLOR_RGBA(r,g,b,a) D3DCOLOR_ARGB(a,r,g,b)
+#define D3DCOLOR_XRGB(r,g,b)   D3DCOLOR_ARGB(0xff,r,g,b)
+
+#define D3D_SDK_VERSION 32
+#define D3D_OK S_OK
+#define D3DERR_INVALIDCALL ((HRESULT)0x8876086c)
+#define D3DERR_NOTAVAILABLE ((HRESULT)0x8876086a)
+#define D3DADAPTER_DEFAULT 0
+
+#define D3DCREATE_MULTITHREADED 0x00000004
+#define D3DCREATE_SOFTWARE_VERTEXPROCESSING 0x00000020
+#define D3DCREATE_HARDWARE_VERTEXPROCESSING 0x00000040
+
+#define D3DCLEAR_TARGET 0x00000001
+#define D3DLOCK_READONLY 0x00000010
+
+#define D3DFVF_XYZRHW 0x004
+#define D3DFVF_DIFFUSE 0x040
+#define D3DFVF_TEX1 0x100
+
+#define D3DTA_DIFFUSE 0x00000000
+#define D3DTA_TEXTURE 0x00000002
+
+enum D3DFORMAT
+{
+	D3DFMT_UNKNOWN = 0,
+	D3DFMT_A8R8G8B8 = 21,
+	D3DFMT_X8R8G8B8 = 22,
+};
+
+enum D3DPOOL
+{
+	D3DPOOL_DEFAULT = 0,
+	D3DPOOL_MANAGED = 1,
+	D3DPOOL_SYSTEMMEM = 2,
+	D3DPOOL_SCRATCH = 3,
+};
+
+enum D3DDEVTYPE
+{
+	D3DDEVTYPE_HAL = 1,
+	D3DDEVTYPE_REF = 2,
+	D3DDEVTYPE_SW = 3,
+	D3DDEVTYPE_NULLREF = 4,
+};
+
+enum D3DSWAPEFFECT
+{
+	D3DSWAPEFFECT_DISCARD = 1,
+};
+
+enum D3DPRIMITIVETYPE
+{
+	D3DPT_TRIANGLELIST = 4,
+};
+
+enum D3DRENDERSTATETYPE
+{
+	D3DRS_CULLMODE = 22,
+	D3DRS_SRCBLEND = 19,
+	D3DRS_DESTBLEND = 20,
+	D3DRS_ALPHABLENDENABLE = 27,
+};
+
+enum D3DCULL
+{
+	D3DCULL_NONE = 1,
+	D3DCULL_CW = 2,
+	D3DCULL_CCW = 3,
+};
+
+enum D3DBLEND
+{
+	D3DBLEND_SRCALPHA = 5,
+	D3DBLEND_INVSRCALPHA = 6,
+};
+
+enum D3DTEXTURESTAGESTATETYPE
+{
+	D3DTSS_COLOROP = 1,
+	D3DTSS_COLORARG1 = 2,
+	D3DTSS_COLORARG2 = 3,
+	D3DTSS_ALPHAOP = 4,
+};
+
+enum D3DTEXTUREOP
+{
+	D3DTOP_MODULATE = 4,
+};
+
+enum D3DSAMPLERSTATETYPE
+{
+	D3DSAMP_MAGFILTER = 5,
+	D3DSAMP_MINFILTER = 6,
+	D3DSAMP_MIPFILTER = 7,
+};
+
+enum D3DTEXTUREFILTERTYPE
+{
+	D3DTEXF_NONE = 0,
+	D3DTEXF_POINT = 1,
+	D3DTEXF_LINEAR = 2,
+};
+
+/** @brief デバイスの作成パラメータ */
+typedef struct _D3DPRESENT_PARAMETERS_
+{
+	UINT BackBufferWidth;
+	UINT BackBufferHeight;
+	D3DFORMAT BackBufferFormat;
+	UINT BackBufferCount;
+	D3DSWAPEFFECT SwapEffect;
+	HWND hDeviceWindow;
+	BOOL Windowed;
+} D3DPRESENT_PARAMETERS;
+
+/** @brief ビューポート */
+typedef struct _D3DVIEWPORT9
+{
+	DWORD X;
+	DWORD Y;
+	DWORD Width;
+	DWORD Height;
+	float MinZ;
+	float MaxZ;
+} D3DVIEWPORT9;
+
+/** @brief サーフェスの情報 */
+typedef struct _D3DSURFACE_DESC
+{
+	D3DFORMAT Format;
+	D3DPOOL Pool;
+	UINT Width;
+	UINT Height;
+} D3DSURFACE_DESC;
+
+/** @brief ロックした領域 */
+typedef struct _D3DLOCKED_RECT
+{
+	INT Pitch;
+	void* pBits;
+} D3DLOCKED_RECT;
+
+/** @brief サーフェス */
+struct IDirect3DSurface9 : public IUnknown
+{
+	virtual HRESULT GetDesc(D3DSURFACE_DESC* out_desc) = 0;
+	virtual HRESULT LockRect(D3DLOCKED_RECT* out_locked_rect, const RECT* rect, DWORD flags) = 0;
+	virtual HRESULT UnlockRect() = 0;
+};
+typedef IDirect3DSurface9* LPDIRECT3DSURFACE9;
+
+/** @brief テクスチャ */
+struct IDirect3DTexture9 : public IUnknown
+{
+	virtual DWORD GetLevelCount() = 0;
+	virtual HRESULT GetLevelDesc(UINT level, D3DSURFACE_DESC* out_desc) = 0;
+	virtual HRESULT LockRect(UINT level, D3DLOCKED_RECT* out_locked_rect, const RECT* rect, DWORD flags) = 0;
+	virtual HRESULT UnlockRect(UINT level) = 0;
+};
+typedef IDirect3DTexture9* LPDIRECT3DTEXTURE9;
+typedef IDirect3DTexture9 IDirect3DBaseTexture9;
+
+/** @brief デバイス */
+struct IDirect3DDevice9 : public IUnknown
+{
+	virtual HRESULT CreateTexture(UINT width, UINT height, UINT levels, DWORD usage, D3DFORMAT format, D3DPOOL pool, IDirect3DTexture9** out_texture, HANDLE* shared_handle) = 0;
+	virtual HRESULT CreateOffscreenPlainSurface(UINT width, UINT height, D3DFORMAT format, D3DPOOL pool, IDirect3DSurface9** out_surface, HANDLE* shared_handle) = 0;
+	virtual HRESULT SetViewport(const D3DVIEWPORT9* view_port) = 0;
+	virtual HRESULT SetRenderState(D3DRENDERSTATETYPE state, DWORD value) = 0;
+	virtual HRESULT SetTextureStageState(DWORD stage, D3DTEXTURESTAGESTATETYPE type, DWORD value) = 0;
+	virtual HRESULT SetSamplerState(DWORD sampler, D3DSAMPLERSTATETYPE type, DWORD value) = 0;
+	virtual HRESULT SetTexture(DWORD stage, IDirect3DBaseTexture9* texture) = 0;
+	virtual HRESULT SetFVF(DWORD fvf) = 0;
+	virtual HRESULT Clear(DWORD count, const void* rects, DWORD flags, D3DCOLOR color, float z, DWORD stencil) = 0;
+	virtual HRESULT BeginScene() = 0;
+	virtual HRESULT EndScene() = 0;
+	virtual HRESULT Present(const RECT* source_rect, const RECT* dest_rect, HWND dest_window, const void* dirty_region) = 0;
+	virtual HRESULT DrawPrimitiveUP(D3DPRIMITIVETYPE type, UINT primitive_count, const void* vertices, UINT stride) = 0;
+};
+typedef IDirect3DDevice9* LPDIRECT3DDEVICE9;
+
+/** @brief Direct3D9のインターフェース */
+struct IDirect3D9 : public IUnknown
+{
+	virtual HRESULT CreateDevice(UINT adapter, D3DDEVTYPE device_type, HWND focus_window, DWORD behavior_flags, D3DPRESENT_PARAMETERS* present_param, IDirect3DDevice9** out_device) = 0;
+};
+typedef IDirect3D9* LPDIRECT3D9;
+
+IDirect3D9* Direct3DCreate9(UINT sdk_version);
+
+#endif
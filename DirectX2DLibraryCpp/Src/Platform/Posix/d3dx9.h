@@ -0,0 +1,51 @@
+﻿/**
+* @file d3dx9.h
+* @brief <pre>
+* Windows以外でビルドするためのD3DXの代替の宣言
+* 画像の読み込みと保存はPNGだけに対応し、D3D9Posix.cppでlibpngを使用して実装する
+* libpngがない環境でビルドした場合は、画像の読み込みと保存は常に失敗する
+* </pre>
+*/
+#ifndef POSIX_D3DX9_H_
+#define POSIX_D3DX9_H_
+
+#include <d3d9.h>
+#include <D3dx9math.h>
+
+#define D3DX_DEFAULT ((UINT)-1)
+#define D3DX_FILTER_NONE 0x00000001
+#define D3DXERR_INVALIDDATA ((HRESULT)0x88760b59)
+
+typedef struct tagPALETTEENTRY PALETTEENTRY;
+
+enum D3DXIMAGE_FILEFORMAT
+{
+	D3DXIFF_BMP = 0,
+	D3DXIFF_JPG = 1,
+	D3DXIFF_TGA = 2,
+	D3DXIFF_PNG = 3,
+};
+
+/** @brief 画像ファイルの情報 */
+typedef struct _D3DXIMAGE_INFO
+{
+	UINT Width;
+	UINT Height;
+	UINT Depth;
+	UINT MipLevels;
+	D3DFORMAT Format;
+	D3DXIMAGE_FILEFORMAT ImageFileFormat;
+} D3DXIMAGE_INFO;
+
+HRESULT D3DXGetImageInfoFromFile(LPCSTR src_file, D3DXIMAGE_INFO* out_src_info);
+HRESULT D3DXGetImageInfoFromFileInMemory(const void* src_data, UINT src_data_size, D3DXIMAGE_INFO* out_src_info);
+
+HRESULT D3DXCreateTextureFromFileEx(LPDIRECT3DDEVICE9 device, LPCSTR src_file, UINT width, UINT height, UINT mip_levels, DWORD usage, D3DFORMAT format, D3DPOOL pool, DWORD filter, DWORD mip_filter, D3DCOLOR color_key, D3DXIMAGE_INFO* out_src_info, PALETTEENTRY* out_palette, LPDIRECT3DTEXTURE9* out_texture);
+HRESULT D3DXCreateTextureFromFileInMemoryEx(LPDIRECT3DDEVICE9 device, const void* src_data, UINT src_data_size, UINT width, UINT height, UINT mip_levels, DWORD usage, D3DFORMAT format, D3DPOOL pool, DWORD filter, DWORD mip_filter, D3DCOLOR color_key, D3DXIMAGE_INFO* out_src_info, PALETTEENTRY* out_palette, LPDIRECT3DTEXTURE9* out_texture);
+
+HRESULT D3DXLoadSurfaceFromFile(LPDIRECT3DSURFACE9 dest_surface, const PALETTEENTRY* dest_palette, const RECT* dest_rect, LPCSTR src_file, const RECT* src_rect, DWORD filter, D3DCOLOR color_key, D3DXIMAGE_INFO* out_src_info);
+HRESULT D3DXLoadSurfaceFromFileInMemory(LPDIRECT3DSURFACE9 dest_surface, const PALETTEENTRY* dest_palette, const RECT* dest_rect, const void* src_data, UINT src_data_size, const RECT* src_rect, DWORD filter, D3DCOLOR color_key, D3DXIMAGE_INFO* out_src_info);
+
+HRESULT D3DXSaveSurfaceToFile(LPCSTR dest_file, D3DXIMAGE_FILEFORMAT dest_format, LPDIRECT3DSURFACE9 src_surface, const PALETTEENTRY* src_palette, const RECT* src_rect);
+
+#endif
@@ -0,0 +1,213 @@
+﻿/**
+* @file dinput.h
+* @brief <pre>
+* Windows以外でビルドするためのDirectInput8の代替の宣言
+* DirectInput8Createは常に失敗するので、入力デバイスは使用できない
+* </pre>
+*/
+#ifndef POSIX_DINPUT_H_
+#define POSIX_DINPUT_H_
+
+#include <Windows.h>
+
+#ifndef DIRECTINPUT_VERSION
+#define DIRECTINPUT_VERSION 0x0800
+#endif
+
+#define DI_OK S_OK
+#define DIERR_INPUTLOST ((HRESULT)0x8007001e)
+#define DIERR_NOTACQUIRED ((HRESULT)0x8007000c)
+
+#define DIENUM_STOP 0
+#define DIENUM_CONTINUE 1
+#define DIEDFL_ATTACHEDONLY 0x00000001
+#define DI8DEVTYPE_JOYSTICK 0x14
+#define DI8DEVTYPE_GAMEPAD 0x15
+#define DIDC_POLLEDDATAFORMAT 0x00000008
+
+#define DISCL_EXCLUSIVE 0x00000001
+#define DISCL_NONEXCLUSIVE 0x00000002
+#define DISCL_FOREGROUND 0x00000004
+#define DISCL_BACKGROUND 0x00000008
+
+#define DIPH_DEVICE 0
+#define DIPH_BYOFFSET 1
+#define DIPROPAXISMODE_ABS 0
+#define DIPROP_RANGE (*(const GUID*)4)
+#define DIPROP_AXISMODE (*(const GUID*)2)
+
+#define DIJOFS_X 0
+#define DIJOFS_Y 4
+
+#define DIK_ESCAPE 0x01
+#define DIK_1 0x02
+#define DIK_2 0x03
+#define DIK_3 0x04
+#define DIK_4 0x05
+#define DIK_5 0x06
+#define DIK_6 0x07
+#define DIK_7 0x08
+#define DIK_8 0x09
+#define DIK_9 0x0a
+#define DIK_0 0x0b
+#define DIK_BACK 0x0e
+#define DIK_TAB 0x0f
+#define DIK_Q 0x10
+#define DIK_W 0x11
+#define DIK_E 0x12
+#define DIK_R 0x13
+#define DIK_T 0x14
+#define DIK_Y 0x15
+#define DIK_U 0x16
+#define DIK_I 0x17
+#define DIK_O 0x18
+#define DIK_P 0x19
+#define DIK_RETURN 0x1c
+#define DIK_LCONTROL 0x1d
+#define DIK_A 0x1e
+#define DIK_S 0x1f
+#define DIK_D 0x20
+#define DIK_F 0x21
+#define DIK_G 0x22
+#define DIK_H 0x23
+#define DIK_J 0x24
+#define DIK_K 0x25
+#define DIK_L 0x26
+#define DIK_LSHIFT 0x2a
+#define DIK_Z 0x2c
+#define DIK_X 0x2d
+#define DIK_C 0x2e
+#define DIK_V 0x2f
+#define DIK_B 0x30
+#define DIK_N 0x31
+#define DIK_M 0x32
+#define DIK_RSHIFT 0x36
+#define DIK_SPACE 0x39
+#define DIK_F1 0x3b
+#define DIK_F2 0x3c
+#define DIK_F3 0x3d
+#define DIK_F4 0x3e
+#define DIK_F5 0x3f
+#define DIK_F6 0x40
+#define DIK_F7 0x41
+#define DIK_F8 0x42
+#define DIK_F9 0x43
+#define DIK_F10 0x44
+#define DIK_UP 0xc8
+#define DIK_LEFT 0xcb
+#define DIK_RIGHT 0xcd
+#define DIK_DOWN 0xd0
+
+/** @brief デバイスのデータ形式 */
+typedef struct _DIDATAFORMAT
+{
+	DWORD dwSize;
+	DWORD dwObjSize;
+	DWORD dwFlags;
+	DWORD dwDataSize;
+	DWORD dwNumObjs;
+	void* rgodf;
+} DIDATAFORMAT;
+
+/** @brief 列挙されたデバイスの情報 */
+typedef struct _DIDEVICEINSTANCE
+{
+	DWORD dwSize;
+	GUID guidInstance;
+	GUID guidProduct;
+	DWORD dwDevType;
+} DIDEVICEINSTANCE;
+typedef const DIDEVICEINSTANCE* LPCDIDEVICEINSTANCE;
+
+/** @brief デバイスの能力 */
+typedef struct _DIDEVCAPS
+{
+	DWORD dwSize;
+	DWORD dwFlags;
+	DWORD dwDevType;
+	DWORD dwAxes;
+	DWORD dwButtons;
+	DWORD dwPOVs;
+} DIDEVCAPS;
+
+/** @brief プロパティのヘッダー */
+typedef struct _DIPROPHEADER
+{
+	DWORD dwSize;
+	DWORD dwHeaderSize;
+	DWORD dwObj;
+	DWORD dwHow;
+} DIPROPHEADER;
+
+/** @brief DWORDのプロパティ */
+typedef struct _DIPROPDWORD
+{
+	DIPROPHEADER diph;
+	DWORD dwData;
+} DIPROPDWORD;
+
+/** @brief 範囲のプロパティ */
+typedef struct _DIPROPRANGE
+{
+	DIPROPHEADER diph;
+	LONG lMin;
+	LONG lMax;
+} DIPROPRANGE;
+
+/** @brief マウスの入力状態 */
+typedef struct _DIMOUSESTATE
+{
+	LONG lX;
+	LONG lY;
+	LONG lZ;
+	BYTE rgbButtons[4];
+} DIMOUSESTATE;
+
+/** @brief ジョイスティックの入力状態 */
+typedef struct _DIJOYSTATE
+{
+	LONG lX;
+	LONG lY;
+	LONG lZ;
+	LONG lRx;
+	LONG lRy;
+	LONG lRz;
+	LONG rglSlider[2];
+	DWORD rgdwPOV[4];
+	BYTE rgbButtons[32];
+} DIJOYSTATE;
+
+typedef BOOL (CALLBACK* LPDIENUMDEVICESCALLBACK)(LPCDIDEVICEINSTANCE device_instance, LPVOID reference);
+
+/** @brief 入力デバイス */
+struct IDirectInputDevice8 : public IUnknown
+{
+	virtual HRESULT GetCapabilities(DIDEVCAPS* out_caps) = 0;
+	virtual HRESULT SetProperty(REFGUID property, const DIPROPHEADER* header) = 0;
+	virtual HRESULT Acquire() = 0;
+	virtual HRESULT Unacquire() = 0;
+	virtual HRESULT GetDeviceState(DWORD data_size, LPVOID out_data) = 0;
+	virtual HRESULT SetDataFormat(const DIDATAFORMAT* data_format) = 0;
+	virtual HRESULT SetCooperativeLevel(HWND window, DWORD flags) = 0;
+	virtual HRESULT Poll() = 0;
+};
+typedef IDirectInputDevice8* LPDIRECTINPUTDEVICE8;
+
+/** @brief DirectInput8のインターフェース */
+struct IDirectInput8 : public IUnknown
+{
+	virtual HRESULT CreateDevice(REFGUID guid, LPDIRECTINPUTDEVICE8* out_device, void* outer) = 0;
+	virtual HRESULT EnumDevices(DWORD device_type, LPDIENUMDEVICESCALLBACK callback, LPVOID reference, DWORD flags) = 0;
+};
+typedef IDirectInput8* LPDIRECTINPUT8;
+
+extern const GUID IID_IDirectInput8;
+extern const GUID GUID_SysKeyboard;
+extern const GUID GUID_SysMouse;
+extern const DIDATAFORMAT c_dfDIKeyboard;
+extern const DIDATAFORMAT c_dfDIMouse;
+extern const DIDATAFORMAT c_dfDIJoystick;
+
+HRESULT DirectInput8Create(HINSTANCE instance, DWORD version, REFIID riid, LPVOID* out_interface, void* outer);
+
+#endif
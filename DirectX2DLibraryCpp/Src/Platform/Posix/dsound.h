@@ -0,0 +1,80 @@
+﻿/**
+* @file dsound.h
+* @brief <pre>
+* Windows以外でビルドするためのDirectSound8の代替の宣言
+* DirectSoundCreate8は常に失敗するので、サウンドは再生できない
+* </pre>
+*/
+#ifndef POSIX_DSOUND_H_
+#define POSIX_DSOUND_H_
+
+#include <Windows.h>
+
+#define DS_OK S_OK
+#define DSSCL_NORMAL 0x00000001
+#define DSBCAPS_CTRLPAN 0x00000040
+#define DSBCAPS_CTRLVOLUME 0x00000080
+#define DSBPLAY_LOOPING 0x00000001
+#define DSBSTATUS_PLAYING 0x00000001
+#define WAVE_FORMAT_PCM 1
+
+/** @brief 波形データの形式 */
+typedef struct tWAVEFORMATEX
+{
+	WORD wFormatTag;
+	WORD nChannels;
+	DWORD nSamplesPerSec;
+	DWORD nAvgBytesPerSec;
+	WORD nBlockAlign;
+	WORD wBitsPerSample;
+	WORD cbSize;
+} WAVEFORMATEX;
+
+/** @brief サウンドバッファの作成情報 */
+typedef struct _DSBUFFERDESC
+{
+	DWORD dwSize;
+	DWORD dwFlags;
+	DWORD dwBufferBytes;
+	DWORD dwReserved;
+	WAVEFORMATEX* lpwfxFormat;
+	GUID guid3DAlgorithm;
+} DSBUFFERDESC;
+
+/** @brief サウンドバッファの能力 */
+typedef struct _DSBCAPS
+{
+	DWORD dwSize;
+	DWORD dwFlags;
+	DWORD dwBufferBytes;
+	DWORD dwUnlockTransferRate;
+	DWORD dwPlayCpuOverheadPercent;
+} DSBCAPS;
+
+extern const GUID DS3DALG_DEFAULT;
+
+/** @brief サウンドバッファ */
+struct IDirectSoundBuffer : public IUnknown
+{
+	virtual HRESULT GetCaps(DSBCAPS* out_caps) = 0;
+	virtual HRESULT GetStatus(DWORD* out_status) = 0;
+	virtual HRESULT Lock(DWORD offset, DWORD bytes, LPVOID* out_audio_ptr1, DWORD* out_audio_bytes1, LPVOID* out_audio_ptr2, DWORD* out_audio_bytes2, DWORD flags) = 0;
+	virtual HRESULT Play(DWORD reserved, DWORD priority, DWORD flags) = 0;
+	virtual HRESULT SetCurrentPosition(DWORD position) = 0;
+	virtual HRESULT Stop() = 0;
+	virtual HRESULT Unlock(LPVOID audio_ptr1, DWORD audio_bytes1, LPVOID audio_ptr2, DWORD audio_bytes2) = 0;
+};
+typedef IDirectSoundBuffer* LPDIRECTSOUNDBUFFER;
+
+/** @brief DirectSound8のインターフェース */
+struct IDirectSound8 : public IUnknown
+{
+	virtual HRESULT CreateSoundBuffer(const DSBUFFERDESC* desc, LPDIRECTSOUNDBUFFER* out_buffer, void* outer) = 0;
+	virtual HRESULT DuplicateSoundBuffer(LPDIRECTSOUNDBUFFER original, LPDIRECTSOUNDBUFFER* out_duplicate) = 0;
+	virtual HRESULT SetCooperativeLevel(HWND window, DWORD level) = 0;
+};
+typedef IDirectSound8* LPDIRECTSOUND8;
+
+HRESULT DirectSoundCreate8(const GUID* device, LPDIRECTSOUND8* out_interface, void* outer);
+
+#endif
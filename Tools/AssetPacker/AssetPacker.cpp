@@ -0,0 +1,387 @@
+﻿/**
+* @file AssetPacker.cpp
+* @brief <pre>
+* フォルダ内のファイルをエンジンで読み込めるアーカイブ(AssetArchive.h)にまとめるツール
+* 使い方：AssetPacker 出力ファイル名 入力フォルダ [-lz4]
+*   入力フォルダはゲームの実行フォルダからのパスで指定する(例：AssetPacker Res.pak Res)
+*   エントリのファイル名は「入力フォルダ/フォルダ内のパス」になる(例：Res/Enemy.png)
+*   -lz4を指定すると、圧縮で元のサイズの90%未満になるファイルをLZ4で圧縮する
+* </pre>
+*/
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "../../DirectX2DLibraryCpp/Src/Engine/AssetArchive.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/FileWatcher.h"
+
+namespace
+{
+	const int Lz4MinMatch = 4;					//!< LZ4の最小一致長
+	const int Lz4LastLiterals = 5;				//!< 末尾のリテラルとして残すバイト数(LZ4の仕様)
+	const int Lz4MatchFindLimit = 12;			//!< 末尾から一致の検索を行わないバイト数(LZ4の仕様)
+	const int Lz4MaxOffset = 65535;				//!< 一致の最大距離
+	const int Lz4HashBits = 16;					//!< 一致の検索に使用するハッシュテーブルのビット数
+	const int CompressRatioLimit = 90;			//!< 圧縮後のサイズがこの割合(%)未満の場合だけ圧縮して格納する
+
+	/** @brief アーカイブに格納するファイル */
+	struct PackEntry
+	{
+		std::string Name;			//!< 正規化したファイル名
+		std::string SourcePath;		//!< 読み込むファイルのパス
+		std::vector<char> Data;		//!< 格納する内容
+		unsigned int OriginalSize;	//!< 元のバイト数
+		unsigned short Flags;		//!< AssetArchiveFlagLz4など
+		unsigned long long Hash;	//!< ファイル名のハッシュ値
+	};
+
+	/**
+	* @brief フォルダ内のファイルの列挙関数
+	* @details サブフォルダを含めて再帰的に列挙する
+	* @retval true 列挙成功
+	* @retval false フォルダを開けなかった
+	* @param[in] directory 列挙するフォルダ
+	* @param[out] out_entry_list 列挙したファイル
+	*/
+	bool CollectFiles(const std::string& directory, std::vector<PackEntry>* out_entry_list)
+	{
+		WIN32_FIND_DATA find_data;
+		HANDLE find_handle = FindFirstFile((directory + "/*").c_str(), &find_data);
+
+		if (find_handle == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		bool is_succeeded = true;
+
+		do
+		{
+			if (strcmp(find_data.cFileName, ".") == 0 || strcmp(find_data.cFileName, "..") == 0)
+			{
+				continue;
+			}
+
+			std::string path = directory + "/" + find_data.cFileName;
+
+			if ((find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+			{
+				is_succeeded = CollectFiles(path, out_entry_list) && is_succeeded;
+				continue;
+			}
+
+			PackEntry entry;
+			entry.Name = FileWatcher::NormalizePath(path.c_str());
+			entry.SourcePath = path;
+			entry.OriginalSize = 0;
+			entry.Flags = 0;
+			entry.Hash = AssetArchive::HashName(entry.Name.c_str(), entry.Name.size());
+			out_entry_list->push_back(entry);
+		} while (FindNextFile(find_handle, &find_data) != FALSE);
+
+		FindClose(find_handle);
+
+		return is_succeeded;
+	}
+
+	/**
+	* @brief ファイルの読み込み関数
+	* @retval true 読み込み成功
+	* @retval false 読み込み失敗
+	* @param[in] file_name ファイル名
+	* @param[out] out_data 読み込んだ内容
+	*/
+	bool ReadWholeFile(const char* file_name, std::vector<char>* out_data)
+	{
+		FILE* fp = nullptr;
+		if (fopen_s(&fp, file_name, "rb") != 0 || fp == nullptr)
+		{
+			return false;
+		}
+
+		fseek(fp, 0, SEEK_END);
+		long size = ftell(fp);
+		fseek(fp, 0, SEEK_SET);
+
+		out_data->resize(size > 0 ? size : 0);
+		bool is_succeeded = size >= 0 &&
+			(size == 0 || fread(&(*out_data)[0], 1, size, fp) == (size_t)size);
+		fclose(fp);
+
+		return is_succeeded;
+	}
+
+	/** @brief LZ4の長さの書き込み関数(15以上の部分を255ずつ書き込む) */
+	void WriteLz4Length(size_t length, std::vector<char>* out_data)
+	{
+		while (length >= 255)
+		{
+			out_data->push_back((char)255);
+			length -= 255;
+		}
+		out_data->push_back((char)length);
+	}
+
+	/** @brief LZ4のシーケンスの書き込み関数 */
+	void WriteLz4Sequence(const unsigned char* literal, size_t literal_length, size_t offset, size_t match_length, std::vector<char>* out_data)
+	{
+		size_t token_literal = (std::min)(literal_length, (size_t)15);
+		size_t token_match = match_length > 0 ? (std::min)(match_length - Lz4MinMatch, (size_t)15) : 0;
+		out_data->push_back((char)((token_literal << 4) | token_match));
+
+		if (literal_length >= 15)
+		{
+			WriteLz4Length(literal_length - 15, out_data);
+		}
+		out_data->insert(out_data->end(), literal, literal + literal_length);
+
+		// 最後のシーケンスはリテラルだけ
+		if (match_length == 0)
+		{
+			return;
+		}
+
+		out_data->push_back((char)(offset & 0xff));
+		out_data->push_back((char)(offset >> 8));
+
+		if (match_length - Lz4MinMatch >= 15)
+		{
+			WriteLz4Length(match_length - Lz4MinMatch - 15, out_data);
+		}
+	}
+
+	/**
+	* @brief LZ4の圧縮関数
+	* @details <pre>
+	* 4バイトのハッシュで直前の出現位置を1つだけ記憶する単純な貪欲法で圧縮する
+	* 出力はLZ4のブロック形式なので、AssetArchive::DecompressLz4と標準のLZ4で展開できる
+	* </pre>
+	* @param[in] source 圧縮するデータ
+	* @param[in] size 圧縮するデータのバイト数
+	* @param[out] out_data 圧縮したデータ
+	*/
+	void CompressLz4(const unsigned char* source, size_t size, std::vector<char>* out_data)
+	{
+		out_data->clear();
+		out_data->reserve(size + size / 255 + 16);
+
+		std::vector<unsigned int> hash_table((size_t)1 << Lz4HashBits, 0xffffffff);
+		size_t anchor = 0;
+		size_t position = 0;
+
+		// 末尾MFLIMITバイトは一致の開始位置にせず、末尾LASTLITERALSバイトは必ずリテラルにする
+		size_t match_limit = size > (size_t)Lz4MatchFindLimit ? size - Lz4MatchFindLimit : 0;
+		size_t match_end_limit = size > (size_t)Lz4LastLiterals ? size - Lz4LastLiterals : 0;
+
+		while (position < match_limit)
+		{
+			unsigned int sequence;
+			memcpy(&sequence, source + position, sizeof(sequence));
+			unsigned int hash = (sequence * 2654435761U) >> (32 - Lz4HashBits);
+			unsigned int candidate = hash_table[hash];
+			hash_table[hash] = (unsigned int)position;
+
+			if (candidate == 0xffffffff ||
+				position - candidate > (size_t)Lz4MaxOffset ||
+				memcmp(source + candidate, &sequence, sizeof(sequence)) != 0)
+			{
+				position++;
+				continue;
+			}
+
+			size_t match_length = Lz4MinMatch;
+			while (position + match_length < match_end_limit &&
+				source[candidate + match_length] == source[position + match_length])
+			{
+				match_length++;
+			}
+
+			WriteLz4Sequence(source + anchor, position - anchor, position - candidate, match_length, out_data);
+			position += match_length;
+			anchor = position;
+		}
+
+		WriteLz4Sequence(source + anchor, size - anchor, 0, 0, out_data);
+	}
+
+	/** @brief 指定したバイト数の境界までの0埋め関数 */
+	void WritePadding(FILE* fp, unsigned long long* position, size_t alignment)
+	{
+		static const char zero[AssetArchiveAlignment] = {};
+		size_t padding = (size_t)((alignment - *position % alignment) % alignment);
+		fwrite(zero, 1, padding, fp);
+		*position += padding;
+	}
+
+	/**
+	* @brief アーカイブの書き込み関数
+	* @retval true 書き込み成功
+	* @retval false 書き込み失敗
+	* @param[in] file_name 出力ファイル名
+	* @param[in] entry_list 格納するファイル
+	*/
+	bool WriteArchive(const char* file_name, const std::vector<PackEntry>& entry_list)
+	{
+		// 空きバケットが必ず残るように、エントリ数の2倍以上の2のべき乗にする
+		unsigned int bucket_count = 1;
+		while (bucket_count < entry_list.size() * 2 + 1)
+		{
+			bucket_count <<= 1;
+		}
+
+		std::vector<unsigned int> bucket_list(bucket_count, AssetArchiveEmptyBucket);
+		std::vector<AssetArchiveEntry> archive_entry_list(entry_list.size());
+		std::string name_list;
+
+		for (size_t i = 0; i < entry_list.size(); i++)
+		{
+			const PackEntry& entry = entry_list[i];
+			AssetArchiveEntry& archive_entry = archive_entry_list[i];
+			archive_entry.NameHash = entry.Hash;
+			archive_entry.StoredSize = (unsigned int)entry.Data.size();
+			archive_entry.OriginalSize = entry.OriginalSize;
+			archive_entry.NameOffset = (unsigned int)name_list.size();
+			archive_entry.NameLength = (unsigned short)entry.Name.size();
+			archive_entry.Flags = entry.Flags;
+			name_list += entry.Name;
+
+			unsigned int bucket = (unsigned int)(entry.Hash & (bucket_count - 1));
+			while (bucket_list[bucket] != AssetArchiveEmptyBucket)
+			{
+				bucket = (bucket + 1) & (bucket_count - 1);
+			}
+			bucket_list[bucket] = (unsigned int)i;
+		}
+
+		FILE* fp = nullptr;
+		if (fopen_s(&fp, file_name, "wb") != 0 || fp == nullptr)
+		{
+			return false;
+		}
+
+		// ヘッダーは位置が決まってから書き直す
+		AssetArchiveHeader header = {};
+		fwrite(&header, sizeof(header), 1, fp);
+		unsigned long long position = sizeof(header);
+
+		for (size_t i = 0; i < entry_list.size(); i++)
+		{
+			WritePadding(fp, &position, AssetArchiveAlignment);
+			archive_entry_list[i].DataOffset = position;
+
+			if (entry_list[i].Data.empty() == false)
+			{
+				fwrite(&entry_list[i].Data[0], 1, entry_list[i].Data.size(), fp);
+			}
+			position += entry_list[i].Data.size();
+		}
+
+		WritePadding(fp, &position, AssetArchiveAlignment);
+		header.EntryOffset = position;
+		if (archive_entry_list.empty() == false)
+		{
+			fwrite(&archive_entry_list[0], sizeof(AssetArchiveEntry), archive_entry_list.size(), fp);
+		}
+		position += sizeof(AssetArchiveEntry) * archive_entry_list.size();
+
+		header.BucketOffset = position;
+		fwrite(&bucket_list[0], sizeof(unsigned int), bucket_list.size(), fp);
+		position += sizeof(unsigned int) * bucket_list.size();
+
+		header.NameOffset = position;
+		header.NameSize = name_list.size();
+		fwrite(name_list.c_str(), 1, name_list.size(), fp);
+
+		memcpy(header.Magic, AssetArchiveMagic, sizeof(AssetArchiveMagic));
+		header.Version = AssetArchiveVersion;
+		header.EntryCount = (unsigned int)archive_entry_list.size();
+		header.BucketCount = bucket_count;
+
+		bool is_succeeded = fseek(fp, 0, SEEK_SET) == 0 &&
+			fwrite(&header, sizeof(header), 1, fp) == 1 &&
+			ferror(fp) == 0;
+
+		is_succeeded = fclose(fp) == 0 && is_succeeded;
+
+		return is_succeeded;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		printf("usage: AssetPacker <output file> <input directory> [-lz4]\n");
+		return 1;
+	}
+
+	bool is_compressed = argc >= 4 && strcmp(argv[3], "-lz4") == 0;
+
+	std::string directory = argv[2];
+	while (directory.empty() == false && (directory.back() == '/' || directory.back() == '\\'))
+	{
+		directory.pop_back();
+	}
+
+	std::vector<PackEntry> entry_list;
+	if (CollectFiles(directory, &entry_list) == false)
+	{
+		printf("failed to read directory: %s\n", argv[2]);
+		return 1;
+	}
+
+	unsigned long long original_total = 0;
+	unsigned long long stored_total = 0;
+	int compressed_count = 0;
+
+	for (size_t i = 0; i < entry_list.size(); i++)
+	{
+		PackEntry& entry = entry_list[i];
+
+		for (size_t j = 0; j < i; j++)
+		{
+			if (entry_list[j].Name == entry.Name)
+			{
+				printf("duplicate file name: %s\n", entry.Name.c_str());
+				return 1;
+			}
+		}
+
+		if (ReadWholeFile(entry.SourcePath.c_str(), &entry.Data) == false ||
+			entry.Data.size() > 0xffffffffULL ||
+			entry.Name.size() > 0xffff)
+		{
+			printf("failed to read file: %s\n", entry.SourcePath.c_str());
+			return 1;
+		}
+		entry.OriginalSize = (unsigned int)entry.Data.size();
+
+		if (is_compressed == true && entry.Data.empty() == false)
+		{
+			std::vector<char> compressed;
+			CompressLz4((const unsigned char*)&entry.Data[0], entry.Data.size(), &compressed);
+
+			// 圧縮の効果が小さいファイル(png、oggなど)は展開の時間を省くためにそのまま格納する
+			if (compressed.size() * 100 < entry.Data.size() * CompressRatioLimit)
+			{
+				entry.Data.swap(compressed);
+				entry.Flags |= AssetArchiveFlagLz4;
+				compressed_count++;
+			}
+		}
+
+		original_total += entry.OriginalSize;
+		stored_total += entry.Data.size();
+	}
+
+	if (WriteArchive(argv[1], entry_list) == false)
+	{
+		printf("failed to write archive: %s\n", argv[1]);
+		return 1;
+	}
+
+	printf("%d files (%d compressed), %llu -> %llu bytes\n", (int)entry_list.size(), compressed_count, original_total, stored_total);
+
+	return 0;
+}
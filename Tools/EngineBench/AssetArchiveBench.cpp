@@ -0,0 +1,804 @@
+﻿/**
+* @file AssetArchiveBench.cpp
+* @brief <pre>
+* アーカイブのベンチマークと検証
+* 作業フォルダに作成したファイルをAssetArchive.hの形式でアーカイブにまとめ(圧縮なし、LZ4)、
+* 内容の一致、16バイト境界、名前の検索、ディレクトリが壊れたアーカイブを開かないことを検証する
+* LZ4の展開は、途中で切れたデータ、バイトを書き換えたデータ、不正な長さと位置で失敗し、展開先の外に書き込まないことを検証する
+* 通常のファイルとアーカイブから全てのファイルを読み込む時間を、初回と2回目で比較する
+* </pre>
+*/
+#include <ctype.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "EngineBench.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/AssetArchive.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/FileSystem.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/FileWatcher.h"
+
+namespace
+{
+	const char ArchiveDirectory[] = "BenchWork/Archive";					//!< アーカイブを置くフォルダ
+	const char DataDirectory[] = "BenchWork/Archive/Data";					//!< アーカイブにまとめるファイルを置くフォルダ
+	const char ArchiveFileName[] = "BenchWork/Archive/Bench.pak";			//!< 圧縮なしのアーカイブ
+	const char Lz4ArchiveFileName[] = "BenchWork/Archive/BenchLz4.pak";	//!< LZ4で圧縮したアーカイブ
+	const char CorruptArchiveFileName[] = "BenchWork/Archive/Corrupt.pak";	//!< 壊したアーカイブ
+	const int BenchFileCount = 256;			//!< 読み込み時間の計測に使用するファイルの数
+	const int SmallFileCount = 8;			//!< ディレクトリの検証に使用するアーカイブのファイルの数
+	const int ArchiveFuzzCount = 2000;		//!< バイトを書き換えたアーカイブを開く回数
+	const int Lz4FuzzCount = 20000;			//!< バイトを書き換えたLZ4のデータを展開する回数
+	const size_t GuardSize = 64;			//!< 展開先の後ろに置く書き込み検出用の領域のバイト数
+	const char GuardValue = (char)0xCD;		//!< 書き込み検出用の領域の値
+
+	// LZ4の圧縮(Tools/AssetPackerと同じ形式の簡易版)
+	const int Lz4MinMatch = 4;				//!< 最小一致長
+	const int Lz4LastLiterals = 5;			//!< 末尾のリテラルとして残すバイト数
+	const int Lz4MatchFindLimit = 12;		//!< 末尾から一致の検索を行わないバイト数
+	const int Lz4MaxOffset = 65535;			//!< 一致の最大距離
+	const int Lz4HashBits = 12;				//!< 一致の検索に使用するハッシュテーブルのビット数
+
+	/** @brief アーカイブにまとめるファイル */
+	struct BenchFile
+	{
+		std::string Name;			//!< ファイル名
+		std::vector<char> Data;		//!< 内容
+	};
+
+	/**
+	* @brief 乱数の取得関数
+	* @details xorshift32
+	* @retval unsigned int 乱数
+	* @param[in,out] state 乱数の状態(0以外)
+	*/
+	unsigned int NextRandom(unsigned int* state)
+	{
+		unsigned int x = *state;
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		*state = x;
+
+		return x;
+	}
+
+	/** @brief LZ4の長さの追加バイトの書き込み関数 */
+	void WriteLz4Length(size_t length, std::vector<char>* out_data)
+	{
+		while (length >= 255)
+		{
+			out_data->push_back((char)255);
+			length -= 255;
+		}
+		out_data->push_back((char)length);
+	}
+
+	/**
+	* @brief LZ4のシーケンスの書き込み関数
+	* @param[in] literal リテラル
+	* @param[in] literal_length リテラルのバイト数
+	* @param[in] offset 一致の距離(最後のシーケンスは0)
+	* @param[in] match_length 一致長(最後のシーケンスは0)
+	* @param[out] out_data 書き込み先
+	*/
+	void WriteLz4Sequence(const unsigned char* literal, size_t literal_length, size_t offset, size_t match_length, std::vector<char>* out_data)
+	{
+		size_t match_code = match_length > 0 ? match_length - Lz4MinMatch : 0;
+		out_data->push_back((char)(((literal_length < 15 ? literal_length : 15) << 4) | (match_code < 15 ? match_code : 15)));
+
+		if (literal_length >= 15)
+		{
+			WriteLz4Length(literal_length - 15, out_data);
+		}
+		out_data->insert(out_data->end(), literal, literal + literal_length);
+
+		if (match_length > 0)
+		{
+			out_data->push_back((char)(offset & 0xff));
+			out_data->push_back((char)(offset >> 8));
+			if (match_code >= 15)
+			{
+				WriteLz4Length(match_code - 15, out_data);
+			}
+		}
+	}
+
+	/**
+	* @brief LZ4の圧縮関数
+	* @param[in] source 圧縮するデータ
+	* @param[in] size 圧縮するデータのバイト数
+	* @param[out] out_data 圧縮したデータ(LZ4ブロック形式)
+	*/
+	void CompressLz4(const char* source, size_t size, std::vector<char>* out_data)
+	{
+		const unsigned char* data = (const unsigned char*)source;
+		std::vector<unsigned int> hash_table((size_t)1 << Lz4HashBits, 0xffffffff);
+		size_t anchor = 0;
+		size_t position = 0;
+		size_t match_limit = size > (size_t)Lz4MatchFindLimit ? size - Lz4MatchFindLimit : 0;
+		size_t match_end_limit = size > (size_t)Lz4LastLiterals ? size - Lz4LastLiterals : 0;
+
+		out_data->clear();
+
+		while (position < match_limit)
+		{
+			unsigned int sequence;
+			memcpy(&sequence, data + position, sizeof(sequence));
+			unsigned int hash = (sequence * 2654435761U) >> (32 - Lz4HashBits);
+			unsigned int candidate = hash_table[hash];
+			hash_table[hash] = (unsigned int)position;
+
+			if (candidate == 0xffffffff ||
+				position - candidate > (size_t)Lz4MaxOffset ||
+				memcmp(data + candidate, &sequence, sizeof(sequence)) != 0)
+			{
+				position++;
+				continue;
+			}
+
+			size_t match_length = Lz4MinMatch;
+			while (position + match_length < match_end_limit &&
+				data[candidate + match_length] == data[position + match_length])
+			{
+				match_length++;
+			}
+
+			WriteLz4Sequence(data + anchor, position - anchor, position - candidate, match_length, out_data);
+			position += match_length;
+			anchor = position;
+		}
+
+		WriteLz4Sequence(data + anchor, size - anchor, 0, 0, out_data);
+	}
+
+	/**
+	* @brief 圧縮できる内容の作成関数
+	* @details 敵のパラメーターを並べたようなテキストを作成する
+	* @param[in] size バイト数
+	* @param[in,out] random_state 乱数の状態
+	* @param[out] out_data 作成した内容
+	*/
+	void MakeTextData(size_t size, unsigned int* random_state, std::vector<char>* out_data)
+	{
+		out_data->clear();
+
+		int id = 0;
+		while (out_data->size() < size)
+		{
+			char line[128];
+			int length = sprintf_s(line, sizeof(line), "id=%d,name=Enemy%d,hp=%u,x=%u,y=%u\n",
+				id, id % 16, NextRandom(random_state) % 1000, NextRandom(random_state) % 1280, NextRandom(random_state) % 720);
+			out_data->insert(out_data->end(), line, line + length);
+			id++;
+		}
+
+		out_data->resize(size);
+	}
+
+	/**
+	* @brief 圧縮できない内容の作成関数
+	* @param[in] size バイト数
+	* @param[in,out] random_state 乱数の状態
+	* @param[out] out_data 作成した内容
+	*/
+	void MakeRandomData(size_t size, unsigned int* random_state, std::vector<char>* out_data)
+	{
+		out_data->resize(size);
+		for (char& c : *out_data)
+		{
+			c = (char)NextRandom(random_state);
+		}
+	}
+
+	/**
+	* @brief アーカイブにまとめるファイルの作成関数
+	* @details 偶数番目は圧縮できるテキスト、奇数番目は圧縮できないデータにする(4KB～64KB)
+	* @param[in] count ファイルの数
+	* @param[in] is_written 作業フォルダに通常のファイルとして書き込むか
+	* @param[out] out_file_list 作成したファイル
+	*/
+	bool MakeBenchFiles(int count, bool is_written, std::vector<BenchFile>* out_file_list)
+	{
+		unsigned int random_state = 0x12345678;
+
+		CreateDirectory(BenchWorkDirectory, nullptr);
+		CreateDirectory(ArchiveDirectory, nullptr);
+		CreateDirectory(DataDirectory, nullptr);
+
+		out_file_list->resize(count);
+		for (int i = 0; i < count; i++)
+		{
+			BenchFile& file = (*out_file_list)[i];
+			char file_name[MAX_PATH];
+			sprintf_s(file_name, sizeof(file_name), "%s/File%03d.%s", DataDirectory, i, i % 2 == 0 ? "txt" : "bin");
+			file.Name = file_name;
+
+			size_t size = 4096 + (size_t)(i * 2477) % 61440;
+			if (i % 2 == 0)
+			{
+				MakeTextData(size, &random_state, &file.Data);
+			}
+			else
+			{
+				MakeRandomData(size, &random_state, &file.Data);
+			}
+
+			if (is_written == true &&
+				WriteBenchFile(file.Name.c_str(), &file.Data[0], file.Data.size()) == false)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/** @brief 指定したバイト数の境界までの0埋め関数 */
+	void AppendPadding(std::vector<char>* archive, size_t alignment)
+	{
+		archive->resize((archive->size() + alignment - 1) / alignment * alignment, 0);
+	}
+
+	/**
+	* @brief アーカイブの作成関数
+	* @details AssetArchive.hの形式で、ヘッダー、内容、エントリ、バケット、ファイル名の順に並べる
+	* @param[in] file_list まとめるファイル
+	* @param[in] is_compressed 圧縮で小さくなるファイルをLZ4で圧縮するか
+	* @param[out] out_archive 作成したアーカイブ
+	*/
+	void BuildArchive(const std::vector<BenchFile>& file_list, bool is_compressed, std::vector<char>* out_archive)
+	{
+		unsigned int bucket_count = 1;
+		while (bucket_count < file_list.size() * 2 + 1)
+		{
+			bucket_count <<= 1;
+		}
+
+		std::vector<unsigned int> bucket_list(bucket_count, AssetArchiveEmptyBucket);
+		std::vector<AssetArchiveEntry> entry_list(file_list.size());
+		std::string name_list;
+
+		out_archive->assign(sizeof(AssetArchiveHeader), 0);
+
+		for (size_t i = 0; i < file_list.size(); i++)
+		{
+			const BenchFile& file = file_list[i];
+			AssetArchiveEntry& entry = entry_list[i];
+			std::string name = FileWatcher::NormalizePath(file.Name.c_str());
+
+			std::vector<char> stored_data = file.Data;
+			entry.Flags = 0;
+			if (is_compressed == true)
+			{
+				std::vector<char> compressed;
+				CompressLz4(&file.Data[0], file.Data.size(), &compressed);
+				if (compressed.size() < file.Data.size())
+				{
+					stored_data.swap(compressed);
+					entry.Flags = AssetArchiveFlagLz4;
+				}
+			}
+
+			AppendPadding(out_archive, AssetArchiveAlignment);
+			entry.NameHash = AssetArchive::HashName(name.c_str(), name.size());
+			entry.DataOffset = out_archive->size();
+			entry.StoredSize = (unsigned int)stored_data.size();
+			entry.OriginalSize = (unsigned int)file.Data.size();
+			entry.NameOffset = (unsigned int)name_list.size();
+			entry.NameLength = (unsigned short)name.size();
+			out_archive->insert(out_archive->end(), stored_data.begin(), stored_data.end());
+			name_list += name;
+
+			unsigned int bucket = (unsigned int)(entry.NameHash & (bucket_count - 1));
+			while (bucket_list[bucket] != AssetArchiveEmptyBucket)
+			{
+				bucket = (bucket + 1) & (bucket_count - 1);
+			}
+			bucket_list[bucket] = (unsigned int)i;
+		}
+
+		AssetArchiveHeader header = {};
+		memcpy(header.Magic, AssetArchiveMagic, sizeof(AssetArchiveMagic));
+		header.Version = AssetArchiveVersion;
+		header.EntryCount = (unsigned int)entry_list.size();
+		header.BucketCount = bucket_count;
+
+		AppendPadding(out_archive, AssetArchiveAlignment);
+		header.EntryOffset = out_archive->size();
+		out_archive->insert(out_archive->end(), (const char*)&entry_list[0], (const char*)(&entry_list[0] + entry_list.size()));
+
+		header.BucketOffset = out_archive->size();
+		out_archive->insert(out_archive->end(), (const char*)&bucket_list[0], (const char*)(&bucket_list[0] + bucket_list.size()));
+
+		header.NameOffset = out_archive->size();
+		header.NameSize = name_list.size();
+		out_archive->insert(out_archive->end(), name_list.begin(), name_list.end());
+
+		memcpy(&(*out_archive)[0], &header, sizeof(header));
+	}
+
+	/**
+	* @brief 書き込み検出用の領域の確認関数
+	* @retval true 書き換えられていない
+	* @retval false 展開先の外に書き込まれた
+	* @param[in] buffer 展開先と書き込み検出用の領域
+	* @param[in] destination_size 展開先のバイト数
+	*/
+	bool IsGuardIntact(const std::vector<char>& buffer, size_t destination_size)
+	{
+		for (size_t i = destination_size; i < buffer.size(); i++)
+		{
+			if (buffer[i] != GuardValue)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	* @brief 不正なLZ4のデータの展開結果の取得関数
+	* @details 入力はちょうどのサイズの領域にコピーし、展開先の後ろに書き込み検出用の領域を置いて展開する
+	* @retval true 展開成功
+	* @retval false 展開失敗
+	* @param[in] source 圧縮したデータ
+	* @param[in] destination_size 展開後のバイト数
+	* @param[out] out_is_overrun 展開先の外に書き込んだか
+	*/
+	bool DecompressWithGuard(const std::vector<char>& source, size_t destination_size, bool* out_is_overrun)
+	{
+		std::vector<char> input(source);
+		std::vector<char> output(destination_size + GuardSize, GuardValue);
+
+		bool is_decompressed = AssetArchive::DecompressLz4(
+			input.empty() == true ? nullptr : &input[0], input.size(), &output[0], destination_size);
+
+		*out_is_overrun = IsGuardIntact(output, destination_size) == false;
+
+		return is_decompressed;
+	}
+
+	/** @brief 手作りの不正なLZ4のデータの検証 */
+	void CheckMalformedLz4()
+	{
+		/** @brief 手作りのデータ */
+		struct Lz4Case
+		{
+			const char* Description;		//!< 検証内容の説明
+			std::vector<char> Source;		//!< 圧縮したデータ
+			size_t DestinationSize;			//!< 展開後のバイト数
+			bool IsValid;					//!< 展開に成功するべきか
+		};
+
+		const Lz4Case case_list[] =
+		{
+			{ "overlapping match repeats the previous byte", { 0x10, 'a', 0x01, 0x00, 0x10, 'b' }, 6, true },
+			{ "empty input with empty output is accepted", {}, 0, true },
+			{ "empty input with non-empty output is rejected", {}, 4, false },
+			{ "zero match offset is rejected", { 0x40, 'a', 'b', 'c', 'd', 0x00, 0x00 }, 8, false },
+			{ "match offset before the output start is rejected", { 0x40, 'a', 'b', 'c', 'd', 0x05, 0x00 }, 8, false },
+			{ "match offset with one byte missing is rejected", { 0x41, 'a', 'b', 'c', 'd', 0x01 }, 9, false },
+			{ "literal length past the input is rejected", { 0x50, 'a', 'b' }, 5, false },
+			{ "unterminated literal length is rejected", { (char)0xF0, (char)0xFF, (char)0xFF }, 1024, false },
+			{ "literal length past the output is rejected", { 0x40, 'a', 'b', 'c', 'd' }, 3, false },
+			{ "match length past the output is rejected", { 0x4F, 'a', 'b', 'c', 'd', 0x01, 0x00, (char)0xFF, 0x10 }, 8, false },
+			{ "unterminated match length is rejected", { 0x4F, 'a', 'b', 'c', 'd', 0x01, 0x00, (char)0xFF }, 1024, false },
+			{ "output shorter than the destination is rejected", { 0x40, 'a', 'b', 'c', 'd' }, 5, false },
+		};
+
+		for (const Lz4Case& lz4_case : case_list)
+		{
+			bool is_overrun = false;
+			bool is_decompressed = DecompressWithGuard(lz4_case.Source, lz4_case.DestinationSize, &is_overrun);
+			BenchCheck(is_decompressed == lz4_case.IsValid && is_overrun == false, lz4_case.Description);
+		}
+	}
+
+	/** @brief LZ4の展開の検証 */
+	void CheckDecompressLz4()
+	{
+		unsigned int random_state = 0x9E3779B9;
+
+		std::vector<char> original;
+		MakeTextData(65536, &random_state, &original);
+		std::vector<char> compressed;
+		CompressLz4(&original[0], original.size(), &compressed);
+
+		std::vector<char> output(original.size());
+		bool is_decompressed = AssetArchive::DecompressLz4(&compressed[0], compressed.size(), &output[0], output.size());
+		BenchCheck(is_decompressed == true && output == original, "compressed text round-trips");
+		BenchCheck(compressed.size() < original.size(), "text compresses");
+
+		bool is_overrun = false;
+		BenchCheck(DecompressWithGuard(compressed, original.size() - 1, &is_overrun) == false && is_overrun == false, "destination one byte short is rejected");
+		BenchCheck(DecompressWithGuard(compressed, original.size() + 1, &is_overrun) == false && is_overrun == false, "destination one byte long is rejected");
+
+		// 途中で切れたデータは、どこで切れても展開後のサイズに届かない
+		int accepted_count = 0;
+		int overrun_count = 0;
+		for (size_t size = 0; size < compressed.size(); size++)
+		{
+			std::vector<char> truncated(compressed.begin(), compressed.begin() + size);
+			if (DecompressWithGuard(truncated, original.size(), &is_overrun) == true)
+			{
+				accepted_count++;
+			}
+			overrun_count += is_overrun == true ? 1 : 0;
+		}
+		BenchCheck(accepted_count == 0 && overrun_count == 0, "every truncated input is rejected");
+
+		CheckMalformedLz4();
+
+		// 小さいデータのバイトを1～3個書き換えて展開する(成功する場合もあるが、展開先の外には書き込まない)
+		std::vector<char> small_original;
+		MakeTextData(4096, &random_state, &small_original);
+		std::vector<char> small_compressed;
+		CompressLz4(&small_original[0], small_original.size(), &small_compressed);
+
+		int rejected_count = 0;
+		overrun_count = 0;
+		for (int i = 0; i < Lz4FuzzCount; i++)
+		{
+			std::vector<char> corrupted(small_compressed);
+			int flip_count = 1 + NextRandom(&random_state) % 3;
+			for (int flip = 0; flip < flip_count; flip++)
+			{
+				corrupted[NextRandom(&random_state) % corrupted.size()] ^= (char)(1 + NextRandom(&random_state) % 255);
+			}
+
+			if (DecompressWithGuard(corrupted, small_original.size(), &is_overrun) == false)
+			{
+				rejected_count++;
+			}
+			overrun_count += is_overrun == true ? 1 : 0;
+		}
+		BenchCheck(overrun_count == 0, "corrupted input never writes past the destination");
+
+		// 乱数だけのデータ
+		int garbage_rejected_count = 0;
+		for (int i = 0; i < Lz4FuzzCount / 10; i++)
+		{
+			std::vector<char> garbage;
+			MakeRandomData(1 + NextRandom(&random_state) % 256, &random_state, &garbage);
+			if (DecompressWithGuard(garbage, 1024, &is_overrun) == false)
+			{
+				garbage_rejected_count++;
+			}
+			overrun_count += is_overrun == true ? 1 : 0;
+		}
+		BenchCheck(overrun_count == 0, "random input never writes past the destination");
+
+		printf("  lz4: %d -> %d bytes, %d/%d corrupted and %d/%d random inputs rejected, no overrun\n",
+			(int)original.size(), (int)compressed.size(), rejected_count, Lz4FuzzCount, garbage_rejected_count, Lz4FuzzCount / 10);
+	}
+
+	/**
+	* @brief アーカイブの内容の検証
+	* @param[in] archive_file アーカイブのファイル名
+	* @param[in] file_list まとめたファイル
+	* @param[in] is_compressed LZ4で圧縮したアーカイブか
+	*/
+	void CheckArchiveContents(const char* archive_file, const std::vector<BenchFile>& file_list, bool is_compressed)
+	{
+		AssetArchive archive;
+		if (archive.Open(archive_file) == false)
+		{
+			BenchCheck(false, "archive opens");
+			return;
+		}
+
+		BenchCheck(archive.GetEntryCount() == (int)file_list.size(), "archive lists every file");
+
+		int mismatch_count = 0;
+		int unaligned_count = 0;
+		int lz4_count = 0;
+		for (const BenchFile& file : file_list)
+		{
+			FileData file_data;
+			if (archive.ReadFile(file.Name.c_str(), &file_data) == false ||
+				file_data.Size != file.Data.size() ||
+				memcmp(file_data.Data, &file.Data[0], file_data.Size) != 0)
+			{
+				mismatch_count++;
+				continue;
+			}
+
+			// 展開していないファイルはマップしたメモリを直接参照するので、アーカイブ内の境界がそのままアドレスの境界になる
+			if (file_data.Buffer.empty() == true)
+			{
+				unaligned_count += (size_t)file_data.Data % AssetArchiveAlignment != 0 ? 1 : 0;
+			}
+			else
+			{
+				lz4_count++;
+			}
+		}
+
+		BenchCheck(mismatch_count == 0, "every file reads back with the same content");
+		BenchCheck(unaligned_count == 0, "stored files start on a 16-byte boundary");
+		BenchCheck((is_compressed == true) == (lz4_count > 0), "only the LZ4 archive holds compressed files");
+
+		// 大文字小文字、区切り文字、先頭の"./"を区別しない
+		std::string other_name = "./" + file_list[0].Name;
+		for (char& c : other_name)
+		{
+			c = c == '/' ? '\\' : (char)toupper((unsigned char)c);
+		}
+		other_name[0] = '.';
+		other_name[1] = '/';
+
+		FileData file_data;
+		BenchCheck(archive.ReadFile(other_name.c_str(), &file_data) == true && file_data.Size == file_list[0].Data.size(), "lookup ignores case, separators and a leading ./");
+
+		std::string prefix_name = file_list[0].Name.substr(0, file_list[0].Name.size() - 1);
+		std::string longer_name = file_list[0].Name + "x";
+		BenchCheck(archive.ReadFile("BenchWork/Archive/Data/Missing.txt", &file_data) == false, "unknown name misses");
+		BenchCheck(archive.ReadFile(prefix_name.c_str(), &file_data) == false && archive.ReadFile(longer_name.c_str(), &file_data) == false, "names that only share a prefix miss");
+		BenchCheck(archive.ReadFile("", &file_data) == false, "empty name misses");
+
+		archive.Close();
+		BenchCheck(archive.ReadFile(file_list[0].Name.c_str(), &file_data) == false, "closed archive reads nothing");
+	}
+
+	/**
+	* @brief アーカイブを開けるかの確認関数
+	* @retval true 開けた
+	* @retval false 開けなかった
+	* @param[in] archive_data アーカイブの内容
+	*/
+	bool CanOpen(const std::vector<char>& archive_data)
+	{
+		if (WriteBenchFile(CorruptArchiveFileName, archive_data.empty() == true ? nullptr : &archive_data[0], archive_data.size()) == false)
+		{
+			return false;
+		}
+
+		AssetArchive archive;
+		return archive.Open(CorruptArchiveFileName);
+	}
+
+	/**
+	* @brief 値を書き換えたアーカイブを開かないことの検証
+	* @param[in] archive_data 正しいアーカイブの内容
+	* @param[in] offset 書き換える位置
+	* @param[in] value 書き込む値
+	* @param[in] size 書き込むバイト数(valueの下位から)
+	* @param[in] description 検証内容の説明
+	*/
+	void CheckRejected(const std::vector<char>& archive_data, size_t offset, unsigned long long value, size_t size, const char* description)
+	{
+		std::vector<char> corrupted(archive_data);
+		memcpy(&corrupted[offset], &value, size);
+
+		BenchCheck(CanOpen(corrupted) == false, description);
+	}
+
+	/** @brief 壊れたディレクトリの検証 */
+	void CheckCorruptDirectory()
+	{
+		std::vector<BenchFile> file_list;
+		MakeBenchFiles(SmallFileCount, false, &file_list);
+		std::vector<char> archive_data;
+		BuildArchive(file_list, true, &archive_data);
+
+		BenchCheck(CanOpen(archive_data) == true, "small test archive opens");
+
+		AssetArchiveHeader header;
+		memcpy(&header, &archive_data[0], sizeof(header));
+		unsigned long long file_size = archive_data.size();
+
+		// 0番目のファイルは圧縮できるテキスト、1番目は圧縮できないデータ
+		size_t lz4_entry = (size_t)header.EntryOffset;
+		size_t stored_entry = (size_t)header.EntryOffset + sizeof(AssetArchiveEntry);
+		AssetArchiveEntry lz4_entry_data;
+		memcpy(&lz4_entry_data, &archive_data[lz4_entry], sizeof(lz4_entry_data));
+		BenchCheck((lz4_entry_data.Flags & AssetArchiveFlagLz4) != 0, "small test archive holds an LZ4 entry");
+
+		CheckRejected(archive_data, offsetof(AssetArchiveHeader, Magic), 0x58585858, 4, "bad magic is rejected");
+		CheckRejected(archive_data, offsetof(AssetArchiveHeader, Version), AssetArchiveVersion + 1, 4, "unknown version is rejected");
+		CheckRejected(archive_data, offsetof(AssetArchiveHeader, BucketCount), 0, 4, "zero buckets are rejected");
+		CheckRejected(archive_data, offsetof(AssetArchiveHeader, BucketCount), header.BucketCount - 1, 4, "bucket count that is not a power of two is rejected");
+		CheckRejected(archive_data, offsetof(AssetArchiveHeader, BucketCount), 8, 4, "buckets without an empty slot are rejected");
+		CheckRejected(archive_data, offsetof(AssetArchiveHeader, EntryCount), 0x08000000, 4, "entry count past the file end is rejected");
+		CheckRejected(archive_data, offsetof(AssetArchiveHeader, EntryOffset), (file_size + 16) & ~7ULL, 8, "entry offset past the file end is rejected");
+		CheckRejected(archive_data, offsetof(AssetArchiveHeader, EntryOffset), header.EntryOffset + 4, 8, "misaligned entry offset is rejected");
+		CheckRejected(archive_data, offsetof(AssetArchiveHeader, EntryOffset), 0xfffffffffffffff8ULL, 8, "wrapping entry offset is rejected");
+		CheckRejected(archive_data, offsetof(AssetArchiveHeader, BucketOffset), file_size & ~3ULL, 8, "bucket offset at the file end is rejected");
+		CheckRejected(archive_data, offsetof(AssetArchiveHeader, BucketOffset), header.BucketOffset + 2, 8, "misaligned bucket offset is rejected");
+		CheckRejected(archive_data, offsetof(AssetArchiveHeader, NameOffset), file_size + 1, 8, "name offset past the file end is rejected");
+		CheckRejected(archive_data, offsetof(AssetArchiveHeader, NameSize), file_size, 8, "name size past the file end is rejected");
+
+		CheckRejected(archive_data, stored_entry + offsetof(AssetArchiveEntry, DataOffset), file_size + 16, 8, "data offset past the file end is rejected");
+		CheckRejected(archive_data, stored_entry + offsetof(AssetArchiveEntry, StoredSize), file_size, 4, "stored size past the file end is rejected");
+		CheckRejected(archive_data, stored_entry + offsetof(AssetArchiveEntry, OriginalSize), file_list[1].Data.size() + 1, 4, "uncompressed entry with a different original size is rejected");
+		CheckRejected(archive_data, stored_entry + offsetof(AssetArchiveEntry, NameOffset), (unsigned int)header.NameSize, 4, "name past the name table is rejected");
+		CheckRejected(archive_data, lz4_entry + offsetof(AssetArchiveEntry, OriginalSize), (unsigned long long)lz4_entry_data.StoredSize * AssetArchiveLz4MaxRatio + 1, 4, "LZ4 original size beyond the maximum ratio is rejected");
+
+		const unsigned int* bucket_list = (const unsigned int*)&archive_data[(size_t)header.BucketOffset];
+		size_t used_bucket = 0;
+		while (bucket_list[used_bucket] == AssetArchiveEmptyBucket)
+		{
+			used_bucket++;
+		}
+		CheckRejected(archive_data, (size_t)header.BucketOffset + used_bucket * sizeof(unsigned int), header.EntryCount, 4, "bucket pointing past the entries is rejected");
+
+		std::vector<char> truncated(archive_data.begin(), archive_data.begin() + sizeof(AssetArchiveHeader) - 1);
+		BenchCheck(CanOpen(truncated) == false, "file shorter than the header is rejected");
+		truncated.assign(archive_data.begin(), archive_data.begin() + (size_t)header.NameOffset);
+		BenchCheck(CanOpen(truncated) == false, "file cut before the name table is rejected");
+		BenchCheck(CanOpen(std::vector<char>()) == false, "empty file is rejected");
+
+		// ヘッダーとディレクトリを中心にバイトを書き換え、開けた場合は全てのファイルを読み込む(クラッシュしないこと)
+		unsigned int random_state = 0x2545F491;
+		size_t directory_size = (size_t)(file_size - header.EntryOffset);
+		int opened_count = 0;
+		int read_count = 0;
+		for (int i = 0; i < ArchiveFuzzCount; i++)
+		{
+			std::vector<char> corrupted(archive_data);
+			int flip_count = 1 + NextRandom(&random_state) % 4;
+			for (int flip = 0; flip < flip_count; flip++)
+			{
+				unsigned int r = NextRandom(&random_state);
+				size_t position = r % 4 == 0 ? r % corrupted.size() :
+					r % 4 == 1 ? r % sizeof(AssetArchiveHeader) :
+					(size_t)header.EntryOffset + r % directory_size;
+				corrupted[position] ^= (char)(1 + NextRandom(&random_state) % 255);
+			}
+
+			if (WriteBenchFile(CorruptArchiveFileName, &corrupted[0], corrupted.size()) == false)
+			{
+				continue;
+			}
+
+			AssetArchive archive;
+			if (archive.Open(CorruptArchiveFileName) == false)
+			{
+				continue;
+			}
+			opened_count++;
+
+			for (const BenchFile& file : file_list)
+			{
+				FileData file_data;
+				if (archive.ReadFile(file.Name.c_str(), &file_data) == true)
+				{
+					read_count++;
+				}
+			}
+		}
+
+		printf("  directory fuzz: %d/%d corrupted archives opened, %d reads succeeded, no crash\n", opened_count, ArchiveFuzzCount, read_count);
+		DeleteFile(CorruptArchiveFileName);
+	}
+
+	/**
+	* @brief 内容の読み取り関数
+	* @details 64バイトごとに1バイト読み、マップしたページを実際に読み込ませる
+	* @retval unsigned int 読み取った値の合計
+	* @param[in] file_data 読み込んだ内容
+	*/
+	unsigned int TouchData(const FileData& file_data)
+	{
+		unsigned int sum = 0;
+		for (size_t i = 0; i < file_data.Size; i += 64)
+		{
+			sum += (unsigned char)file_data.Data[i];
+		}
+
+		return sum;
+	}
+
+	/**
+	* @brief 全てのファイルの読み込み時間の計測
+	* @retval double 読み込み時間(ミリ秒)
+	* @param[in] file_system ファイルを読み込む仮想ファイルシステム(nullptrの場合は通常のファイルから読み込む)
+	* @param[in] file_list 読み込むファイル
+	* @param[out] out_sum 読み取った値の合計(最適化で読み込みが省略されないように使用する)
+	*/
+	double MeasureReadAll(const FileSystem* file_system, const std::vector<BenchFile>& file_list, unsigned int* out_sum)
+	{
+		int failure_count = 0;
+
+		BenchTimer timer;
+		for (const BenchFile& file : file_list)
+		{
+			FileData file_data;
+			bool is_read = file_system != nullptr ?
+				file_system->ReadFile(file.Name.c_str(), &file_data) :
+				FileSystem::ReadLooseFile(file.Name.c_str(), &file_data);
+
+			if (is_read == false)
+			{
+				failure_count++;
+				continue;
+			}
+			*out_sum += TouchData(file_data);
+		}
+		double read_time = timer.GetElapsedTime();
+
+		BenchCheck(failure_count == 0, "every file is read");
+
+		return read_time;
+	}
+
+	/**
+	* @brief 読み込み時間の計測
+	* @param[in] file_list 作業フォルダに書き込んだファイル
+	*/
+	void MeasureReadTime(const std::vector<BenchFile>& file_list)
+	{
+		size_t total_size = 0;
+		for (const BenchFile& file : file_list)
+		{
+			total_size += file.Data.size();
+		}
+
+		// 作成した直後なのでファイルはOSのファイルキャッシュに載っている(初回はマップしたページの割り当てを含む)
+		unsigned int sum = 0;
+		double loose_first = MeasureReadAll(nullptr, file_list, &sum);
+		double loose_warm = MeasureReadAll(nullptr, file_list, &sum);
+
+		const char* archive_file_list[] = { ArchiveFileName, Lz4ArchiveFileName };
+		const char* label_list[] = { "archive (stored):", "archive (LZ4):   " };
+		double archive_time[2][3] = {};
+
+		for (int i = 0; i < 2; i++)
+		{
+			FileSystem file_system;
+			BenchTimer timer;
+			if (file_system.MountArchive(archive_file_list[i]) == false)
+			{
+				BenchCheck(false, "mount archive");
+				continue;
+			}
+			archive_time[i][0] = timer.GetElapsedTime();
+			archive_time[i][1] = MeasureReadAll(&file_system, file_list, &sum);
+			archive_time[i][2] = MeasureReadAll(&file_system, file_list, &sum);
+			file_system.UnmountAll();
+		}
+
+		double total_megabytes = total_size / (1024.0 * 1024.0);
+		printf("  %d files, %.1f MB (checksum %08x)\n", (int)file_list.size(), total_megabytes, sum);
+		printf("  loose files:       first %8.3f ms, warm %8.3f ms (%.0f MB/s)\n",
+			loose_first, loose_warm, loose_warm > 0.0 ? total_megabytes * 1000.0 / loose_warm : 0.0);
+		for (int i = 0; i < 2; i++)
+		{
+			printf("  %s mount %6.3f ms, first %8.3f ms, warm %8.3f ms (%.0f MB/s)\n",
+				label_list[i], archive_time[i][0], archive_time[i][1], archive_time[i][2],
+				archive_time[i][2] > 0.0 ? total_megabytes * 1000.0 / archive_time[i][2] : 0.0);
+		}
+	}
+}
+
+void RunAssetArchiveBench()
+{
+	CheckDecompressLz4();
+	CheckCorruptDirectory();
+
+	std::vector<BenchFile> file_list;
+	if (MakeBenchFiles(BenchFileCount, true, &file_list) == false)
+	{
+		BenchCheck(false, "write test files into BenchWork/Archive/Data");
+		return;
+	}
+
+	std::vector<char> archive_data;
+	BuildArchive(file_list, false, &archive_data);
+	bool is_written = WriteBenchFile(ArchiveFileName, &archive_data[0], archive_data.size());
+	BuildArchive(file_list, true, &archive_data);
+	is_written = WriteBenchFile(Lz4ArchiveFileName, &archive_data[0], archive_data.size()) == true && is_written == true;
+	if (is_written == false)
+	{
+		BenchCheck(false, "write archives into BenchWork/Archive");
+		return;
+	}
+
+	CheckArchiveContents(ArchiveFileName, file_list, false);
+	CheckArchiveContents(Lz4ArchiveFileName, file_list, true);
+	MeasureReadTime(file_list);
+}
@@ -0,0 +1,212 @@
+﻿/**
+* @file BitmapFontBench.cpp
+* @brief <pre>
+* ビットマップフォントのベンチマークと検証
+* フォント定義(.fnt)の解析、カーニング、フォントに含まれない文字の配置、不正な行の扱いを検証し、
+* 長い文字列の配置(NextQuad)とサイズ計算(MeasureText)の時間を計測する
+* </pre>
+*/
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include "EngineBench.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/BitmapFont.h"
+
+namespace
+{
+	const int BenchTextLength = 100000;		//!< 計測する文字列の長さ
+	const int BenchRepeatCount = 20;		//!< 計測の繰り返し回数
+
+	/** 検証用のフォント定義(2ページ、Aだけpageを省略、同じ組み合わせのカーニングを2つ記述) */
+	const char TestFontDefinition[] =
+		"info face=\"Test Font\" size=16 bold=0 italic=0\r\n"
+		"common lineHeight=20 base=16 scaleW=128 scaleH=64 pages=2 packed=0\r\n"
+		"page id=0 file=\"test_0.png\"\r\n"
+		"page id=1 file=\"test_1.png\"\r\n"
+		"chars count=4\r\n"
+		"char id=32 x=0 y=0 width=0 height=0 xoffset=0 yoffset=0 xadvance=5 page=0 chnl=15\r\n"
+		"char id=65 x=0 y=0 width=10 height=12 xoffset=1 yoffset=4 xadvance=11 chnl=15\r\n"
+		"char id=86 x=32 y=16 width=10 height=12 xoffset=-1 yoffset=4 xadvance=10 page=1 chnl=15\r\n"
+		"char id=12354 x=64 y=0 width=16 height=16 xoffset=0 yoffset=2 xadvance=16 page=1 chnl=15\r\n"
+		"char id=70000 x=0 y=0 width=8 height=8 xoffset=0 yoffset=0 xadvance=8 page=0 chnl=15\r\n"
+		"kernings count=4\r\n"
+		"kerning first=65 second=86 amount=-2\r\n"
+		"kerning first=65 second=86 amount=-5\r\n"
+		"kerning first=86 second=65 amount=-1\r\n"
+		"kerning first=65 second=65 amount=0\r\n";
+
+	/**
+	* @brief 文字列のフォント定義の解析関数
+	* @retval true 解析成功
+	* @retval false 解析失敗
+	* @param[out] font 解析先
+	* @param[in] definition フォント定義
+	*/
+	bool ParseText(BitmapFont* font, const char* definition)
+	{
+		return font->Parse(definition, strlen(definition));
+	}
+
+	/**
+	* @brief 数値の比較関数
+	* @retval true 誤差の範囲で一致する
+	* @retval false 一致しない
+	*/
+	bool IsNear(float a, float b)
+	{
+		return fabsf(a - b) < 0.001f;
+	}
+
+	/** @brief 正しいフォント定義の解析とカーニングの検証 */
+	void CheckParseAndKerning(const BitmapFont& font)
+	{
+		BenchCheck(font.GetLineHeight() == 20 && font.GetBase() == 16, "common line is parsed");
+		BenchCheck(font.GetPageCount() == 2 && strcmp(font.GetPageFileName(1), "test_1.png") == 0, "quoted page file names are parsed");
+
+		const BitmapGlyph* a = font.FindGlyph('A');
+		const BitmapGlyph* v = font.FindGlyph('V');
+		BenchCheck(a != nullptr && a->Page == 0 && a->Advance == 11, "char without page attribute uses page 0");
+		BenchCheck(v != nullptr && v->Page == 1 && v->OffsetX == -1, "negative offsets are parsed");
+		BenchCheck(v != nullptr && IsNear(v->U0, 32.0f / 128.0f) && IsNear(v->V1, 28.0f / 64.0f), "texture coordinates are normalized by scaleW/scaleH");
+		BenchCheck(font.FindGlyph(0x3042) != nullptr, "non-ASCII glyph is registered");
+		BenchCheck(font.FindGlyph(70000) == nullptr, "codepoints beyond the table are ignored");
+
+		BenchCheck(font.GetKerning('A', 'V') == -2, "first kerning of a duplicated pair wins");
+		BenchCheck(font.GetKerning('V', 'A') == -1, "kerning is ordered by pair");
+		BenchCheck(font.GetKerning('A', 'A') == 0, "zero kerning is not stored");
+		BenchCheck(font.GetKerning('V', 'V') == 0, "unknown pair has no kerning");
+	}
+
+	/** @brief 文字の配置とフォントに含まれない文字の検証 */
+	void CheckLayout(const BitmapFont& font)
+	{
+		// AVはカーニングで2ピクセル詰め、空白は矩形を返さずに進める
+		BitmapFontCursor cursor;
+		BitmapGlyphQuad quad;
+		font.BeginLayout("AV A", 100.0f, 50.0f, 2.0f, &cursor);
+
+		BenchCheck(font.NextQuad(&cursor, &quad) == true && IsNear(quad.Left, 102.0f) && IsNear(quad.Top, 58.0f) && IsNear(quad.Right, 122.0f), "first glyph uses its offset and scale");
+		BenchCheck(font.NextQuad(&cursor, &quad) == true && IsNear(quad.Left, 100.0f + (11.0f - 2.0f - 1.0f) * 2.0f) && quad.Glyph == font.FindGlyph('V'), "kerning pulls V towards A");
+		BenchCheck(font.NextQuad(&cursor, &quad) == true && IsNear(quad.Left, 100.0f + (11.0f - 2.0f + 10.0f + 5.0f + 1.0f) * 2.0f), "space advances without a quad");
+		BenchCheck(font.NextQuad(&cursor, &quad) == false, "layout ends at the terminator");
+
+		// フォントに含まれない文字は読み飛ばし、前後の文字のカーニングも行わない
+		font.BeginLayout("A?V", 0.0f, 0.0f, 1.0f, &cursor);
+		font.NextQuad(&cursor, &quad);
+		BenchCheck(font.NextQuad(&cursor, &quad) == true && IsNear(quad.Left, 11.0f - 1.0f) && quad.Glyph == font.FindGlyph('V'), "missing glyph is skipped and breaks the kerning pair");
+		BenchCheck(font.NextQuad(&cursor, &quad) == false, "missing glyph produces no quad");
+
+		// 改行で行頭に戻り、次の行ではカーニングを行わない
+		font.BeginLayout("A\r\nV", 10.0f, 0.0f, 1.0f, &cursor);
+		font.NextQuad(&cursor, &quad);
+		BenchCheck(font.NextQuad(&cursor, &quad) == true && IsNear(quad.Left, 9.0f) && IsNear(quad.Top, 24.0f), "newline returns to the line start");
+
+		// 不正なUTF-8は置換文字(フォントに含まれない)として読み飛ばす
+		font.BeginLayout("\xE3\x81" "A", 0.0f, 0.0f, 1.0f, &cursor);
+		BenchCheck(font.NextQuad(&cursor, &quad) == true && quad.Glyph == font.FindGlyph('A') && IsNear(quad.Left, 1.0f), "truncated UTF-8 sequence is skipped");
+
+		const char* text = "\xE3\x81\x82";
+		BenchCheck(BitmapFont::DecodeUtf8(&text) == 0x3042 && *text == '\0', "3-byte UTF-8 is decoded");
+		text = "\xC0\xAF";
+		BenchCheck(BitmapFont::DecodeUtf8(&text) == 0xFFFD && text[0] == '\xAF', "overlong UTF-8 is replaced one byte at a time");
+
+		float width = 0.0f;
+		float height = 0.0f;
+		font.MeasureText("AV\nA?A", 1.0f, &width, &height);
+		BenchCheck(IsNear(width, 22.0f) && IsNear(height, 40.0f), "MeasureText returns the widest line and every line height");
+	}
+
+	/** @brief 不正なフォント定義の検証 */
+	void CheckMalformed()
+	{
+		const char* common = "common lineHeight=20 base=16 scaleW=128 scaleH=64 pages=1\n";
+		const char* page = "page id=0 file=\"test_0.png\"\n";
+		const char* glyph = "char id=65 x=0 y=0 width=10 height=12 xoffset=1 yoffset=4 xadvance=11\n";
+
+		struct MalformedCase
+		{
+			std::string Definition;
+			const char* Description;
+		};
+		const MalformedCase case_list[] =
+		{
+			{ std::string(page) + glyph, "missing common line is rejected" },
+			{ std::string("common lineHeight=20 base=16 scaleW=128 pages=1\n") + page, "common line without scaleH is rejected" },
+			{ std::string("common lineHeight=20 base=16 scaleW=0 scaleH=64 pages=1\n") + page, "zero texture width is rejected" },
+			{ std::string(common), "missing page line is rejected" },
+			{ std::string(common) + "page id=0 file=\"\"\n", "empty page file name is rejected" },
+			{ std::string(common) + "page id=16 file=\"a.png\"\n", "page id beyond the limit is rejected" },
+			{ std::string(common) + page + "page id=1 file=\"b.png\"\n", "page count mismatch is rejected" },
+			{ std::string(common) + page + "char id=65 x=0 y=0 width=10 height=12 xoffset=1 yoffset=4\n", "char without xadvance is rejected" },
+			{ std::string(common) + page + "char id=65 x=0 y=abc width=10 height=12 xoffset=1 yoffset=4 xadvance=11\n", "non-numeric char value is rejected" },
+			{ std::string(common) + page + "char id=65 x=0 y=0 width=10 height=12 xoffset=1 yoffset=4 xadvance=11 page=1\n", "char on a missing page is rejected" },
+			{ std::string(common) + page + glyph + "kerning first=65 amount=-1\n", "kerning without second is rejected" },
+		};
+
+		for (const MalformedCase& malformed : case_list)
+		{
+			BitmapFont font;
+			BenchCheck(font.Parse(malformed.Definition.c_str(), malformed.Definition.size()) == false, malformed.Description);
+			BenchCheck(font.GetPageCount() == 0 && font.FindGlyph('A') == nullptr, "failed parse leaves the font empty");
+		}
+
+		// 知らない行や空行、行頭の空白は無視する
+		std::string tolerant = std::string("\n  ") + common + "unknown key=1\n\n" + page + "chars count=1\n\t" + glyph;
+		BitmapFont font;
+		BenchCheck(font.Parse(tolerant.c_str(), tolerant.size()) == true && font.FindGlyph('A') != nullptr, "unknown and blank lines are ignored");
+
+		// 失敗した解析は以前の内容も消す
+		BenchCheck(ParseText(&font, glyph) == false && font.FindGlyph('A') == nullptr, "failed parse clears the previous font");
+		BenchCheck(font.Parse(nullptr, 0) == false, "null data is rejected");
+	}
+}
+
+void RunBitmapFontBench()
+{
+	BitmapFont font;
+	BenchCheck(ParseText(&font, TestFontDefinition) == true, "parse test font definition");
+
+	CheckParseAndKerning(font);
+	CheckLayout(font);
+	CheckMalformed();
+
+	// カーニングの組み合わせと空白、改行を含む長い文字列
+	std::string text;
+	text.reserve(BenchTextLength);
+	const char pattern[] = "AVAV A\xE3\x81\x82V\n";
+	while (text.size() + sizeof(pattern) < BenchTextLength)
+	{
+		text += pattern;
+	}
+
+	int quad_count = 0;
+	BenchTimer timer;
+	for (int i = 0; i < BenchRepeatCount; i++)
+	{
+		BitmapFontCursor cursor;
+		BitmapGlyphQuad quad;
+		font.BeginLayout(text.c_str(), 0.0f, 0.0f, 1.0f, &cursor);
+		while (font.NextQuad(&cursor, &quad) == true)
+		{
+			quad_count++;
+		}
+	}
+	double layout_time = timer.GetElapsedTime() / BenchRepeatCount;
+
+	float width = 0.0f;
+	float height = 0.0f;
+	timer.Reset();
+	for (int i = 0; i < BenchRepeatCount; i++)
+	{
+		font.MeasureText(text.c_str(), 1.0f, &width, &height);
+	}
+	double measure_time = timer.GetElapsedTime() / BenchRepeatCount;
+
+	BenchCheck(quad_count == BenchRepeatCount * 7 * (int)(text.size() / (sizeof(pattern) - 1)), "every visible glyph produces a quad");
+
+	printf("  NextQuad (%d bytes):    %8.3f ms (%d quads)\n", (int)text.size(), layout_time, quad_count / BenchRepeatCount);
+	printf("  MeasureText (%d bytes): %8.3f ms (%.0f x %.0f)\n", (int)text.size(), measure_time, width, height);
+
+	font.Clear();
+}
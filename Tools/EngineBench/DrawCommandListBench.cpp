@@ -0,0 +1,194 @@
+﻿/**
+* @file DrawCommandListBench.cpp
+* @brief <pre>
+* 遅延描画の命令リストの並び替えのベンチマークと検証
+* 10万個の命令を並び替え、レイヤー順、重なる命令の記録順、テクスチャのまとまりを検証し、
+* 並び替えの時間をソートキーのstd::sortと比較する
+* </pre>
+*/
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+#include "EngineBench.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/DrawCommandList.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/FrameAllocator.h"
+
+namespace
+{
+	const int ScreenWidth = 1280;				//!< 重なり判定を行う範囲の横幅
+	const int ScreenHeight = 720;				//!< 重なり判定を行う範囲の縦幅
+	const int BenchCommandCount = 100000;		//!< 計測する命令数
+	const int BenchLayerCount = 8;				//!< 使用するレイヤー数
+	const int BenchTextureCount = 16;			//!< 使用するテクスチャ数
+	const int BenchRepeatCount = 50;			//!< 計測の繰り返し回数
+	const float SpriteSize = 16.0f;				//!< 命令の矩形のサイズ
+
+	/**
+	* @brief 矩形の命令の追加関数
+	* @param[out] command_list 追加先の命令リスト
+	* @param[in] texture 使用するテクスチャ
+	* @param[in] layer 描画レイヤー
+	* @param[in] x 左端
+	* @param[in] y 上端
+	*/
+	void AddQuad(DrawCommandList* command_list, const Texture* texture, int layer, float x, float y)
+	{
+		CustomVertex* v = command_list->AddCommand(texture, 6, layer, TextureFilterPoint);
+		const float corner_x[6] = { 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f };
+		const float corner_y[6] = { 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f };
+		for (int i = 0; i < 6; i++)
+		{
+			v[i].X = x + corner_x[i] * SpriteSize;
+			v[i].Y = y + corner_y[i] * SpriteSize;
+			v[i].Z = 0.0f;
+			v[i].Rhw = 1.0f;
+			v[i].Color = 0xffffffff;
+			v[i].TextureX = corner_x[i];
+			v[i].TexrureY = corner_y[i];
+		}
+	}
+
+	/**
+	* @brief テクスチャの切り替え回数の取得関数
+	* @retval int 並び替え後に隣り合う命令でテクスチャが変わる回数
+	* @param[in] command_list 並び替え済みの命令リスト
+	*/
+	int CountTextureSwitches(const DrawCommandList& command_list)
+	{
+		int switch_count = 0;
+		for (int i = 1; i < command_list.GetCount(); i++)
+		{
+			if (command_list.GetSortedCommand(i).TextureData != command_list.GetSortedCommand(i - 1).TextureData)
+			{
+				switch_count++;
+			}
+		}
+		return switch_count;
+	}
+
+	/**
+	* @brief 並び替えの検証
+	* @param[in] allocator 作業領域に使用するフレームアロケーター
+	*/
+	void CheckSort(FrameAllocator* allocator)
+	{
+		Texture texture_a = { nullptr, 64, 64 };
+		Texture texture_b = { nullptr, 64, 64 };
+
+		// 重なる命令は記録順を保ち、重ならない命令はテクスチャごとにまとめる
+		DrawCommandList command_list;
+		AddQuad(&command_list, &texture_a, 0, 0.0f, 0.0f);
+		AddQuad(&command_list, &texture_b, 0, 4.0f, 4.0f);
+		AddQuad(&command_list, &texture_a, 0, 8.0f, 8.0f);
+		AddQuad(&command_list, &texture_b, 0, 500.0f, 300.0f);
+		AddQuad(&command_list, &texture_a, 0, 900.0f, 600.0f);
+		command_list.Sort((float)ScreenWidth, (float)ScreenHeight, allocator);
+
+		const Texture* expected[5] = { &texture_a, &texture_a, &texture_b, &texture_b, &texture_a };
+		bool is_expected = command_list.GetCount() == 5;
+		for (int i = 0; i < command_list.GetCount() && is_expected == true; i++)
+		{
+			is_expected = command_list.GetSortedCommand(i).TextureData == expected[i];
+		}
+		BenchCheck(is_expected == true, "overlapping commands keep painter's order, separate ones group by texture");
+		BenchCheck(command_list.GetSortedCommand(4).FirstVertex == 2 * 6, "third overlapping command stays after the second");
+
+		// レイヤーは記録順に関係なく昇順に並ぶ
+		command_list.Clear();
+		AddQuad(&command_list, &texture_a, 2, 0.0f, 0.0f);
+		AddQuad(&command_list, &texture_a, 0, 100.0f, 0.0f);
+		AddQuad(&command_list, &texture_a, 1, 200.0f, 0.0f);
+		command_list.Sort((float)ScreenWidth, (float)ScreenHeight, allocator);
+		BenchCheck(command_list.GetSortedCommand(0).Layer == 0 &&
+			command_list.GetSortedCommand(1).Layer == 1 &&
+			command_list.GetSortedCommand(2).Layer == 2, "layers are drawn in ascending order");
+
+		command_list.Release();
+		allocator->NextFrame();
+
+		// 基数ソートはstd::sortと同じ結果になる
+		std::vector<unsigned long long> keys(10000);
+		unsigned long long seed = 88172645463325252ULL;
+		for (unsigned long long& key : keys)
+		{
+			seed ^= seed << 13;
+			seed ^= seed >> 7;
+			seed ^= seed << 17;
+			key = seed;
+		}
+		std::vector<unsigned long long> expected_keys = keys;
+		std::vector<unsigned long long> temp(keys.size());
+		std::sort(expected_keys.begin(), expected_keys.end());
+		DrawCommandList::RadixSort(&keys[0], &temp[0], (int)keys.size());
+		BenchCheck(keys == expected_keys, "radix sort matches std::sort");
+	}
+}
+
+void RunDrawCommandListBench()
+{
+	FrameAllocator allocator;
+	BenchCheck(allocator.Initialize(DefaultFrameAllocatorSize), "initialize frame allocator");
+
+	CheckSort(&allocator);
+
+	Texture texture_list[BenchTextureCount];
+	for (Texture& texture : texture_list)
+	{
+		texture = { nullptr, 64, 64 };
+	}
+
+	// 画面全体に散らばった命令を、テクスチャとレイヤーを入れ替えながら記録する
+	DrawCommandList command_list;
+	unsigned int seed = 12345;
+	for (int i = 0; i < BenchCommandCount; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		float x = (float)((seed >> 8) % (ScreenWidth - (int)SpriteSize));
+		seed = seed * 1103515245 + 12345;
+		float y = (float)((seed >> 8) % (ScreenHeight - (int)SpriteSize));
+		AddQuad(&command_list, &texture_list[i % BenchTextureCount], i % BenchLayerCount, x, y);
+	}
+
+	BenchTimer timer;
+	for (int i = 0; i < BenchRepeatCount; i++)
+	{
+		command_list.Sort((float)ScreenWidth, (float)ScreenHeight, &allocator);
+		allocator.NextFrame();
+	}
+	double sort_time = timer.GetElapsedTime() / BenchRepeatCount;
+
+	int switch_count = CountTextureSwitches(command_list);
+
+	bool is_layer_ordered = true;
+	for (int i = 1; i < command_list.GetCount(); i++)
+	{
+		is_layer_ordered = is_layer_ordered && command_list.GetSortedCommand(i - 1).Layer <= command_list.GetSortedCommand(i).Layer;
+	}
+	BenchCheck(is_layer_ordered == true, "100k commands are sorted by layer");
+	BenchCheck(switch_count < BenchCommandCount / 2, "sorting reduces texture switches");
+
+	// 比較用に、同じ数のソートキーをstd::sortで並び替える(重なり判定とキーの作成は含まない)
+	std::vector<unsigned long long> keys(BenchCommandCount);
+	double std_sort_time = 0.0;
+	for (int i = 0; i < BenchRepeatCount; i++)
+	{
+		for (int k = 0; k < BenchCommandCount; k++)
+		{
+			const DrawCommand& command = command_list.GetCommand(k);
+			keys[k] = DrawCommandList::MakeSortKey(command.Layer, k % 64, (int)(command.TextureData - texture_list), k);
+		}
+
+		timer.Reset();
+		std::sort(keys.begin(), keys.end());
+		std_sort_time += timer.GetElapsedTime();
+	}
+	std_sort_time /= BenchRepeatCount;
+
+	printf("  Sort x%d (%d layers, %d tex): %8.3f ms (%.1f M commands/s), %d texture switches (unsorted %d)\n",
+		BenchCommandCount, BenchLayerCount, BenchTextureCount, sort_time,
+		sort_time > 0.0 ? BenchCommandCount / sort_time / 1000.0 : 0.0, switch_count, BenchCommandCount - 1);
+	printf("  std::sort of the keys only:        %8.3f ms\n", std_sort_time);
+
+	command_list.Release();
+	allocator.Release();
+}
@@ -0,0 +1,219 @@
+﻿/**
+* @file DrawCommandRecorderBench.cpp
+* @brief <pre>
+* ワーカースレッドでの描画命令の記録のベンチマークと検証
+* DrawCommandRecorderの矩形がGraphicsの描画と同じ頂点になること、ParallelDrawRecorder::Mergeの連結順を検証し、
+* 矩形の記録を1つのスレッドで行った場合と、複数のスレッドで記録して統合した場合の時間を比較する
+* </pre>
+*/
+#include <math.h>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+#include "EngineBench.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/DrawCommandRecorder.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/Graphics.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/RecordingRenderBackend.h"
+
+namespace
+{
+	const int ScreenWidth = 1280;				//!< 画面の横幅
+	const int ScreenHeight = 720;				//!< 画面の縦幅
+	const int BenchRecorderCount = 4;			//!< 計測で使用するスレッド数
+	const int BenchRectCount = 100000;			//!< 1フレームに記録する矩形の数
+	const int BenchRepeatCount = 20;			//!< 計測の繰り返し回数
+
+	/**
+	* @brief 座標の比較関数
+	* @retval true 誤差の範囲で一致する
+	* @retval false 一致しない
+	* @param[in] a 比較する頂点
+	* @param[in] b 比較する頂点
+	*/
+	bool IsNearPosition(const CustomVertex& a, const CustomVertex& b)
+	{
+		return fabsf(a.X - b.X) < 0.01f && fabsf(a.Y - b.Y) < 0.01f;
+	}
+
+	/**
+	* @brief 矩形の記録関数
+	* @details 番号から決まる位置に矩形を記録する(スレッドごとに範囲を分けて呼び出す)
+	* @param[in,out] recorder 記録先
+	* @param[in] first 最初の番号
+	* @param[in] count 記録する数
+	*/
+	void RecordRects(DrawCommandRecorder* recorder, int first, int count)
+	{
+		for (int i = first; i < first + count; i++)
+		{
+			float x = (float)((i * 7) % ScreenWidth);
+			float y = (float)((i * 13) % ScreenHeight);
+			recorder->RecordRect(x, y, 16.0f, 16.0f, 0x00ffffff, 255, (float)(i % 360), 1.0f, 1.0f);
+		}
+	}
+
+	/** @brief Graphicsの描画と同じ頂点になることの検証 */
+	void CheckSameAsGraphics()
+	{
+		std::unique_ptr<Graphics> graphics = CreateBenchGraphics();
+		BenchCheck(graphics->Initialize(ScreenWidth, ScreenHeight, true, RenderBackendType::RenderBackendTypeRecording), "initialize recording backend");
+
+		RecordingRenderBackend* backend = (RecordingRenderBackend*)graphics->GetBackend();
+		if (backend == nullptr)
+		{
+			return;
+		}
+
+		// 全ての軸で、拡縮と回転を含めてGraphics::DrawRectと同じ頂点を記録する
+		bool is_same = true;
+		DrawCommandRecorder recorder;
+		for (int pivot = 0; pivot < PivotType::MaxPivotType; pivot++)
+		{
+			graphics->SetPivotType((PivotType)pivot);
+			graphics->StartDraw(0);
+			graphics->DrawRect(300.0f, 200.0f, 40.0f, 24.0f, 0x00ff0000, 255, 30.0f, 1.5f, 0.5f);
+			graphics->FinishDraw();
+
+			recorder.Clear();
+			recorder.SetPivotType((PivotType)pivot);
+			recorder.RecordRect(300.0f, 200.0f, 40.0f, 24.0f, 0x00ff0000, 255, 30.0f, 1.5f, 0.5f);
+
+			const std::vector<CustomVertex>& expected = backend->GetVertices();
+			const DrawCommandList& command_list = recorder.GetCommandList();
+			if (expected.size() != 6 || command_list.GetCount() != 1 || command_list.GetCommand(0).VertexCount != 6)
+			{
+				is_same = false;
+				continue;
+			}
+
+			const CustomVertex* vertices = command_list.GetVertices(command_list.GetCommand(0));
+			for (int i = 0; i < 6; i++)
+			{
+				is_same = is_same && IsNearPosition(vertices[i], expected[i]) && vertices[i].Color == expected[i].Color;
+			}
+		}
+		BenchCheck(is_same == true, "recorded rects match Graphics::DrawRect for every pivot");
+		graphics->SetPivotType(PivotType::LeftTop);
+
+		recorder.SetLayer(DrawLayerCount + 5);
+		recorder.RecordRect(0.0f, 0.0f, 1.0f, 1.0f, 0, 255, 0.0f, 1.0f, 1.0f);
+		BenchCheck(recorder.GetCommandList().GetCommand(recorder.GetCommandList().GetCount() - 1).Layer == DrawLayerCount - 1, "out of range layer is clamped");
+
+		graphics->Release();
+	}
+
+	/** @brief 複数のレコーダーの統合の検証 */
+	void CheckMerge()
+	{
+		ParallelDrawRecorder parallel;
+		parallel.Initialize(3);
+		BenchCheck(parallel.GetRecorder(3) == nullptr && parallel.GetRecorder(-1) == nullptr, "out of range recorder is nullptr");
+
+		Texture texture_list[3] = { { nullptr, 16, 16 }, { nullptr, 16, 16 }, { nullptr, 16, 16 } };
+
+		// 後の番号のレコーダーから先に記録を終えても、統合はレコーダーの番号順になる
+		for (int index = 2; index >= 0; index--)
+		{
+			std::thread worker([&parallel, &texture_list, index]()
+			{
+				DrawCommandRecorder* recorder = parallel.GetRecorder(index);
+				recorder->SetLayer(index);
+				for (int i = 0; i <= index; i++)
+				{
+					recorder->RecordTexture((float)(index * 100 + i), 0.0f, &texture_list[index], 255, 0.0f, 1.0f, 1.0f);
+				}
+			});
+			worker.join();
+		}
+
+		// 統合先に記録済みの命令は先頭に残る
+		DrawCommandList merged;
+		merged.AddCommand(nullptr, 3, 0, TextureFilterPoint);
+		parallel.Merge(&merged);
+
+		BenchCheck(merged.GetCount() == 1 + 1 + 2 + 3, "merge appends every recorded command");
+		bool is_ordered = merged.GetCount() == 7 && merged.GetCommand(0).TextureData == nullptr;
+		int command_index = 1;
+		for (int index = 0; index < 3 && is_ordered == true; index++)
+		{
+			for (int i = 0; i <= index; i++)
+			{
+				const DrawCommand& command = merged.GetCommand(command_index++);
+				is_ordered = is_ordered &&
+					command.TextureData == &texture_list[index] &&
+					command.Layer == index &&
+					merged.GetVertices(command)[0].X == (float)(index * 100 + i);
+			}
+		}
+		BenchCheck(is_ordered == true, "merge keeps recorder order, record order, layers and vertex positions");
+
+		// Clearで全てのレコーダーの記録を消す
+		parallel.Clear();
+		DrawCommandList empty;
+		parallel.Merge(&empty);
+		BenchCheck(empty.GetCount() == 0, "Clear removes every recorded command");
+
+		merged.Release();
+		parallel.Release();
+	}
+}
+
+void RunDrawCommandRecorderBench()
+{
+	CheckSameAsGraphics();
+	CheckMerge();
+
+	DrawCommandRecorder single;
+	BenchTimer timer;
+	for (int i = 0; i < BenchRepeatCount; i++)
+	{
+		single.Clear();
+		RecordRects(&single, 0, BenchRectCount);
+	}
+	double single_time = timer.GetElapsedTime() / BenchRepeatCount;
+
+	ParallelDrawRecorder parallel;
+	parallel.Initialize(BenchRecorderCount);
+	DrawCommandList merged;
+	int rect_per_recorder = BenchRectCount / BenchRecorderCount;
+
+	timer.Reset();
+	for (int i = 0; i < BenchRepeatCount; i++)
+	{
+		parallel.Clear();
+
+		std::vector<std::thread> worker_list;
+		for (int index = 0; index < BenchRecorderCount; index++)
+		{
+			worker_list.emplace_back(RecordRects, parallel.GetRecorder(index), index * rect_per_recorder, rect_per_recorder);
+		}
+		for (std::thread& worker : worker_list)
+		{
+			worker.join();
+		}
+
+		merged.Clear();
+		parallel.Merge(&merged);
+	}
+	double parallel_time = timer.GetElapsedTime() / BenchRepeatCount;
+
+	// 同じ範囲を記録しているので、統合した結果は1つのスレッドで記録したものと同じになる
+	bool is_same = merged.GetCount() == single.GetCommandList().GetCount();
+	for (int i = 0; i < merged.GetCount() && is_same == true; i += 997)
+	{
+		const DrawCommandList& single_list = single.GetCommandList();
+		is_same = IsNearPosition(merged.GetVertices(merged.GetCommand(i))[0], single_list.GetVertices(single_list.GetCommand(i))[0]);
+	}
+	BenchCheck(is_same == true, "merged parallel recording matches single-thread recording");
+
+	printf("  record %d rects, 1 thread:          %8.3f ms\n", BenchRectCount, single_time);
+	printf("  record %d rects, %d threads + Merge: %8.3f ms (x%.2f)\n", BenchRectCount, BenchRecorderCount, parallel_time, parallel_time > 0.0 ? single_time / parallel_time : 0.0);
+
+	if (std::thread::hardware_concurrency() < 2)
+	{
+		printf("  (single core: the threads cannot record in parallel)\n");
+	}
+
+	merged.Release();
+	parallel.Release();
+}
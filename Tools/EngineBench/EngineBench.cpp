@@ -0,0 +1,133 @@
+﻿/**
+* @file EngineBench.cpp
+* @brief <pre>
+* GPUやウィンドウなしでエンジンの処理時間を計測し、結果を検証するツール
+* 使い方：EngineBench [ベンチマーク名...]
+*   ベンチマーク名を省略した場合は全て実行する(例：EngineBench render)
+*   ゲームと同じくDirectX2DLibraryCppフォルダを作業フォルダにして実行する
+*   検証に1つでも失敗した場合は終了コードが1になる
+* </pre>
+*/
+#include <stdio.h>
+#include <string.h>
+#include "EngineBench.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/Graphics.h"
+
+namespace
+{
+	/** @brief ベンチマークの情報 */
+	struct BenchEntry
+	{
+		const char* Name;		//!< コマンドラインで指定する名前
+		void (*Function)();		//!< 実行関数
+	};
+
+	const BenchEntry BenchList[] =
+	{
+		{ "render", RunRenderBench },
+		{ "tilemap", RunTilemapBench },
+		{ "particle", RunParticleBench },
+		{ "jobsystem", RunJobSystemBench },
+		{ "texcache", RunTextureCacheBench },
+		{ "preload", RunPreloadBench },
+		{ "archive", RunAssetArchiveBench },
+		{ "frame", RunFrameAllocatorBench },
+		{ "sort", RunDrawCommandListBench },
+		{ "renderthread", RunRenderThreadBench },
+		{ "mipmap", RunMipmapBench },
+		{ "texmanager", RunTextureManagerBench },
+		{ "bitmapfont", RunBitmapFontBench },
+		{ "recorder", RunDrawCommandRecorderBench },
+	};
+
+	int g_FailureCount = 0;		//!< 検証に失敗した数
+
+	/**
+	* @brief ベンチマークの実行対象の確認関数
+	* @retval true 実行する
+	* @retval false 実行しない
+	* @param[in] name ベンチマーク名
+	* @param[in] argc コマンドライン引数の数
+	* @param[in] argv コマンドライン引数
+	*/
+	bool IsSelected(const char* name, int argc, char* argv[])
+	{
+		if (argc < 2)
+		{
+			return true;
+		}
+
+		for (int i = 1; i < argc; i++)
+		{
+			if (strcmp(argv[i], name) == 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
+
+void BenchCheck(bool condition, const char* description)
+{
+	if (condition == true)
+	{
+		return;
+	}
+
+	printf("  FAILED: %s\n", description);
+	g_FailureCount++;
+}
+
+bool WriteBenchFile(const char* file_name, const void* data, size_t size)
+{
+	FILE* fp = nullptr;
+	if (fopen_s(&fp, file_name, "wb") != 0)
+	{
+		return false;
+	}
+
+	bool is_succeeded = size == 0 || fwrite(data, size, 1, fp) == 1;
+	fclose(fp);
+
+	return is_succeeded;
+}
+
+std::unique_ptr<Graphics> CreateBenchGraphics()
+{
+	return std::unique_ptr<Graphics>(new Graphics());
+}
+
+int main(int argc, char* argv[])
+{
+	int run_count = 0;
+
+	for (const BenchEntry& entry : BenchList)
+	{
+		if (IsSelected(entry.Name, argc, argv) == false)
+		{
+			continue;
+		}
+
+		printf("[%s]\n", entry.Name);
+		entry.Function();
+		run_count++;
+	}
+
+	if (run_count == 0)
+	{
+		printf("usage: EngineBench [benchmark...]\n");
+		printf("benchmarks:");
+		for (const BenchEntry& entry : BenchList)
+		{
+			printf(" %s", entry.Name);
+		}
+		printf("\n");
+		return 1;
+	}
+
+	printf("%d failure(s)\n", g_FailureCount);
+
+	return g_FailureCount == 0 ? 0 : 1;
+}
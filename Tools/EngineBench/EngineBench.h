@@ -0,0 +1,122 @@
+﻿/**
+* @file EngineBench.h
+* @brief <pre>
+* EngineBenchの各ベンチマークで共通に使用する計測と検証の宣言
+* ベンチマークはGPUやウィンドウなしで実行できるように、Graphicsを単体でNull描画バックエンドなどで初期化して使用する
+* </pre>
+*/
+#ifndef ENGINE_BENCH_H_
+#define ENGINE_BENCH_H_
+
+#include <Windows.h>
+#include <memory>
+
+class Graphics;
+
+const char BenchWorkDirectory[] = "BenchWork";	//!< ベンチマークで作成するファイルを置くフォルダ(作業フォルダからの相対パス)
+
+/** @brief 経過時間の計測クラス */
+class BenchTimer
+{
+public:
+	/** Constructor */
+	BenchTimer() :
+		m_Frequency(),
+		m_StartCounter()
+	{
+		QueryPerformanceFrequency(&m_Frequency);
+		Reset();
+	}
+
+	/** @brief 計測の開始関数 */
+	void Reset()
+	{
+		QueryPerformanceCounter(&m_StartCounter);
+	}
+
+	/**
+	* @brief 経過時間の取得関数
+	* @retval double Resetからの経過時間(ミリ秒)
+	*/
+	double GetElapsedTime() const
+	{
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter(&counter);
+
+		return (double)(counter.QuadPart - m_StartCounter.QuadPart) * 1000.0 / (double)m_Frequency.QuadPart;
+	}
+
+private:
+	LARGE_INTEGER m_Frequency;		//!< カウンターの周波数
+	LARGE_INTEGER m_StartCounter;	//!< 計測を開始した時のカウンターの値
+};
+
+/**
+* @brief 検証関数
+* @details 条件が成り立たない場合は失敗として出力し、失敗数に加える(失敗があった場合は終了コードが1になる)
+* @param[in] condition 検証する条件
+* @param[in] description 検証内容の説明
+*/
+void BenchCheck(bool condition, const char* description);
+
+/**
+* @brief ファイルの書き込み関数
+* @details ベンチマークで使用するファイルを作成する(既にある場合は上書きする)
+* @retval true 書き込み成功
+* @retval false 書き込み失敗
+* @param[in] file_name ファイル名
+* @param[in] data 書き込む内容
+* @param[in] size バイト数
+*/
+bool WriteBenchFile(const char* file_name, const void* data, size_t size);
+
+/**
+* @brief ベンチマークで使用するGraphicsの作成関数
+* @details Graphicsはバッチの頂点配列(約340KB)をメンバに持つので、スタックではなくヒープに作成する(初期化は呼び出し側で行う)
+* @retval std::unique_ptr<Graphics> 作成したGraphics
+*/
+std::unique_ptr<Graphics> CreateBenchGraphics();
+
+/** @brief 描画(Null、Recording描画バックエンド)のベンチマークと検証 */
+void RunRenderBench();
+
+/** @brief タイルマップのチャンク作成と描画のベンチマークと検証 */
+void RunTilemapBench();
+
+/** @brief パーティクルの1コアでの更新と描画のベンチマークと検証 */
+void RunParticleBench();
+
+/** @brief ジョブシステムとパーティクルの並列更新のベンチマークと検証 */
+void RunJobSystemBench();
+
+/** @brief テクスチャキャッシュの起動時間のベンチマークとヘッダーの検証 */
+void RunTextureCacheBench();
+
+/** @brief アセットの一括読み込みのワーカー数ごとのベンチマークと検証 */
+void RunPreloadBench();
+
+/** @brief アーカイブの読み込みのベンチマークと、ディレクトリとLZ4の展開の検証 */
+void RunAssetArchiveBench();
+
+/** @brief ワーカースレッドでの描画命令の記録と統合の検証 */
+void RunDrawCommandRecorderBench();
+
+/** @brief ビットマップフォントの解析と文字配置の検証 */
+void RunBitmapFontBench();
+
+/** @brief テクスチャの予算による解放と読み込み直しの検証 */
+void RunTextureManagerBench();
+
+/** @brief ミップマップの縮小のSSE2とスカラーの比較 */
+void RunMipmapBench();
+
+/** @brief 描画スレッドの有無による1フレームの時間の比較 */
+void RunRenderThreadBench();
+
+/** @brief 遅延描画の命令リストの並び替えの検証と、10万命令の並び替えのベンチマーク */
+void RunDrawCommandListBench();
+
+/** @brief フレームアロケーターの検証と、malloc/freeとの確保時間の比較 */
+void RunFrameAllocatorBench();
+
+#endif
@@ -0,0 +1,162 @@
+﻿/**
+* @file FrameAllocatorBench.cpp
+* @brief <pre>
+* フレームアロケーターのベンチマークと検証
+* アライメント、次のフレームまでの有効期間、容量を超えた場合の拡張を検証し、
+* 1フレームの一時メモリの確保と破棄をmalloc/freeと比較する
+* </pre>
+*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "EngineBench.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/FrameAllocator.h"
+
+namespace
+{
+	const size_t BenchCapacity = 256 * 1024;	//!< 検証と計測で使用するバッファの容量
+	const int BenchFrameCount = 1000;			//!< 計測するフレーム数
+	const int BenchAllocationCount = 1000;		//!< 1フレームの確保回数
+
+	/**
+	* @brief 確保するバイト数の取得関数
+	* @details 頂点配列や文字列の作業領域を想定して16～1024バイトの間で変える
+	* @retval size_t バイト数
+	* @param[in] index 確保の番号
+	*/
+	size_t GetAllocationSize(int index)
+	{
+		return 16 + (size_t)((index * 37) % 64) * 16;
+	}
+
+	/**
+	* @brief フレームアロケーターの動作の検証
+	*/
+	void CheckFrameAllocator()
+	{
+		FrameAllocator allocator;
+		BenchCheck(allocator.Initialize(BenchCapacity) == true, "initialize frame allocator");
+
+		BenchCheck(allocator.Allocate(16, 0) == nullptr, "alignment 0 is rejected");
+		BenchCheck(allocator.Allocate(16, 24) == nullptr, "non power of two alignment is rejected");
+
+		bool is_aligned = true;
+		const size_t alignment_list[] = { 1, 4, 16, 64, 4096 };
+		for (size_t alignment : alignment_list)
+		{
+			allocator.Allocate(3, 1);
+			void* memory = allocator.Allocate(8, alignment);
+			is_aligned = is_aligned && memory != nullptr && ((uintptr_t)memory & (alignment - 1)) == 0;
+		}
+		BenchCheck(is_aligned == true, "allocations honour the requested alignment");
+
+		// フレームNで確保したメモリはフレームN+1でも内容が残る
+		const int PatternSize = 1024;
+		unsigned char* pattern = allocator.AllocateArray<unsigned char>(PatternSize);
+		memset(pattern, 0x5A, PatternSize);
+		allocator.NextFrame();
+		unsigned char* next_frame = allocator.AllocateArray<unsigned char>(PatternSize);
+		memset(next_frame, 0xA5, PatternSize);
+
+		bool is_kept = true;
+		for (int i = 0; i < PatternSize; i++)
+		{
+			is_kept = is_kept && pattern[i] == 0x5A;
+		}
+		BenchCheck(is_kept == true, "memory stays valid through the next frame");
+		allocator.NextFrame();
+
+		// 容量を超えた分はヒープから確保し、そのバッファを次に空にする時に広げる
+		void* overflow = allocator.Allocate(BenchCapacity * 2, DefaultFrameAlignment);
+		BenchCheck(overflow != nullptr, "allocation larger than the capacity succeeds");
+		allocator.NextFrame();
+		BenchCheck(allocator.GetStats().OverflowCount == 1, "overflow is reported");
+		BenchCheck(allocator.GetStats().HighWaterMark >= BenchCapacity * 2, "high water mark includes the overflow");
+
+		allocator.NextFrame();
+		allocator.Allocate(BenchCapacity * 2, DefaultFrameAlignment);
+		allocator.NextFrame();
+		BenchCheck(allocator.GetStats().OverflowCount == 0, "grown buffer serves the same frame size without the heap");
+
+		allocator.Release();
+	}
+
+	/**
+	* @brief フレームアロケーターの計測
+	* @retval double 1回の確保の時間(ナノ秒)
+	*/
+	double MeasureFrameAllocator()
+	{
+		FrameAllocator allocator;
+		allocator.Initialize(BenchCapacity);
+
+		// 最適化で確保が省略されないように、確保した領域に書き込んだ値を集計する
+		unsigned int checksum = 0;
+
+		BenchTimer timer;
+		for (int frame = 0; frame < BenchFrameCount; frame++)
+		{
+			for (int i = 0; i < BenchAllocationCount; i++)
+			{
+				unsigned char* memory = (unsigned char*)allocator.Allocate(GetAllocationSize(i), DefaultFrameAlignment);
+				memory[0] = (unsigned char)i;
+				checksum += memory[0];
+			}
+			allocator.NextFrame();
+		}
+		double elapsed_time = timer.GetElapsedTime();
+
+		BenchCheck(allocator.GetStats().OverflowCount == 0, "benchmark frame fits in the frame allocator");
+		BenchCheck(checksum != 0, "frame allocator checksum");
+
+		allocator.Release();
+
+		return elapsed_time * 1000000.0 / ((double)BenchFrameCount * BenchAllocationCount);
+	}
+
+	/**
+	* @brief malloc/freeの計測
+	* @details フレームの終わりにまとめて解放する(フレームアロケーターと同じ寿命)
+	* @retval double 1回の確保と解放の時間(ナノ秒)
+	*/
+	double MeasureMalloc()
+	{
+		std::vector<void*> block_list(BenchAllocationCount);
+		unsigned int checksum = 0;
+
+		BenchTimer timer;
+		for (int frame = 0; frame < BenchFrameCount; frame++)
+		{
+			for (int i = 0; i < BenchAllocationCount; i++)
+			{
+				unsigned char* memory = (unsigned char*)malloc(GetAllocationSize(i));
+				memory[0] = (unsigned char)i;
+				checksum += memory[0];
+				block_list[i] = memory;
+			}
+			for (void* block : block_list)
+			{
+				free(block);
+			}
+		}
+		double elapsed_time = timer.GetElapsedTime();
+
+		BenchCheck(checksum != 0, "malloc checksum");
+
+		return elapsed_time * 1000000.0 / ((double)BenchFrameCount * BenchAllocationCount);
+	}
+}
+
+void RunFrameAllocatorBench()
+{
+	CheckFrameAllocator();
+
+	double frame_time = MeasureFrameAllocator();
+	double malloc_time = MeasureMalloc();
+
+	printf("  %d allocations x %d frames (16-1024 bytes)\n", BenchAllocationCount, BenchFrameCount);
+	printf("  FrameAllocator: %7.2f ns/allocation\n", frame_time);
+	printf("  malloc/free   : %7.2f ns/allocation (x%.2f)\n", malloc_time, frame_time > 0.0 ? malloc_time / frame_time : 0.0);
+}
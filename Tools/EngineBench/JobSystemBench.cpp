@@ -0,0 +1,199 @@
+﻿/**
+* @file JobSystemBench.cpp
+* @brief <pre>
+* ジョブシステムのベンチマークと検証
+* ワーカー数を変えながら、並列ループ、依存関係、ジョブの中からのジョブの追加を検証し、
+* 小さいジョブ1個あたりのオーバーヘッドと、10万個のパーティクルの更新時間のスケーリングを計測する
+* </pre>
+*/
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "EngineBench.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/JobSystem.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/ParticleEmitter.h"
+
+namespace
+{
+	const int BenchParticleCount = 100000;	//!< 計測するパーティクル数
+	const int BenchFrameCount = 200;		//!< 計測するフレーム数
+	const int DependencyJobCount = 64;		//!< 依存関係の検証で先に実行するジョブの数
+	const int NestedJobCount = 50;			//!< ジョブの中からジョブを追加する検証の親ジョブの数
+	const int NestedChildCount = 100;		//!< 親ジョブ1個が追加する子ジョブの数
+
+	/** @brief 検証用のジョブで共有するデータ */
+	struct JobTestData
+	{
+		JobSystem* System;					//!< 使用中のジョブシステム
+		std::atomic<int> Sum;				//!< 処理した要素数の合計
+		std::atomic<int> FinishedCount;		//!< 完了した先行ジョブの数
+		int ObservedCount;					//!< 後続ジョブが実行時に観測した先行ジョブの完了数
+	};
+
+	/** @brief 範囲の要素数を合計するジョブ */
+	void SumJob(void* data, int begin, int end)
+	{
+		((JobTestData*)data)->Sum.fetch_add(end - begin);
+	}
+
+	/** @brief 少し時間のかかる先行ジョブ */
+	void FirstJob(void* data, int begin, int end)
+	{
+		for (volatile int i = 0; i < 20000; i++)
+		{
+		}
+		((JobTestData*)data)->FinishedCount.fetch_add(1);
+	}
+
+	/** @brief 先行ジョブの完了数を記録する後続ジョブ */
+	void SecondJob(void* data, int begin, int end)
+	{
+		JobTestData* test_data = (JobTestData*)data;
+		test_data->ObservedCount = test_data->FinishedCount.load();
+	}
+
+	/** @brief 子ジョブを追加して完了を待つジョブ */
+	void NestedJob(void* data, int begin, int end)
+	{
+		JobTestData* test_data = (JobTestData*)data;
+
+		JobCounter counter;
+		for (int i = 0; i < NestedChildCount; i++)
+		{
+			test_data->System->Run(SumJob, test_data, &counter, nullptr);
+		}
+		test_data->System->Wait(&counter);
+	}
+
+	/**
+	* @brief ジョブシステムの動作の検証
+	* @param[in] job_system 初期化済みのジョブシステム
+	*/
+	void CheckJobSystem(JobSystem* job_system)
+	{
+		JobTestData data;
+		data.System = job_system;
+		data.Sum = 0;
+		data.FinishedCount = 0;
+		data.ObservedCount = -1;
+
+		job_system->ParallelFor(SumJob, &data, 1000000, 1000);
+		BenchCheck(data.Sum.load() == 1000000, "ParallelFor covers the whole range once");
+
+		JobCounter first_counter;
+		JobCounter second_counter;
+		for (int i = 0; i < DependencyJobCount; i++)
+		{
+			job_system->Run(FirstJob, &data, &first_counter, nullptr);
+		}
+		job_system->Run(SecondJob, &data, &second_counter, &first_counter);
+		job_system->Wait(&second_counter);
+		BenchCheck(data.ObservedCount == DependencyJobCount && first_counter.IsDone() == true, "dependent job runs after all of its dependencies");
+
+		data.Sum = 0;
+		JobCounter nested_counter;
+		for (int i = 0; i < NestedJobCount; i++)
+		{
+			job_system->Run(NestedJob, &data, &nested_counter, nullptr);
+		}
+		job_system->Wait(&nested_counter);
+		BenchCheck(data.Sum.load() == NestedJobCount * NestedChildCount, "jobs can run and wait for child jobs");
+	}
+
+	/**
+	* @brief 小さいジョブ1個あたりの時間の計測
+	* @retval double ジョブ1個あたりの時間(マイクロ秒)
+	* @param[in] job_system 初期化済みのジョブシステム
+	*/
+	double MeasureJobOverhead(JobSystem* job_system)
+	{
+		const int RepeatCount = 100;
+		const int JobCount = 1000;
+
+		JobTestData data;
+		data.System = job_system;
+		data.Sum = 0;
+
+		BenchTimer timer;
+		for (int i = 0; i < RepeatCount; i++)
+		{
+			job_system->ParallelFor(SumJob, &data, JobCount * 100, 100);
+		}
+
+		return timer.GetElapsedTime() * 1000.0 / (RepeatCount * JobCount);
+	}
+
+	/**
+	* @brief パーティクルの並列更新の計測
+	* @retval double 1フレームの更新時間(ミリ秒)
+	* @param[in] job_system 初期化済みのジョブシステム
+	*/
+	double MeasureParticleUpdate(JobSystem* job_system)
+	{
+		ParticleEmitterDesc desc;
+		desc.MaxParticles = BenchParticleCount;
+		desc.EmitRate = 0.0f;
+		desc.LifeMin = 100.0f;
+		desc.LifeMax = 100.0f;
+		desc.GravityY = 98.0f;
+
+		ParticleEmitter emitter;
+		emitter.Initialize(desc);
+		emitter.Emit(BenchParticleCount);
+
+		BenchTimer timer;
+		for (int frame = 0; frame < BenchFrameCount; frame++)
+		{
+			emitter.Update(1.0f / 60.0f, job_system);
+		}
+		double update_time = timer.GetElapsedTime() / BenchFrameCount;
+
+		BenchCheck(emitter.GetCount() == BenchParticleCount, "parallel update keeps every live particle");
+
+		emitter.Release();
+
+		return update_time;
+	}
+}
+
+void RunJobSystemBench()
+{
+	// 0(メインスレッドのみ)、1、3、7…と論理コア数 - 1までワーカーを増やす
+	int max_thread_count = (int)std::thread::hardware_concurrency() - 1;
+	max_thread_count = (std::max)(0, (std::min)(max_thread_count, MaxJobWorkers));
+
+	std::vector<int> thread_count_list;
+	for (int thread_count = 0; thread_count < max_thread_count; thread_count = thread_count * 2 + 1)
+	{
+		thread_count_list.push_back(thread_count);
+	}
+	thread_count_list.push_back(max_thread_count);
+
+	double base_time = 0.0;
+
+	for (int thread_count : thread_count_list)
+	{
+		JobSystem job_system;
+		if (job_system.Initialize(thread_count) == false)
+		{
+			BenchCheck(false, "initialize job system");
+			continue;
+		}
+
+		CheckJobSystem(&job_system);
+		double job_time = MeasureJobOverhead(&job_system);
+		double particle_time = MeasureParticleUpdate(&job_system);
+
+		if (thread_count == 0)
+		{
+			base_time = particle_time;
+		}
+
+		printf("  %2d workers: job overhead %.3f us/job, 100k particle update %8.3f ms/frame (x%.2f)\n",
+			job_system.GetWorkerCount(), job_time, particle_time, particle_time > 0.0 ? base_time / particle_time : 0.0);
+
+		job_system.Release();
+	}
+}
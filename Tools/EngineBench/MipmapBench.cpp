@@ -0,0 +1,148 @@
+﻿/**
+* @file MipmapBench.cpp
+* @brief <pre>
+* ミップマップ作成のベンチマークと検証
+* SSE2の縮小(MipmapGenerator::Downsample)がスカラーの計算(AverageTexels)と同じ結果になることを奇数サイズを含めて検証し、
+* 2048x2048のテクスチャの縮小時間をSSE2とスカラーで比較する
+* </pre>
+*/
+#include <stdio.h>
+#include <vector>
+#include "EngineBench.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/MipmapGenerator.h"
+
+namespace
+{
+	const int BenchTextureSize = 2048;		//!< 計測するテクスチャの横幅、縦幅
+	const int BenchRepeatCount = 20;		//!< 計測の繰り返し回数
+
+	/**
+	* @brief スカラーでの1レベルの縮小関数
+	* @details Downsampleと同じ範囲のテクセルをAverageTexelsで平均する(比較用)
+	* @param[in] src 縮小元のテクセル
+	* @param[in] src_width 縮小元の横幅
+	* @param[in] src_height 縮小元の縦幅
+	* @param[out] dest 縮小したテクセル
+	*/
+	void DownsampleScalar(const DWORD* src, int src_width, int src_height, DWORD* dest)
+	{
+		int dest_width = src_width / 2 > 1 ? src_width / 2 : 1;
+		int dest_height = src_height / 2 > 1 ? src_height / 2 : 1;
+		int next_column = src_width > 1 ? 1 : 0;
+		size_t next_row = src_height > 1 ? (size_t)src_width : 0;
+
+		for (int y = 0; y < dest_height; y++)
+		{
+			const DWORD* top = &src[(size_t)y * 2 * src_width];
+			const DWORD* bottom = top + next_row;
+			for (int x = 0; x < dest_width; x++)
+			{
+				dest[(size_t)y * dest_width + x] = MipmapGenerator::AverageTexels(
+					top[x * 2],
+					top[x * 2 + next_column],
+					bottom[x * 2],
+					bottom[x * 2 + next_column]);
+			}
+		}
+	}
+
+	/**
+	* @brief 検証用のテクセルの作成関数
+	* @details カラーキーで透明にしたテクセルを含むように、一部のアルファを0にする
+	* @param[out] out_pixels 作成したテクセル
+	* @param[in] count テクセル数
+	* @param[in] seed 乱数の初期値
+	*/
+	void MakeTexels(std::vector<DWORD>* out_pixels, size_t count, unsigned int seed)
+	{
+		out_pixels->resize(count);
+		for (DWORD& texel : *out_pixels)
+		{
+			seed = seed * 1664525 + 1013904223;
+			texel = (DWORD)seed;
+			if ((seed >> 28) == 0)
+			{
+				texel &= 0x00FFFFFF;
+			}
+		}
+	}
+
+	/** @brief SSE2とスカラーの縮小結果の検証 */
+	void CheckDownsample()
+	{
+		const int size_list[][2] =
+		{
+			{ 64, 64 }, { 7, 5 }, { 6, 3 }, { 33, 1 }, { 1, 9 }, { 1, 1 },
+		};
+
+		bool is_same = true;
+		for (const int* size : size_list)
+		{
+			std::vector<DWORD> pixels;
+			MakeTexels(&pixels, (size_t)size[0] * size[1], (unsigned int)(size[0] * 31 + size[1]));
+
+			int dest_width = size[0] / 2 > 1 ? size[0] / 2 : 1;
+			int dest_height = size[1] / 2 > 1 ? size[1] / 2 : 1;
+			std::vector<DWORD> simd((size_t)dest_width * dest_height);
+			std::vector<DWORD> scalar((size_t)dest_width * dest_height);
+
+			MipmapGenerator::Downsample(&pixels[0], size[0], size[1], &simd[0]);
+			DownsampleScalar(&pixels[0], size[0], size[1], &scalar[0]);
+			is_same = is_same && simd == scalar;
+		}
+		BenchCheck(is_same == true, "SSE2 downsample matches the scalar path (odd and 1-texel sizes included)");
+
+		// 透明なテクセルの色は混ざらず、アルファだけが平均される
+		BenchCheck(MipmapGenerator::AverageTexels(0xFFFF0000, 0x00000000, 0x00000000, 0x00000000) == 0x40FF0000, "transparent texels do not darken the colour");
+
+		BenchCheck(MipmapGenerator::CalculateLevelCount(256, 128) == 9, "256x128 has 9 levels");
+
+		std::vector<DWORD> pixels;
+		MakeTexels(&pixels, 256 * 128, 1);
+		std::vector<DWORD> chain;
+		MipmapGenerator::GenerateChain(256, 128, &pixels[0], 9, &chain);
+		BenchCheck(chain.size() == MipmapGenerator::CalculateChainTexelCount(256, 128, 9), "chain holds every level");
+
+		int last_width = 0;
+		int last_height = 0;
+		MipmapGenerator::CalculateLevelSize(256, 128, 8, &last_width, &last_height);
+		BenchCheck(last_width == 1 && last_height == 1, "last level is 1x1");
+	}
+}
+
+void RunMipmapBench()
+{
+	CheckDownsample();
+
+	std::vector<DWORD> pixels;
+	MakeTexels(&pixels, (size_t)BenchTextureSize * BenchTextureSize, 12345);
+	std::vector<DWORD> dest((size_t)BenchTextureSize * BenchTextureSize / 4);
+
+	BenchTimer timer;
+	for (int i = 0; i < BenchRepeatCount; i++)
+	{
+		MipmapGenerator::Downsample(&pixels[0], BenchTextureSize, BenchTextureSize, &dest[0]);
+	}
+	double simd_time = timer.GetElapsedTime() / BenchRepeatCount;
+
+	timer.Reset();
+	for (int i = 0; i < BenchRepeatCount; i++)
+	{
+		DownsampleScalar(&pixels[0], BenchTextureSize, BenchTextureSize, &dest[0]);
+	}
+	double scalar_time = timer.GetElapsedTime() / BenchRepeatCount;
+
+	int level_count = MipmapGenerator::CalculateLevelCount(BenchTextureSize, BenchTextureSize);
+	std::vector<DWORD> chain;
+	timer.Reset();
+	for (int i = 0; i < BenchRepeatCount; i++)
+	{
+		MipmapGenerator::GenerateChain(BenchTextureSize, BenchTextureSize, &pixels[0], level_count, &chain);
+	}
+	double chain_time = timer.GetElapsedTime() / BenchRepeatCount;
+
+	double texel_count = (double)BenchTextureSize * BenchTextureSize;
+	printf("  Downsample %dx%d SSE2:   %8.3f ms (%.0f M source texels/s)\n", BenchTextureSize, BenchTextureSize, simd_time, simd_time > 0.0 ? texel_count / simd_time / 1000.0 : 0.0);
+	printf("  Downsample %dx%d scalar: %8.3f ms (x%.2f)\n", BenchTextureSize, BenchTextureSize, scalar_time, simd_time > 0.0 ? scalar_time / simd_time : 0.0);
+	printf("  GenerateChain %d levels:    %8.3f ms\n", level_count, chain_time);
+}
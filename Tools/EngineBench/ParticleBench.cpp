@@ -0,0 +1,204 @@
+﻿/**
+* @file ParticleBench.cpp
+* @brief <pre>
+* パーティクルのベンチマークと検証
+* 10万個のパーティクルを1コアで更新する時間を、AoSの構造体をスカラーで更新する場合と比較し、
+* スプライトバッチへの書き込み時間、寿命が尽きたパーティクルの削除、設定ファイルの解析を検証する
+* </pre>
+*/
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "EngineBench.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/Graphics.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/ParticleEmitter.h"
+
+namespace
+{
+	const int BenchParticleCount = 100000;	//!< 計測するパーティクル数
+	const int BenchFrameCount = 200;		//!< 計測するフレーム数
+	const float FrameTime = 1.0f / 60.0f;	//!< 1フレームの経過時間(秒)
+
+	/** @brief 比較用のAoS形式のパーティクル */
+	struct AosParticle
+	{
+		float PositionX;		//!< 座標X
+		float PositionY;		//!< 座標Y
+		float VelocityX;		//!< 速度X
+		float VelocityY;		//!< 速度Y
+		float Color[4];			//!< 色
+		float ColorDelta[4];	//!< 色の変化量
+		float Size;				//!< サイズ
+		float SizeDelta;		//!< サイズの変化量
+		float Life;				//!< 残り寿命
+	};
+
+	/** @brief 設定ファイルの解析の検証 */
+	void CheckParseDesc()
+	{
+		const char* text =
+			"\xEF\xBB\xBF# test\r\n"
+			"texture = Spark\r\n"
+			"max_particles=2000\n"
+			"life=0.5,1.5\n"
+			"end_color=00FF4000\n"
+			"gravity=0,98 # down\n"
+			"\n";
+
+		ParticleEmitterDesc desc;
+		bool is_parsed = ParticleEmitter::ParseDesc(text, strlen(text), &desc);
+		BenchCheck(is_parsed == true, "emitter desc with BOM, CRLF and comments parses");
+		BenchCheck(desc.TextureKeyword == "Spark" && desc.MaxParticles == 2000, "desc keeps texture and particle count");
+		BenchCheck(desc.LifeMin == 0.5f && desc.LifeMax == 1.5f && desc.GravityY == 98.0f, "desc reads ranges and vectors");
+		BenchCheck(desc.EndColor == 0x00FF4000, "desc reads hexadecimal colours");
+
+		const char* bad_text = "life=abc";
+		BenchCheck(ParticleEmitter::ParseDesc(bad_text, strlen(bad_text), &desc) == false, "invalid desc value is rejected");
+	}
+
+	/** @brief 寿命が尽きたパーティクルの削除の検証 */
+	void CheckSwapRemove()
+	{
+		ParticleEmitterDesc desc;
+		desc.MaxParticles = 1000;
+		desc.EmitRate = 600.0f;
+		desc.LifeMin = 0.5f;
+		desc.LifeMax = 1.0f;
+
+		ParticleEmitter emitter;
+		emitter.Initialize(desc);
+
+		int peak_count = 0;
+		for (int frame = 0; frame < 600; frame++)
+		{
+			emitter.Update(FrameTime, nullptr);
+			if (emitter.GetCount() > peak_count)
+			{
+				peak_count = emitter.GetCount();
+			}
+		}
+
+		const float* life = emitter.GetStream(ParticleStreamLife);
+		int dead_count = 0;
+		for (int i = 0; i < emitter.GetCount(); i++)
+		{
+			if (life[i] <= 0.0f)
+			{
+				dead_count++;
+			}
+		}
+
+		BenchCheck(dead_count == 0, "dead particles are removed every update");
+		BenchCheck(peak_count <= desc.MaxParticles && emitter.GetCount() > 0, "particle count stays within MaxParticles");
+
+		emitter.Release();
+	}
+
+	/** @brief 10万個の更新と描画の計測 */
+	void MeasureUpdate()
+	{
+		ParticleEmitterDesc desc;
+		desc.MaxParticles = BenchParticleCount;
+		desc.EmitRate = 0.0f;
+		desc.LifeMin = 100.0f;
+		desc.LifeMax = 200.0f;
+		desc.SpeedMin = 50.0f;
+		desc.SpeedMax = 200.0f;
+		desc.StartSizeMin = 8.0f;
+		desc.StartSizeMax = 16.0f;
+		desc.EndSize = 0.0f;
+		desc.EndColor = 0x00FF4000;
+		desc.GravityY = 98.0f;
+		desc.SpawnRadius = 4.0f;
+
+		ParticleEmitter emitter;
+		emitter.Initialize(desc);
+		emitter.SetPosition(640.0f, 360.0f);
+		emitter.Emit(BenchParticleCount);
+		BenchCheck(emitter.GetCount() == BenchParticleCount, "emit fills the pool");
+
+		// 同じ初期値のAoSの配列を作成する
+		std::vector<AosParticle> aos_list(emitter.GetCount());
+		for (int i = 0; i < emitter.GetCount(); i++)
+		{
+			AosParticle& particle = aos_list[i];
+			particle.PositionX = emitter.GetStream(ParticleStreamPositionX)[i];
+			particle.PositionY = emitter.GetStream(ParticleStreamPositionY)[i];
+			particle.VelocityX = emitter.GetStream(ParticleStreamVelocityX)[i];
+			particle.VelocityY = emitter.GetStream(ParticleStreamVelocityY)[i];
+			for (int c = 0; c < 4; c++)
+			{
+				particle.Color[c] = emitter.GetStream((ParticleStream)(ParticleStreamColorR + c))[i];
+				particle.ColorDelta[c] = emitter.GetStream((ParticleStream)(ParticleStreamColorDeltaR + c))[i];
+			}
+			particle.Size = emitter.GetStream(ParticleStreamSize)[i];
+			particle.SizeDelta = emitter.GetStream(ParticleStreamSizeDelta)[i];
+			particle.Life = emitter.GetStream(ParticleStreamLife)[i];
+		}
+
+		BenchTimer timer;
+		for (int frame = 0; frame < BenchFrameCount; frame++)
+		{
+			emitter.Update(FrameTime, nullptr);
+		}
+		double soa_time = timer.GetElapsedTime() / BenchFrameCount;
+
+		timer.Reset();
+		for (int frame = 0; frame < BenchFrameCount; frame++)
+		{
+			for (AosParticle& particle : aos_list)
+			{
+				particle.VelocityX += desc.GravityX * FrameTime;
+				particle.VelocityY += desc.GravityY * FrameTime;
+				particle.PositionX += particle.VelocityX * FrameTime;
+				particle.PositionY += particle.VelocityY * FrameTime;
+				for (int c = 0; c < 4; c++)
+				{
+					particle.Color[c] += particle.ColorDelta[c] * FrameTime;
+				}
+				particle.Size += particle.SizeDelta * FrameTime;
+				particle.Life -= FrameTime;
+			}
+		}
+		double aos_time = timer.GetElapsedTime() / BenchFrameCount;
+
+		// 同じ式で積分しているので、SIMDでもスカラーと同じ結果になる
+		float max_difference = 0.0f;
+		const float* position_y = emitter.GetStream(ParticleStreamPositionY);
+		for (int i = 0; i < emitter.GetCount(); i++)
+		{
+			max_difference = (std::max)(max_difference, fabsf(aos_list[i].PositionY - position_y[i]));
+		}
+		BenchCheck(emitter.GetCount() == BenchParticleCount && max_difference < 0.01f, "SIMD update matches the scalar reference");
+
+		std::unique_ptr<Graphics> graphics = CreateBenchGraphics();
+		BenchCheck(graphics->Initialize(1280, 720, true, RenderBackendType::RenderBackendTypeNull), "initialize null backend");
+
+		timer.Reset();
+		for (int frame = 0; frame < BenchFrameCount; frame++)
+		{
+			graphics->StartDraw(0);
+			graphics->DrawParticles(&emitter);
+			graphics->FinishDraw();
+		}
+		double draw_time = timer.GetElapsedTime() / BenchFrameCount;
+		FrameStats stats = graphics->GetFrameStats();
+		BenchCheck(stats.VertexCount == emitter.GetCount() * 6, "DrawParticles writes six vertices per particle");
+
+		printf("  SoA SIMD update, 1 core:  %8.3f ms/frame (%d particles)\n", soa_time, emitter.GetCount());
+		printf("  AoS scalar update:        %8.3f ms/frame\n", aos_time);
+		printf("  DrawParticles:            %8.3f ms/frame, %d draw calls, %d vertices\n", draw_time, stats.DrawCallCount, stats.VertexCount);
+
+		graphics->Release();
+		emitter.Release();
+	}
+}
+
+void RunParticleBench()
+{
+	CheckParseDesc();
+	CheckSwapRemove();
+	MeasureUpdate();
+}
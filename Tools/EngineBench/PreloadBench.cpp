@@ -0,0 +1,363 @@
+﻿/**
+* @file PreloadBench.cpp
+* @brief <pre>
+* アセットの一括読み込みのベンチマークと検証
+* 作業フォルダにコピーした画像をマニフェストに列挙し、メインスレッドで1つずつ読み込む場合と、
+* ジョブシステムのワーカー数を変えながらAssetPreloaderで読み込む場合の時間を計測する
+* 進捗の通知、読み込めないファイルの失敗数、マニフェストの解析、中止を検証する
+* D3DXで画像をデコードするので、GraphicsはSoftware描画バックエンド(NULLREFデバイス)で初期化する
+* </pre>
+*/
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+#include "EngineBench.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/AssetPreloader.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/FileSystem.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/Graphics.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/JobSystem.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/TextureManager.h"
+
+namespace
+{
+	const char* const SourceFileList[] = { "Res/bomb_move.png", "Res/Enemy.png" };	//!< コピー元の画像ファイル
+	const char PreloadDirectory[] = "BenchWork/Preload";					//!< コピーした画像とマニフェストを置くフォルダ
+	const char ManifestFileName[] = "BenchWork/Preload/Manifest.txt";		//!< 全ての画像を列挙したマニフェスト
+	const char MissingManifestFileName[] = "BenchWork/Preload/Missing.txt";	//!< 存在しないファイルを含むマニフェスト
+	const int BenchTextureCount = 64;										//!< マニフェストに列挙する画像の数
+
+	/** @brief GraphicsでテクスチャをCreateTextureで作成するローダー */
+	class BenchTextureLoader : public TextureLoader
+	{
+	public:
+		/**
+		* @brief Constructor
+		* @param[in] graphics テクスチャを作成するGraphics
+		*/
+		explicit BenchTextureLoader(Graphics* graphics) :
+			m_Graphics(graphics)
+		{
+		}
+
+		bool Load(const char* file_name, Texture* out_texture, FileContentHash* out_hash) override
+		{
+			return m_Graphics->CreateTexture(file_name, out_texture, out_hash);
+		}
+
+		void Unload(Texture* texture) override
+		{
+			if (texture->TextureData != nullptr)
+			{
+				texture->TextureData->Release();
+				texture->TextureData = nullptr;
+			}
+		}
+
+	private:
+		Graphics* m_Graphics;	//!< テクスチャを作成するGraphics
+	};
+
+	/** @brief 進捗の通知の記録 */
+	struct ProgressLog
+	{
+		int CallCount;			//!< 通知された回数
+		int LastLoadedCount;	//!< 最後に通知された読み込み完了数
+		int TotalCount;			//!< 通知されたアセットの数
+		bool IsMonotonic;		//!< 読み込み完了数が減らずに増え続けたか
+	};
+
+	/** @brief 進捗の記録関数 */
+	void RecordProgress(void* data, int loaded_count, int total_count)
+	{
+		ProgressLog* log = (ProgressLog*)data;
+
+		if (log->CallCount > 0 && loaded_count <= log->LastLoadedCount)
+		{
+			log->IsMonotonic = false;
+		}
+
+		log->CallCount++;
+		log->LastLoadedCount = loaded_count;
+		log->TotalCount = total_count;
+	}
+
+	/**
+	* @brief 読み込むファイルの作成関数
+	* @details <pre>
+	* コピー元の画像を交互にコピーし、全ての画像を列挙したマニフェストと、
+	* 先頭の1つを存在しないファイルに置き換えたマニフェストを作成する
+	* </pre>
+	* @retval true 作成成功
+	* @retval false 作成失敗
+	* @param[out] out_file_list コピーした画像ファイル名
+	*/
+	bool PrepareManifest(std::vector<std::string>* out_file_list)
+	{
+		FileData source_list[2];
+		for (int i = 0; i < 2; i++)
+		{
+			if (FileSystem::ReadLooseFile(SourceFileList[i], &source_list[i]) == false)
+			{
+				return false;
+			}
+		}
+
+		CreateDirectory(BenchWorkDirectory, nullptr);
+		CreateDirectory(PreloadDirectory, nullptr);
+
+		std::string manifest = "# EngineBench preload\r\n";
+		std::string missing_manifest = "texture,Missing,BenchWork/Preload/Missing.png\r\n";
+
+		for (int i = 0; i < BenchTextureCount; i++)
+		{
+			char file_name[MAX_PATH];
+			sprintf_s(file_name, sizeof(file_name), "%s/Texture%03d.png", PreloadDirectory, i);
+
+			const FileData& source = source_list[i % 2];
+			if (WriteBenchFile(file_name, source.Data, source.Size) == false)
+			{
+				return false;
+			}
+			out_file_list->push_back(file_name);
+
+			char line[MAX_PATH + 32];
+			sprintf_s(line, sizeof(line), "texture,Texture%03d,%s\r\n", i, file_name);
+			manifest += line;
+			if (i > 0)
+			{
+				missing_manifest += line;
+			}
+		}
+
+		return WriteBenchFile(ManifestFileName, manifest.c_str(), manifest.size()) == true &&
+			WriteBenchFile(MissingManifestFileName, missing_manifest.c_str(), missing_manifest.size()) == true;
+	}
+
+	/** @brief マニフェストの解析の検証 */
+	void CheckParseManifest()
+	{
+		const char* text =
+			"\xEF\xBB\xBF# assets\r\n"
+			"\r\n"
+			" texture , Enemy , Res/Enemy.png # comment\r\n"
+			"sound,Se,Res/Se.wav";
+
+		std::vector<PreloadEntry> entry_list;
+		BenchCheck(AssetPreloader::ParseManifest(text, strlen(text), &entry_list), "manifest with BOM, CRLF, blank lines and comments parses");
+		BenchCheck(entry_list.size() == 2, "manifest lists every asset line");
+		if (entry_list.size() == 2)
+		{
+			BenchCheck(entry_list[0].Type == PreloadAssetType::Texture && entry_list[0].Keyword == "Enemy" && entry_list[0].FileName == "Res/Enemy.png", "manifest fields are trimmed");
+			BenchCheck(entry_list[1].Type == PreloadAssetType::Sound && entry_list[1].FileName == "Res/Se.wav", "last line without a newline is read");
+		}
+
+		const char* bad_text_list[] =
+		{
+			"image,Enemy,Res/Enemy.png",
+			"texture,Res/Enemy.png",
+			"texture,,Res/Enemy.png",
+			"texture,Enemy,  # no file",
+			"Res/Enemy.png",
+		};
+
+		for (const char* bad_text : bad_text_list)
+		{
+			std::vector<PreloadEntry> bad_entry_list;
+			if (AssetPreloader::ParseManifest(bad_text, strlen(bad_text), &bad_entry_list) == true)
+			{
+				printf("  accepted: \"%s\"\n", bad_text);
+				BenchCheck(false, "invalid manifest line is rejected");
+			}
+		}
+	}
+
+	/**
+	* @brief メインスレッドで1つずつ読み込む時間の計測
+	* @retval double 全ての画像を読み込む時間(ミリ秒)
+	* @param[in] graphics テクスチャを作成するGraphics
+	* @param[in] file_list 読み込む画像ファイル名
+	*/
+	double MeasureSequentialLoad(Graphics* graphics, const std::vector<std::string>& file_list)
+	{
+		BenchTextureLoader loader(graphics);
+		TextureManager texture_manager;
+		texture_manager.Initialize(&loader);
+
+		int loaded_count = 0;
+		BenchTimer timer;
+		for (size_t i = 0; i < file_list.size(); i++)
+		{
+			char keyword[32];
+			sprintf_s(keyword, sizeof(keyword), "Texture%03d", (int)i);
+			if (texture_manager.LoadTexture(keyword, file_list[i].c_str()) == true)
+			{
+				loaded_count++;
+			}
+		}
+		double load_time = timer.GetElapsedTime();
+
+		BenchCheck(loaded_count == (int)file_list.size(), "sequential LoadTexture loads every texture");
+
+		texture_manager.Release();
+
+		return load_time;
+	}
+
+	/**
+	* @brief 一括読み込みの実行関数
+	* @details 完了するまで、毎フレームの更新と同じようにUpdateを繰り返す
+	* @retval true 開始して完了した
+	* @retval false 開始できなかった
+	* @param[in] manifest_file マニフェストのファイル名
+	* @param[in] job_system 初期化済みのジョブシステム
+	* @param[in] graphics テクスチャのデコードと作成に使用するGraphics
+	* @param[in] texture_manager テクスチャを登録するクラス
+	* @param[out] out_stats 読み込みの結果
+	* @param[out] out_log 進捗の通知の記録
+	*/
+	bool RunPreload(const char* manifest_file, JobSystem* job_system, Graphics* graphics, TextureManager* texture_manager, PreloadStats* out_stats, ProgressLog* out_log)
+	{
+		*out_log = { 0, -1, 0, true };
+
+		AssetPreloader preloader;
+		if (preloader.Start(manifest_file, job_system, graphics, nullptr, RecordProgress, out_log) == false)
+		{
+			return false;
+		}
+
+		while (preloader.IsLoading() == true)
+		{
+			preloader.Update(texture_manager);
+			std::this_thread::yield();
+		}
+
+		*out_stats = preloader.GetStats();
+
+		return true;
+	}
+
+	/**
+	* @brief ワーカー数ごとの一括読み込みの計測
+	* @param[in] graphics テクスチャのデコードと作成に使用するGraphics
+	* @param[in] sequential_time メインスレッドで1つずつ読み込んだ時間(ミリ秒)
+	*/
+	void MeasurePreload(Graphics* graphics, double sequential_time)
+	{
+		// 0(メインスレッドのみ)、1、3、7…と論理コア数 - 1までワーカーを増やす
+		int max_thread_count = (int)std::thread::hardware_concurrency() - 1;
+		max_thread_count = (std::max)(0, (std::min)(max_thread_count, MaxJobWorkers));
+
+		std::vector<int> thread_count_list;
+		for (int thread_count = 0; thread_count < max_thread_count; thread_count = thread_count * 2 + 1)
+		{
+			thread_count_list.push_back(thread_count);
+		}
+		thread_count_list.push_back(max_thread_count);
+
+		BenchTextureLoader loader(graphics);
+
+		for (int thread_count : thread_count_list)
+		{
+			JobSystem job_system;
+			if (job_system.Initialize(thread_count) == false)
+			{
+				BenchCheck(false, "initialize job system");
+				continue;
+			}
+
+			TextureManager texture_manager;
+			texture_manager.Initialize(&loader);
+
+			PreloadStats stats;
+			ProgressLog log;
+			bool is_finished = RunPreload(ManifestFileName, &job_system, graphics, &texture_manager, &stats, &log);
+
+			BenchCheck(is_finished == true && stats.TotalCount == BenchTextureCount && stats.FailureCount == 0, "preload registers every texture");
+			BenchCheck(log.IsMonotonic == true && log.LastLoadedCount == BenchTextureCount && log.TotalCount == BenchTextureCount, "progress only increases and ends at the total");
+			BenchCheck(texture_manager.GetTexture("Texture000") != nullptr && texture_manager.GetTexture("Texture063") != nullptr, "preloaded textures are found by keyword");
+
+			printf("  %2d workers: total %8.3f ms (decode %8.3f ms, upload %7.3f ms), x%.2f vs sequential, %d progress calls\n",
+				stats.WorkerCount, stats.TotalTime, stats.DecodeTime, stats.UploadTime,
+				stats.TotalTime > 0.0f ? sequential_time / stats.TotalTime : 0.0, log.CallCount);
+
+			texture_manager.Release();
+			job_system.Release();
+		}
+	}
+
+	/**
+	* @brief 読み込めないファイルと中止の検証
+	* @param[in] graphics テクスチャのデコードと作成に使用するGraphics
+	*/
+	void CheckFailureAndCancel(Graphics* graphics)
+	{
+		JobSystem job_system;
+		if (job_system.Initialize(1) == false)
+		{
+			BenchCheck(false, "initialize job system");
+			return;
+		}
+
+		BenchTextureLoader loader(graphics);
+		TextureManager texture_manager;
+		texture_manager.Initialize(&loader);
+
+		PreloadStats stats;
+		ProgressLog log;
+		BenchCheck(RunPreload("BenchWork/Preload/NoManifest.txt", &job_system, graphics, &texture_manager, &stats, &log) == false, "missing manifest does not start");
+
+		// 存在しないファイルは失敗数に数え、残りは登録する
+		bool is_finished = RunPreload(MissingManifestFileName, &job_system, graphics, &texture_manager, &stats, &log);
+		BenchCheck(is_finished == true && stats.TotalCount == BenchTextureCount && stats.FailureCount == 1, "missing file is counted as one failure");
+		BenchCheck(texture_manager.GetTexture("Missing") == nullptr && texture_manager.GetTexture("Texture001") != nullptr, "other textures are registered despite the failure");
+		BenchCheck(log.LastLoadedCount == BenchTextureCount, "progress reaches the total even with a failure");
+		texture_manager.ReleaseAllTextures();
+
+		AssetPreloader preloader;
+		BenchCheck(preloader.Start(ManifestFileName, &job_system, graphics, nullptr, nullptr, nullptr), "preload starts");
+		BenchCheck(preloader.Start(ManifestFileName, &job_system, graphics, nullptr, nullptr, nullptr) == false, "preload does not start twice");
+		preloader.Cancel();
+		BenchCheck(preloader.IsLoading() == false && texture_manager.GetTexture("Texture000") == nullptr, "cancel discards decoded textures without registering them");
+
+		preloader.Update(&texture_manager);
+		BenchCheck(texture_manager.GetTexture("Texture000") == nullptr, "update after cancel does nothing");
+
+		BenchCheck(preloader.Start(ManifestFileName, &job_system, graphics, nullptr, nullptr, nullptr), "preload restarts after cancel");
+		preloader.Wait(&texture_manager);
+		BenchCheck(preloader.GetStats().FailureCount == 0 && texture_manager.GetTexture("Texture000") != nullptr, "restarted preload completes");
+
+		texture_manager.Release();
+		job_system.Release();
+	}
+}
+
+void RunPreloadBench()
+{
+	CheckParseManifest();
+
+	std::vector<std::string> file_list;
+	if (PrepareManifest(&file_list) == false)
+	{
+		BenchCheck(false, "copy Res images and write the manifest into BenchWork/Preload");
+		return;
+	}
+
+	std::unique_ptr<Graphics> graphics = CreateBenchGraphics();
+	if (graphics->Initialize(256, 256, true, RenderBackendType::RenderBackendTypeSoftware) == false)
+	{
+		BenchCheck(false, "initialize software backend");
+		graphics->Release();
+		return;
+	}
+
+	double sequential_time = MeasureSequentialLoad(graphics.get(), file_list);
+	printf("  %d textures, sequential LoadTexture: %8.3f ms\n", BenchTextureCount, sequential_time);
+
+	MeasurePreload(graphics.get(), sequential_time);
+	CheckFailureAndCancel(graphics.get());
+
+	graphics->Release();
+}
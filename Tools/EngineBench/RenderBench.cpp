@@ -0,0 +1,202 @@
+﻿/**
+* @file RenderBench.cpp
+* @brief <pre>
+* 描画処理のベンチマークと検証
+* Recording描画バックエンドで記録した頂点から軸、カメラ、バッチ、カリングの結果を検証し、
+* Null描画バックエンドでDraw関数の頂点作成とバッチ処理にかかる時間を計測する
+* </pre>
+*/
+#include <math.h>
+#include <stdio.h>
+#include "EngineBench.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/Graphics.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/RecordingRenderBackend.h"
+
+namespace
+{
+	const int ScreenWidth = 1280;		//!< 画面の横幅
+	const int ScreenHeight = 720;		//!< 画面の縦幅
+	const int BenchFrameCount = 300;	//!< 計測するフレーム数
+	const int BenchDrawCount = 10000;	//!< 1フレームの描画回数
+
+	/**
+	* @brief 座標の比較関数
+	* @retval true 誤差の範囲で一致する
+	* @retval false 一致しない
+	* @param[in] vertex 比較する頂点
+	* @param[in] x 期待するX座標
+	* @param[in] y 期待するY座標
+	*/
+	bool IsNearPosition(const CustomVertex& vertex, float x, float y)
+	{
+		return fabsf(vertex.X - x) < 0.01f && fabsf(vertex.Y - y) < 0.01f;
+	}
+
+	/** @brief Recording描画バックエンドで記録した頂点の検証 */
+	void CheckRecordedVertices()
+	{
+		std::unique_ptr<Graphics> graphics = CreateBenchGraphics();
+		BenchCheck(graphics->Initialize(ScreenWidth, ScreenHeight, true, RenderBackendType::RenderBackendTypeRecording), "initialize recording backend");
+
+		RecordingRenderBackend* recorder = (RecordingRenderBackend*)graphics->GetBackend();
+		if (recorder == nullptr)
+		{
+			return;
+		}
+
+		// 軸が左上の場合は指定した座標が矩形の左上になる
+		graphics->StartDraw(0);
+		graphics->DrawRect(100.0f, 50.0f, 32.0f, 16.0f, 0x00ff0000, 128);
+		graphics->FinishDraw();
+		BenchCheck(recorder->GetCommands().size() == 1 && recorder->GetVertices().size() == 6, "DrawRect records one command with six vertices");
+		if (recorder->GetVertices().size() == 6)
+		{
+			const std::vector<CustomVertex>& vertices = recorder->GetVertices();
+			BenchCheck(IsNearPosition(vertices[0], 100.0f, 50.0f) && IsNearPosition(vertices[2], 132.0f, 66.0f), "left-top pivot places the rect at the given position");
+			BenchCheck(vertices[0].Color == 0x80ff0000, "DrawRect adds alpha to the colour");
+		}
+
+		// 軸が中央の場合は矩形の半分だけずれる
+		graphics->SetPivotType(PivotType::CenterCenter);
+		graphics->StartDraw(0);
+		graphics->DrawRect(100.0f, 50.0f, 32.0f, 16.0f);
+		graphics->FinishDraw();
+		BenchCheck(recorder->GetVertices().empty() == false && IsNearPosition(recorder->GetVertices()[0], 84.0f, 42.0f), "center pivot offsets the rect by half its size");
+		graphics->SetPivotType(PivotType::LeftTop);
+
+		// カメラを右に動かすと描画位置は左にずれる
+		graphics->SetCamera(ScreenWidth / 2.0f + 100.0f, ScreenHeight / 2.0f, 1.0f, 0.0f);
+		graphics->StartDraw(0);
+		graphics->DrawRect(100.0f, 50.0f, 32.0f, 16.0f);
+		graphics->FinishDraw();
+		BenchCheck(recorder->GetVertices().empty() == false && IsNearPosition(recorder->GetVertices()[0], 0.0f, 50.0f), "camera translation moves the rect");
+		graphics->ResetCamera();
+
+		// 画面外の矩形は頂点を作成しない
+		graphics->StartDraw(0);
+		graphics->DrawRect(-1000.0f, -1000.0f, 32.0f, 16.0f);
+		graphics->FinishDraw();
+		BenchCheck(recorder->GetVertices().empty() == true && graphics->GetFrameStats().CulledCount == 1, "off-screen rect is culled");
+
+		// 円の頂点はフレームアロケーターに作成し、中心と外周の180個の三角形にする
+		graphics->StartDraw(0);
+		graphics->DrawCircle(200.0f, 100.0f, 10.0f, 0x0000ff00, 255);
+		graphics->FinishDraw();
+		BenchCheck(recorder->GetVertices().size() == 180 * 3, "DrawCircle records 180 triangles");
+		if (recorder->GetVertices().size() == 180 * 3)
+		{
+			const std::vector<CustomVertex>& vertices = recorder->GetVertices();
+			BenchCheck(IsNearPosition(vertices[0], 200.0f, 100.0f) && IsNearPosition(vertices[1], 210.0f, 100.0f), "DrawCircle starts at the center and the right edge");
+			BenchCheck(vertices[0].Color == 0xff00ff00, "DrawCircle adds alpha to the colour");
+		}
+
+		// 同じテクスチャの描画は1回の描画命令にまとめ、テクスチャが変わる時だけ区切る
+		Texture texture_a = { nullptr, 64, 64 };
+		Texture texture_b = { nullptr, 64, 64 };
+		CustomVertex triangle[3] =
+		{
+			{ 10.0f, 10.0f, 0.0f, 1.0f, 0xffffffff, 0.25f, 0.5f },
+			{ 20.0f, 10.0f, 0.0f, 1.0f, 0xffffffff, 0.75f, 0.5f },
+			{ 20.0f, 20.0f, 0.0f, 1.0f, 0xffffffff, 0.75f, 1.0f },
+		};
+
+		graphics->StartDraw(0);
+		for (int i = 0; i < 100; i++)
+		{
+			graphics->DrawTriangles(&texture_a, triangle, 3);
+		}
+		graphics->DrawTriangles(&texture_b, triangle, 3);
+		graphics->DrawTriangles(&texture_a, triangle, 3);
+		graphics->FinishDraw();
+
+		const std::vector<RecordedCommand>& commands = recorder->GetCommands();
+		BenchCheck(commands.size() == 3, "batches split only when the texture changes");
+		if (commands.size() == 3)
+		{
+			BenchCheck(commands[0].TextureData == &texture_a && commands[0].VertexCount == 300, "first batch holds all triangles of the same texture");
+			BenchCheck(commands[1].TextureData == &texture_b && commands[2].TextureData == &texture_a, "batches keep the draw order");
+		}
+		BenchCheck(recorder->GetVertices().empty() == false && recorder->GetVertices()[1].TextureX == 0.75f, "DrawTriangles keeps texture coordinates");
+
+		graphics->Release();
+	}
+
+	/** @brief Null描画バックエンドでの描画時間の計測 */
+	void MeasureDrawCost()
+	{
+		std::unique_ptr<Graphics> graphics = CreateBenchGraphics();
+		BenchCheck(graphics->Initialize(ScreenWidth, ScreenHeight, true, RenderBackendType::RenderBackendTypeNull), "initialize null backend");
+
+		Texture texture = { nullptr, 64, 64 };
+		CustomVertex quad[6] =
+		{
+			{ 0.0f, 0.0f, 0.0f, 1.0f, 0xffffffff, 0.0f, 0.0f },
+			{ 16.0f, 0.0f, 0.0f, 1.0f, 0xffffffff, 1.0f, 0.0f },
+			{ 16.0f, 16.0f, 0.0f, 1.0f, 0xffffffff, 1.0f, 1.0f },
+			{ 0.0f, 0.0f, 0.0f, 1.0f, 0xffffffff, 0.0f, 0.0f },
+			{ 16.0f, 16.0f, 0.0f, 1.0f, 0xffffffff, 1.0f, 1.0f },
+			{ 0.0f, 16.0f, 0.0f, 1.0f, 0xffffffff, 0.0f, 1.0f },
+		};
+
+		BenchTimer timer;
+		for (int frame = 0; frame < BenchFrameCount; frame++)
+		{
+			graphics->StartDraw(0);
+			for (int i = 0; i < BenchDrawCount; i++)
+			{
+				graphics->DrawRect((float)(i % 1200), (float)(i % 700), 16.0f, 16.0f, 0x00ffffff, 255, (float)(i % 360));
+			}
+			graphics->FinishDraw();
+		}
+		double rect_time = timer.GetElapsedTime() / BenchFrameCount;
+		FrameStats rect_stats = graphics->GetFrameStats();
+
+		timer.Reset();
+		for (int frame = 0; frame < BenchFrameCount; frame++)
+		{
+			graphics->StartDraw(0);
+			graphics->SetCamera(ScreenWidth / 2.0f + frame, ScreenHeight / 2.0f, 1.5f, 10.0f);
+			for (int i = 0; i < BenchDrawCount; i++)
+			{
+				graphics->DrawTriangles(&texture, quad, 6);
+			}
+			graphics->FinishDraw();
+		}
+		double triangle_time = timer.GetElapsedTime() / BenchFrameCount;
+		FrameStats triangle_stats = graphics->GetFrameStats();
+		graphics->ResetCamera();
+
+		// 遅延描画はレイヤーとテクスチャで並べ替えてからまとめる
+		Texture texture_list[4] = { texture, texture, texture, texture };
+		graphics->SetDeferredDrawing(true);
+		timer.Reset();
+		for (int frame = 0; frame < BenchFrameCount; frame++)
+		{
+			graphics->StartDraw(0);
+			for (int i = 0; i < BenchDrawCount; i++)
+			{
+				graphics->SetDrawLayer(i % 8);
+				graphics->DrawTriangles(&texture_list[i % 4], quad, 6);
+			}
+			graphics->FinishDraw();
+		}
+		double deferred_time = timer.GetElapsedTime() / BenchFrameCount;
+		FrameStats deferred_stats = graphics->GetFrameStats();
+		graphics->SetDeferredDrawing(false);
+
+		printf("  DrawRect x%d (rotated):          %8.3f ms/frame, %d draw calls, %d vertices\n", BenchDrawCount, rect_time, rect_stats.DrawCallCount, rect_stats.VertexCount);
+		printf("  DrawTriangles x%d (camera):      %8.3f ms/frame, %d draw calls, %d vertices\n", BenchDrawCount, triangle_time, triangle_stats.DrawCallCount, triangle_stats.VertexCount);
+		printf("  deferred x%d (8 layers, 4 tex):  %8.3f ms/frame, %d draw calls, %d vertices\n", BenchDrawCount, deferred_time, deferred_stats.DrawCallCount, deferred_stats.VertexCount);
+
+		BenchCheck(rect_stats.VertexCount == BenchDrawCount * 6, "every rect reaches the backend");
+		BenchCheck(deferred_stats.DrawCallCount <= 8 * 4 * 2, "deferred drawing merges draws per layer and texture");
+
+		graphics->Release();
+	}
+}
+
+void RunRenderBench()
+{
+	CheckRecordedVertices();
+	MeasureDrawCost();
+}
@@ -0,0 +1,186 @@
+﻿/**
+* @file RenderThreadBench.cpp
+* @brief <pre>
+* 描画スレッドのベンチマークと検証
+* パーティクルの更新と命令の記録(ゲームスレッドの処理)と、命令リストの描画(描画スレッドの処理)を
+* 1つのスレッドで順番に行った場合と、描画スレッドで重ねて行った場合の1フレームの時間をNull描画バックエンドで比較する
+* </pre>
+*/
+#include <stdio.h>
+#include <thread>
+#include "EngineBench.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/Graphics.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/ParticleEmitter.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/RenderThread.h"
+
+namespace
+{
+	const int ScreenWidth = 1280;				//!< 画面の横幅
+	const int ScreenHeight = 720;				//!< 画面の縦幅
+	const int BenchFrameCount = 200;			//!< 計測するフレーム数
+	const int BenchCommandCount = 20000;		//!< 1フレームに記録する命令数
+	const int BenchParticleCount = 50000;			//!< ゲームスレッドで更新するパーティクル数
+	const float FrameTime = 1.0f / 60.0f;		//!< 1フレームの経過時間(秒)
+
+	/**
+	* @brief ゲームスレッドの1フレームの処理
+	* @details パーティクルを更新し、命令リストに矩形を記録する
+	* @param[in,out] emitter 更新するパーティクル
+	* @param[out] command_list 記録先の命令リスト
+	* @param[in] texture 使用するテクスチャ
+	* @param[in] frame フレーム番号
+	*/
+	void SimulateFrame(ParticleEmitter* emitter, DrawCommandList* command_list, const Texture* texture, int frame)
+	{
+		emitter->Update(FrameTime, nullptr);
+
+		for (int i = 0; i < BenchCommandCount; i++)
+		{
+			float x = (float)((i * 7 + frame) % (ScreenWidth - 16));
+			float y = (float)((i * 13) % (ScreenHeight - 16));
+
+			CustomVertex* v = command_list->AddCommand(texture, 6, 0, TextureFilterPoint);
+			const float corner_x[6] = { 0.0f, 16.0f, 16.0f, 0.0f, 16.0f, 0.0f };
+			const float corner_y[6] = { 0.0f, 0.0f, 16.0f, 0.0f, 16.0f, 16.0f };
+			for (int k = 0; k < 6; k++)
+			{
+				v[k].X = x + corner_x[k];
+				v[k].Y = y + corner_y[k];
+				v[k].Z = 0.0f;
+				v[k].Rhw = 1.0f;
+				v[k].Color = 0xffffffff;
+				v[k].TextureX = corner_x[k] / 16.0f;
+				v[k].TexrureY = corner_y[k] / 16.0f;
+			}
+		}
+	}
+
+	/**
+	* @brief パーティクルの初期化関数
+	* @param[out] emitter 初期化するパーティクル
+	*/
+	void InitializeEmitter(ParticleEmitter* emitter)
+	{
+		ParticleEmitterDesc desc;
+		desc.MaxParticles = BenchParticleCount;
+		desc.EmitRate = 0.0f;
+		desc.LifeMin = 100.0f;
+		desc.LifeMax = 100.0f;
+		desc.GravityY = 98.0f;
+
+		emitter->Initialize(desc);
+		emitter->Emit(BenchParticleCount);
+	}
+
+	/**
+	* @brief 1つのスレッドで順番に処理した場合の計測
+	* @retval double 1フレームの時間(ミリ秒)
+	* @param[out] out_simulate_time ゲームスレッドの処理の時間(ミリ秒)
+	* @param[out] out_draw_time 描画の時間(ミリ秒)
+	*/
+	double MeasureSerial(double* out_simulate_time, double* out_draw_time)
+	{
+		std::unique_ptr<Graphics> graphics = CreateBenchGraphics();
+		BenchCheck(graphics->Initialize(ScreenWidth, ScreenHeight, true, RenderBackendType::RenderBackendTypeNull), "initialize null backend");
+
+		ParticleEmitter emitter;
+		InitializeEmitter(&emitter);
+
+		Texture texture = { nullptr, 16, 16 };
+		DrawCommandList command_list;
+		double simulate_time = 0.0;
+		double draw_time = 0.0;
+
+		BenchTimer frame_timer;
+		for (int frame = 0; frame < BenchFrameCount; frame++)
+		{
+			BenchTimer timer;
+			command_list.Clear();
+			SimulateFrame(&emitter, &command_list, &texture, frame);
+			simulate_time += timer.GetElapsedTime();
+
+			timer.Reset();
+			graphics->StartDraw(0);
+			graphics->SubmitCommandList(command_list);
+			graphics->FinishDraw();
+			draw_time += timer.GetElapsedTime();
+		}
+		double frame_time = frame_timer.GetElapsedTime() / BenchFrameCount;
+
+		BenchCheck(graphics->GetFrameStats().VertexCount == BenchCommandCount * 6, "serial frame draws every command");
+
+		*out_simulate_time = simulate_time / BenchFrameCount;
+		*out_draw_time = draw_time / BenchFrameCount;
+
+		command_list.Release();
+		emitter.Release();
+		graphics->Release();
+
+		return frame_time;
+	}
+
+	/**
+	* @brief 描画スレッドで重ねて処理した場合の計測
+	* @retval double 1フレームの時間(ミリ秒)
+	* @param[in] frame_count 処理中にできるフレーム数
+	*/
+	double MeasureOverlapped(int frame_count)
+	{
+		std::unique_ptr<Graphics> graphics = CreateBenchGraphics();
+		BenchCheck(graphics->Initialize(ScreenWidth, ScreenHeight, true, RenderBackendType::RenderBackendTypeNull), "initialize null backend");
+
+		ParticleEmitter emitter;
+		InitializeEmitter(&emitter);
+
+		Texture texture = { nullptr, 16, 16 };
+		RenderThread render_thread;
+		BenchCheck(render_thread.Start(graphics.get(), nullptr, frame_count), "start render thread");
+
+		// 描画スレッドがフレームNを描画している間にフレームN+1を処理する
+		BenchTimer timer;
+		for (int frame = 0; frame < BenchFrameCount; frame++)
+		{
+			RenderFrame* render_frame = render_thread.BeginFrame();
+			if (render_frame == nullptr)
+			{
+				break;
+			}
+
+			SimulateFrame(&emitter, &render_frame->CommandList, &texture, frame);
+			render_thread.SubmitFrame();
+		}
+		render_thread.WaitIdle();
+		double frame_time = timer.GetElapsedTime() / BenchFrameCount;
+
+		BenchCheck(render_thread.GetPendingFrameCount() == 0, "render thread drains every submitted frame");
+		render_thread.Stop();
+
+		BenchCheck(graphics->GetFrameStats().VertexCount == BenchCommandCount * 6, "render thread draws every command of the last frame");
+
+		emitter.Release();
+		graphics->Release();
+
+		return frame_time;
+	}
+}
+
+void RunRenderThreadBench()
+{
+	double simulate_time = 0.0;
+	double draw_time = 0.0;
+	double serial_time = MeasureSerial(&simulate_time, &draw_time);
+
+	printf("  serial:                      %8.3f ms/frame (update and record %.3f ms + draw %.3f ms)\n", serial_time, simulate_time, draw_time);
+
+	for (int frame_count = 2; frame_count <= MaxRenderFramesInFlight; frame_count *= 2)
+	{
+		double overlapped_time = MeasureOverlapped(frame_count);
+		printf("  render thread (%d in flight): %8.3f ms/frame (x%.2f)\n",
+			frame_count, overlapped_time, overlapped_time > 0.0 ? serial_time / overlapped_time : 0.0);
+	}
+
+	if (std::thread::hardware_concurrency() < 2)
+	{
+		printf("  (single core: the render thread cannot overlap)\n");
+	}
+}
@@ -0,0 +1,444 @@
+﻿/**
+* @file TextureCacheBench.cpp
+* @brief <pre>
+* テクスチャキャッシュのベンチマークと検証
+* 作業フォルダにコピーした画像を、キャッシュなし、キャッシュありの初回起動(デコードして保存)、
+* 2回目以降の起動(メモリマップで読み込み)で作成する時間を計測し、
+* ヘッダーが壊れたキャッシュや、元のファイルが更新されたキャッシュを使用しないことを検証する
+* D3DXで画像をデコードするので、GraphicsはSoftware描画バックエンド(NULLREFデバイス)で初期化する
+* </pre>
+*/
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "EngineBench.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/FileSystem.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/Graphics.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/TextureCache.h"
+
+namespace
+{
+	const char SourceFileName[] = "Res/bomb_move.png";				//!< コピー元の画像ファイル
+	const char TextureDirectory[] = "BenchWork/Textures";			//!< コピーした画像を置くフォルダ
+	const char CacheDirectory[] = "BenchWork/TextureCache";			//!< キャッシュファイルを保存するフォルダ
+	const int BenchTextureCount = 64;								//!< 起動時に読み込む画像の数
+	const int TestWidth = 16;										//!< ヘッダーの検証で保存するテクセルの横幅
+	const int TestHeight = 8;										//!< ヘッダーの検証で保存するテクセルの縦幅
+
+	// TextureCache.cppのTextureCacheHeaderのメンバーの位置
+	const long HeaderMagicOffset = 0;		//!< 識別子
+	const long HeaderVersionOffset = 4;		//!< 形式のバージョン
+	const long HeaderWidthOffset = 8;		//!< 横幅
+	const long HeaderColorKeyOffset = 40;	//!< 適用したカラーキー
+
+	/**
+	* @brief ファイルの一部の上書き関数
+	* @retval true 上書き成功
+	* @retval false 上書き失敗
+	* @param[in] file_name ファイル名
+	* @param[in] offset 上書きする位置
+	* @param[in] data 書き込む内容
+	* @param[in] size バイト数
+	*/
+	bool PatchBenchFile(const char* file_name, long offset, const void* data, size_t size)
+	{
+		FILE* fp = nullptr;
+		if (fopen_s(&fp, file_name, "r+b") != 0)
+		{
+			return false;
+		}
+
+		bool is_succeeded = fseek(fp, offset, SEEK_SET) == 0 &&
+			fwrite(data, size, 1, fp) == 1;
+		fclose(fp);
+
+		return is_succeeded;
+	}
+
+	/**
+	* @brief ファイルの切り詰め関数
+	* @retval true 切り詰め成功
+	* @retval false 切り詰め失敗
+	* @param[in] file_name ファイル名
+	* @param[in] size 残すバイト数
+	*/
+	bool TruncateBenchFile(const char* file_name, size_t size)
+	{
+		FileData file_data;
+		if (FileSystem::ReadLooseFile(file_name, &file_data) == false ||
+			file_data.Size < size)
+		{
+			return false;
+		}
+
+		return WriteBenchFile(file_name, file_data.Data, size);
+	}
+
+	/**
+	* @brief 更新日時を進める関数
+	* @details 内容とサイズを変えずに、元のファイルの更新日時だけが変わった場合を再現する
+	* @retval true 変更成功
+	* @retval false 変更失敗
+	* @param[in] file_name ファイル名
+	*/
+	bool TouchBenchFile(const char* file_name)
+	{
+		HANDLE file = CreateFile(
+			file_name,
+			FILE_WRITE_ATTRIBUTES,
+			FILE_SHARE_READ | FILE_SHARE_WRITE,
+			nullptr,
+			OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL,
+			nullptr);
+
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		// 1秒(100ナノ秒単位)進める
+		FILETIME write_time;
+		bool is_succeeded = GetFileTime(file, nullptr, nullptr, &write_time) != FALSE;
+		if (is_succeeded == true)
+		{
+			unsigned long long time = ((unsigned long long)write_time.dwHighDateTime << 32) | write_time.dwLowDateTime;
+			time += 10000000ULL;
+			write_time.dwLowDateTime = (DWORD)time;
+			write_time.dwHighDateTime = (DWORD)(time >> 32);
+			is_succeeded = SetFileTime(file, nullptr, nullptr, &write_time) != FALSE;
+		}
+
+		CloseHandle(file);
+
+		return is_succeeded;
+	}
+
+	/**
+	* @brief キャッシュファイル名の作成関数
+	* @details TextureCache::MakeCacheFileNameと同じ規則で作成する
+	* @retval std::string キャッシュファイル名
+	* @param[in] file_name 元の画像ファイル名
+	*/
+	std::string MakeCacheFilePath(const char* file_name)
+	{
+		std::string cache_file_name = file_name;
+
+		for (char& c : cache_file_name)
+		{
+			if (c == '/' || c == '\\' || c == ':')
+			{
+				c = '_';
+			}
+		}
+
+		return std::string(CacheDirectory) + "/" + cache_file_name + TextureCacheExtension;
+	}
+
+	/**
+	* @brief 読み込む画像の作成関数
+	* @details コピー元の画像を作業フォルダにコピーする(書き直すので前回のキャッシュは更新日時が合わずに無効になる)
+	* @retval true 作成成功
+	* @retval false 作成失敗
+	* @param[out] out_file_list コピーした画像ファイル名
+	*/
+	bool PrepareTextures(std::vector<std::string>* out_file_list)
+	{
+		FileData source;
+		if (FileSystem::ReadLooseFile(SourceFileName, &source) == false)
+		{
+			return false;
+		}
+
+		CreateDirectory(BenchWorkDirectory, nullptr);
+		CreateDirectory(TextureDirectory, nullptr);
+
+		for (int i = 0; i < BenchTextureCount; i++)
+		{
+			char file_name[MAX_PATH];
+			sprintf_s(file_name, sizeof(file_name), "%s/Texture%03d.png", TextureDirectory, i);
+
+			DeleteFile(MakeCacheFilePath(file_name).c_str());
+			if (WriteBenchFile(file_name, source.Data, source.Size) == false)
+			{
+				return false;
+			}
+			out_file_list->push_back(file_name);
+		}
+
+		return true;
+	}
+
+	/**
+	* @brief 1回の起動で画像を読み込む時間の計測
+	* @retval double 全ての画像を作成する時間(ミリ秒、Graphicsの初期化は含まない)
+	* @param[in] file_list 読み込む画像ファイル名
+	* @param[in] is_cache_enabled キャッシュを使用するか
+	* @param[out] out_stats キャッシュの使用状況
+	*/
+	double MeasureStartup(const std::vector<std::string>& file_list, bool is_cache_enabled, TextureCacheStats* out_stats)
+	{
+		std::unique_ptr<Graphics> graphics = CreateBenchGraphics();
+		if (graphics->Initialize(256, 256, true, RenderBackendType::RenderBackendTypeSoftware) == false ||
+			(is_cache_enabled == true && graphics->EnableTextureCache(CacheDirectory) == false))
+		{
+			BenchCheck(false, "initialize software backend with the texture cache");
+			graphics->Release();
+			return 0.0;
+		}
+
+		std::vector<Texture> texture_list(file_list.size());
+		int created_count = 0;
+
+		BenchTimer timer;
+		for (size_t i = 0; i < file_list.size(); i++)
+		{
+			if (graphics->CreateTexture(file_list[i].c_str(), &texture_list[i]) == true)
+			{
+				created_count++;
+			}
+		}
+		double startup_time = timer.GetElapsedTime();
+
+		BenchCheck(created_count == (int)file_list.size(), "every texture is created");
+
+		for (Texture& texture : texture_list)
+		{
+			if (texture.TextureData != nullptr)
+			{
+				texture.TextureData->Release();
+			}
+		}
+
+		*out_stats = graphics->GetTextureCacheStats();
+		graphics->Release();
+
+		return startup_time;
+	}
+
+	/**
+	* @brief キャッシュから読み込んだテクセルとデコードしたテクセルの比較
+	* @param[in] file_name 比較する画像ファイル名(キャッシュ保存済み)
+	*/
+	void CheckCachedPixels(const char* file_name)
+	{
+		std::unique_ptr<Graphics> decoder = CreateBenchGraphics();
+		std::unique_ptr<Graphics> cached = CreateBenchGraphics();
+		if (decoder->Initialize(256, 256, true, RenderBackendType::RenderBackendTypeSoftware) == false ||
+			cached->Initialize(256, 256, true, RenderBackendType::RenderBackendTypeSoftware) == false ||
+			cached->EnableTextureCache(CacheDirectory) == false)
+		{
+			BenchCheck(false, "initialize software backend with the texture cache");
+			cached->Release();
+			decoder->Release();
+			return;
+		}
+
+		int width = 0;
+		int height = 0;
+		std::vector<DWORD> pixels;
+		FileContentHash hash;
+		int cached_width = 0;
+		int cached_height = 0;
+		std::vector<DWORD> cached_pixels;
+		FileContentHash cached_hash;
+
+		bool is_decoded = decoder->DecodeTexture(file_name, &width, &height, &pixels, &hash);
+		bool is_loaded = cached->DecodeTexture(file_name, &cached_width, &cached_height, &cached_pixels, &cached_hash);
+
+		BenchCheck(is_decoded == true && is_loaded == true && cached->GetTextureCacheStats().HitCount == 1, "second start reads texels from the cache");
+		BenchCheck(width == cached_width && height == cached_height && pixels == cached_pixels, "cached texels match freshly decoded texels");
+		BenchCheck(hash.Value == cached_hash.Value && hash.Size == cached_hash.Size, "cached content hash matches the source file");
+
+		cached->Release();
+		decoder->Release();
+	}
+
+	/** @brief 起動時間の計測 */
+	void MeasureStartupTime()
+	{
+		std::vector<std::string> file_list;
+		if (PrepareTextures(&file_list) == false)
+		{
+			BenchCheck(false, "copy Res/bomb_move.png into BenchWork/Textures");
+			return;
+		}
+
+		// キャッシュなし、キャッシュありの初回、2回目の順に起動する
+		TextureCacheStats decode_stats;
+		TextureCacheStats first_stats;
+		TextureCacheStats cached_stats;
+		double decode_time = MeasureStartup(file_list, false, &decode_stats);
+		double first_time = MeasureStartup(file_list, true, &first_stats);
+		double cached_time = MeasureStartup(file_list, true, &cached_stats);
+
+		BenchCheck(first_stats.MissCount == BenchTextureCount && first_stats.HitCount == 0, "first start decodes and writes every texture");
+		BenchCheck(cached_stats.HitCount == BenchTextureCount && cached_stats.MissCount == 0, "second start hits the cache for every texture");
+
+		CheckCachedPixels(file_list[0].c_str());
+
+		// ファイルはOSのファイルキャッシュに載った状態で計測する(コールドスタートはOSの再起動後の初回起動で計測する)
+		printf("  %d textures (%s)\n", BenchTextureCount, SourceFileName);
+		printf("  decode every start:      %8.3f ms\n", decode_time);
+		printf("  first start (write):     %8.3f ms, hit %d, miss %d\n", first_time, first_stats.HitCount, first_stats.MissCount);
+		printf("  cached start (mapped):   %8.3f ms, hit %d, miss %d (x%.2f)\n",
+			cached_time, cached_stats.HitCount, cached_stats.MissCount, cached_time > 0.0 ? decode_time / cached_time : 0.0);
+	}
+
+	/**
+	* @brief 検証用のキャッシュの保存関数
+	* @retval true 保存して有効なキャッシュとして開けた
+	* @retval false 保存失敗
+	* @param[in] cache 初期化済みのテクスチャキャッシュ
+	* @param[in] file_name 元の画像ファイル名
+	* @param[in] pixels 保存するテクセル
+	*/
+	bool WriteTestCache(TextureCache* cache, const char* file_name, const std::vector<DWORD>& pixels)
+	{
+		if (cache->Write(file_name, TestWidth, TestHeight, &pixels[0], 0x123456789abcdef0ULL) == false)
+		{
+			return false;
+		}
+
+		TextureCacheView view;
+		if (cache->Open(file_name, &view) == false)
+		{
+			return false;
+		}
+		cache->Close(&view);
+
+		return true;
+	}
+
+	/**
+	* @brief 無効なキャッシュの検証
+	* @details キャッシュを開けずに、デコードし直す数に加えられることを確認する
+	* @param[in] cache 初期化済みのテクスチャキャッシュ
+	* @param[in] file_name 元の画像ファイル名
+	* @param[in] description 検証内容の説明
+	*/
+	void CheckRejected(TextureCache* cache, const char* file_name, const char* description)
+	{
+		int miss_count = cache->GetStats().MissCount;
+
+		TextureCacheView view;
+		bool is_opened = cache->Open(file_name, &view);
+		if (is_opened == true)
+		{
+			cache->Close(&view);
+		}
+
+		BenchCheck(is_opened == false && cache->GetStats().MissCount == miss_count + 1, description);
+	}
+
+	/** @brief キャッシュファイルのヘッダーの検証 */
+	void CheckCacheHeader()
+	{
+		CreateDirectory(BenchWorkDirectory, nullptr);
+		CreateDirectory(TextureDirectory, nullptr);
+
+		// デコードはしないので、元のファイルは内容が画像でなくてもよい
+		const char file_name[] = "BenchWork/Textures/HeaderTest.png";
+		const char source_text[] = "texture cache header test";
+		if (WriteBenchFile(file_name, source_text, sizeof(source_text)) == false)
+		{
+			BenchCheck(false, "write header test source file");
+			return;
+		}
+
+		std::vector<DWORD> pixels(TestWidth * TestHeight);
+		for (size_t i = 0; i < pixels.size(); i++)
+		{
+			pixels[i] = 0xff000000 | (DWORD)(i * 0x010203);
+		}
+
+		TextureCache cache;
+		if (cache.Initialize(CacheDirectory) == false)
+		{
+			BenchCheck(false, "initialize texture cache");
+			return;
+		}
+
+		std::string cache_file_name = MakeCacheFilePath(file_name);
+		size_t cache_size = TextureCacheHeaderSize + pixels.size() * sizeof(DWORD);
+
+		// 正しいキャッシュは内容とヘッダーの値をそのまま参照できる
+		BenchCheck(cache.Write(file_name, TestWidth, TestHeight, &pixels[0], 0x123456789abcdef0ULL), "cache file is written");
+		TextureCacheView view;
+		if (cache.Open(file_name, &view) == true)
+		{
+			BenchCheck(view.Width == TestWidth && view.Height == TestHeight && memcmp(view.Pixels, &pixels[0], pixels.size() * sizeof(DWORD)) == 0, "valid cache maps the stored texels");
+			BenchCheck(view.SourceHash == 0x123456789abcdef0ULL && view.SourceSize == sizeof(source_text), "valid cache keeps the source hash and size");
+			BenchCheck(((size_t)view.Pixels - (size_t)view.MappedData) == TextureCacheHeaderSize, "texels start right after the header");
+			cache.Close(&view);
+		}
+		else
+		{
+			BenchCheck(false, "valid cache is opened");
+		}
+
+		const char bad_magic[4] = { 'X', 'X', 'X', 'X' };
+		WriteTestCache(&cache, file_name, pixels);
+		PatchBenchFile(cache_file_name.c_str(), HeaderMagicOffset, bad_magic, sizeof(bad_magic));
+		CheckRejected(&cache, file_name, "cache with a bad magic is rejected");
+
+		unsigned int old_version = TextureCacheVersion - 1;
+		WriteTestCache(&cache, file_name, pixels);
+		PatchBenchFile(cache_file_name.c_str(), HeaderVersionOffset, &old_version, sizeof(old_version));
+		CheckRejected(&cache, file_name, "cache with an old format version is rejected");
+
+		DWORD other_color_key = 0x00ff00ff;
+		WriteTestCache(&cache, file_name, pixels);
+		PatchBenchFile(cache_file_name.c_str(), HeaderColorKeyOffset, &other_color_key, sizeof(other_color_key));
+		CheckRejected(&cache, file_name, "cache written with another colour key is rejected");
+
+		// 横幅を大きくするとテクセルがファイルの外にはみ出すので、サイズの検証で弾く
+		unsigned int huge_width = 0x40000000;
+		WriteTestCache(&cache, file_name, pixels);
+		PatchBenchFile(cache_file_name.c_str(), HeaderWidthOffset, &huge_width, sizeof(huge_width));
+		CheckRejected(&cache, file_name, "cache whose size does not cover width x height is rejected");
+
+		// 書き込みを中断したファイルはヘッダーが0のまま残る
+		std::vector<char> zero_header(TextureCacheHeaderSize, 0);
+		WriteTestCache(&cache, file_name, pixels);
+		PatchBenchFile(cache_file_name.c_str(), HeaderMagicOffset, &zero_header[0], zero_header.size());
+		CheckRejected(&cache, file_name, "cache with an unwritten header is rejected");
+
+		WriteTestCache(&cache, file_name, pixels);
+		TruncateBenchFile(cache_file_name.c_str(), cache_size - 4);
+		CheckRejected(&cache, file_name, "cache with truncated texels is rejected");
+
+		WriteTestCache(&cache, file_name, pixels);
+		TruncateBenchFile(cache_file_name.c_str(), TextureCacheHeaderSize / 2);
+		CheckRejected(&cache, file_name, "cache shorter than the header is rejected");
+
+		WriteTestCache(&cache, file_name, pixels);
+		TruncateBenchFile(cache_file_name.c_str(), 0);
+		CheckRejected(&cache, file_name, "empty cache file is rejected");
+
+		// 元のファイルの更新
+		WriteTestCache(&cache, file_name, pixels);
+		BenchCheck(TouchBenchFile(file_name), "source write time is changed");
+		CheckRejected(&cache, file_name, "cache is rejected when the source write time changes");
+
+		const char longer_text[] = "texture cache header test, edited";
+		WriteTestCache(&cache, file_name, pixels);
+		WriteBenchFile(file_name, longer_text, sizeof(longer_text));
+		CheckRejected(&cache, file_name, "cache is rejected when the source size changes");
+
+		BenchCheck(WriteTestCache(&cache, file_name, pixels), "rewritten cache is valid again");
+
+		DeleteFile(file_name);
+		CheckRejected(&cache, file_name, "cache is rejected when the source file is deleted");
+
+		DeleteFile(cache_file_name.c_str());
+		cache.Release();
+	}
+}
+
+void RunTextureCacheBench()
+{
+	CheckCacheHeader();
+	MeasureStartupTime();
+}
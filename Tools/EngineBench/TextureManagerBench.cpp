@@ -0,0 +1,231 @@
+﻿/**
+* @file TextureManagerBench.cpp
+* @brief <pre>
+* テクスチャの予算と解放(TextureManager::EvictTextures)のベンチマークと検証
+* デバイスを使用しないTextureLoaderに差し替え、予算、最後に使用したフレームの古い順の解放、
+* 処理中のフレームで使用したテクスチャを解放しないこと、解放したテクスチャを使用時に読み込み直すことを検証し、
+* 多数のテクスチャから解放する時間を計測する
+* </pre>
+*/
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "EngineBench.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/TextureManager.h"
+
+namespace
+{
+	const int TextureSize = 64;										//!< 作成するテクスチャの横幅、縦幅
+	const size_t TextureByteSize = TextureSize * TextureSize * 4;	//!< テクスチャ1枚のバイト数
+	const int BenchTextureCount = 4096;								//!< 計測で登録するテクスチャの数
+	const int BenchRepeatCount = 20;								//!< 計測の繰り返し回数
+
+	/**
+	* @brief デバイスを使用しないテクスチャローダー
+	* @details ファイルを読み込まずに同じサイズのテクスチャを作成し、読み込みと解放を記録する
+	*/
+	class FakeTextureLoader : public TextureLoader
+	{
+	public:
+		/** Constructor */
+		FakeTextureLoader() :
+			LoadCount(0),
+			UnloadList()
+		{
+		}
+
+		bool Load(const char* file_name, Texture* out_texture, FileContentHash* out_hash) override
+		{
+			out_texture->TextureData = nullptr;
+			out_texture->Width = TextureSize;
+			out_texture->Height = TextureSize;
+
+			// ファイル名ごとに違う内容として扱い、共有させない
+			std::string name = file_name;
+			*out_hash = FileSystem::MakeContentHash(name.c_str(), name.size());
+
+			LoadCount++;
+			return true;
+		}
+
+		void Unload(Texture* texture) override
+		{
+			UnloadList.push_back(texture);
+			texture->TextureData = nullptr;
+		}
+
+		int LoadCount;						//!< Loadを実行した回数
+		std::vector<Texture*> UnloadList;	//!< 解放したテクスチャ(解放した順)
+	};
+
+	/**
+	* @brief テクスチャの登録関数
+	* @details 1フレームに1枚ずつ読み込み、登録したテクスチャを返す
+	* @param[in,out] manager 登録先
+	* @param[in] count 登録する数
+	* @param[out] out_texture_list 登録したテクスチャ(GetTextureで取得したもの)
+	*/
+	void LoadTextures(TextureManager* manager, int count, std::vector<Texture*>* out_texture_list)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			std::string keyword = "tex" + std::to_string(i);
+			std::string file_name = "Res/" + keyword + ".png";
+			BenchCheck(manager->LoadTexture(keyword.c_str(), file_name.c_str()), "load texture through the fake loader");
+
+			// 読み込んだフレームと同じフレームなので、最後に使用したフレームは変わらない
+			out_texture_list->push_back(manager->GetTexture(keyword.c_str()));
+			manager->NextFrame();
+		}
+	}
+
+	/**
+	* @brief フレームを進める関数
+	* @param[in,out] manager フレームを進めるTextureManager
+	* @param[in] count 進めるフレーム数
+	*/
+	void AdvanceFrames(TextureManager* manager, int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			manager->NextFrame();
+		}
+	}
+
+	/** @brief 予算と最後に使用したフレームの古い順の解放の検証 */
+	void CheckBudgetAndOrder()
+	{
+		FakeTextureLoader loader;
+		TextureManager manager;
+		manager.Initialize(&loader);
+		manager.SetBudget(TextureByteSize * 4);
+
+		// tex0～7をフレーム0～7で読み込み、tex0だけフレーム10で使用する
+		std::vector<Texture*> texture_list;
+		LoadTextures(&manager, 8, &texture_list);
+		BenchCheck(manager.IsOverBudget() == true && manager.GetStats().ResidentSize == TextureByteSize * 8, "eight textures exceed a four-texture budget");
+
+		AdvanceFrames(&manager, 2);
+		manager.TouchTexture(texture_list[0]);
+		AdvanceFrames(&manager, 20);
+
+		int eviction_count = manager.EvictTextures();
+		BenchCheck(eviction_count == 4, "eviction stops once the budget is met");
+		BenchCheck(manager.IsOverBudget() == false && manager.GetStats().ResidentSize == TextureByteSize * 4, "resident size is back within the budget");
+		BenchCheck(manager.GetStats().ResidentCount == 4 && manager.GetStats().TextureCount == 8, "evicted textures stay registered");
+
+		const int expected_order[4] = { 1, 2, 3, 4 };
+		bool is_lru_order = loader.UnloadList.size() == 4;
+		for (size_t i = 0; i < loader.UnloadList.size() && is_lru_order == true; i++)
+		{
+			is_lru_order = loader.UnloadList[i] == texture_list[expected_order[i]];
+		}
+		BenchCheck(is_lru_order == true, "least recently used textures are evicted first (tex0 was touched later)");
+
+		// 予算内の場合は何もしない
+		BenchCheck(manager.EvictTextures() == 0, "no eviction within the budget");
+
+		manager.Release();
+	}
+
+	/** @brief 処理中のフレームで使用したテクスチャを解放しないことの検証 */
+	void CheckInFlightGuard()
+	{
+		FakeTextureLoader loader;
+		TextureManager manager;
+		manager.Initialize(&loader);
+		manager.SetBudget(TextureByteSize * 2);
+
+		std::vector<Texture*> texture_list;
+		LoadTextures(&manager, 4, &texture_list);
+
+		// 最後に読み込んだtex3はフレーム3で使用しているので、フレーム3+TextureEvictionGuardFramesまでは解放できない
+		BenchCheck(manager.EvictTextures() == 0 && loader.UnloadList.empty() == true, "textures used in frames still in flight are not evicted");
+		BenchCheck(manager.IsOverBudget() == true, "budget stays exceeded while every texture is guarded");
+
+		// tex0だけが保護の期間を過ぎたフレームで解放する
+		AdvanceFrames(&manager, TextureEvictionGuardFrames - 4);
+		BenchCheck(manager.EvictTextures() == 1 && loader.UnloadList.size() == 1 && loader.UnloadList[0] == texture_list[0], "only textures older than the guard are evicted");
+
+		// 直前に使用したテクスチャは古いテクスチャが残っていても解放しない
+		AdvanceFrames(&manager, TextureEvictionGuardFrames);
+		manager.TouchTexture(texture_list[1]);
+		manager.NextFrame();
+		int eviction_count = manager.EvictTextures();
+		BenchCheck(eviction_count == 1 && loader.UnloadList.back() == texture_list[2], "recently touched texture is skipped");
+
+		manager.Release();
+	}
+
+	/** @brief 解放したテクスチャを使用時に読み込み直すことの検証 */
+	void CheckReloadOnUse()
+	{
+		FakeTextureLoader loader;
+		TextureManager manager;
+		manager.Initialize(&loader);
+		manager.SetBudget(TextureByteSize);
+
+		std::vector<Texture*> texture_list;
+		LoadTextures(&manager, 2, &texture_list);
+		AdvanceFrames(&manager, TextureEvictionGuardFrames);
+		BenchCheck(manager.EvictTextures() == 1 && loader.UnloadList[0] == texture_list[0], "oldest texture is evicted");
+
+		int load_count = loader.LoadCount;
+		Texture* texture = manager.GetTexture("tex0");
+		BenchCheck(texture == texture_list[0], "reloaded texture keeps its address");
+		BenchCheck(loader.LoadCount == load_count + 1 && manager.GetStats().ReloadCount == 1, "GetTexture reloads an evicted texture");
+		BenchCheck(texture != nullptr && texture->Width == TextureSize && manager.GetStats().ResidentCount == 2, "reloaded texture is resident again");
+
+		// 読み込み直したテクスチャは直近で使用したので、次の解放ではもう一方が解放される
+		AdvanceFrames(&manager, TextureEvictionGuardFrames);
+		manager.GetTexture("tex0");
+		AdvanceFrames(&manager, TextureEvictionGuardFrames);
+		manager.EvictTextures();
+		BenchCheck(loader.UnloadList.back() == texture_list[1], "reloaded texture counts as recently used");
+
+		// 使用記録(描画コマンドのテクスチャ)でも読み込み直す
+		manager.TouchTexture(texture_list[1]);
+		BenchCheck(loader.LoadCount == load_count + 2 && manager.GetStats().ReloadCount == 2, "TouchTexture reloads an evicted texture");
+
+		manager.Release();
+	}
+}
+
+void RunTextureManagerBench()
+{
+	CheckBudgetAndOrder();
+	CheckInFlightGuard();
+	CheckReloadOnUse();
+
+	// 多数のテクスチャから予算を超えた分を解放し、使用して読み込み直す
+	FakeTextureLoader loader;
+	TextureManager manager;
+	manager.Initialize(&loader);
+
+	std::vector<Texture*> texture_list;
+	LoadTextures(&manager, BenchTextureCount, &texture_list);
+	manager.SetBudget(TextureByteSize * BenchTextureCount / 2);
+
+	double evict_time = 0.0;
+	int eviction_count = 0;
+	for (int i = 0; i < BenchRepeatCount; i++)
+	{
+		AdvanceFrames(&manager, TextureEvictionGuardFrames);
+
+		BenchTimer timer;
+		eviction_count += manager.EvictTextures();
+		evict_time += timer.GetElapsedTime();
+
+		for (Texture* texture : texture_list)
+		{
+			manager.TouchTexture(texture);
+		}
+	}
+	evict_time /= BenchRepeatCount;
+
+	BenchCheck(eviction_count == BenchRepeatCount * BenchTextureCount / 2, "each pass evicts half of the textures");
+
+	printf("  EvictTextures (%d textures, half over budget): %8.3f ms, %d reloads\n", BenchTextureCount, evict_time, manager.GetStats().ReloadCount);
+
+	manager.Release();
+}
@@ -0,0 +1,202 @@
+﻿/**
+* @file TilemapBench.cpp
+* @brief <pre>
+* タイルマップのベンチマークと検証
+* 200x200タイルのマップでチャンクの作成時間と、スクロールしながら描画する1フレームの時間を計測し、
+* タイルごとにUVを計算してDrawTrianglesで全タイルを描画する場合と比較する
+* </pre>
+*/
+#include <stdio.h>
+#include "EngineBench.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/Graphics.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/RecordingRenderBackend.h"
+#include "../../DirectX2DLibraryCpp/Src/Engine/Tilemap.h"
+
+namespace
+{
+	const int ScreenWidth = 1280;		//!< 画面の横幅
+	const int ScreenHeight = 720;		//!< 画面の縦幅
+	const int MapColumns = 200;			//!< マップの横のタイル数
+	const int MapRows = 200;			//!< マップの縦のタイル数
+	const int TileSize = 32;			//!< タイルの一辺の長さ
+	const int TilesetSize = 256;		//!< タイルセットの一辺の長さ
+	const int TilesetColumns = TilesetSize / TileSize;	//!< タイルセットの横のタイル数
+	const int BenchFrameCount = 300;	//!< 計測するフレーム数
+
+	/**
+	* @brief タイル番号の取得関数
+	* @retval int テスト用のマップのタイル番号
+	* @param[in] column 列
+	* @param[in] row 行
+	*/
+	int GetTestTile(int column, int row)
+	{
+		return (row * 7 + column) % (TilesetColumns * TilesetColumns);
+	}
+
+	/**
+	* @brief スクロール中のカメラの設定関数
+	* @param[in] graphics 設定するGraphics
+	* @param[in] frame フレーム番号
+	*/
+	void SetScrollCamera(Graphics* graphics, int frame)
+	{
+		graphics->SetCamera(ScreenWidth / 2.0f + frame * 10.0f, ScreenHeight / 2.0f + frame * 5.0f, 1.0f, 0.0f);
+	}
+
+	/**
+	* @brief チャンクの作成時間の計測と頂点の検証
+	* @param[in] tilemap 初期化済みのタイルマップ
+	*/
+	void MeasureChunkBuild(Tilemap* tilemap)
+	{
+		int chunk_count = tilemap->GetChunkColumns() * tilemap->GetChunkRows();
+
+		BenchTimer timer;
+		int built_count = tilemap->RebuildDirtyChunks();
+		double full_time = timer.GetElapsedTime();
+
+		BenchCheck(built_count == chunk_count, "first rebuild builds every chunk");
+		BenchCheck(tilemap->RebuildDirtyChunks() == 0, "clean chunks are not rebuilt");
+
+		// 1タイルの変更では含まれるチャンクだけを作り直す
+		tilemap->SetTile(5, 5, 3);
+		timer.Reset();
+		int edit_count = tilemap->RebuildDirtyChunks();
+		double edit_time = timer.GetElapsedTime();
+
+		BenchCheck(edit_count == 1, "single tile edit rebuilds one chunk");
+
+		const TilemapChunk& chunk = tilemap->GetChunk(0, 0);
+		BenchCheck(chunk.Vertices.size() == TilemapChunkSize * TilemapChunkSize * 6, "full chunk has six vertices per tile");
+		if (chunk.Vertices.size() > 6)
+		{
+			float expected_u = (float)(GetTestTile(1, 0) % TilesetColumns) * TileSize / TilesetSize;
+			BenchCheck(chunk.Vertices[6].TextureX == expected_u && chunk.Vertices[6].X == (float)TileSize, "chunk vertices carry tile position and UV");
+		}
+
+		tilemap->SetTile(0, 0, EmptyTile);
+		tilemap->RebuildDirtyChunks();
+		BenchCheck(tilemap->GetChunk(0, 0).Vertices.size() == (TilemapChunkSize * TilemapChunkSize - 1) * 6, "empty tile emits no vertices");
+		tilemap->SetTile(0, 0, GetTestTile(0, 0));
+		tilemap->SetTile(5, 5, GetTestTile(5, 5));
+		tilemap->RebuildDirtyChunks();
+
+		printf("  chunk build: %d chunks in %.3f ms (%.2f us/chunk), single edit %.4f ms\n",
+			built_count, full_time, full_time * 1000.0 / chunk_count, edit_time);
+	}
+
+	/**
+	* @brief 画面内のチャンクだけを描画することの検証
+	* @param[in] tilemap 作成済みのタイルマップ
+	*/
+	void CheckVisibleChunks(Tilemap* tilemap)
+	{
+		std::unique_ptr<Graphics> graphics = CreateBenchGraphics();
+		BenchCheck(graphics->Initialize(ScreenWidth, ScreenHeight, true, RenderBackendType::RenderBackendTypeRecording), "initialize recording backend");
+
+		RecordingRenderBackend* recorder = (RecordingRenderBackend*)graphics->GetBackend();
+		if (recorder == nullptr)
+		{
+			return;
+		}
+
+		// 画面に重なるチャンクは横に最大(画面幅/チャンク幅+1)個、縦に最大(画面高さ/チャンク高さ+1)個
+		int chunk_pixels = TilemapChunkSize * TileSize;
+		int max_visible_chunks = (ScreenWidth / chunk_pixels + 2) * (ScreenHeight / chunk_pixels + 2);
+
+		graphics->StartDraw(0);
+		SetScrollCamera(graphics.get(), 100);
+		graphics->DrawTilemap(tilemap);
+		graphics->FinishDraw();
+
+		int vertex_count = (int)recorder->GetVertices().size();
+		BenchCheck(vertex_count > 0 && vertex_count <= max_visible_chunks * TilemapChunkSize * TilemapChunkSize * 6, "only chunks near the screen are drawn");
+
+		graphics->Release();
+	}
+
+	/**
+	* @brief 1フレームの描画時間の計測
+	* @param[in] tilemap 作成済みのタイルマップ
+	*/
+	void MeasureFrameCost(Tilemap* tilemap)
+	{
+		std::unique_ptr<Graphics> graphics = CreateBenchGraphics();
+		BenchCheck(graphics->Initialize(ScreenWidth, ScreenHeight, true, RenderBackendType::RenderBackendTypeNull), "initialize null backend");
+
+		BenchTimer timer;
+		for (int frame = 0; frame < BenchFrameCount; frame++)
+		{
+			graphics->StartDraw(0);
+			SetScrollCamera(graphics.get(), frame);
+			graphics->DrawTilemap(tilemap);
+			graphics->FinishDraw();
+		}
+		double chunk_time = timer.GetElapsedTime() / BenchFrameCount;
+		FrameStats chunk_stats = graphics->GetFrameStats();
+
+		// 比較用：タイルごとにUVを計算し、全タイルを描画関数に渡す
+		const Texture* tileset = tilemap->GetTileset();
+		timer.Reset();
+		for (int frame = 0; frame < BenchFrameCount; frame++)
+		{
+			graphics->StartDraw(0);
+			SetScrollCamera(graphics.get(), frame);
+			for (int row = 0; row < MapRows; row++)
+			{
+				for (int column = 0; column < MapColumns; column++)
+				{
+					int tile = tilemap->GetTile(column, row);
+					float x = (float)(column * TileSize);
+					float y = (float)(row * TileSize);
+					float u_left = (float)(tile % TilesetColumns * TileSize) / tileset->Width;
+					float v_top = (float)(tile / TilesetColumns * TileSize) / tileset->Height;
+					float u_right = (float)(tile % TilesetColumns * TileSize + TileSize) / tileset->Width;
+					float v_bottom = (float)(tile / TilesetColumns * TileSize + TileSize) / tileset->Height;
+
+					CustomVertex v[6] =
+					{
+						{ x, y, 0.0f, 1.0f, 0xffffffff, u_left, v_top },
+						{ x + TileSize, y, 0.0f, 1.0f, 0xffffffff, u_right, v_top },
+						{ x + TileSize, y + TileSize, 0.0f, 1.0f, 0xffffffff, u_right, v_bottom },
+						{ x, y, 0.0f, 1.0f, 0xffffffff, u_left, v_top },
+						{ x + TileSize, y + TileSize, 0.0f, 1.0f, 0xffffffff, u_right, v_bottom },
+						{ x, y + TileSize, 0.0f, 1.0f, 0xffffffff, u_left, v_bottom },
+					};
+					graphics->DrawTriangles(tileset, v, 6);
+				}
+			}
+			graphics->FinishDraw();
+		}
+		double tile_time = timer.GetElapsedTime() / BenchFrameCount;
+		FrameStats tile_stats = graphics->GetFrameStats();
+
+		printf("  DrawTilemap:             %8.3f ms/frame, %d draw calls, %d vertices\n", chunk_time, chunk_stats.DrawCallCount, chunk_stats.VertexCount);
+		printf("  per-tile DrawTriangles:  %8.3f ms/frame, %d draw calls, %d vertices\n", tile_time, tile_stats.DrawCallCount, tile_stats.VertexCount);
+
+		graphics->Release();
+	}
+}
+
+void RunTilemapBench()
+{
+	Texture tileset = { nullptr, TilesetSize, TilesetSize };
+
+	Tilemap tilemap;
+	BenchCheck(tilemap.Initialize(&tileset, TileSize, TileSize, MapColumns, MapRows), "initialize tilemap");
+
+	for (int row = 0; row < MapRows; row++)
+	{
+		for (int column = 0; column < MapColumns; column++)
+		{
+			tilemap.SetTile(column, row, GetTestTile(column, row));
+		}
+	}
+
+	MeasureChunkBuild(&tilemap);
+	CheckVisibleChunks(&tilemap);
+	MeasureFrameCost(&tilemap);
+
+	tilemap.Release();
+}